@@ -15,10 +15,27 @@ MODULE_FIDL_H := $(MODULE_FIDL_INCLUDE)/$(MODULE_FIDL_LIB_PATH)/c/fidl.h
 MODULE_FIDL_CPP := $(MODULE_GENDIR)/src/tables.cpp
 MODULE_FIDL_CLIENT_C := $(MODULE_GENDIR)/src/client.c
 MODULE_FIDL_SERVER_C := $(MODULE_GENDIR)/src/server.c
+MODULE_FIDL_CODERS_CPP := $(MODULE_GENDIR)/src/coders.cpp
 MODULE_FIDL_CPPOBJS :=  $(MODULE_GENDIR)/obj/tables.cpp.o
 MODULE_FIDL_COBJS :=  $(MODULE_GENDIR)/obj/client.c.o $(MODULE_GENDIR)/obj/server.c.o
+
+# Coders specialized to each message, which the C bindings then use in place of
+# the coding tables.
+ifeq ($(MODULE_FIDL_CODERS),true)
+MODULE_FIDL_CODERS_FLAG := --coders $(MODULE_FIDL_CODERS_CPP)
+MODULE_FIDL_CPPOBJS += $(MODULE_GENDIR)/obj/coders.cpp.o
+MODULE_SRCDEPS += $(MODULE_FIDL_CODERS_CPP)
+GENERATED += $(MODULE_FIDL_CODERS_CPP)
+else
+MODULE_FIDL_CODERS_FLAG :=
+endif
+
 MODULE_FIDL_OBJS := $(MODULE_FIDL_CPPOBJS) $(MODULE_FIDL_COBJS)
 
+# Every library is compiled again for each library depending on it. fidlc keeps
+# them compiled here instead, keyed by their sources and its own build.
+FIDL_CACHE_DIR := $(BUILDDIR)/gen/fidl-cache
+
 MODULE_SRCDEPS += $(MODULE_FIDL_H) $(MODULE_FIDL_CPP)
 MODULE_GEN_HDR += $(MODULE_FIDL_H)
 
@@ -57,14 +74,15 @@ $(MODULE_FIDL_RSP): FIDL_H:=$(MODULE_FIDL_H)
 $(MODULE_FIDL_RSP): FIDL_CPP:=$(MODULE_FIDL_CPP)
 $(MODULE_FIDL_RSP): FIDL_CLIENT_C:=$(MODULE_FIDL_CLIENT_C)
 $(MODULE_FIDL_RSP): FIDL_SERVER_C:=$(MODULE_FIDL_SERVER_C)
+$(MODULE_FIDL_RSP): FIDL_CODERS:=$(MODULE_FIDL_CODERS_FLAG)
 $(MODULE_FIDL_RSP): FIDL_SRCS:=$(MODULE_FIDLSRCS)
 $(MODULE_FIDL_RSP): $(foreach dep,$(MODULE_FIDL_DEPS),$(call TOBUILDDIR,$(dep))/gen/fidl-files) $(MODULE_FIDLSRCS) make/fcompile.mk
 	@$(MKDIR)
-	$(NOECHO)echo --name $(FIDL_NAME) --c-header $(FIDL_H) --c-client $(FIDL_CLIENT_C) --c-server $(FIDL_SERVER_C) --tables $(FIDL_CPP) $(foreach dep,$(FIDL_DEPS),--files $(shell cat $(call TOBUILDDIR,$(dep))/gen/fidl-files)) --files $(FIDL_SRCS) > $@
+	$(NOECHO)echo --name $(FIDL_NAME) --c-header $(FIDL_H) --c-client $(FIDL_CLIENT_C) --c-server $(FIDL_SERVER_C) --tables $(FIDL_CPP) $(FIDL_CODERS) --cache-dir $(FIDL_CACHE_DIR) $(foreach dep,$(FIDL_DEPS),--files $(shell cat $(call TOBUILDDIR,$(dep))/gen/fidl-files)) --files $(FIDL_SRCS) > $@
 
 # $@ only lists one of the multiple targets, so we use $< (first dep) to
 # compute the (related) destination directories to create
-%/gen/include/$(MODULE_FIDL_LIB_PATH)/c/fidl.h %/gen/src/tables.cpp %/gen/src/client.c %/gen/src/server.c: %/gen/fidl.rsp $(FIDL)
+%/gen/include/$(MODULE_FIDL_LIB_PATH)/c/fidl.h %/gen/src/tables.cpp %/gen/src/client.c %/gen/src/server.c %/gen/src/coders.cpp: %/gen/fidl.rsp $(FIDL)
 	$(call BUILDECHO, generating fidl from $<)
 	@mkdir -p $(<D)/include $(<D)/src
 	$(NOECHO)$(FIDL) @$<
@@ -78,6 +96,8 @@ MODULE_FIDL_LIB_PATH :=
 MODULE_FIDL_INCLUDE :=
 MODULE_FIDL_H :=
 MODULE_FIDL_CPP :=
+MODULE_FIDL_CODERS_CPP :=
+MODULE_FIDL_CODERS_FLAG :=
 MODULE_FIDL_CLIENT_C :=
 MODULE_FIDL_SERVER_C :=
 MODULE_FIDL_CPPOBJS :=
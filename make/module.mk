@@ -32,6 +32,8 @@
 # MODULE_STATIC_LIBS : static libraries for a userapp or userlib to depend on
 # MODULE_FIDL_LIBS : fidl libraries for a userapp or userlib to depend on the C bindings of
 # MODULE_FIDL_LIBRARY : the name of the FIDL library being built (for fidl modules)
+# MODULE_FIDL_CODERS : if "true", the C bindings of a fidl module use coders generated for each
+#                      message instead of walking the coding tables
 # MODULE_BANJO_LIBS : banjo libraries for a userapp or userlib to depend on the C bindings of
 # MODULE_BANJO_LIBRARY : the name of the BANJO library being built (for banjo modules)
 # MODULE_FIRMWARE : files under prebuilt/downloads/firmware/ to be installed under /boot/driver/firmware/
@@ -292,6 +294,7 @@ MODULE_STATIC_LIBS :=
 MODULE_FIDL_DEPS :=
 MODULE_FIDL_LIBS :=
 MODULE_FIDL_LIBRARY :=
+MODULE_FIDL_CODERS :=
 MODULE_BANJO_DEPS :=
 MODULE_BANJO_LIBS :=
 MODULE_BANJO_LIBRARY :=
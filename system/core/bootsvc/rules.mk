@@ -28,6 +28,7 @@ MODULE_STATIC_LIBS := \
     system/ulib/async.cpp \
     system/ulib/async-loop \
     system/ulib/async-loop.cpp \
+    system/ulib/bitmap \
     system/ulib/bootdata \
     system/ulib/bootfs \
     system/ulib/bootsvc-protocol \
@@ -335,6 +335,11 @@ static zx_status_t fidl_directory_rewind(void* ctx, fidl_txn_t* txn) {
     return fuchsia_io_DirectoryRewind_reply(txn, ZX_ERR_NOT_SUPPORTED);
 }
 
+static zx_status_t fidl_directory_readdirentsplus(void* ctx, uint64_t max_out,
+                                                  fidl_txn_t* txn) {
+    return fuchsia_io_DirectoryReadDirentsPlus_reply(txn, ZX_ERR_NOT_SUPPORTED, nullptr, 0);
+}
+
 static zx_status_t fidl_directory_gettoken(void* ctx, fidl_txn_t* txn) {
     return fuchsia_io_DirectoryGetToken_reply(txn, ZX_ERR_NOT_SUPPORTED, ZX_HANDLE_INVALID);
 }
@@ -379,6 +384,7 @@ static const fuchsia_io_Directory_ops_t kDirectoryOps = []() {
     ops.Unlink = fidl_directory_unlink;
     ops.ReadDirents = fidl_directory_readdirents;
     ops.Rewind = fidl_directory_rewind;
+    ops.ReadDirentsPlus = fidl_directory_readdirentsplus;
     ops.GetToken = fidl_directory_gettoken;
     ops.Rename = fidl_directory_rename;
     ops.Link = fidl_directory_link;
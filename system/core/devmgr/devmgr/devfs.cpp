@@ -793,6 +793,10 @@ zx_status_t DcIostate::DevfsFidlHandler(fidl_msg_t* msg, fidl_txn_t* txn, void*
         }
         return fuchsia_io_DirectoryReadDirents_reply(txn, r, data, actual);
     }
+    case fuchsia_io_DirectoryReadDirentsPlusOrdinal: {
+        DECODE_REQUEST(msg, DirectoryReadDirentsPlus);
+        return fuchsia_io_DirectoryReadDirentsPlus_reply(txn, ZX_ERR_NOT_SUPPORTED, nullptr, 0);
+    }
     case fuchsia_io_DirectoryWatchOrdinal: {
         DECODE_REQUEST(msg, DirectoryWatch);
         DEFINE_REQUEST(msg, DirectoryWatch);
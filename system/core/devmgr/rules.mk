@@ -147,6 +147,7 @@ MODULE_STATIC_LIBS := \
     system/ulib/async \
     system/ulib/async-loop.cpp \
     system/ulib/async-loop \
+    system/ulib/bitmap \
     system/ulib/bootdata \
     system/ulib/bootfs \
     system/ulib/fbl \
@@ -12,6 +12,7 @@ bool FtlShell::Init(const ftl::VolumeOptions& options) {
     if (error) {
         return false;
     }
+    driver_ = driver.get();
     error = volume_.Init(std::move(driver));
     return error ? false : true;
 }
@@ -19,6 +19,7 @@ class FtlShell : public ftl::FtlInstance {
     bool ReAttach();
 
     ftl::Volume* volume() { return &volume_; }
+    const NdmRamDriver* driver() const { return driver_; }
     uint32_t page_size() const { return page_size_; }
     uint32_t num_pages() const { return num_pages_; }
 
@@ -27,6 +28,7 @@ class FtlShell : public ftl::FtlInstance {
 
   private:
     ftl::VolumeImpl volume_;
+    NdmRamDriver* driver_ = nullptr;  // Owned by |volume_|.
     uint32_t page_size_ = 0;
     uint32_t num_pages_ = 0;
 };
@@ -4,12 +4,14 @@
 
 #include "ftl-shell.h"
 
+#include <inttypes.h>
 #include <stdlib.h>
 #include <time.h>
 
 #include <fbl/algorithm.h>
 #include <fbl/array.h>
 #include <unittest/unittest.h>
+#include <zircon/syscalls.h>
 
 namespace {
 
@@ -185,7 +187,7 @@ class FtlTest {
         }
     }
 
-    bool Init();
+    bool Init(const ftl::VolumeOptions& options = kDefaultOptions);
 
     // Goes over a single iteration of the "main" ftl test. |num_pages| is the
     // number of pages to write at the same time.
@@ -213,9 +215,9 @@ class FtlTest {
     uint32_t rand_seed_;  // TODO(rvargas): replace with framework provided seed when available.
 };
 
-bool FtlTest::Init() {
+bool FtlTest::Init(const ftl::VolumeOptions& options) {
     BEGIN_TEST;
-    ASSERT_TRUE(ftl_.Init(kDefaultOptions));
+    ASSERT_TRUE(ftl_.Init(options));
     volume_ = ftl_.volume();
     ASSERT_EQ(ZX_OK, volume_->Unmount());
 
@@ -329,6 +331,63 @@ bool MultiplePassTest() {
     END_TEST;
 }
 
+// Caching only two map pages makes most volume writes evict a dirty map page.
+bool SmallMapCacheTest() {
+    BEGIN_TEST;
+    ftl::VolumeOptions options = kDefaultOptions;
+    options.map_cache_pages = 2;
+    FtlTest test;
+    ASSERT_TRUE(test.Init(options));
+
+    ASSERT_TRUE(test.SingleLoop(1));
+    ASSERT_TRUE(test.SingleLoop(7));
+    END_TEST;
+}
+
+// Reports the write amplification (pages written to NAND per page written to
+// the volume) and rate of random single page writes, with a flush every few
+// writes, for several map cache sizes.
+bool MapCachePerformanceTest() {
+    BEGIN_TEST;
+    constexpr uint32_t kMapCachePages[] = {0, 8, 4, 2, 1};
+    constexpr uint32_t kRandomWrites = 20000;
+    constexpr uint32_t kFlushInterval = 64;
+
+    unittest_printf_critical("\n");
+    for (uint32_t map_cache_pages : kMapCachePages) {
+        ftl::VolumeOptions options = kDefaultOptions;
+        options.map_cache_pages = map_cache_pages;
+        FtlShell ftl;
+        ASSERT_TRUE(ftl.Init(options));
+
+        fbl::Array<uint8_t> buffer(new uint8_t[ftl.page_size()], ftl.page_size());
+        memset(buffer.get(), 0x55, buffer.size());
+        for (uint32_t page = 0; page < ftl.num_pages(); page++) {
+            ASSERT_EQ(ZX_OK, ftl.volume()->Write(page, 1, buffer.get()));
+        }
+        ASSERT_EQ(ZX_OK, ftl.volume()->Flush());
+
+        unsigned int seed = 0;
+        uint32_t start_pages = ftl.driver()->num_pages_written();
+        zx_time_t start = zx_clock_get_monotonic();
+        for (uint32_t i = 1; i <= kRandomWrites; i++) {
+            uint32_t page = rand_r(&seed) % ftl.num_pages();
+            ASSERT_EQ(ZX_OK, ftl.volume()->Write(page, 1, buffer.get()));
+            if (i % kFlushInterval == 0) {
+                ASSERT_EQ(ZX_OK, ftl.volume()->Flush());
+            }
+        }
+        zx_duration_t elapsed = zx_clock_get_monotonic() - start;
+
+        uint32_t nand_pages = ftl.driver()->num_pages_written() - start_pages;
+        unittest_printf_critical("    map cache %u pages: write amplification %.2f, "
+                                 "%" PRId64 " writes/s\n", map_cache_pages,
+                                 static_cast<double>(nand_pages) / kRandomWrites,
+                                 kRandomWrites * ZX_SEC(1) / fbl::max<zx_duration_t>(elapsed, 1));
+    }
+    END_TEST;
+}
+
 } // namespace
 
 BEGIN_TEST_CASE(FtlTests)
@@ -344,4 +403,6 @@ RUN_TEST_SMALL(GarbageCollectTest)
 RUN_TEST_SMALL(StatsTest)
 RUN_TEST_SMALL(SinglePassTest)
 RUN_TEST_MEDIUM(MultiplePassTest)
+RUN_TEST_MEDIUM(SmallMapCacheTest)
+RUN_TEST_PERFORMANCE(MapCachePerformanceTest)
 END_TEST_CASE(FtlTests)
@@ -184,6 +184,7 @@ int NdmRamDriver::WritePage(uint32_t page_num, const uint8_t* data, const uint8_
     memcpy(MainData(page_num), data, options_.page_size);
     memcpy(SpareData(page_num), spare, options_.eb_size);
     SetWritten(page_num, true);
+    num_pages_written_++;
 
     return ftl::kNdmOk;
 }
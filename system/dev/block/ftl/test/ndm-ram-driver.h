@@ -31,6 +31,9 @@ class NdmRamDriver : public ftl::NdmBaseDriver {
     int IsBadBlock(uint32_t page_num) final;
     bool IsEmptyPage(uint32_t page_num, const uint8_t* data, const uint8_t* spare) final;
 
+    // Number of pages successfully written so far, including FTL metadata.
+    uint32_t num_pages_written() const { return num_pages_written_; }
+
   private:
     // Reads or Writes a single page.
     int ReadPage(uint32_t page_num, uint8_t* data, uint8_t* spare);
@@ -59,4 +62,5 @@ class NdmRamDriver : public ftl::NdmBaseDriver {
     int ecc_error_interval_ = 0;  // Controls simulation of ECC errors.
     int bad_block_interval_ = 0;  // Controls simulation of bad blocks.
     uint32_t num_bad_blocks_ = 0;
+    uint32_t num_pages_written_ = 0;
 };
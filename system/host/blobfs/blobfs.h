@@ -8,6 +8,7 @@
 
 #include <blobfs/host.h>
 #include <digest/digest.h>
+#include <digest/merkle-cache.h>
 #include <fbl/array.h>
 #include <fbl/vector.h>
 #include <fs-host/common.h>
@@ -40,6 +41,16 @@ private:
     zx_status_t Fsck() override;
     zx_status_t Add() override;
 
+    // Opens the Merkle cache, if one was requested and it is not already open.
+    zx_status_t OpenMerkleCache();
+
+    // Generates the Merkle tree (and, if requested, the compressed form) of the blob at
+    // |path|, open as |data_fd|, consulting the Merkle cache if there is one.
+    zx_status_t PreprocessBlob(const char* path, int data_fd, blobfs::MerkleInfo* out);
+
+    // Generates the Merkle tree of the blob at |path| and adds it to |blobfs|.
+    zx_status_t PreprocessAndAddBlob(blobfs::Blobfs* blobfs, const char* path);
+
     // A comparison function used to quickly compare MerkleInfo.
     struct DigestCompare {
         inline bool operator()(const blobfs::MerkleInfo& lhs, const blobfs::MerkleInfo& rhs) const {
@@ -64,4 +75,7 @@ private:
 
     // A list of Merkle Information for blobs in |blob_list_|.
     std::vector<blobfs::MerkleInfo> merkle_list_;
+
+    // Cache of Merkle trees from earlier runs, if one was requested.
+    fbl::unique_ptr<digest::MerkleCache> merkle_cache_;
 };
@@ -33,6 +33,46 @@ zx_status_t AddBlob(blobfs::Blobfs* blobfs, const blobfs::MerkleInfo& info) {
 
 } // namespace
 
+zx_status_t BlobfsCreator::OpenMerkleCache() {
+    const char* path = GetMerkleCachePath();
+    if (path == nullptr || merkle_cache_ != nullptr) {
+        return ZX_OK;
+    }
+    return digest::MerkleCache::Create(path, &merkle_cache_);
+}
+
+zx_status_t BlobfsCreator::PreprocessBlob(const char* path, int data_fd,
+                                          blobfs::MerkleInfo* out) {
+    zx_status_t status;
+    if (merkle_cache_ != nullptr) {
+        status = blobfs::blobfs_preprocess_cached(*merkle_cache_, path, data_fd,
+                                                  ShouldCompress(), out);
+    } else {
+        status = blobfs::blobfs_preprocess(data_fd, ShouldCompress(), out);
+    }
+    if (status != ZX_OK) {
+        fprintf(stderr, "blobfs: Failed to preprocess blob '%s': %d\n", path, status);
+        return status;
+    }
+    out->path = path;
+    return ZX_OK;
+}
+
+zx_status_t BlobfsCreator::PreprocessAndAddBlob(blobfs::Blobfs* blobfs, const char* path) {
+    fbl::unique_fd data_fd(open(path, O_RDONLY, 0644));
+    if (!data_fd) {
+        fprintf(stderr, "error: cannot open '%s'\n", path);
+        return ZX_ERR_IO;
+    }
+
+    blobfs::MerkleInfo info;
+    zx_status_t status;
+    if ((status = PreprocessBlob(path, data_fd.get(), &info)) != ZX_OK) {
+        return status;
+    }
+    return AddBlob(blobfs, info);
+}
+
 zx_status_t BlobfsCreator::Usage() {
     zx_status_t status = FsCreator::Usage();
 
@@ -61,6 +101,7 @@ bool BlobfsCreator::IsOptionValid(Option option) {
     case Option::kDepfile:
     case Option::kReadonly:
     case Option::kCompress:
+    case Option::kMerkleCache:
     case Option::kHelp:
         return true;
     default:
@@ -114,13 +155,17 @@ zx_status_t BlobfsCreator::ProcessCustom(int argc, char** argv, uint8_t* process
 }
 
 zx_status_t BlobfsCreator::CalculateRequiredSize(off_t* out) {
+    zx_status_t status;
+    if ((status = OpenMerkleCache()) != ZX_OK) {
+        return status;
+    }
+
     std::vector<std::thread> threads;
     unsigned blob_index = 0;
     unsigned n_threads = std::thread::hardware_concurrency();
     if (!n_threads) {
         n_threads = 4;
     }
-    zx_status_t status = ZX_OK;
     std::mutex mtx;
     for (unsigned j = n_threads; j > 0; j--) {
         threads.push_back(std::thread([&] {
@@ -148,15 +193,13 @@ zx_status_t BlobfsCreator::CalculateRequiredSize(off_t* out) {
                 blobfs::MerkleInfo info;
                 fbl::unique_fd data_fd(open(path, O_RDONLY, 0644));
 
-                if ((res = blobfs::blobfs_preprocess(data_fd.get(), ShouldCompress(), &info))
-                    != ZX_OK) {
+                if ((res = PreprocessBlob(path, data_fd.get(), &info)) != ZX_OK) {
+                    mtx.lock();
                     status = res;
                     mtx.unlock();
                     return;
                 }
 
-                info.path = path;
-
                 mtx.lock();
                 merkle_list_.push_back(std::move(info));
                 mtx.unlock();
@@ -236,10 +279,20 @@ zx_status_t BlobfsCreator::Add() {
     if ((status = blobfs_create(&blobfs, std::move(fd_))) != ZX_OK) {
         return status;
     }
+    if ((status = OpenMerkleCache()) != ZX_OK) {
+        return status;
+    }
 
     std::vector<std::thread> threads;
     std::mutex mtx;
 
+    // When creating a new image, CalculateRequiredSize has already generated the Merkle tree
+    // (and compressed form) of every blob. Otherwise each worker preprocesses its blob just
+    // before adding it, so that hashing, compression and data writes of different blobs all
+    // proceed in parallel.
+    const bool preprocessed = !merkle_list_.empty();
+    const size_t blob_count = preprocessed ? merkle_list_.size() : blob_list_.size();
+
     unsigned n_threads = std::thread::hardware_concurrency();
     if (!n_threads) {
         n_threads = 4;
@@ -251,14 +304,20 @@ zx_status_t BlobfsCreator::Add() {
             while (true) {
                 mtx.lock();
                 i = blob_index++;
-                if (i >= merkle_list_.size()) {
+                if (i >= blob_count || status != ZX_OK) {
                     mtx.unlock();
                     return;
                 }
                 mtx.unlock();
 
                 zx_status_t res;
-                if ((res = AddBlob(blobfs.get(), merkle_list_[i])) < 0) {
+                if (preprocessed) {
+                    res = AddBlob(blobfs.get(), merkle_list_[i]);
+                } else {
+                    res = PreprocessAndAddBlob(blobfs.get(), blob_list_[i].c_str());
+                }
+
+                if (res < 0) {
                     mtx.lock();
                     status = res;
                     mtx.unlock();
@@ -6,16 +6,21 @@
 #include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include <fstream>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include <fidl/c_generator.h>
+#include <fidl/coders_generator.h>
+#include <fidl/compiled_library.h>
 #include <fidl/flat_ast.h>
 #include <fidl/json_generator.h>
 #include <fidl/json_schema.h>
@@ -34,8 +39,10 @@ void Usage() {
            "             [--c-client CLIENT_PATH]\n"
            "             [--c-server SERVER_PATH]\n"
            "             [--tables TABLES_PATH]\n"
+           "             [--coders CODERS_PATH]\n"
            "             [--json JSON_PATH]\n"
            "             [--name LIBRARY_NAME]\n"
+           "             [--cache-dir CACHE_DIR]\n"
            "             [--files [FIDL_FILE...]...]\n"
            "             [--help]\n"
            "\n"
@@ -52,6 +59,10 @@ void Usage() {
            "   coding tables at the given path. The coding tables are required to encode and\n"
            "   decode messages from the C and C++ bindings.\n"
            "\n"
+           " * `--coders CODERS_PATH`. If present, this flag instructs `fidlc` to output\n"
+           "   an encoder, decoder and validator specialized to each message at the given\n"
+           "   path, and the C bindings to use them instead of walking the coding tables.\n"
+           "\n"
            " * `--json JSON_PATH`. If present, this flag instructs `fidlc` to output the\n"
            "   library's intermediate representation at the given path. The intermediate\n"
            "   representation is JSON that conforms to the schema available via --json-schema.\n"
@@ -62,6 +73,11 @@ void Usage() {
            "   cross-check between the library's declaration in a build system and the\n"
            "   actual contents of the library.\n"
            "\n"
+           " * `--cache-dir CACHE_DIR`. If present, this flag instructs `fidlc` to keep the\n"
+           "   compiled form of each library it compiles in CACHE_DIR, and to load the\n"
+           "   libraries preceding the final one from there when their sources, those of\n"
+           "   the libraries preceding them, and `fidlc` itself are unchanged.\n"
+           "\n"
            " * `--files [FIDL_FILE...]...`. Each `--file [FIDL_FILE...]` chunk of arguments\n"
            "   describes a library, all of which must share the same top-level library name\n"
            "   declaration. Libraries must be presented in dependency order, with later\n"
@@ -223,19 +239,73 @@ enum struct Behavior {
     kCClient,
     kCServer,
     kTables,
+    kCoders,
     kJSON,
 };
 
-bool Parse(const fidl::SourceFile& source_file,
+struct ParsedFile {
+    fidl::ErrorReporter error_reporter;
+    std::unique_ptr<fidl::raw::File> ast;
+    bool ok = false;
+};
+
+void Parse(const fidl::SourceFile& source_file, ParsedFile* parsed_file) {
+    fidl::Lexer lexer(source_file, &parsed_file->error_reporter);
+    fidl::Parser parser(&lexer, &parsed_file->error_reporter);
+    parsed_file->ast = parser.Parse();
+    parsed_file->ok = parser.Ok();
+}
+
+// Lexing and parsing a file does not depend on any other, so the files of a
+// library are parsed concurrently, each reporting to its own ErrorReporter.
+// They are then consumed in order, reporting their errors in that order too,
+// and stopping at the first failure, just as parsing them one after the
+// other would.
+bool Parse(const std::vector<std::unique_ptr<fidl::SourceFile>>& source_files,
            fidl::ErrorReporter* error_reporter, fidl::flat::Library* library) {
-    fidl::Lexer lexer(source_file, error_reporter);
-    fidl::Parser parser(&lexer, error_reporter);
-    auto ast = parser.Parse();
-    if (!parser.Ok()) {
-        return false;
+    std::vector<ParsedFile> parsed_files(source_files.size());
+
+    size_t n_threads = std::thread::hardware_concurrency();
+    if (!n_threads) {
+        n_threads = 4;
+    }
+    if (n_threads > source_files.size()) {
+        n_threads = source_files.size();
+    }
+    if (n_threads <= 1) {
+        for (size_t i = 0; i < source_files.size(); ++i) {
+            Parse(*source_files[i], &parsed_files[i]);
+        }
+    } else {
+        std::vector<std::thread> threads;
+        std::mutex mtx;
+        size_t next_file = 0;
+        for (size_t i = n_threads; i > 0; --i) {
+            threads.push_back(std::thread([&] {
+                while (true) {
+                    mtx.lock();
+                    auto j = next_file++;
+                    mtx.unlock();
+                    if (j >= source_files.size()) {
+                        return;
+                    }
+                    Parse(*source_files[j], &parsed_files[j]);
+                }
+            }));
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
     }
-    if (!library->ConsumeFile(std::move(ast))) {
-        return false;
+
+    for (auto& parsed_file : parsed_files) {
+        error_reporter->Merge(parsed_file.error_reporter);
+        if (!parsed_file.ok || !error_reporter->errors().empty()) {
+            return false;
+        }
+        if (!library->ConsumeFile(std::move(parsed_file.ast))) {
+            return false;
+        }
     }
     return true;
 }
@@ -245,6 +315,55 @@ void Write(std::ostringstream output, std::fstream file) {
     file.flush();
 }
 
+// Identifies this build of the compiler, so that libraries it compiled are
+// not loaded by another. Returns an empty string if it cannot tell.
+std::string CompilerIdentity(const char* program) {
+    struct stat program_stat;
+    if (stat(program, &program_stat) != 0) {
+        return std::string();
+    }
+    return std::to_string(program_stat.st_size) + ":" + std::to_string(program_stat.st_mtime);
+}
+
+// Returns nullptr if |path| does not hold a library compiled against
+// |all_libraries|, in which case it is compiled from source instead.
+std::unique_ptr<fidl::flat::Library> ReadCompiledLibrary(
+    const std::string& path, const fidl::flat::Libraries* all_libraries,
+    fidl::ErrorReporter* error_reporter, fidl::flat::Typespace* typespace) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        return nullptr;
+    }
+    std::ostringstream data;
+    data << file.rdbuf();
+    std::string contents = data.str();
+    fidl::CompiledLibraryReader reader(contents, all_libraries, error_reporter, typespace);
+    return reader.Consume();
+}
+
+// Failing to write to the cache only costs a later compilation, so it is
+// not an error. The file is renamed into place, so that concurrent
+// compilations only ever see complete files.
+void WriteCompiledLibrary(const std::string& path, const fidl::flat::Library* library) {
+    fidl::CompiledLibraryWriter writer(library);
+    std::string temporary_path = path + "." + std::to_string(getpid()) + ".tmp";
+    {
+        std::ofstream file(temporary_path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return;
+        }
+        file << writer.Produce().str();
+        if (!file.good()) {
+            file.close();
+            unlink(temporary_path.data());
+            return;
+        }
+    }
+    if (rename(temporary_path.data(), path.data()) != 0) {
+        unlink(temporary_path.data());
+    }
+}
+
 } // namespace
 
 // TODO(pascallouis): remove forward declaration, this was only introduced to
@@ -252,6 +371,8 @@ void Write(std::ostringstream output, std::fstream file) {
 int compile(fidl::ErrorReporter* error_reporter,
             fidl::flat::Typespace* typespace,
             std::string library_name,
+            std::string cache_dir,
+            std::string compiler,
             std::map<Behavior, std::fstream> outputs,
             std::vector<fidl::SourceManager> source_managers);
 
@@ -283,6 +404,7 @@ int main(int argc, char* argv[]) {
     }
 
     std::string library_name;
+    std::string cache_dir;
 
     std::map<Behavior, std::fstream> outputs;
     while (args->Remaining()) {
@@ -303,10 +425,15 @@ int main(int argc, char* argv[]) {
             outputs.emplace(Behavior::kCServer, Open(args->Claim(), std::ios::out));
         } else if (behavior_argument == "--tables") {
             outputs.emplace(Behavior::kTables, Open(args->Claim(), std::ios::out));
+        } else if (behavior_argument == "--coders") {
+            outputs.emplace(Behavior::kCoders, Open(args->Claim(), std::ios::out));
         } else if (behavior_argument == "--json") {
             outputs.emplace(Behavior::kJSON, Open(args->Claim(), std::ios::out));
         } else if (behavior_argument == "--name") {
             library_name = args->Claim();
+        } else if (behavior_argument == "--cache-dir") {
+            cache_dir = args->Claim();
+            MakeParentDirectory(cache_dir + "/");
         } else if (behavior_argument == "--files") {
             // Start parsing filenames.
             break;
@@ -339,6 +466,8 @@ int main(int argc, char* argv[]) {
     auto status = compile(&error_reporter,
                           &typespace,
                           library_name,
+                          cache_dir,
+                          CompilerIdentity(argv[0]),
                           std::move(outputs),
                           std::move(source_managers));
     error_reporter.PrintReports();
@@ -348,22 +477,51 @@ int main(int argc, char* argv[]) {
 int compile(fidl::ErrorReporter* error_reporter,
             fidl::flat::Typespace* typespace,
             std::string library_name,
+            std::string cache_dir,
+            std::string compiler,
             std::map<Behavior, std::fstream> outputs,
             std::vector<fidl::SourceManager> source_managers) {
+    // Without knowing which compiler produced a cached library, it cannot
+    // be trusted.
+    if (compiler.empty()) {
+        cache_dir.clear();
+    }
+    const fidl::SourceManager* final_source_manager = nullptr;
+    for (const auto& source_manager : source_managers) {
+        if (!source_manager.sources().empty()) {
+            final_source_manager = &source_manager;
+        }
+    }
+
     fidl::flat::Libraries all_libraries;
     const fidl::flat::Library* final_library = nullptr;
+    std::string key;
     for (const auto& source_manager : source_managers) {
         if (source_manager.sources().empty()) {
             continue;
         }
-        auto library = std::make_unique<fidl::flat::Library>(&all_libraries, error_reporter, typespace);
-        for (const auto& source_file : source_manager.sources()) {
-            if (!Parse(*source_file, error_reporter, library.get())) {
-                return 1;
+        std::unique_ptr<fidl::flat::Library> library;
+        std::string cache_path;
+        if (!cache_dir.empty()) {
+            key = fidl::CompiledLibraryKey(compiler, key, source_manager.sources());
+            cache_path = cache_dir + "/" + key + ".fidl-library";
+            // The final library is always compiled from source, so that
+            // errors and warnings are reported against it.
+            if (&source_manager != final_source_manager) {
+                library = ReadCompiledLibrary(cache_path, &all_libraries, error_reporter, typespace);
             }
         }
-        if (!library->Compile()) {
-            return 1;
+        if (!library) {
+            library = std::make_unique<fidl::flat::Library>(&all_libraries, error_reporter, typespace);
+            if (!Parse(source_manager.sources(), error_reporter, library.get())) {
+                return 1;
+            }
+            if (!library->Compile()) {
+                return 1;
+            }
+            if (!cache_path.empty()) {
+                WriteCompiledLibrary(cache_path, library.get());
+            }
         }
         final_library = library.get();
         if (!all_libraries.Insert(std::move(library))) {
@@ -383,25 +541,30 @@ int compile(fidl::ErrorReporter* error_reporter,
              final_name.data(), library_name.data());
     }
 
-    // We recompile dependencies, and only emit output for the final
-    // library.
+    // The C bindings call the generated coders, if there are any, instead of
+    // the coding tables.
+    auto coding = outputs.count(Behavior::kCoders) ? fidl::CGenerator::Coding::kGeneratedCoders
+                                                   : fidl::CGenerator::Coding::kTables;
+
+    // We recompile (or load) dependencies, and only emit output for the
+    // final library.
     for (auto& output : outputs) {
         auto& behavior = output.first;
         auto& output_file = output.second;
 
         switch (behavior) {
         case Behavior::kCHeader: {
-            fidl::CGenerator generator(final_library);
+            fidl::CGenerator generator(final_library, coding);
             Write(generator.ProduceHeader(), std::move(output_file));
             break;
         }
         case Behavior::kCClient: {
-            fidl::CGenerator generator(final_library);
+            fidl::CGenerator generator(final_library, coding);
             Write(generator.ProduceClient(), std::move(output_file));
             break;
         }
         case Behavior::kCServer: {
-            fidl::CGenerator generator(final_library);
+            fidl::CGenerator generator(final_library, coding);
             Write(generator.ProduceServer(), std::move(output_file));
             break;
         }
@@ -410,6 +573,11 @@ int compile(fidl::ErrorReporter* error_reporter,
             Write(generator.Produce(), std::move(output_file));
             break;
         }
+        case Behavior::kCoders: {
+            fidl::CodersGenerator generator(final_library);
+            Write(generator.Produce(), std::move(output_file));
+            break;
+        }
         case Behavior::kJSON: {
             fidl::JSONGenerator generator(final_library);
             Write(generator.Produce(), std::move(output_file));
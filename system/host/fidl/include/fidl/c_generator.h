@@ -26,8 +26,16 @@ namespace fidl {
 
 class CGenerator {
 public:
-    explicit CGenerator(const flat::Library* library)
-        : library_(library) {}
+    // How messages are encoded and decoded by the client and server.
+    enum class Coding {
+        // By walking the coding tables, with fidl_encode() and fidl_decode().
+        kTables,
+        // By the coders fidlc generates with --coders.
+        kGeneratedCoders,
+    };
+
+    explicit CGenerator(const flat::Library* library, Coding coding = Coding::kTables)
+        : library_(library), coding_(coding) {}
 
     ~CGenerator() = default;
 
@@ -173,6 +181,7 @@ private:
     void ProduceInterfaceServerImplementation(const NamedInterface& named_interface);
 
     const flat::Library* library_;
+    const Coding coding_;
     std::ostringstream file_;
 };
 
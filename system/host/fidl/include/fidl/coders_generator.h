@@ -0,0 +1,80 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ZIRCON_SYSTEM_HOST_FIDL_INCLUDE_FIDL_CODERS_GENERATOR_H_
+#define ZIRCON_SYSTEM_HOST_FIDL_INCLUDE_FIDL_CODERS_GENERATOR_H_
+
+#include <sstream>
+#include <string>
+
+#include "coded_ast.h"
+#include "coded_types_generator.h"
+#include "flat_ast.h"
+#include "string_view.h"
+
+namespace fidl {
+
+// Generates an encoder, decoder and validator specialized to each message of
+// a library, as an alternative to walking its coding tables. See
+// <lib/fidl/generated_coding.h> for the runtime support the output relies on.
+
+// Methods named "Generate..." directly generate coders output.
+
+// Methods named "Produce..." indirectly generate coders output by calling
+// the Generate methods.
+
+class CodersGenerator {
+public:
+    explicit CodersGenerator(const flat::Library* library)
+        : coded_types_generator_(library) {}
+
+    ~CodersGenerator() = default;
+
+    std::ostringstream Produce();
+
+private:
+    void GenerateFilePreamble();
+    void GenerateFilePostamble();
+
+    void GenerateCoderSignature(StringView coded_name);
+    void GenerateCoderForward(StringView coded_name);
+    void GenerateCoderBegin(StringView coded_name);
+    void GenerateCoderEnd();
+
+    // Emits a call to the coder of |type| for the object at |offset|.
+    void GenerateCall(const coded::Type* type, StringView offset);
+    // Emits a lambda calling the coder of |type|, for the coding helpers.
+    void GenerateLambda(const coded::Type* type);
+
+    void Generate(const coded::StructType& struct_type);
+    void Generate(const coded::TableType& table_type);
+    void Generate(const coded::UnionType& union_type);
+    void Generate(const coded::XUnionType& xunion_type);
+    void Generate(const coded::MessageType& message_type);
+    void Generate(const coded::HandleType& handle_type);
+    void Generate(const coded::InterfaceHandleType& interface_type);
+    void Generate(const coded::RequestHandleType& request_type);
+    void Generate(const coded::ArrayType& array_type);
+    void Generate(const coded::StringType& string_type);
+    void Generate(const coded::VectorType& vector_type);
+
+    void GenerateFields(const std::vector<coded::StructField>& fields);
+    template <typename Field>
+    void GenerateEnvelopeSwitch(const std::vector<Field>& fields);
+    void GeneratePointer(StringView pointer_name, StringView coded_name, uint32_t size);
+    void GenerateHandle(types::Nullability nullability);
+
+    void GenerateEntryPoints(const coded::MessageType& message_type);
+
+    template <typename Visit>
+    void ForEachNamedType(Visit visit);
+
+    CodedTypesGenerator coded_types_generator_;
+
+    std::ostringstream coders_file_;
+};
+
+} // namespace fidl
+
+#endif // ZIRCON_SYSTEM_HOST_FIDL_INCLUDE_FIDL_CODERS_GENERATOR_H_
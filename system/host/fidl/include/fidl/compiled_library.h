@@ -0,0 +1,177 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ZIRCON_SYSTEM_HOST_FIDL_INCLUDE_FIDL_COMPILED_LIBRARY_H_
+#define ZIRCON_SYSTEM_HOST_FIDL_INCLUDE_FIDL_COMPILED_LIBRARY_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "error_reporter.h"
+#include "flat_ast.h"
+#include "source_file.h"
+#include "string_view.h"
+
+namespace fidl {
+
+// A compiled library is the serialized form of a flat::Library once it has
+// been compiled: its declarations, with their types and constants resolved
+// and their shapes computed. Libraries depending on it can be compiled
+// against it without lexing, parsing and compiling its sources again.
+//
+// Only what dependent libraries and the generators of a dependent library
+// read is kept. In particular, source locations are replaced by virtual
+// ones, and unresolved literal constants (e.g. the default values of struct
+// members) are dropped.
+
+// Bumped whenever the serialized form, or what the compiler computes for a
+// library, changes.
+constexpr uint32_t kCompiledLibraryVersion = 1u;
+
+// Returns the key of a compiled library: a hash of the |compiler| that
+// produced it, of the |previous_key| of the libraries preceding it on the
+// command line (which it may depend on), and of its |sources|.
+std::string CompiledLibraryKey(StringView compiler, StringView previous_key,
+                               const std::vector<std::unique_ptr<SourceFile>>& sources);
+
+// Methods named "Emit..." write the serialized form of scalars and strings.
+
+// Methods named "Generate..." serialize flat AST nodes via the "Emit"
+// methods.
+
+// Methods named "Produce..." indirectly serialize the library by calling the
+// Generate methods.
+
+class CompiledLibraryWriter {
+public:
+    // |library| must have been compiled successfully.
+    explicit CompiledLibraryWriter(const flat::Library* library)
+        : library_(library) {}
+
+    ~CompiledLibraryWriter() = default;
+
+    std::ostringstream Produce();
+
+private:
+    void EmitNumber(uint64_t value);
+    void EmitSignedNumber(int64_t value);
+    void EmitFloat(double value);
+    void EmitString(StringView value);
+
+    void GenerateName(const flat::Name& name);
+    void GenerateAttributes(const raw::AttributeList* attributes);
+    void GenerateOrdinal(const raw::Ordinal* ordinal);
+    void GenerateTypeShape(const TypeShape& typeshape);
+    void GenerateFieldShape(const FieldShape& fieldshape);
+    void GenerateConstantValue(const flat::ConstantValue& value);
+    void GenerateConstant(const flat::Constant* constant);
+    void GenerateType(const flat::Type* type);
+
+    void Generate(const flat::Const& const_decl);
+    void Generate(const flat::Enum& enum_decl);
+    void Generate(const flat::Interface& interface_decl);
+    void Generate(const flat::Struct& struct_decl);
+    void Generate(const flat::Table& table_decl);
+    void Generate(const flat::Union& union_decl);
+    void Generate(const flat::XUnion& xunion_decl);
+
+    template <typename Decls>
+    void GenerateDecls(const Decls& decls);
+
+    const flat::Library* library_;
+
+    // The index of each of the library's declarations, in the order they
+    // are serialized.
+    std::map<const flat::Decl*, uint64_t> decl_indices_;
+    // The index of each of the library's structs, in struct_declarations_.
+    std::map<const flat::Struct*, uint64_t> struct_indices_;
+
+    std::ostringstream compiled_file_;
+};
+
+// Methods named "Read..." deserialize scalars and strings.
+
+// Methods named "Consume..." deserialize flat AST nodes via the "Read"
+// methods, and fail when the serialized form is malformed.
+
+class CompiledLibraryReader {
+public:
+    CompiledLibraryReader(StringView data, const flat::Libraries* all_libraries,
+                          ErrorReporter* error_reporter, flat::Typespace* typespace)
+        : data_(data), all_libraries_(all_libraries), error_reporter_(error_reporter),
+          typespace_(typespace) {}
+
+    ~CompiledLibraryReader() = default;
+
+    // Returns the library, or nullptr if the data is not a compiled library
+    // of this version, or depends on a library missing from all_libraries.
+    std::unique_ptr<flat::Library> Consume();
+
+private:
+    bool ReadNumber(uint64_t* out_value);
+    bool ReadSignedNumber(int64_t* out_value);
+    bool ReadFloat(double* out_value);
+    bool ReadString(std::string* out_value);
+    bool ReadKeyword(StringView keyword);
+    template <typename Value>
+    bool ReadBoundedNumber(uint64_t bound, Value* out_value);
+
+    // Returns a location in the library's virtual source file, which also
+    // keeps |data| alive for as long as the library.
+    SourceLocation AddLocation(const std::string& data);
+
+    bool ConsumeLibrary(const std::string& library_name, flat::Library** out_library);
+    bool ConsumeName(flat::Name* out_name);
+    bool ConsumeAttributes(std::unique_ptr<raw::AttributeList>* out_attributes);
+    bool ConsumeOrdinal(std::unique_ptr<raw::Ordinal>* out_ordinal);
+    bool ConsumeTypeShape(TypeShape* out_typeshape);
+    bool ConsumeFieldShape(FieldShape* out_fieldshape);
+    bool ConsumeConstantValue(std::unique_ptr<flat::ConstantValue>* out_value);
+    bool ConsumeConstant(std::unique_ptr<flat::Constant>* out_constant);
+    bool ConsumeType(std::unique_ptr<flat::Type>* out_type);
+    bool ConsumeTypeOfKind(flat::Type::Kind kind, types::Nullability nullability,
+                           std::unique_ptr<flat::Type>* out_type);
+    bool ConsumePrimitiveType(const flat::PrimitiveType** out_type);
+    bool ConsumeStruct(flat::Struct** out_struct);
+
+    bool ConsumeConstDecl();
+    bool ConsumeEnumDecl();
+    bool ConsumeInterfaceDecl();
+    bool ConsumeStructDecl();
+    bool ConsumeTableDecl();
+    bool ConsumeUnionDecl();
+    bool ConsumeXUnionDecl();
+    bool ConsumeDecls(bool (CompiledLibraryReader::*consume)());
+
+    StringView data_;
+    size_t position_ = 0u;
+
+    const flat::Libraries* all_libraries_;
+    ErrorReporter* error_reporter_;
+    flat::Typespace* typespace_;
+
+    std::unique_ptr<flat::Library> library_;
+    std::vector<flat::Decl*> decls_;
+    // The libraries that names refer to, by dotted name.
+    std::map<std::string, flat::Library*> libraries_;
+
+    // The entries of each interface's all_methods, including those of the
+    // interfaces it composes. They are resolved once all the library's
+    // declarations have been read.
+    struct MethodReference {
+        flat::Interface* interface;
+        flat::Name interface_name;
+        uint64_t index;
+    };
+    std::vector<MethodReference> method_references_;
+};
+
+} // namespace fidl
+
+#endif // ZIRCON_SYSTEM_HOST_FIDL_INCLUDE_FIDL_COMPILED_LIBRARY_H_
@@ -34,6 +34,7 @@ public:
     void ReportError(const Token& token, StringView message);
     void ReportError(StringView message);
     void ReportWarning(const SourceLocation& location, StringView message);
+    void Merge(const ErrorReporter& other);
     void PrintReports();
     Counts Checkpoint() const { return Counts(this); };
     const std::vector<std::string>& errors() const { return errors_; };
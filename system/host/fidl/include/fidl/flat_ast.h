@@ -25,6 +25,10 @@
 #include "virtual_source_file.h"
 
 namespace fidl {
+
+class CompiledLibraryReader;
+class CompiledLibraryWriter;
+
 namespace flat {
 
 template <typename T>
@@ -1068,6 +1072,9 @@ private:
 };
 
 class Library {
+    friend class ::fidl::CompiledLibraryReader;
+    friend class ::fidl::CompiledLibraryWriter;
+
 public:
     Library(const Libraries* all_libraries, ErrorReporter* error_reporter, Typespace* typespace)
         : all_libraries_(all_libraries), error_reporter_(error_reporter), typespace_(typespace) {}
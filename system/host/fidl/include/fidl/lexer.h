@@ -24,13 +24,9 @@ public:
     // The Lexer assumes the final character is 0. This substantially
     // simplifies advancing to the next character.
     Lexer(const SourceFile& source_file, ErrorReporter* error_reporter)
-        : source_file_(source_file), error_reporter_(error_reporter) {
+        : source_file_(source_file), keyword_table_(KeywordTable()),
+          error_reporter_(error_reporter) {
         assert(data()[data().size() - 1] == 0);
-        keyword_table_ = {
-#define KEYWORD(Name, Spelling) {Spelling, Token::Subkind::k##Name},
-#include "fidl/token_definitions.inc"
-#undef KEYWORD
-        };
         current_ = data().data();
         previous_end_ = token_start_ = current_;
     }
@@ -39,11 +35,17 @@ public:
     Token LexNoComments();
 
 private:
+    // Shared by all lexers, including those running on other threads.
+    static const std::map<StringView, Token::Subkind>& KeywordTable();
+
     StringView data() { return source_file_.data(); }
+    const char* end() { return data().data() + data().size(); }
 
     constexpr char Peek() const;
     void Skip();
+    void Skip(size_t count);
     char Consume();
+    void Consume(size_t count);
     StringView Reset(Token::Kind kind);
     Token Finish(Token::Kind kind);
 
@@ -57,7 +59,7 @@ private:
     Token LexCommentOrDocComment();
 
     const SourceFile& source_file_;
-    std::map<StringView, Token::Subkind> keyword_table_;
+    const std::map<StringView, Token::Subkind>& keyword_table_;
     ErrorReporter* error_reporter_;
 
     const char* current_ = nullptr;
@@ -49,6 +49,10 @@ std::string NameTable(StringView type_name);
 std::string NamePointer(StringView name);
 std::string NameMembers(StringView name);
 std::string NameFields(StringView name);
+std::string NameCoder(StringView type_name);
+std::string NameEncode(StringView type_name);
+std::string NameDecode(StringView type_name);
+std::string NameValidate(StringView type_name);
 
 std::string NameCodedStruct(const flat::Struct* struct_decl);
 std::string NameCodedTable(const flat::Table* table_decl);
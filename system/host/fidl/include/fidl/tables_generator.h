@@ -13,6 +13,7 @@
 #include <vector>
 
 #include "coded_ast.h"
+#include "coded_types_generator.h"
 #include "flat_ast.h"
 #include "string_view.h"
 
@@ -31,7 +32,7 @@ namespace fidl {
 class TablesGenerator {
 public:
     explicit TablesGenerator(const flat::Library* library)
-        : library_(library) {}
+        : library_(library), coded_types_generator_(library) {}
 
     ~TablesGenerator() = default;
 
@@ -72,28 +73,8 @@ private:
     void GenerateForward(const coded::UnionType& union_type);
     void GenerateForward(const coded::XUnionType& xunion_type);
 
-    // Returns a pointer owned by coded_types_.
-    const coded::Type* CompileType(const flat::Type* type);
-    void CompileFields(const flat::Decl* decl);
-    void Compile(const flat::Decl* decl);
-
     const flat::Library* library_;
-
-    // All flat::Types and flat::Names here are owned by library_, and
-    // all coded::Types by the named_coded_types_ map or the coded_types_ vector.
-    template <typename FlatType, typename CodedType>
-    using TypeMap = std::map<const FlatType*, const CodedType*, flat::PtrCompare<FlatType>>;
-    TypeMap<flat::PrimitiveType, coded::PrimitiveType> primitive_type_map_;
-    TypeMap<flat::HandleType, coded::HandleType> handle_type_map_;
-    TypeMap<flat::RequestHandleType, coded::RequestHandleType> request_type_map_;
-    TypeMap<flat::IdentifierType, coded::InterfaceHandleType> interface_type_map_;
-    TypeMap<flat::ArrayType, coded::ArrayType> array_type_map_;
-    TypeMap<flat::VectorType, coded::VectorType> vector_type_map_;
-    TypeMap<flat::StringType, coded::StringType> string_type_map_;
-
-    std::map<const flat::Name*, std::unique_ptr<coded::Type>, flat::PtrCompare<flat::Name>>
-        named_coded_types_;
-    std::vector<std::unique_ptr<coded::Type>> coded_types_;
+    CodedTypesGenerator coded_types_generator_;
 
     std::ostringstream tables_file_;
     size_t indent_level_ = 0u;
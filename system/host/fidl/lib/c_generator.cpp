@@ -597,6 +597,44 @@ void GetMethodParameters(const flat::Library* library,
     }
 }
 
+// Emits the start of a call encoding |message|, up to its first argument,
+// which is its bytes.
+void EmitEncodeCall(std::ostream* file, CGenerator::Coding coding,
+                    const CGenerator::NamedMessage& message) {
+    switch (coding) {
+    case CGenerator::Coding::kTables:
+        *file << "fidl_encode(&" << message.coded_name << ", ";
+        break;
+    case CGenerator::Coding::kGeneratedCoders:
+        *file << NameEncode(message.c_name) << "(";
+        break;
+    }
+}
+
+void EmitDecodeCall(std::ostream* file, CGenerator::Coding coding,
+                    const CGenerator::NamedMessage& message) {
+    switch (coding) {
+    case CGenerator::Coding::kTables:
+        *file << "fidl_decode(&" << message.coded_name << ", ";
+        break;
+    case CGenerator::Coding::kGeneratedCoders:
+        *file << NameDecode(message.c_name) << "(";
+        break;
+    }
+}
+
+void EmitCoderDecls(std::ostream* file, const CGenerator::NamedMessage& message) {
+    *file << "zx_status_t " << NameEncode(message.c_name)
+          << "(void* bytes, uint32_t num_bytes, zx_handle_t* handles, uint32_t max_handles,"
+          << " uint32_t* out_actual_handles, const char** out_error_msg);\n";
+    *file << "zx_status_t " << NameDecode(message.c_name)
+          << "(void* bytes, uint32_t num_bytes, const zx_handle_t* handles,"
+          << " uint32_t num_handles, const char** out_error_msg);\n";
+    *file << "zx_status_t " << NameValidate(message.c_name)
+          << "(const void* bytes, uint32_t num_bytes, uint32_t num_handles,"
+          << " const char** out_error_msg);\n";
+}
+
 } // namespace
 
 void CGenerator::GeneratePrologues() {
@@ -900,6 +938,12 @@ void CGenerator::ProduceInterfaceExternDeclaration(const NamedInterface& named_i
         if (method_info.response)
             file_ << "extern const fidl_type_t " << method_info.response->coded_name
                   << ";\n";
+        if (coding_ == Coding::kGeneratedCoders) {
+            if (method_info.request)
+                EmitCoderDecls(&file_, *method_info.request);
+            if (method_info.response)
+                EmitCoderDecls(&file_, *method_info.response);
+        }
     }
 }
 
@@ -1043,13 +1087,15 @@ void CGenerator::ProduceInterfaceClientImplementation(const NamedInterface& name
             switch (named_interface.transport) {
             case Transport::Channel:
                 file_ << kIndent << "zx_handle_t _handles[ZX_CHANNEL_MAX_MSG_HANDLES];\n";
-                file_ << kIndent << "zx_status_t _status = fidl_encode(&" << method_info.request->coded_name
-                      << ", _wr_bytes, _wr_num_bytes, _handles, ZX_CHANNEL_MAX_MSG_HANDLES"
+                file_ << kIndent << "zx_status_t _status = ";
+                EmitEncodeCall(&file_, coding_, *method_info.request);
+                file_ << "_wr_bytes, _wr_num_bytes, _handles, ZX_CHANNEL_MAX_MSG_HANDLES"
                       << ", &_wr_num_handles, NULL);\n";
                 break;
             case Transport::SocketControl:
-                file_ << kIndent << "zx_status_t _status = fidl_encode(&" << method_info.request->coded_name
-                      << ", _wr_bytes, _wr_num_bytes, NULL, 0, &_wr_num_handles, NULL);\n";
+                file_ << kIndent << "zx_status_t _status = ";
+                EmitEncodeCall(&file_, coding_, *method_info.request);
+                file_ << "_wr_bytes, _wr_num_bytes, NULL, 0, &_wr_num_handles, NULL);\n";
                 break;
             }
             file_ << kIndent << "if (_status != ZX_OK)\n";
@@ -1171,12 +1217,14 @@ void CGenerator::ProduceInterfaceClientImplementation(const NamedInterface& name
                 // TODO(FIDL-162): Validate the response ordinal. C++ bindings also need to do that.
                 switch (named_interface.transport) {
                 case Transport::Channel:
-                    file_ << kIndent << "_status = fidl_decode(&" << method_info.response->coded_name
-                          << ", _rd_bytes, _actual_num_bytes, _handles, _actual_num_handles, NULL);\n";
+                    file_ << kIndent << "_status = ";
+                    EmitDecodeCall(&file_, coding_, *method_info.response);
+                    file_ << "_rd_bytes, _actual_num_bytes, _handles, _actual_num_handles, NULL);\n";
                     break;
                 case Transport::SocketControl:
-                    file_ << kIndent << "_status = fidl_decode(&" << method_info.response->coded_name
-                          << ", _rd_bytes, _actual_num_bytes, NULL, 0, NULL);\n";
+                    file_ << kIndent << "_status = ";
+                    EmitDecodeCall(&file_, coding_, *method_info.response);
+                    file_ << "_rd_bytes, _actual_num_bytes, NULL, 0, NULL);\n";
                     break;
                 }
                 file_ << kIndent << "if (_status != ZX_OK)\n";
@@ -1301,7 +1349,15 @@ void CGenerator::ProduceInterfaceServerImplementation(const NamedInterface& name
             file_ << kIndent << "case " << method_info.generated_ordinal_name << ":\n";
         }
         file_ << kIndent << "case " << method_info.ordinal_name << ": {\n";
-        file_ << kIndent << kIndent << "status = fidl_decode_msg(&" << method_info.request->coded_name << ", msg, NULL);\n";
+        switch (coding_) {
+        case Coding::kTables:
+            file_ << kIndent << kIndent << "status = fidl_decode_msg(&" << method_info.request->coded_name << ", msg, NULL);\n";
+            break;
+        case Coding::kGeneratedCoders:
+            file_ << kIndent << kIndent << "status = " << NameDecode(method_info.request->c_name)
+                  << "(msg->bytes, msg->num_bytes, msg->handles, msg->num_handles, NULL);\n";
+            break;
+        }
         file_ << kIndent << kIndent << "if (status != ZX_OK)\n";
         file_ << kIndent << kIndent << kIndent << "break;\n";
         std::vector<Member> request;
@@ -1421,8 +1477,16 @@ void CGenerator::ProduceInterfaceServerImplementation(const NamedInterface& name
         }
         file_ << kIndent << "};\n";
         if (encode) {
-            file_ << kIndent << "zx_status_t _status = fidl_encode_msg(&"
-                  << method_info.response->coded_name << ", &_msg, &_msg.num_handles, NULL);\n";
+            switch (coding_) {
+            case Coding::kTables:
+                file_ << kIndent << "zx_status_t _status = fidl_encode_msg(&"
+                      << method_info.response->coded_name << ", &_msg, &_msg.num_handles, NULL);\n";
+                break;
+            case Coding::kGeneratedCoders:
+                file_ << kIndent << "zx_status_t _status = " << NameEncode(method_info.response->c_name)
+                      << "(_msg.bytes, _msg.num_bytes, _msg.handles, _msg.num_handles, &_msg.num_handles, NULL);\n";
+                break;
+            }
             file_ << kIndent << "if (_status != ZX_OK)\n";
             file_ << kIndent << kIndent << "return _status;\n";
         } else {
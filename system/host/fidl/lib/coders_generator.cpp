@@ -0,0 +1,425 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "fidl/coders_generator.h"
+
+#include "fidl/names.h"
+
+namespace fidl {
+
+namespace {
+
+constexpr auto kIndent = "    ";
+
+std::ostream& operator<<(std::ostream& stream, StringView view) {
+    stream.rdbuf()->sputn(view.data(), view.size());
+    return stream;
+}
+
+const char* NameNullable(types::Nullability nullability) {
+    switch (nullability) {
+    case types::Nullability::kNullable:
+        return "true";
+    case types::Nullability::kNonnullable:
+        return "false";
+    }
+}
+
+std::string NameOffset(uint32_t offset) {
+    if (offset == 0u)
+        return "offset";
+    return "offset + " + std::to_string(offset) + "u";
+}
+
+} // namespace
+
+void CodersGenerator::GenerateFilePreamble() {
+    coders_file_ << "// WARNING: This file is machine generated by fidlc.\n\n";
+    coders_file_ << "#include <lib/fidl/generated_coding.h>\n\n";
+    coders_file_ << "namespace {\n\n";
+}
+
+void CodersGenerator::GenerateFilePostamble() {
+    coders_file_ << "} // extern \"C\"\n";
+}
+
+void CodersGenerator::GenerateCoderSignature(StringView coded_name) {
+    coders_file_ << "template <typename Coder>\n";
+    coders_file_ << "bool " << NameCoder(coded_name) << "(Coder* coder, uint32_t offset)";
+}
+
+void CodersGenerator::GenerateCoderForward(StringView coded_name) {
+    GenerateCoderSignature(coded_name);
+    coders_file_ << ";\n";
+}
+
+void CodersGenerator::GenerateCoderBegin(StringView coded_name) {
+    GenerateCoderSignature(coded_name);
+    coders_file_ << " {\n";
+}
+
+void CodersGenerator::GenerateCoderEnd() {
+    coders_file_ << "}\n\n";
+}
+
+void CodersGenerator::GenerateCall(const coded::Type* type, StringView offset) {
+    coders_file_ << NameCoder(type->coded_name) << "(coder, " << offset << ")";
+}
+
+void CodersGenerator::GenerateLambda(const coded::Type* type) {
+    coders_file_ << "[](Coder* coder, uint32_t offset) { return ";
+    GenerateCall(type, "offset");
+    coders_file_ << "; }";
+}
+
+void CodersGenerator::GenerateFields(const std::vector<coded::StructField>& fields) {
+    for (const auto& field : fields) {
+        coders_file_ << kIndent << "if (!";
+        GenerateCall(field.type, NameOffset(field.offset));
+        coders_file_ << ")\n";
+        coders_file_ << kIndent << kIndent << "return false;\n";
+    }
+    coders_file_ << kIndent << "return true;\n";
+}
+
+template <typename Field>
+void CodersGenerator::GenerateEnvelopeSwitch(const std::vector<Field>& fields) {
+    coders_file_ << "[](Coder* coder, uint32_t ordinal, uint32_t envelope_offset) {\n";
+    coders_file_ << kIndent << kIndent << "switch (ordinal) {\n";
+    for (const auto& field : fields) {
+        coders_file_ << kIndent << kIndent << "case " << field.ordinal << "u:\n";
+        coders_file_ << kIndent << kIndent << kIndent
+                     << "return ::fidl::internal::CodeEnvelope(coder, envelope_offset, "
+                     << field.type->size << "u, ";
+        GenerateLambda(field.type);
+        coders_file_ << ");\n";
+    }
+    coders_file_ << kIndent << kIndent << "default:\n";
+    coders_file_ << kIndent << kIndent << kIndent
+                 << "return ::fidl::internal::CodeUnknownEnvelope(coder, envelope_offset);\n";
+    coders_file_ << kIndent << kIndent << "}\n";
+    coders_file_ << kIndent << "}";
+}
+
+void CodersGenerator::Generate(const coded::StructType& struct_type) {
+    GenerateCoderBegin(struct_type.coded_name);
+    GenerateFields(struct_type.fields);
+    GenerateCoderEnd();
+}
+
+void CodersGenerator::Generate(const coded::TableType& table_type) {
+    GenerateCoderBegin(table_type.coded_name);
+    coders_file_ << kIndent << "return ::fidl::internal::CodeTable(coder, offset, ";
+    GenerateEnvelopeSwitch(table_type.fields);
+    coders_file_ << ");\n";
+    GenerateCoderEnd();
+}
+
+void CodersGenerator::Generate(const coded::UnionType& union_type) {
+    GenerateCoderBegin(union_type.coded_name);
+    coders_file_ << kIndent << "switch (*coder->template At<fidl_union_tag_t>(offset)) {\n";
+    for (size_t tag = 0; tag < union_type.types.size(); ++tag) {
+        coders_file_ << kIndent << "case " << tag << "u:\n";
+        coders_file_ << kIndent << kIndent << "return ";
+        // Members which need no coding are still valid tags.
+        if (union_type.types[tag] != nullptr) {
+            GenerateCall(union_type.types[tag], NameOffset(union_type.data_offset));
+        } else {
+            coders_file_ << "true";
+        }
+        coders_file_ << ";\n";
+    }
+    coders_file_ << kIndent << "default:\n";
+    coders_file_ << kIndent << kIndent
+                 << "return coder->ConstraintViolation(\"Bad union discriminant\");\n";
+    coders_file_ << kIndent << "}\n";
+    GenerateCoderEnd();
+}
+
+void CodersGenerator::Generate(const coded::XUnionType& xunion_type) {
+    GenerateCoderBegin(xunion_type.coded_name);
+    coders_file_ << kIndent << "return ::fidl::internal::CodeXUnion(coder, offset, ";
+    GenerateEnvelopeSwitch(xunion_type.fields);
+    coders_file_ << ");\n";
+    GenerateCoderEnd();
+}
+
+void CodersGenerator::Generate(const coded::MessageType& message_type) {
+    GenerateCoderBegin(message_type.coded_name);
+    GenerateFields(message_type.fields);
+    GenerateCoderEnd();
+}
+
+void CodersGenerator::GenerateHandle(types::Nullability nullability) {
+    coders_file_ << kIndent << "return ::fidl::internal::CodeHandle(coder, offset, "
+                 << NameNullable(nullability) << ");\n";
+}
+
+void CodersGenerator::Generate(const coded::HandleType& handle_type) {
+    GenerateCoderBegin(handle_type.coded_name);
+    GenerateHandle(handle_type.nullability);
+    GenerateCoderEnd();
+}
+
+void CodersGenerator::Generate(const coded::InterfaceHandleType& interface_type) {
+    GenerateCoderBegin(interface_type.coded_name);
+    GenerateHandle(interface_type.nullability);
+    GenerateCoderEnd();
+}
+
+void CodersGenerator::Generate(const coded::RequestHandleType& request_type) {
+    GenerateCoderBegin(request_type.coded_name);
+    GenerateHandle(request_type.nullability);
+    GenerateCoderEnd();
+}
+
+void CodersGenerator::Generate(const coded::ArrayType& array_type) {
+    GenerateCoderBegin(array_type.coded_name);
+    coders_file_ << kIndent << "for (uint32_t element_offset = 0u; element_offset < "
+                 << array_type.size << "u; element_offset += " << array_type.element_size
+                 << "u) {\n";
+    coders_file_ << kIndent << kIndent << "if (!";
+    GenerateCall(array_type.element_type, "offset + element_offset");
+    coders_file_ << ")\n";
+    coders_file_ << kIndent << kIndent << kIndent << "return false;\n";
+    coders_file_ << kIndent << "}\n";
+    coders_file_ << kIndent << "return true;\n";
+    GenerateCoderEnd();
+}
+
+void CodersGenerator::Generate(const coded::StringType& string_type) {
+    GenerateCoderBegin(string_type.coded_name);
+    coders_file_ << kIndent << "return ::fidl::internal::CodeString(coder, offset, "
+                 << string_type.max_size << "u, " << NameNullable(string_type.nullability)
+                 << ");\n";
+    GenerateCoderEnd();
+}
+
+void CodersGenerator::Generate(const coded::VectorType& vector_type) {
+    GenerateCoderBegin(vector_type.coded_name);
+    coders_file_ << kIndent << "return ::fidl::internal::CodeVector(coder, offset, "
+                 << vector_type.max_count << "u, " << vector_type.element_size << "u, "
+                 << NameNullable(vector_type.nullability) << ", ";
+    if (vector_type.element_type->coding_needed == coded::CodingNeeded::kNeeded) {
+        GenerateLambda(vector_type.element_type);
+    } else {
+        coders_file_ << "::fidl::internal::NothingToCode()";
+    }
+    coders_file_ << ");\n";
+    GenerateCoderEnd();
+}
+
+void CodersGenerator::GeneratePointer(StringView pointer_name, StringView coded_name,
+                                      uint32_t size) {
+    GenerateCoderBegin(pointer_name);
+    coders_file_ << kIndent << "return ::fidl::internal::CodePointer(coder, offset, " << size
+                 << "u, [](Coder* coder, uint32_t offset) { return " << NameCoder(coded_name)
+                 << "(coder, offset); });\n";
+    GenerateCoderEnd();
+}
+
+void CodersGenerator::GenerateEntryPoints(const coded::MessageType& message_type) {
+    const std::string& name = message_type.coded_name;
+
+    coders_file_ << "zx_status_t " << NameEncode(name)
+                 << "(void* bytes, uint32_t num_bytes, zx_handle_t* handles, uint32_t max_handles,"
+                 << " uint32_t* out_actual_handles, const char** out_error_msg) {\n";
+    coders_file_ << kIndent << "return ::fidl::internal::GeneratedEncode(\n";
+    coders_file_ << kIndent << kIndent << message_type.size
+                 << "u, [](::fidl::internal::GeneratedEncoder* coder) { return "
+                 << NameCoder(name) << "(coder, 0u); },\n";
+    coders_file_ << kIndent << kIndent
+                 << "bytes, num_bytes, handles, max_handles, out_actual_handles, out_error_msg);\n";
+    coders_file_ << "}\n\n";
+
+    coders_file_ << "zx_status_t " << NameDecode(name)
+                 << "(void* bytes, uint32_t num_bytes, const zx_handle_t* handles,"
+                 << " uint32_t num_handles, const char** out_error_msg) {\n";
+    coders_file_ << kIndent << "return ::fidl::internal::GeneratedDecode(\n";
+    coders_file_ << kIndent << kIndent << message_type.size
+                 << "u, [](::fidl::internal::GeneratedDecoder* coder) { return "
+                 << NameCoder(name) << "(coder, 0u); },\n";
+    coders_file_ << kIndent << kIndent
+                 << "bytes, num_bytes, handles, num_handles, out_error_msg);\n";
+    coders_file_ << "}\n\n";
+
+    coders_file_ << "zx_status_t " << NameValidate(name)
+                 << "(const void* bytes, uint32_t num_bytes, uint32_t num_handles,"
+                 << " const char** out_error_msg) {\n";
+    coders_file_ << kIndent << "return ::fidl::internal::GeneratedValidate(\n";
+    coders_file_ << kIndent << kIndent << message_type.size
+                 << "u, [](::fidl::internal::GeneratedValidator* coder) { return "
+                 << NameCoder(name) << "(coder, 0u); },\n";
+    coders_file_ << kIndent << kIndent << "bytes, num_bytes, num_handles, out_error_msg);\n";
+    coders_file_ << "}\n\n";
+}
+
+template <typename Visit>
+void CodersGenerator::ForEachNamedType(Visit visit) {
+    // Types declared by dependencies are included, so that the coders of a
+    // library do not depend on those of other libraries.
+    for (const auto& decl : coded_types_generator_.library()->declaration_order_) {
+        const coded::Type* coded_type = coded_types_generator_.CodedTypeFor(&decl->name);
+        if (!coded_type)
+            continue;
+        switch (coded_type->kind) {
+        case coded::Type::Kind::kStruct:
+        case coded::Type::Kind::kTable:
+        case coded::Type::Kind::kUnion:
+        case coded::Type::Kind::kXUnion:
+            visit(coded_type);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+std::ostringstream CodersGenerator::Produce() {
+    GenerateFilePreamble();
+
+    coded_types_generator_.CompileCodedTypes(true);
+
+    // The anonymous types and messages which need coding. Pointers are
+    // generated along with the types they point to.
+    std::vector<const coded::Type*> anonymous_types;
+    for (const auto& coded_type : coded_types_generator_.coded_types()) {
+        if (coded_type->coding_needed == coded::CodingNeeded::kNotNeeded)
+            continue;
+        switch (coded_type->kind) {
+        case coded::Type::Kind::kMessage:
+        case coded::Type::Kind::kHandle:
+        case coded::Type::Kind::kInterfaceHandle:
+        case coded::Type::Kind::kRequestHandle:
+        case coded::Type::Kind::kArray:
+        case coded::Type::Kind::kString:
+        case coded::Type::Kind::kVector:
+            anonymous_types.push_back(coded_type.get());
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Coders may refer to each other in any order, e.g. for recursive types,
+    // so all of them are declared first.
+    ForEachNamedType([this](const coded::Type* coded_type) {
+        GenerateCoderForward(coded_type->coded_name);
+    });
+    ForEachNamedType([this](const coded::Type* coded_type) {
+        switch (coded_type->kind) {
+        case coded::Type::Kind::kStruct: {
+            auto struct_type = static_cast<const coded::StructType*>(coded_type);
+            if (struct_type->referenced_by_pointer)
+                GenerateCoderForward(struct_type->pointer_name);
+            break;
+        }
+        case coded::Type::Kind::kTable: {
+            auto table_type = static_cast<const coded::TableType*>(coded_type);
+            if (table_type->referenced_by_pointer)
+                GenerateCoderForward(table_type->pointer_name);
+            break;
+        }
+        case coded::Type::Kind::kUnion: {
+            auto union_type = static_cast<const coded::UnionType*>(coded_type);
+            if (union_type->referenced_by_pointer)
+                GenerateCoderForward(union_type->pointer_name);
+            break;
+        }
+        case coded::Type::Kind::kXUnion: {
+            auto xunion_type = static_cast<const coded::XUnionType*>(coded_type);
+            if (xunion_type->referenced_by_pointer)
+                GenerateCoderForward(xunion_type->pointer_name);
+            break;
+        }
+        default:
+            break;
+        }
+    });
+    for (const coded::Type* coded_type : anonymous_types)
+        GenerateCoderForward(coded_type->coded_name);
+
+    coders_file_ << "\n";
+
+    ForEachNamedType([this](const coded::Type* coded_type) {
+        switch (coded_type->kind) {
+        case coded::Type::Kind::kStruct: {
+            auto struct_type = static_cast<const coded::StructType*>(coded_type);
+            Generate(*struct_type);
+            if (struct_type->referenced_by_pointer)
+                GeneratePointer(struct_type->pointer_name, struct_type->coded_name,
+                                struct_type->size);
+            break;
+        }
+        case coded::Type::Kind::kTable: {
+            auto table_type = static_cast<const coded::TableType*>(coded_type);
+            Generate(*table_type);
+            if (table_type->referenced_by_pointer)
+                GeneratePointer(table_type->pointer_name, table_type->coded_name,
+                                table_type->size);
+            break;
+        }
+        case coded::Type::Kind::kUnion: {
+            auto union_type = static_cast<const coded::UnionType*>(coded_type);
+            Generate(*union_type);
+            if (union_type->referenced_by_pointer)
+                GeneratePointer(union_type->pointer_name, union_type->coded_name,
+                                union_type->size);
+            break;
+        }
+        case coded::Type::Kind::kXUnion: {
+            auto xunion_type = static_cast<const coded::XUnionType*>(coded_type);
+            Generate(*xunion_type);
+            if (xunion_type->referenced_by_pointer)
+                GeneratePointer(xunion_type->pointer_name, xunion_type->coded_name,
+                                xunion_type->size);
+            break;
+        }
+        default:
+            break;
+        }
+    });
+
+    for (const coded::Type* coded_type : anonymous_types) {
+        switch (coded_type->kind) {
+        case coded::Type::Kind::kMessage:
+            Generate(*static_cast<const coded::MessageType*>(coded_type));
+            break;
+        case coded::Type::Kind::kHandle:
+            Generate(*static_cast<const coded::HandleType*>(coded_type));
+            break;
+        case coded::Type::Kind::kInterfaceHandle:
+            Generate(*static_cast<const coded::InterfaceHandleType*>(coded_type));
+            break;
+        case coded::Type::Kind::kRequestHandle:
+            Generate(*static_cast<const coded::RequestHandleType*>(coded_type));
+            break;
+        case coded::Type::Kind::kArray:
+            Generate(*static_cast<const coded::ArrayType*>(coded_type));
+            break;
+        case coded::Type::Kind::kString:
+            Generate(*static_cast<const coded::StringType*>(coded_type));
+            break;
+        case coded::Type::Kind::kVector:
+            Generate(*static_cast<const coded::VectorType*>(coded_type));
+            break;
+        default:
+            break;
+        }
+    }
+
+    coders_file_ << "} // namespace\n\n";
+    coders_file_ << "extern \"C\" {\n\n";
+
+    for (const coded::Type* coded_type : anonymous_types) {
+        if (coded_type->kind == coded::Type::Kind::kMessage)
+            GenerateEntryPoints(*static_cast<const coded::MessageType*>(coded_type));
+    }
+
+    GenerateFilePostamble();
+
+    return std::move(coders_file_);
+}
+
+} // namespace fidl
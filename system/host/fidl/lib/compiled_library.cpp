@@ -0,0 +1,1180 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "fidl/compiled_library.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BORINGSSL_NO_CXX
+#include <openssl/sha.h>
+
+#include "fidl/names.h"
+
+namespace fidl {
+
+namespace {
+
+constexpr const char* kMagic = "fidl-compiled-library";
+
+void HashNumber(SHA256_CTX* context, uint64_t value) {
+    uint8_t bytes[8];
+    for (size_t i = 0; i < sizeof(bytes); ++i)
+        bytes[i] = static_cast<uint8_t>(value >> (8 * i));
+    SHA256_Update(context, bytes, sizeof(bytes));
+}
+
+void HashString(SHA256_CTX* context, StringView value) {
+    HashNumber(context, value.size());
+    SHA256_Update(context, value.data(), value.size());
+}
+
+// Finds the interface declaring |method| among |interface| and the interfaces
+// it composes.
+bool FindMethod(const flat::Library* library, const flat::Interface* interface,
+                const flat::Interface::Method* method,
+                const flat::Interface** out_interface, uint64_t* out_index) {
+    for (size_t i = 0; i < interface->methods.size(); ++i) {
+        if (&interface->methods[i] == method) {
+            *out_interface = interface;
+            *out_index = i;
+            return true;
+        }
+    }
+    for (const auto& superinterface : interface->superinterfaces) {
+        auto decl = library->LookupDeclByName(superinterface);
+        if (decl == nullptr || decl->kind != flat::Decl::Kind::kInterface)
+            continue;
+        if (FindMethod(library, static_cast<const flat::Interface*>(decl), method,
+                       out_interface, out_index))
+            return true;
+    }
+    return false;
+}
+
+// How a constant is serialized.
+enum struct ConstantForm : uint64_t {
+    // Absent, or a literal that was never resolved.
+    kNone,
+    kIdentifier,
+    kResolvedIdentifier,
+    kValue,
+};
+
+} // namespace
+
+std::string CompiledLibraryKey(StringView compiler, StringView previous_key,
+                               const std::vector<std::unique_ptr<SourceFile>>& sources) {
+    SHA256_CTX context;
+    SHA256_Init(&context);
+    HashString(&context, kMagic);
+    HashNumber(&context, kCompiledLibraryVersion);
+    HashString(&context, compiler);
+    HashString(&context, previous_key);
+    HashNumber(&context, sources.size());
+    for (const auto& source : sources)
+        HashString(&context, source->data());
+
+    uint8_t digest[SHA256_DIGEST_LENGTH];
+    SHA256_Final(digest, &context);
+
+    static const char kHexDigits[] = "0123456789abcdef";
+    std::string key;
+    for (uint8_t byte : digest) {
+        key.push_back(kHexDigits[byte >> 4]);
+        key.push_back(kHexDigits[byte & 0xf]);
+    }
+    return key;
+}
+
+void CompiledLibraryWriter::EmitNumber(uint64_t value) {
+    compiled_file_ << value << ' ';
+}
+
+void CompiledLibraryWriter::EmitSignedNumber(int64_t value) {
+    compiled_file_ << value << ' ';
+}
+
+void CompiledLibraryWriter::EmitFloat(double value) {
+    // Hexadecimal floating point round-trips exactly through strtod.
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%a", value);
+    compiled_file_ << buffer << ' ';
+}
+
+void CompiledLibraryWriter::EmitString(StringView value) {
+    compiled_file_ << value.size() << ':';
+    compiled_file_.write(value.data(), value.size());
+    compiled_file_ << ' ';
+}
+
+void CompiledLibraryWriter::GenerateName(const flat::Name& name) {
+    EmitString(flat::LibraryName(name.library(), "."));
+    EmitNumber(name.is_anonymous());
+    EmitString(name.name_part());
+}
+
+void CompiledLibraryWriter::GenerateAttributes(const raw::AttributeList* attributes) {
+    EmitNumber(attributes != nullptr);
+    if (attributes == nullptr)
+        return;
+    EmitNumber(attributes->attributes.size());
+    for (const auto& attribute : attributes->attributes) {
+        EmitString(attribute->name);
+        EmitString(attribute->value);
+    }
+}
+
+void CompiledLibraryWriter::GenerateOrdinal(const raw::Ordinal* ordinal) {
+    EmitNumber(ordinal != nullptr);
+    if (ordinal != nullptr)
+        EmitNumber(ordinal->value);
+}
+
+void CompiledLibraryWriter::GenerateTypeShape(const TypeShape& typeshape) {
+    EmitNumber(typeshape.Size());
+    EmitNumber(typeshape.Alignment());
+    EmitNumber(typeshape.Depth());
+    EmitNumber(typeshape.MaxHandles());
+    EmitNumber(typeshape.MaxOutOfLine());
+}
+
+void CompiledLibraryWriter::GenerateFieldShape(const FieldShape& fieldshape) {
+    GenerateTypeShape(fieldshape.Typeshape());
+    EmitNumber(fieldshape.Offset());
+}
+
+void CompiledLibraryWriter::GenerateConstantValue(const flat::ConstantValue& value) {
+    using Kind = flat::ConstantValue::Kind;
+    EmitNumber(static_cast<uint64_t>(value.kind));
+    switch (value.kind) {
+    case Kind::kInt8:
+        EmitSignedNumber(static_cast<const flat::NumericConstantValue<int8_t>&>(value).value);
+        break;
+    case Kind::kInt16:
+        EmitSignedNumber(static_cast<const flat::NumericConstantValue<int16_t>&>(value).value);
+        break;
+    case Kind::kInt32:
+        EmitSignedNumber(static_cast<const flat::NumericConstantValue<int32_t>&>(value).value);
+        break;
+    case Kind::kInt64:
+        EmitSignedNumber(static_cast<const flat::NumericConstantValue<int64_t>&>(value).value);
+        break;
+    case Kind::kUint8:
+        EmitNumber(static_cast<const flat::NumericConstantValue<uint8_t>&>(value).value);
+        break;
+    case Kind::kUint16:
+        EmitNumber(static_cast<const flat::NumericConstantValue<uint16_t>&>(value).value);
+        break;
+    case Kind::kUint32:
+        EmitNumber(static_cast<const flat::NumericConstantValue<uint32_t>&>(value).value);
+        break;
+    case Kind::kUint64:
+        EmitNumber(static_cast<const flat::NumericConstantValue<uint64_t>&>(value).value);
+        break;
+    case Kind::kFloat32:
+        EmitFloat(static_cast<const flat::NumericConstantValue<float>&>(value).value);
+        break;
+    case Kind::kFloat64:
+        EmitFloat(static_cast<const flat::NumericConstantValue<double>&>(value).value);
+        break;
+    case Kind::kBool:
+        EmitNumber(static_cast<const flat::BoolConstantValue&>(value).value);
+        break;
+    case Kind::kString:
+        EmitString(static_cast<const flat::StringConstantValue&>(value).value);
+        break;
+    }
+}
+
+void CompiledLibraryWriter::GenerateConstant(const flat::Constant* constant) {
+    // Identifier constants keep their name, since the order in which a
+    // dependent library sorts declarations depends on it. The others are only
+    // needed for their value.
+    if (constant == nullptr) {
+        EmitNumber(static_cast<uint64_t>(ConstantForm::kNone));
+        return;
+    }
+    if (constant->kind == flat::Constant::Kind::kIdentifier) {
+        auto identifier_constant = static_cast<const flat::IdentifierConstant*>(constant);
+        if (!constant->IsResolved()) {
+            EmitNumber(static_cast<uint64_t>(ConstantForm::kIdentifier));
+            GenerateName(identifier_constant->name);
+            return;
+        }
+        EmitNumber(static_cast<uint64_t>(ConstantForm::kResolvedIdentifier));
+        GenerateName(identifier_constant->name);
+        GenerateConstantValue(constant->Value());
+        return;
+    }
+    if (!constant->IsResolved()) {
+        EmitNumber(static_cast<uint64_t>(ConstantForm::kNone));
+        return;
+    }
+    EmitNumber(static_cast<uint64_t>(ConstantForm::kValue));
+    GenerateConstantValue(constant->Value());
+}
+
+void CompiledLibraryWriter::GenerateType(const flat::Type* type) {
+    EmitNumber(static_cast<uint64_t>(type->kind));
+    EmitNumber(static_cast<uint64_t>(type->nullability));
+    // Arrays and identifier types are only sized once compiled.
+    EmitNumber(type->size);
+    switch (type->kind) {
+    case flat::Type::Kind::kArray: {
+        auto array_type = static_cast<const flat::ArrayType*>(type);
+        GenerateType(array_type->element_type.get());
+        GenerateConstant(array_type->element_count.get());
+        break;
+    }
+    case flat::Type::Kind::kVector: {
+        auto vector_type = static_cast<const flat::VectorType*>(type);
+        GenerateType(vector_type->element_type.get());
+        GenerateConstant(vector_type->element_count.get());
+        break;
+    }
+    case flat::Type::Kind::kString: {
+        auto string_type = static_cast<const flat::StringType*>(type);
+        GenerateConstant(string_type->max_size.get());
+        break;
+    }
+    case flat::Type::Kind::kHandle: {
+        auto handle_type = static_cast<const flat::HandleType*>(type);
+        EmitNumber(static_cast<uint64_t>(handle_type->subtype));
+        break;
+    }
+    case flat::Type::Kind::kRequestHandle: {
+        auto request_type = static_cast<const flat::RequestHandleType*>(type);
+        GenerateName(request_type->name);
+        break;
+    }
+    case flat::Type::Kind::kPrimitive: {
+        auto primitive_type = static_cast<const flat::PrimitiveType*>(type);
+        EmitNumber(static_cast<uint64_t>(primitive_type->subtype));
+        break;
+    }
+    case flat::Type::Kind::kIdentifier: {
+        auto identifier_type = static_cast<const flat::IdentifierType*>(type);
+        GenerateName(identifier_type->name);
+        break;
+    }
+    }
+}
+
+void CompiledLibraryWriter::Generate(const flat::Const& const_decl) {
+    GenerateType(const_decl.type.get());
+    GenerateConstant(const_decl.value.get());
+}
+
+void CompiledLibraryWriter::Generate(const flat::Enum& enum_decl) {
+    EmitNumber(static_cast<uint64_t>(enum_decl.type->subtype));
+    GenerateTypeShape(enum_decl.typeshape);
+    EmitNumber(enum_decl.members.size());
+    for (const auto& member : enum_decl.members) {
+        EmitString(member.name.data());
+        GenerateConstant(member.value.get());
+        GenerateAttributes(member.attributes.get());
+    }
+}
+
+void CompiledLibraryWriter::Generate(const flat::Interface& interface_decl) {
+    EmitNumber(interface_decl.superinterfaces.size());
+    for (const auto& superinterface : interface_decl.superinterfaces)
+        GenerateName(superinterface);
+    EmitNumber(interface_decl.methods.size());
+    for (const auto& method : interface_decl.methods) {
+        GenerateAttributes(method.attributes.get());
+        GenerateOrdinal(method.ordinal.get());
+        GenerateOrdinal(method.generated_ordinal.get());
+        EmitString(method.name.data());
+        // Structs are numbered from 1, so that 0 stands for no message.
+        EmitNumber(method.maybe_request ? struct_indices_.at(method.maybe_request) + 1 : 0u);
+        EmitNumber(method.maybe_response ? struct_indices_.at(method.maybe_response) + 1 : 0u);
+    }
+    EmitNumber(interface_decl.all_methods.size());
+    for (const auto* method : interface_decl.all_methods) {
+        const flat::Interface* interface = nullptr;
+        uint64_t index = 0u;
+        bool found = FindMethod(library_, &interface_decl, method, &interface, &index);
+        assert(found && "Compiler bug: method of no interface!");
+        static_cast<void>(found);
+        GenerateName(interface->name);
+        EmitNumber(index);
+    }
+}
+
+void CompiledLibraryWriter::Generate(const flat::Struct& struct_decl) {
+    EmitNumber(struct_decl.anonymous);
+    EmitNumber(struct_decl.recursive);
+    GenerateTypeShape(struct_decl.typeshape);
+    EmitNumber(struct_decl.members.size());
+    for (const auto& member : struct_decl.members) {
+        GenerateType(member.type.get());
+        EmitString(member.name.data());
+        GenerateConstant(member.maybe_default_value.get());
+        GenerateAttributes(member.attributes.get());
+        GenerateFieldShape(member.fieldshape);
+    }
+}
+
+void CompiledLibraryWriter::Generate(const flat::Table& table_decl) {
+    EmitNumber(table_decl.recursive);
+    GenerateTypeShape(table_decl.typeshape);
+    EmitNumber(table_decl.members.size());
+    for (const auto& member : table_decl.members) {
+        GenerateOrdinal(member.ordinal.get());
+        EmitNumber(member.maybe_used != nullptr);
+        if (!member.maybe_used)
+            continue;
+        GenerateType(member.maybe_used->type.get());
+        EmitString(member.maybe_used->name.data());
+        GenerateConstant(member.maybe_used->maybe_default_value.get());
+        GenerateAttributes(member.maybe_used->attributes.get());
+        GenerateTypeShape(member.maybe_used->typeshape);
+    }
+}
+
+void CompiledLibraryWriter::Generate(const flat::Union& union_decl) {
+    EmitNumber(union_decl.recursive);
+    GenerateTypeShape(union_decl.typeshape);
+    GenerateFieldShape(union_decl.membershape);
+    EmitNumber(union_decl.members.size());
+    for (const auto& member : union_decl.members) {
+        GenerateType(member.type.get());
+        EmitString(member.name.data());
+        GenerateAttributes(member.attributes.get());
+        GenerateFieldShape(member.fieldshape);
+    }
+}
+
+void CompiledLibraryWriter::Generate(const flat::XUnion& xunion_decl) {
+    EmitNumber(xunion_decl.recursive);
+    GenerateTypeShape(xunion_decl.typeshape);
+    EmitNumber(xunion_decl.members.size());
+    for (const auto& member : xunion_decl.members) {
+        GenerateOrdinal(member.ordinal.get());
+        GenerateType(member.type.get());
+        EmitString(member.name.data());
+        GenerateAttributes(member.attributes.get());
+        GenerateFieldShape(member.fieldshape);
+    }
+}
+
+template <typename Decls>
+void CompiledLibraryWriter::GenerateDecls(const Decls& decls) {
+    EmitNumber(decls.size());
+    for (const auto& decl : decls) {
+        GenerateName(decl->name);
+        GenerateAttributes(decl->attributes.get());
+        Generate(*decl);
+        decl_indices_.emplace(decl.get(), decl_indices_.size());
+    }
+}
+
+std::ostringstream CompiledLibraryWriter::Produce() {
+    compiled_file_ << kMagic << ' ';
+    EmitNumber(kCompiledLibraryVersion);
+
+    EmitNumber(library_->name().size());
+    for (const auto& component : library_->name())
+        EmitString(component);
+    GenerateAttributes(library_->attributes_.get());
+
+    EmitNumber(library_->dependencies().size());
+    for (const auto* dep_library : library_->dependencies())
+        EmitString(flat::LibraryName(dep_library, "."));
+
+    EmitNumber(library_->using_.size());
+    for (const auto& alias : library_->using_) {
+        EmitString(alias->name.name_part());
+        EmitNumber(static_cast<uint64_t>(alias->type->subtype));
+    }
+
+    for (const auto& struct_decl : library_->struct_declarations_)
+        struct_indices_.emplace(struct_decl.get(), struct_indices_.size());
+
+    // Interfaces come last, since their methods refer to structs.
+    GenerateDecls(library_->const_declarations_);
+    GenerateDecls(library_->enum_declarations_);
+    GenerateDecls(library_->struct_declarations_);
+    GenerateDecls(library_->table_declarations_);
+    GenerateDecls(library_->union_declarations_);
+    GenerateDecls(library_->xunion_declarations_);
+    GenerateDecls(library_->interface_declarations_);
+
+    // Only the library's own declarations are kept in its declaration
+    // order. Libraries depending on it sort theirs again anyway.
+    std::vector<uint64_t> declaration_order;
+    for (const auto* decl : library_->declaration_order_) {
+        auto iter = decl_indices_.find(decl);
+        if (iter != decl_indices_.end())
+            declaration_order.push_back(iter->second);
+    }
+    EmitNumber(declaration_order.size());
+    for (uint64_t index : declaration_order)
+        EmitNumber(index);
+
+    compiled_file_ << kMagic << '\n';
+    return std::move(compiled_file_);
+}
+
+bool CompiledLibraryReader::ReadNumber(uint64_t* out_value) {
+    uint64_t value = 0u;
+    size_t start = position_;
+    while (position_ < data_.size() && data_[position_] >= '0' && data_[position_] <= '9') {
+        uint64_t digit = data_[position_] - '0';
+        if (value > (UINT64_MAX - digit) / 10u)
+            return false;
+        value = value * 10u + digit;
+        ++position_;
+    }
+    if (position_ == start || position_ == data_.size() || data_[position_] != ' ')
+        return false;
+    ++position_;
+    *out_value = value;
+    return true;
+}
+
+bool CompiledLibraryReader::ReadSignedNumber(int64_t* out_value) {
+    bool negative = position_ < data_.size() && data_[position_] == '-';
+    if (negative)
+        ++position_;
+    uint64_t magnitude;
+    if (!ReadNumber(&magnitude))
+        return false;
+    if (magnitude > static_cast<uint64_t>(INT64_MAX) + negative)
+        return false;
+    *out_value = negative ? static_cast<int64_t>(0u - magnitude) : static_cast<int64_t>(magnitude);
+    return true;
+}
+
+bool CompiledLibraryReader::ReadFloat(double* out_value) {
+    size_t end = position_;
+    while (end < data_.size() && data_[end] != ' ')
+        ++end;
+    if (end == position_ || end == data_.size())
+        return false;
+    std::string token(data_.data() + position_, end - position_);
+    char* token_end = nullptr;
+    *out_value = strtod(token.c_str(), &token_end);
+    if (token_end != token.c_str() + token.size())
+        return false;
+    position_ = end + 1;
+    return true;
+}
+
+bool CompiledLibraryReader::ReadString(std::string* out_value) {
+    uint64_t size = 0u;
+    size_t start = position_;
+    while (position_ < data_.size() && data_[position_] >= '0' && data_[position_] <= '9') {
+        size = size * 10u + (data_[position_] - '0');
+        if (size > data_.size())
+            return false;
+        ++position_;
+    }
+    if (position_ == start || position_ == data_.size() || data_[position_] != ':')
+        return false;
+    ++position_;
+    if (size >= data_.size() - position_ || data_[position_ + size] != ' ')
+        return false;
+    out_value->assign(data_.data() + position_, size);
+    position_ += size + 1;
+    return true;
+}
+
+bool CompiledLibraryReader::ReadKeyword(StringView keyword) {
+    if (data_.size() - position_ <= keyword.size())
+        return false;
+    if (StringView(data_.data() + position_, keyword.size()) != keyword)
+        return false;
+    position_ += keyword.size();
+    if (data_[position_] != ' ' && data_[position_] != '\n')
+        return false;
+    ++position_;
+    return true;
+}
+
+template <typename Value>
+bool CompiledLibraryReader::ReadBoundedNumber(uint64_t bound, Value* out_value) {
+    uint64_t value;
+    if (!ReadNumber(&value) || value > bound)
+        return false;
+    *out_value = static_cast<Value>(value);
+    return true;
+}
+
+SourceLocation CompiledLibraryReader::AddLocation(const std::string& data) {
+    return library_->generated_source_file_.AddLine(data);
+}
+
+bool CompiledLibraryReader::ConsumeLibrary(const std::string& library_name,
+                                           flat::Library** out_library) {
+    auto iter = libraries_.find(library_name);
+    if (iter != libraries_.end()) {
+        *out_library = iter->second;
+        return true;
+    }
+
+    std::vector<StringView> name;
+    size_t start = 0u;
+    for (;;) {
+        size_t dot = library_name.find('.', start);
+        size_t end = dot == std::string::npos ? library_name.size() : dot;
+        name.emplace_back(library_name.data() + start, end - start);
+        if (dot == std::string::npos)
+            break;
+        start = dot + 1;
+    }
+    if (!all_libraries_->Lookup(name, out_library))
+        return false;
+    libraries_.emplace(library_name, *out_library);
+    return true;
+}
+
+bool CompiledLibraryReader::ConsumeName(flat::Name* out_name) {
+    std::string library_name;
+    uint64_t anonymous;
+    std::string name_part;
+    if (!ReadString(&library_name) || !ReadBoundedNumber(1u, &anonymous) ||
+        !ReadString(&name_part))
+        return false;
+
+    flat::Library* library = nullptr;
+    if (!library_name.empty() && !ConsumeLibrary(library_name, &library))
+        return false;
+
+    if (anonymous)
+        *out_name = flat::Name(library, name_part);
+    else
+        *out_name = flat::Name(library, AddLocation(name_part));
+    return true;
+}
+
+bool CompiledLibraryReader::ConsumeAttributes(std::unique_ptr<raw::AttributeList>* out_attributes) {
+    uint64_t present;
+    if (!ReadBoundedNumber(1u, &present))
+        return false;
+    if (!present) {
+        out_attributes->reset();
+        return true;
+    }
+    uint64_t count;
+    if (!ReadNumber(&count))
+        return false;
+    auto location = AddLocation("attributes");
+    raw::SourceElement element(Token(location, location, Token::Kind::kNotAToken, Token::Subkind::kNone),
+                               Token(location, location, Token::Kind::kNotAToken, Token::Subkind::kNone));
+    std::vector<std::unique_ptr<raw::Attribute>> attributes;
+    for (uint64_t i = 0; i < count; ++i) {
+        std::string name;
+        std::string value;
+        if (!ReadString(&name) || !ReadString(&value))
+            return false;
+        attributes.push_back(std::make_unique<raw::Attribute>(element, std::move(name), std::move(value)));
+    }
+    *out_attributes = std::make_unique<raw::AttributeList>(element, std::move(attributes));
+    return true;
+}
+
+bool CompiledLibraryReader::ConsumeOrdinal(std::unique_ptr<raw::Ordinal>* out_ordinal) {
+    uint64_t present;
+    if (!ReadBoundedNumber(1u, &present))
+        return false;
+    if (!present) {
+        out_ordinal->reset();
+        return true;
+    }
+    uint32_t value;
+    if (!ReadBoundedNumber(UINT32_MAX, &value))
+        return false;
+    auto location = AddLocation("ordinal");
+    raw::SourceElement element(Token(location, location, Token::Kind::kNotAToken, Token::Subkind::kNone),
+                               Token(location, location, Token::Kind::kNotAToken, Token::Subkind::kNone));
+    *out_ordinal = std::make_unique<raw::Ordinal>(element, value);
+    return true;
+}
+
+bool CompiledLibraryReader::ConsumeTypeShape(TypeShape* out_typeshape) {
+    uint32_t size, alignment, depth, max_handles, max_out_of_line;
+    if (!ReadBoundedNumber(UINT32_MAX, &size) || !ReadBoundedNumber(UINT32_MAX, &alignment) ||
+        !ReadBoundedNumber(UINT32_MAX, &depth) || !ReadBoundedNumber(UINT32_MAX, &max_handles) ||
+        !ReadBoundedNumber(UINT32_MAX, &max_out_of_line))
+        return false;
+    *out_typeshape = TypeShape(size, alignment, depth, max_handles, max_out_of_line);
+    return true;
+}
+
+bool CompiledLibraryReader::ConsumeFieldShape(FieldShape* out_fieldshape) {
+    TypeShape typeshape;
+    uint32_t offset;
+    if (!ConsumeTypeShape(&typeshape) || !ReadBoundedNumber(UINT32_MAX, &offset))
+        return false;
+    *out_fieldshape = FieldShape(typeshape, offset);
+    return true;
+}
+
+bool CompiledLibraryReader::ConsumeConstantValue(std::unique_ptr<flat::ConstantValue>* out_value) {
+    using Kind = flat::ConstantValue::Kind;
+    Kind kind;
+    if (!ReadBoundedNumber(static_cast<uint64_t>(Kind::kString), &kind))
+        return false;
+
+    int64_t signed_value;
+    uint64_t value;
+    double float_value;
+    switch (kind) {
+    case Kind::kInt8:
+        if (!ReadSignedNumber(&signed_value) || signed_value < INT8_MIN || signed_value > INT8_MAX)
+            return false;
+        *out_value = std::make_unique<flat::NumericConstantValue<int8_t>>(
+            static_cast<int8_t>(signed_value));
+        return true;
+    case Kind::kInt16:
+        if (!ReadSignedNumber(&signed_value) || signed_value < INT16_MIN || signed_value > INT16_MAX)
+            return false;
+        *out_value = std::make_unique<flat::NumericConstantValue<int16_t>>(
+            static_cast<int16_t>(signed_value));
+        return true;
+    case Kind::kInt32:
+        if (!ReadSignedNumber(&signed_value) || signed_value < INT32_MIN || signed_value > INT32_MAX)
+            return false;
+        *out_value = std::make_unique<flat::NumericConstantValue<int32_t>>(
+            static_cast<int32_t>(signed_value));
+        return true;
+    case Kind::kInt64:
+        if (!ReadSignedNumber(&signed_value))
+            return false;
+        *out_value = std::make_unique<flat::NumericConstantValue<int64_t>>(signed_value);
+        return true;
+    case Kind::kUint8:
+        if (!ReadBoundedNumber(UINT8_MAX, &value))
+            return false;
+        *out_value = std::make_unique<flat::NumericConstantValue<uint8_t>>(
+            static_cast<uint8_t>(value));
+        return true;
+    case Kind::kUint16:
+        if (!ReadBoundedNumber(UINT16_MAX, &value))
+            return false;
+        *out_value = std::make_unique<flat::NumericConstantValue<uint16_t>>(
+            static_cast<uint16_t>(value));
+        return true;
+    case Kind::kUint32:
+        if (!ReadBoundedNumber(UINT32_MAX, &value))
+            return false;
+        *out_value = std::make_unique<flat::NumericConstantValue<uint32_t>>(
+            static_cast<uint32_t>(value));
+        return true;
+    case Kind::kUint64:
+        if (!ReadNumber(&value))
+            return false;
+        *out_value = std::make_unique<flat::NumericConstantValue<uint64_t>>(value);
+        return true;
+    case Kind::kFloat32:
+        if (!ReadFloat(&float_value))
+            return false;
+        *out_value = std::make_unique<flat::NumericConstantValue<float>>(
+            static_cast<float>(float_value));
+        return true;
+    case Kind::kFloat64:
+        if (!ReadFloat(&float_value))
+            return false;
+        *out_value = std::make_unique<flat::NumericConstantValue<double>>(float_value);
+        return true;
+    case Kind::kBool:
+        if (!ReadBoundedNumber(1u, &value))
+            return false;
+        *out_value = std::make_unique<flat::BoolConstantValue>(value != 0u);
+        return true;
+    case Kind::kString: {
+        std::string string_value;
+        if (!ReadString(&string_value))
+            return false;
+        *out_value = std::make_unique<flat::StringConstantValue>(AddLocation(string_value).data());
+        return true;
+    }
+    }
+    return false;
+}
+
+bool CompiledLibraryReader::ConsumeConstant(std::unique_ptr<flat::Constant>* out_constant) {
+    ConstantForm form;
+    if (!ReadBoundedNumber(static_cast<uint64_t>(ConstantForm::kValue), &form))
+        return false;
+
+    std::unique_ptr<flat::ConstantValue> value;
+    switch (form) {
+    case ConstantForm::kNone:
+        out_constant->reset();
+        return true;
+    case ConstantForm::kIdentifier:
+    case ConstantForm::kResolvedIdentifier: {
+        flat::Name name;
+        if (!ConsumeName(&name))
+            return false;
+        auto constant = std::make_unique<flat::IdentifierConstant>(std::move(name));
+        if (form == ConstantForm::kResolvedIdentifier) {
+            if (!ConsumeConstantValue(&value))
+                return false;
+            constant->ResolveTo(std::move(value));
+        }
+        *out_constant = std::move(constant);
+        return true;
+    }
+    case ConstantForm::kValue:
+        if (!ConsumeConstantValue(&value))
+            return false;
+        *out_constant = std::make_unique<flat::SynthesizedConstant>(std::move(value));
+        return true;
+    }
+    return false;
+}
+
+bool CompiledLibraryReader::ConsumePrimitiveType(const flat::PrimitiveType** out_type) {
+    types::PrimitiveSubtype subtype;
+    if (!ReadBoundedNumber(static_cast<uint64_t>(types::PrimitiveSubtype::kFloat64), &subtype))
+        return false;
+    flat::Name name(nullptr, NamePrimitiveSubtype(subtype));
+    auto type = typespace_->Lookup(name, types::Nullability::kNonnullable,
+                                   flat::Typespace::LookupMode::kNoForwardReferences);
+    if (type == nullptr || type->kind != flat::Type::Kind::kPrimitive)
+        return false;
+    *out_type = static_cast<const flat::PrimitiveType*>(type);
+    return true;
+}
+
+bool CompiledLibraryReader::ConsumeType(std::unique_ptr<flat::Type>* out_type) {
+    flat::Type::Kind kind;
+    types::Nullability nullability;
+    uint32_t size;
+    if (!ReadBoundedNumber(static_cast<uint64_t>(flat::Type::Kind::kIdentifier), &kind) ||
+        !ReadBoundedNumber(static_cast<uint64_t>(types::Nullability::kNonnullable), &nullability) ||
+        !ReadBoundedNumber(UINT32_MAX, &size))
+        return false;
+    if (!ConsumeTypeOfKind(kind, nullability, out_type))
+        return false;
+    (*out_type)->size = size;
+    return true;
+}
+
+bool CompiledLibraryReader::ConsumeTypeOfKind(flat::Type::Kind kind, types::Nullability nullability,
+                                              std::unique_ptr<flat::Type>* out_type) {
+
+    // Sizes must have been resolved for the library to have compiled.
+    auto consume_size = [this](std::unique_ptr<flat::Constant>* out_size) {
+        return ConsumeConstant(out_size) && *out_size != nullptr && (*out_size)->IsResolved() &&
+               (*out_size)->Value().kind == flat::ConstantValue::Kind::kUint32;
+    };
+
+    switch (kind) {
+    case flat::Type::Kind::kArray: {
+        std::unique_ptr<flat::Type> element_type;
+        std::unique_ptr<flat::Constant> element_count;
+        if (!ConsumeType(&element_type) || !consume_size(&element_count))
+            return false;
+        *out_type = std::make_unique<flat::ArrayType>(AddLocation("array"), std::move(element_type),
+                                                      std::move(element_count));
+        return true;
+    }
+    case flat::Type::Kind::kVector: {
+        std::unique_ptr<flat::Type> element_type;
+        std::unique_ptr<flat::Constant> element_count;
+        if (!ConsumeType(&element_type) || !consume_size(&element_count))
+            return false;
+        *out_type = std::make_unique<flat::VectorType>(AddLocation("vector"), std::move(element_type),
+                                                       std::move(element_count), nullability);
+        return true;
+    }
+    case flat::Type::Kind::kString: {
+        std::unique_ptr<flat::Constant> max_size;
+        if (!consume_size(&max_size))
+            return false;
+        *out_type = std::make_unique<flat::StringType>(AddLocation("string"), std::move(max_size),
+                                                       nullability);
+        return true;
+    }
+    case flat::Type::Kind::kHandle: {
+        types::HandleSubtype subtype;
+        if (!ReadBoundedNumber(UINT32_MAX, &subtype))
+            return false;
+        *out_type = std::make_unique<flat::HandleType>(subtype, nullability);
+        return true;
+    }
+    case flat::Type::Kind::kRequestHandle: {
+        flat::Name name;
+        if (!ConsumeName(&name))
+            return false;
+        *out_type = std::make_unique<flat::RequestHandleType>(std::move(name), nullability);
+        return true;
+    }
+    case flat::Type::Kind::kPrimitive: {
+        const flat::PrimitiveType* primitive_type;
+        if (!ConsumePrimitiveType(&primitive_type))
+            return false;
+        *out_type = std::make_unique<flat::PrimitiveType>(primitive_type->subtype);
+        return true;
+    }
+    case flat::Type::Kind::kIdentifier: {
+        flat::Name name;
+        if (!ConsumeName(&name))
+            return false;
+        *out_type = std::make_unique<flat::IdentifierType>(std::move(name), nullability);
+        return true;
+    }
+    }
+    return false;
+}
+
+bool CompiledLibraryReader::ConsumeStruct(flat::Struct** out_struct) {
+    uint64_t index;
+    if (!ReadNumber(&index) || index > library_->struct_declarations_.size())
+        return false;
+    *out_struct = index == 0u ? nullptr : library_->struct_declarations_[index - 1].get();
+    return true;
+}
+
+bool CompiledLibraryReader::ConsumeConstDecl() {
+    flat::Name name;
+    std::unique_ptr<raw::AttributeList> attributes;
+    std::unique_ptr<flat::Type> type;
+    std::unique_ptr<flat::Constant> value;
+    if (!ConsumeName(&name) || !ConsumeAttributes(&attributes) || !ConsumeType(&type) ||
+        !ConsumeConstant(&value) || value == nullptr || !value->IsResolved())
+        return false;
+    library_->const_declarations_.push_back(std::make_unique<flat::Const>(
+        std::move(attributes), std::move(name), std::move(type), std::move(value)));
+    auto decl = library_->const_declarations_.back().get();
+    library_->constants_.emplace(&decl->name, decl);
+    decls_.push_back(decl);
+    return true;
+}
+
+bool CompiledLibraryReader::ConsumeEnumDecl() {
+    flat::Name name;
+    std::unique_ptr<raw::AttributeList> attributes;
+    const flat::PrimitiveType* type;
+    TypeShape typeshape;
+    uint64_t count;
+    if (!ConsumeName(&name) || !ConsumeAttributes(&attributes) || !ConsumePrimitiveType(&type) ||
+        !ConsumeTypeShape(&typeshape) || !ReadNumber(&count))
+        return false;
+    std::vector<flat::Enum::Member> members;
+    for (uint64_t i = 0; i < count; ++i) {
+        std::string member_name;
+        std::unique_ptr<flat::Constant> value;
+        std::unique_ptr<raw::AttributeList> member_attributes;
+        if (!ReadString(&member_name) || !ConsumeConstant(&value) || value == nullptr ||
+            !value->IsResolved() || !ConsumeAttributes(&member_attributes))
+            return false;
+        members.emplace_back(AddLocation(member_name), std::move(value), std::move(member_attributes));
+    }
+    library_->enum_declarations_.push_back(std::make_unique<flat::Enum>(
+        std::move(attributes), std::move(name), nullptr, std::move(members)));
+    auto decl = library_->enum_declarations_.back().get();
+    decl->type = type;
+    decl->typeshape = typeshape;
+    decls_.push_back(decl);
+    return true;
+}
+
+bool CompiledLibraryReader::ConsumeInterfaceDecl() {
+    flat::Name name;
+    std::unique_ptr<raw::AttributeList> attributes;
+    uint64_t count;
+    if (!ConsumeName(&name) || !ConsumeAttributes(&attributes) || !ReadNumber(&count))
+        return false;
+    std::vector<flat::Name> superinterfaces;
+    for (uint64_t i = 0; i < count; ++i) {
+        flat::Name superinterface;
+        if (!ConsumeName(&superinterface))
+            return false;
+        superinterfaces.push_back(std::move(superinterface));
+    }
+
+    if (!ReadNumber(&count))
+        return false;
+    std::vector<flat::Interface::Method> methods;
+    for (uint64_t i = 0; i < count; ++i) {
+        std::unique_ptr<raw::AttributeList> method_attributes;
+        std::unique_ptr<raw::Ordinal> ordinal;
+        std::unique_ptr<raw::Ordinal> generated_ordinal;
+        std::string method_name;
+        flat::Struct* maybe_request;
+        flat::Struct* maybe_response;
+        if (!ConsumeAttributes(&method_attributes) || !ConsumeOrdinal(&ordinal) ||
+            ordinal == nullptr || !ConsumeOrdinal(&generated_ordinal) ||
+            !ReadString(&method_name) || !ConsumeStruct(&maybe_request) ||
+            !ConsumeStruct(&maybe_response) ||
+            (maybe_request == nullptr && maybe_response == nullptr))
+            return false;
+        methods.emplace_back(std::move(method_attributes), std::move(ordinal),
+                             std::move(generated_ordinal), AddLocation(method_name),
+                             maybe_request, maybe_response);
+    }
+
+    library_->interface_declarations_.push_back(std::make_unique<flat::Interface>(
+        std::move(attributes), std::move(name), std::move(superinterfaces), std::move(methods)));
+    auto decl = library_->interface_declarations_.back().get();
+    decls_.push_back(decl);
+
+    if (!ReadNumber(&count))
+        return false;
+    for (uint64_t i = 0; i < count; ++i) {
+        flat::Name interface_name;
+        uint64_t index;
+        if (!ConsumeName(&interface_name) || !ReadNumber(&index))
+            return false;
+        method_references_.push_back({decl, std::move(interface_name), index});
+    }
+    return true;
+}
+
+bool CompiledLibraryReader::ConsumeStructDecl() {
+    flat::Name name;
+    std::unique_ptr<raw::AttributeList> attributes;
+    uint64_t anonymous;
+    uint64_t recursive;
+    TypeShape typeshape;
+    uint64_t count;
+    if (!ConsumeName(&name) || !ConsumeAttributes(&attributes) ||
+        !ReadBoundedNumber(1u, &anonymous) || !ReadBoundedNumber(1u, &recursive) ||
+        !ConsumeTypeShape(&typeshape) || !ReadNumber(&count))
+        return false;
+    std::vector<flat::Struct::Member> members;
+    for (uint64_t i = 0; i < count; ++i) {
+        std::unique_ptr<flat::Type> type;
+        std::string member_name;
+        std::unique_ptr<flat::Constant> maybe_default_value;
+        std::unique_ptr<raw::AttributeList> member_attributes;
+        FieldShape fieldshape;
+        if (!ConsumeType(&type) || !ReadString(&member_name) ||
+            !ConsumeConstant(&maybe_default_value) || !ConsumeAttributes(&member_attributes) ||
+            !ConsumeFieldShape(&fieldshape))
+            return false;
+        members.emplace_back(std::move(type), AddLocation(member_name),
+                             std::move(maybe_default_value), std::move(member_attributes));
+        members.back().fieldshape = fieldshape;
+    }
+    library_->struct_declarations_.push_back(std::make_unique<flat::Struct>(
+        std::move(attributes), std::move(name), std::move(members), anonymous != 0u));
+    auto decl = library_->struct_declarations_.back().get();
+    decl->typeshape = typeshape;
+    decl->recursive = recursive != 0u;
+    decls_.push_back(decl);
+    return true;
+}
+
+bool CompiledLibraryReader::ConsumeTableDecl() {
+    flat::Name name;
+    std::unique_ptr<raw::AttributeList> attributes;
+    uint64_t recursive;
+    TypeShape typeshape;
+    uint64_t count;
+    if (!ConsumeName(&name) || !ConsumeAttributes(&attributes) ||
+        !ReadBoundedNumber(1u, &recursive) || !ConsumeTypeShape(&typeshape) || !ReadNumber(&count))
+        return false;
+    std::vector<flat::Table::Member> members;
+    for (uint64_t i = 0; i < count; ++i) {
+        std::unique_ptr<raw::Ordinal> ordinal;
+        uint64_t used;
+        if (!ConsumeOrdinal(&ordinal) || ordinal == nullptr || !ReadBoundedNumber(1u, &used))
+            return false;
+        if (!used) {
+            members.emplace_back(std::move(ordinal));
+            continue;
+        }
+        std::unique_ptr<flat::Type> type;
+        std::string member_name;
+        std::unique_ptr<flat::Constant> maybe_default_value;
+        std::unique_ptr<raw::AttributeList> member_attributes;
+        TypeShape member_typeshape;
+        if (!ConsumeType(&type) || !ReadString(&member_name) ||
+            !ConsumeConstant(&maybe_default_value) || !ConsumeAttributes(&member_attributes) ||
+            !ConsumeTypeShape(&member_typeshape))
+            return false;
+        members.emplace_back(std::move(ordinal), std::move(type), AddLocation(member_name),
+                             std::move(maybe_default_value), std::move(member_attributes));
+        members.back().maybe_used->typeshape = member_typeshape;
+    }
+    library_->table_declarations_.push_back(std::make_unique<flat::Table>(
+        std::move(attributes), std::move(name), std::move(members)));
+    auto decl = library_->table_declarations_.back().get();
+    decl->typeshape = typeshape;
+    decl->recursive = recursive != 0u;
+    decls_.push_back(decl);
+    return true;
+}
+
+bool CompiledLibraryReader::ConsumeUnionDecl() {
+    flat::Name name;
+    std::unique_ptr<raw::AttributeList> attributes;
+    uint64_t recursive;
+    TypeShape typeshape;
+    FieldShape membershape;
+    uint64_t count;
+    if (!ConsumeName(&name) || !ConsumeAttributes(&attributes) ||
+        !ReadBoundedNumber(1u, &recursive) || !ConsumeTypeShape(&typeshape) ||
+        !ConsumeFieldShape(&membershape) || !ReadNumber(&count))
+        return false;
+    std::vector<flat::Union::Member> members;
+    for (uint64_t i = 0; i < count; ++i) {
+        std::unique_ptr<flat::Type> type;
+        std::string member_name;
+        std::unique_ptr<raw::AttributeList> member_attributes;
+        FieldShape fieldshape;
+        if (!ConsumeType(&type) || !ReadString(&member_name) ||
+            !ConsumeAttributes(&member_attributes) || !ConsumeFieldShape(&fieldshape))
+            return false;
+        members.emplace_back(std::move(type), AddLocation(member_name), std::move(member_attributes));
+        members.back().fieldshape = fieldshape;
+    }
+    library_->union_declarations_.push_back(std::make_unique<flat::Union>(
+        std::move(attributes), std::move(name), std::move(members)));
+    auto decl = library_->union_declarations_.back().get();
+    decl->typeshape = typeshape;
+    decl->membershape = membershape;
+    decl->recursive = recursive != 0u;
+    decls_.push_back(decl);
+    return true;
+}
+
+bool CompiledLibraryReader::ConsumeXUnionDecl() {
+    flat::Name name;
+    std::unique_ptr<raw::AttributeList> attributes;
+    uint64_t recursive;
+    TypeShape typeshape;
+    uint64_t count;
+    if (!ConsumeName(&name) || !ConsumeAttributes(&attributes) ||
+        !ReadBoundedNumber(1u, &recursive) || !ConsumeTypeShape(&typeshape) || !ReadNumber(&count))
+        return false;
+    std::vector<flat::XUnion::Member> members;
+    for (uint64_t i = 0; i < count; ++i) {
+        std::unique_ptr<raw::Ordinal> ordinal;
+        std::unique_ptr<flat::Type> type;
+        std::string member_name;
+        std::unique_ptr<raw::AttributeList> member_attributes;
+        FieldShape fieldshape;
+        if (!ConsumeOrdinal(&ordinal) || ordinal == nullptr || !ConsumeType(&type) ||
+            !ReadString(&member_name) || !ConsumeAttributes(&member_attributes) ||
+            !ConsumeFieldShape(&fieldshape))
+            return false;
+        members.emplace_back(std::move(ordinal), std::move(type), AddLocation(member_name),
+                             std::move(member_attributes));
+        members.back().fieldshape = fieldshape;
+    }
+    library_->xunion_declarations_.push_back(std::make_unique<flat::XUnion>(
+        std::move(attributes), std::move(name), std::move(members)));
+    auto decl = library_->xunion_declarations_.back().get();
+    decl->typeshape = typeshape;
+    decl->recursive = recursive != 0u;
+    decls_.push_back(decl);
+    return true;
+}
+
+bool CompiledLibraryReader::ConsumeDecls(bool (CompiledLibraryReader::*consume)()) {
+    uint64_t count;
+    if (!ReadNumber(&count))
+        return false;
+    for (uint64_t i = 0; i < count; ++i) {
+        if (!(this->*consume)())
+            return false;
+    }
+    return true;
+}
+
+std::unique_ptr<flat::Library> CompiledLibraryReader::Consume() {
+    uint64_t version;
+    if (!ReadKeyword(kMagic) || !ReadNumber(&version) || version != kCompiledLibraryVersion)
+        return nullptr;
+
+    library_ = std::make_unique<flat::Library>(all_libraries_, error_reporter_, typespace_);
+
+    uint64_t count;
+    if (!ReadNumber(&count) || count == 0u)
+        return nullptr;
+    for (uint64_t i = 0; i < count; ++i) {
+        std::string component;
+        if (!ReadString(&component))
+            return nullptr;
+        library_->library_name_.push_back(AddLocation(component).data());
+    }
+    libraries_.emplace(flat::LibraryName(library_.get(), "."), library_.get());
+    if (!ConsumeAttributes(&library_->attributes_))
+        return nullptr;
+
+    // Import the declarations of the dependencies, as the library did when
+    // consuming its `using` directives.
+    if (!ReadNumber(&count))
+        return nullptr;
+    std::unique_ptr<raw::Identifier> no_alias;
+    for (uint64_t i = 0; i < count; ++i) {
+        std::string dep_name;
+        if (!ReadString(&dep_name))
+            return nullptr;
+        flat::Library* dep_library = nullptr;
+        if (!ConsumeLibrary(dep_name, &dep_library))
+            return nullptr;
+        if (!library_->dependencies_.Register(library_->generated_source_file_.filename(),
+                                              dep_library, no_alias))
+            return nullptr;
+        library_->declarations_.insert(dep_library->declarations_.begin(),
+                                       dep_library->declarations_.end());
+        library_->type_aliases_.insert(dep_library->type_aliases_.begin(),
+                                       dep_library->type_aliases_.end());
+        library_->constants_.insert(dep_library->constants_.begin(),
+                                    dep_library->constants_.end());
+    }
+
+    if (!ReadNumber(&count))
+        return nullptr;
+    for (uint64_t i = 0; i < count; ++i) {
+        std::string alias_name;
+        const flat::PrimitiveType* type;
+        if (!ReadString(&alias_name) || !ConsumePrimitiveType(&type))
+            return nullptr;
+        auto alias = std::make_unique<flat::Using>(
+            flat::Name(library_.get(), AddLocation(alias_name)), type);
+        library_->type_aliases_.emplace(&alias->name, alias.get());
+        library_->using_.push_back(std::move(alias));
+    }
+
+    if (!ConsumeDecls(&CompiledLibraryReader::ConsumeConstDecl) ||
+        !ConsumeDecls(&CompiledLibraryReader::ConsumeEnumDecl) ||
+        !ConsumeDecls(&CompiledLibraryReader::ConsumeStructDecl) ||
+        !ConsumeDecls(&CompiledLibraryReader::ConsumeTableDecl) ||
+        !ConsumeDecls(&CompiledLibraryReader::ConsumeUnionDecl) ||
+        !ConsumeDecls(&CompiledLibraryReader::ConsumeXUnionDecl) ||
+        !ConsumeDecls(&CompiledLibraryReader::ConsumeInterfaceDecl))
+        return nullptr;
+
+    for (auto* decl : decls_) {
+        decl->compiled = true;
+        if (!library_->declarations_.emplace(&decl->name, decl).second)
+            return nullptr;
+    }
+
+    for (const auto& reference : method_references_) {
+        auto decl = library_->LookupDeclByName(reference.interface_name);
+        if (decl == nullptr || decl->kind != flat::Decl::Kind::kInterface)
+            return nullptr;
+        auto interface = static_cast<const flat::Interface*>(decl);
+        if (reference.index >= interface->methods.size())
+            return nullptr;
+        reference.interface->all_methods.push_back(&interface->methods[reference.index]);
+    }
+
+    if (!ReadNumber(&count))
+        return nullptr;
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t index;
+        if (!ReadNumber(&index) || index >= decls_.size())
+            return nullptr;
+        library_->declaration_order_.push_back(decls_[index]);
+    }
+
+    if (!ReadKeyword(kMagic) || position_ != data_.size())
+        return nullptr;
+    return std::move(library_);
+}
+
+} // namespace fidl
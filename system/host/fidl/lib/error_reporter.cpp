@@ -98,6 +98,13 @@ void ErrorReporter::ReportWarning(const SourceLocation& location, StringView mes
     warnings_.push_back(std::move(error));
 }
 
+// Merge records the errors and warnings of another reporter after those
+// already recorded, e.g. those of a source file parsed on another thread.
+void ErrorReporter::Merge(const ErrorReporter& other) {
+    errors_.insert(errors_.end(), other.errors_.begin(), other.errors_.end());
+    warnings_.insert(warnings_.end(), other.warnings_.begin(), other.warnings_.end());
+}
+
 void ErrorReporter::PrintReports() {
     for (const auto& error : errors_) {
         fprintf(stderr, "%s\n", error.data());
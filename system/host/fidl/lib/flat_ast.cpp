@@ -2590,6 +2590,13 @@ bool Library::Compile() {
     // example, we process a struct member's type before the entire
     // struct.
     for (Decl* decl : declaration_order_) {
+        // Declarations imported from dependencies were compiled along with
+        // their own library.
+        if (decl->name.library() != this) {
+            assert(decl->compiled);
+            continue;
+        }
+
         switch (decl->kind) {
         case Decl::Kind::kConst: {
             auto const_decl = static_cast<Const*>(decl);
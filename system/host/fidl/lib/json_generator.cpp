@@ -610,12 +610,17 @@ std::ostringstream JSONGenerator::Produce() {
 
         GenerateObjectPunctuation(Position::kSubsequent);
         EmitObjectKey(&json_file_, indent_level_, "library_dependencies");
-        std::vector<flat::Library*> dependencies;
+        // Dependencies are in pointer order... change to a deterministic
+        // ordering prior to output.
+        std::map<std::string, flat::Library*> dependencies_by_name;
         for (const auto& dep_library : library_->dependencies()) {
             if (dep_library->HasAttribute("Internal"))
                 continue;
-            dependencies.push_back(dep_library);
+            dependencies_by_name.emplace(LibraryName(dep_library, "."), dep_library);
         }
+        std::vector<flat::Library*> dependencies;
+        for (const auto& dep_library : dependencies_by_name)
+            dependencies.push_back(dep_library.second);
 
         GenerateArray(dependencies.begin(), dependencies.end());
 
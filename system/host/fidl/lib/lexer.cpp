@@ -5,12 +5,82 @@
 #include "fidl/lexer.h"
 
 #include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
 #include <map>
 
 namespace fidl {
 
 namespace {
 
+// The identifier and whitespace scanners below classify a 64-bit word of
+// source at a time, which only maps bytes to their position in the source on
+// little endian hosts. Big endian hosts scan a character at a time.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+constexpr bool kScanWords = true;
+#else
+constexpr bool kScanWords = false;
+#endif
+
+constexpr uint64_t kLowBytes = ~0ull / 255u;
+constexpr uint64_t kHighBits = kLowBytes * 128u;
+
+// Returns a word with the high bit of each byte set exactly when that byte of
+// |word| is ASCII, and strictly between |low| and |high|. |low| must be at most
+// 127, and |high| at most 128. No byte carries into its neighbour.
+constexpr uint64_t BytesBetween(uint64_t word, uint64_t low, uint64_t high) {
+    return (kLowBytes * (127u + high) - (word & kLowBytes * 127u)) & ~word &
+           ((word & kLowBytes * 127u) + kLowBytes * (127u - low)) & kHighBits;
+}
+
+constexpr uint64_t BytesEqual(uint64_t word, char c) {
+    return BytesBetween(word, c - 1, c + 1);
+}
+
+uint64_t IdentifierBodyBytes(uint64_t word) {
+    return BytesBetween(word, 'a' - 1, 'z' + 1) | BytesBetween(word, 'A' - 1, 'Z' + 1) |
+           BytesBetween(word, '0' - 1, '9' + 1) | BytesEqual(word, '_');
+}
+
+uint64_t WhitespaceBytes(uint64_t word) {
+    // '\t' and '\n' are adjacent.
+    return BytesBetween(word, '\t' - 1, '\n' + 1) | BytesEqual(word, '\r') |
+           BytesEqual(word, ' ');
+}
+
+// Returns the number of leading characters of |data| (up to |end|) for which
+// |word_class| sets the high bit, and |char_class| returns true.
+template <uint64_t (*word_class)(uint64_t), bool (*char_class)(char)>
+size_t ScanClass(const char* data, const char* end) {
+    const char* current = data;
+    if (kScanWords) {
+        while (end - current >= static_cast<ptrdiff_t>(sizeof(uint64_t))) {
+            uint64_t word;
+            memcpy(&word, current, sizeof(word));
+            uint64_t stop = ~word_class(word) & kHighBits;
+            if (stop != 0u)
+                return current - data + __builtin_ctzll(stop) / 8u;
+            current += sizeof(word);
+        }
+    }
+    while (current < end && char_class(*current))
+        ++current;
+    return current - data;
+}
+
+bool IsWhitespace(char c) {
+    switch (c) {
+    case ' ':
+    case '\n':
+    case '\r':
+    case '\t':
+        return true;
+    default:
+        return false;
+    }
+}
+
 bool IsIdentifierBody(char c) {
     switch (c) {
     case 'a':
@@ -125,6 +195,15 @@ bool IsNumericLiteralBody(char c) {
 
 } // namespace
 
+const std::map<StringView, Token::Subkind>& Lexer::KeywordTable() {
+    static const std::map<StringView, Token::Subkind> keyword_table = {
+#define KEYWORD(Name, Spelling) {Spelling, Token::Subkind::k##Name},
+#include "fidl/token_definitions.inc"
+#undef KEYWORD
+    };
+    return keyword_table;
+}
+
 constexpr char Lexer::Peek() const {
     return *current_;
 }
@@ -134,6 +213,11 @@ void Lexer::Skip() {
     ++token_start_;
 }
 
+void Lexer::Skip(size_t count) {
+    current_ += count;
+    token_start_ += count;
+}
+
 char Lexer::Consume() {
     auto current = *current_;
     ++current_;
@@ -141,6 +225,11 @@ char Lexer::Consume() {
     return current;
 }
 
+void Lexer::Consume(size_t count) {
+    current_ += count;
+    token_size_ += count;
+}
+
 StringView Lexer::Reset(Token::Kind kind) {
     auto data = StringView(token_start_, token_size_);
     if (kind != Token::Kind::kComment) {
@@ -170,8 +259,7 @@ Token Lexer::LexNumericLiteral() {
 }
 
 Token Lexer::LexIdentifier() {
-    while (IsIdentifierBody(Peek()))
-        Consume();
+    Consume(ScanClass<IdentifierBodyBytes, IsIdentifierBody>(current_, end()));
     StringView previous(previous_end_, token_start_ - previous_end_);
     SourceLocation previous_end(previous, source_file_);
     StringView identifier_data = Reset(Token::Kind::kIdentifier);
@@ -228,32 +316,13 @@ Token Lexer::LexCommentOrDocComment() {
     }
 
     // Lexing a C++-style // comment. Go to the end of the line or
-    // file.
-    for (;;) {
-        switch (Peek()) {
-        case 0:
-        case '\n':
-            return Finish(comment_type);
-        default:
-            Consume();
-            continue;
-        }
-    }
+    // file. The source is NUL terminated, so strcspn stops at either.
+    Consume(strcspn(current_, "\n"));
+    return Finish(comment_type);
 }
 
 void Lexer::SkipWhitespace() {
-    for (;;) {
-        switch (Peek()) {
-        case ' ':
-        case '\n':
-        case '\r':
-        case '\t':
-            Skip();
-            continue;
-        default:
-            return;
-        }
-    }
+    Skip(ScanClass<WhitespaceBytes, IsWhitespace>(current_, end()));
 }
 
 Token Lexer::LexNoComments() {
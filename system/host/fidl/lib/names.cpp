@@ -483,6 +483,22 @@ std::string NameFields(StringView name) {
     return fields_name;
 }
 
+std::string NameCoder(StringView type_name) {
+    return std::string(type_name) + "Coder";
+}
+
+std::string NameEncode(StringView type_name) {
+    return std::string(type_name) + "Encode";
+}
+
+std::string NameDecode(StringView type_name) {
+    return std::string(type_name) + "Decode";
+}
+
+std::string NameValidate(StringView type_name) {
+    return std::string(type_name) + "Validate";
+}
+
 std::string NameCodedStruct(const flat::Struct* struct_decl) {
     return NameName(struct_decl->name, "_", "_");
 }
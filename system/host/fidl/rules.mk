@@ -14,6 +14,9 @@ MODULE_COMPILEFLAGS := -O0 -g
 
 MODULE_SRCS := \
     $(LOCAL_DIR)/lib/attributes.cpp \
+    $(LOCAL_DIR)/lib/coded_types_generator.cpp \
+    $(LOCAL_DIR)/lib/coders_generator.cpp \
+    $(LOCAL_DIR)/lib/compiled_library.cpp \
     $(LOCAL_DIR)/lib/c_generator.cpp \
     $(LOCAL_DIR)/lib/error_reporter.cpp \
     $(LOCAL_DIR)/lib/flat_ast.cpp \
@@ -36,6 +36,8 @@ int usage(void) {
     fprintf(stderr, " --length [bytes] - length of container within file (fvm only)\n");
     fprintf(stderr, " --compress - specify that file should be compressed (sparse only)\n");
     fprintf(stderr, " --disk [bytes] - Size of target disk (valid for size command only)\n");
+    fprintf(stderr, " --threads [count] - number of threads used for compression (sparse only,"
+                    " default: one per core)\n");
     fprintf(stderr, "Input options:\n");
     fprintf(stderr, " --blob [path] - Add path as blob type (must be blobfs)\n");
     fprintf(stderr, " --data [path] - Add path as encrypted data type (must be minfs)\n");
@@ -125,6 +127,7 @@ int main(int argc, char** argv) {
     size_t disk_size = 0;
     bool should_unlink = true;
     uint32_t flags = 0;
+    unsigned compression_threads = 0;
     while (i < argc) {
         if (!strcmp(argv[i], "--slice") && i + 1 < argc) {
             if (parse_size(argv[++i], &slice_size) < 0) {
@@ -157,6 +160,13 @@ int main(int argc, char** argv) {
             if (parse_size(argv[++i], &disk_size) < 0) {
                 return -1;
             }
+        } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            char* end;
+            compression_threads = static_cast<unsigned>(strtoul(argv[++i], &end, 10));
+            if (end[0] || compression_threads == 0) {
+                fprintf(stderr, "Bad thread count: %s\n", argv[i]);
+                return -1;
+            }
         } else {
             break;
         }
@@ -237,6 +247,8 @@ int main(int argc, char** argv) {
             return -1;
         }
 
+        sparseContainer->SetCompressionThreads(compression_threads);
+
         if (add_partitions(sparseContainer.get(), argc - i, argv + i) < 0) {
             return -1;
         }
@@ -13,9 +13,11 @@
 #include <sys/types.h>
 #include <thread>
 #include <unistd.h>
+#include <utility>
 #include <vector>
 
 #include <digest/digest.h>
+#include <digest/merkle-cache.h>
 #include <digest/merkle-tree.h>
 #include <fbl/alloc_checker.h>
 #include <fbl/unique_fd.h>
@@ -24,6 +26,8 @@
 namespace {
 
 using digest::Digest;
+using digest::MerkleCache;
+using digest::MerkleCacheEntry;
 using digest::MerkleTree;
 
 struct FileEntry {
@@ -32,8 +36,10 @@ struct FileEntry {
 };
 
 void usage(char** argv) {
-    fprintf(stderr, "Usage: %s [-o OUTPUT | -m MANIFEST] FILE...\n", argv[0]);
+    fprintf(stderr, "Usage: %s [-c CACHE] [-o OUTPUT | -m MANIFEST] FILE...\n", argv[0]);
     fprintf(stderr, "\n\
+With -c, the Merkle trees of files unchanged since an earlier run are read from\n\
+the cache directory CACHE instead of being recomputed.\n\
 With -o, OUTPUT gets the same format normally written to stdout: HASH - FILE.\n\
 With -m, MANIFEST gets \"manifest file\" format: HASH=FILE.\n\
 Any argument may be \"@RSPFILE\" to be replaced with the contents of RSPFILE.\n\
@@ -68,7 +74,7 @@ int handle_argument(char** argv, const char* arg,
     }
 }
 
-void handle_entry(FileEntry* entry) {
+void handle_entry(const MerkleCache* cache, FileEntry* entry) {
     fbl::unique_fd fd{open(entry->filename.c_str(), O_RDONLY)};
     if (!fd) {
         perror(entry->filename.c_str());
@@ -84,6 +90,12 @@ void handle_entry(FileEntry* entry) {
         return;
     }
 
+    MerkleCacheEntry cached;
+    if (cache && cache->Lookup(entry->filename.c_str(), info, &cached) == ZX_OK) {
+        cached.digest.ToString(entry->digest, sizeof(entry->digest));
+        return;
+    }
+
     // Buffer one intermediate node's worth at a time.
     fbl::unique_ptr<uint8_t[]> tree;
     Digest digest;
@@ -119,6 +131,16 @@ void handle_entry(FileEntry* entry) {
                 entry->filename.c_str(), rc);
         exit(1);
     }
+
+    if (cache) {
+        // The cache only saves work, so failing to update it is not fatal.
+        cached.digest = std::move(digest);
+        cached.length = info.st_size;
+        cached.tree.reset(tree.release(), len);
+        if (cache->Store(entry->filename.c_str(), info, cached) != ZX_OK) {
+            fprintf(stderr, "%s: Unable to cache Merkle tree\n", entry->filename.c_str());
+        }
+    }
 }
 
 } // namespace
@@ -130,17 +152,28 @@ int main(int argc, char** argv) {
     }
 
     int argi = 1;
-    bool manifest = !strcmp(argv[1], "-m");
-    if (manifest || !strcmp(argv[1], "-o")) {
-        if (argc < 4) {
+    fbl::unique_ptr<MerkleCache> cache;
+    if (!strcmp(argv[argi], "-c")) {
+        if (argc < argi + 3) {
+            usage(argv);
+        }
+        if (MerkleCache::Create(argv[argi + 1], &cache) != ZX_OK) {
+            return 1;
+        }
+        argi += 2;
+    }
+
+    bool manifest = !strcmp(argv[argi], "-m");
+    if (manifest || !strcmp(argv[argi], "-o")) {
+        if (argc < argi + 3) {
             usage(argv);
         }
-        argi = 3;
-        outf = fopen(argv[2], "w");
+        outf = fopen(argv[argi + 1], "w");
         if (!outf) {
-            perror(argv[2]);
+            perror(argv[argi + 1]);
             return 1;
         }
+        argi += 2;
     }
 
     std::vector<FileEntry> entries;
@@ -168,7 +201,7 @@ int main(int argc, char** argv) {
                 if (j >= entries.size()) {
                     return;
                 }
-                handle_entry(&entries[j]);
+                handle_entry(cache.get(), &entries[j]);
             }
         }));
     }
@@ -22,6 +22,7 @@ HOSTAPPS := \
     $(LOCAL_DIR)/mkkdtb/rules.mk \
     $(LOCAL_DIR)/netprotocol/rules.mk \
     $(LOCAL_DIR)/runtests/rules.mk \
+    $(LOCAL_DIR)/trace-reader-benchmark/rules.mk \
     $(LOCAL_DIR)/xdc-server/rules.mk \
     $(LOCAL_DIR)/zbi/rules.mk \
 
@@ -0,0 +1,359 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares reading events from a large trace file sequentially with
+// |trace::TraceReader| against querying it with |trace::MappedTraceReader|.
+// Unless given a trace file, it writes a synthetic one of the requested
+// size first.
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <utility>
+
+#include <fbl/algorithm.h>
+#include <fbl/string.h>
+#include <fbl/string_printf.h>
+#include <fbl/unique_ptr.h>
+#include <fbl/vector.h>
+#include <trace-engine/fields.h>
+#include <trace-reader/mapped_reader.h>
+#include <trace-reader/reader.h>
+
+namespace {
+
+constexpr size_t kDefaultTraceSizeMb = 1024;
+constexpr size_t kDefaultNumThreads = 8;
+
+constexpr trace::ProviderId kNumProviders = 4;
+constexpr trace_thread_index_t kThreadsPerProvider = 4;
+constexpr trace_string_index_t kNumCategories = 8;
+constexpr trace_string_index_t kNumNames = 16;
+// Providers take turns writing sections of this many events, as they do
+// in the traces written by the trace manager.
+constexpr size_t kEventsPerSection = 16384;
+
+constexpr const char* kOutputPrefix = "  - ";
+
+uint64_t NowInNsecs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void PrintRate(const char* what, uint64_t start_ns, size_t num_events) {
+    double seconds = static_cast<double>(NowInNsecs() - start_ns) / 1e9;
+    printf("%s%s: %zu events in %.3f s, %.0f events per second\n",
+           kOutputPrefix, what, num_events, seconds,
+           static_cast<double>(num_events) / seconds);
+}
+
+uint64_t MakeHeader(trace::RecordType type, size_t size_words) {
+    return trace::RecordFields::Type::Make(trace::ToUnderlyingType(type)) |
+           trace::RecordFields::RecordSize::Make(size_words);
+}
+
+// Writes a synthetic trace to a file, buffering the words.
+class TraceWriter {
+public:
+    explicit TraceWriter(FILE* file) : file_(file) {}
+    ~TraceWriter() { Flush(); }
+
+    void ProviderInfo(trace::ProviderId id, const char* name) {
+        size_t length = strlen(name);
+        Append(MakeHeader(trace::RecordType::kMetadata, 1 + trace::BytesToWords(length)) |
+               trace::MetadataRecordFields::MetadataType::Make(
+                   trace::ToUnderlyingType(trace::MetadataType::kProviderInfo)) |
+               trace::ProviderInfoMetadataRecordFields::Id::Make(id) |
+               trace::ProviderInfoMetadataRecordFields::NameLength::Make(length));
+        AppendString(name, length);
+    }
+
+    void ProviderSection(trace::ProviderId id) {
+        Append(MakeHeader(trace::RecordType::kMetadata, 1) |
+               trace::MetadataRecordFields::MetadataType::Make(
+                   trace::ToUnderlyingType(trace::MetadataType::kProviderSection)) |
+               trace::ProviderSectionMetadataRecordFields::Id::Make(id));
+    }
+
+    void String(trace_string_index_t index, const char* string) {
+        size_t length = strlen(string);
+        Append(MakeHeader(trace::RecordType::kString, 1 + trace::BytesToWords(length)) |
+               trace::StringRecordFields::StringIndex::Make(index) |
+               trace::StringRecordFields::StringLength::Make(length));
+        AppendString(string, length);
+    }
+
+    void Thread(trace_thread_index_t index, zx_koid_t process_koid, zx_koid_t thread_koid) {
+        Append(MakeHeader(trace::RecordType::kThread, 3) |
+               trace::ThreadRecordFields::ThreadIndex::Make(index));
+        Append(process_koid);
+        Append(thread_koid);
+    }
+
+    void Event(trace_ticks_t timestamp, trace_thread_index_t thread,
+               trace_string_index_t category, trace_string_index_t name) {
+        Append(MakeHeader(trace::RecordType::kEvent, 2) |
+               trace::EventRecordFields::EventType::Make(
+                   trace::ToUnderlyingType(trace::EventType::kDurationBegin)) |
+               trace::EventRecordFields::ThreadRef::Make(thread) |
+               trace::EventRecordFields::CategoryStringRef::Make(category) |
+               trace::EventRecordFields::NameStringRef::Make(name));
+        Append(timestamp);
+    }
+
+    size_t bytes_written() const { return bytes_written_; }
+
+    bool Flush() {
+        size_t count = fwrite(buffer_, sizeof(uint64_t), num_words_, file_);
+        bool ok = count == num_words_;
+        num_words_ = 0u;
+        return ok;
+    }
+
+private:
+    void Append(uint64_t word) {
+        if (num_words_ == fbl::count_of(buffer_))
+            Flush();
+        buffer_[num_words_++] = word;
+        bytes_written_ += sizeof(uint64_t);
+    }
+
+    void AppendString(const char* string, size_t length) {
+        for (size_t i = 0; i < length; i += sizeof(uint64_t)) {
+            uint64_t word = 0u;
+            memcpy(&word, string + i, fbl::min(sizeof(uint64_t), length - i));
+            Append(word);
+        }
+    }
+
+    FILE* const file_;
+    uint64_t buffer_[64 * 1024];
+    size_t num_words_ = 0u;
+    size_t bytes_written_ = 0u;
+};
+
+void DefineStrings(TraceWriter* writer) {
+    for (trace_string_index_t i = 0; i < kNumCategories; ++i) {
+        writer->String(1 + i, fbl::StringPrintf("category%u", i).c_str());
+    }
+    for (trace_string_index_t i = 0; i < kNumNames; ++i) {
+        writer->String(1 + kNumCategories + i, fbl::StringPrintf("name%u", i).c_str());
+    }
+}
+
+// Writes a trace of at least |size| bytes, with one event per tick.
+// Returns the number of events.
+bool WriteTrace(const char* path, size_t size, size_t* out_num_events) {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "Failed to create %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    auto writer = fbl::make_unique<TraceWriter>(file);
+
+    for (trace::ProviderId id = 1; id <= kNumProviders; ++id) {
+        writer->ProviderInfo(id, fbl::StringPrintf("provider%u", id).c_str());
+        DefineStrings(writer.get());
+        for (trace_thread_index_t i = 1; i <= kThreadsPerProvider; ++i) {
+            writer->Thread(i, id, id * 100 + i);
+        }
+    }
+
+    trace_ticks_t ts = 0u;
+    for (size_t section = 0; writer->bytes_written() < size; ++section) {
+        trace::ProviderId id = static_cast<trace::ProviderId>(1 + section % kNumProviders);
+        writer->ProviderSection(id);
+        // Providers redefine strings as their string tables fill.
+        if (section % 16 == 0)
+            DefineStrings(writer.get());
+        for (size_t i = 0; i < kEventsPerSection; ++i, ++ts) {
+            writer->Event(ts,
+                          static_cast<trace_thread_index_t>(1 + i % kThreadsPerProvider),
+                          static_cast<trace_string_index_t>(1 + i % kNumCategories),
+                          static_cast<trace_string_index_t>(
+                              1 + kNumCategories + i % kNumNames));
+        }
+    }
+
+    bool ok = writer->Flush();
+    writer.reset();
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        fprintf(stderr, "Failed to write %s\n", path);
+        return false;
+    }
+    *out_num_events = ts;
+    return true;
+}
+
+void PrintError(fbl::String error) {
+    fprintf(stderr, "Error: %s\n", error.c_str());
+}
+
+// Reads the file from the start with |TraceReader|, as tools do today,
+// counting the events in |query|'s time range.
+bool ReadSequentially(const char* path, const trace::MappedTraceReader::Query& query,
+                      size_t* out_count) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Failed to open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    size_t count = 0u;
+    trace::TraceReader reader(
+        [&count, &query](trace::Record record) {
+            if (record.type() == trace::RecordType::kEvent &&
+                record.GetEvent().timestamp >= query.start_time &&
+                record.GetEvent().timestamp < query.end_time)
+                count++;
+        },
+        PrintError);
+
+    constexpr size_t kBufferWords = 1024 * 1024 / sizeof(uint64_t);
+    auto buffer = fbl::make_unique<uint64_t[]>(kBufferWords);
+    size_t num_words = 0u;
+    bool ok = true;
+    for (;;) {
+        size_t count_read = fread(buffer.get() + num_words, sizeof(uint64_t),
+                                  kBufferWords - num_words, file);
+        if (count_read == 0u)
+            break;
+        num_words += count_read;
+        trace::Chunk chunk(buffer.get(), num_words);
+        if (!reader.ReadRecords(chunk)) {
+            ok = false;
+            break;
+        }
+        // Keep the words of a partial record for the next read.
+        size_t remaining = chunk.remaining_words();
+        memmove(buffer.get(), buffer.get() + num_words - remaining,
+                remaining * sizeof(uint64_t));
+        num_words = remaining;
+    }
+    fclose(file);
+    *out_count = count;
+    return ok;
+}
+
+bool Query(const trace::MappedTraceReader& reader, const char* what,
+           const trace::MappedTraceReader::Query& query, size_t num_threads) {
+    std::atomic<size_t> count{0u};
+    uint64_t start_ns = NowInNsecs();
+    if (!reader.ReadEvents(query, num_threads, [&count](trace::Record record) {
+            count.fetch_add(1u, std::memory_order_relaxed);
+        })) {
+        return false;
+    }
+    PrintRate(fbl::StringPrintf("%s, %zu thread%s", what, num_threads,
+                                num_threads == 1 ? "" : "s").c_str(),
+              start_ns, count.load());
+    return true;
+}
+
+void Usage(const char* argv0) {
+    fprintf(stderr,
+            "Usage: %s [--size=MB] [--threads=N] [FILE]\n"
+            "Benchmarks reading FILE, or a synthetic trace of MB megabytes\n"
+            "(default %zu) written to a temporary file.\n",
+            argv0, kDefaultTraceSizeMb);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t size_mb = kDefaultTraceSizeMb;
+    size_t num_threads = kDefaultNumThreads;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (!strncmp(argv[i], "--size=", 7)) {
+            size_mb = strtoul(argv[i] + 7, nullptr, 0);
+        } else if (!strncmp(argv[i], "--threads=", 10)) {
+            num_threads = strtoul(argv[i] + 10, nullptr, 0);
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            Usage(argv[0]);
+            return 1;
+        }
+    }
+
+    char temp_path[] = "/tmp/trace-reader-benchmark-XXXXXX";
+    if (!path) {
+        int fd = mkstemp(temp_path);
+        if (fd < 0) {
+            fprintf(stderr, "Failed to create a temporary file: %s\n", strerror(errno));
+            return 1;
+        }
+        close(fd);
+        path = temp_path;
+
+        printf("* Writing a %zu MB trace to %s ...\n", size_mb, path);
+        size_t num_events;
+        uint64_t start_ns = NowInNsecs();
+        if (!WriteTrace(path, size_mb * 1024 * 1024, &num_events)) {
+            unlink(path);
+            return 1;
+        }
+        PrintRate("write", start_ns, num_events);
+    }
+
+    int status = 1;
+    do {
+        printf("\n* Indexing ...\n");
+        uint64_t start_ns = NowInNsecs();
+        fbl::unique_ptr<trace::MappedTraceReader> reader;
+        if (!trace::MappedTraceReader::Open(path, PrintError, &reader))
+            break;
+        printf("%sindexed %zu blocks in %.3f s\n", kOutputPrefix, reader->num_blocks(),
+               static_cast<double>(NowInNsecs() - start_ns) / 1e9);
+
+        // A window of 1% of the trace, in the middle.
+        trace::MappedTraceReader::Query window;
+        trace_ticks_t duration = reader->end_time() - reader->start_time();
+        window.start_time = reader->start_time() + duration / 2;
+        window.end_time = window.start_time + duration / 100;
+
+        printf("\n* Reading 1%% of the trace ...\n");
+        size_t count;
+        start_ns = NowInNsecs();
+        if (!ReadSequentially(path, window, &count))
+            break;
+        PrintRate("sequential TraceReader", start_ns, count);
+        if (!Query(*reader, "mapped", window, 1u) ||
+            !Query(*reader, "mapped", window, num_threads))
+            break;
+
+        printf("\n* Reading the whole trace ...\n");
+        trace::MappedTraceReader::Query all;
+        start_ns = NowInNsecs();
+        if (!ReadSequentially(path, all, &count))
+            break;
+        PrintRate("sequential TraceReader", start_ns, count);
+        if (!Query(*reader, "mapped", all, 1u) ||
+            !Query(*reader, "mapped", all, num_threads))
+            break;
+
+        printf("\n* Reading one category from one provider ...\n");
+        trace::MappedTraceReader::Query filtered;
+        filtered.provider_id = 1u;
+        filtered.categories.push_back("category0");
+        if (!Query(*reader, "mapped", filtered, num_threads))
+            break;
+
+        status = 0;
+    } while (false);
+
+    if (path == temp_path)
+        unlink(path);
+    return status;
+}
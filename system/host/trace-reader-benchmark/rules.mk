@@ -0,0 +1,25 @@
+# Copyright 2019 The Fuchsia Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+LOCAL_DIR := $(GET_LOCAL_DIR)
+
+MODULE := $(LOCAL_DIR)
+
+MODULE_TYPE := hostapp
+
+MODULE_SRCS += \
+    $(LOCAL_DIR)/main.cpp \
+
+MODULE_HEADER_DEPS := \
+    system/ulib/trace-engine \
+
+MODULE_COMPILEFLAGS := \
+    -Isystem/ulib/fbl/include \
+    -Isystem/ulib/trace-reader/include \
+
+MODULE_HOST_LIBS := \
+    system/ulib/trace-reader.hostlib \
+    system/ulib/fbl.hostlib \
+
+include make/module.mk
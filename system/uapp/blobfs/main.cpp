@@ -56,6 +56,14 @@ int Mount(fbl::unique_fd fd, blobfs::MountOptions* options) {
                             std::move(root), std::move(loop_quit)) != ZX_OK) {
         return -1;
     }
+    // The calling thread is the last of the dispatcher's threads.
+    for (uint32_t i = 1; i < options->dispatch_threads; i++) {
+        zx_status_t status = loop.StartThread("blobfs-dispatch");
+        if (status != ZX_OK) {
+            FS_TRACE_ERROR("blobfs: Failed to start dispatcher thread: %d\n", status);
+            return -1;
+        }
+    }
     loop.Run();
     return ZX_OK;
 }
@@ -99,6 +107,7 @@ int usage() {
             "\n"
             "options: -r|--readonly  Mount filesystem read-only\n"
             "         -m|--metrics   Collect filesystem metrics\n"
+            "         -t|--threads N Serve requests on N threads\n"
             "         -h|--help      Display this message\n"
             "\n"
             "On Fuchsia, blobfs takes the block device argument by handle.\n"
@@ -120,11 +129,12 @@ int ProcessArgs(int argc, char** argv, CommandFunction* func, blobfs::MountOptio
             {"readonly", no_argument, nullptr, 'r'},
             {"metrics", no_argument, nullptr, 'm'},
             {"journal", no_argument, nullptr, 'j'},
+            {"threads", required_argument, nullptr, 't'},
             {"help", no_argument, nullptr, 'h'},
             {nullptr, 0, nullptr, 0},
         };
         int opt_index;
-        int c = getopt_long(argc, argv, "rmjh", opts, &opt_index);
+        int c = getopt_long(argc, argv, "rmjt:h", opts, &opt_index);
         if (c < 0) {
             break;
         }
@@ -138,6 +148,12 @@ int ProcessArgs(int argc, char** argv, CommandFunction* func, blobfs::MountOptio
         case 'j':
             options->journal = true;
             break;
+        case 't':
+            options->dispatch_threads = static_cast<uint32_t>(strtoul(optarg, NULL, 0));
+            if (options->dispatch_threads == 0) {
+                return usage();
+            }
+            break;
         case 'h':
         default:
             return usage();
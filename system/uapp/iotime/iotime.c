@@ -4,9 +4,12 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <block-client/client.h>
@@ -82,6 +85,56 @@ static zx_duration_t iotime_posix(int is_read, int fd, size_t total, size_t bufs
     return zx_time_sub_time(t1, t0);
 }
 
+// Like iotime_posix, but transfers each buffer with readv() or writev(),
+// split into 4K vectors (IOV_MAX of them at a time).
+static zx_duration_t iotime_posixv(int is_read, int fd, size_t total, size_t bufsz) {
+    const size_t vecsz = 4096;
+    if ((total % vecsz) || (bufsz % vecsz)) {
+        fprintf(stderr, "error: total and buffer size must be multiples of 4K\n");
+        return ZX_TIME_INFINITE;
+    }
+
+    char* buffer = malloc(bufsz);
+    struct iovec* iov = calloc(IOV_MAX, sizeof(struct iovec));
+    if (buffer == NULL || iov == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        return ZX_TIME_INFINITE;
+    }
+
+    zx_time_t t0 = zx_clock_get_monotonic();
+    size_t n = total;
+    const char* fn_name = is_read ? "readv" : "writev";
+    while (n > 0) {
+        size_t xfer = (n > bufsz) ? bufsz : n;
+        for (size_t done = 0; done < xfer;) {
+            size_t iovcnt = (xfer - done) / vecsz;
+            if (iovcnt > IOV_MAX) {
+                iovcnt = IOV_MAX;
+            }
+            for (size_t i = 0; i < iovcnt; i++) {
+                iov[i].iov_base = buffer + done + i * vecsz;
+                iov[i].iov_len = vecsz;
+            }
+            size_t len = iovcnt * vecsz;
+            ssize_t r = is_read ? readv(fd, iov, (int)iovcnt) : writev(fd, iov, (int)iovcnt);
+            if (r < 0) {
+                fprintf(stderr, "error: %s() error %d\n", fn_name, errno);
+                return ZX_TIME_INFINITE;
+            }
+            if ((size_t)r != len) {
+                fprintf(stderr, "error: %s() %zu of %zu bytes processed\n", fn_name, r, len);
+                return ZX_TIME_INFINITE;
+            }
+            done += len;
+        }
+        n -= xfer;
+    }
+    zx_time_t t1 = zx_clock_get_monotonic();
+
+    free(iov);
+    free(buffer);
+    return zx_time_sub_time(t1, t0);
+}
 
 static int make_ramdisk(size_t blocks) {
     char ramdisk_path[PATH_MAX];
@@ -165,12 +218,39 @@ static zx_duration_t iotime_fifo(char* dev, int is_read, int fd, size_t total, s
 
 static int usage(void) {
     fprintf(stderr,
-            "usage: iotime <read|write> <posix|block|fifo> <device|--ramdisk> <bytes> <bufsize>\n\n"
-            "        <bytes> and <bufsize> must be a multiple of 4k for block mode\n"
+            "usage: iotime <read|write> <posix|posixv|block|fifo> <device|--ramdisk> <bytes> <bufsize>\n\n"
+            "        <bytes> and <bufsize> must be a multiple of 4k for posixv and block modes\n"
+            "        <bufsize> may be 'sweep', to run with each power of two from 4K to 16M\n"
             "        --ramdisk only supported for block mode\n");
     return -1;
 }
 
+static zx_duration_t iotime(const char* mode, char* dev, int is_read, int fd, size_t total,
+                            size_t bufsz) {
+    if (!strcmp(mode, "posix")) {
+        return iotime_posix(is_read, fd, total, bufsz);
+    } else if (!strcmp(mode, "posixv")) {
+        return iotime_posixv(is_read, fd, total, bufsz);
+    } else if (!strcmp(mode, "block")) {
+        return iotime_block(is_read, fd, total, bufsz);
+    } else if (!strcmp(mode, "fifo")) {
+        return iotime_fifo(dev, is_read, fd, total, bufsz);
+    } else {
+        fprintf(stderr, "error: unknown mode '%s'\n", mode);
+        return ZX_TIME_INFINITE;
+    }
+}
+
+static int report(int is_read, size_t total, size_t bufsz, zx_duration_t res) {
+    if (res == ZX_TIME_INFINITE) {
+        return -1;
+    }
+    fprintf(stderr, "%s %zu bytes (%zu at a time) in %zu ns: ", is_read ? "read" : "write",
+            total, bufsz, res);
+    bytes_per_second(total, res);
+    return 0;
+}
+
 
 int main(int argc, char** argv) {
     if (argc != 6) {
@@ -179,7 +259,8 @@ int main(int argc, char** argv) {
 
     int is_read = !strcmp(argv[1], "read");
     size_t total = number(argv[4]);
-    size_t bufsz = number(argv[5]);
+    bool sweep = !strcmp(argv[5], "sweep");
+    size_t bufsz = sweep ? 0 : number(argv[5]);
 
     int fd;
     if (!strcmp(argv[3], "--ramdisk")) {
@@ -198,23 +279,21 @@ int main(int argc, char** argv) {
         }
     }
 
-    zx_duration_t res;
-    if (!strcmp(argv[2], "posix")) {
-        res = iotime_posix(is_read, fd, total, bufsz);
-    } else if (!strcmp(argv[2], "block")) {
-        res = iotime_block(is_read, fd, total, bufsz);
-    } else if (!strcmp(argv[2], "fifo")) {
-        res = iotime_fifo(argv[3], is_read, fd, total, bufsz);
-    } else {
-        fprintf(stderr, "error: unknown mode '%s'\n", argv[2]);
-        return -1;
+    if (!sweep) {
+        return report(is_read, total, bufsz, iotime(argv[2], argv[3], is_read, fd, total, bufsz));
     }
-
-    if (res != ZX_TIME_INFINITE) {
-        fprintf(stderr, "%s %zu bytes in %zu ns: ", is_read ? "read" : "write", total, res);
-        bytes_per_second(total, res);
-        return 0;
-    } else {
-        return -1;
+    for (bufsz = 4096; bufsz <= 16 * 1024 * 1024; bufsz *= 2) {
+        if (bufsz > total) {
+            break;
+        }
+        if (lseek(fd, 0, SEEK_SET) != 0) {
+            fprintf(stderr, "error: cannot seek '%s'\n", argv[3]);
+            return -1;
+        }
+        if (report(is_read, total, bufsz,
+                   iotime(argv[2], argv[3], is_read, fd, total, bufsz)) < 0) {
+            return -1;
+        }
     }
+    return 0;
 }
@@ -56,6 +56,13 @@ int Mount(fbl::unique_ptr<minfs::Bcache> bc, const minfs::MountOptions& options)
         fprintf(stderr, "minfs: Mounted successfully\n");
     }
 
+    // The calling thread is the last of the dispatcher's threads.
+    for (uint32_t i = 1; i < options.dispatch_threads; i++) {
+        if ((status = loop.StartThread("minfs-dispatch")) != ZX_OK) {
+            FS_TRACE_ERROR("minfs: Failed to start dispatcher thread: %d\n", status);
+            return -1;
+        }
+    }
     loop.Run();
     return 0;
 }
@@ -85,6 +92,7 @@ int usage() {
                     "    -m|--metrics                  Collect filesystem metrics\n"
                     "    -s|--fvm_data_slices SLICES   When mkfs on top of FVM,\n"
                     "                                  preallocate |SLICES| slices of data. \n"
+                    "    -t|--threads THREADS          Serve requests on |THREADS| threads\n"
                     "    -h|--help                     Display this message\n"
                     "\n"
                     "On Fuchsia, MinFS takes the block device argument by handle.\n"
@@ -123,11 +131,12 @@ int main(int argc, char** argv) {
             {"journal", no_argument, nullptr, 'j'},
             {"verbose", no_argument, nullptr, 'v'},
             {"fvm_data_slices", required_argument, nullptr, 's'},
+            {"threads", required_argument, nullptr, 't'},
             {"help", no_argument, nullptr, 'h'},
             {nullptr, 0, nullptr, 0},
         };
         int opt_index;
-        int c = getopt_long(argc, argv, "rmjvhs:", opts, &opt_index);
+        int c = getopt_long(argc, argv, "rmjvhs:t:", opts, &opt_index);
         if (c < 0) {
             break;
         }
@@ -148,6 +157,12 @@ int main(int argc, char** argv) {
         case 's':
             options.fvm_data_slices = static_cast<uint32_t>(strtoul(optarg, NULL, 0));
             break;
+        case 't':
+            options.dispatch_threads = static_cast<uint32_t>(strtoul(optarg, NULL, 0));
+            if (options.dispatch_threads == 0) {
+                return usage();
+            }
+            break;
         case 'h':
         default:
             return usage();
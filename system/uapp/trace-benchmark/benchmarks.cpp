@@ -7,6 +7,7 @@
 #include <inttypes.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <threads.h>
 
 #include <fbl/function.h>
 #include <lib/async/cpp/task.h>
@@ -14,6 +15,7 @@
 #include <trace-engine/instrumentation.h>
 #include <trace-vthread/event_vthread.h>
 #include <trace/event.h>
+#include <zircon/assert.h>
 
 #include "handler.h"
 #include "runner.h"
@@ -28,6 +30,14 @@ public:
         : enabled_(enabled), spec_(spec) {}
 
     void Run(const char* name, Benchmark benchmark) {
+        // For the disabled benchmarks we just use the default number
+        // of iterations.
+        Run(name, enabled_ ? spec_->num_iterations : kDefaultRunIterations,
+            std::move(benchmark));
+    }
+
+    // Returns the minimum time of a run, in microseconds.
+    float Run(const char* name, unsigned iterations, Benchmark benchmark) {
         if (enabled_) {
             // The trace engine needs to run in its own thread in order to
             // process buffer full requests in streaming mode while the
@@ -36,22 +46,22 @@ public:
             // is a stress test so all the app is doing is filling the trace
             // buffer. :-)
             async::Loop loop(&kAsyncLoopConfigNoAttachToThread);
-            BenchmarkHandler handler(&loop, spec_->mode, spec_->buffer_size);
+            BenchmarkHandler handler(&loop, spec_->mode, spec_->buffer_size,
+                                     spec_->engine_options);
 
             loop.StartThread("trace-engine loop", nullptr);
 
-            RunAndMeasure(
-                name, spec_->name, spec_->num_iterations, benchmark,
+            float min_time = RunAndMeasure(
+                name, spec_->name, iterations, benchmark,
                 [&handler]() { handler.Start(); },
                 [&handler]() { handler.Stop(); });
 
             loop.Quit();
             loop.JoinThreads();
+            return min_time;
         } else {
-            // For the disabled benchmarks we just use the default number
-            // of iterations.
-            RunAndMeasure(
-                name, spec_->name, benchmark, []() {}, []() {});
+            return RunAndMeasure(
+                name, spec_->name, iterations, benchmark, []() {}, []() {});
         }
     }
 
@@ -70,6 +80,34 @@ private:
     const BenchmarkSpec* spec_;
 };
 
+// The multi-threaded benchmark has this many threads each write this many
+// events per iteration, to measure contention between threads writing
+// to the same trace buffer.
+// N.B. The warm-up iterations and test runs must together fit in the
+// 16MB buffer in oneshot mode.
+constexpr unsigned kNumWriterThreads = 8;
+constexpr unsigned kEventsPerWriterThread = 5000;
+constexpr unsigned kMultiThreadIterations = 10;
+
+int WriteEvents(void*) {
+    for (unsigned i = 0; i < kEventsPerWriterThread; ++i) {
+        TRACE_DURATION_BEGIN("+enabled", "name");
+    }
+    return 0;
+}
+
+void WriteEventsFromThreads() {
+    thrd_t threads[kNumWriterThreads];
+    for (auto& thread : threads) {
+        int result = thrd_create(&thread, WriteEvents, nullptr);
+        ZX_ASSERT(result == thrd_success);
+    }
+    for (auto& thread : threads) {
+        int result = thrd_join(thread, nullptr);
+        ZX_ASSERT(result == thrd_success);
+    }
+}
+
 } // namespace
 
 #define MAKE_TEST_SYMBOL_NAME(prefix, DURATION_MACRO, test_symbol_name, category) \
@@ -212,6 +250,16 @@ static void RunBenchmarks(bool tracing_enabled, const BenchmarkSpec* spec) {
     RUN_TEST(zero_args, "0 arguments", TRACE_VTHREAD_DURATION_BEGIN, "+", enabled,
              TRACE_VTHREAD_DURATION_BEGIN("+enabled", "name", "vthread", 1, zx_ticks_get()));
 
+    if (tracing_enabled) {
+        float min_time = runner.Run("TRACE_DURATION_BEGIN macro from 8 threads",
+                                    kMultiThreadIterations, WriteEventsFromThreads);
+        // The time includes creating and joining the threads.
+        runner.Print("events per second: %.0f\n",
+                     static_cast<float>(kNumWriterThreads * kEventsPerWriterThread *
+                                        kMultiThreadIterations) *
+                         1000000.f / min_time);
+    }
+
     if (tracing_enabled) {
         DURATION_TEST(TRACE_DURATION_BEGIN, "-", disabled);
         DURATION_TEST(TRACE_DURATION, "-", disabled);
@@ -226,6 +274,7 @@ void RunTracingDisabledBenchmarks() {
         "tracing off",
         TRACE_BUFFERING_MODE_ONESHOT, // unused
         0,
+        0u,
         kDefaultRunIterations,
     };
     RunBenchmarks(false, &spec);
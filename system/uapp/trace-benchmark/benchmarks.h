@@ -5,6 +5,7 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include <trace-engine/types.h>
 
@@ -12,6 +13,8 @@ struct BenchmarkSpec {
     const char* name;
     trace_buffering_mode_t mode;
     size_t buffer_size;
+    // The |TRACE_ENGINE_OPTION_*| values to start the engine with.
+    uint32_t engine_options;
     // The number of iterations is a parameter to make it easier to
     // experiment and debug.
     unsigned num_iterations;
@@ -19,9 +19,10 @@ public:
     static constexpr int kWaitStoppedTimeoutSeconds = 10;
 
     BenchmarkHandler(async::Loop* loop, trace_buffering_mode_t mode,
-                     size_t buffer_size)
+                     size_t buffer_size, uint32_t engine_options)
         : loop_(loop),
           mode_(mode),
+          engine_options_(engine_options),
           buffer_(new uint8_t[buffer_size], buffer_size) {
         auto status = zx::event::create(0u, &observer_event_);
         ZX_DEBUG_ASSERT_MSG(status == ZX_OK,
@@ -43,11 +44,12 @@ public:
     trace_buffering_mode_t mode() const { return mode_; }
 
     void Start() {
-        zx_status_t status = trace_start_engine(loop_->dispatcher(),
-                                                this, mode_,
-                                                buffer_.get(), buffer_.size());
+        zx_status_t status = trace_start_engine_etc(loop_->dispatcher(),
+                                                    this, mode_,
+                                                    buffer_.get(), buffer_.size(),
+                                                    engine_options_);
         ZX_DEBUG_ASSERT_MSG(status == ZX_OK,
-                            "trace_start_engine returned %s\n",
+                            "trace_start_engine_etc returned %s\n",
                             zx_status_get_string(status));
         ZX_DEBUG_ASSERT(trace_state() == TRACE_STARTED);
         observer_event_.signal(ZX_EVENT_SIGNALED, 0u);
@@ -131,6 +133,7 @@ private:
 
     async::Loop* const loop_;
     const trace_buffering_mode_t mode_;
+    const uint32_t engine_options_;
     fbl::Array<uint8_t> const buffer_;
     zx::event observer_event_;
 };
@@ -4,6 +4,8 @@
 
 #include "benchmarks.h"
 
+#include <trace-engine/handler.h>
+
 #include "runner.h"
 
 namespace {
@@ -30,30 +32,56 @@ int main(int argc, char** argv) {
             "oneshot, 16MB buffer",
             TRACE_BUFFERING_MODE_ONESHOT,
             kLargeBufferSizeBytes,
+            0u,
             kDefaultRunIterations,
         },
         {
             "streaming, 16MB buffer",
             TRACE_BUFFERING_MODE_STREAMING,
             kLargeBufferSizeBytes,
+            0u,
             kDefaultRunIterations,
         },
         {
             "circular, 16MB buffer",
             TRACE_BUFFERING_MODE_CIRCULAR,
             kLargeBufferSizeBytes,
+            0u,
             kDefaultRunIterations,
         },
         {
             "streaming, 16K buffer",
             TRACE_BUFFERING_MODE_STREAMING,
             kSmallBufferSizeBytes,
+            0u,
             kDefaultRunIterations,
         },
         {
             "circular, 16K buffer",
             TRACE_BUFFERING_MODE_CIRCULAR,
             kSmallBufferSizeBytes,
+            0u,
+            kDefaultRunIterations,
+        },
+        {
+            "oneshot, 16MB buffer, thread buffers",
+            TRACE_BUFFERING_MODE_ONESHOT,
+            kLargeBufferSizeBytes,
+            TRACE_ENGINE_OPTION_THREAD_BUFFERS,
+            kDefaultRunIterations,
+        },
+        {
+            "streaming, 16MB buffer, thread buffers",
+            TRACE_BUFFERING_MODE_STREAMING,
+            kLargeBufferSizeBytes,
+            TRACE_ENGINE_OPTION_THREAD_BUFFERS,
+            kDefaultRunIterations,
+        },
+        {
+            "circular, 16MB buffer, thread buffers",
+            TRACE_BUFFERING_MODE_CIRCULAR,
+            kLargeBufferSizeBytes,
+            TRACE_ENGINE_OPTION_THREAD_BUFFERS,
             kDefaultRunIterations,
         },
     };
@@ -43,8 +43,9 @@ float Measure(unsigned iterations, const T& closure) {
 using thunk = fbl::Function<void ()>;
 
 // Runs a closure repeatedly and prints its timing.
+// Returns the minimum time of a run, in microseconds.
 template <typename T>
-void RunAndMeasure(const char* test_name, const char* spec_name,
+float RunAndMeasure(const char* test_name, const char* spec_name,
                    unsigned iterations, const T& closure,
                    thunk setup, thunk teardown) {
     printf("\n* %s: %s ...\n", spec_name, test_name);
@@ -82,11 +83,12 @@ void RunAndMeasure(const char* test_name, const char* spec_name,
     printf("%sper-iteration (usec): min: %.3f\n",
            // The static cast is to avoid a "may change value" warning.
            kTestOutputPrefix, min / static_cast<float>(iterations));
+    return min;
 }
 
 template <typename T>
-void RunAndMeasure(const char* test_name, const char* spec_name,
-                   const T& closure, thunk setup, thunk teardown) {
-    RunAndMeasure(test_name, spec_name, kDefaultRunIterations, closure,
-                  std::move(setup), std::move(teardown));
+float RunAndMeasure(const char* test_name, const char* spec_name,
+                    const T& closure, thunk setup, thunk teardown) {
+    return RunAndMeasure(test_name, spec_name, kDefaultRunIterations, closure,
+                         std::move(setup), std::move(teardown));
 }
@@ -22,6 +22,7 @@
 #include <cobalt-client/cpp/timer.h>
 #include <digest/digest.h>
 #include <fbl/auto_call.h>
+#include <fbl/auto_lock.h>
 #include <fbl/ref_ptr.h>
 #include <fbl/string_piece.h>
 #include <fs/metrics.h>
@@ -72,6 +73,9 @@ zx_status_t Blob::Verify() const {
 zx_status_t Blob::InitVmos() {
     TRACE_DURATION("blobfs", "Blobfs::InitVmos");
 
+    // Readers of the same blob may be dispatched on several threads at once,
+    // and the first of them to arrive reads it in.
+    fbl::AutoLock lock(&vmo_lock_);
     if (mapping_.vmo()) {
         return ZX_OK;
     }
@@ -650,6 +654,10 @@ zx_status_t Blob::CloneVmo(zx_rights_t rights, zx_handle_t* out_vmo, size_t* out
         return status;
     }
 
+    // Held until the clone is being watched, so that |HandleNoClones| can't
+    // drop |clone_ref_| while it is in use.
+    fbl::AutoLock lock(&vmo_lock_);
+
     // TODO(smklein): Only clone / verify the part of the vmo that
     // was requested.
     const size_t merkle_bytes = MerkleTreeBlocks(inode_) * kBlobfsBlockSize;
@@ -690,9 +698,26 @@ void Blob::HandleNoClones(async_dispatcher_t* dispatcher, async::WaitBase* wait,
                                zx_status_t status, const zx_packet_signal_t* signal) {
     ZX_DEBUG_ASSERT(status == ZX_OK);
     ZX_DEBUG_ASSERT((signal->observed & ZX_VMO_ZERO_CHILDREN) != 0);
-    ZX_DEBUG_ASSERT(clone_watcher_.object() != ZX_HANDLE_INVALID);
-    clone_watcher_.set_object(ZX_HANDLE_INVALID);
-    clone_ref_ = nullptr;
+    fbl::RefPtr<Blob> clone_ref;
+    {
+        fbl::AutoLock lock(&vmo_lock_);
+        ZX_DEBUG_ASSERT(clone_watcher_.object() != ZX_HANDLE_INVALID);
+        // A clone may have been handed out on another thread since the
+        // signal was observed.
+        zx_signals_t observed;
+        if (mapping_.vmo().wait_one(ZX_VMO_ZERO_CHILDREN, zx::time(),
+                                    &observed) == ZX_ERR_TIMED_OUT) {
+            clone_watcher_.Begin(dispatcher);
+            return;
+        }
+        clone_watcher_.set_object(ZX_HANDLE_INVALID);
+        clone_ref = std::move(clone_ref_);
+    }
+    // This may be the last reference to the blob, and so is dropped once
+    // its lock has been released. Releasing a blob may purge it, which must
+    // not happen alongside any request.
+    fs::DispatchLock dispatch_lock(blobfs_, false);
+    clone_ref = nullptr;
 }
 
 zx_status_t Blob::ReadInternal(void* data, size_t len, size_t off, size_t* actual) {
@@ -918,6 +943,7 @@ void Blob::CompleteSync() {
 }
 
 fbl::RefPtr<Blob> Blob::CloneWatcherTeardown() {
+    fbl::AutoLock lock(&vmo_lock_);
     if (clone_watcher_.is_pending()) {
         clone_watcher_.Cancel();
         clone_watcher_.set_object(ZX_HANDLE_INVALID);
@@ -552,9 +552,14 @@ Blobfs::Blobfs(fbl::unique_fd fd, const Superblock* info)
     : blockfd_(std::move(fd)), metrics_(),
       cobalt_metrics_(MakeCollectorOptions(), false, "blobfs") {
     memcpy(&info_, info, sizeof(Superblock));
+    EnableLookupCache();
 }
 
 Blobfs::~Blobfs() {
+    // Cached lookups hold references to vnodes, which must be released
+    // before the blob cache is reset.
+    FlushLookupCache();
+
     // The journal must be destroyed before the writeback buffer, since it may still need
     // to enqueue more transactions for writeback.
     journal_.reset();
@@ -579,6 +584,9 @@ zx_status_t Blobfs::Create(fbl::unique_fd fd, const MountOptions& options, const
     auto fs = fbl::unique_ptr<Blobfs>(new Blobfs(std::move(fd), info));
     fs->SetReadonly(options.readonly);
     fs->Cache().SetCachePolicy(options.cache_policy);
+    if (options.dispatch_threads > 1) {
+        fs->EnableConcurrentDispatch();
+    }
     if (options.metrics) {
         fs->LocalMetrics().Collect();
     }
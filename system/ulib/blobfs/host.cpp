@@ -9,10 +9,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <thread>
 #include <unistd.h>
 #include <utility>
 
 #include <digest/digest.h>
+#include <digest/merkle-cache.h>
 #include <digest/merkle-tree.h>
 #include <fbl/algorithm.h>
 #include <fbl/array.h>
@@ -34,35 +36,46 @@ using digest::MerkleTree;
 
 constexpr uint32_t kExtentCount = 5;
 
+// Blobs at least this large have their Merkle tree and compressed form generated concurrently.
+constexpr size_t kConcurrentPreprocessMinBytes = 1 << 20;
+
 namespace blobfs {
 namespace {
 
+// Block I/O uses positional reads and writes so that blob data may be written to the image from
+// multiple threads while metadata is being updated.
 zx_status_t readblk_offset(int fd, uint64_t bno, off_t offset, void* data) {
     off_t off = offset + bno * kBlobfsBlockSize;
-    if (lseek(fd, off, SEEK_SET) < 0) {
-        FS_TRACE_ERROR("blobfs: cannot seek to block %" PRIu64 "\n", bno);
-        return ZX_ERR_IO;
-    }
-    if (read(fd, data, kBlobfsBlockSize) != kBlobfsBlockSize) {
+    if (pread(fd, data, kBlobfsBlockSize, off) != kBlobfsBlockSize) {
         FS_TRACE_ERROR("blobfs: cannot read block %" PRIu64 "\n", bno);
         return ZX_ERR_IO;
     }
     return ZX_OK;
 }
 
-zx_status_t writeblk_offset(int fd, uint64_t bno, off_t offset, const void* data) {
+zx_status_t writeblks_offset(int fd, uint64_t bno, uint64_t count, off_t offset,
+                             const void* data) {
     off_t off = offset + bno * kBlobfsBlockSize;
-    if (lseek(fd, off, SEEK_SET) < 0) {
-        FS_TRACE_ERROR("blobfs: cannot seek to block %" PRIu64 "\n", bno);
-        return ZX_ERR_IO;
-    }
-    if (write(fd, data, kBlobfsBlockSize) != kBlobfsBlockSize) {
-        FS_TRACE_ERROR("blobfs: cannot write block %" PRIu64 "\n", bno);
-        return ZX_ERR_IO;
+    size_t remaining = count * kBlobfsBlockSize;
+    const uint8_t* buf = static_cast<const uint8_t*>(data);
+    while (remaining > 0) {
+        ssize_t r = pwrite(fd, buf, remaining, off);
+        if (r <= 0) {
+            FS_TRACE_ERROR("blobfs: cannot write blocks %" PRIu64 "-%" PRIu64 "\n", bno,
+                           bno + count - 1);
+            return ZX_ERR_IO;
+        }
+        buf += r;
+        off += r;
+        remaining -= r;
     }
     return ZX_OK;
 }
 
+zx_status_t writeblk_offset(int fd, uint64_t bno, off_t offset, const void* data) {
+    return writeblks_offset(fd, bno, 1, offset, data);
+}
+
 // From a buffer, create a merkle tree.
 //
 // Given a mapped blob at |blob_data| of length |length|, compute the
@@ -114,6 +127,46 @@ zx_status_t buffer_compress(const FileMapping& mapping, MerkleInfo* out_info) {
     return ZX_OK;
 }
 
+// Fill in the compressed form of a blob in |out_info| from the payload of a
+// cached |entry|. An empty payload records that the blob was not worth
+// compressing.
+void merkle_info_set_payload(const digest::MerkleCacheEntry& entry, MerkleInfo* out_info) {
+    out_info->compressed = entry.payload.size() > 0;
+    out_info->compressed_length = entry.payload.size();
+    if (!out_info->compressed) {
+        return;
+    }
+
+    // Blob data is written a whole block at a time, so pad the buffer out to a block boundary.
+    size_t buffer_size = fbl::round_up(entry.payload.size(), kBlobfsBlockSize);
+    out_info->compressed_data.reset(new uint8_t[buffer_size]);
+    memcpy(out_info->compressed_data.get(), entry.payload.get(), entry.payload.size());
+    memset(out_info->compressed_data.get() + entry.payload.size(), 0,
+           buffer_size - entry.payload.size());
+}
+
+// Record the Merkle tree, and compressed form if |compressed_known|, of the
+// blob described by |info| in |cache|.
+zx_status_t merkle_info_store(const digest::MerkleCache& cache, const char* path,
+                              const struct stat& st, bool compressed_known, MerkleInfo* info) {
+    digest::MerkleCacheEntry entry;
+    uint8_t root[digest::Digest::kLength];
+    info->digest.CopyTo(root, sizeof(root));
+    entry.digest = root;
+    entry.length = info->length;
+    entry.has_payload = compressed_known;
+    if (compressed_known && info->compressed) {
+        entry.payload.reset(new uint8_t[info->compressed_length], info->compressed_length);
+        memcpy(entry.payload.get(), info->compressed_data.get(), info->compressed_length);
+    }
+
+    // Lend the tree to the entry rather than copying it.
+    entry.tree = std::move(info->merkle);
+    zx_status_t status = cache.Store(path, st, entry);
+    info->merkle = std::move(entry.tree);
+    return status;
+}
+
 // Given a buffer (and pre-computed merkle tree), add the buffer as a
 // blob in Blobfs.
 zx_status_t blobfs_add_mapped_blob_with_merkle(Blobfs* bs, const FileMapping& mapping,
@@ -128,57 +181,62 @@ zx_status_t blobfs_add_mapped_blob_with_merkle(Blobfs* bs, const FileMapping& ma
     }
 
     // After we've pre-calculated all necessary information, actually add the
-    // blob to the filesystem itself.
+    // blob to the filesystem itself. Only the allocation of the inode and blocks,
+    // and the metadata recording them, is serialized; the blob's data is written
+    // to its newly reserved blocks without holding the lock.
     static std::mutex add_blob_mutex_;
-    std::lock_guard<std::mutex> lock(add_blob_mutex_);
-    fbl::unique_ptr<InodeBlock> inode_block;
-    zx_status_t status;
-    if ((status = bs->NewBlob(info.digest, &inode_block)) != ZX_OK) {
-        FS_TRACE_ERROR("error: Failed to allocate a new blob\n");
-        return status;
-    }
-    if (inode_block == nullptr) {
-        FS_TRACE_ERROR("error: No nodes available on blobfs image\n");
-        return ZX_ERR_NO_RESOURCES;
-    }
-
-    Inode* inode = inode_block->GetInode();
-    inode->blob_size = mapping.length();
-    inode->block_count = MerkleTreeBlocks(*inode) + info.GetDataBlocks();
-    inode->header.flags |= kBlobFlagAllocated | (info.compressed ? kBlobFlagLZ4Compressed : 0);
+    Inode inode;
+    {
+        std::lock_guard<std::mutex> lock(add_blob_mutex_);
+        fbl::unique_ptr<InodeBlock> inode_block;
+        zx_status_t status;
+        if ((status = bs->NewBlob(info.digest, &inode_block)) != ZX_OK) {
+            FS_TRACE_ERROR("error: Failed to allocate a new blob\n");
+            return status;
+        }
+        if (inode_block == nullptr) {
+            FS_TRACE_ERROR("error: No nodes available on blobfs image\n");
+            return ZX_ERR_NO_RESOURCES;
+        }
 
-    // TODO(smklein): Currently, host-side tools can only generate single-extent
-    // blobs. This should be fixed.
-    if (inode->block_count > kBlockCountMax) {
-        FS_TRACE_ERROR("error: Blobs larger than %lu blocks not yet implemented\n",
-                       kBlockCountMax);
-        return ZX_ERR_NOT_SUPPORTED;
-    }
+        Inode* node = inode_block->GetInode();
+        node->blob_size = mapping.length();
+        node->block_count = MerkleTreeBlocks(*node) + info.GetDataBlocks();
+        node->header.flags |= kBlobFlagAllocated | (info.compressed ? kBlobFlagLZ4Compressed : 0);
+
+        // TODO(smklein): Currently, host-side tools can only generate single-extent
+        // blobs. This should be fixed.
+        if (node->block_count > kBlockCountMax) {
+            FS_TRACE_ERROR("error: Blobs larger than %lu blocks not yet implemented\n",
+                           kBlockCountMax);
+            return ZX_ERR_NOT_SUPPORTED;
+        }
 
-    size_t start_block = 0;
-    if ((status = bs->AllocateBlocks(inode->block_count, &start_block)) != ZX_OK) {
-        FS_TRACE_ERROR("error: No blocks available\n");
-        return status;
-    }
+        size_t start_block = 0;
+        if ((status = bs->AllocateBlocks(node->block_count, &start_block)) != ZX_OK) {
+            FS_TRACE_ERROR("error: No blocks available\n");
+            return status;
+        }
 
-    // TODO(smklein): This is hardcoded alongside the check against "kBlockCountMax" above.
-    inode->extents[0].SetStart(start_block);
-    inode->extents[0].SetLength(static_cast<BlockCountType>(inode->block_count));
-    inode->extent_count = 1;
+        // TODO(smklein): This is hardcoded alongside the check against "kBlockCountMax" above.
+        node->extents[0].SetStart(start_block);
+        node->extents[0].SetLength(static_cast<BlockCountType>(node->block_count));
+        node->extent_count = 1;
 
-    if ((status = bs->WriteData(inode, info.merkle.get(), data)) != ZX_OK) {
-        return status;
-    }
+        // |node| points into the block cache, which may be reused as soon as the lock is
+        // dropped.
+        inode = *node;
 
-    if ((status = bs->WriteBitmap(inode->block_count, inode->extents[0].Start())) != ZX_OK) {
-        return status;
-    } else if ((status = bs->WriteNode(std::move(inode_block))) != ZX_OK) {
-        return status;
-    } else if ((status = bs->WriteInfo()) != ZX_OK) {
-        return status;
+        if ((status = bs->WriteBitmap(node->block_count, node->extents[0].Start())) != ZX_OK) {
+            return status;
+        } else if ((status = bs->WriteNode(std::move(inode_block))) != ZX_OK) {
+            return status;
+        } else if ((status = bs->WriteInfo()) != ZX_OK) {
+            return status;
+        }
     }
 
-    return ZX_OK;
+    return bs->WriteData(&inode, info.merkle.get(), data);
 }
 
 } // namespace
@@ -269,6 +327,18 @@ zx_status_t blobfs_preprocess(int data_fd, bool compress, MerkleInfo* out_info)
         return status;
     }
 
+    if (compress && mapping.length() >= kConcurrentPreprocessMinBytes) {
+        // Merkle tree generation and compression both only read the mapping, and fill in
+        // disjoint fields of |out_info|, so for large blobs they may run side by side.
+        zx_status_t compress_status;
+        std::thread compress_thread([&]() {
+            compress_status = buffer_compress(mapping, out_info);
+        });
+        status = buffer_create_merkle(mapping, out_info);
+        compress_thread.join();
+        return status != ZX_OK ? status : compress_status;
+    }
+
     if ((status = buffer_create_merkle(mapping, out_info)) != ZX_OK) {
         return status;
     }
@@ -280,6 +350,59 @@ zx_status_t blobfs_preprocess(int data_fd, bool compress, MerkleInfo* out_info)
     return status;
 }
 
+zx_status_t blobfs_preprocess_cached(const digest::MerkleCache& cache, const char* path,
+                                     int data_fd, bool compress, MerkleInfo* out_info) {
+    struct stat st;
+    if (fstat(data_fd, &st) < 0) {
+        return ZX_ERR_BAD_STATE;
+    }
+
+    // If the file is unchanged since it was cached, nothing needs to be read.
+    digest::MerkleCacheEntry entry;
+    bool cached = cache.Lookup(path, st, &entry) == ZX_OK;
+    if (cached && (!compress || entry.has_payload)) {
+        out_info->digest = std::move(entry.digest);
+        out_info->length = entry.length;
+        out_info->merkle = std::move(entry.tree);
+        if (compress) {
+            merkle_info_set_payload(entry, out_info);
+        }
+        return ZX_OK;
+    }
+
+    FileMapping mapping;
+    zx_status_t status = mapping.Map(data_fd);
+    if (status != ZX_OK) {
+        return status;
+    }
+
+    if (cached) {
+        out_info->digest = std::move(entry.digest);
+        out_info->length = entry.length;
+        out_info->merkle = std::move(entry.tree);
+    } else if ((status = buffer_create_merkle(mapping, out_info)) != ZX_OK) {
+        return status;
+    }
+
+    if (compress) {
+        // Identical contents may already have been compressed under another path, or
+        // before the file was last touched.
+        digest::MerkleCacheEntry content;
+        if (!cached && cache.LookupContent(out_info->digest, &content) == ZX_OK &&
+            content.has_payload) {
+            merkle_info_set_payload(content, out_info);
+        } else if ((status = buffer_compress(mapping, out_info)) != ZX_OK) {
+            return status;
+        }
+    }
+
+    // The cache only saves work; failing to update it does not fail preprocessing.
+    if (merkle_info_store(cache, path, st, compress, out_info) != ZX_OK) {
+        FS_TRACE_WARN("blobfs: Failed to cache Merkle tree for '%s'\n", path);
+    }
+    return ZX_OK;
+}
+
 zx_status_t blobfs_add_blob(Blobfs* bs, int data_fd) {
     FileMapping mapping;
     zx_status_t status = mapping.Map(data_fd);
@@ -475,16 +598,19 @@ zx_status_t Blobfs::WriteNode(fbl::unique_ptr<InodeBlock> ino_block) {
 zx_status_t Blobfs::WriteData(Inode* inode, const void* merkle_data, const void* blob_data) {
     const size_t merkle_blocks = MerkleTreeBlocks(*inode);
     const size_t data_blocks = inode->block_count - merkle_blocks;
-    for (size_t n = 0; n < merkle_blocks; n++) {
-        const void* data = fs::GetBlock(kBlobfsBlockSize, merkle_data, n);
-        uint64_t bno = data_start_block_ + inode->extents[0].Start() + n;
-        zx_status_t status;
-        if ((status = WriteBlock(bno, data)) != ZX_OK) {
-            return status;
-        }
+    const uint64_t start = data_start_block_ + inode->extents[0].Start();
+    zx_status_t status;
+    if ((status = WriteBlocks(start, merkle_blocks, merkle_data)) != ZX_OK) {
+        return status;
+    }
+
+    // Blocks lying entirely within the source buffer are written directly.
+    const size_t full_blocks = fbl::min<size_t>(data_blocks, inode->blob_size / kBlobfsBlockSize);
+    if ((status = WriteBlocks(start + merkle_blocks, full_blocks, blob_data)) != ZX_OK) {
+        return status;
     }
 
-    for (size_t n = 0; n < data_blocks; n++) {
+    for (size_t n = full_blocks; n < data_blocks; n++) {
         const void* data = fs::GetBlock(kBlobfsBlockSize, blob_data, n);
 
         // If we try to write a block, will it be reaching beyond the end of the
@@ -498,8 +624,7 @@ zx_status_t Blobfs::WriteData(Inode* inode, const void* merkle_data, const void*
             data = last_data;
         }
 
-        uint64_t bno = data_start_block_ + inode->extents[0].Start() + merkle_blocks + n;
-        zx_status_t status;
+        uint64_t bno = start + merkle_blocks + n;
         if ((status = WriteBlock(bno, data)) != ZX_OK) {
             return status;
         }
@@ -530,6 +655,10 @@ zx_status_t Blobfs::WriteBlock(size_t bno, const void* data) {
     return writeblk_offset(blockfd_.get(), bno, offset_, data);
 }
 
+zx_status_t Blobfs::WriteBlocks(size_t bno, size_t count, const void* data) {
+    return writeblks_offset(blockfd_.get(), bno, count, offset_, data);
+}
+
 zx_status_t Blobfs::ResetCache() {
     if (dirty_) {
         return ZX_ERR_ACCESS_DENIED;
@@ -16,6 +16,7 @@
 #include <fbl/algorithm.h>
 #include <fbl/intrusive_wavl_tree.h>
 #include <fbl/macros.h>
+#include <fbl/mutex.h>
 #include <fbl/ref_ptr.h>
 #include <fbl/unique_ptr.h>
 #include <fbl/vector.h>
@@ -244,6 +245,11 @@ private:
     BlobFlags flags_ = {};
     std::atomic_bool syncing_;
 
+    // Held while the blob is read into |mapping_|, and while clones of it are
+    // handed out or stop being watched, since readers may be dispatched on
+    // several threads at once.
+    fbl::Mutex vmo_lock_;
+
     // The mapping here consists of:
     // 1) The Merkle Tree
     // 2) The Blob itself, aligned to the nearest kBlobfsBlockSize
@@ -66,6 +66,9 @@ struct MountOptions {
     bool metrics = false;
     bool journal = false;
     CachePolicy cache_policy = CachePolicy::EvictImmediately;
+    // Number of threads the caller runs the dispatcher on. With more than
+    // one, reads of blobs are handled in parallel.
+    uint32_t dispatch_threads = 1;
 };
 
 class Blobfs : public fs::ManagedVfs,
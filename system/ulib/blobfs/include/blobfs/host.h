@@ -16,6 +16,7 @@
 #include <bitmap/raw-bitmap.h>
 #include <bitmap/storage.h>
 #include <digest/digest.h>
+#include <digest/merkle-cache.h>
 #include <fbl/algorithm.h>
 #include <fbl/macros.h>
 #include <fbl/ref_counted.h>
@@ -150,6 +151,9 @@ public:
     // Allocate |nblocks| starting at |*blkno_out| in memory
     zx_status_t AllocateBlocks(size_t nblocks, size_t* blkno_out);
 
+    // Writes the merkle tree and data of the blob described by |inode| to its allocated blocks.
+    // Only touches the blocks reserved for |inode|, and may be called concurrently with other
+    // operations.
     zx_status_t WriteData(Inode* inode, const void* merkle_data,
                           const void* blob_data);
     zx_status_t WriteBitmap(size_t nblocks, size_t start_block);
@@ -194,6 +198,9 @@ private:
     // Write |data| into block |bno|
     zx_status_t WriteBlock(size_t bno, const void* data);
 
+    // Write |count| blocks of |data| starting at block |bno|
+    zx_status_t WriteBlocks(size_t bno, size_t count, const void* data);
+
     zx_status_t ResetCache();
 
     zx_status_t VerifyBlob(uint32_t node_index);
@@ -230,11 +237,19 @@ zx_status_t blobfs_create(fbl::unique_ptr<Blobfs>* out, fbl::unique_fd blockfd);
 // the compressed length and data are returned.
 zx_status_t blobfs_preprocess(int data_fd, bool compress, MerkleInfo* out_info);
 
+// Identical to blobfs_preprocess, but reuses the Merkle tree and compressed form of the
+// file at |path| (open as |data_fd|) from |cache| where possible, and records them there
+// otherwise.
+zx_status_t blobfs_preprocess_cached(const digest::MerkleCache& cache, const char* path,
+                                     int data_fd, bool compress, MerkleInfo* out_info);
+
 // blobfs_add_blob may be called by multiple threads to gain concurrent
-// merkle tree generation. No other methods are thread safe.
+// merkle tree generation and data writeback; only inode and block allocation
+// are serialized. No other methods are thread safe.
 zx_status_t blobfs_add_blob(Blobfs* bs, int data_fd);
 
 // Identical to blobfs_add_blob, but uses a precomputed Merkle Tree and digest.
+// May be called concurrently with itself and blobfs_add_blob.
 zx_status_t blobfs_add_blob_with_merkle(Blobfs* bs, int data_fd, const MerkleInfo& info);
 
 zx_status_t blobfs_fsck(fbl::unique_fd fd, off_t start, off_t end,
@@ -20,6 +20,7 @@ static_assert(false, "Fuchsia only header");
 #include <fbl/intrusive_single_list.h>
 #include <fbl/mutex.h>
 #include <fbl/unique_ptr.h>
+#include <fbl/vector.h>
 #include <zircon/types.h>
 
 namespace blobfs {
@@ -224,7 +225,8 @@ public:
     zx_status_t Load();
 
     // Checks for any existing journal entries starting at the |start| indicated in the super block,
-    // and replays all valid entries in order.
+    // and replays all valid entries. Entries are verified in parallel, and only the latest version
+    // of each block is written out.
     // This method must be called before the journal background thread is initialized.
     zx_status_t Replay();
 
@@ -314,11 +316,28 @@ private:
     bool VerifyEntryMetadata(size_t header_index, uint64_t last_timestamp, bool expected_valid)
         __TA_REQUIRES(lock_);
 
-    // Checks if the entry at |header_index| is valid, and if so replays the entry.
-    // Takes in |remaining_length| of the journal to determine whether we expect this entry to
-    // exist or not. Returns the number of |entry_blocks| and the entry |timestamp|.
-    zx_status_t ReplayEntry(size_t header_index, size_t remaining_length, uint64_t* entry_blocks,
-                            uint64_t* timestamp) __TA_REQUIRES(lock_);
+    // Returns true if the checksum in the commit block of the entry at |header_index| matches the
+    // entry's contents. The header and commit blocks must already have been checked with
+    // VerifyEntryMetadata. Safe to call from several threads at once during replay.
+    bool VerifyEntryChecksum(size_t header_index);
+
+    // Verifies the checksums of the |count| entries at |header_indices| in parallel, and returns
+    // in |out_valid| the number of entries before the first one which is corrupt.
+    zx_status_t VerifyEntryChecksums(const size_t* header_indices, size_t count,
+                                     size_t* out_valid) __TA_REQUIRES(lock_);
+
+    // Writes out the data of the |count| entries at |header_indices| to its target blocks.
+    // Blocks written by several entries are only written once, from the latest entry, and
+    // contiguous blocks are written together. Returns the number of blocks written in
+    // |out_blocks|.
+    zx_status_t ReplayEntries(const size_t* header_indices, size_t count, size_t* out_blocks)
+        __TA_REQUIRES(lock_);
+
+    // Shared state for the threads started by VerifyEntryChecksums.
+    struct ChecksumContext;
+
+    // Thread which verifies entry checksums on behalf of VerifyEntryChecksums.
+    static int ChecksumThread(void* arg);
 
     // Commits the replay by updating the journal info block and syncing all writes to disk.
     zx_status_t CommitReplay() __TA_REQUIRES(lock_);
@@ -434,6 +453,9 @@ public:
     }
 
     void ProcessWorkEntry(fbl::unique_ptr<JournalEntry> entry);
+
+    // Moves persisted entries from the wait queue to the delete queue, and enqueues the writes
+    // of their data to its final on-disk location.
     void ProcessWaitQueue();
     void ProcessDeleteQueue();
     void ProcessSyncQueue();
@@ -492,6 +514,10 @@ private:
     // Action to take for an unsupported state.
     ProcessResult ProcessUnsupported();
 
+    // Enqueues the works taken from entries by ProcessWaitDefault, first dropping any writes
+    // which a later work of the same batch overwrites.
+    void EnqueueCheckpoint();
+
     JournalBase* journal_;
     bool error_;
     fbl::unique_ptr<WritebackWork> work_;
@@ -513,5 +539,9 @@ private:
     // Stores any sync works pulled from the delete queue in this sync queue, so we can
     // complete them after we update the journal's info block.
     EntryQueue sync_queue_;
+
+    // Works taken from persisted entries in the wait queue which have not yet been enqueued,
+    // in journal order.
+    fbl::Vector<fbl::unique_ptr<WritebackWork>> checkpoint_works_;
 };
 } // blobfs
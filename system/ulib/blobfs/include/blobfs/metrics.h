@@ -10,6 +10,7 @@
 #error Fuchsia-only Header
 #endif
 
+#include <fbl/mutex.h>
 #include <lib/zx/time.h>
 #include <fs/ticker.h>
 
@@ -92,6 +93,10 @@ private:
 
     // LOOKUP STATS
 
+    // Blobs are read from disk, and verified, by whichever dispatcher thread
+    // first reads them, so these may be updated by several threads at once.
+    fbl::Mutex read_lock_;
+
     // Total time waiting for reads from disk.
     zx::ticks total_read_from_disk_time_ticks_ = {};
     uint64_t bytes_read_from_disk_ = 0;
@@ -66,6 +66,10 @@ public:
 
     fbl::Vector<WriteRequest>& Requests() { return requests_; }
 
+    // Drops the writes to any of the device |blocks|, which must be sorted in ascending order.
+    // Used when those blocks are known to be overwritten by a later transaction.
+    void RemoveBlocks(const fbl::Vector<uint64_t>& blocks);
+
     // Returns the first block at which this WriteTxn exists within its VMO buffer.
     // Requires all requests within the transaction to have been copied to a single buffer.
     size_t BlkStart() const;
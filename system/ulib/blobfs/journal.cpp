@@ -3,16 +3,25 @@
 // found in the LICENSE file.
 
 #include <blobfs/journal.h>
+#include <fbl/algorithm.h>
+#include <fbl/alloc_checker.h>
 #include <fbl/unique_ptr.h>
+#include <fbl/vector.h>
 #include <lib/cksum.h>
+#include <threads.h>
+#include <zircon/syscalls.h>
 #include <zircon/types.h>
 
+#include <algorithm>
 #include <utility>
 
 namespace blobfs {
 
 // TODO(ZX-2415): Add tracing/metrics collection to journal related operations.
 
+// The maximum number of threads used to verify entry checksums during replay.
+constexpr size_t kMaxChecksumThreads = 8;
+
 // Thread which asynchronously processes journal entries.
 static int JournalThread(void* arg) {
     Journal* journal = reinterpret_cast<Journal*>(arg);
@@ -20,6 +29,12 @@ static int JournalThread(void* arg) {
     return 0;
 }
 
+// A journaled block found during replay, and the block on disk it is intended for.
+struct ReplayBlock {
+    uint64_t target;
+    size_t vmo_block;
+};
+
 JournalEntry::JournalEntry(JournalBase* journal, EntryStatus status, size_t header_index,
                            size_t commit_index, fbl::unique_ptr<WritebackWork> work)
         : journal_(journal), status_(static_cast<uint32_t>(status)), block_count_(0),
@@ -212,37 +227,70 @@ zx_status_t Journal::Replay() {
     uint64_t timestamp = 0;
     size_t start = GetInfo()->start_block;
     size_t length = GetInfo()->num_blocks;
-    size_t total_entries = 0;
-    size_t total_blocks = 0;
 
-    // Replay entries until we find one that isn't valid.
-    while (true) {
-        uint64_t entry_blocks;
-        // |start| is the header index of the next entry.
-        zx_status_t status = ReplayEntry(start, length, &entry_blocks, &timestamp);
-        if (status == ZX_ERR_OUT_OF_RANGE) {
-            break;
-        } else if (status != ZX_OK) {
-            return status;
+    // Find the entries to replay, checking only their header and commit blocks for now. The
+    // checksums cover all blocks of each entry, so they are verified afterwards, in parallel.
+    fbl::Vector<size_t> header_indices;
+    size_t header_index = start;
+    size_t remaining_length = length;
+    while (VerifyEntryMetadata(header_index, timestamp, remaining_length > 0)) {
+        HeaderBlock* header = GetHeaderBlock(header_index);
+        size_t entry_blocks = header->num_blocks + kEntryMetadataBlocks;
+        // We have found a valid entry - ensure that remaining_length is valid
+        // (either 0 remaining, or enough to fit this entry).
+        ZX_DEBUG_ASSERT(remaining_length == 0 || remaining_length >= entry_blocks);
+
+        fbl::AllocChecker ac;
+        header_indices.push_back(header_index, &ac);
+        if (!ac.check()) {
+            return ZX_ERR_NO_MEMORY;
         }
 
-        total_entries++;
-        total_blocks += entry_blocks;
+        timestamp = header->timestamp;
+        header_index = (header_index + entry_blocks) % entries_->capacity();
+        if (remaining_length) {
+            remaining_length -= entry_blocks;
+        }
+    }
+
+    // Replay entries up to the first one that isn't valid.
+    size_t total_entries;
+    zx_status_t status = VerifyEntryChecksums(header_indices.get(), header_indices.size(),
+                                              &total_entries);
+    if (status != ZX_OK) {
+        return status;
+    }
 
-        start += entry_blocks;
-        start %= entries_->capacity();
+    if (total_entries < header_indices.size()) {
+        FS_TRACE_ERROR("Journal Replay Error: commit checksum does not match expected\n");
+    }
 
-        if (length) {
-            length -= entry_blocks;
-        }
+    size_t total_blocks = 0;
+    for (size_t i = 0; i < total_entries; i++) {
+        total_blocks += GetHeaderBlock(header_indices[i])->num_blocks + kEntryMetadataBlocks;
     }
 
+    // |start| is now the header index of the entry following the last one replayed.
+    start = (start + total_blocks) % entries_->capacity();
+    length = length > total_blocks ? length - total_blocks : 0;
+
     // TODO(planders): Sync to ensure that all entries have been written out before resetting the
     //                 on-disk state of the journal.
     if (total_entries > 0) {
+        // Replay (and therefore mount) will fail if we cannot enqueue the replay work. Since the
+        // journal itself is not corrupt (at least up to this point), we would expect replay to
+        // succeed on a subsequent attempt, so we should keep any existing entries intact. (i.e.,
+        // do not reset the journal metadata in this failure case).
+        size_t written_blocks;
+        if ((status = ReplayEntries(header_indices.get(), total_entries,
+                                    &written_blocks)) != ZX_OK) {
+            FS_TRACE_ERROR("Journal replay failed with status %d\n", status);
+            return status;
+        }
+
         printf("Found and replayed %zu total blobfs journal entries starting from index %zu, "
-               "including %zu total blocks.\n",
-               total_entries, GetInfo()->start_block, total_blocks);
+               "including %zu total blocks (%zu distinct metadata blocks written).\n",
+               total_entries, GetInfo()->start_block, total_blocks, written_blocks);
     } else if (start == 0 && length == 0) {
         // If no entries were found and journal is already in its default state,
         // return without writing out any changes.
@@ -253,7 +301,7 @@ zx_status_t Journal::Replay() {
     // We expect length to be 0 at this point, assuming the journal was not corrupted and replay
     // completed successfully. However, in the case of corruption of the journal this may not be the
     // case. Since we cannot currently recover from this situation we should proceed as normal.
-    zx_status_t status = CommitReplay();
+    status = CommitReplay();
     if (status != ZX_OK) {
         return status;
     }
@@ -503,11 +551,13 @@ zx_status_t Journal::EnqueueEntryWork(fbl::unique_ptr<WritebackWork> work) {
 bool Journal::VerifyEntryMetadata(size_t header_index, uint64_t last_timestamp, bool expect_valid) {
     HeaderBlock* header = GetHeaderBlock(header_index);
     // If length_ > 0, the next entry should be guaranteed.
-    if (header->magic != kEntryHeaderMagic || header->timestamp <= last_timestamp) {
-        // If the next calculated header block is either 1) not a header block, or 2) does not
-        // have a timestamp strictly later than the previous entry, it is not a valid entry and
-        // should not be replayed. This is only a journal replay "error" if, according to the
-        // journal super block, we still have some entries left to process (i.e. length_ > 0).
+    if (header->magic != kEntryHeaderMagic || header->timestamp <= last_timestamp ||
+        header->num_blocks > kMaxEntryDataBlocks) {
+        // If the next calculated header block is either 1) not a header block, 2) does not
+        // have a timestamp strictly later than the previous entry, or 3) claims more blocks than
+        // an entry may hold, it is not a valid entry and should not be replayed. This is only a
+        // journal replay "error" if, according to the journal super block, we still have some
+        // entries left to process (i.e. length_ > 0).
         if (expect_valid) {
             FS_TRACE_ERROR("Journal Replay Error: invalid header found.\n");
         }
@@ -528,53 +578,166 @@ bool Journal::VerifyEntryMetadata(size_t header_index, uint64_t last_timestamp,
         return false;
     }
 
+    return true;
+}
+
+bool Journal::VerifyEntryChecksum(size_t header_index) {
+    HeaderBlock* header = GetHeaderBlock(header_index);
+    size_t commit_index = (header_index + header->num_blocks + 1) % entries_->capacity();
+
     // Calculate the checksum of the entry data to verify the commit block's checksum.
-    uint32_t checksum = GenerateChecksum(header_index, commit_index);
+    // Since we already found a valid header, we expect this to be a valid entry.
+    return GetCommitBlock(commit_index)->checksum == GenerateChecksum(header_index, commit_index);
+}
 
-    // Since we already found a valid header, we expect this to be a valid entry. If something
-    // in the commit block does not match what we expect, this is an error.
-    if (commit->checksum != checksum) {
-        FS_TRACE_ERROR("Journal Replay Error: commit checksum does not match expected\n");
-        return false;
+struct Journal::ChecksumContext {
+    Journal* journal;
+    const size_t* header_indices;
+    bool* valid;
+    size_t count;
+    std::atomic<size_t> next;
+};
+
+int Journal::ChecksumThread(void* arg) {
+    ChecksumContext* context = static_cast<ChecksumContext*>(arg);
+    size_t i;
+    while ((i = context->next.fetch_add(1)) < context->count) {
+        context->valid[i] = context->journal->VerifyEntryChecksum(context->header_indices[i]);
     }
+    return 0;
+}
 
-    return true;
+zx_status_t Journal::VerifyEntryChecksums(const size_t* header_indices, size_t count,
+                                          size_t* out_valid) {
+    if (count == 0) {
+        *out_valid = 0;
+        return ZX_OK;
+    }
+
+    fbl::AllocChecker ac;
+    fbl::unique_ptr<bool[]> valid(new (&ac) bool[count]);
+    if (!ac.check()) {
+        return ZX_ERR_NO_MEMORY;
+    }
+
+    ChecksumContext context;
+    context.journal = this;
+    context.header_indices = header_indices;
+    context.valid = valid.get();
+    context.count = count;
+    context.next.store(0);
+
+    // The calling thread verifies entries too, so start one thread fewer than we want. If a
+    // thread cannot be started, the remaining threads simply take on more of the entries.
+    size_t thread_count = fbl::min(fbl::min(static_cast<size_t>(zx_system_get_num_cpus()),
+                                            kMaxChecksumThreads), count);
+    thrd_t threads[kMaxChecksumThreads];
+    size_t started = 0;
+    while (started + 1 < thread_count) {
+        if (thrd_create_with_name(&threads[started], ChecksumThread, &context,
+                                  "blobfs-replay") != thrd_success) {
+            break;
+        }
+        started++;
+    }
+
+    ChecksumThread(&context);
+    for (size_t i = 0; i < started; i++) {
+        thrd_join(threads[i], nullptr);
+    }
+
+    size_t valid_count = 0;
+    while (valid_count < count && valid[valid_count]) {
+        valid_count++;
+    }
+
+    *out_valid = valid_count;
+    return ZX_OK;
 }
 
-zx_status_t Journal::ReplayEntry(size_t header_index, size_t remaining_length,
-                                 uint64_t* entry_blocks, uint64_t* timestamp) {
+zx_status_t Journal::ReplayEntries(const size_t* header_indices, size_t count,
+                                   size_t* out_blocks) {
     ZX_DEBUG_ASSERT(state_ == WritebackState::kInit);
 
-    bool expect_valid = remaining_length > 0;
-    if (!VerifyEntryMetadata(header_index, *timestamp, expect_valid)) {
-        return ZX_ERR_OUT_OF_RANGE;
+    size_t block_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        block_count += GetHeaderBlock(header_indices[i])->num_blocks;
     }
 
-    HeaderBlock* header = GetHeaderBlock(header_index);
-    *timestamp = header->timestamp;
-    *entry_blocks = header->num_blocks + 2;
-    // We have found a valid entry - ensure that remaining_length is valid
-    // (either 0 remaining, or enough to fit this entry).
-    ZX_DEBUG_ASSERT(remaining_length == 0 || remaining_length >= *entry_blocks);
+    fbl::AllocChecker ac;
+    fbl::Vector<ReplayBlock> blocks;
+    blocks.reserve(block_count, &ac);
+    if (!ac.check()) {
+        return ZX_ERR_NO_MEMORY;
+    }
 
-    fbl::unique_ptr<WritebackWork> work = CreateWork();
+    for (size_t i = 0; i < count; i++) {
+        HeaderBlock* header = GetHeaderBlock(header_indices[i]);
+        for (unsigned j = 0; j < header->num_blocks; j++) {
+            size_t vmo_block = (header_indices[i] + j + 1) % entries_->capacity();
+            blocks.push_back({header->target_blocks[j], vmo_block});
+        }
+    }
+
+    // Order the blocks by target, keeping the journal order of blocks with the same target, so
+    // that the last of them is the latest version of that block.
+    std::stable_sort(blocks.begin(), blocks.end(), [](const ReplayBlock& a, const ReplayBlock& b) {
+        return a.target < b.target;
+    });
+
+    // Returns the index of the latest version of the block at |index|.
+    auto latest = [&blocks](size_t index) {
+        while (index + 1 < blocks.size() && blocks[index + 1].target == blocks[index].target) {
+            index++;
+        }
+        return index;
+    };
 
-    // Enqueue one block at a time, since they may not end up being contiguous on disk.
-    for (unsigned i = 0; i < header->num_blocks; i++) {
-        size_t vmo_block = (header_index + i + 1) % entries_->capacity();
-        entries_->AddTransaction(vmo_block, header->target_blocks[i], 1, work.get());
+    // Enqueue the writes in works of at most kMaxEntryDataBlocks requests, the same limit which
+    // applies to the works of journal entries.
+    fbl::unique_ptr<WritebackWork> work;
+    size_t requests = 0;
+    size_t written = 0;
+    zx_status_t status;
+    for (size_t i = 0; i < blocks.size();) {
+        i = latest(i);
+        uint64_t target = blocks[i].target;
+        size_t vmo_block = blocks[i].vmo_block;
+        size_t length = 1;
+        i++;
+
+        // Extend the request for as long as the latest versions of the following blocks are
+        // contiguous both on disk and in the journal.
+        while (i < blocks.size()) {
+            size_t next = latest(i);
+            if (blocks[next].target != target + length ||
+                blocks[next].vmo_block != vmo_block + length) {
+                break;
+            }
+            length++;
+            i = next + 1;
+        }
+
+        if (work == nullptr) {
+            work = CreateWork();
+        }
+        entries_->AddTransaction(vmo_block, target, length, work.get());
+        written += length;
+
+        if (++requests == kMaxEntryDataBlocks) {
+            if ((status = EnqueueEntryWork(std::move(work))) != ZX_OK) {
+                return status;
+            }
+            requests = 0;
+        }
     }
 
-    // Replay (and therefore mount) will fail if we cannot enqueue the replay work. Since the
-    // journal itself is not corrupt (at least up to this point), we would expect replay to
-    // succeed on a subsequent attempt, so we should keep any existing entries intact. (i.e.,
-    // do not reset the journal metadata in this failure case).
-    zx_status_t status = EnqueueEntryWork(std::move(work));
-    if (status != ZX_OK) {
-        FS_TRACE_ERROR("Journal replay failed with status %d\n", status);
+    if (work != nullptr && (status = EnqueueEntryWork(std::move(work))) != ZX_OK) {
+        return status;
     }
 
-    return status;
+    *out_blocks = written;
+    return ZX_OK;
 }
 
 zx_status_t Journal::CommitReplay() {
@@ -848,6 +1011,7 @@ void JournalProcessor::ProcessWorkEntry(fbl::unique_ptr<JournalEntry> entry) {
 void JournalProcessor::ProcessWaitQueue() {
     SetContext(ProcessorContext::kWait);
     ProcessQueue(&wait_queue_, &delete_queue_);
+    EnqueueCheckpoint();
 }
 
 void JournalProcessor::ProcessDeleteQueue() {
@@ -1003,8 +1167,9 @@ ProcessResult JournalProcessor::ProcessWorkDefault(JournalEntry* entry) {
 ProcessResult JournalProcessor::ProcessWaitDefault(JournalEntry* entry) {
     EntryStatus last_status = entry->SetStatus(EntryStatus::kWaiting);
     ZX_DEBUG_ASSERT(last_status == EntryStatus::kPersisted);
-    fbl::unique_ptr<WritebackWork> work = entry->TakeWork();
-    journal_->EnqueueEntryWork(std::move(work));
+    // Hold on to the work until the rest of the wait queue has been processed, so that writes
+    // to the same block by several entries can be coalesced.
+    checkpoint_works_.push_back(entry->TakeWork());
     return ProcessResult::kContinue;
 }
 
@@ -1066,6 +1231,34 @@ ProcessResult JournalProcessor::ProcessErrorComplete(JournalEntry* entry) {
     return ProcessResult::kRemove;
 }
 
+void JournalProcessor::EnqueueCheckpoint() {
+    // Entries often update the same metadata blocks (e.g. a bitmap or inode table block), and
+    // only the last of those updates needs to be written to disk. Visit the works from newest to
+    // oldest, dropping the blocks a newer work will write. This is safe, since a newer entry is
+    // not removed from the journal until its own work has completed - if we crash before then,
+    // the entry is replayed on the next mount.
+    fbl::Vector<uint64_t> written;
+    for (size_t i = checkpoint_works_.size(); i-- > 0;) {
+        WritebackWork* work = checkpoint_works_[i].get();
+        work->RemoveBlocks(written);
+        if (i == 0) {
+            break;
+        }
+
+        for (const WriteRequest& request : work->Requests()) {
+            for (size_t j = 0; j < request.length; j++) {
+                written.push_back(request.dev_offset + j);
+            }
+        }
+        std::sort(written.begin(), written.end());
+    }
+
+    for (size_t i = 0; i < checkpoint_works_.size(); i++) {
+        journal_->EnqueueEntryWork(std::move(checkpoint_works_[i]));
+    }
+    checkpoint_works_.reset();
+}
+
 ProcessResult JournalProcessor::ProcessUnsupported() {
     ZX_ASSERT(false);
     return ProcessResult::kRemove;
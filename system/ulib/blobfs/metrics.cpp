@@ -7,6 +7,7 @@
 #include <stdio.h>
 
 #include <blobfs/metrics.h>
+#include <fbl/auto_lock.h>
 #include <fs/trace.h>
 #include <lib/fzl/time.h>
 #include <lib/zx/time.h>
@@ -86,6 +87,7 @@ void BlobfsMetrics::UpdateWriteback(uint64_t size, const fs::Duration& duration)
 
 void BlobfsMetrics::UpdateMerkleDiskRead(uint64_t size, const fs::Duration& duration) {
     if (Collecting()) {
+        fbl::AutoLock lock(&read_lock_);
         total_read_from_disk_time_ticks_ += duration;
         bytes_read_from_disk_ += size;
     }
@@ -96,6 +98,7 @@ void BlobfsMetrics::UdpateMerkleDecompress(uint64_t size_compressed,
                                            const fs::Duration& read_duration,
                                            const fs::Duration& decompress_duration) {
     if (Collecting()) {
+        fbl::AutoLock lock(&read_lock_);
         bytes_compressed_read_from_disk_ += size_compressed;
         bytes_decompressed_from_disk_ += size_uncompressed;
         total_read_compressed_time_ticks_ += read_duration;
@@ -106,6 +109,7 @@ void BlobfsMetrics::UdpateMerkleDecompress(uint64_t size_compressed,
 void BlobfsMetrics::UpdateMerkleVerify(uint64_t size_data, uint64_t size_merkle,
                                        const fs::Duration& duration) {
     if (Collecting()) {
+        fbl::AutoLock lock(&read_lock_);
         blobs_verified_++;
         blobs_verified_total_size_data_ += size_data;
         blobs_verified_total_size_merkle_ += size_merkle;
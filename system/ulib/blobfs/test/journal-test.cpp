@@ -33,12 +33,13 @@ public:
         return CreateWork();
     }
 
-    fbl::unique_ptr<WritebackWork> CreateBufferedWork(size_t block_count) {
+    fbl::unique_ptr<WritebackWork> CreateBufferedWork(size_t block_count,
+                                                      size_t dev_offset = 0) {
         fbl::unique_ptr<WritebackWork> work = CreateWork();
 
         zx::vmo vmo;
         ZX_ASSERT(zx::vmo::create(PAGE_SIZE, 0, &vmo) == ZX_OK);
-        work->Enqueue(vmo, 0, 0, block_count);
+        work->Enqueue(vmo, 0, dev_offset, block_count);
         work->SetBuffer(2);
         return work;
     }
@@ -189,10 +190,68 @@ static bool JournalProcessorResetWorkTest() {
     END_TEST;
 }
 
+static bool JournalProcessorCoalesceCheckpointTest() {
+    BEGIN_TEST;
+    // Create a dummy journal and journal processor.
+    FakeJournal journal;
+    JournalProcessor processor(&journal);
+
+    // Create and process a 'work' entry writing blocks 0 through 3.
+    fbl::unique_ptr<JournalEntry> entry(
+        new JournalEntry(&journal, EntryStatus::kInit, 0, 5, journal.CreateBufferedWork(4, 0)));
+    fbl::unique_ptr<WritebackWork> first_work = journal.CreateDefaultWork();
+    first_work->SetSyncCallback(entry->CreateSyncCallback());
+    processor.ProcessWorkEntry(std::move(entry));
+
+    // Create and process another 'work' entry, overwriting blocks 2 and 3.
+    entry.reset(new JournalEntry(&journal, EntryStatus::kInit, 6, 11,
+                                 journal.CreateBufferedWork(4, 2)));
+    fbl::unique_ptr<WritebackWork> second_work = journal.CreateDefaultWork();
+    second_work->SetSyncCallback(entry->CreateSyncCallback());
+    processor.ProcessWorkEntry(std::move(entry));
+
+    // Enqueue and process the processor's work.
+    processor.EnqueueWork();
+    journal.DequeueWork()->MarkCompleted(ZX_OK);
+
+    // Persist both entries to the journal, and process the wait queue.
+    first_work->MarkCompleted(ZX_OK);
+    second_work->MarkCompleted(ZX_OK);
+    processor.ProcessWaitQueue();
+
+    first_work = journal.DequeueWork();
+    second_work = journal.DequeueWork();
+    ASSERT_NE(first_work.get(), nullptr);
+    ASSERT_NE(second_work.get(), nullptr);
+
+    // The first entry's writes to blocks 2 and 3 should have been dropped, since the second
+    // entry overwrites them.
+    ASSERT_EQ(first_work->Requests().size(), 1);
+    ASSERT_EQ(first_work->Requests()[0].dev_offset, 0);
+    ASSERT_EQ(first_work->Requests()[0].length, 2);
+    ASSERT_EQ(first_work->BlkCount(), 2);
+    ASSERT_EQ(second_work->Requests().size(), 1);
+    ASSERT_EQ(second_work->Requests()[0].dev_offset, 2);
+    ASSERT_EQ(second_work->BlkCount(), 4);
+
+    // Both entries should still be deleted once their works complete.
+    first_work->MarkCompleted(ZX_OK);
+    second_work->MarkCompleted(ZX_OK);
+    processor.ProcessDeleteQueue();
+    ASSERT_FALSE(processor.HasError());
+    ASSERT_EQ(processor.GetBlocksProcessed(), 12);
+
+    processor.EnqueueWork();
+    processor.ProcessSyncQueue();
+    ASSERT_TRUE(processor.IsEmpty());
+    END_TEST;
+}
+
 } // namespace
 } // namespace blobfs
 
 BEGIN_TEST_CASE(blobfsJournalTests)
 RUN_TEST(blobfs::JournalEntryLifetimeTest)
 RUN_TEST(blobfs::JournalProcessorResetWorkTest)
+RUN_TEST(blobfs::JournalProcessorCoalesceCheckpointTest)
 END_TEST_CASE(blobfsJournalTests);
@@ -4,6 +4,7 @@
 
 #include <blobfs/writeback.h>
 
+#include <algorithm>
 #include <utility>
 
 namespace blobfs {
@@ -47,6 +48,38 @@ void WriteTxn::Enqueue(const zx::vmo& vmo, uint64_t relative_block, uint64_t abs
     block_count_ += request.length;
 }
 
+void WriteTxn::RemoveBlocks(const fbl::Vector<uint64_t>& blocks) {
+    if (blocks.is_empty()) {
+        return;
+    }
+
+    fbl::Vector<WriteRequest> requests;
+    block_count_ = 0;
+    for (const WriteRequest& request : requests_) {
+        // Split the request around any removed blocks, keeping the runs in between.
+        size_t run = 0;
+        for (size_t i = 0; i <= request.length; i++) {
+            if (i < request.length &&
+                !std::binary_search(blocks.begin(), blocks.end(), request.dev_offset + i)) {
+                run++;
+                continue;
+            }
+
+            if (run > 0) {
+                WriteRequest kept = request;
+                kept.vmo_offset += i - run;
+                kept.dev_offset += i - run;
+                kept.length = run;
+                requests.push_back(kept);
+                block_count_ += run;
+                run = 0;
+            }
+        }
+    }
+
+    requests_.swap(requests);
+}
+
 size_t WriteTxn::BlkStart() const {
     ZX_DEBUG_ASSERT(IsBuffered());
     ZX_DEBUG_ASSERT(requests_.size() > 0);
@@ -2,16 +2,34 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <atomic>
 #include <string.h>
 
 #include <cobalt-client/cpp/counter-internal.h>
 #include <cobalt-client/cpp/counter.h>
 #include <zircon/assert.h>
+#include <zircon/compiler.h>
 
 #include <utility>
 
 namespace cobalt_client {
 namespace internal {
+namespace {
+
+// Slot assigned to the next thread to update a metric.
+std::atomic<uint32_t> next_shard(0);
+
+// One more than the calling thread's slot, or 0 if it hasn't been assigned one yet.
+thread_local uint32_t current_shard = 0;
+
+} // namespace
+
+uint32_t GetMetricShard() {
+    if (unlikely(current_shard == 0)) {
+        current_shard = next_shard.fetch_add(1, std::memory_order_relaxed) % kMetricShards + 1;
+    }
+    return current_shard - 1;
+}
 
 RemoteCounter::RemoteCounter(const RemoteMetricInfo& metric_info)
     : BaseCounter(), metric_info_(metric_info) {
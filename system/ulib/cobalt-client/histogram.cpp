@@ -102,20 +102,27 @@ void InitLazily(const MetricOptions& options, HistogramBucket* buckets, uint32_t
 }
 
 bool HistogramFlush(const RemoteMetricInfo& metric_info, Logger* logger,
-                    BaseCounter<uint64_t>* buckets, HistogramBucket* bucket_buffer,
-                    uint32_t num_buckets) {
+                    std::atomic<uint64_t>* buckets, uint32_t shard_stride,
+                    HistogramBucket* bucket_buffer, uint32_t num_buckets) {
     // Sets every bucket back to 0, not all buckets will be at the same instant, but
     // eventual consistency in the backend is good enough.
     for (uint32_t bucket_index = 0; bucket_index < num_buckets; ++bucket_index) {
-        bucket_buffer[bucket_index].count = buckets[bucket_index].Exchange();
+        uint64_t count = 0;
+        for (uint32_t shard = 0; shard < kMetricShards; ++shard) {
+            count += buckets[shard * shard_stride + bucket_index].exchange(
+                0, std::memory_order_relaxed);
+        }
+        bucket_buffer[bucket_index].count = count;
     }
     return logger->Log(metric_info, bucket_buffer, num_buckets);
 }
 
-void HistogramUndoFlush(BaseCounter<uint64_t>* buckets, HistogramBucket* bucket_buffer,
+void HistogramUndoFlush(std::atomic<uint64_t>* buckets, HistogramBucket* bucket_buffer,
                         uint32_t num_buckets) {
+    // Any slot will do, the counts are summed when read. Use the first one.
     for (uint32_t bucket_index = 0; bucket_index < num_buckets; ++bucket_index) {
-        buckets[bucket_index].Increment(bucket_buffer[bucket_index].count);
+        buckets[bucket_index].fetch_add(bucket_buffer[bucket_index].count,
+                                        std::memory_order_relaxed);
     }
 }
 
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <atomic>
+#include <stddef.h>
 #include <stdint.h>
 #include <unistd.h>
 
@@ -19,12 +20,25 @@ namespace internal {
 // Note: Everything on this namespace is internal, no external users should rely
 // on the behaviour of any of these classes.
 
+// Number of slots a metric's count is spread across. Each thread updates the
+// slot it was assigned the first time it touched any metric, so that threads
+// updating the same metric rarely write to the same cache line.
+constexpr uint32_t kMetricShards = 8;
+
+// Size of the cache line that a slot is padded to.
+constexpr size_t kMetricCacheLineSize = 64;
+
+// Returns the slot the calling thread updates, in [0, kMetricShards). Threads
+// are assigned slots round robin.
+uint32_t GetMetricShard();
+
 // BaseCounter and RemoteCounter differ in that the first is simply a thin wrapper over
-// an atomic while the second provides Cobalt Fidl specific API and holds more metric related
-// data for a full fledged metric.
+// a set of atomics while the second provides Cobalt Fidl specific API and holds more metric
+// related data for a full fledged metric.
 //
-// Thin wrapper on top of an atomic, which provides a fixed memory ordering for all calls.
-// Calls are inlined to reduce overhead.A
+// Thin wrapper on top of |kMetricShards| atomics, each on its own cache line, which provides
+// a fixed memory ordering for all calls. Increments only touch the calling thread's slot,
+// while reads sum every slot. Calls are inlined to reduce overhead.
 template <typename T>
 class BaseCounter {
 public:
@@ -34,28 +48,50 @@ public:
     // All atomic operations use this memory order.
     static constexpr auto kMemoryOrder = std::memory_order_relaxed;
 
-    BaseCounter()
-        : counter_(0) {}
+    BaseCounter() = default;
     BaseCounter(const BaseCounter&) = delete;
-    BaseCounter(BaseCounter&& other)
-        : counter_(other.Exchange(0)) {}
+    BaseCounter(BaseCounter&& other) { Increment(other.Exchange(0)); }
     BaseCounter& operator=(const BaseCounter&) = delete;
     BaseCounter& operator=(BaseCounter&&) = delete;
     ~BaseCounter() = default;
 
-    // Increments |counter_| by |val|.
-    void Increment(Type val = 1) { counter_.fetch_add(val, kMemoryOrder); }
-
-    // Returns the current value of|counter_| and resets it to |val|.
-    Type Exchange(Type val = 0) { return counter_.exchange(val, kMemoryOrder); }
-
-    // Returns the current value of |counter_|.
-    Type Load() const { return counter_.load(kMemoryOrder); }
+    // Increments the counter by |val|.
+    void Increment(Type val = 1) { slots_[GetMetricShard()].value.fetch_add(val, kMemoryOrder); }
+
+    // Returns the current value of the counter and resets it to |val|. Each slot is reset
+    // atomically, so every increment is returned by exactly one call, although increments
+    // made during the call may be left for the next one.
+    Type Exchange(Type val = 0) {
+        Type current = 0;
+        for (auto& slot : slots_) {
+            current += slot.value.exchange(0, kMemoryOrder);
+        }
+        if (val != 0) {
+            Increment(val);
+        }
+        return current;
+    }
+
+    // Returns the current value of the counter.
+    Type Load() const {
+        Type current = 0;
+        for (const auto& slot : slots_) {
+            current += slot.value.load(kMemoryOrder);
+        }
+        return current;
+    }
 
 protected:
     static_assert(fbl::is_integral<Type>::value, "Can only count integral types");
 
-    std::atomic<Type> counter_;
+    // Padded, rather than aligned, so that the counter can be allocated with plain new. Two
+    // values a cache line apart are never on the same line.
+    struct Slot {
+        std::atomic<Type> value{0};
+        char padding[kMetricCacheLineSize - sizeof(std::atomic<Type>)];
+    };
+
+    Slot slots_[kMetricShards];
 };
 
 // Counter which represents a standalone cobalt metric. Provides API for converting
@@ -4,11 +4,13 @@
 
 #pragma once
 
+#include <atomic>
 #include <stdint.h>
 #include <unistd.h>
 
 #include <cobalt-client/cpp/counter-internal.h>
 #include <cobalt-client/cpp/types-internal.h>
+#include <fbl/algorithm.h>
 #include <fbl/function.h>
 #include <fbl/string.h>
 #include <fbl/vector.h>
@@ -23,6 +25,11 @@ namespace internal {
 // that represent a histogram. Once constructed, unless moved, the class is thread-safe.
 // All allocations happen when constructed.
 //
+// Each of the |kMetricShards| slots holds a full set of buckets, padded to a whole number
+// of cache lines, and a thread only increments the buckets in its own slot. Reading a
+// bucket sums it across the slots. Keeping a slot's buckets together, rather than sharding
+// each bucket like a BaseCounter, keeps the histogram small.
+//
 // This class is not moveable, not copyable or assignable.
 // This class is thread-compatible.
 template <uint32_t num_buckets>
@@ -44,17 +51,26 @@ public:
     void IncrementCount(Bucket bucket, Count val = 1) {
         ZX_DEBUG_ASSERT_MSG(bucket < size(), "IncrementCount bucket(%u) out of range(%u).", bucket,
                             size());
-        buckets_[bucket].Increment(val);
+        buckets_[GetMetricShard() * kShardStride + bucket].fetch_add(val,
+                                                                      std::memory_order_relaxed);
     }
 
     Count GetCount(uint32_t bucket) const {
         ZX_DEBUG_ASSERT_MSG(bucket < size(), "GetCount bucket out of range.");
-        return buckets_[bucket].Load();
+        Count count = 0;
+        for (uint32_t shard = 0; shard < kMetricShards; ++shard) {
+            count += buckets_[shard * kShardStride + bucket].load(std::memory_order_relaxed);
+        }
+        return count;
     }
 
 protected:
-    // Counter for the abs frequency of every histogram bucket.
-    BaseCounter<uint64_t> buckets_[num_buckets];
+    // Number of buckets in each slot, including the padding.
+    static constexpr uint32_t kShardStride = static_cast<uint32_t>(
+        fbl::round_up(num_buckets * sizeof(Count), kMetricCacheLineSize) / sizeof(Count));
+
+    // Counter for the abs frequency of every histogram bucket, |kShardStride| per slot.
+    std::atomic<Count> buckets_[kMetricShards * kShardStride] = {};
 };
 
 // Free functions to move logic outside the templated class.
@@ -68,12 +84,13 @@ void InitLazily(const MetricOptions& options, HistogramBucket* buckets, uint32_t
 
 // Sets the count of each bucket in |bucket_buffer| to the respective value in
 // |buckets|, and sets the count in |buckets| to 0.
+// |buckets| holds |kMetricShards| slots of |shard_stride| buckets each.
 bool HistogramFlush(const RemoteMetricInfo& metric_info, Logger* logger,
-                    BaseCounter<uint64_t>* buckets, HistogramBucket* bucket_buffer,
-                    uint32_t num_buckets);
+                    std::atomic<uint64_t>* buckets, uint32_t shard_stride,
+                    HistogramBucket* bucket_buffer, uint32_t num_buckets);
 
 // Undo's an ungoing Flush effects.
-void HistogramUndoFlush(BaseCounter<uint64_t>* buckets, HistogramBucket* bucket_buffer,
+void HistogramUndoFlush(std::atomic<uint64_t>* buckets, HistogramBucket* bucket_buffer,
                         uint32_t num_buckets);
 
 // This class provides a histogram which represents a full fledged cobalt metric. The histogram
@@ -100,7 +117,8 @@ public:
     }
 
     bool Flush(Logger* logger) override {
-        return HistogramFlush(metric_info_, logger, this->buckets_, bucket_buffer_, num_buckets);
+        return HistogramFlush(metric_info_, logger, this->buckets_, this->kShardStride,
+                              bucket_buffer_, num_buckets);
     }
 
     void UndoFlush() override { HistogramUndoFlush(this->buckets_, bucket_buffer_, num_buckets); }
@@ -0,0 +1,89 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// This file describes a host-side, on-disk cache of Merkle trees, which lets
+// host tools that repeatedly hash mostly unchanged inputs (e.g. blobfs and
+// merkleroot) reuse earlier results.
+
+#pragma once
+
+#ifdef __Fuchsia__
+#error Host-only Header
+#endif
+
+#include <stdint.h>
+#include <sys/stat.h>
+
+#include <digest/digest.h>
+#include <fbl/array.h>
+#include <fbl/macros.h>
+#include <fbl/string.h>
+#include <fbl/unique_ptr.h>
+#include <zircon/types.h>
+
+#include <utility>
+
+namespace digest {
+
+// The cached results for one file's contents.
+struct MerkleCacheEntry {
+    // Merkle root and tree of the contents, which are |length| bytes long.
+    Digest digest;
+    uint64_t length = 0;
+    fbl::Array<uint8_t> tree;
+
+    // Tool-specific data derived from the same contents, such as the compressed
+    // form of a blob. If |has_payload| is set but |payload| is empty, the
+    // payload was computed but not worth keeping (e.g. the contents do not
+    // compress).
+    bool has_payload = false;
+    fbl::Array<uint8_t> payload;
+};
+
+// A directory of cached Merkle trees, safe to share between threads and
+// between concurrently running tools. It holds two kinds of files:
+//
+//  objects/<root>: The tree (and payload, if any) of some contents, named by
+//      their Merkle root, so identical files share one object.
+//  index/<hash of path>: The path, size and modification time a file had when
+//      it was last hashed, and the Merkle root of its contents then. This lets
+//      unchanged files be looked up without reading them.
+//
+// Every file is written under a temporary name and renamed into place, so
+// readers never observe partial entries. Entries which fail validation are
+// treated as missing.
+class MerkleCache {
+public:
+    DISALLOW_COPY_ASSIGN_AND_MOVE(MerkleCache);
+
+    // Opens the cache rooted at |path|, creating it if it does not exist.
+    static zx_status_t Create(const char* path, fbl::unique_ptr<MerkleCache>* out);
+
+    ~MerkleCache() {}
+
+    // Looks up the entry for the file at |path|, whose current attributes are
+    // |st|. Returns ZX_ERR_NOT_FOUND if the file was never cached, or has been
+    // modified since.
+    zx_status_t Lookup(const char* path, const struct stat& st, MerkleCacheEntry* out) const;
+
+    // Looks up the entry for the contents whose Merkle root is |digest|,
+    // regardless of which file they came from.
+    zx_status_t LookupContent(const Digest& digest, MerkleCacheEntry* out) const;
+
+    // Records |entry| as the contents of the file at |path|, whose attributes
+    // were |st| when |entry| was computed. An existing object for the same
+    // contents is only replaced if |entry| adds a payload to it.
+    zx_status_t Store(const char* path, const struct stat& st,
+                      const MerkleCacheEntry& entry) const;
+
+private:
+    explicit MerkleCache(fbl::String path) : path_(std::move(path)) {}
+
+    fbl::String ObjectPath(const Digest& digest) const;
+    fbl::String IndexPath(const char* path) const;
+
+    fbl::String path_;
+};
+
+} // namespace digest
@@ -0,0 +1,289 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <digest/merkle-cache.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <digest/merkle-tree.h>
+#include <fbl/algorithm.h>
+#include <fbl/alloc_checker.h>
+#include <fbl/string_printf.h>
+#include <fbl/unique_fd.h>
+#include <zircon/errors.h>
+
+#include <utility>
+
+namespace digest {
+namespace {
+
+constexpr uint64_t kObjectMagic = 0x31676a626f6c6b6dULL;  // "mklobjg1"
+constexpr uint64_t kIndexMagic = 0x3178646e696c6b6dULL;   // "mklindx1"
+
+constexpr uint32_t kObjectFlagPayload = 1;
+
+// On-disk header of an object file; followed by the tree and the payload.
+struct ObjectHeader {
+    uint64_t magic;
+    uint64_t length;
+    uint64_t tree_length;
+    uint64_t payload_length;
+    uint32_t flags;
+    uint32_t reserved;
+    uint8_t digest[Digest::kLength];
+};
+
+// On-disk contents of an index file; followed by the path.
+struct IndexRecord {
+    uint64_t magic;
+    uint64_t size;
+    uint64_t ino;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+    uint32_t path_length;
+    uint32_t reserved;
+    uint8_t digest[Digest::kLength];
+};
+
+void GetModificationTime(const struct stat& st, int64_t* sec, int64_t* nsec) {
+#ifdef __APPLE__
+    *sec = st.st_mtimespec.tv_sec;
+    *nsec = st.st_mtimespec.tv_nsec;
+#else
+    *sec = st.st_mtim.tv_sec;
+    *nsec = st.st_mtim.tv_nsec;
+#endif
+}
+
+bool ReadAll(int fd, void* data, size_t len) {
+    uint8_t* buf = static_cast<uint8_t*>(data);
+    while (len > 0) {
+        ssize_t r = read(fd, buf, len);
+        if (r <= 0) {
+            return false;
+        }
+        buf += r;
+        len -= r;
+    }
+    return true;
+}
+
+bool WriteAll(int fd, const void* data, size_t len) {
+    const uint8_t* buf = static_cast<const uint8_t*>(data);
+    while (len > 0) {
+        ssize_t r = write(fd, buf, len);
+        if (r <= 0) {
+            return false;
+        }
+        buf += r;
+        len -= r;
+    }
+    return true;
+}
+
+bool MakeDirectory(const char* path) {
+    return mkdir(path, 0755) == 0 || errno == EEXIST;
+}
+
+// Reads |len| bytes from |fd| into a newly allocated |out|.
+bool ReadArray(int fd, size_t len, fbl::Array<uint8_t>* out) {
+    if (len == 0) {
+        out->reset();
+        return true;
+    }
+    fbl::AllocChecker ac;
+    fbl::Array<uint8_t> data(new (&ac) uint8_t[len], len);
+    if (!ac.check() || !ReadAll(fd, data.get(), len)) {
+        return false;
+    }
+    *out = std::move(data);
+    return true;
+}
+
+struct Buffer {
+    const void* data;
+    size_t length;
+};
+
+// Writes the concatenation of |buffers| to a temporary file, which is then
+// renamed to |path|.
+zx_status_t WriteFileAtomically(const fbl::String& path, const Buffer* buffers, size_t count) {
+    char tmp[PATH_MAX];
+    if (snprintf(tmp, sizeof(tmp), "%s.XXXXXX", path.c_str()) >= PATH_MAX) {
+        return ZX_ERR_BAD_PATH;
+    }
+    fbl::unique_fd fd(mkstemp(tmp));
+    if (!fd) {
+        return ZX_ERR_IO;
+    }
+
+    bool ok = fchmod(fd.get(), 0644) == 0;
+    for (size_t i = 0; ok && i < count; i++) {
+        ok = WriteAll(fd.get(), buffers[i].data, buffers[i].length);
+    }
+    fd.reset();
+
+    if (!ok || rename(tmp, path.c_str()) != 0) {
+        unlink(tmp);
+        return ZX_ERR_IO;
+    }
+    return ZX_OK;
+}
+
+// Reads the header of the object open at |fd|, checking it describes |digest|.
+bool ReadObjectHeader(int fd, const Digest& digest, ObjectHeader* out) {
+    struct stat st;
+    if (!ReadAll(fd, out, sizeof(*out)) || fstat(fd, &st) != 0) {
+        return false;
+    }
+    return out->magic == kObjectMagic && digest == out->digest &&
+           out->tree_length == MerkleTree::GetTreeLength(out->length) &&
+           static_cast<uint64_t>(st.st_size) ==
+               sizeof(*out) + out->tree_length + out->payload_length;
+}
+
+} // namespace
+
+zx_status_t MerkleCache::Create(const char* path, fbl::unique_ptr<MerkleCache>* out) {
+    fbl::String root(path);
+    if (!MakeDirectory(root.c_str()) ||
+        !MakeDirectory(fbl::StringPrintf("%s/objects", root.c_str()).c_str()) ||
+        !MakeDirectory(fbl::StringPrintf("%s/index", root.c_str()).c_str())) {
+        fprintf(stderr, "error: cannot create Merkle cache at '%s': %s\n", path,
+                strerror(errno));
+        return ZX_ERR_IO;
+    }
+
+    out->reset(new MerkleCache(std::move(root)));
+    return ZX_OK;
+}
+
+zx_status_t MerkleCache::Lookup(const char* path, const struct stat& st,
+                                MerkleCacheEntry* out) const {
+    char real_path[PATH_MAX];
+    if (realpath(path, real_path) == nullptr) {
+        return ZX_ERR_NOT_FOUND;
+    }
+
+    fbl::unique_fd fd(open(IndexPath(real_path).c_str(), O_RDONLY));
+    IndexRecord record;
+    if (!fd || !ReadAll(fd.get(), &record, sizeof(record)) || record.magic != kIndexMagic) {
+        return ZX_ERR_NOT_FOUND;
+    }
+
+    int64_t mtime_sec, mtime_nsec;
+    GetModificationTime(st, &mtime_sec, &mtime_nsec);
+    size_t path_length = strlen(real_path);
+    char recorded_path[PATH_MAX];
+    if (record.size != static_cast<uint64_t>(st.st_size) ||
+        record.ino != static_cast<uint64_t>(st.st_ino) ||
+        record.mtime_sec != mtime_sec || record.mtime_nsec != mtime_nsec ||
+        record.path_length != path_length ||
+        !ReadAll(fd.get(), recorded_path, path_length) ||
+        memcmp(recorded_path, real_path, path_length) != 0) {
+        return ZX_ERR_NOT_FOUND;
+    }
+
+    zx_status_t status;
+    if ((status = LookupContent(Digest(record.digest), out)) != ZX_OK) {
+        return status;
+    }
+    return out->length == record.size ? ZX_OK : ZX_ERR_NOT_FOUND;
+}
+
+zx_status_t MerkleCache::LookupContent(const Digest& digest, MerkleCacheEntry* out) const {
+    fbl::unique_fd fd(open(ObjectPath(digest).c_str(), O_RDONLY));
+    ObjectHeader header;
+    if (!fd || !ReadObjectHeader(fd.get(), digest, &header)) {
+        return ZX_ERR_NOT_FOUND;
+    }
+
+    if (!ReadArray(fd.get(), header.tree_length, &out->tree) ||
+        !ReadArray(fd.get(), header.payload_length, &out->payload)) {
+        return ZX_ERR_NOT_FOUND;
+    }
+    out->digest = header.digest;
+    out->length = header.length;
+    out->has_payload = (header.flags & kObjectFlagPayload) != 0;
+    return ZX_OK;
+}
+
+zx_status_t MerkleCache::Store(const char* path, const struct stat& st,
+                               const MerkleCacheEntry& entry) const {
+    ObjectHeader header = {};
+    header.magic = kObjectMagic;
+    header.length = entry.length;
+    header.tree_length = entry.tree.size();
+    header.payload_length = entry.payload.size();
+    header.flags = entry.has_payload ? kObjectFlagPayload : 0;
+    zx_status_t status;
+    if ((status = entry.digest.CopyTo(header.digest, sizeof(header.digest))) != ZX_OK) {
+        return status;
+    }
+
+    // Keep an existing object unless this entry knows more about the contents.
+    fbl::String object_path = ObjectPath(entry.digest);
+    fbl::unique_fd object_fd(open(object_path.c_str(), O_RDONLY));
+    ObjectHeader existing;
+    if (!object_fd || !ReadObjectHeader(object_fd.get(), entry.digest, &existing) ||
+        (entry.has_payload && !(existing.flags & kObjectFlagPayload))) {
+        const Buffer buffers[] = {
+            {&header, sizeof(header)},
+            {entry.tree.get(), entry.tree.size()},
+            {entry.payload.get(), entry.payload.size()},
+        };
+        if ((status = WriteFileAtomically(object_path, buffers,
+                                          fbl::count_of(buffers))) != ZX_OK) {
+            return status;
+        }
+    }
+
+    char real_path[PATH_MAX];
+    if (realpath(path, real_path) == nullptr) {
+        return ZX_ERR_IO;
+    }
+
+    // A file modified within the current second may be modified again without
+    // its modification time changing, so it is not indexed until later.
+    IndexRecord record = {};
+    GetModificationTime(st, &record.mtime_sec, &record.mtime_nsec);
+    if (record.mtime_sec >= static_cast<int64_t>(time(nullptr))) {
+        return ZX_OK;
+    }
+    record.magic = kIndexMagic;
+    record.size = st.st_size;
+    record.ino = st.st_ino;
+    record.path_length = static_cast<uint32_t>(strlen(real_path));
+    entry.digest.CopyTo(record.digest, sizeof(record.digest));
+
+    const Buffer buffers[] = {
+        {&record, sizeof(record)},
+        {real_path, record.path_length},
+    };
+    return WriteFileAtomically(IndexPath(real_path), buffers, fbl::count_of(buffers));
+}
+
+fbl::String MerkleCache::ObjectPath(const Digest& digest) const {
+    char hex[Digest::kLength * 2 + 1];
+    digest.ToString(hex, sizeof(hex));
+    return fbl::StringPrintf("%s/objects/%s", path_.c_str(), hex);
+}
+
+fbl::String MerkleCache::IndexPath(const char* path) const {
+    Digest path_digest;
+    path_digest.Hash(path, strlen(path));
+    char hex[Digest::kLength * 2 + 1];
+    path_digest.ToString(hex, sizeof(hex));
+    return fbl::StringPrintf("%s/index/%s", path_.c_str(), hex);
+}
+
+} // namespace digest
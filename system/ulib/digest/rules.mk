@@ -33,6 +33,7 @@ MODULE_COMPILEFLAGS := \
 
 MODULE_SRCS += \
     $(LOCAL_DIR)/digest.cpp \
+    $(LOCAL_DIR)/merkle-cache.cpp \
     $(LOCAL_DIR)/merkle-tree.cpp
 
 MODULE_HOST_LIBS := \
@@ -59,4 +59,16 @@ zx_status_t fdio_get_vmo_clone(int fd, zx_handle_t* out_vmo);
 // or clone data into a new VMO).
 zx_status_t fdio_get_vmo_exact(int fd, zx_handle_t* out_vmo);
 
+// Reads entries of the directory |fd| together with their attributes, as
+// vdirent_plus_t records (see <lib/fdio/vfs.h>), into the 8-byte aligned
+// |buf|. Each call continues from where the last left off, and returns no
+// entries once all have been read. Returns ZX_ERR_BUFFER_TOO_SMALL, and reads
+// nothing, if |len| may be too small for the next entry; a few kilobytes are
+// always enough.
+//
+// When the filesystem can't return the attributes of an entry along with
+// its name, they are read by opening the entry. If that fails, the entry's
+// |attr.mode| is left zero.
+zx_status_t fdio_readdir_plus(int fd, void* buf, size_t len, size_t* out_actual);
+
 __END_CDECLS
@@ -8,6 +8,7 @@
 #include <zircon/listnode.h>
 #include <zircon/compiler.h>
 
+#include <stddef.h>
 #include <stdio.h>
 #include <unistd.h>  // ssize_t
 
@@ -79,4 +80,19 @@ typedef struct vdirent {
     char name[0];
 } __PACKED vdirent_t;
 
+// A dirent together with the attributes of the node it names, as returned
+// by ReadDirentsPlus. Entries whose attributes could not be read (such as
+// mount points) have an |attr.mode| of zero.
+typedef struct vdirent_plus {
+    vnattr_t attr;
+    uint8_t size;
+    uint8_t type;
+    char name[0];
+} vdirent_plus_t;
+
+// The length of a vdirent_plus_t with a |namelen|-byte name, including the
+// padding which aligns the entry following it.
+#define VDIRENT_PLUS_LEN(namelen) \
+    ((offsetof(vdirent_plus_t, name) + (namelen) + 7) & ~(size_t)7)
+
 __END_CDECLS
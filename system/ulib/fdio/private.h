@@ -78,6 +78,8 @@ typedef struct fdio_ops {
 #define IOFLAG_SOCKET_CONNECTED     (1 << 5)
 #define IOFLAG_NONBLOCK             (1 << 6)
 #define IOFLAG_SOCKET_DID_LISTEN    (1 << 7)
+#define IOFLAG_DIRENTS_PLUS_PROBED  (1 << 8)
+#define IOFLAG_DIRENTS_PLUS         (1 << 9)
 
 // The subset of fdio_t per-fd flags queryable via fcntl.
 // Static assertions in unistd.c ensure we aren't colliding.
@@ -130,6 +132,11 @@ zx_status_t fdio_wait(fdio_t* io, uint32_t events, zx_time_t deadline,
 // Takes ownership of |control|.
 fdio_t* fdio_dir_create(zx_handle_t control);
 
+// Creates an |fdio_t| from a remote file connection.
+//
+// Takes ownership of |control| and |event|.
+fdio_t* fdio_file_create(zx_handle_t control, zx_handle_t event);
+
 // Creates a pipe backed by a socket.
 //
 // Takes ownership of |socket|.
@@ -964,8 +964,61 @@ int fdio_status_to_errno(zx_status_t status) {
 // The functions from here on provide implementations of fd and path
 // centric posix-y io operations.
 
+// Vectors of several buffers which total at most this many bytes are
+// transferred with a single read or write of a buffer gathering them, rather
+// than one per buffer, so that many small buffers don't each cost a round
+// trip to the server.
+#define FDIO_IOV_GATHER_MAX (64 * 1024)
+
+// Returns a buffer big enough for all of |iov|, and its size in
+// |out_total|, or NULL if the vector should be handled a buffer at a time.
+static void* iov_gather_alloc(const struct iovec* iov, int num, size_t* out_total) {
+    if (num < 2) {
+        return NULL;
+    }
+    size_t total = 0;
+    for (int i = 0; i < num; i++) {
+        if (iov[i].iov_len > FDIO_IOV_GATHER_MAX - total) {
+            return NULL;
+        }
+        total += iov[i].iov_len;
+    }
+    if (total == 0) {
+        return NULL;
+    }
+    *out_total = total;
+    return malloc(total);
+}
+
+static void iov_gather(const struct iovec* iov, int num, uint8_t* buffer) {
+    for (int i = 0; i < num; i++) {
+        memcpy(buffer, iov[i].iov_base, iov[i].iov_len);
+        buffer += iov[i].iov_len;
+    }
+}
+
+static void iov_scatter(const struct iovec* iov, int num, const uint8_t* buffer, size_t len) {
+    for (int i = 0; i < num && len > 0; i++) {
+        size_t n = (iov[i].iov_len < len) ? iov[i].iov_len : len;
+        memcpy(iov[i].iov_base, buffer, n);
+        buffer += n;
+        len -= n;
+    }
+}
+
 __EXPORT
 ssize_t readv(int fd, const struct iovec* iov, int num) {
+    size_t total;
+    uint8_t* buffer = iov_gather_alloc(iov, num, &total);
+    if (buffer != NULL) {
+        ssize_t r = read(fd, buffer, total);
+        if (r > 0) {
+            iov_scatter(iov, num, buffer, r);
+        }
+        free(buffer);
+        return r;
+    }
+
     ssize_t count = 0;
     ssize_t r;
     while (num > 0) {
@@ -987,6 +1040,15 @@ ssize_t readv(int fd, const struct iovec* iov, int num) {
 
 __EXPORT
 ssize_t writev(int fd, const struct iovec* iov, int num) {
+    size_t total;
+    uint8_t* buffer = iov_gather_alloc(iov, num, &total);
+    if (buffer != NULL) {
+        iov_gather(iov, num, buffer);
+        ssize_t r = write(fd, buffer, total);
+        free(buffer);
+        return r;
+    }
+
     ssize_t count = 0;
     ssize_t r;
     while (num > 0) {
@@ -1098,6 +1160,17 @@ ssize_t write(int fd, const void* buf, size_t count) {
 
 __EXPORT
 ssize_t preadv(int fd, const struct iovec* iov, int count, off_t ofs) {
+    size_t total;
+    uint8_t* buffer = iov_gather_alloc(iov, count, &total);
+    if (buffer != NULL) {
+        ssize_t r = pread(fd, buffer, total, ofs);
+        if (r > 0) {
+            iov_scatter(iov, count, buffer, r);
+        }
+        free(buffer);
+        return r;
+    }
+
     ssize_t iov_count = 0;
     ssize_t r;
     while (count > 0) {
@@ -1144,6 +1217,15 @@ ssize_t pread(int fd, void* buf, size_t size, off_t ofs) {
 
 __EXPORT
 ssize_t pwritev(int fd, const struct iovec* iov, int count, off_t ofs) {
+    size_t total;
+    uint8_t* buffer = iov_gather_alloc(iov, count, &total);
+    if (buffer != NULL) {
+        iov_gather(iov, count, buffer);
+        ssize_t r = pwrite(fd, buffer, total, ofs);
+        free(buffer);
+        return r;
+    }
+
     ssize_t iov_count = 0;
     ssize_t r;
     while (count > 0) {
@@ -1411,6 +1493,151 @@ done:
     return status == ZX_OK ? (int) actual : ERROR(status);
 }
 
+// A vdirent_plus_t is at most this many times the size of the vdirent_t with
+// the same name.
+#define READDIR_PLUS_EXPANSION 8
+
+// Whether the server of the directory |handle| handles ReadDirentsPlus. One
+// which doesn't know the method closes the connection rather than replying,
+// so it is tried on a clone.
+static bool readdir_plus_probe(zx_handle_t handle) {
+    zx_handle_t h0, h1;
+    if (zx_channel_create(0, &h0, &h1) != ZX_OK) {
+        return false;
+    }
+    if (fuchsia_io_NodeClone(handle, 0, h1) != ZX_OK) {
+        zx_handle_close(h0);
+        return false;
+    }
+    char buf[VDIRENT_PLUS_LEN(NAME_MAX)];
+    size_t actual = 0;
+    zx_status_t io_status, status;
+    io_status = fuchsia_io_DirectoryReadDirentsPlus(h0, sizeof(buf), &status, buf, sizeof(buf),
+                                                    &actual);
+    zx_handle_close(h0);
+    return io_status == ZX_OK && status != ZX_ERR_NOT_SUPPORTED;
+}
+
+// Reads entries with ReadDirentsPlus, when |io| is a remote directory whose
+// server handles it.
+static zx_status_t readdir_plus_remote(fdio_t* io, void* buf, size_t len, size_t* out_actual) {
+    zx_handle_t handle = fdio_unsafe_borrow_channel(io);
+    if (handle == ZX_HANDLE_INVALID) {
+        return ZX_ERR_NOT_SUPPORTED;
+    }
+    if (!(io->ioflag & IOFLAG_DIRENTS_PLUS_PROBED)) {
+        if (readdir_plus_probe(handle)) {
+            io->ioflag |= IOFLAG_DIRENTS_PLUS;
+        }
+        io->ioflag |= IOFLAG_DIRENTS_PLUS_PROBED;
+    }
+    if (!(io->ioflag & IOFLAG_DIRENTS_PLUS)) {
+        return ZX_ERR_NOT_SUPPORTED;
+    }
+    if (len > fuchsia_io_MAX_BUF) {
+        len = fuchsia_io_MAX_BUF;
+    }
+    size_t actual = 0;
+    zx_status_t io_status, status;
+    io_status = fuchsia_io_DirectoryReadDirentsPlus(handle, len, &status, buf, len, &actual);
+    if (io_status != ZX_OK) {
+        return io_status;
+    }
+    if (status != ZX_OK) {
+        return status;
+    }
+    if (actual > len) {
+        return ZX_ERR_IO;
+    }
+    *out_actual = actual;
+    return ZX_OK;
+}
+
+// Reads entries with readdir, leaving their attributes for
+// readdir_plus_fill_attributes to read.
+static zx_status_t readdir_plus_local(fdio_t* io, void* buf, size_t len, size_t* out_actual) {
+    char dirents[FDIO_CHUNK_SIZE / READDIR_PLUS_EXPANSION];
+    size_t max = len / READDIR_PLUS_EXPANSION;
+    if (max > sizeof(dirents)) {
+        max = sizeof(dirents);
+    }
+    size_t actual;
+    zx_status_t status = io->ops->readdir(io, dirents, max, &actual);
+    if (status != ZX_OK) {
+        return status;
+    }
+    if (actual == 0 && max < sizeof(vdirent_t) + NAME_MAX) {
+        // The next entry may not have fit, so this needn't be the end.
+        return ZX_ERR_BUFFER_TOO_SMALL;
+    }
+    size_t pos = 0;
+    for (size_t off = 0; off < actual;) {
+        const vdirent_t* de = (const vdirent_t*)(dirents + off);
+        vdirent_plus_t* dp = (vdirent_plus_t*)((char*)buf + pos);
+        size_t sz = VDIRENT_PLUS_LEN(de->size);
+        memset(dp, 0, sz);
+        dp->size = de->size;
+        dp->type = de->type;
+        memcpy(dp->name, de->name, de->size);
+        pos += sz;
+        off += sizeof(vdirent_t) + de->size;
+    }
+    *out_actual = pos;
+    return ZX_OK;
+}
+
+// Reads the attributes of each entry which the filesystem did not return
+// them for, by opening it.
+static void readdir_plus_fill_attributes(int fd, void* buf, size_t len) {
+    for (size_t off = 0; off < len;) {
+        vdirent_plus_t* de = (vdirent_plus_t*)((char*)buf + off);
+        off += VDIRENT_PLUS_LEN(de->size);
+        if (de->attr.mode != 0) {
+            continue;
+        }
+        char name[NAME_MAX + 1];
+        memcpy(name, de->name, de->size);
+        name[de->size] = '\0';
+        fdio_t* io;
+        if (__fdio_open_at(&io, fd, name, O_PATH, 0) != ZX_OK) {
+            continue;
+        }
+        fuchsia_io_NodeAttributes attr;
+        if (io->ops->get_attr(io, &attr) == ZX_OK) {
+            de->attr.mode = attr.mode;
+            de->attr.inode = attr.id;
+            de->attr.size = attr.content_size;
+            de->attr.blksize = VNATTR_BLKSIZE;
+            de->attr.blkcount = attr.storage_size / VNATTR_BLKSIZE;
+            de->attr.nlink = attr.link_count;
+            de->attr.create_time = attr.creation_time;
+            de->attr.modify_time = attr.modification_time;
+        }
+        fdio_close(io);
+        fdio_release(io);
+    }
+}
+
+__EXPORT
+zx_status_t fdio_readdir_plus(int fd, void* buf, size_t len, size_t* out_actual) {
+    fdio_t* io = fd_to_io(fd);
+    if (io == NULL) {
+        return ZX_ERR_BAD_HANDLE;
+    }
+    size_t actual = 0;
+    zx_status_t status = readdir_plus_remote(io, buf, len, &actual);
+    if (status == ZX_ERR_NOT_SUPPORTED) {
+        status = readdir_plus_local(io, buf, len, &actual);
+    }
+    fdio_release(io);
+    if (status != ZX_OK) {
+        return status;
+    }
+    readdir_plus_fill_attributes(fd, buf, actual);
+    *out_actual = actual;
+    return ZX_OK;
+}
+
 static int truncateat(int dirfd, const char* path, off_t len) {
     fdio_t* io;
     zx_status_t r;
@@ -0,0 +1,87 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <lib/fidl/llcpp/buffer_pool.h>
+#include <zircon/assert.h>
+#include <zircon/fidl.h>
+
+#include <stdlib.h>
+
+namespace fidl {
+namespace {
+
+// The slab header, and each buffer, start on a FIDL_ALIGNMENT boundary.
+constexpr size_t kSlabHeaderSize = FIDL_ALIGN(sizeof(void*));
+
+size_t GetBufferStride(uint32_t buffer_capacity) {
+    // Unused buffers hold a link, so they are never smaller than one.
+    size_t size = buffer_capacity < sizeof(void*) ? sizeof(void*) : buffer_capacity;
+    return FIDL_ALIGN(size);
+}
+
+} // namespace
+
+void BufferPool::Buffer::reset() {
+    if (data_ != nullptr) {
+        pool_->Release(data_);
+        pool_ = nullptr;
+        data_ = nullptr;
+        capacity_ = 0u;
+    }
+}
+
+BufferPool::BufferPool(uint32_t buffer_capacity, uint32_t buffers_per_slab)
+    : buffer_capacity_(buffer_capacity),
+      buffers_per_slab_(buffers_per_slab > 0u ? buffers_per_slab : 1u) {
+    AddSlab();
+}
+
+BufferPool::~BufferPool() {
+    ZX_ASSERT_MSG(outstanding_ == 0u, "BufferPool destroyed with buffers in use");
+    while (slabs_ != nullptr) {
+        Link* next = slabs_->next;
+        free(slabs_);
+        slabs_ = next;
+    }
+}
+
+BufferPool::Buffer BufferPool::Acquire() {
+    if (free_buffers_ == nullptr)
+        AddSlab();
+    Link* buffer = free_buffers_;
+    free_buffers_ = buffer->next;
+    ++outstanding_;
+    return Buffer(this, reinterpret_cast<uint8_t*>(buffer));
+}
+
+void BufferPool::AddSlab() {
+    const size_t stride = GetBufferStride(buffer_capacity_);
+    uint8_t* slab = static_cast<uint8_t*>(
+        malloc(kSlabHeaderSize + stride * buffers_per_slab_));
+    ZX_ASSERT_MSG(slab, "malloc returned NULL in BufferPool::AddSlab()");
+
+    Link* header = reinterpret_cast<Link*>(slab);
+    header->next = slabs_;
+    slabs_ = header;
+    ++slab_count_;
+
+    // Push the buffers in reverse, so they are handed out in address order.
+    for (size_t i = buffers_per_slab_; i > 0u; --i) {
+        Link* buffer = reinterpret_cast<Link*>(slab + kSlabHeaderSize + stride * (i - 1u));
+        buffer->next = free_buffers_;
+        free_buffers_ = buffer;
+    }
+}
+
+void BufferPool::Release(uint8_t* data) {
+    ZX_DEBUG_ASSERT(outstanding_ > 0u);
+    // The most recently released buffer is the next one handed out, while
+    // it is still warm in the cache.
+    Link* buffer = reinterpret_cast<Link*>(data);
+    buffer->next = free_buffers_;
+    free_buffers_ = buffer;
+    --outstanding_;
+}
+
+} // namespace fidl
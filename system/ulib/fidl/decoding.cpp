@@ -149,7 +149,7 @@ public:
 #ifdef __Fuchsia__
             zx_handle_close_many(&handles_[handle_idx_], envelope->num_handles);
 #endif
-            handle_idx_ += num_handles_;
+            handle_idx_ += envelope->num_handles;
         }
         return Status::kSuccess;
     }
@@ -232,6 +232,19 @@ zx_status_t fidl_decode(const fidl_type_t* type, void* bytes, uint32_t num_bytes
         return status;
     }
 
+    // A flat message has nothing to decode beyond its primary object.
+    if (fidl::IsFlat(type)) {
+        if (next_out_of_line != num_bytes) {
+            set_error("message did not decode all provided bytes");
+            return ZX_ERR_INVALID_ARGS;
+        }
+        if (num_handles != 0) {
+            set_error("message did not decode all provided handles");
+            return ZX_ERR_INVALID_ARGS;
+        }
+        return ZX_OK;
+    }
+
     FidlDecoder decoder(bytes, num_bytes, handles, num_handles, next_out_of_line, out_error_msg);
     fidl::Walk(decoder,
                type,
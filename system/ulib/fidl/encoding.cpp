@@ -234,6 +234,16 @@ zx_status_t fidl_encode(const fidl_type_t* type, void* bytes, uint32_t num_bytes
         return status;
     }
 
+    // A flat message has nothing to encode beyond its primary object.
+    if (fidl::IsFlat(type)) {
+        if (next_out_of_line != num_bytes) {
+            set_error("message did not encode all provided bytes");
+            return ZX_ERR_INVALID_ARGS;
+        }
+        *out_actual_handles = 0;
+        return ZX_OK;
+    }
+
     FidlEncoder encoder(bytes, num_bytes, handles, max_handles, next_out_of_line, out_error_msg);
     fidl::Walk(encoder,
                type,
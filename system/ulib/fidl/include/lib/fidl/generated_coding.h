@@ -0,0 +1,703 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LIB_FIDL_GENERATED_CODING_H_
+#define LIB_FIDL_GENERATED_CODING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <lib/fidl/coding.h>
+#include <lib/fidl/internal.h>
+#include <zircon/compiler.h>
+#include <zircon/fidl.h>
+#include <zircon/types.h>
+
+#ifdef __Fuchsia__
+#include <zircon/syscalls.h>
+#endif
+
+// Support for the encoders, decoders and validators generated by `fidlc --coders`.
+//
+// For each type which needs coding, fidlc generates a function template
+//
+//     template <typename Coder>
+//     bool <coded name>Coder(Coder* coder, uint32_t offset);
+//
+// which codes the object at |offset| in the message by calling the helpers
+// below for each of its fields, in the order the walker visits them when
+// given the coding table of the type. |Coder| is one of GeneratedEncoder,
+// GeneratedDecoder or GeneratedValidator, which check and rewrite pointers,
+// handles and envelopes exactly like the visitors used by fidl_encode(),
+// fidl_decode() and fidl_validate() do.
+//
+// Coding functions return false if coding must stop, which is the case after
+// a memory error. A constraint violation is recorded, after which the rest of
+// the object being coded is skipped and coding continues, as in the walker.
+
+namespace fidl {
+namespace internal {
+
+enum class CodingStatus {
+    kSuccess,
+    kConstraintViolationError,
+    kMemoryError,
+};
+
+// The state shared by the encoder, decoder and validator.
+class GeneratedCoder {
+public:
+    GeneratedCoder(uint8_t* bytes, uint32_t num_bytes, uint32_t next_out_of_line,
+                   const char** out_error_msg)
+        : bytes_(bytes), num_bytes_(num_bytes), next_out_of_line_(next_out_of_line),
+          out_error_msg_(out_error_msg) {}
+
+    template <typename T>
+    T* At(uint32_t offset) const {
+        return reinterpret_cast<T*>(bytes_ + offset);
+    }
+
+    // Records a constraint violation. Returns true, as coding continues.
+    bool ConstraintViolation(const char* error) {
+        SetError(error);
+        return true;
+    }
+
+    // Records an error after which coding stops. Returns false.
+    bool MemoryError(const char* error) {
+        SetError(error);
+        return false;
+    }
+
+    // Out-of-line objects may only nest FIDL_RECURSION_DEPTH deep. Returns
+    // false if another level would exceed that.
+    bool EnterOutOfLine() {
+        if (depth_ == FIDL_RECURSION_DEPTH) {
+            return false;
+        }
+        ++depth_;
+        return true;
+    }
+
+    void LeaveOutOfLine() { --depth_; }
+
+    // Checks the sizes recorded in |envelope| against the bytes and handles
+    // its payload was found to have.
+    CodingStatus LeaveEnvelope(const fidl_envelope_t* envelope, uint32_t bytes_before,
+                               uint32_t handles_before) {
+        if (envelope->num_bytes != next_out_of_line_ - bytes_before) {
+            SetError("Envelope num_bytes was mis-sized");
+            return CodingStatus::kConstraintViolationError;
+        }
+        if (envelope->num_handles != handle_idx_ - handles_before) {
+            SetError("Envelope num_handles was mis-sized");
+            return CodingStatus::kConstraintViolationError;
+        }
+        return CodingStatus::kSuccess;
+    }
+
+    zx_status_t status() const { return status_; }
+
+    uint32_t next_out_of_line() const { return next_out_of_line_; }
+
+    uint32_t handle_idx() const { return handle_idx_; }
+
+    bool DidConsumeAllBytes() const { return next_out_of_line_ == num_bytes_; }
+
+protected:
+    void SetError(const char* error) {
+        if (status_ != ZX_OK) {
+            return;
+        }
+        status_ = ZX_ERR_INVALID_ARGS;
+        if (out_error_msg_ != nullptr) {
+            *out_error_msg_ = error;
+        }
+    }
+
+    // Claims the next |size| bytes of out-of-line storage, setting
+    // |out_offset| to their offset.
+    CodingStatus ClaimOutOfLine(uint32_t size, const char* too_large_error,
+                                uint32_t* out_offset) {
+        uint32_t new_offset;
+        if (!AddOutOfLine(next_out_of_line_, size, &new_offset)) {
+            SetError("overflow updating out-of-line offset");
+            return CodingStatus::kMemoryError;
+        }
+        if (new_offset > num_bytes_) {
+            SetError(too_large_error);
+            return CodingStatus::kMemoryError;
+        }
+        *out_offset = next_out_of_line_;
+        next_out_of_line_ = new_offset;
+        return CodingStatus::kSuccess;
+    }
+
+    // Checks the header of an envelope received in a message.
+    CodingStatus CheckReceivedEnvelope(const fidl_envelope_t* envelope, uint32_t num_handles) {
+        if (envelope->presence == FIDL_ALLOC_ABSENT &&
+            (envelope->num_bytes != 0 || envelope->num_handles != 0)) {
+            SetError("Envelope has absent data pointer, yet has data and/or handles");
+            return CodingStatus::kConstraintViolationError;
+        }
+        if (envelope->presence != FIDL_ALLOC_ABSENT && envelope->num_bytes == 0) {
+            SetError("Envelope has present data pointer, but zero byte count");
+            return CodingStatus::kConstraintViolationError;
+        }
+        uint32_t expected_handle_count;
+        if (add_overflow(handle_idx_, envelope->num_handles, &expected_handle_count) ||
+            expected_handle_count > num_handles) {
+            SetError("Envelope has more handles than expected");
+            return CodingStatus::kConstraintViolationError;
+        }
+        return CodingStatus::kSuccess;
+    }
+
+    uint8_t* const bytes_;
+    const uint32_t num_bytes_;
+    uint32_t next_out_of_line_;
+    const char** const out_error_msg_;
+
+    zx_status_t status_ = ZX_OK;
+    uint32_t handle_idx_ = 0;
+    uint32_t depth_ = 0;
+};
+
+class GeneratedEncoder final : public GeneratedCoder {
+public:
+    GeneratedEncoder(void* bytes, uint32_t num_bytes, zx_handle_t* handles, uint32_t max_handles,
+                     uint32_t next_out_of_line, const char** out_error_msg)
+        : GeneratedCoder(static_cast<uint8_t*>(bytes), num_bytes, next_out_of_line,
+                         out_error_msg),
+          handles_(handles), max_handles_(max_handles) {}
+
+    CodingStatus VisitPointer(void** object_ptr_ptr, uint32_t inline_size, uint32_t* out_offset) {
+        // Make sure objects in secondary storage are contiguous.
+        if (*object_ptr_ptr != &bytes_[next_out_of_line_]) {
+            SetError("noncontiguous out of line storage during encode");
+            return CodingStatus::kMemoryError;
+        }
+        CodingStatus status = ClaimOutOfLine(
+            inline_size, "message tried to encode more than provided number of bytes", out_offset);
+        if (status != CodingStatus::kSuccess) {
+            return status;
+        }
+        *object_ptr_ptr = reinterpret_cast<void*>(FIDL_ALLOC_PRESENT);
+        return CodingStatus::kSuccess;
+    }
+
+    void VisitHandle(zx_handle_t* handle) {
+        if (handle_idx_ == max_handles_) {
+            SetError("message tried to encode too many handles");
+            ThrowAwayHandle(handle);
+            return;
+        }
+        if (handles_ == nullptr) {
+            SetError("did not provide place to store handles");
+            ThrowAwayHandle(handle);
+            return;
+        }
+        handles_[handle_idx_] = *handle;
+        *handle = FIDL_HANDLE_PRESENT;
+        handle_idx_++;
+    }
+
+    CodingStatus EnterEnvelope(const fidl_envelope_t* envelope, bool known_payload) {
+        if (envelope->data == nullptr &&
+            (envelope->num_bytes != 0 || envelope->num_handles != 0)) {
+            SetError("Envelope has absent data pointer, yet has data and/or handles");
+            return CodingStatus::kConstraintViolationError;
+        }
+        if (envelope->data != nullptr && envelope->num_bytes == 0) {
+            SetError("Envelope has present data pointer, but zero byte count");
+            return CodingStatus::kConstraintViolationError;
+        }
+        if (envelope->data != nullptr && envelope->num_handles > 0 && !known_payload) {
+            // Since we do not know the shape of the objects in this envelope,
+            // we cannot move the handles scattered in the message.
+            SetError("Does not know how to encode for this ordinal");
+            return CodingStatus::kConstraintViolationError;
+        }
+        return CodingStatus::kSuccess;
+    }
+
+private:
+    void ThrowAwayHandle(zx_handle_t* handle) {
+#ifdef __Fuchsia__
+        zx_handle_close(*handle);
+#endif
+        *handle = ZX_HANDLE_INVALID;
+    }
+
+    zx_handle_t* const handles_;
+    const uint32_t max_handles_;
+};
+
+class GeneratedDecoder final : public GeneratedCoder {
+public:
+    GeneratedDecoder(void* bytes, uint32_t num_bytes, const zx_handle_t* handles,
+                     uint32_t num_handles, uint32_t next_out_of_line, const char** out_error_msg)
+        : GeneratedCoder(static_cast<uint8_t*>(bytes), num_bytes, next_out_of_line,
+                         out_error_msg),
+          handles_(handles), num_handles_(num_handles) {}
+
+    CodingStatus VisitPointer(void** object_ptr_ptr, uint32_t inline_size, uint32_t* out_offset) {
+        if (reinterpret_cast<uintptr_t>(*object_ptr_ptr) != FIDL_ALLOC_PRESENT) {
+            SetError("decoder encountered invalid pointer");
+            return CodingStatus::kConstraintViolationError;
+        }
+        CodingStatus status = ClaimOutOfLine(
+            inline_size, "message tried to decode more than provided number of bytes", out_offset);
+        if (status != CodingStatus::kSuccess) {
+            return status;
+        }
+        *object_ptr_ptr = &bytes_[*out_offset];
+        return CodingStatus::kSuccess;
+    }
+
+    void VisitHandle(zx_handle_t* handle) {
+        if (*handle != FIDL_HANDLE_PRESENT) {
+            SetError("message tried to decode a garbage handle");
+            return;
+        }
+        if (handle_idx_ == num_handles_) {
+            SetError("message decoded too many handles");
+            return;
+        }
+        if (handles_ == nullptr) {
+            SetError("decoder noticed a handle is present but the handle table is empty");
+            *handle = ZX_HANDLE_INVALID;
+            return;
+        }
+        if (handles_[handle_idx_] == ZX_HANDLE_INVALID) {
+            SetError("invalid handle detected in handle table");
+            return;
+        }
+        *handle = handles_[handle_idx_];
+        handle_idx_++;
+    }
+
+    CodingStatus EnterEnvelope(const fidl_envelope_t* envelope, bool known_payload) {
+        CodingStatus status = CheckReceivedEnvelope(envelope, num_handles_);
+        if (status != CodingStatus::kSuccess) {
+            return status;
+        }
+        // The handles of a payload we cannot decode are closed, as nobody
+        // else knows where they are.
+        if (envelope->presence != FIDL_ALLOC_ABSENT && !known_payload &&
+            envelope->num_handles > 0) {
+#ifdef __Fuchsia__
+            zx_handle_close_many(&handles_[handle_idx_], envelope->num_handles);
+#endif
+            handle_idx_ += envelope->num_handles;
+        }
+        return CodingStatus::kSuccess;
+    }
+
+    bool DidConsumeAllHandles() const { return handle_idx_ == num_handles_; }
+
+private:
+    const zx_handle_t* const handles_;
+    const uint32_t num_handles_;
+};
+
+class GeneratedValidator final : public GeneratedCoder {
+public:
+    GeneratedValidator(const void* bytes, uint32_t num_bytes, uint32_t num_handles,
+                       uint32_t next_out_of_line, const char** out_error_msg)
+        // The validator never writes to the message.
+        : GeneratedCoder(static_cast<uint8_t*>(const_cast<void*>(bytes)), num_bytes,
+                         next_out_of_line, out_error_msg),
+          num_handles_(num_handles) {}
+
+    CodingStatus VisitPointer(void** object_ptr_ptr, uint32_t inline_size, uint32_t* out_offset) {
+        if (reinterpret_cast<uintptr_t>(*object_ptr_ptr) != FIDL_ALLOC_PRESENT) {
+            SetError("validator encountered invalid pointer");
+            return CodingStatus::kConstraintViolationError;
+        }
+        return ClaimOutOfLine(
+            inline_size, "message tried to access more than provided number of bytes", out_offset);
+    }
+
+    void VisitHandle(zx_handle_t* handle) {
+        if (*handle != FIDL_HANDLE_PRESENT) {
+            SetError("message contains a garbage handle");
+            return;
+        }
+        if (handle_idx_ == num_handles_) {
+            SetError("message has too many handles");
+            return;
+        }
+        handle_idx_++;
+    }
+
+    CodingStatus EnterEnvelope(const fidl_envelope_t* envelope, bool known_payload) {
+        CodingStatus status = CheckReceivedEnvelope(envelope, num_handles_);
+        if (status != CodingStatus::kSuccess) {
+            return status;
+        }
+        if (envelope->presence != FIDL_ALLOC_ABSENT && !known_payload) {
+            handle_idx_ += envelope->num_handles;
+        }
+        return CodingStatus::kSuccess;
+    }
+
+    bool DidConsumeAllHandles() const { return handle_idx_ == num_handles_; }
+
+private:
+    const uint32_t num_handles_;
+};
+
+// Codes nothing, for out-of-line objects without pointers or handles.
+struct NothingToCode {
+    template <typename Coder>
+    bool operator()(Coder* coder, uint32_t offset) const { return true; }
+};
+
+// Claims the out-of-line object of |inline_size| bytes |object_ptr_ptr|
+// points to, then codes it with |code_object|.
+template <typename Coder, typename CodeFn>
+bool CodeOutOfLine(Coder* coder, void** object_ptr_ptr, uint32_t inline_size,
+                   CodeFn code_object) {
+    uint32_t offset;
+    switch (coder->VisitPointer(object_ptr_ptr, inline_size, &offset)) {
+    case CodingStatus::kSuccess:
+        break;
+    case CodingStatus::kConstraintViolationError:
+        return true;
+    case CodingStatus::kMemoryError:
+        return false;
+    }
+    if (!coder->EnterOutOfLine()) {
+        return coder->ConstraintViolation("recursion depth exceeded");
+    }
+    bool result = code_object(coder, offset);
+    coder->LeaveOutOfLine();
+    return result;
+}
+
+// Codes a nullable pointer to a struct, table, union or xunion.
+template <typename Coder, typename CodeFn>
+bool CodePointer(Coder* coder, uint32_t offset, uint32_t inline_size, CodeFn code_object) {
+    void** object_ptr_ptr = coder->template At<void*>(offset);
+    if (*object_ptr_ptr == nullptr) {
+        return true;
+    }
+    return CodeOutOfLine(coder, object_ptr_ptr, inline_size, code_object);
+}
+
+template <typename Coder>
+bool CodeHandle(Coder* coder, uint32_t offset, bool nullable) {
+    zx_handle_t* handle = coder->template At<zx_handle_t>(offset);
+    if (*handle == ZX_HANDLE_INVALID) {
+        if (!nullable) {
+            return coder->ConstraintViolation("message is missing a non-nullable handle");
+        }
+        return true;
+    }
+    coder->VisitHandle(handle);
+    return true;
+}
+
+template <typename Coder>
+bool CodeString(Coder* coder, uint32_t offset, uint32_t max_size, bool nullable) {
+    fidl_string_t* string = coder->template At<fidl_string_t>(offset);
+    if (string->data == nullptr) {
+        if (!nullable) {
+            return coder->ConstraintViolation("non-nullable string is absent");
+        }
+        if (string->size != 0) {
+            return coder->ConstraintViolation("string is absent but length is not zero");
+        }
+        return true;
+    }
+    if (string->size > UINT32_MAX) {
+        return coder->MemoryError("string size overflows 32 bits");
+    }
+    if (string->size > max_size) {
+        return coder->ConstraintViolation("message tried to access too large of a bounded string");
+    }
+    return CodeOutOfLine(coder, reinterpret_cast<void**>(&string->data),
+                         static_cast<uint32_t>(string->size), NothingToCode());
+}
+
+// Codes a vector whose elements are |element_size| bytes apart, each coded by
+// |code_element|.
+template <typename Coder, typename CodeFn>
+bool CodeVector(Coder* coder, uint32_t offset, uint32_t max_count, uint32_t element_size,
+                bool nullable, CodeFn code_element) {
+    fidl_vector_t* vector = coder->template At<fidl_vector_t>(offset);
+    if (vector->data == nullptr) {
+        if (!nullable) {
+            return coder->ConstraintViolation("non-nullable vector is absent");
+        }
+        if (vector->count != 0) {
+            return coder->ConstraintViolation("absent vector of non-zero elements");
+        }
+        return true;
+    }
+    if (vector->count > max_count) {
+        return coder->ConstraintViolation("message tried to access too large of a bounded vector");
+    }
+    uint32_t size;
+    if (mul_overflow(vector->count, element_size, &size)) {
+        return coder->MemoryError("integer overflow calculating vector size");
+    }
+    return CodeOutOfLine(coder, &vector->data, size, [&](Coder* coder, uint32_t data_offset) {
+        for (uint32_t element_offset = 0; element_offset < size; element_offset += element_size) {
+            if (!code_element(coder, data_offset + element_offset)) {
+                return false;
+            }
+        }
+        return true;
+    });
+}
+
+// Codes the envelope at |envelope_offset|, whose payload is an object of
+// |inline_size| bytes coded by |code_payload|. Any error is returned to the
+// enclosing table or xunion, which stops coding after a constraint violation
+// in the envelope header, as the walker does.
+template <typename Coder, typename CodeFn>
+CodingStatus CodeEnvelope(Coder* coder, uint32_t envelope_offset, uint32_t inline_size,
+                          CodeFn code_payload) {
+    fidl_envelope_t* envelope = coder->template At<fidl_envelope_t>(envelope_offset);
+    uint32_t bytes_before = coder->next_out_of_line();
+    uint32_t handles_before = coder->handle_idx();
+    CodingStatus status = coder->EnterEnvelope(envelope, true);
+    if (status != CodingStatus::kSuccess) {
+        return status;
+    }
+    if (envelope->data != nullptr &&
+        !CodeOutOfLine(coder, &envelope->data, inline_size, code_payload)) {
+        return CodingStatus::kMemoryError;
+    }
+    return coder->LeaveEnvelope(envelope, bytes_before, handles_before);
+}
+
+// Codes an envelope whose ordinal has no payload type which needs coding,
+// either because it is unknown or because it holds plain data.
+template <typename Coder>
+CodingStatus CodeUnknownEnvelope(Coder* coder, uint32_t envelope_offset) {
+    fidl_envelope_t* envelope = coder->template At<fidl_envelope_t>(envelope_offset);
+    uint32_t bytes_before = coder->next_out_of_line();
+    uint32_t handles_before = coder->handle_idx();
+    CodingStatus status = coder->EnterEnvelope(envelope, false);
+    if (status != CodingStatus::kSuccess) {
+        return status;
+    }
+    if (envelope->data != nullptr) {
+        uint32_t offset;
+        if (coder->VisitPointer(&envelope->data, envelope->num_bytes, &offset) ==
+            CodingStatus::kMemoryError) {
+            return CodingStatus::kMemoryError;
+        }
+    }
+    return coder->LeaveEnvelope(envelope, bytes_before, handles_before);
+}
+
+// Codes a table, calling |code_envelope(coder, ordinal, envelope_offset)|
+// for each envelope present.
+template <typename Coder, typename CodeEnvelopeFn>
+bool CodeTable(Coder* coder, uint32_t offset, CodeEnvelopeFn code_envelope) {
+    fidl_vector_t* envelopes = coder->template At<fidl_vector_t>(offset);
+    if (envelopes->data == nullptr) {
+        return coder->ConstraintViolation("Table data cannot be absent");
+    }
+    uint32_t size;
+    if (mul_overflow(envelopes->count, sizeof(fidl_envelope_t), &size)) {
+        return coder->MemoryError("integer overflow calculating table size");
+    }
+    uint32_t envelopes_offset;
+    switch (coder->VisitPointer(&envelopes->data, size, &envelopes_offset)) {
+    case CodingStatus::kSuccess:
+        break;
+    case CodingStatus::kConstraintViolationError:
+        return true;
+    case CodingStatus::kMemoryError:
+        return false;
+    }
+    uint32_t count = static_cast<uint32_t>(envelopes->count);
+    for (uint32_t ordinal = 1; ordinal <= count; ordinal++) {
+        uint32_t envelope_offset =
+            envelopes_offset + (ordinal - 1) * static_cast<uint32_t>(sizeof(fidl_envelope_t));
+        switch (code_envelope(coder, ordinal, envelope_offset)) {
+        case CodingStatus::kSuccess:
+            break;
+        case CodingStatus::kConstraintViolationError:
+            return true;
+        case CodingStatus::kMemoryError:
+            return false;
+        }
+    }
+    return true;
+}
+
+// Codes an xunion, calling |code_envelope(coder, ordinal, envelope_offset)|
+// for its envelope.
+template <typename Coder, typename CodeEnvelopeFn>
+bool CodeXUnion(Coder* coder, uint32_t offset, CodeEnvelopeFn code_envelope) {
+    fidl_xunion_t* xunion = coder->template At<fidl_xunion_t>(offset);
+    if (xunion->padding != 0) {
+        return coder->ConstraintViolation("xunion padding after discriminant are non-zero");
+    }
+    uint32_t envelope_offset = offset + static_cast<uint32_t>(offsetof(fidl_xunion_t, envelope));
+    return code_envelope(coder, xunion->tag, envelope_offset) != CodingStatus::kMemoryError;
+}
+
+// Checks the arguments common to the entry points below, and finds the start
+// of the out-of-line objects of a message whose primary object is
+// |primary_size| bytes.
+inline zx_status_t StartGeneratedCoding(const void* bytes, uint32_t num_bytes,
+                                        uint32_t primary_size, const char* null_bytes_error,
+                                        uint32_t* out_next_out_of_line,
+                                        const char** out_error_msg) {
+    const char* error = nullptr;
+    if (bytes == nullptr) {
+        error = null_bytes_error;
+    } else if (primary_size > num_bytes) {
+        error = "Buffer is too small for first inline object";
+    }
+    if (error != nullptr) {
+        if (out_error_msg != nullptr) {
+            *out_error_msg = error;
+        }
+        return ZX_ERR_INVALID_ARGS;
+    }
+    *out_next_out_of_line = static_cast<uint32_t>(FidlAlign(primary_size));
+    return ZX_OK;
+}
+
+inline zx_status_t FinishGeneratedCoding(zx_status_t status, const char* error,
+                                         const char** out_error_msg) {
+    if (out_error_msg != nullptr) {
+        *out_error_msg = error;
+    }
+    return status;
+}
+
+// The entry points of the generated coders, with the same contract as
+// fidl_encode(), fidl_decode() and fidl_validate() given the coding table of
+// a message whose primary object is |primary_size| bytes, and which
+// |code_message(coder)| codes.
+
+template <typename CodeFn>
+zx_status_t GeneratedEncode(uint32_t primary_size, CodeFn code_message, void* bytes,
+                            uint32_t num_bytes, zx_handle_t* handles, uint32_t max_handles,
+                            uint32_t* out_actual_handles, const char** out_error_msg) {
+    if (handles == nullptr && max_handles != 0) {
+        return FinishGeneratedCoding(
+            ZX_ERR_INVALID_ARGS, "Cannot provide non-zero handle count and null handle pointer",
+            out_error_msg);
+    }
+    if (out_actual_handles == nullptr) {
+        return FinishGeneratedCoding(ZX_ERR_INVALID_ARGS,
+                                     "Cannot encode with null out_actual_handles", out_error_msg);
+    }
+    uint32_t next_out_of_line;
+    zx_status_t status = StartGeneratedCoding(bytes, num_bytes, primary_size,
+                                              "Cannot encode null bytes", &next_out_of_line,
+                                              out_error_msg);
+    if (status != ZX_OK) {
+        return status;
+    }
+
+    GeneratedEncoder encoder(bytes, num_bytes, handles, max_handles, next_out_of_line,
+                             out_error_msg);
+    code_message(&encoder);
+
+    if (encoder.status() == ZX_OK) {
+        if (!encoder.DidConsumeAllBytes()) {
+            return FinishGeneratedCoding(ZX_ERR_INVALID_ARGS,
+                                         "message did not encode all provided bytes",
+                                         out_error_msg);
+        }
+        *out_actual_handles = encoder.handle_idx();
+    } else {
+#ifdef __Fuchsia__
+        if (handles) {
+            // Return value intentionally ignored. This is best-effort cleanup.
+            zx_handle_close_many(handles, max_handles);
+        }
+#endif
+    }
+    return encoder.status();
+}
+
+template <typename CodeFn>
+zx_status_t GeneratedDecode(uint32_t primary_size, CodeFn code_message, void* bytes,
+                            uint32_t num_bytes, const zx_handle_t* handles, uint32_t num_handles,
+                            const char** out_error_msg) {
+    uint32_t next_out_of_line;
+    zx_status_t status = StartGeneratedCoding(bytes, num_bytes, primary_size,
+                                              "Cannot decode null bytes", &next_out_of_line,
+                                              out_error_msg);
+    if (status != ZX_OK) {
+        return status;
+    }
+    if (handles == nullptr && num_handles != 0) {
+        return FinishGeneratedCoding(
+            ZX_ERR_INVALID_ARGS, "Cannot provide non-zero handle count and null handle pointer",
+            out_error_msg);
+    }
+
+    GeneratedDecoder decoder(bytes, num_bytes, handles, num_handles, next_out_of_line,
+                             out_error_msg);
+    code_message(&decoder);
+
+    if (decoder.status() == ZX_OK) {
+        if (!decoder.DidConsumeAllBytes()) {
+            return FinishGeneratedCoding(ZX_ERR_INVALID_ARGS,
+                                         "message did not decode all provided bytes",
+                                         out_error_msg);
+        }
+        if (!decoder.DidConsumeAllHandles()) {
+            return FinishGeneratedCoding(ZX_ERR_INVALID_ARGS,
+                                         "message did not decode all provided handles",
+                                         out_error_msg);
+        }
+    } else {
+#ifdef __Fuchsia__
+        if (handles) {
+            // Return value intentionally ignored. This is best-effort cleanup.
+            (void)zx_handle_close_many(handles, num_handles);
+        }
+#endif
+    }
+    return decoder.status();
+}
+
+template <typename CodeFn>
+zx_status_t GeneratedValidate(uint32_t primary_size, CodeFn code_message, const void* bytes,
+                              uint32_t num_bytes, uint32_t num_handles,
+                              const char** out_error_msg) {
+    uint32_t next_out_of_line;
+    zx_status_t status = StartGeneratedCoding(bytes, num_bytes, primary_size,
+                                              "Cannot validate null bytes", &next_out_of_line,
+                                              out_error_msg);
+    if (status != ZX_OK) {
+        return status;
+    }
+
+    GeneratedValidator validator(bytes, num_bytes, num_handles, next_out_of_line, out_error_msg);
+    code_message(&validator);
+
+    if (validator.status() == ZX_OK) {
+        if (!validator.DidConsumeAllBytes()) {
+            return FinishGeneratedCoding(ZX_ERR_INVALID_ARGS,
+                                         "message did not consume all provided bytes",
+                                         out_error_msg);
+        }
+        if (!validator.DidConsumeAllHandles()) {
+            return FinishGeneratedCoding(ZX_ERR_INVALID_ARGS,
+                                         "message did not reference all provided handles",
+                                         out_error_msg);
+        }
+    }
+    return validator.status();
+}
+
+} // namespace internal
+} // namespace fidl
+
+#endif // LIB_FIDL_GENERATED_CODING_H_
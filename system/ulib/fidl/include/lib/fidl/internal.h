@@ -96,6 +96,9 @@ enum FidlTypeTag : uint32_t {
 
 // Though the |size| is implied by the fields, computing that information is not the purview of this
 // library. It's easier for the compiler to stash it.
+//
+// Fields without pointers, handles or other constraints to check are elided, so a struct with no
+// fields is "flat": coding it never does more than check the size of the message.
 struct FidlCodedStruct {
     const FidlStructField* const fields;
     const uint32_t field_count;
@@ -0,0 +1,131 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LIB_FIDL_LLCPP_BUFFER_POOL_H_
+#define LIB_FIDL_LLCPP_BUFFER_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <lib/fidl/cpp/message_part.h>
+#include <utility>
+#include <zircon/types.h>
+
+namespace fidl {
+
+// A pool of fixed-size message buffers, meant to be owned by a connection
+// and reused for every message it receives.
+//
+// Buffers are carved out of slabs, each holding several of them. A slab is
+// only allocated when every buffer is in use, so once a connection has
+// received as many concurrent messages as it ever will, acquiring and
+// releasing buffers no longer touches the heap.
+//
+// This class is not thread-safe: buffers must be acquired and released on
+// the thread that owns the pool, and all of them must be released before
+// the pool is destroyed.
+class BufferPool final {
+public:
+    // A buffer borrowed from a |BufferPool|. It is returned to the pool when
+    // destroyed or reset.
+    class Buffer final {
+    public:
+        Buffer() = default;
+
+        Buffer(Buffer&& other) noexcept { MoveImpl(std::move(other)); }
+
+        Buffer& operator=(Buffer&& other) noexcept {
+            if (this != &other) {
+                reset();
+                MoveImpl(std::move(other));
+            }
+            return *this;
+        }
+
+        Buffer(const Buffer& other) = delete;
+
+        Buffer& operator=(const Buffer& other) = delete;
+
+        ~Buffer() { reset(); }
+
+        // The memory of the buffer, aligned to FIDL_ALIGNMENT.
+        // Returns nullptr if the buffer is empty.
+        uint8_t* data() const { return data_; }
+
+        uint32_t capacity() const { return capacity_; }
+
+        bool is_valid() const { return data_ != nullptr; }
+
+        // Returns an empty BytePart covering the whole buffer, e.g. to read a
+        // message into. The buffer must outlive it.
+        BytePart view() const { return BytePart(data_, capacity_); }
+
+        // Returns the buffer to its pool, leaving this object empty.
+        void reset();
+
+    private:
+        friend class BufferPool;
+
+        Buffer(BufferPool* pool, uint8_t* data)
+            : pool_(pool), data_(data), capacity_(pool->buffer_capacity()) {}
+
+        void MoveImpl(Buffer&& other) {
+            pool_ = other.pool_;
+            data_ = other.data_;
+            capacity_ = other.capacity_;
+            other.pool_ = nullptr;
+            other.data_ = nullptr;
+            other.capacity_ = 0u;
+        }
+
+        BufferPool* pool_ = nullptr;
+        uint8_t* data_ = nullptr;
+        uint32_t capacity_ = 0u;
+    };
+
+    // Creates a pool of buffers of |buffer_capacity| bytes, allocated
+    // |buffers_per_slab| at a time. The first slab is allocated here.
+    explicit BufferPool(uint32_t buffer_capacity = ZX_CHANNEL_MAX_MSG_BYTES,
+                        uint32_t buffers_per_slab = 4u);
+
+    BufferPool(const BufferPool& other) = delete;
+
+    BufferPool& operator=(const BufferPool& other) = delete;
+
+    // Frees the slabs. Every buffer must have been returned.
+    ~BufferPool();
+
+    // Returns an unused buffer, allocating a new slab if there is none.
+    Buffer Acquire();
+
+    uint32_t buffer_capacity() const { return buffer_capacity_; }
+
+    // The number of buffers currently acquired.
+    size_t outstanding() const { return outstanding_; }
+
+    // The number of slabs allocated so far, i.e. the number of heap
+    // allocations the pool has made.
+    size_t slab_count() const { return slab_count_; }
+
+private:
+    // Slabs and unused buffers are kept in intrusive singly linked lists,
+    // threaded through their first bytes.
+    struct Link {
+        Link* next;
+    };
+
+    void AddSlab();
+    void Release(uint8_t* data);
+
+    const uint32_t buffer_capacity_;
+    const uint32_t buffers_per_slab_;
+    Link* slabs_ = nullptr;
+    Link* free_buffers_ = nullptr;
+    size_t outstanding_ = 0u;
+    size_t slab_count_ = 0u;
+};
+
+} // namespace fidl
+
+#endif // LIB_FIDL_LLCPP_BUFFER_POOL_H_
@@ -111,6 +111,29 @@ EncodeResult<typename RequestType::ResponseType> Call(zx::channel& chan,
     });
     return result;
 }
+
+// Reads a message from the channel into the caller-provided |buffer|, e.g. the view of
+// a |BufferPool::Buffer|, and wraps it in an EncodeResult without copying it. The handles
+// are read into the EncodedMessage itself, so nothing is allocated.
+// The buffer must outlive the message.
+template <typename FidlType>
+EncodeResult<FidlType> Read(const zx::channel& chan, BytePart buffer) {
+    EncodeResult<FidlType> result;
+    result.message.Initialize([&](BytePart& bytes, HandlePart& handles) {
+        bytes = std::move(buffer);
+        uint32_t actual_num_bytes = 0u;
+        uint32_t actual_num_handles = 0u;
+        result.status = chan.read(0u, bytes.data(), bytes.capacity(), &actual_num_bytes,
+                                  handles.data(), handles.capacity(), &actual_num_handles);
+        if (result.status != ZX_OK) {
+            return;
+        }
+
+        bytes.set_actual(actual_num_bytes);
+        handles.set_actual(actual_num_handles);
+    });
+    return result;
+}
 #endif
 
 } // namespace fidl
@@ -234,6 +234,14 @@ zx_status_t fidl_linearize(const fidl_type_t* type, void* value, uint8_t* buffer
     // Zero the padding gaps
     memset(buffer + primary_size, 0, next_out_of_line - primary_size);
 
+    // A flat object is fully linearized by copying it.
+    if (fidl::IsFlat(type)) {
+        if (out_num_bytes) {
+            *out_num_bytes = static_cast<uint32_t>(next_out_of_line);
+        }
+        return ZX_OK;
+    }
+
     FidlLinearizer linearizer(buffer, num_bytes, static_cast<uint32_t>(next_out_of_line),
                               out_error_msg);
     fidl::Walk(linearizer,
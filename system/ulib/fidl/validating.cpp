@@ -201,6 +201,19 @@ zx_status_t fidl_validate(const fidl_type_t* type, const void* bytes, uint32_t n
         return status;
     }
 
+    // A flat message has nothing to validate beyond the size of its primary object.
+    if (fidl::IsFlat(type)) {
+        if (next_out_of_line != num_bytes) {
+            set_error("message did not consume all provided bytes");
+            return ZX_ERR_INVALID_ARGS;
+        }
+        if (num_handles != 0) {
+            set_error("message did not reference all provided handles");
+            return ZX_ERR_INVALID_ARGS;
+        }
+        return ZX_OK;
+    }
+
     FidlValidator validator(num_bytes, num_handles, next_out_of_line, out_error_msg);
     fidl::Walk(validator,
                type,
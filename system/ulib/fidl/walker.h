@@ -764,6 +764,14 @@ void Walk(VisitorImpl& visitor,
     walker.Walk(visitor);
 }
 
+// Returns true if |type| is a struct with no fields to code, so that encoding, decoding or
+// validating a message of this type only needs to check its size. Having no out-of-line data or
+// handles is not enough: inline unions, and strings and vectors bounded to zero elements, still
+// have constraints the walker must check.
+constexpr bool IsFlat(const fidl_type_t* type) {
+    return type->type_tag == kFidlTypeStruct && type->coded_struct.field_count == 0;
+}
+
 // Infer the size of the primary object, from the coding table in |type|.
 // Ensures that the primary object is of one of the expected types.
 //
@@ -34,6 +34,8 @@ struct {
         "Length in bytes of minfs partition"},
     {"compress", Option::kCompress, "",        nullptr,
         "Compress files before adding them to blobfs"},
+    {"merkle-cache", Option::kMerkleCache, "[dir]", nullptr,
+        "Reuse Merkle trees of unchanged files from a cache"},
     {"help",     Option::kHelp,     "",        nullptr,
         "Display this message"},
 };
@@ -230,7 +232,7 @@ zx_status_t FsCreator::ProcessArgs(int argc, char** argv) {
         opts[index] = {nullptr, 0, nullptr, 0};
 
         int opt_index;
-        int c = getopt_long(argc, argv, "+dro:l:ch", opts, &opt_index);
+        int c = getopt_long(argc, argv, "+dro:l:cm:h", opts, &opt_index);
         if (c < 0) {
             break;
         }
@@ -251,6 +253,9 @@ zx_status_t FsCreator::ProcessArgs(int argc, char** argv) {
         case 'c':
             compress_ = true;
             break;
+        case 'm':
+            merkle_cache_path_ = optarg;
+            break;
         case 'h':
         default:
             return Usage();
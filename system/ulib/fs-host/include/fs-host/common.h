@@ -33,6 +33,7 @@ enum class Option {
     kOffset,
     kLength,
     kCompress,
+    kMerkleCache,
     kHelp,
 };
 
@@ -117,6 +118,10 @@ protected:
     off_t GetOffset() const { return offset_; }
     off_t GetLength() const { return length_; }
     bool ShouldCompress() const { return compress_; }
+    // Returns the directory in which to cache Merkle trees, or nullptr if none was requested.
+    const char* GetMerkleCachePath() const {
+        return merkle_cache_path_.empty() ? nullptr : merkle_cache_path_.c_str();
+    }
 
     fbl::unique_fd fd_;
 
@@ -142,6 +147,7 @@ private:
     off_t length_;
     bool read_only_;
     bool compress_;
+    fbl::String merkle_cache_path_;
     std::mutex depfile_lock_;
     fbl::unique_fd depfile_;
 };
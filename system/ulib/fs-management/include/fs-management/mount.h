@@ -85,6 +85,8 @@ typedef struct mount_options {
     bool create_mountpoint;
     // Enable journaling on the file system (if supported).
     bool enable_journal;
+    // Number of threads the file system serves requests on (if supported).
+    uint32_t dispatch_threads;
 } mount_options_t;
 
 extern const mount_options_t default_mount_options;
@@ -196,8 +196,11 @@ zx_status_t Mounter::MountNativeFs(const char* binary, unique_fd device,
     // 2. (optional) readonly
     // 3. (optional) verbose
     // 4. (optional) metrics
-    // 5. command
-    const char* argv[5] = {binary};
+    // 5. (optional) journal
+    // 6. (optional) threads
+    // 7. command
+    char threads_arg[32];
+    const char* argv[7] = {binary};
     int argc = 1;
     if (options.readonly) {
         argv[argc++] = "--readonly";
@@ -211,6 +214,10 @@ zx_status_t Mounter::MountNativeFs(const char* binary, unique_fd device,
     if (options.enable_journal) {
         argv[argc++] = "--journal";
     }
+    if (options.dispatch_threads > 1) {
+        snprintf(threads_arg, sizeof(threads_arg), "--threads=%u", options.dispatch_threads);
+        argv[argc++] = threads_arg;
+    }
     argv[argc++] = "mount";
     return LaunchAndMount(cb, options, argv, argc);
 }
@@ -262,6 +269,7 @@ const mount_options_t default_mount_options = {
     .wait_until_ready = true,
     .create_mountpoint = false,
     .enable_journal = false,
+    .dispatch_threads = 1,
 };
 
 const mkfs_options_t default_mkfs_options = {
@@ -217,6 +217,10 @@ bool FixtureOptions::IsValid(fbl::String* err_description) const {
         }
     }
 
+    if (dispatch_threads == 0) {
+        buffer.Append("dispatch_threads must be greater than 0.\n");
+    }
+
     *err_description = buffer.ToString();
 
     return err_description->empty();
@@ -247,6 +251,7 @@ zx_status_t Fixture::Mount() {
     mount_options_t mount_options = default_mount_options;
     mount_options.create_mountpoint = true;
     mount_options.wait_until_ready = true;
+    mount_options.dispatch_threads = options_.dispatch_threads;
 
     disk_format_t format = detect_disk_format(fd.get());
     zx_status_t result = mount(fd.release(), fs_path_.c_str(), format,
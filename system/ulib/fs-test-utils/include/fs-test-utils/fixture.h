@@ -92,6 +92,9 @@ struct FixtureOptions {
     // Mount the device in |Fixture::fs_path()|. Format is auto detected.
     bool fs_mount = true;
 
+    // Number of threads the mounted filesystem serves requests on.
+    uint32_t dispatch_threads = 1;
+
     // Seed for pseudo random number generator.
     unsigned int seed = 0;
 };
@@ -54,6 +54,9 @@ Usage:
         --seed SEED                    An unsigned integer to initialize
                                        pseudo-ramdom number generator.
 
+        --dispatch_threads COUNT       Number of threads the mounted
+                                       filesystem serves requests on.
+
     [Test Options]
          --out PATH                    In performance test mode, collected
                                        results will be written to PATH.
@@ -312,6 +315,7 @@ bool ParseCommandLineArgs(int argc, const char* const* argv, FixtureOptions* fix
         {"print_statistics", no_argument, nullptr, 0},
         {"runs", required_argument, nullptr, 0},
         {"seed", required_argument, nullptr, 0},
+        {"dispatch_threads", required_argument, nullptr, 0},
         {0, 0, 0, 0},
     };
     // Resets the internal state of getopt*, making this function idempotent.
@@ -379,6 +383,10 @@ bool ParseCommandLineArgs(int argc, const char* const* argv, FixtureOptions* fix
             case 12:
                 fixture_options->seed = static_cast<unsigned int>(strtoul(optarg, NULL, 0));
                 break;
+            case 13:
+                fixture_options->dispatch_threads =
+                    static_cast<uint32_t>(strtoul(optarg, NULL, 0));
+                break;
             default:
                 break;
             }
@@ -224,6 +224,7 @@ ZXFIDL_OPERATION(DirectoryOpen)
 ZXFIDL_OPERATION(DirectoryUnlink)
 ZXFIDL_OPERATION(DirectoryReadDirents)
 ZXFIDL_OPERATION(DirectoryRewind)
+ZXFIDL_OPERATION(DirectoryReadDirentsPlus)
 ZXFIDL_OPERATION(DirectoryGetToken)
 ZXFIDL_OPERATION(DirectoryRename)
 ZXFIDL_OPERATION(DirectoryLink)
@@ -241,6 +242,7 @@ const fuchsia_io_Directory_ops kDirectoryOps {
     .Unlink = DirectoryUnlinkOp,
     .ReadDirents = DirectoryReadDirentsOp,
     .Rewind = DirectoryRewindOp,
+    .ReadDirentsPlus = DirectoryReadDirentsPlusOp,
     .GetToken = DirectoryGetTokenOp,
     .Rename = DirectoryRenameOp,
     .Link = DirectoryLinkOp,
@@ -266,6 +268,7 @@ const fuchsia_io_DirectoryAdmin_ops kDirectoryAdminOps {
     .Unlink = DirectoryUnlinkOp,
     .ReadDirents = DirectoryReadDirentsOp,
     .Rewind = DirectoryRewindOp,
+    .ReadDirentsPlus = DirectoryReadDirentsPlusOp,
     .GetToken = DirectoryGetTokenOp,
     .Rename = DirectoryRenameOp,
     .Link = DirectoryLinkOp,
@@ -278,11 +281,38 @@ const fuchsia_io_DirectoryAdmin_ops kDirectoryAdminOps {
     .GetDevicePath = DirectoryAdminGetDevicePathOp,
 };
 
+// Returns true for requests which neither modify a vnode nor the namespace,
+// and so may be handled alongside one another.
+//
+// Describe is not among them, since it may create a vnode's event.
+bool IsReadOnlyRequest(const fidl_msg_t* msg) {
+    auto hdr = static_cast<const fidl_message_header_t*>(msg->bytes);
+    switch (hdr->ordinal) {
+    case fuchsia_io_NodeGetAttrOrdinal:
+    case fuchsia_io_FileReadOrdinal:
+    case fuchsia_io_FileReadAtOrdinal:
+    case fuchsia_io_FileSeekOrdinal:
+    case fuchsia_io_FileGetFlagsOrdinal:
+    case fuchsia_io_FileGetBufferOrdinal:
+    case fuchsia_io_DirectoryReadDirentsOrdinal:
+    case fuchsia_io_DirectoryRewindOrdinal:
+    case fuchsia_io_DirectoryReadDirentsPlusOrdinal:
+        return true;
+    default:
+        return false;
+    }
+}
+
 } // namespace
 
 constexpr zx_signals_t kWakeSignals = ZX_CHANNEL_READABLE |
                                       ZX_CHANNEL_PEER_CLOSED | kLocalTeardownSignal;
 
+// The most messages handled each time the channel becomes readable, before
+// waiting on it again. Clients which pipeline requests are served without a
+// wait per message, while other connections still get their turn.
+constexpr size_t kMaxMessagesPerWakeup = 16;
+
 Connection::Connection(Vfs* vfs, fbl::RefPtr<Vnode> vnode,
                        zx::channel channel, uint32_t flags)
     : vfs_(vfs), vnode_(std::move(vnode)), channel_(std::move(channel)),
@@ -339,8 +369,16 @@ void Connection::HandleSignals(async_dispatcher_t* dispatcher, async::WaitBase*
             // opened while filesystems are torn down.
             status = ZX_ERR_PEER_CLOSED;
         } else if (signal->observed & ZX_CHANNEL_READABLE) {
-            // Handle the message.
-            status = CallHandler();
+            // Handle the pending messages.
+            size_t handled = 0;
+            do {
+                status = CallHandler();
+            } while (status == ZX_OK && ++handled < kMaxMessagesPerWakeup &&
+                     !vfs_->IsTerminating());
+            if (status == ZX_ERR_SHOULD_WAIT && handled > 0) {
+                // The channel has been drained.
+                status = ZX_OK;
+            }
             switch (status) {
             case ERR_DISPATCHER_ASYNC:
                 return;
@@ -359,6 +397,9 @@ void Connection::HandleSignals(async_dispatcher_t* dispatcher, async::WaitBase*
 }
 
 void Connection::Terminate(bool call_close) {
+    // Releasing the connection may release its vnode too, which must not
+    // happen alongside other requests.
+    DispatchLock lock(vfs_, false);
     if (call_close) {
         // Give the dispatcher a chance to clean up.
         CallClose();
@@ -375,11 +416,13 @@ void Connection::Terminate(bool call_close) {
 
 zx_status_t Connection::CallHandler() {
     return ReadMessage(channel_.get(), [this] (fidl_msg_t* msg, FidlConnection* txn) {
+        DispatchLock lock(vfs_, IsReadOnlyRequest(msg));
         return HandleMessage(msg, txn->Txn());
     });
 }
 
 void Connection::CallClose() {
+    DispatchLock lock(vfs_, false);
     CloseMessage([this] (fidl_msg_t* msg, FidlConnection* txn) {
         return HandleMessage(msg, txn->Txn());
     });
@@ -718,6 +761,19 @@ zx_status_t Connection::DirectoryReadDirents(uint64_t max_out, fidl_txn_t* txn)
     return fuchsia_io_DirectoryReadDirents_reply(txn, status, data, actual);
 }
 
+zx_status_t Connection::DirectoryReadDirentsPlus(uint64_t max_out, fidl_txn_t* txn) {
+    if (IsPathOnly(flags_)) {
+        return fuchsia_io_DirectoryReadDirentsPlus_reply(txn, ZX_ERR_BAD_HANDLE, nullptr, 0);
+    }
+    if (max_out > ZXFIDL_MAX_MSG_BYTES) {
+        return fuchsia_io_DirectoryReadDirentsPlus_reply(txn, ZX_ERR_INVALID_ARGS, nullptr, 0);
+    }
+    uint8_t data[max_out];
+    size_t actual = 0;
+    zx_status_t status = vfs_->ReaddirPlus(vnode_.get(), &dircookie_, data, max_out, &actual);
+    return fuchsia_io_DirectoryReadDirentsPlus_reply(txn, status, data, actual);
+}
+
 zx_status_t Connection::DirectoryRewind(fidl_txn_t* txn) {
     if (IsPathOnly(flags_)) {
         return fuchsia_io_DirectoryRewind_reply(txn, ZX_ERR_BAD_HANDLE);
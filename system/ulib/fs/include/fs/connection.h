@@ -101,6 +101,7 @@ public:
                               size_t path_size, zx_handle_t object);
     zx_status_t DirectoryUnlink(const char* path_data, size_t path_size, fidl_txn_t* txn);
     zx_status_t DirectoryReadDirents(uint64_t max_out, fidl_txn_t* txn);
+    zx_status_t DirectoryReadDirentsPlus(uint64_t max_out, fidl_txn_t* txn);
     zx_status_t DirectoryRewind(fidl_txn_t* txn);
     zx_status_t DirectoryGetToken(fidl_txn_t* txn);
     zx_status_t DirectoryRename(const char* src_data, size_t src_size, zx_handle_t dst_parent_token,
@@ -0,0 +1,84 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#pragma once
+
+#ifndef __Fuchsia__
+#error "Fuchsia-only header"
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <fbl/array.h>
+#include <fbl/macros.h>
+#include <fbl/ref_ptr.h>
+#include <fbl/string_piece.h>
+#include <fbl/unique_ptr.h>
+#include <zircon/types.h>
+
+namespace fs {
+
+class Vnode;
+
+// A bounded cache of the results of looking up names in directories, used by
+// the Vfs to avoid calling into the filesystem for each component of a path
+// which has recently been walked.
+//
+// Both hits and misses are cached: a "negative" entry records that a name
+// does not exist in a directory, so that repeatedly opening a missing path
+// (as when searching a list of directories) is as cheap as opening one which
+// is present.
+//
+// The cache is direct-mapped; an entry whose slot is wanted by another name
+// is simply dropped. Entries hold references to the vnodes they name, so the
+// cache must be cleared before the filesystem which owns them is destroyed.
+//
+// This class is not thread-safe; the Vfs only uses it while holding its lock.
+class LookupCache {
+public:
+    DISALLOW_COPY_ASSIGN_AND_MOVE(LookupCache);
+
+    // Number of entries in the cache.
+    static constexpr size_t kEntries = 256;
+
+    // Names longer than this are not cached.
+    static constexpr size_t kMaxNameLength = 64;
+
+    static zx_status_t Create(fbl::unique_ptr<LookupCache>* out);
+    ~LookupCache();
+
+    // Returns true if the result of looking up |name| in |dir| is cached.
+    // In that case, |out_status| holds the result: either ZX_OK, with the
+    // vnode found returned in |out|, or ZX_ERR_NOT_FOUND.
+    bool Lookup(Vnode* dir, fbl::StringPiece name, fbl::RefPtr<Vnode>* out,
+                zx_status_t* out_status) const;
+
+    // Records that |name| in |dir| refers to |vn|, or does not exist if |vn|
+    // is null.
+    void Insert(fbl::RefPtr<Vnode> dir, fbl::StringPiece name, fbl::RefPtr<Vnode> vn);
+
+    // Drops any entry for |name| in |dir|.
+    void Erase(Vnode* dir, fbl::StringPiece name);
+
+    // Drops all entries.
+    void Clear();
+
+private:
+    struct Entry {
+        fbl::RefPtr<Vnode> dir;
+        size_t name_length;
+        char name[kMaxNameLength];
+        // Null for a negative entry.
+        fbl::RefPtr<Vnode> vnode;
+    };
+
+    explicit LookupCache(fbl::Array<Entry> entries);
+
+    static size_t Slot(const Vnode* dir, fbl::StringPiece name);
+
+    fbl::Array<Entry> entries_;
+};
+
+} // namespace fs
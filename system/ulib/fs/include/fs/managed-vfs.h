@@ -11,17 +11,22 @@
 #include <lib/async/cpp/task.h>
 #include <fbl/intrusive_double_list.h>
 #include <fbl/function.h>
+#include <fbl/mutex.h>
 #include <fbl/unique_ptr.h>
 #include <fs/connection.h>
 #include <fs/vfs.h>
 
+#include <atomic>
+
 namespace fs {
 
 // A specialization of |Vfs| which provides a mechanism to tear down
 // all active connections before it is destroyed.
 //
-// This class is NOT thread-safe and it must be used with a
-// single-threaded asynchronous dispatcher. However, after an operation
+// Connections may be served on a dispatcher which runs on several threads,
+// as long as the filesystem has enabled concurrent dispatch (see
+// |Vfs::EnableConcurrentDispatch|). Otherwise it must be used with a
+// single-threaded asynchronous dispatcher. In either case, after an operation
 // has been dispatched to a connection, it is safe to defer completion
 // of that operation, returning "ERR_DISPATCHER_ASYNC".
 //
@@ -49,11 +54,11 @@ public:
 
 private:
     // Posts the task for OnShutdownComplete if it is safe to do so.
-    void CheckForShutdownComplete();
+    void CheckForShutdownCompleteLocked() __TA_REQUIRES(lock_);
 
     // Identifies if the filesystem has fully terminated, and is
     // ready for "OnShutdownComplete" to execute.
-    bool IsTerminated() const;
+    bool IsTerminatedLocked() const __TA_REQUIRES(lock_);
 
     // Invokes the handler from |Shutdown| once all connections have been
     // released. Additionally, unmounts all sub-mounted filesystems, if any
@@ -64,11 +69,15 @@ private:
     void UnregisterConnection(Connection* connection) final;
     bool IsTerminating() const final;
 
-    fbl::DoublyLinkedList<fbl::unique_ptr<Connection>> connections_;
+    // Guards connection tracking, which connections on any dispatcher thread
+    // may update as they close.
+    mutable fbl::Mutex lock_;
+    fbl::DoublyLinkedList<fbl::unique_ptr<Connection>> connections_ __TA_GUARDED(lock_);
 
-    bool is_shutting_down_;
+    std::atomic_bool is_shutting_down_;
+    bool shutdown_posted_ __TA_GUARDED(lock_) = false;
     async::TaskMethod<ManagedVfs, &ManagedVfs::OnShutdownComplete> shutdown_task_{this};
-    ShutdownCallback shutdown_handler_;
+    ShutdownCallback shutdown_handler_ __TA_GUARDED(lock_);
 };
 
 } // namespace fs
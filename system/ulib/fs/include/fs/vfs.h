@@ -17,6 +17,8 @@
 #include <zircon/types.h>
 
 #ifdef __Fuchsia__
+#include <pthread.h>
+
 #include <lib/async/dispatcher.h>
 #include <lib/fdio/io.h>
 #include <lib/zx/channel.h>
@@ -40,6 +42,9 @@ namespace fs {
 
 class Connection;
 class Vnode;
+#ifdef __Fuchsia__
+class LookupCache;
+#endif
 
 inline constexpr bool IsWritable(uint32_t flags) {
     return flags & ZX_FS_RIGHT_WRITABLE;
@@ -151,6 +156,9 @@ public:
     // modification operations for the duration of the operation.
     zx_status_t Readdir(Vnode* vn, vdircookie_t* cookie,
                         void* dirents, size_t len, size_t* out_actual) FS_TA_EXCLUDES(vfs_lock_);
+    // As Readdir, but calls ReaddirPlus.
+    zx_status_t ReaddirPlus(Vnode* vn, vdircookie_t* cookie,
+                            void* dirents, size_t len, size_t* out_actual) FS_TA_EXCLUDES(vfs_lock_);
 
     Vfs(async_dispatcher_t* dispatcher);
 
@@ -187,6 +195,22 @@ public:
     // Unpins all remote filesystems in the current filesystem, and waits for the
     // response of each one with the provided deadline.
     zx_status_t UninstallAll(zx_time_t deadline) FS_TA_EXCLUDES(vfs_lock_);
+
+    // Drops all cached lookups, releasing the vnodes they refer to.
+    void FlushLookupCache() FS_TA_EXCLUDES(vfs_lock_);
+
+    // Allows the dispatcher to be run on several threads, with requests
+    // which only read from a vnode (Read, GetAttr, ReadDirents, GetBuffer and
+    // the like) handled in parallel. Any other request excludes all others.
+    //
+    // The filesystem's vnodes must tolerate concurrent calls to Read,
+    // Getattr, Readdir and GetVmo. Must be called before any connection is
+    // served, and only by a Vfs which tracks connections in a thread-safe
+    // way, as ManagedVfs does.
+    void EnableConcurrentDispatch() { concurrent_dispatch_ = true; }
+
+    // Whether requests may be handled on several threads at once.
+    bool dispatches_concurrently() const { return concurrent_dispatch_; }
 #endif
 
 protected:
@@ -204,6 +228,11 @@ private:
     zx_status_t Walk(fbl::RefPtr<Vnode> vn, fbl::RefPtr<Vnode>* out,
                      fbl::StringPiece path, fbl::StringPiece* pathout) FS_TA_REQUIRES(vfs_lock_);
 
+    // Looks up the single path component |name| in |vn|, using the lookup
+    // cache if it is enabled.
+    zx_status_t LookupLocked(fbl::RefPtr<Vnode> vn, fbl::RefPtr<Vnode>* out,
+                             fbl::StringPiece name) FS_TA_REQUIRES(vfs_lock_);
+
     zx_status_t OpenLocked(fbl::RefPtr<Vnode> vn, fbl::RefPtr<Vnode>* out,
                            fbl::StringPiece path, fbl::StringPiece* pathout,
                            uint32_t flags, uint32_t mode) FS_TA_REQUIRES(vfs_lock_);
@@ -239,10 +268,53 @@ private:
 
     async_dispatcher_t* dispatcher_{};
 
+    // Null unless enabled with |EnableLookupCache|.
+    fbl::unique_ptr<LookupCache> lookup_cache_ FS_TA_GUARDED(vfs_lock_);
+
+    // Held by |DispatchLock|.
+    //
+    // There is one lock for the whole Vfs rather than one per vnode, because
+    // a request which modifies one vnode can also change state its vnodes
+    // share: allocation bitmaps, the inode table, writeback, and caches of
+    // vnodes such as blobfs's. Filesystems were written for a single
+    // dispatcher thread, so only requests which read from a vnode run in
+    // parallel, and anything else excludes every other request.
+    //
+    // This lock is taken before any lock of the filesystem's own. In
+    // particular:
+    // - A dispatcher thread holding it may fault on a vnode VMO paged by the
+    //   minfs Pager, and wait for the pager thread. The pager thread takes
+    //   only Pager's lock, and never this one.
+    // - Blobfs takes the BlobCache lock and a Blob's VMO lock while holding
+    //   this lock. It only takes this lock once it has released those, as
+    //   when a blob whose clones are gone drops its last reference.
+    friend class DispatchLock;
+    bool concurrent_dispatch_ = false;
+    pthread_rwlock_t dispatch_lock_ = PTHREAD_RWLOCK_INITIALIZER;
+
 protected:
     // A lock which should be used to protect lookup and walk operations
     mtx_t vfs_lock_{};
 
+    // Caches the results of looking up path components, including names
+    // which were not found, so that walking the same paths again doesn't call
+    // into the filesystem.
+    //
+    // The Vfs keeps the cache up to date as long as every change to the
+    // namespace is made through it (by Open with ZX_FS_FLAG_CREATE, Unlink,
+    // Rename or Link). A filesystem which changes its directories any other
+    // way must call |InvalidateLookupLocked| or |FlushLookupCacheLocked|.
+    //
+    // Cached vnodes are kept alive by the cache, so a filesystem which
+    // enables it must call |FlushLookupCache| before it is torn down.
+    void EnableLookupCache() FS_TA_EXCLUDES(vfs_lock_);
+
+    // Drops any cached lookup of |name| in |dir|.
+    void InvalidateLookupLocked(Vnode* dir, fbl::StringPiece name) FS_TA_REQUIRES(vfs_lock_);
+
+    // Drops all cached lookups.
+    void FlushLookupCacheLocked() FS_TA_REQUIRES(vfs_lock_);
+
     // Starts tracking the lifetime of the connection.
     virtual void RegisterConnection(fbl::unique_ptr<Connection> connection) = 0;
 
@@ -252,4 +324,32 @@ protected:
 #endif // ifdef __Fuchsia__
 };
 
+#ifdef __Fuchsia__
+
+// Holds the lock which connections take while handling a request, if |vfs|
+// has enabled concurrent dispatch. Requests which only read from a vnode
+// hold it shared (|read_only|), so that they run in parallel; everything
+// else which may modify the filesystem holds it exclusively.
+//
+// Does nothing on a thread which already holds the lock of the same |vfs|, as
+// when a request handler closes its own connection. DispatchLocks must be
+// destroyed in the reverse order they were constructed on a thread.
+class DispatchLock {
+public:
+    DISALLOW_COPY_ASSIGN_AND_MOVE(DispatchLock);
+
+    DispatchLock(Vfs* vfs, bool read_only);
+    ~DispatchLock();
+
+private:
+    static bool HeldByCurrentThread(const Vfs* vfs);
+
+    // Null if this doesn't hold the lock.
+    Vfs* const vfs_;
+    // The DispatchLock constructed on this thread before this one.
+    DispatchLock* const outer_;
+};
+
+#endif // __Fuchsia__
+
 } // namespace fs
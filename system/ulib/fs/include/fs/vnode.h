@@ -150,6 +150,16 @@ public:
     virtual zx_status_t Readdir(vdircookie_t* cookie, void* dirents, size_t len,
                                 size_t* out_actual);
 
+    // Read directory entries of vn along with their attributes, as
+    // vdirent_plus_t records, sharing the cookie used by Readdir. Returns
+    // ZX_ERR_BUFFER_TOO_SMALL if len can't hold the next entry.
+    //
+    // The default implementation reads entries with Readdir, and looks up
+    // each one to read its attributes. Filesystems which can read the
+    // attributes of an entry more cheaply should override it.
+    virtual zx_status_t ReaddirPlus(vdircookie_t* cookie, void* dirents, size_t len,
+                                    size_t* out_actual);
+
     // METHODS FOR OPENED OR UNOPENED NODES
     //
     // The following operations may be invoked on a Vnode, even if it has
@@ -243,4 +253,32 @@ private:
     const size_t len_;
 };
 
+// Helper class used to fill direntries during calls to ReaddirPlus.
+class DirentPlusFiller {
+public:
+    DISALLOW_COPY_ASSIGN_AND_MOVE(DirentPlusFiller);
+
+    DirentPlusFiller(void* ptr, size_t len);
+
+    // Attempts to add the name and the attributes of the node it names to
+    // the end of the dirent buffer. |attr| may be null if the attributes
+    // could not be read.
+    zx_status_t Next(fbl::StringPiece name, uint8_t type, const vnattr_t* attr);
+
+    size_t BytesFilled() const {
+        return pos_;
+    }
+
+    // Returns the number of bytes filled in |out_actual|, or
+    // ZX_ERR_BUFFER_TOO_SMALL if the buffer couldn't hold the first entry,
+    // which would otherwise look like the end of the directory.
+    zx_status_t Finish(size_t* out_actual) const;
+
+private:
+    char* ptr_;
+    size_t pos_;
+    const size_t len_;
+    bool full_;
+};
+
 } // namespace fs
@@ -0,0 +1,102 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string.h>
+
+#include <fbl/alloc_checker.h>
+#include <fs/lookup-cache.h>
+#include <fs/vnode.h>
+
+#include <utility>
+
+namespace fs {
+namespace {
+
+constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+uint64_t FnvHash(uint64_t hash, const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * kFnvPrime;
+    }
+    return hash;
+}
+
+} // namespace
+
+zx_status_t LookupCache::Create(fbl::unique_ptr<LookupCache>* out) {
+    fbl::AllocChecker ac;
+    fbl::Array<Entry> entries(new (&ac) Entry[kEntries](), kEntries);
+    if (!ac.check()) {
+        return ZX_ERR_NO_MEMORY;
+    }
+    fbl::unique_ptr<LookupCache> cache(new (&ac) LookupCache(std::move(entries)));
+    if (!ac.check()) {
+        return ZX_ERR_NO_MEMORY;
+    }
+    *out = std::move(cache);
+    return ZX_OK;
+}
+
+LookupCache::LookupCache(fbl::Array<Entry> entries) : entries_(std::move(entries)) {}
+
+LookupCache::~LookupCache() = default;
+
+size_t LookupCache::Slot(const Vnode* dir, fbl::StringPiece name) {
+    uintptr_t key = reinterpret_cast<uintptr_t>(dir);
+    uint64_t hash = FnvHash(kFnvOffsetBasis, &key, sizeof(key));
+    hash = FnvHash(hash, name.data(), name.length());
+    return hash % kEntries;
+}
+
+bool LookupCache::Lookup(Vnode* dir, fbl::StringPiece name, fbl::RefPtr<Vnode>* out,
+                         zx_status_t* out_status) const {
+    if (name.length() > kMaxNameLength) {
+        return false;
+    }
+    const Entry& entry = entries_[Slot(dir, name)];
+    if (entry.dir.get() != dir || entry.name_length != name.length() ||
+        memcmp(entry.name, name.data(), name.length()) != 0) {
+        return false;
+    }
+    if (entry.vnode == nullptr) {
+        *out_status = ZX_ERR_NOT_FOUND;
+    } else {
+        *out = entry.vnode;
+        *out_status = ZX_OK;
+    }
+    return true;
+}
+
+void LookupCache::Insert(fbl::RefPtr<Vnode> dir, fbl::StringPiece name,
+                         fbl::RefPtr<Vnode> vn) {
+    if (name.length() > kMaxNameLength) {
+        return;
+    }
+    Entry& entry = entries_[Slot(dir.get(), name)];
+    entry.dir = std::move(dir);
+    entry.name_length = name.length();
+    memcpy(entry.name, name.data(), name.length());
+    entry.vnode = std::move(vn);
+}
+
+void LookupCache::Erase(Vnode* dir, fbl::StringPiece name) {
+    if (name.length() > kMaxNameLength) {
+        return;
+    }
+    Entry& entry = entries_[Slot(dir, name)];
+    if (entry.dir.get() == dir && entry.name_length == name.length() &&
+        memcmp(entry.name, name.data(), name.length()) == 0) {
+        entry = Entry();
+    }
+}
+
+void LookupCache::Clear() {
+    for (Entry& entry : entries_) {
+        entry = Entry();
+    }
+}
+
+} // namespace fs
@@ -4,6 +4,7 @@
 
 #include <fs/managed-vfs.h>
 
+#include <fbl/auto_lock.h>
 #include <fbl/unique_ptr.h>
 #include <lib/async/cpp/task.h>
 #include <lib/sync/completion.h>
@@ -17,10 +18,11 @@ ManagedVfs::ManagedVfs() : is_shutting_down_(false) {}
 ManagedVfs::ManagedVfs(async_dispatcher_t* dispatcher) : Vfs(dispatcher), is_shutting_down_(false) {}
 
 ManagedVfs::~ManagedVfs() {
+    fbl::AutoLock lock(&lock_);
     ZX_DEBUG_ASSERT(connections_.is_empty());
 }
 
-bool ManagedVfs::IsTerminated() const {
+bool ManagedVfs::IsTerminatedLocked() const {
     return is_shutting_down_ && connections_.is_empty();
 }
 
@@ -28,50 +30,73 @@ bool ManagedVfs::IsTerminated() const {
 void ManagedVfs::Shutdown(ShutdownCallback handler) {
     ZX_DEBUG_ASSERT(handler);
     zx_status_t status = async::PostTask(dispatcher(), [this, closure = std::move(handler)]() mutable {
-        ZX_DEBUG_ASSERT(!shutdown_handler_);
-        shutdown_handler_ = std::move(closure);
-        is_shutting_down_ = true;
+        {
+            fbl::AutoLock lock(&lock_);
+            ZX_DEBUG_ASSERT(!shutdown_handler_);
+            shutdown_handler_ = std::move(closure);
+            is_shutting_down_ = true;
+        }
 
         UninstallAll(ZX_TIME_INFINITE);
+        {
+            // Flushing may release the last references to vnodes.
+            DispatchLock dispatch_lock(this, false);
+            FlushLookupCache();
+        }
 
+        fbl::AutoLock lock(&lock_);
         // Signal the teardown on channels in a way that doesn't potentially
         // pull them out from underneath async callbacks.
         for (auto& c : connections_) {
             c.AsyncTeardown();
         }
 
-        CheckForShutdownComplete();
+        CheckForShutdownCompleteLocked();
     });
     ZX_DEBUG_ASSERT(status == ZX_OK);
 }
 
 // Trigger "OnShutdownComplete" if all preconditions have been met.
-void ManagedVfs::CheckForShutdownComplete() {
-    if (IsTerminated()) {
+void ManagedVfs::CheckForShutdownCompleteLocked() {
+    // With several dispatcher threads, the last connections may close
+    // concurrently with the shutdown task; only post completion once.
+    if (IsTerminatedLocked() && !shutdown_posted_) {
+        shutdown_posted_ = true;
         shutdown_task_.Post(dispatcher());
     }
 }
 
 void ManagedVfs::OnShutdownComplete(async_dispatcher_t*, async::TaskBase*, zx_status_t status) {
-    ZX_ASSERT_MSG(IsTerminated(),
-                  "Failed to complete VFS shutdown: dispatcher status = %d\n", status);
-    ZX_DEBUG_ASSERT(shutdown_handler_);
-
-    auto handler = std::move(shutdown_handler_);
+    ShutdownCallback handler;
+    {
+        fbl::AutoLock lock(&lock_);
+        ZX_ASSERT_MSG(IsTerminatedLocked(),
+                      "Failed to complete VFS shutdown: dispatcher status = %d\n", status);
+        ZX_DEBUG_ASSERT(shutdown_handler_);
+        handler = std::move(shutdown_handler_);
+    }
+    {
+        // Wait for the thread which released the last connection to let go
+        // of the dispatch lock, since the handler may destroy this object.
+        DispatchLock dispatch_lock(this, false);
+    }
     handler(status);
 }
 
 void ManagedVfs::RegisterConnection(fbl::unique_ptr<Connection> connection) {
     ZX_DEBUG_ASSERT(!is_shutting_down_);
+    fbl::AutoLock lock(&lock_);
     connections_.push_back(std::move(connection));
 }
 
 void ManagedVfs::UnregisterConnection(Connection* connection) {
     // We drop the result of |erase| on the floor, effectively destroying the
     // connection when all other references (like async callbacks) have
-    // completed.
+    // completed. This happens before shutdown completion can be posted, so
+    // that no connection outlives the filesystem on another thread.
+    fbl::AutoLock lock(&lock_);
     connections_.erase(*connection);
-    CheckForShutdownComplete();
+    CheckForShutdownCompleteLocked();
 }
 
 bool ManagedVfs::IsTerminating() const {
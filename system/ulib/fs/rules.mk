@@ -21,6 +21,7 @@ MODULE_SRCS += \
     $(LOCAL_DIR)/fvm.cpp \
     $(LOCAL_DIR)/handler.cpp \
     $(LOCAL_DIR)/lazy-dir.cpp \
+    $(LOCAL_DIR)/lookup-cache.cpp \
     $(LOCAL_DIR)/managed-vfs.cpp \
     $(LOCAL_DIR)/metrics.cpp \
     $(LOCAL_DIR)/mount.cpp \
@@ -19,6 +19,7 @@
 #include <fbl/auto_lock.h>
 #include <fbl/ref_ptr.h>
 #include <fs/connection.h>
+#include <fs/lookup-cache.h>
 #include <fs/remote.h>
 #include <lib/zx/event.h>
 #include <lib/zx/process.h>
@@ -108,6 +109,45 @@ Vfs::~Vfs() = default;
 #ifdef __Fuchsia__
 Vfs::Vfs(async_dispatcher_t* dispatcher)
     : dispatcher_(dispatcher) {}
+
+namespace {
+
+// The DispatchLocks constructed on the current thread and not yet destroyed,
+// innermost first.
+thread_local DispatchLock* t_dispatch_locks = nullptr;
+
+} // namespace
+
+bool DispatchLock::HeldByCurrentThread(const Vfs* vfs) {
+    for (const DispatchLock* lock = t_dispatch_locks; lock != nullptr; lock = lock->outer_) {
+        if (lock->vfs_ == vfs) {
+            return true;
+        }
+    }
+    return false;
+}
+
+DispatchLock::DispatchLock(Vfs* vfs, bool read_only)
+    : vfs_(vfs->dispatches_concurrently() && !HeldByCurrentThread(vfs) ? vfs : nullptr),
+      outer_(t_dispatch_locks) {
+    t_dispatch_locks = this;
+    if (vfs_ == nullptr) {
+        return;
+    }
+    if (read_only) {
+        ZX_ASSERT(pthread_rwlock_rdlock(&vfs_->dispatch_lock_) == 0);
+    } else {
+        ZX_ASSERT(pthread_rwlock_wrlock(&vfs_->dispatch_lock_) == 0);
+    }
+}
+
+DispatchLock::~DispatchLock() {
+    ZX_DEBUG_ASSERT(t_dispatch_locks == this);
+    t_dispatch_locks = outer_;
+    if (vfs_ != nullptr) {
+        ZX_ASSERT(pthread_rwlock_unlock(&vfs_->dispatch_lock_) == 0);
+    }
+}
 #endif
 
 zx_status_t Vfs::Open(fbl::RefPtr<Vnode> vndir, fbl::RefPtr<Vnode>* out,
@@ -168,11 +208,12 @@ zx_status_t Vfs::OpenLocked(fbl::RefPtr<Vnode> vndir, fbl::RefPtr<Vnode>* out,
             return r;
         }
 #ifdef __Fuchsia__
+        InvalidateLookupLocked(vndir.get(), path);
         vndir->Notify(path, fuchsia_io_WATCH_EVENT_ADDED);
 #endif
     } else {
     try_open:
-        r = vfs_lookup(std::move(vndir), &vn, path);
+        r = LookupLocked(std::move(vndir), &vn, path);
         if (r < 0) {
             return r;
         }
@@ -229,6 +270,13 @@ zx_status_t Vfs::Unlink(fbl::RefPtr<Vnode> vndir, fbl::StringPiece path) {
             r = ZX_ERR_ACCESS_DENIED;
         } else {
             r = vndir->Unlink(path, must_be_dir);
+#ifdef __Fuchsia__
+            if (r == ZX_OK) {
+                // Lookups within the unlinked node are cached as well as
+                // the lookup of the node itself, so drop everything.
+                FlushLookupCacheLocked();
+            }
+#endif
         }
     }
     if (r != ZX_OK) {
@@ -337,6 +385,10 @@ zx_status_t Vfs::Rename(zx::event token, fbl::RefPtr<Vnode> oldparent,
 
         r = oldparent->Rename(newparent, oldStr, newStr, old_must_be_dir,
                               new_must_be_dir);
+        if (r == ZX_OK) {
+            // Both names change, and a directory may have been replaced.
+            FlushLookupCacheLocked();
+        }
     }
     if (r != ZX_OK) {
         return r;
@@ -352,6 +404,39 @@ zx_status_t Vfs::Readdir(Vnode* vn, vdircookie_t* cookie,
     return vn->Readdir(cookie, dirents, len, out_actual);
 }
 
+zx_status_t Vfs::ReaddirPlus(Vnode* vn, vdircookie_t* cookie,
+                             void* dirents, size_t len, size_t* out_actual) {
+    fbl::AutoLock lock(&vfs_lock_);
+    return vn->ReaddirPlus(cookie, dirents, len, out_actual);
+}
+
+void Vfs::EnableLookupCache() {
+    fbl::unique_ptr<LookupCache> cache;
+    if (LookupCache::Create(&cache) != ZX_OK) {
+        // Lookups still work without the cache, only more slowly.
+        return;
+    }
+    fbl::AutoLock lock(&vfs_lock_);
+    lookup_cache_ = std::move(cache);
+}
+
+void Vfs::InvalidateLookupLocked(Vnode* dir, fbl::StringPiece name) {
+    if (lookup_cache_ != nullptr) {
+        lookup_cache_->Erase(dir, name);
+    }
+}
+
+void Vfs::FlushLookupCacheLocked() {
+    if (lookup_cache_ != nullptr) {
+        lookup_cache_->Clear();
+    }
+}
+
+void Vfs::FlushLookupCache() {
+    fbl::AutoLock lock(&vfs_lock_);
+    FlushLookupCacheLocked();
+}
+
 zx_status_t Vfs::Link(zx::event token, fbl::RefPtr<Vnode> oldparent,
                       fbl::StringPiece oldStr, fbl::StringPiece newStr) {
     fbl::AutoLock lock(&vfs_lock_);
@@ -392,6 +477,7 @@ zx_status_t Vfs::Link(zx::event token, fbl::RefPtr<Vnode> oldparent,
     if (r != ZX_OK) {
         return r;
     }
+    InvalidateLookupLocked(newparent.get(), newStr);
     newparent->Notify(newStr, fuchsia_io_WATCH_EVENT_ADDED);
     return ZX_OK;
 }
@@ -440,6 +526,34 @@ void Vfs::SetReadonly(bool value) {
     readonly_ = value;
 }
 
+zx_status_t Vfs::LookupLocked(fbl::RefPtr<Vnode> vn, fbl::RefPtr<Vnode>* out,
+                              fbl::StringPiece name) {
+#ifdef __Fuchsia__
+    if (lookup_cache_ == nullptr || name == "." || name == "..") {
+        return vfs_lookup(std::move(vn), out, name);
+    }
+    zx_status_t r;
+    if (lookup_cache_->Lookup(vn.get(), name, out, &r)) {
+        return r;
+    }
+    fbl::RefPtr<Vnode> child;
+    if ((r = vn->Lookup(&child, name)) == ZX_ERR_NOT_FOUND) {
+        lookup_cache_->Insert(std::move(vn), name, nullptr);
+    } else if (r == ZX_OK && child->ValidateFlags(ZX_FS_FLAG_DIRECTORY) == ZX_OK) {
+        // Only directories are cached. They are what paths are walked
+        // through, and holding references to files would keep them (and
+        // their contents) in memory after they are closed.
+        lookup_cache_->Insert(std::move(vn), name, child);
+    }
+    if (r == ZX_OK) {
+        *out = std::move(child);
+    }
+    return r;
+#else
+    return vfs_lookup(std::move(vn), out, name);
+#endif
+}
+
 zx_status_t Vfs::Walk(fbl::RefPtr<Vnode> vn, fbl::RefPtr<Vnode>* out_vn,
                       fbl::StringPiece path, fbl::StringPiece* out_path) {
     zx_status_t r;
@@ -478,7 +592,7 @@ zx_status_t Vfs::Walk(fbl::RefPtr<Vnode> vn, fbl::RefPtr<Vnode>* out_vn,
 
         // Path has at least one additional segment.
         fbl::StringPiece component(path.data(), next_path - path.data());
-        if ((r = vfs_lookup(std::move(vn), &vn, component)) != ZX_OK) {
+        if ((r = LookupLocked(std::move(vn), &vn, component)) != ZX_OK) {
             return r;
         }
         // Traverse to the next segment.
@@ -74,6 +74,71 @@ zx_status_t Vnode::Readdir(vdircookie_t* cookie, void* dirents, size_t len, size
     return ZX_ERR_NOT_SUPPORTED;
 }
 
+namespace {
+
+zx_status_t GetEntryAttributes(Vnode* dir, fbl::StringPiece name, vnattr_t* attr) {
+    if (name == ".") {
+        return dir->Getattr(attr);
+    }
+    fbl::RefPtr<Vnode> vn;
+    zx_status_t status = dir->Lookup(&vn, name);
+    if (status != ZX_OK) {
+        return status;
+    }
+#ifdef __Fuchsia__
+    if (vn->IsRemote()) {
+        // The attributes of a mount point are those of another filesystem.
+        return ZX_ERR_NOT_SUPPORTED;
+    }
+#endif
+    return vn->Getattr(attr);
+}
+
+} // namespace
+
+zx_status_t Vnode::ReaddirPlus(vdircookie_t* cookie, void* dirents, size_t len,
+                               size_t* out_actual) {
+    DirentPlusFiller df(dirents, len);
+    char buffer[1024];
+    for (;;) {
+        vdircookie_t start = *cookie;
+        size_t actual;
+        zx_status_t status = Readdir(cookie, buffer, sizeof(buffer), &actual);
+        if (status != ZX_OK) {
+            if (df.BytesFilled() > 0) {
+                break;
+            }
+            return status;
+        }
+        if (actual == 0) {
+            break;
+        }
+        size_t off = 0;
+        while (off < actual) {
+            const vdirent_t* de = reinterpret_cast<const vdirent_t*>(buffer + off);
+            fbl::StringPiece name(de->name, de->size);
+            vnattr_t attr;
+            memset(&attr, 0, sizeof(attr));
+            status = GetEntryAttributes(this, name, &attr);
+            if (df.Next(name, de->type, status == ZX_OK ? &attr : nullptr) != ZX_OK) {
+                break;
+            }
+            off += sizeof(vdirent_t) + de->size;
+        }
+        if (off < actual) {
+            // Readdir moved the cookie past entries which didn't fit, so it
+            // is moved back, and then past only the ones which did.
+            *cookie = start;
+            if (off > 0) {
+                status = Readdir(cookie, buffer, off, &actual);
+                ZX_DEBUG_ASSERT(status == ZX_OK && actual == off);
+            }
+            break;
+        }
+    }
+    return df.Finish(out_actual);
+}
+
 zx_status_t Vnode::Create(fbl::RefPtr<Vnode>* out, fbl::StringPiece name, uint32_t mode) {
     return ZX_ERR_NOT_SUPPORTED;
 }
@@ -153,4 +218,41 @@ zx_status_t DirentFiller::Next(fbl::StringPiece name, uint8_t type, uint64_t ino
     return ZX_OK;
 }
 
+DirentPlusFiller::DirentPlusFiller(void* ptr, size_t len)
+    : ptr_(static_cast<char*>(ptr)), pos_(0), len_(len), full_(false) {}
+
+zx_status_t DirentPlusFiller::Next(fbl::StringPiece name, uint8_t type, const vnattr_t* attr) {
+    size_t sz = VDIRENT_PLUS_LEN(name.length());
+
+    if (name.length() > NAME_MAX) {
+        return ZX_ERR_INVALID_ARGS;
+    }
+    if (sz > len_ - pos_) {
+        full_ = true;
+        return ZX_ERR_INVALID_ARGS;
+    }
+    // The buffer need not be aligned, so the entry is copied into place.
+    vdirent_plus_t de;
+    memset(&de, 0, sizeof(de));
+    if (attr != nullptr) {
+        de.attr = *attr;
+    }
+    de.size = static_cast<uint8_t>(name.length());
+    de.type = type;
+    size_t header = offsetof(vdirent_plus_t, name);
+    memcpy(ptr_ + pos_, &de, header);
+    memcpy(ptr_ + pos_ + header, name.data(), name.length());
+    memset(ptr_ + pos_ + header + name.length(), 0, sz - header - name.length());
+    pos_ += sz;
+    return ZX_OK;
+}
+
+zx_status_t DirentPlusFiller::Finish(size_t* out_actual) const {
+    if (pos_ == 0 && full_) {
+        return ZX_ERR_BUFFER_TOO_SMALL;
+    }
+    *out_actual = pos_;
+    return ZX_OK;
+}
+
 } // namespace fs
@@ -1132,6 +1132,8 @@ static void free_ftl(void* vol) {
         FsFree(ftl->blk_wc_lag);
     if (ftl->mpns)
         FsFree(ftl->mpns);
+    if (ftl->rec_pgs)
+        FsFree(ftl->rec_pgs);
     if (ftl->main_buf)
         FsAfreeClear(&ftl->main_buf);
     if (ftl->map_cache)
@@ -1400,6 +1402,11 @@ void* FtlnAddVol(FtlNdmVol* ftl_dvr, int ftl_type, int sect_size, void* fs_vol)
     if (ftl->mpns == NULL)
         goto FtlnAddV_err;
 
+    // Allocate memory to sort the pages of a volume block being recycled.
+    ftl->rec_pgs = FsMalloc(2 * ftl->pgs_per_blk * sizeof(ui32));
+    if (ftl->rec_pgs == NULL)
+        goto FtlnAddV_err;
+
 // For SLC devices, adjust driver cached MPNs if too big or zero.
 #if INC_FTL_NDM_MLC && (INC_FTL_NDM_SLC || INC_FTL_NOR_WR1)
     if (ftl->type == NDM_SLC)
@@ -634,6 +634,19 @@ static ui32 next_recycle_blk(FTLN ftl) {
     return rec_b;
 }
 
+//     cmp_vpn: qsort() comparison function for (VPN, page #) pairs
+//
+//      Inputs: a, b = pointers to the pairs to compare
+//
+//     Returns: Negative, zero or positive as a's VPN is less than,
+//              equal to or greater than b's
+//
+static int cmp_vpn(const void* a, const void* b) {
+    ui32 vpn_a = *(const ui32*)a, vpn_b = *(const ui32*)b;
+
+    return (vpn_a > vpn_b) - (vpn_a < vpn_b);
+}
+
 // recycle_vblk: Recycle one volume block
 //
 //      Inputs: ftl = pointer to FTL control block
@@ -642,22 +655,18 @@ static ui32 next_recycle_blk(FTLN ftl) {
 //     Returns: 0 on success, -1 on error
 //
 static int recycle_vblk(FTLN ftl, ui32 recycle_b) {
-    ui32 pn, past_end;
+    ui32 pn, past_end, i, num_pgs = 0, *rec_pgs = ftl->rec_pgs;
 
 #if FTLN_DEBUG > 1
     printf("recycle_vblk: block# %u\n", recycle_b);
 #endif
 
-    // Transfer all used pages from recycle block to free block.
+    // List the VPN of each page in recycle block, to find the used ones.
     pn = recycle_b * ftl->pgs_per_blk;
     past_end = pn + ftl->pgs_per_blk;
-    for (; NUM_USED(ftl->bdata[recycle_b]); ++pn) {
+    for (; pn < past_end; ++pn) {
         int rc;
-        ui32 vpn, pn2;
-
-        // Error if looped over block and not enough valid used pages.
-        if (pn >= past_end)
-            return FtlnFatErr(ftl);
+        ui32 vpn;
 
         // Read page's spare area.
         ++ftl->stats.read_spare;
@@ -675,20 +684,38 @@ static int recycle_vblk(FTLN ftl, ui32 recycle_b) {
         vpn = GET_SA_VPN(ftl->spare_buf);
         if (vpn > ftl->num_vpages)
             continue;
+        rec_pgs[2 * num_pgs] = vpn;
+        rec_pgs[2 * num_pgs + 1] = pn;
+        ++num_pgs;
+    }
+
+    // Transfer pages in VPN order, so those sharing a map page are moved
+    // together. That way each map page is looked up, and if the map cache
+    // is too small to keep it, written back, once per recycle rather than
+    // once per page.
+    qsort(rec_pgs, num_pgs, 2 * sizeof(ui32), cmp_vpn);
+
+    // Transfer all used pages from recycle block to free block.
+    for (i = 0; i < num_pgs && NUM_USED(ftl->bdata[recycle_b]); ++i) {
+        ui32 vpn = rec_pgs[2 * i], pn2;
 
         // Retrieve physical page number for VPN. Return -1 if error.
         if (FtlnMapGetPpn(ftl, vpn, &pn2) < 0)
             return -1;
 
         // Skip page copy if physical mapping is outdated.
-        if (pn2 != pn)
+        if (pn2 != rec_pgs[2 * i + 1])
             continue;
 
         // Write page to new flash block. Return -1 if error.
-        if (wr_vol_page(ftl, vpn, NULL, pn))
+        if (wr_vol_page(ftl, vpn, NULL, pn2))
             return -1;
     }
 
+    // Error if not enough valid used pages were found.
+    if (NUM_USED(ftl->bdata[recycle_b]))
+        return FtlnFatErr(ftl);
+
     // Save MPGs modified by volume page transfers. Return -1 if error.
     if (ftlmcFlushMaps(ftl->map_cache))
         return -1;
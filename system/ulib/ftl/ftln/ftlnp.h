@@ -217,6 +217,7 @@ struct ftln {
     ui32* bdata;     // block metadata: flags and counts
     ui8* blk_wc_lag; // amount block erase counts lag 'high_wc'
     ui32* mpns;      // array holding phy page # of map pages
+    ui32* rec_pgs;   // (VPN, page #) pairs of block being recycled
 
 #if INC_FTL_PAGE_CACHE
     void* vol_cache; // handle to volume page cache
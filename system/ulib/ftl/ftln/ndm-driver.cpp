@@ -142,7 +142,7 @@ const char* NdmBaseDriver::CreateNdmVolume(const Volume* ftl_volume, const Volum
     XfsVol xfs = {};
 
     ftl.flags = FSF_EXTRA_FREE;
-    ftl.cached_map_pages = options.num_blocks * (options.block_size / options.page_size);
+    ftl.cached_map_pages = options.map_cache_pages;
     ftl.extra_free = 6;  // Over-provision 6% of the device.
     xfs.ftl_volume = const_cast<Volume*>(ftl_volume);
 
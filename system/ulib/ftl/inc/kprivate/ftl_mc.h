@@ -27,6 +27,7 @@ typedef struct {
     ui32 num_mpgs;         // number of cached map pages
     ui32 num_dirty;        // number of dirty cached entries
     ui32 mpg_sz;           // size of a cached map page in bytes
+    ui32 hash_shift;       // 32 - log2(number of hash table buckets)
 } FTLMC;
 
 /***********************************************************************/
@@ -30,6 +30,11 @@ struct VolumeOptions {
     uint32_t page_size;
     uint32_t eb_size;  // Extra bytes, a.k.a. OOB.
     uint32_t flags;
+
+    // Number of FTL map pages to keep in RAM. Each one maps page_size / 4
+    // pages of the volume. Zero (the default) caches the whole map, which
+    // avoids map writes on cache evictions at the cost of the most RAM.
+    uint32_t map_cache_pages;
 };
 
 // Encapsulates the lower layer TargetFtl-Ndm driver.
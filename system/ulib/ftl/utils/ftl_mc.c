@@ -29,13 +29,21 @@ struct ftlmc_cache_entry {
 
 //        hash: Hash based on the page number
 //
-//      Inputs: mpn = map page number to be hashed
-//              num_mpgs = size of hash table in number of map pages
+//      Inputs: cache = cache handle
+//              mpn = map page number to be hashed
 //
 //     Returns: Index into the hash table where value gets hashed
 //
-static ui32 hash(ui32 mpn, ui32 num_mpgs) {
-    return (19823u * mpn + 321043U) % num_mpgs;
+static ui32 hash(const FTLMC* cache, ui32 mpn) {
+    // Fibonacci hashing: the top bits of the product spread consecutive
+    // page numbers across the power-of-two sized table without a division.
+    return (mpn * 2654435769u) >> cache->hash_shift;
+}
+
+//  hash_size: Number of buckets in the cache's hash table
+//
+static ui32 hash_size(const FTLMC* cache) {
+    return 1u << (32 - cache->hash_shift);
 }
 
 #if MC_DEBUG
@@ -57,7 +65,7 @@ static void check_cache(FTLMC* cache, ui32 mpn) {
 
         // Check if entry is used.
         if (entry->mpn != (ui32)-1) {
-            if (entry->hash_head != &cache->hash_tbl[hash(entry->mpn, cache->num_mpgs)]) {
+            if (entry->hash_head != &cache->hash_tbl[hash(cache, entry->mpn)]) {
                 printf("\nFTL MAP CACHE: mpn = %u hash_head != hash()\n", mpn);
                 exit(-1);
             }
@@ -84,10 +92,9 @@ static void check_cache(FTLMC* cache, ui32 mpn) {
 //     Returns: RAM usage in bytes
 //
 ui32 ftlmcRAM(const FTLMC* cache) {
-    return cache
-               ? sizeof(FTLMC) +
-                     cache->num_mpgs * (sizeof(ftlmcEntry) + cache->mpg_sz + sizeof(ftlmcEntry*))
-               : 0;
+    return cache ? sizeof(FTLMC) + cache->num_mpgs * (sizeof(ftlmcEntry) + cache->mpg_sz) +
+                       hash_size(cache) * sizeof(ftlmcEntry*)
+                 : 0;
 }
 
 //    ftlmcNew: Create a new instance of an FTL map pages cache
@@ -118,13 +125,18 @@ FTLMC* ftlmcNew(void* ftl, ui32 num_mpgs, ftlmcFuncW wf, ftlmcFuncR rf, ui32 mpg
     cache->num_mpgs = num_mpgs;
     cache->mpg_sz = mpg_sz;
 
+    // Size the hash table to the smallest power of two (at least 2) that
+    // holds all pages.
+    for (cache->hash_shift = 31; hash_size(cache) < num_mpgs; --cache->hash_shift)
+        ;
+
     // Allocate memory for entries and hash table. Return NULL if unable.
     cache->entry = FsCalloc(num_mpgs, sizeof(ftlmcEntry));
     if (cache->entry == NULL) {
         FsFree(cache);
         return NULL;
     }
-    cache->hash_tbl = FsCalloc(num_mpgs, sizeof(ftlmcEntry*));
+    cache->hash_tbl = FsCalloc(hash_size(cache), sizeof(ftlmcEntry*));
     if (cache->hash_tbl == NULL) {
         FsFree(cache->entry);
         FsFree(cache);
@@ -169,11 +181,14 @@ void ftlmcInit(FTLMC* cache) {
         // Append entry to cache's least recently used list.
         CIRC_LIST_APPEND(&cache->entry[i].lru_link, &cache->lru_list);
 
-        // Initialize the entry hash table pointers.
+        // Initialize the entry hash table pointer.
         cache->entry[i].hash_head = NULL;
-        cache->hash_tbl[i] = NULL;
     }
 
+    // Empty the hash table.
+    for (i = 0; i < hash_size(cache); ++i)
+        cache->hash_tbl[i] = NULL;
+
     // There are no dirty entries at this point.
     cache->num_dirty = 0;
 } //lint !e429
@@ -214,7 +229,7 @@ void* ftlmcGetPage(FTLMC* cache, ui32 mpn, int* new_ptr) {
 #endif
 
     // Find page's hash table entry.
-    entry = cache->hash_tbl[hash(mpn, cache->num_mpgs)];
+    entry = cache->hash_tbl[hash(cache, mpn)];
 
     // Search hash entry for matching page number.
     for (; entry; entry = entry->next_hash) {
@@ -300,7 +315,7 @@ void* ftlmcGetPage(FTLMC* cache, ui32 mpn, int* new_ptr) {
     entry->mpn = mpn;
 
     // Determine location in hash table for page.
-    hash_ndx = hash(mpn, cache->num_mpgs);
+    hash_ndx = hash(cache, mpn);
 
     // Add new entry into the hash table.
     entry->prev_hash = NULL;
@@ -399,7 +414,7 @@ ui32* ftlmcInCache(FTLMC* cache, ui32 mpn) {
 #endif
 
     // Find page's hash table entry.
-    entry = cache->hash_tbl[hash(mpn, cache->num_mpgs)];
+    entry = cache->hash_tbl[hash(cache, mpn)];
 
     // Search hash entry for matching page number.
     for (; entry; entry = entry->next_hash) {
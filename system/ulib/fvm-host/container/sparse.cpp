@@ -3,12 +3,26 @@
 // found in the LICENSE file.
 
 #include <inttypes.h>
+#include <lz4/lz4.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "fvm-host/container.h"
 
 constexpr size_t kLz4HeaderSize = 15;
 
+// Size of each independently compressed block. Must match the block size in |lz4_prefs|.
+constexpr size_t kLz4BlockSize = 64 * 1024;
+// Each block is prefixed by a little-endian length; the high bit marks uncompressed blocks.
+constexpr size_t kLz4BlockHeaderSize = sizeof(uint32_t);
+constexpr uint32_t kLz4BlockUncompressed = 0x80000000U;
+// Number of blocks buffered per compression thread before a batch is compressed.
+constexpr size_t kBlocksPerThread = 16;
+
 static LZ4F_preferences_t lz4_prefs = {
     .frameInfo = {
         .blockSizeID = LZ4F_max64KB,
@@ -17,7 +31,48 @@ static LZ4F_preferences_t lz4_prefs = {
     .compressionLevel = 0,
 };
 
+namespace {
+
+void WriteLE32(uint8_t* dst, uint32_t value) {
+    dst[0] = static_cast<uint8_t>(value);
+    dst[1] = static_cast<uint8_t>(value >> 8);
+    dst[2] = static_cast<uint8_t>(value >> 16);
+    dst[3] = static_cast<uint8_t>(value >> 24);
+}
+
+// Compresses |src_len| bytes of |src| as one LZ4 frame block, header included, into |dst|, which
+// must have room for |kLz4BlockHeaderSize + src_len| bytes. Blocks which do not shrink are stored
+// uncompressed, as LZ4F does. Returns the number of bytes written.
+size_t CompressBlock(const uint8_t* src, size_t src_len, uint8_t* dst) {
+    int r = LZ4_compress_default(reinterpret_cast<const char*>(src),
+                                 reinterpret_cast<char*>(dst + kLz4BlockHeaderSize),
+                                 static_cast<int>(src_len), static_cast<int>(src_len - 1));
+    if (r <= 0) {
+        memcpy(dst + kLz4BlockHeaderSize, src, src_len);
+        WriteLE32(dst, static_cast<uint32_t>(src_len) | kLz4BlockUncompressed);
+        return kLz4BlockHeaderSize + src_len;
+    }
+
+    WriteLE32(dst, static_cast<uint32_t>(r));
+    return kLz4BlockHeaderSize + r;
+}
+
+} // namespace
+
 zx_status_t CompressionContext::Setup(size_t max_len) {
+    if (thread_count_ == 0) {
+        thread_count_ = std::thread::hardware_concurrency();
+        if (!thread_count_) {
+            thread_count_ = 4;
+        }
+    }
+
+    size_t batch_blocks = thread_count_ * kBlocksPerThread;
+    pending_size_ = batch_blocks * kLz4BlockSize;
+    pending_length_ = 0;
+    pending_.reset(new uint8_t[pending_size_]);
+    scratch_.reset(new uint8_t[batch_blocks * (kLz4BlockHeaderSize + kLz4BlockSize)]);
+
     LZ4F_errorCode_t errc = LZ4F_createCompressionContext(&cctx_, LZ4F_VERSION);
     if (LZ4F_isError(errc)) {
         fprintf(stderr, "Could not create compression context: %s\n", LZ4F_getErrorName(errc));
@@ -37,17 +92,78 @@ zx_status_t CompressionContext::Setup(size_t max_len) {
 }
 
 zx_status_t CompressionContext::Compress(const void* data, size_t length) {
-    size_t r = LZ4F_compressUpdate(cctx_, GetBuffer(), GetRemaining(), data, length, NULL);
-    if (LZ4F_isError(r)) {
-        fprintf(stderr, "Could not compress data: %s\n", LZ4F_getErrorName(r));
-        return ZX_ERR_INTERNAL;
+    const uint8_t* src = static_cast<const uint8_t*>(data);
+    while (length > 0) {
+        size_t copy = std::min(length, pending_size_ - pending_length_);
+        memcpy(pending_.get() + pending_length_, src, copy);
+        pending_length_ += copy;
+        src += copy;
+        length -= copy;
+
+        if (pending_length_ == pending_size_) {
+            zx_status_t status;
+            if ((status = CompressPending()) != ZX_OK) {
+                return status;
+            }
+        }
+    }
+
+    return ZX_OK;
+}
+
+zx_status_t CompressionContext::CompressPending() {
+    size_t block_count = (pending_length_ + kLz4BlockSize - 1) / kLz4BlockSize;
+    if (block_count == 0) {
+        return ZX_OK;
+    }
+
+    // Blocks are independent, so each may be compressed into its own slot on any thread. The
+    // slots are then appended to the output in order.
+    constexpr size_t kSlotSize = kLz4BlockHeaderSize + kLz4BlockSize;
+    std::vector<size_t> lengths(block_count);
+    std::atomic<size_t> next_block(0);
+    auto compress_blocks = [&]() {
+        size_t i;
+        while ((i = next_block.fetch_add(1)) < block_count) {
+            size_t start = i * kLz4BlockSize;
+            size_t len = std::min(kLz4BlockSize, pending_length_ - start);
+            lengths[i] = CompressBlock(pending_.get() + start, len,
+                                       scratch_.get() + i * kSlotSize);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    size_t n_threads = std::min<size_t>(thread_count_, block_count);
+    for (size_t j = 1; j < n_threads; j++) {
+        threads.push_back(std::thread(compress_blocks));
+    }
+    compress_blocks();
+    for (unsigned j = 0; j < threads.size(); j++) {
+        threads[j].join();
+    }
+    pending_length_ = 0;
+
+    for (size_t i = 0; i < block_count; i++) {
+        if (lengths[i] > GetRemaining()) {
+            fprintf(stderr, "Could not compress data: output buffer too small\n");
+            return ZX_ERR_INTERNAL;
+        }
+        memcpy(GetBuffer(), scratch_.get() + i * kSlotSize, lengths[i]);
+        IncreaseOffset(lengths[i]);
     }
 
-    IncreaseOffset(r);
     return ZX_OK;
 }
 
 zx_status_t CompressionContext::Finish() {
+    zx_status_t status;
+    if ((status = CompressPending()) != ZX_OK) {
+        return status;
+    }
+    pending_.reset();
+    scratch_.reset();
+
+    // No data has been passed through |cctx_|, so this only emits the frame's end mark.
     size_t r = LZ4F_compressEnd(cctx_, GetBuffer(), GetRemaining(), NULL);
     if (LZ4F_isError(r)) {
         fprintf(stderr, "Could not finish compression: %s\n", LZ4F_getErrorName(r));
@@ -377,6 +493,10 @@ zx_status_t SparseContainer::Pave(const char* path, size_t disk_offset, size_t d
     return paver->Commit();
 }
 
+void SparseContainer::SetCompressionThreads(unsigned count) {
+    compression_.SetThreadCount(count);
+}
+
 size_t SparseContainer::SliceSize() const {
     return image_.slice_size;
 }
@@ -114,10 +114,18 @@ private:
     zx_status_t WriteData(uint32_t pslice, uint32_t block_offset, size_t block_size, void* data);
 };
 
+// Compresses data into a single LZ4 frame made up of independent blocks. Incoming data is
+// buffered into batches, and the blocks of each batch are compressed in parallel and appended to
+// the output in order, so the result is a regular LZ4 frame readable by fvm::SparseReader.
 class CompressionContext {
 public:
     CompressionContext() {}
     ~CompressionContext() {}
+
+    // Sets the number of threads used to compress each batch of blocks. If |count| is 0 (the
+    // default), one thread per available core is used. Must be called before Setup.
+    void SetThreadCount(unsigned count) { thread_count_ = count; }
+
     zx_status_t Setup(size_t max_len);
     zx_status_t Compress(const void* data, size_t length);
     zx_status_t Finish();
@@ -145,10 +153,22 @@ private:
         offset_ = 0;
     }
 
+    // Compresses all data currently held in |pending_| and appends the resulting blocks to the
+    // output buffer.
+    zx_status_t CompressPending();
+
     LZ4F_compressionContext_t cctx_;
     fbl::unique_ptr<uint8_t[]> data_;
     size_t size_ = 0;
     size_t offset_ = 0;
+
+    unsigned thread_count_ = 0;
+    // Uncompressed data waiting to be compressed as one batch of blocks.
+    fbl::unique_ptr<uint8_t[]> pending_;
+    size_t pending_size_ = 0;
+    size_t pending_length_ = 0;
+    // Per-block output slots for the batch currently being compressed.
+    fbl::unique_ptr<uint8_t[]> scratch_;
 };
 
 class SparseContainer final : public Container {
@@ -161,6 +181,10 @@ public:
     zx_status_t Verify() const final;
     zx_status_t Commit() final;
 
+    // Sets the number of threads used to compress partition data when the container is
+    // committed with LZ4 compression enabled. If |count| is 0, one thread per core is used.
+    void SetCompressionThreads(unsigned count);
+
     // Unpacks the sparse container and "paves" it to |path|.
     zx_status_t Pave(const char* path, size_t disk_offset = 0, size_t disk_size = 0);
     size_t SliceSize() const final;
@@ -2,7 +2,9 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <fbl/algorithm.h>
 #include <lib/inspect/heap.h>
+#include <zircon/limits.h>
 
 namespace inspect {
 namespace internal {
@@ -29,6 +31,20 @@ Heap::~Heap() {
                         num_allocated_blocks_);
 }
 
+fbl::unique_ptr<fzl::ResizeableVmoMapper> Heap::CreateVmo(size_t size, size_t max_size,
+                                                          const char* name) {
+    auto vmar = fzl::VmarManager::Create(
+        fbl::round_up<size_t>(fbl::max(size, max_size), ZX_PAGE_SIZE), nullptr,
+        ZX_VM_CAN_MAP_READ | ZX_VM_CAN_MAP_WRITE | ZX_VM_CAN_MAP_SPECIFIC);
+    if (!vmar) {
+        return nullptr;
+    }
+    // Mapping at offset 0 of the VMAR leaves the rest of it free for Grow to
+    // extend into.
+    return fzl::ResizeableVmoMapper::Create(
+        size, name, ZX_VM_PERM_READ | ZX_VM_PERM_WRITE | ZX_VM_SPECIFIC, std::move(vmar));
+}
+
 zx::vmo Heap::ReadOnlyClone() const {
     zx::vmo ret;
     // BASIC rights include the ability to duplicate, transfer, and wait
@@ -28,6 +28,17 @@ public:
     Heap(fbl::unique_ptr<fzl::ResizeableVmoMapper> vmo, size_t max_size = kDefaultMaxSize);
     ~Heap();
 
+    // Create a VMO of |size| bytes for a heap of at most |max_size| bytes.
+    //
+    // The VMO is mapped at the start of a VMAR reserved for |max_size| bytes,
+    // so growing the heap always extends the mapping in place and pointers to
+    // blocks stay valid. A VMO mapped any other way may be moved when the heap
+    // grows.
+    //
+    // Returns nullptr on failure.
+    static fbl::unique_ptr<fzl::ResizeableVmoMapper> CreateVmo(size_t size, size_t max_size,
+                                                               const char* name);
+
     zx::vmo ReadOnlyClone() const;
 
     // Allocate a |BlockIndex| out of the heap that can contain at least |min_size| bytes.
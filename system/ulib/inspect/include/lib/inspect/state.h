@@ -23,6 +23,10 @@ class State final : public fbl::RefCounted<State> {
 public:
     // Create a new State wrapping the given Heap.
     // On failure, returns nullptr.
+    //
+    // Metrics may be updated while other threads create and free values only
+    // if the heap's VMO was created by |Heap::CreateVmo|, so that the heap
+    // never moves its blocks.
     static fbl::RefPtr<State> Create(fbl::unique_ptr<Heap> heap);
     ~State();
 
@@ -57,6 +61,12 @@ public:
     // entities using the Object are destroyed.
     Object CreateObject(fbl::StringPiece name, BlockIndex parent);
 
+    // Numeric metrics are updated in place by a single atomic operation on
+    // their value, without taking the state's lock or changing the generation
+    // count. Their blocks can't be freed until the metric is, and a reader
+    // copying the VMO sees either the old or the new value, so snapshots stay
+    // consistent; they just aren't of every metric's value at one instant.
+
     // Setters for various metric types
     void SetIntMetric(IntMetric* metric, int64_t value);
     void SetUintMetric(UintMetric* metric, uint64_t value);
@@ -108,6 +118,13 @@ private:
     // Helper to create a new name block with the given name.
     zx_status_t CreateName(fbl::StringPiece name, BlockIndex* out) __TA_REQUIRES(mutex_);
 
+    // Get the block of a numeric metric, without the mutex.
+    // This is safe because the heap's mapping never moves, and the block
+    // stays allocated until the metric is freed.
+    Block* GetMetricBlock(BlockIndex index) const __TA_NO_THREAD_SAFETY_ANALYSIS {
+        return heap_->GetBlock(index);
+    }
+
     // Mutex wrapping all fields in the state.
     mutable fbl::Mutex mutex_;
 
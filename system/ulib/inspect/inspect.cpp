@@ -20,7 +20,7 @@ Inspector::Inspector()
 
 Inspector::Inspector(size_t capacity, size_t max_size) {
     fbl::unique_ptr<fzl::ResizeableVmoMapper> vmo =
-        fzl::ResizeableVmoMapper::Create(capacity, kVmoName);
+        Heap::CreateVmo(capacity, max_size, kVmoName);
     if (!vmo) {
         return;
     }
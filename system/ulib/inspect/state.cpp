@@ -2,6 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <string.h>
+
 #include <fbl/alloc_checker.h>
 #include <fbl/auto_lock.h>
 #include <lib/inspect/state.h>
@@ -43,6 +45,22 @@ private:
     DISALLOW_COPY_ASSIGN_AND_MOVE(AutoGenerationIncrement);
 };
 
+// Atomically apply |op| to the double stored in |block|'s payload.
+template <typename Op>
+void UpdateDouble(Block* block, Op op) {
+    uint64_t* ptr = &block->payload.u64;
+    uint64_t expected = __atomic_load_n(ptr, fbl::memory_order_relaxed);
+    uint64_t desired;
+    do {
+        double value;
+        memcpy(&value, &expected, sizeof(value));
+        value = op(value);
+        memcpy(&desired, &value, sizeof(desired));
+    } while (!__atomic_compare_exchange_n(ptr, &expected, desired, true,
+                                          fbl::memory_order_relaxed,
+                                          fbl::memory_order_relaxed));
+}
+
 } // namespace
 
 fbl::RefPtr<State> State::Create(fbl::unique_ptr<Heap> heap) {
@@ -167,109 +185,85 @@ Object State::CreateObject(fbl::StringPiece name, BlockIndex parent) {
 
 void State::SetIntMetric(IntMetric* metric, int64_t value) {
     ZX_ASSERT(metric->state_.get() == this);
-    fbl::AutoLock lock(&mutex_);
-    auto gen = AutoGenerationIncrement(header_, heap_.get());
 
-    auto* block = heap_->GetBlock(metric->value_index_);
+    auto* block = GetMetricBlock(metric->value_index_);
     ZX_DEBUG_ASSERT_MSG(GetType(block) == BlockType::kIntValue, "Expected int metric, got %d",
                         static_cast<int>(GetType(block)));
-    block->payload.i64 = value;
+    __atomic_store_n(&block->payload.i64, value, fbl::memory_order_relaxed);
 }
 
 void State::SetUintMetric(UintMetric* metric, uint64_t value) {
     ZX_ASSERT(metric->state_.get() == this);
 
-    fbl::AutoLock lock(&mutex_);
-    auto gen = AutoGenerationIncrement(header_, heap_.get());
-
-    auto* block = heap_->GetBlock(metric->value_index_);
+    auto* block = GetMetricBlock(metric->value_index_);
     ZX_DEBUG_ASSERT_MSG(GetType(block) == BlockType::kUintValue, "Expected uint metric, got %d",
                         static_cast<int>(GetType(block)));
-    block->payload.u64 = value;
+    __atomic_store_n(&block->payload.u64, value, fbl::memory_order_relaxed);
 }
 
 void State::SetDoubleMetric(DoubleMetric* metric, double value) {
     ZX_ASSERT(metric->state_.get() == this);
 
-    fbl::AutoLock lock(&mutex_);
-    auto gen = AutoGenerationIncrement(header_, heap_.get());
-
-    auto* block = heap_->GetBlock(metric->value_index_);
+    auto* block = GetMetricBlock(metric->value_index_);
     ZX_DEBUG_ASSERT_MSG(GetType(block) == BlockType::kDoubleValue, "Expected double metric, got %d",
                         static_cast<int>(GetType(block)));
-    block->payload.f64 = value;
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    __atomic_store_n(&block->payload.u64, bits, fbl::memory_order_relaxed);
 }
 
 void State::AddIntMetric(IntMetric* metric, int64_t value) {
     ZX_ASSERT(metric->state_.get() == this);
 
-    fbl::AutoLock lock(&mutex_);
-    auto gen = AutoGenerationIncrement(header_, heap_.get());
-
-    auto* block = heap_->GetBlock(metric->value_index_);
+    auto* block = GetMetricBlock(metric->value_index_);
     ZX_DEBUG_ASSERT_MSG(GetType(block) == BlockType::kIntValue, "Expected int metric, got %d",
                         static_cast<int>(GetType(block)));
-    block->payload.i64 += value;
+    __atomic_fetch_add(&block->payload.i64, value, fbl::memory_order_relaxed);
 }
 
 void State::AddUintMetric(UintMetric* metric, uint64_t value) {
     ZX_ASSERT(metric->state_.get() == this);
 
-    fbl::AutoLock lock(&mutex_);
-    auto gen = AutoGenerationIncrement(header_, heap_.get());
-
-    auto* block = heap_->GetBlock(metric->value_index_);
+    auto* block = GetMetricBlock(metric->value_index_);
     ZX_DEBUG_ASSERT_MSG(GetType(block) == BlockType::kUintValue, "Expected uint metric, got %d",
                         static_cast<int>(GetType(block)));
-    block->payload.u64 += value;
+    __atomic_fetch_add(&block->payload.u64, value, fbl::memory_order_relaxed);
 }
 
 void State::AddDoubleMetric(DoubleMetric* metric, double value) {
     ZX_ASSERT(metric->state_.get() == this);
 
-    fbl::AutoLock lock(&mutex_);
-    auto gen = AutoGenerationIncrement(header_, heap_.get());
-
-    auto* block = heap_->GetBlock(metric->value_index_);
+    auto* block = GetMetricBlock(metric->value_index_);
     ZX_DEBUG_ASSERT_MSG(GetType(block) == BlockType::kDoubleValue, "Expected double metric, got %d",
                         static_cast<int>(GetType(block)));
-    block->payload.f64 += value;
+    UpdateDouble(block, [value](double current) { return current + value; });
 }
 
 void State::SubtractIntMetric(IntMetric* metric, int64_t value) {
     ZX_ASSERT(metric->state_.get() == this);
 
-    fbl::AutoLock lock(&mutex_);
-    auto gen = AutoGenerationIncrement(header_, heap_.get());
-
-    auto* block = heap_->GetBlock(metric->value_index_);
+    auto* block = GetMetricBlock(metric->value_index_);
     ZX_DEBUG_ASSERT_MSG(GetType(block) == BlockType::kIntValue, "Expected int metric, got %d",
                         static_cast<int>(GetType(block)));
-    block->payload.i64 -= value;
+    __atomic_fetch_sub(&block->payload.i64, value, fbl::memory_order_relaxed);
 }
 
 void State::SubtractUintMetric(UintMetric* metric, uint64_t value) {
     ZX_ASSERT(metric->state_.get() == this);
 
-    fbl::AutoLock lock(&mutex_);
-    auto gen = AutoGenerationIncrement(header_, heap_.get());
-
-    auto* block = heap_->GetBlock(metric->value_index_);
+    auto* block = GetMetricBlock(metric->value_index_);
     ZX_DEBUG_ASSERT_MSG(GetType(block) == BlockType::kUintValue, "Expected uint metric, got %d",
                         static_cast<int>(GetType(block)));
-    block->payload.u64 -= value;
+    __atomic_fetch_sub(&block->payload.u64, value, fbl::memory_order_relaxed);
 }
 
 void State::SubtractDoubleMetric(DoubleMetric* metric, double value) {
     ZX_ASSERT(metric->state_.get() == this);
 
-    fbl::AutoLock lock(&mutex_);
-    auto gen = AutoGenerationIncrement(header_, heap_.get());
-
-    auto* block = heap_->GetBlock(metric->value_index_);
+    auto* block = GetMetricBlock(metric->value_index_);
     ZX_DEBUG_ASSERT_MSG(GetType(block) == BlockType::kDoubleValue, "Expected double metric, got %d",
                         static_cast<int>(GetType(block)));
-    block->payload.f64 -= value;
+    UpdateDouble(block, [value](double current) { return current - value; });
 }
 
 void State::SetProperty(Property* property, fbl::StringPiece value) {
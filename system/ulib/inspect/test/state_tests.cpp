@@ -143,7 +143,8 @@ bool CreateIntMetric() {
     EXPECT_EQ(7, allocated_blocks);
     EXPECT_EQ(6, free_blocks);
 
-    EXPECT_TRUE(CompareBlock(blocks.find(0)->block, MakeHeader(12)));
+    // Only creating the metrics changes the generation count.
+    EXPECT_TRUE(CompareBlock(blocks.find(0)->block, MakeHeader(6)));
     EXPECT_TRUE(CompareBlock(blocks.find(1)->block,
                              MakeIntBlock(ValueBlockFields::Type::Make(BlockType::kIntValue) |
                                               ValueBlockFields::NameIndex::Make(2),
@@ -198,7 +199,8 @@ bool CreateUintMetric() {
     EXPECT_EQ(7, allocated_blocks);
     EXPECT_EQ(6, free_blocks);
 
-    EXPECT_TRUE(CompareBlock(blocks.find(0)->block, MakeHeader(12)));
+    // Only creating the metrics changes the generation count.
+    EXPECT_TRUE(CompareBlock(blocks.find(0)->block, MakeHeader(6)));
     EXPECT_TRUE(CompareBlock(blocks.find(1)->block,
                              MakeBlock(ValueBlockFields::Type::Make(BlockType::kUintValue) |
                                            ValueBlockFields::NameIndex::Make(2),
@@ -253,7 +255,8 @@ bool CreateDoubleMetric() {
     EXPECT_EQ(7, allocated_blocks);
     EXPECT_EQ(6, free_blocks);
 
-    EXPECT_TRUE(CompareBlock(blocks.find(0)->block, MakeHeader(12)));
+    // Only creating the metrics changes the generation count.
+    EXPECT_TRUE(CompareBlock(blocks.find(0)->block, MakeHeader(6)));
     EXPECT_TRUE(CompareBlock(blocks.find(1)->block,
                              MakeDoubleBlock(ValueBlockFields::Type::Make(BlockType::kDoubleValue) |
                                                  ValueBlockFields::NameIndex::Make(2),
@@ -806,6 +809,7 @@ bool TombstoneCleanup() {
 }
 
 constexpr size_t kThreadTimes = 1024 * 10;
+constexpr size_t kMaxHeapSize = 256 * 1024;
 
 struct ThreadArgs {
     IntMetric* metric;
@@ -838,9 +842,10 @@ int ChildThread(void* input) {
 bool MultithreadingTest() {
     BEGIN_TEST;
 
-    auto vmo = fzl::ResizeableVmoMapper::Create(4096, "test");
+    // The metric is updated while the heap grows, so the heap must not move.
+    auto vmo = Heap::CreateVmo(4096, kMaxHeapSize, "test");
     ASSERT_TRUE(vmo != nullptr);
-    auto heap = fbl::make_unique<Heap>(std::move(vmo));
+    auto heap = fbl::make_unique<Heap>(std::move(vmo), kMaxHeapSize);
     auto state = State::Create(std::move(heap));
 
     size_t per_thread_times_operation_count = 0;
@@ -862,10 +867,8 @@ bool MultithreadingTest() {
         other_operation_count += 2; // create and delete
         Object child2 = child1.CreateChild("child2");
 
-        per_thread_times_operation_count += 1; // add metric
+        // Metric updates don't change the generation count.
         thrd_create(&add_thread, ValueThread, &adder);
-
-        per_thread_times_operation_count += 1; // subtract metric
         thrd_create(&subtract_thread, ValueThread, &subtractor);
 
         per_thread_times_operation_count += 4; // create child, create temp, delete both
@@ -921,6 +924,69 @@ bool MultithreadingTest() {
     END_TEST;
 }
 
+struct MetricThreadArgs {
+    UintMetric* uint_metric;
+    DoubleMetric* double_metric;
+};
+
+int MetricThread(void* input) {
+    auto* args = reinterpret_cast<MetricThreadArgs*>(input);
+    for (size_t i = 0; i < kThreadTimes; i++) {
+        args->uint_metric->Add(2);
+        args->uint_metric->Subtract(1);
+        args->double_metric->Add(1.0);
+    }
+    return 0;
+}
+
+bool ConcurrentMetricUpdates() {
+    BEGIN_TEST;
+
+    auto vmo = Heap::CreateVmo(4096, kMaxHeapSize, "test");
+    ASSERT_TRUE(vmo != nullptr);
+    auto heap = fbl::make_unique<Heap>(std::move(vmo), kMaxHeapSize);
+    auto state = State::Create(std::move(heap));
+
+    UintMetric uint_metric = state->CreateUintMetric("a", 0, 0);
+    DoubleMetric double_metric = state->CreateDoubleMetric("b", 0, 0);
+
+    constexpr size_t kNumThreads = 4;
+    MetricThreadArgs args{.uint_metric = &uint_metric, .double_metric = &double_metric};
+    thrd_t threads[kNumThreads];
+    for (auto& thread : threads) {
+        ASSERT_EQ(thrd_success, thrd_create(&thread, MetricThread, &args));
+    }
+    // Updates don't change the generation count, so snapshots taken meanwhile
+    // always succeed.
+    for (size_t i = 0; i < 100; i++) {
+        Snapshot snapshot;
+        EXPECT_EQ(ZX_OK, Snapshot::Create(state->GetReadOnlyVmoClone(),
+                                          {.read_attempts = 1, .skip_consistency_check = false},
+                                          &snapshot));
+    }
+    for (auto& thread : threads) {
+        thrd_join(thread, nullptr);
+    }
+
+    fbl::WAVLTree<BlockIndex, fbl::unique_ptr<ScannedBlock>> blocks;
+    size_t free_blocks, allocated_blocks;
+    auto snapshot =
+        SnapshotAndScan(state->GetReadOnlyVmoClone(), &blocks, &free_blocks, &allocated_blocks);
+    ASSERT_TRUE(snapshot);
+
+    EXPECT_TRUE(CompareBlock(blocks.find(0)->block, MakeHeader(4)));
+    EXPECT_TRUE(CompareBlock(blocks.find(1)->block,
+                             MakeBlock(ValueBlockFields::Type::Make(BlockType::kUintValue) |
+                                           ValueBlockFields::NameIndex::Make(2),
+                                       kNumThreads * kThreadTimes)));
+    EXPECT_TRUE(CompareBlock(blocks.find(3)->block,
+                             MakeDoubleBlock(ValueBlockFields::Type::Make(BlockType::kDoubleValue) |
+                                                 ValueBlockFields::NameIndex::Make(4),
+                                             kNumThreads * kThreadTimes)));
+
+    END_TEST;
+}
+
 } // namespace
 
 BEGIN_TEST_CASE(StateTests)
@@ -937,4 +1003,5 @@ RUN_TEST(CreateObjectHierarchy)
 RUN_TEST(TombstoneTest)
 RUN_TEST(TombstoneCleanup)
 RUN_TEST(MultithreadingTest)
+RUN_TEST(ConcurrentMetricUpdates)
 END_TEST_CASE(StateTests)
@@ -186,6 +186,49 @@ zx_status_t launchpad_load_from_fd(launchpad_t* lp, int fd);
 zx_status_t launchpad_load_from_vmo(launchpad_t* lp, zx_handle_t vmo);
 
 
+// LOADING FROM A TEMPLATE
+// A template is a cache of parsed images, not a snapshot of a process: it
+// holds the ELF headers of a binary, its PT_INTERP file (looked up once,
+// via the loader service) and the vDSO, and their VMOs.  Launching many
+// processes from one template skips reading and parsing them each time.
+// Everything else is done again for each process: its randomly-placed
+// mappings, stack and bootstrap message, and the relocation and startup
+// work of the dynamic linker and libc, which run in the new process.
+// -------------------------------------------------------------------
+
+typedef struct launchpad_template launchpad_template_t;
+
+// Create a template for the ELF binary in vmo, which is consumed.  If the
+// binary has a PT_INTERP, it is looked up using loader_svc, which is not
+// consumed, or using the default loader service if loader_svc is
+// ZX_HANDLE_INVALID.  A binary without a PT_INTERP needs no loader service.
+// The template keeps both VMOs without ZX_RIGHT_WRITE, so processes
+// launched from it can't modify them.  #! scripts are not supported.
+zx_status_t launchpad_template_create(zx_handle_t vmo, zx_handle_t loader_svc,
+                                      launchpad_template_t** out);
+
+// Create a template as launchpad_template_create does, but never using the
+// default loader service: if the binary has a PT_INTERP and loader_svc is
+// ZX_HANDLE_INVALID, this fails with ZX_ERR_INVALID_ARGS.  This is for
+// callers making templates on behalf of another process.
+zx_status_t launchpad_template_create_with_loader(zx_handle_t vmo,
+                                                  zx_handle_t loader_svc,
+                                                  launchpad_template_t** out);
+
+// Returns true if the binary held by a template has a PT_INTERP, so that
+// processes launched from it need a loader service.
+bool launchpad_template_has_interp(const launchpad_template_t* tmpl);
+
+// Destroy a template.  Processes launched from it are not affected.
+void launchpad_template_destroy(launchpad_template_t* tmpl);
+
+// Load the binary held by a template, and the vDSO, as
+// launchpad_load_from_vmo would.  The template is not modified, so it may
+// be used by several launchpads at once.
+zx_status_t launchpad_load_from_template(launchpad_t* lp,
+                                         launchpad_template_t* tmpl);
+
+
 // ADDING ARGUMENTS, ENVIRONMENT, AND HANDLES
 // These functions setup arguments, environment, or handles to be
 // passed to the new process via the processargs protocol.
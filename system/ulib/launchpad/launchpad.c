@@ -513,6 +513,20 @@ static zx_status_t reserve_low_address_space(launchpad_t* lp) {
     return ZX_OK;
 }
 
+// Once the PT_INTERP file has been mapped, the executable's VMO and the
+// VMAR holding the interpreter's segments are passed to the dynamic linker
+// in the loader message.  Consumes both handles.
+static void set_interp_loaded(launchpad_t* lp, zx_handle_t exec_vmo,
+                              zx_handle_t segments_vmar) {
+    if (lp->special_handles[HND_EXEC_VMO] != ZX_HANDLE_INVALID)
+        zx_handle_close(lp->special_handles[HND_EXEC_VMO]);
+    lp->special_handles[HND_EXEC_VMO] = exec_vmo;
+    if (lp->special_handles[HND_SEGMENTS_VMAR] != ZX_HANDLE_INVALID)
+        zx_handle_close(lp->special_handles[HND_SEGMENTS_VMAR]);
+    lp->special_handles[HND_SEGMENTS_VMAR] = segments_vmar;
+    lp->loader_message = true;
+}
+
 // Consumes 'vmo' on success, not on failure.
 static zx_status_t handle_interp(launchpad_t* lp, zx_handle_t vmo,
                                  const char* interp, size_t interp_len) {
@@ -546,15 +560,8 @@ static zx_status_t handle_interp(launchpad_t* lp, zx_handle_t vmo,
     }
     zx_handle_close(interp_vmo);
 
-    if (status == ZX_OK) {
-        if (lp->special_handles[HND_EXEC_VMO] != ZX_HANDLE_INVALID)
-            zx_handle_close(lp->special_handles[HND_EXEC_VMO]);
-        lp->special_handles[HND_EXEC_VMO] = vmo;
-        if (lp->special_handles[HND_SEGMENTS_VMAR] != ZX_HANDLE_INVALID)
-            zx_handle_close(lp->special_handles[HND_SEGMENTS_VMAR]);
-        lp->special_handles[HND_SEGMENTS_VMAR] = segments_vmar;
-        lp->loader_message = true;
-    }
+    if (status == ZX_OK)
+        set_interp_loaded(lp, vmo, segments_vmar);
 
     return status;
 }
@@ -1317,3 +1324,171 @@ zx_status_t launchpad_load_from_fd(launchpad_t* lp, int fd) {
 zx_status_t launchpad_load_from_vmo(launchpad_t* lp, zx_handle_t vmo) {
     return launchpad_file_load_with_vdso(lp, vmo);
 }
+
+struct launchpad_template {
+    zx_handle_t exec_vmo;
+    elf_load_info_t* exec_elf;
+    // ZX_HANDLE_INVALID if the executable has no PT_INTERP.
+    zx_handle_t interp_vmo;
+    elf_load_info_t* interp_elf;
+    zx_handle_t vdso_vmo;
+    elf_load_info_t* vdso_elf;
+};
+
+void launchpad_template_destroy(launchpad_template_t* tmpl) {
+    if (tmpl == NULL)
+        return;
+    elf_load_destroy(tmpl->exec_elf);
+    elf_load_destroy(tmpl->interp_elf);
+    elf_load_destroy(tmpl->vdso_elf);
+    zx_handle_close(tmpl->exec_vmo);
+    zx_handle_close(tmpl->interp_vmo);
+    zx_handle_close(tmpl->vdso_vmo);
+    free(tmpl);
+}
+
+// Each process launched from a template is given its own handle to the
+// template's VMOs, so they must not let one process change what the next
+// one runs.
+static zx_status_t template_drop_write(zx_handle_t* vmo) {
+    zx_info_handle_basic_t info;
+    zx_status_t status = zx_object_get_info(*vmo, ZX_INFO_HANDLE_BASIC,
+                                            &info, sizeof(info), NULL, NULL);
+    if (status != ZX_OK || !(info.rights & ZX_RIGHT_WRITE))
+        return status;
+    zx_handle_t replaced;
+    status = zx_handle_replace(*vmo, info.rights & ~ZX_RIGHT_WRITE, &replaced);
+    // The old handle is gone whether or not this succeeded.
+    *vmo = status == ZX_OK ? replaced : ZX_HANDLE_INVALID;
+    return status;
+}
+
+static zx_status_t template_load_interp(launchpad_template_t* tmpl,
+                                       zx_handle_t loader_svc,
+                                       bool use_default_loader) {
+    char* interp;
+    size_t interp_len;
+    zx_status_t status = elf_load_get_interp(tmpl->exec_elf, tmpl->exec_vmo,
+                                             &interp, &interp_len);
+    if (status != ZX_OK || interp == NULL)
+        return status;
+
+    zx_handle_t default_loader_svc = ZX_HANDLE_INVALID;
+    if (loader_svc == ZX_HANDLE_INVALID && !use_default_loader) {
+        status = ZX_ERR_INVALID_ARGS;
+    } else if (loader_svc == ZX_HANDLE_INVALID) {
+        status = dl_clone_loader_service(&default_loader_svc);
+        loader_svc = default_loader_svc;
+    }
+    if (status == ZX_OK)
+        status = loader_svc_rpc(loader_svc, LDMSG_OP_LOAD_OBJECT,
+                                interp, interp_len, &tmpl->interp_vmo);
+    zx_handle_close(default_loader_svc);
+    free(interp);
+
+    if (status == ZX_OK)
+        status = template_drop_write(&tmpl->interp_vmo);
+    if (status == ZX_OK)
+        status = elf_load_start(tmpl->interp_vmo, NULL, 0, &tmpl->interp_elf);
+    return status;
+}
+
+static zx_status_t template_create(zx_handle_t vmo, zx_handle_t loader_svc,
+                                   bool use_default_loader,
+                                   launchpad_template_t** out) {
+    if (vmo == ZX_HANDLE_INVALID)
+        return ZX_ERR_INVALID_ARGS;
+
+    launchpad_template_t* tmpl = calloc(1, sizeof(*tmpl));
+    if (tmpl == NULL) {
+        zx_handle_close(vmo);
+        return ZX_ERR_NO_MEMORY;
+    }
+    tmpl->exec_vmo = vmo;
+
+    zx_status_t status = template_drop_write(&tmpl->exec_vmo);
+    if (status == ZX_OK)
+        status = elf_load_start(tmpl->exec_vmo, NULL, 0, &tmpl->exec_elf);
+    if (status == ZX_OK)
+        status = template_load_interp(tmpl, loader_svc, use_default_loader);
+    if (status == ZX_OK)
+        status = launchpad_get_vdso_vmo(&tmpl->vdso_vmo);
+    if (status == ZX_OK)
+        status = elf_load_start(tmpl->vdso_vmo, NULL, 0, &tmpl->vdso_elf);
+
+    if (status != ZX_OK) {
+        launchpad_template_destroy(tmpl);
+        return status;
+    }
+    *out = tmpl;
+    return ZX_OK;
+}
+
+zx_status_t launchpad_template_create(zx_handle_t vmo, zx_handle_t loader_svc,
+                                      launchpad_template_t** out) {
+    return template_create(vmo, loader_svc, true, out);
+}
+
+zx_status_t launchpad_template_create_with_loader(zx_handle_t vmo,
+                                                  zx_handle_t loader_svc,
+                                                  launchpad_template_t** out) {
+    return template_create(vmo, loader_svc, false, out);
+}
+
+bool launchpad_template_has_interp(const launchpad_template_t* tmpl) {
+    return tmpl->interp_vmo != ZX_HANDLE_INVALID;
+}
+
+zx_status_t launchpad_load_from_template(launchpad_t* lp,
+                                         launchpad_template_t* tmpl) {
+    if (lp->error)
+        return lp->error;
+
+    zx_status_t status;
+    zx_handle_t segments_vmar;
+    if (tmpl->interp_vmo == ZX_HANDLE_INVALID) {
+        status = elf_load_finish(lp_vmar(lp), tmpl->exec_elf, tmpl->exec_vmo,
+                                 &segments_vmar, &lp->base, &lp->entry);
+        if (status != ZX_OK)
+            return lp_error(lp, status,
+                            "load_from_template: elf_load_finish() failed");
+        check_elf_stack_size(lp, tmpl->exec_elf);
+        lp->loader_message = false;
+        launchpad_add_handle(lp, segments_vmar, PA_HND(PA_VMAR_LOADED, 0));
+    } else {
+        // This matches what handle_interp() does, except that the
+        // PT_INTERP file was already looked up when the template was made.
+        if ((status = setup_loader_svc(lp)) != ZX_OK)
+            return lp_error(lp, status,
+                            "load_from_template: no loader service");
+        if (lp->fresh_process && reserve_low_address_space(lp) != ZX_OK)
+            return lp->error;
+        zx_handle_t exec_vmo;
+        status = zx_handle_duplicate(tmpl->exec_vmo, ZX_RIGHT_SAME_RIGHTS,
+                                     &exec_vmo);
+        if (status != ZX_OK)
+            return lp_error(lp, status,
+                            "load_from_template: cannot duplicate vmo");
+        status = elf_load_finish(lp_vmar(lp), tmpl->interp_elf,
+                                 tmpl->interp_vmo, &segments_vmar,
+                                 &lp->base, &lp->entry);
+        if (status != ZX_OK) {
+            zx_handle_close(exec_vmo);
+            return lp_error(lp, status,
+                            "load_from_template: elf_load_finish() failed");
+        }
+        set_interp_loaded(lp, exec_vmo, segments_vmar);
+    }
+
+    status = elf_load_finish(lp_vmar(lp), tmpl->vdso_elf, tmpl->vdso_vmo,
+                             NULL, &lp->vdso_base, NULL);
+    if (status != ZX_OK)
+        return lp_error(lp, status,
+                        "load_from_template: cannot map vDSO");
+    zx_handle_t vdso;
+    status = zx_handle_duplicate(tmpl->vdso_vmo, ZX_RIGHT_SAME_RIGHTS, &vdso);
+    if (status != ZX_OK)
+        return lp_error(lp, status,
+                        "load_from_template: cannot duplicate vDSO vmo");
+    return launchpad_add_handle(lp, vdso, PA_HND(PA_VMO_VDSO, 0));
+}
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <stdbool.h>
+
 #include <zircon/compiler.h>
 #include <zircon/types.h>
 
@@ -47,6 +49,25 @@ zx_status_t loader_service_create_fd(async_dispatcher_t* dispatcher,
                                      int root_dir_fd,
                                      loader_service_t** out);
 
+// Enables or disables caching of loaded objects by a loader service created
+// by |loader_service_create_fs| or |loader_service_create_fd|. Caching is
+// enabled by default.
+//
+// While enabled, the service keeps the VMOs of recently loaded objects, and
+// hands out copy-on-write clones of them rather than loading the same objects
+// again. Every client, including the one whose request loaded an object,
+// gets its own clone, and the service keeps no writable handle to the VMOs it
+// caches, so nothing a client writes is seen by another.
+//
+// Objects are only cached while the library paths can be watched for names
+// being added or removed, and the cache is flushed whenever that happens.
+// Names containing '/', including those with a configured prefix, are never
+// cached. A file rewritten in place isn't noticed, so caching should be
+// disabled if the library paths may hold mutable files.
+//
+// Returns ZX_ERR_NOT_SUPPORTED for a loader service with custom ops.
+zx_status_t loader_service_set_cache_enabled(loader_service_t* svc, bool enabled);
+
 // Returns a new dl_set_loader_service-compatible loader service channel.
 zx_status_t loader_service_connect(loader_service_t* svc, zx_handle_t* out);
 
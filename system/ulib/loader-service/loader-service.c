@@ -6,7 +6,9 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <fuchsia/io/c/fidl.h>
 #include <lib/fdio/io.h>
+#include <lib/fdio/unsafe.h>
 #include <inttypes.h>
 #include <ldmsg/ldmsg.h>
 #include <lib/async-loop/loop.h>
@@ -17,21 +19,74 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <threads.h>
 #include <unistd.h>
 #include <zircon/compiler.h>
 #include <zircon/device/vfs.h>
 #include <zircon/status.h>
 #include <zircon/syscalls.h>
+#include <zircon/time.h>
 #include <zircon/types.h>
 
 #define PREFIX_MAX 32
 
-// State of a loader service instance.
+// Number of loaded objects whose VMOs are kept by the default loader
+// service, so that launching the same programs over and over doesn't walk
+// the library paths and fetch the same libraries from the filesystem each
+// time.
+#define CACHE_ENTRIES 32
+// Names longer than this are not cached.
+#define CACHE_NAME_MAX 64
+// Objects are only cached while this many library paths, at most, are
+// watched for changes.
+#define LIB_PATHS_MAX 4
+// Minimum time between attempts to watch library paths which aren't watched,
+// such as paths which don't exist.
+#define LIB_PATH_WATCH_RETRY ZX_SEC(1)
+
 typedef struct instance_state instance_state_t;
+
+// A loaded object whose VMO is cached, keyed by the name it was loaded by.
+typedef struct cache_entry {
+    // Empty if the entry is unused.
+    char name[CACHE_NAME_MAX + 1];
+    zx_handle_t vmo;
+    // Value of |cache_clock| when the entry was last used.
+    uint64_t last_use;
+} cache_entry_t;
+
+// Watches one of the library paths for names being added or removed, which
+// may change which file a name resolves to.
+typedef struct lib_path_watch {
+    async_wait_t wait; // Must be first.
+    instance_state_t* instance_state;
+    // Index of the watched path in |lib_paths|.
+    size_t index;
+} lib_path_watch_t;
+
+// State of a loader service instance.
 struct instance_state {
   int root_dir_fd;
   // NULL-terminated list of paths from which objects will loaded.
   const char* const* lib_paths;
+
+  // Guards the fields below, which the dispatcher's threads share with the
+  // watches' handlers.
+  mtx_t cache_lock;
+  bool cache_enabled;
+  async_dispatcher_t* dispatcher;
+  // Held by the loader service and by each pending watch.
+  int refcount;
+  bool finalized;
+  // Objects are only cached while all of |lib_paths| are watched.
+  lib_path_watch_t* watches[LIB_PATHS_MAX];
+  // When the library paths which aren't watched may next be tried again.
+  zx_time_t watch_retry_time;
+  // Incremented whenever the cache is flushed, so that an object loaded
+  // while that happened isn't cached.
+  uint64_t cache_generation;
+  uint64_t cache_clock;
+  cache_entry_t cache[CACHE_ENTRIES];
 };
 
 // This represents an instance of the loader service. Each session in an
@@ -91,15 +146,302 @@ static zx_handle_t vmo_from_fd(int fd, const char* fn, zx_handle_t* out) {
     return status;
 }
 
+// Drops all cached objects.
+static void cache_flush_locked(instance_state_t* instance_state) {
+    for (size_t i = 0; i < CACHE_ENTRIES; ++i) {
+        cache_entry_t* entry = &instance_state->cache[i];
+        if (entry->name[0] != '\0') {
+            zx_handle_close(entry->vmo);
+            entry->name[0] = '\0';
+        }
+    }
+    instance_state->cache_generation++;
+}
+
+// Drops a reference to |instance_state|, freeing it along with the last one.
+// Called without |cache_lock| held.
+static void instance_state_deref(instance_state_t* instance_state) {
+    mtx_lock(&instance_state->cache_lock);
+    bool last = --instance_state->refcount == 0;
+    mtx_unlock(&instance_state->cache_lock);
+    if (last) {
+        cache_flush_locked(instance_state);
+        mtx_destroy(&instance_state->cache_lock);
+        free(instance_state);
+    }
+}
+
+// Stops watching a library path. The caller takes over the watch's
+// reference to the instance state.
+static void lib_path_watch_destroy_locked(lib_path_watch_t* watch) {
+    watch->instance_state->watches[watch->index] = NULL;
+    // Try to watch the path again straight away.
+    watch->instance_state->watch_retry_time = 0;
+    zx_handle_close(watch->wait.object);
+    free(watch);
+}
+
+static void lib_path_watch_handler(async_dispatcher_t* dispatcher,
+                                   async_wait_t* wait,
+                                   zx_status_t status,
+                                   const zx_packet_signal_t* signal) {
+    lib_path_watch_t* watch = (lib_path_watch_t*)wait;
+    instance_state_t* instance_state = watch->instance_state;
+    mtx_lock(&instance_state->cache_lock);
+    // Any event means a name in the path was added or removed. Rather than
+    // working out which cached objects that affects, drop them all.
+    cache_flush_locked(instance_state);
+    if (status == ZX_OK && !instance_state->finalized &&
+        (signal->observed & ZX_CHANNEL_READABLE)) {
+        uint8_t msg[fuchsia_io_MAX_BUF];
+        uint32_t actual;
+        while (zx_channel_read(wait->object, 0, msg, NULL, sizeof(msg), 0,
+                               &actual, NULL) == ZX_OK) {
+        }
+        if (async_begin_wait(dispatcher, wait) == ZX_OK) {
+            mtx_unlock(&instance_state->cache_lock);
+            return;
+        }
+    }
+    // The watch was closed or cancelled. Objects aren't cached again until
+    // the path can be watched once more.
+    lib_path_watch_destroy_locked(watch);
+    mtx_unlock(&instance_state->cache_lock);
+    instance_state_deref(instance_state);
+}
+
+// Opens |lib_paths[index]|, if it exists, and asks to watch it. Returns the
+// channel the watch's events arrive on, or ZX_HANDLE_INVALID. Called without
+// |cache_lock| held, since both are round trips to the filesystem.
+static zx_handle_t lib_path_watch_open(instance_state_t* instance_state, size_t index) {
+    int fd = openat(instance_state->root_dir_fd, instance_state->lib_paths[index],
+                    O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        return ZX_HANDLE_INVALID;
+    }
+    zx_handle_t client, server;
+    zx_status_t status = zx_channel_create(0, &client, &server);
+    if (status != ZX_OK) {
+        close(fd);
+        return ZX_HANDLE_INVALID;
+    }
+    fdio_t* io = fdio_unsafe_fd_to_io(fd);
+    zx_handle_t dir_channel = fdio_unsafe_borrow_channel(io);
+    zx_status_t io_status = ZX_ERR_NOT_SUPPORTED;
+    if (dir_channel != ZX_HANDLE_INVALID) {
+        io_status = fuchsia_io_DirectoryWatch(
+            dir_channel, fuchsia_io_WATCH_MASK_ADDED | fuchsia_io_WATCH_MASK_REMOVED, 0,
+            server, &status);
+    } else {
+        zx_handle_close(server);
+    }
+    fdio_unsafe_release(io);
+    close(fd);
+    if (io_status != ZX_OK || status != ZX_OK) {
+        zx_handle_close(client);
+        return ZX_HANDLE_INVALID;
+    }
+    return client;
+}
+
+// Watches |lib_paths[index]| for events on |client|, unless another thread
+// started watching it first. Always consumes |client|.
+static void lib_path_watch_install_locked(instance_state_t* instance_state, size_t index,
+                                          zx_handle_t client) {
+    if (instance_state->finalized || instance_state->watches[index] != NULL) {
+        zx_handle_close(client);
+        return;
+    }
+    lib_path_watch_t* watch = calloc(1, sizeof(lib_path_watch_t));
+    if (watch == NULL) {
+        zx_handle_close(client);
+        return;
+    }
+    watch->wait.handler = lib_path_watch_handler;
+    watch->wait.object = client;
+    watch->wait.trigger = ZX_CHANNEL_READABLE | ZX_CHANNEL_PEER_CLOSED;
+    watch->instance_state = instance_state;
+    watch->index = index;
+    if (async_begin_wait(instance_state->dispatcher, &watch->wait) != ZX_OK) {
+        zx_handle_close(client);
+        free(watch);
+        return;
+    }
+    instance_state->watches[index] = watch;
+    instance_state->refcount++;
+    // Anything cached before the path was watched may have been shadowed by
+    // a name in it.
+    cache_flush_locked(instance_state);
+}
+
+// Returns true if the cache is enabled and some library paths, which may
+// have appeared since, aren't watched.
+static bool lib_path_watches_missing_locked(instance_state_t* instance_state) {
+    if (!instance_state->cache_enabled) {
+        return false;
+    }
+    for (size_t i = 0; i < LIB_PATHS_MAX && instance_state->lib_paths[i]; ++i) {
+        if (instance_state->watches[i] == NULL) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Starts watching the library paths which have appeared since they were
+// last tried. Attempts are rate limited, so that loads don't each try to
+// open a path that doesn't exist. Called without |cache_lock| held.
+static void lib_path_watches_update(instance_state_t* instance_state) {
+    mtx_lock(&instance_state->cache_lock);
+    zx_time_t now = zx_clock_get_monotonic();
+    bool due = lib_path_watches_missing_locked(instance_state) &&
+               now >= instance_state->watch_retry_time;
+    if (due) {
+        instance_state->watch_retry_time = zx_time_add_duration(now, LIB_PATH_WATCH_RETRY);
+    }
+    mtx_unlock(&instance_state->cache_lock);
+    if (!due) {
+        return;
+    }
+
+    for (size_t i = 0; i < LIB_PATHS_MAX && instance_state->lib_paths[i]; ++i) {
+        mtx_lock(&instance_state->cache_lock);
+        bool watched = instance_state->watches[i] != NULL;
+        mtx_unlock(&instance_state->cache_lock);
+        if (watched) {
+            continue;
+        }
+        zx_handle_t client = lib_path_watch_open(instance_state, i);
+        if (client == ZX_HANDLE_INVALID) {
+            continue;
+        }
+        mtx_lock(&instance_state->cache_lock);
+        lib_path_watch_install_locked(instance_state, i, client);
+        mtx_unlock(&instance_state->cache_lock);
+    }
+}
+
+// Returns true if objects may be cached: every library path exists and is
+// watched.
+static bool cache_usable_locked(instance_state_t* instance_state) {
+    if (!instance_state->cache_enabled) {
+        return false;
+    }
+    for (size_t i = 0; instance_state->lib_paths[i]; ++i) {
+        if (i == LIB_PATHS_MAX || instance_state->watches[i] == NULL) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Returns a copy-on-write clone of a cached VMO, so that clients never share
+// pages they might write to.
+static zx_status_t cache_clone_vmo(zx_handle_t vmo, const char* name, zx_handle_t* out) {
+    uint64_t size;
+    zx_status_t status = zx_vmo_get_size(vmo, &size);
+    if (status != ZX_OK) {
+        return status;
+    }
+    if ((status = zx_vmo_clone(vmo, ZX_VMO_CLONE_COPY_ON_WRITE, 0, size, out)) != ZX_OK) {
+        return status;
+    }
+    zx_object_set_property(*out, ZX_PROP_NAME, name, strlen(name));
+    return ZX_OK;
+}
+
+// Looks up |name| in the cache. Returns true on a hit, with a clone of its
+// VMO in |out|.
+static bool cache_lookup_locked(instance_state_t* instance_state, const char* name,
+                                zx_handle_t* out) {
+    for (size_t i = 0; i < CACHE_ENTRIES; ++i) {
+        cache_entry_t* entry = &instance_state->cache[i];
+        if (entry->name[0] != '\0' && strcmp(entry->name, name) == 0) {
+            if (cache_clone_vmo(entry->vmo, name, out) != ZX_OK) {
+                return false;
+            }
+            entry->last_use = ++instance_state->cache_clock;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Caches |vmo| as the object loaded by |name|, evicting the least recently
+// used object if the cache is full. Consumes |vmo|, whose clients' clones read
+// through to its pages, so the handle kept has no right to write to it.
+static void cache_insert_locked(instance_state_t* instance_state, const char* name,
+                                zx_handle_t vmo) {
+    zx_info_handle_basic_t info;
+    zx_status_t status = zx_object_get_info(vmo, ZX_INFO_HANDLE_BASIC, &info, sizeof(info),
+                                            NULL, NULL);
+    if (status != ZX_OK) {
+        zx_handle_close(vmo);
+        return;
+    }
+    if (zx_handle_replace(vmo, info.rights & ~ZX_RIGHT_WRITE, &vmo) != ZX_OK) {
+        return;
+    }
+
+    cache_entry_t* victim = &instance_state->cache[0];
+    for (size_t i = 0; i < CACHE_ENTRIES; ++i) {
+        cache_entry_t* entry = &instance_state->cache[i];
+        if (entry->name[0] == '\0') {
+            victim = entry;
+            break;
+        }
+        if (entry->last_use < victim->last_use) {
+            victim = entry;
+        }
+    }
+    if (victim->name[0] != '\0') {
+        zx_handle_close(victim->vmo);
+    }
+    strcpy(victim->name, name);
+    victim->vmo = vmo;
+    victim->last_use = ++instance_state->cache_clock;
+}
+
 static zx_status_t fd_load_object(void* ctx, const char* name, zx_handle_t* out) {
-    int root_dir_fd = ((instance_state_t*)ctx)->root_dir_fd;
-    const char* const* lib_paths = ((instance_state_t*)ctx)->lib_paths;
+    instance_state_t* instance_state = (instance_state_t*)ctx;
+    int root_dir_fd = instance_state->root_dir_fd;
+    const char* const* lib_paths = instance_state->lib_paths;
+
+    // Names with a configured prefix are found in subdirectories of the
+    // library paths, which aren't watched, so they're never cached.
+    bool cacheable = strlen(name) <= CACHE_NAME_MAX && strchr(name, '/') == NULL;
+    uint64_t generation = 0;
+    if (cacheable) {
+        lib_path_watches_update(instance_state);
+        mtx_lock(&instance_state->cache_lock);
+        cacheable = cache_usable_locked(instance_state);
+        if (cacheable && cache_lookup_locked(instance_state, name, out)) {
+            mtx_unlock(&instance_state->cache_lock);
+            return ZX_OK;
+        }
+        generation = instance_state->cache_generation;
+        mtx_unlock(&instance_state->cache_lock);
+    }
 
     int fd = open_from_lib_paths(root_dir_fd, lib_paths, name);
-    if (fd >= 0) {
-        return vmo_from_fd(fd, name, out);
+    if (fd < 0) {
+        return ZX_ERR_NOT_FOUND;
     }
-    return ZX_ERR_NOT_FOUND;
+    zx_status_t status = vmo_from_fd(fd, name, out);
+    if (status == ZX_OK && cacheable) {
+        mtx_lock(&instance_state->cache_lock);
+        // If the cache was flushed while the object was loaded, it may not
+        // be the object the name refers to now. Otherwise the client gets a
+        // clone like any other, so that nothing it writes reaches the cache.
+        zx_handle_t clone;
+        if (instance_state->cache_generation == generation &&
+            cache_clone_vmo(*out, name, &clone) == ZX_OK) {
+            cache_insert_locked(instance_state, name, *out);
+            *out = clone;
+        }
+        mtx_unlock(&instance_state->cache_lock);
+    }
+    return status;
 }
 
 static zx_status_t fd_load_abspath(void* ctx, const char* path, zx_handle_t* out) {
@@ -120,7 +462,24 @@ void fd_finalizer(void* ctx) {
     instance_state_t* instance_state = (instance_state_t*)ctx;
     int root_dir_fd = instance_state->root_dir_fd;
     close(root_dir_fd);
-    free(instance_state);
+
+    // Watches whose handlers are running (or can't be cancelled for any
+    // other reason) notice that the instance is finalized, and release
+    // their references themselves.
+    mtx_lock(&instance_state->cache_lock);
+    instance_state->finalized = true;
+    instance_state->cache_enabled = false;
+    for (size_t i = 0; i < LIB_PATHS_MAX; ++i) {
+        lib_path_watch_t* watch = instance_state->watches[i];
+        if (watch != NULL &&
+            async_cancel_wait(instance_state->dispatcher, &watch->wait) == ZX_OK) {
+            lib_path_watch_destroy_locked(watch);
+            // The loader service's reference is still held.
+            instance_state->refcount--;
+        }
+    }
+    mtx_unlock(&instance_state->cache_lock);
+    instance_state_deref(instance_state);
 }
 
 static const loader_service_ops_t fd_ops = {
@@ -302,19 +661,24 @@ static zx_status_t loader_service_create_default(async_dispatcher_t* dispatcher,
                                                  int root_dir_fd,
                                                  const char* const* lib_paths,
                                                  loader_service_t** out) {
-    instance_state_t* instance_state = calloc(1, sizeof(loader_service_t));
+    instance_state_t* instance_state = calloc(1, sizeof(instance_state_t));
     if (instance_state == NULL) {
         return ZX_ERR_NO_MEMORY;
     }
     instance_state->root_dir_fd = root_dir_fd;
     instance_state->lib_paths = lib_paths? lib_paths : fd_lib_paths;
+    mtx_init(&instance_state->cache_lock, mtx_plain);
+    instance_state->cache_enabled = true;
+    instance_state->refcount = 1;
 
     loader_service_t* svc;
     zx_status_t status = loader_service_create(dispatcher, &fd_ops, NULL, &svc);
     if (status == ZX_OK) {
+      instance_state->dispatcher = svc->dispatcher;
       svc->ctx = instance_state;
       *out = svc;
     } else {
+      mtx_destroy(&instance_state->cache_lock);
       free(instance_state);
     }
     return status;
@@ -334,6 +698,23 @@ zx_status_t loader_service_create_fd(async_dispatcher_t* dispatcher,
     return loader_service_create_default(dispatcher, root_dir_fd, fd_lib_paths, out);
 }
 
+zx_status_t loader_service_set_cache_enabled(loader_service_t* svc, bool enabled) {
+    if (svc == NULL) {
+        return ZX_ERR_INVALID_ARGS;
+    }
+    if (svc->ops != &fd_ops) {
+        return ZX_ERR_NOT_SUPPORTED;
+    }
+    instance_state_t* instance_state = (instance_state_t*)svc->ctx;
+    mtx_lock(&instance_state->cache_lock);
+    instance_state->cache_enabled = enabled;
+    if (!enabled) {
+        cache_flush_locked(instance_state);
+    }
+    mtx_unlock(&instance_state->cache_lock);
+    return ZX_OK;
+}
+
 zx_status_t loader_service_release(loader_service_t* svc) {
     // This call to |loader_service_deref| balances the |loader_service_addref|
     // call in |loader_service_create|. This reference prevents the loader
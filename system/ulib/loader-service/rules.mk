@@ -13,9 +13,14 @@ MODULE_COMPILEFLAGS += -fvisibility=hidden
 MODULE_SRCS += \
     $(LOCAL_DIR)/loader-service.c \
 
+MODULE_FIDL_LIBS := \
+    system/fidl/fuchsia-io \
+    system/fidl/fuchsia-mem \
+
 MODULE_STATIC_LIBS := \
     system/ulib/async-loop \
     system/ulib/async \
+    system/ulib/fidl \
     system/ulib/ldmsg \
 
 MODULE_LIBS := \
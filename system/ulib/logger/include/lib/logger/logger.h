@@ -11,6 +11,7 @@
 #include <lib/async/cpp/wait.h>
 #include <lib/fidl/cpp/message_buffer.h>
 #include <lib/zx/channel.h>
+#include <lib/zx/eventpair.h>
 #include <lib/zx/socket.h>
 #include <stdint.h>
 #include <lib/syslog/wire_format.h>
@@ -42,7 +43,12 @@ private:
                       const zx_packet_signal_t* signal);
     zx_status_t ReadAndDispatchMessage(fidl::MessageBuffer* buffer, async_dispatcher_t* dispatcher);
 
+    void OnBufferSignaled(async_dispatcher_t* dispatcher, async::WaitBase* wait,
+                          zx_status_t status, const zx_packet_signal_t* signal);
+    zx_status_t DrainBuffer();
+
     zx_status_t Connect(fidl::Message message, async_dispatcher_t* dispatcher);
+    zx_status_t ConnectBuffer(fidl::Message message, async_dispatcher_t* dispatcher);
 
     zx_status_t PrintLogMessage(const fx_log_packet_t* packet);
 
@@ -50,9 +56,15 @@ private:
 
     zx::channel channel_;
     zx::socket socket_;
+    // The mapping of the client's shared log buffer, if it connected one,
+    // and our end of the eventpair it signals to wake us.
+    uintptr_t buffer_ = 0;
+    size_t buffer_size_ = 0;
+    zx::eventpair buffer_event_;
     int fd_;
     async::WaitMethod<LoggerImpl, &LoggerImpl::OnHandleReady> wait_;
     async::WaitMethod<LoggerImpl, &LoggerImpl::OnLogMessage> socket_wait_;
+    async::WaitMethod<LoggerImpl, &LoggerImpl::OnBufferSignaled> buffer_wait_;
     ErrorCallback error_handler_;
 };
 
@@ -8,7 +8,10 @@
 #include <fuchsia/logger/c/fidl.h>
 #include <lib/fidl/cpp/message_buffer.h>
 #include <lib/zx/channel.h>
+#include <lib/zx/vmar.h>
+#include <lib/zx/vmo.h>
 #include <stdint.h>
+#include <lib/syslog/log_buffer.h>
 #include <lib/syslog/logger.h>
 #include <lib/syslog/wire_format.h>
 #include <zircon/processargs.h>
@@ -21,16 +24,26 @@ namespace {
 
 static fx_log_packet_t packet;
 
+// Context for printing the records drained from a shared log buffer.
+struct DrainContext {
+    LoggerImpl* logger;
+    zx_status_t status;
+};
+
 } // namespace
 
 LoggerImpl::LoggerImpl(zx::channel channel, int out_fd)
     : channel_(std::move(channel)),
       fd_(out_fd),
       wait_(this, channel_.get(), ZX_CHANNEL_READABLE | ZX_CHANNEL_PEER_CLOSED),
-      socket_wait_(this) {
+      socket_wait_(this),
+      buffer_wait_(this) {
 }
 
 LoggerImpl::~LoggerImpl() {
+    if (buffer_ != 0) {
+        zx::vmar::root_self()->unmap(buffer_, buffer_size_);
+    }
     fsync(fd_);
 }
 
@@ -128,6 +141,57 @@ void LoggerImpl::OnLogMessage(async_dispatcher_t* dispatcher, async::WaitBase* w
     NotifyError(ZX_ERR_PEER_CLOSED);
 }
 
+zx_status_t LoggerImpl::DrainBuffer() {
+    DrainContext context{this, ZX_OK};
+    auto print_record = [](const fx_log_packet_t* record, size_t size, void* ctx) {
+        auto* drain = static_cast<DrainContext*>(ctx);
+        // Copy the record out of shared memory before looking at it.
+        memset(&packet, 0, sizeof(packet));
+        memcpy(&packet, record, size);
+        packet.data[sizeof(packet.data) - 1] = 0;
+        zx_status_t status = drain->logger->PrintLogMessage(&packet);
+        if (status == ZX_ERR_INVALID_ARGS) {
+            drain->status = status;
+        }
+    };
+    ssize_t count = fx_log_buffer_drain(reinterpret_cast<void*>(buffer_), buffer_size_,
+                                        print_record, &context);
+    if (count < 0) {
+        return static_cast<zx_status_t>(count);
+    }
+    return context.status;
+}
+
+void LoggerImpl::OnBufferSignaled(async_dispatcher_t* dispatcher, async::WaitBase* wait,
+                                  zx_status_t status, const zx_packet_signal_t* signal) {
+    if (status != ZX_OK) {
+        NotifyError(status);
+        return;
+    }
+
+    // Clear the signal before draining, so that a record committed after we
+    // drain wakes us again.
+    buffer_event_.signal(ZX_USER_SIGNAL_0, 0);
+    status = DrainBuffer();
+    if (status != ZX_OK) {
+        NotifyError(status);
+        return;
+    }
+    if (signal->observed & ZX_EVENTPAIR_PEER_CLOSED) {
+        NotifyError(ZX_ERR_PEER_CLOSED);
+        return;
+    }
+    // Sleep until a writer wakes us. If records came in since we drained,
+    // wake ourselves instead, so that other waits get a turn first.
+    if (!fx_log_buffer_arm(reinterpret_cast<void*>(buffer_), buffer_size_)) {
+        buffer_event_.signal(0, ZX_USER_SIGNAL_0);
+    }
+    status = wait->Begin(dispatcher);
+    if (status != ZX_OK) {
+        NotifyError(status);
+    }
+}
+
 void LoggerImpl::OnHandleReady(async_dispatcher_t* dispatcher, async::WaitBase* wait, zx_status_t status,
                                const zx_packet_signal_t* signal) {
     if (status != ZX_OK) {
@@ -155,7 +219,7 @@ void LoggerImpl::OnHandleReady(async_dispatcher_t* dispatcher, async::WaitBase*
 
     ZX_DEBUG_ASSERT(signal->observed & ZX_CHANNEL_PEER_CLOSED);
     channel_.reset();
-    if (!socket_) {
+    if (!socket_ && !buffer_event_) {
         // if there is no socket, it doesn't make sense to keep running this
         // instance.
         NotifyError(ZX_ERR_PEER_CLOSED);
@@ -173,6 +237,9 @@ zx_status_t LoggerImpl::ReadAndDispatchMessage(fidl::MessageBuffer* buffer, asyn
     case fuchsia_logger_LogSinkConnectOrdinal:
     case fuchsia_logger_LogSinkConnectGenOrdinal:
         return Connect(std::move(message), dispatcher);
+    case fuchsia_logger_LogSinkConnectBufferOrdinal:
+    case fuchsia_logger_LogSinkConnectBufferGenOrdinal:
+        return ConnectBuffer(std::move(message), dispatcher);
     default:
         fprintf(stderr, "logger: error: Unknown message ordinal: %d\n", message.ordinal());
         return ZX_ERR_NOT_SUPPORTED;
@@ -180,7 +247,7 @@ zx_status_t LoggerImpl::ReadAndDispatchMessage(fidl::MessageBuffer* buffer, asyn
 }
 
 zx_status_t LoggerImpl::Connect(fidl::Message message, async_dispatcher_t* dispatcher) {
-    if (socket_) {
+    if (socket_ || buffer_event_) {
         return ZX_ERR_INVALID_ARGS;
     }
     const char* error_msg = nullptr;
@@ -197,11 +264,52 @@ zx_status_t LoggerImpl::Connect(fidl::Message message, async_dispatcher_t* dispa
     return ZX_OK;
 }
 
+zx_status_t LoggerImpl::ConnectBuffer(fidl::Message message, async_dispatcher_t* dispatcher) {
+    if (socket_ || buffer_event_) {
+        return ZX_ERR_INVALID_ARGS;
+    }
+    const char* error_msg = nullptr;
+    zx_status_t status = message.Decode(&fuchsia_logger_LogSinkConnectBufferRequestTable,
+                                        &error_msg);
+    if (status != ZX_OK) {
+        fprintf(stderr, "logger: error: ConnectBuffer: %s\n", error_msg);
+        return status;
+    }
+    auto* request = message.GetBytesAs<fuchsia_logger_LogSinkConnectBufferRequest>();
+    zx::vmo vmo(request->buffer);
+    zx::eventpair event(request->reader_event);
+    uint64_t size;
+    if ((status = vmo.get_size(&size)) != ZX_OK) {
+        return status;
+    }
+    if (size > FX_LOG_BUFFER_MAX_SIZE) {
+        return ZX_ERR_INVALID_ARGS;
+    }
+    // Refuse a buffer the client could shrink under our mapping.
+    uintptr_t buffer;
+    if ((status = zx::vmar::root_self()->map(0, vmo, 0, size,
+                                              ZX_VM_PERM_READ | ZX_VM_PERM_WRITE |
+                                                  ZX_VM_REQUIRE_NON_RESIZABLE,
+                                              &buffer)) != ZX_OK) {
+        return status;
+    }
+    buffer_ = buffer;
+    buffer_size_ = size;
+    buffer_event_ = std::move(event);
+    // Drain whatever was written before we connected, and arm the buffer.
+    buffer_event_.signal(0, ZX_USER_SIGNAL_0);
+    buffer_wait_.set_object(buffer_event_.get());
+    buffer_wait_.set_trigger(ZX_USER_SIGNAL_0 | ZX_EVENTPAIR_PEER_CLOSED);
+    return buffer_wait_.Begin(dispatcher);
+}
+
 void LoggerImpl::NotifyError(zx_status_t error) {
     socket_wait_.Cancel();
+    buffer_wait_.Cancel();
     wait_.Cancel();
     channel_.reset();
     socket_.reset();
+    buffer_event_.reset();
     if (error_handler_)
         error_handler_(error);
 }
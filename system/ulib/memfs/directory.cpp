@@ -30,7 +30,8 @@ constexpr const char kFsName[] = "memfs";
 
 }
 
-VnodeDir::VnodeDir(Vfs* vfs) : VnodeMemfs(vfs) {
+VnodeDir::VnodeDir(Vfs* vfs, fbl::RefPtr<PageAccount> account)
+    : VnodeMemfs(vfs, std::move(account)) {
     link_count_ = 1; // Implied '.'
 }
 VnodeDir::~VnodeDir() {}
@@ -57,13 +58,15 @@ zx_status_t VnodeDir::QueryFilesystem(fuchsia_io_FilesystemInfo* info) {
     info->max_filename_size = kDnodeNameMax;
     info->fs_type = VFS_TYPE_MEMFS;
     info->fs_id = vfs()->GetFsId();
+    // Directories within a subtree with a limit of its own report that
+    // subtree's capacity and usage.
     size_t total_bytes = 0;
-    if (mul_overflow(vfs()->PagesLimit(), kMemfsBlksize, &total_bytes)) {
+    if (mul_overflow(PagesLimit(), kMemfsBlksize, &total_bytes)) {
         info->total_bytes = UINT64_MAX;
     } else {
         info->total_bytes = total_bytes;
     }
-    info->used_bytes = vfs()->NumAllocatedPages() * kMemfsBlksize;
+    info->used_bytes = NumAllocatedPages() * kMemfsBlksize;
     info->total_nodes = UINT64_MAX;
     uint64_t deleted_ino_count = GetDeletedInoCounter();
     uint64_t ino_count = GetInoCounter();
@@ -131,6 +134,18 @@ zx_status_t VnodeDir::Readdir(fs::vdircookie_t* cookie, void* data, size_t len,
     return ZX_OK;
 }
 
+zx_status_t VnodeDir::ReaddirPlus(fs::vdircookie_t* cookie, void* data, size_t len,
+                                  size_t* out_actual) {
+    fs::DirentPlusFiller df(data, len);
+    if (!IsDirectory()) {
+        // This WAS a directory, but it has been deleted.
+        Dnode::ReaddirPlusStart(&df, cookie, this);
+        return df.Finish(out_actual);
+    }
+    dnode_->ReaddirPlus(&df, cookie);
+    return df.Finish(out_actual);
+}
+
 // postcondition: reference taken on vn returned through "out"
 zx_status_t VnodeDir::Create(fbl::RefPtr<fs::Vnode>* out, fbl::StringPiece name, uint32_t mode) {
     zx_status_t status;
@@ -141,9 +156,9 @@ zx_status_t VnodeDir::Create(fbl::RefPtr<fs::Vnode>* out, fbl::StringPiece name,
     fbl::AllocChecker ac;
     fbl::RefPtr<memfs::VnodeMemfs> vn;
     if (S_ISDIR(mode)) {
-        vn = fbl::AdoptRef(new (&ac) memfs::VnodeDir(vfs()));
+        vn = fbl::AdoptRef(new (&ac) memfs::VnodeDir(vfs(), account_));
     } else {
-        vn = fbl::AdoptRef(new (&ac) memfs::VnodeFile(vfs()));
+        vn = fbl::AdoptRef(new (&ac) memfs::VnodeFile(vfs(), account_));
     }
 
     if (!ac.check()) {
@@ -202,6 +217,10 @@ zx_status_t VnodeDir::Rename(fbl::RefPtr<fs::Vnode> _newdir, fbl::StringPiece ol
         // Renaming a file or directory to itself?
         // Shortcut success case
         return ZX_OK;
+    } else if (newdir->account() != account_.get()) {
+        // Pages stay charged to the subtree they were committed in, so nodes
+        // can't be moved between subtrees with different limits.
+        return ZX_ERR_NOT_SUPPORTED;
     }
 
     // Verify that the destination is not a subdirectory of the source (if
@@ -272,6 +291,11 @@ zx_status_t VnodeDir::Link(fbl::StringPiece name, fbl::RefPtr<fs::Vnode> target)
         return ZX_ERR_NOT_FILE;
     }
 
+    if (vn->account() != nullptr && vn->account() != account_.get()) {
+        // The target's pages are charged to a subtree with a different limit
+        return ZX_ERR_NOT_SUPPORTED;
+    }
+
     if (dnode_->Lookup(name, nullptr) == ZX_OK) {
         // The destination should not exist
         return ZX_ERR_ALREADY_EXISTS;
@@ -293,6 +317,29 @@ void VnodeDir::MountSubtree(fbl::RefPtr<VnodeDir> subtree) {
     Dnode::AddChild(dnode_, subtree->dnode_);
 }
 
+zx_status_t VnodeDir::SetPagesLimit(size_t pages_limit) {
+    if (!IsDirectory()) {
+        return ZX_ERR_BAD_STATE;
+    }
+    if (has_pages_limit_) {
+        account_->SetPagesLimit(pages_limit);
+        return ZX_OK;
+    }
+    if (dnode_->HasChildren()) {
+        // The pages of existing children are charged to the parent's account.
+        return ZX_ERR_BAD_STATE;
+    }
+
+    fbl::AllocChecker ac;
+    auto account = fbl::MakeRefCountedChecked<PageAccount>(&ac, pages_limit, account_);
+    if (!ac.check()) {
+        return ZX_ERR_NO_MEMORY;
+    }
+    account_ = std::move(account);
+    has_pages_limit_ = true;
+    return ZX_OK;
+}
+
 zx_status_t VnodeDir::CreateFromVmo(fbl::StringPiece name,
                                     zx_handle_t vmo, zx_off_t off, zx_off_t len) {
     zx_status_t status;
@@ -167,6 +167,55 @@ void Dnode::Readdir(fs::DirentFiller* df, void* cookie) const {
     }
 }
 
+// Reads the attributes of |vn| into |attr|, returning null if they can't
+// be read, or belong to another filesystem mounted on |vn|.
+static const vnattr_t* DirentAttributes(VnodeMemfs* vn, vnattr_t* attr) {
+    if (vn->IsRemote()) {
+        return nullptr;
+    }
+    memset(attr, 0, sizeof(*attr));
+    return vn->Getattr(attr) == ZX_OK ? attr : nullptr;
+}
+
+zx_status_t Dnode::ReaddirPlusStart(fs::DirentPlusFiller* df, void* cookie, VnodeMemfs* dir) {
+    dircookie_t* c = static_cast<dircookie_t*>(cookie);
+    zx_status_t r;
+
+    if (c->order == 0) {
+        vnattr_t attr;
+        if ((r = df->Next(".", VTYPE_TO_DTYPE(V_TYPE_DIR),
+                          DirentAttributes(dir, &attr))) != ZX_OK) {
+            return r;
+        }
+        c->order++;
+    }
+    return ZX_OK;
+}
+
+void Dnode::ReaddirPlus(fs::DirentPlusFiller* df, void* cookie) const {
+    dircookie_t* c = static_cast<dircookie_t*>(cookie);
+    zx_status_t r = 0;
+
+    if (c->order < 1) {
+        if ((r = Dnode::ReaddirPlusStart(df, cookie, vnode_.get())) != ZX_OK) {
+            return;
+        }
+    }
+
+    for (const auto& dn : children_) {
+        if (dn.ordering_token_ < c->order) {
+            continue;
+        }
+        uint32_t vtype = dn.IsDirectory() ? V_TYPE_DIR : V_TYPE_FILE;
+        vnattr_t attr;
+        if ((r = df->Next(fbl::StringPiece(dn.name_.get(), dn.NameLen()), VTYPE_TO_DTYPE(vtype),
+                          DirentAttributes(dn.vnode_.get(), &attr))) != ZX_OK) {
+            return;
+        }
+        c->order = dn.ordering_token_ + 1;
+    }
+}
+
 // Answers the question: "Is dn a subdirectory of this?"
 bool Dnode::IsSubdirectory(fbl::RefPtr<Dnode> dn) const {
     if (IsDirectory() && dn->IsDirectory()) {
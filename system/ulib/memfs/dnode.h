@@ -78,6 +78,12 @@ public:
     static zx_status_t ReaddirStart(fs::DirentFiller* df, void* cookie);
     void Readdir(fs::DirentFiller* df, void* cookie) const;
 
+    // As ReaddirStart and Readdir, but also returns the attributes of each
+    // entry, read directly from its vnode. |dir| is the directory being read.
+    static zx_status_t ReaddirPlusStart(fs::DirentPlusFiller* df, void* cookie,
+                                        VnodeMemfs* dir);
+    void ReaddirPlus(fs::DirentPlusFiller* df, void* cookie) const;
+
     // Answers the question: "Is dn a subdirectory of this?"
     bool IsSubdirectory(fbl::RefPtr<Dnode> dn) const;
 
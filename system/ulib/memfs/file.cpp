@@ -18,18 +18,29 @@
 #include <lib/memfs/cpp/vnode.h>
 #include <zircon/device/vfs.h>
 
+#include <utility>
+
 #include "dnode.h"
 
 namespace memfs {
 
-// Artificially cap the maximum in-memory file size to 512MB.
-constexpr size_t kMemfsMaxFileSize = 512 * 1024 * 1024;
+namespace {
+
+constexpr size_t kPageSize = static_cast<size_t>(PAGE_SIZE);
+
+// Files only use memory for the pages which have been written, so their size
+// is capped just to keep offsets well clear of overflow.
+constexpr size_t kMemfsMaxFileSize = 1ull << 40;
+
+const uint8_t kZeroPage[kPageSize] = {};
 
-VnodeFile::VnodeFile(Vfs* vfs)
-    : VnodeMemfs(vfs), vmo_size_(0), length_(0)  {}
+} // namespace
+
+VnodeFile::VnodeFile(Vfs* vfs, fbl::RefPtr<PageAccount> account)
+    : VnodeMemfs(vfs, std::move(account)), vmo_size_(0), length_(0)  {}
 
 VnodeFile::~VnodeFile() {
-    vfs()->WillFreeVMO(vmo_size_);
+    account_->Uncharge(charged_pages_);
 }
 
 zx_status_t VnodeFile::ValidateFlags(uint32_t flags) {
@@ -57,9 +68,17 @@ zx_status_t VnodeFile::Read(void* data, size_t len, size_t off, size_t* out_actu
 zx_status_t VnodeFile::Write(const void* data, size_t len, size_t offset,
                              size_t* out_actual) {
     zx_status_t status;
+    if (offset > kMemfsMaxFileSize) {
+        return ZX_ERR_FILE_BIG;
+    }
     size_t newlen = offset + len;
     newlen = newlen > kMemfsMaxFileSize ? kMemfsMaxFileSize : newlen;
-    if ((status = vfs()->GrowVMO(vmo_, vmo_size_, newlen, &vmo_size_)) != ZX_OK) {
+    if ((status = GrowVmo(newlen)) != ZX_OK) {
+        return status;
+    }
+    // Zero-extending the file never commits a page (see ZeroTail), so only the
+    // pages the write touches may need memory.
+    if ((status = ReservePages(offset, newlen)) != ZX_OK) {
         return status;
     }
     // Accessing beyond the end of the file? Extend it.
@@ -69,7 +88,9 @@ zx_status_t VnodeFile::Write(const void* data, size_t len, size_t offset,
         ZeroTail(length_, offset);
     }
     size_t writelen = newlen - offset;
-    if ((status = vmo_.write(data, offset, writelen)) != ZX_OK) {
+    status = WriteSparse(static_cast<const uint8_t*>(data), writelen, offset);
+    UpdateCommittedPages();
+    if (status != ZX_OK) {
         return status;
     }
     *out_actual = writelen;
@@ -121,21 +142,39 @@ zx_status_t VnodeFile::GetVmo(int flags, zx_handle_t* out_vmo, size_t* out_size)
         return ZX_OK;
     }
 
+    // Clients writing to the vmo itself commit pages which memfs only sees
+    // after the fact, so the whole vmo is charged for as long as they may.
+    bool writable = flags & fuchsia_io_VMO_FLAG_WRITE;
+    if (writable && !shared_writable_) {
+        UpdateCommittedPages();
+        ZX_DEBUG_ASSERT(charged_pages_ <= vmo_size_ / kPageSize);
+        if ((status = account_->CheckCharge(vmo_size_ / kPageSize - charged_pages_)) != ZX_OK) {
+            return status;
+        }
+    }
     if ((status = vmo_.duplicate(rights, &result)) != ZX_OK) {
         return status;
     }
+    if (writable) {
+        shared_writable_ = true;
+        UpdateCommittedPages();
+    }
     *out_vmo = result.release();
     *out_size = length_;
     return ZX_OK;
 }
 
 zx_status_t VnodeFile::Getattr(vnattr_t* attr) {
+    // Clients may have committed pages through mappings of the vmo since it
+    // was last written.
+    UpdateCommittedPages();
     memset(attr, 0, sizeof(vnattr_t));
     attr->inode = ino_;
     attr->mode = V_TYPE_FILE | V_IRUSR | V_IWUSR | V_IRGRP | V_IROTH;
     attr->size = length_;
     attr->blksize = kMemfsBlksize;
-    attr->blkcount = fbl::round_up(attr->size, kMemfsBlksize) / VNATTR_BLKSIZE;
+    // Holes take no memory, so only committed pages are reported as blocks.
+    attr->blkcount = committed_pages_ * kPageSize / VNATTR_BLKSIZE;
     attr->nlink = link_count_;
     attr->create_time = create_time_;
     attr->modify_time = modify_time_;
@@ -152,7 +191,9 @@ zx_status_t VnodeFile::Truncate(size_t len) {
     if (len > kMemfsMaxFileSize) {
         return ZX_ERR_INVALID_ARGS;
     }
-    if ((status = vfs()->GrowVMO(vmo_, vmo_size_, len, &vmo_size_)) != ZX_OK) {
+    // Truncating never commits a page (see ZeroTail), so only growing a vmo
+    // which clients may write to needs to be within the limits.
+    if ((status = GrowVmo(len)) != ZX_OK) {
         return status;
     }
     if (len < length_) {
@@ -165,17 +206,24 @@ zx_status_t VnodeFile::Truncate(size_t len) {
     }
 
     length_ = len;
+    UpdateCommittedPages();
     UpdateModified();
     return ZX_OK;
 }
 
 void VnodeFile::ZeroTail(size_t start, size_t end) {
-    constexpr size_t kPageSize = static_cast<size_t>(PAGE_SIZE);
     if (start % kPageSize != 0) {
+        // A page which is not committed reads as zeroes, so the tail is only
+        // written if its page is committed already. Zeroing never commits a
+        // page.
         char buf[kPageSize];
         size_t ppage_size = kPageSize - (start % kPageSize);
-        memset(buf, 0, ppage_size);
-        ZX_ASSERT(vmo_.write(buf, start, ppage_size) == ZX_OK);
+        ZX_ASSERT(vmo_.read(buf, start, ppage_size) == ZX_OK);
+        if (memcmp(buf, kZeroPage, ppage_size) != 0) {
+            memset(buf, 0, ppage_size);
+            ZX_ASSERT(vmo_.write(buf, start, ppage_size) == ZX_OK);
+            MarkPagesWritten(start, start + ppage_size);
+        }
     }
     end = fbl::min(fbl::round_up(end, kPageSize), vmo_size_);
     uint64_t decommit_offset = fbl::round_up(start, kPageSize);
@@ -184,7 +232,138 @@ void VnodeFile::ZeroTail(size_t start, size_t end) {
     if (decommit_length > 0) {
         ZX_ASSERT(vmo_.op_range(ZX_VMO_OP_DECOMMIT, decommit_offset,
                                 decommit_length, nullptr, 0) == ZX_OK);
+        MarkPagesDecommitted(decommit_offset, end);
+    }
+}
+
+zx_status_t VnodeFile::GrowVmo(size_t len) {
+    if (len <= vmo_size_) {
+        return ZX_OK;
+    }
+    size_t aligned_len = fbl::round_up(len, kPageSize);
+    zx_status_t status;
+    if (shared_writable_) {
+        UpdateCommittedPages();
+    }
+    if (shared_writable_ &&
+        (status = account_->CheckCharge((aligned_len - vmo_size_) / kPageSize)) != ZX_OK) {
+        return status;
+    }
+    if (!vmo_.is_valid()) {
+        if ((status = zx::vmo::create(aligned_len, 0, &vmo_)) != ZX_OK) {
+            return status;
+        }
+    } else {
+        if ((status = vmo_.set_size(aligned_len)) != ZX_OK) {
+            return status;
+        }
+    }
+    vmo_size_ = aligned_len;
+    if (shared_writable_) {
+        UpdateCommittedPages();
     }
+    return ZX_OK;
+}
+
+zx_status_t VnodeFile::ReservePages(size_t start, size_t end) {
+    if (shared_writable_ || start >= end) {
+        // While the vmo is shared, all of it is charged already.
+        return ZX_OK;
+    }
+    size_t first = start / kPageSize;
+    size_t last = fbl::round_up(end, kPageSize) / kPageSize;
+    size_t pages = last - first;
+    for (const auto& range : written_pages_) {
+        if (range.start() >= last) {
+            break;
+        }
+        if (range.end() > first) {
+            pages -= fbl::min(range.end(), last) - fbl::max(range.start(), first);
+        }
+    }
+    ZX_DEBUG_ASSERT(charged_pages_ <= vmo_size_ / kPageSize);
+    return account_->CheckCharge(fbl::min(pages, vmo_size_ / kPageSize - charged_pages_));
+}
+
+void VnodeFile::UpdateCommittedPages() {
+    zx_info_vmo_t info;
+    if (!vmo_.is_valid() ||
+        vmo_.get_info(ZX_INFO_VMO, &info, sizeof(info), nullptr, nullptr) != ZX_OK) {
+        return;
+    }
+    committed_pages_ = info.committed_bytes / kPageSize;
+    if (shared_writable_) {
+        // Once memfs holds the only handle, no new mappings can be made, so
+        // the vmo is no longer shared when none remain. Clients may have
+        // decommitted pages memfs wrote, so forget them all.
+        zx_info_handle_count_t count;
+        if (vmo_.get_info(ZX_INFO_HANDLE_COUNT, &count, sizeof(count),
+                          nullptr, nullptr) == ZX_OK && count.handle_count == 1 &&
+            vmo_.get_info(ZX_INFO_VMO, &info, sizeof(info), nullptr, nullptr) == ZX_OK &&
+            info.num_mappings == 0) {
+            committed_pages_ = info.committed_bytes / kPageSize;
+            shared_writable_ = false;
+            written_pages_.ClearAll();
+        }
+    }
+    size_t pages = shared_writable_ ? vmo_size_ / kPageSize : committed_pages_;
+    if (pages > charged_pages_) {
+        account_->Charge(pages - charged_pages_);
+    } else {
+        account_->Uncharge(charged_pages_ - pages);
+    }
+    charged_pages_ = pages;
+}
+
+void VnodeFile::MarkPagesWritten(size_t start, size_t end) {
+    // Failing to record the pages only makes later reservations larger.
+    written_pages_.Set(start / kPageSize, fbl::round_up(end, kPageSize) / kPageSize);
+}
+
+void VnodeFile::MarkPagesDecommitted(size_t start, size_t end) {
+    // Splitting a run may need memory; if it cannot be had, forget every page
+    // rather than keep some which are no longer committed.
+    if (written_pages_.Clear(fbl::round_up(start, kPageSize) / kPageSize,
+                             end / kPageSize) != ZX_OK) {
+        written_pages_.ClearAll();
+    }
+}
+
+zx_status_t VnodeFile::WriteSparse(const uint8_t* data, size_t len, size_t offset) {
+    // Split the write into runs of whole pages of zeroes, which are
+    // decommitted, and runs of anything else, which are written.
+    auto flush = [this, data, offset](size_t start, size_t end, bool hole) -> zx_status_t {
+        if (hole && vmo_.op_range(ZX_VMO_OP_DECOMMIT, offset + start, end - start,
+                                  nullptr, 0) == ZX_OK) {
+            MarkPagesDecommitted(offset + start, offset + end);
+            return ZX_OK;
+        }
+        zx_status_t status = vmo_.write(data + start, offset + start, end - start);
+        if (status == ZX_OK) {
+            MarkPagesWritten(offset + start, offset + end);
+        }
+        return status;
+    };
+
+    size_t run_start = 0;
+    bool run_is_hole = false;
+    for (size_t pos = 0; pos < len;) {
+        size_t chunk = fbl::min(len - pos, kPageSize - (offset + pos) % kPageSize);
+        bool hole = chunk == kPageSize && memcmp(data + pos, kZeroPage, kPageSize) == 0;
+        if (hole != run_is_hole && pos > run_start) {
+            zx_status_t status = flush(run_start, pos, run_is_hole);
+            if (status != ZX_OK) {
+                return status;
+            }
+            run_start = pos;
+        }
+        run_is_hole = hole;
+        pos += chunk;
+    }
+    if (run_start < len) {
+        return flush(run_start, len, run_is_hole);
+    }
+    return ZX_OK;
 }
 
 } // namespace memfs
@@ -13,7 +13,10 @@
 
 #ifdef __cplusplus
 
+#include <bitmap/rle-bitmap.h>
 #include <fbl/intrusive_double_list.h>
+#include <fbl/macros.h>
+#include <fbl/ref_counted.h>
 #include <fbl/ref_ptr.h>
 #include <fbl/unique_ptr.h>
 #include <fs/managed-vfs.h>
@@ -32,6 +35,41 @@ constexpr uint64_t kMemfsBlksize = PAGE_SIZE;
 class Dnode;
 class Vfs;
 
+// Counts the pages committed by the files of a subtree of the filesystem, and
+// bounds them. A directory shares the account of its parent unless it has
+// been given a limit of its own, in which case its account is nested in its
+// parent's: pages charged to it are charged to every account containing it,
+// up to the one for the whole filesystem.
+class PageAccount : public fbl::RefCounted<PageAccount> {
+public:
+    DISALLOW_COPY_ASSIGN_AND_MOVE(PageAccount);
+
+    PageAccount(size_t pages_limit, fbl::RefPtr<PageAccount> parent);
+
+    size_t PagesLimit() const { return pages_limit_.load(std::memory_order_relaxed); }
+    void SetPagesLimit(size_t pages_limit) {
+        pages_limit_.store(pages_limit, std::memory_order_relaxed);
+    }
+    size_t NumAllocatedPages() const { return num_allocated_pages_; }
+
+    // Returns ZX_ERR_NO_SPACE if charging |pages| more pages would exceed the
+    // limit of this account or of any account containing it.
+    zx_status_t CheckCharge(size_t pages) const;
+
+    // Adds or removes |pages| from this account and the accounts containing
+    // it. Charges are not checked against the limits: by the time they are
+    // made, the pages have already been committed.
+    void Charge(size_t pages);
+    void Uncharge(size_t pages);
+
+private:
+    // Atomic since limits may be set from outside the dispatcher which
+    // serves the files charging the account.
+    std::atomic<size_t> pages_limit_;
+    size_t num_allocated_pages_ = 0;
+    const fbl::RefPtr<PageAccount> parent_;
+};
+
 class VnodeMemfs : public fs::Vnode {
 public:
     virtual zx_status_t Setattr(const vnattr_t* a) final;
@@ -47,14 +85,18 @@ public:
 
     Vfs* vfs() const { return vfs_; }
     uint64_t ino() const { return ino_; }
+    PageAccount* account() const { return account_.get(); }
 
     fbl::RefPtr<Dnode> dnode_;
     uint32_t link_count_;
 
 protected:
-    explicit VnodeMemfs(Vfs* vfs);
+    VnodeMemfs(Vfs* vfs, fbl::RefPtr<PageAccount> account);
 
     Vfs* vfs_;
+    // The account charged for the pages of a file, or shared by the children
+    // of a directory. Null for nodes which are not accounted.
+    fbl::RefPtr<PageAccount> account_;
     uint64_t ino_;
     uint64_t create_time_;
     uint64_t modify_time_;
@@ -74,7 +116,7 @@ private:
 
 class VnodeFile final : public VnodeMemfs {
 public:
-    explicit VnodeFile(Vfs* vfs);
+    VnodeFile(Vfs* vfs, fbl::RefPtr<PageAccount> account);
     ~VnodeFile() override;
 
     virtual zx_status_t ValidateFlags(uint32_t flags) final;
@@ -94,16 +136,52 @@ private:
     // [start, round_up(end, PAGE_SIZE)).
     void ZeroTail(size_t start, size_t end);
 
+    // Increases the size of the vmo to at least |len| bytes, creating it if
+    // need be. Pages are only charged to the file as they are committed, so
+    // the vmo may be much larger than the memory it uses, unless clients may
+    // write to it directly.
+    zx_status_t GrowVmo(size_t len);
+
+    // Returns ZX_ERR_NO_SPACE if writing the bytes [start, end) of the vmo
+    // could commit more pages than the limits of the file's account allow.
+    // Pages of the range which memfs has already written are not counted.
+    zx_status_t ReservePages(size_t start, size_t end);
+
+    // Charges the file's account for the pages the vmo has actually
+    // committed, or for the whole vmo while clients may write to it directly.
+    void UpdateCommittedPages();
+
+    // Records that the pages spanning the bytes [start, end) of the vmo have
+    // been written, or that the whole pages within them have been
+    // decommitted.
+    void MarkPagesWritten(size_t start, size_t end);
+    void MarkPagesDecommitted(size_t start, size_t end);
+
+    // Writes |len| bytes of |data| into the vmo at |offset|, decommitting
+    // rather than writing any whole pages of zeroes.
+    zx_status_t WriteSparse(const uint8_t* data, size_t len, size_t offset);
+
     zx::vmo vmo_;
     // Cached length of the vmo.
     uint64_t vmo_size_;
     // Logical length of the underlying file.
     zx_off_t length_;
+    // Number of pages the vmo had committed when last checked.
+    size_t committed_pages_ = 0;
+    // Number of pages of the vmo charged to |account_|.
+    size_t charged_pages_ = 0;
+    // Pages of the vmo which memfs has written and not since decommitted.
+    // Pages committed through mappings of the vmo are not tracked, so this may
+    // miss committed pages but never includes uncommitted ones.
+    bitmap::RleBitmap written_pages_;
+    // Whether a writable handle to the vmo itself has been handed out, and
+    // may still be held or mapped by a client.
+    bool shared_writable_ = false;
 };
 
 class VnodeDir final : public VnodeMemfs {
 public:
-    explicit VnodeDir(Vfs* vfs);
+    VnodeDir(Vfs* vfs, fbl::RefPtr<PageAccount> account);
     ~VnodeDir() override;
 
     zx_status_t ValidateFlags(uint32_t flags) final;
@@ -119,6 +197,17 @@ public:
     // Mount a subtree as a child of this directory.
     void MountSubtree(fbl::RefPtr<VnodeDir> subtree);
 
+    // Limits the pages committed by files in this directory's subtree to
+    // |pages_limit|, on top of the limits of the subtrees containing it.
+    // A directory must be empty to be given a limit, but once it has one,
+    // the limit may be changed at any time.
+    zx_status_t SetPagesLimit(size_t pages_limit);
+
+    // The limit and usage of the innermost subtree with a limit of its own
+    // which contains this directory, or of the whole filesystem.
+    size_t PagesLimit() const { return account_->PagesLimit(); }
+    size_t NumAllocatedPages() const { return account_->NumAllocatedPages(); }
+
     // Use the watcher container to implement a directory watcher
     void Notify(fbl::StringPiece name, unsigned event) final;
     zx_status_t WatchDir(fs::Vfs* vfs, uint32_t mask, uint32_t options, zx::channel watcher) final;
@@ -133,6 +222,8 @@ public:
 private:
     zx_status_t Readdir(fs::vdircookie_t* cookie, void* dirents, size_t len,
                         size_t* out_actual) final;
+    zx_status_t ReaddirPlus(fs::vdircookie_t* cookie, void* dirents, size_t len,
+                            size_t* out_actual) final;
 
     // Resolves the question, "Can this directory create a child node with the name?"
     // Returns "ZX_OK" on success; otherwise explains failure with error message.
@@ -154,6 +245,8 @@ private:
 
     fs::RemoteContainer remoter_;
     fs::WatcherContainer watcher_;
+    // Whether |account_| belongs to this directory, rather than its parent.
+    bool has_pages_limit_ = false;
 };
 
 class VnodeVmo final : public VnodeMemfs {
@@ -177,11 +270,15 @@ private:
 class Vfs : public fs::ManagedVfs {
 public:
     // Creates a Vfs with practically unlimited pages upper bound.
-    Vfs(): fs::ManagedVfs(), pages_limit_(UINT64_MAX), num_allocated_pages_(0) { }
+    Vfs(): Vfs(UINT64_MAX) {}
 
     // Creates a Vfs with the maximum |pages_limit| number of pages.
     explicit Vfs(size_t pages_limit):
-        fs::ManagedVfs(), pages_limit_(pages_limit), num_allocated_pages_(0) { }
+        fs::ManagedVfs(), account_(fbl::MakeRefCounted<PageAccount>(pages_limit, nullptr)) {
+        EnableLookupCache();
+    }
+
+    ~Vfs() override;
 
     // Creates a VnodeVmo under |parent| with |name| which is backed by |vmo|.
     // N.B. The VMO will not be taken into account when calculating
@@ -192,9 +289,13 @@ public:
 
     void MountSubtree(VnodeDir* parent, fbl::RefPtr<VnodeDir> subtree);
 
-    size_t PagesLimit() const { return pages_limit_; }
+    // Limits the pages used by files in the subtree rooted at |dir|.
+    // See VnodeDir::SetPagesLimit.
+    zx_status_t SetSubtreePagesLimit(VnodeDir* dir, size_t pages_limit);
 
-    size_t NumAllocatedPages() const { return num_allocated_pages_; }
+    size_t PagesLimit() const { return account_->PagesLimit(); }
+
+    size_t NumAllocatedPages() const { return account_->NumAllocatedPages(); }
 
     uint64_t GetFsId() const { return fs_id_; }
 
@@ -206,29 +307,9 @@ private:
     friend zx_status_t CreateFilesystem(const char* name, memfs::Vfs* vfs,
                                         fbl::RefPtr<VnodeDir>* out);
 
-    // Allows VnodeFile (and no other class) to manipulate number of allocated pages
-    // using GrowVMO and WillFreeVMO.
-    friend VnodeFile;
-
-    // Increases the size of the |vmo| to at least |request_size| bytes.
-    // If the VMO is invalid, it will try to create it.
-    // |current_size| is the current size of the VMO in number of bytes. It should be
-    // a multiple of page size. The new size of the VMO is returned via |actual_size|.
-    // If the new size would cause us to exceed the limit on number of pages or if the system
-    // ran out of memory, an error is returned.
-    zx_status_t GrowVMO(zx::vmo& vmo, size_t current_size,
-                        size_t request_size, size_t* actual_size);
-
-    // VnodeFile must call this function in the destructor to signal that its VMO will be freed.
-    // |vmo_size| is the size of the owned vmo in bytes. It should be a multiple of page size.
-    void WillFreeVMO(size_t vmo_size);
-
-    // Maximum number of pages available; fixed at Vfs creation time.
-    // Puts a bound on maximum memory usage.
-    const size_t pages_limit_;
-
-    // Number of pages currently in use by VnodeFiles.
-    size_t num_allocated_pages_;
+    // Pages committed by VnodeFiles, bounded by the maximum number of pages
+    // available, which is fixed at Vfs creation time.
+    const fbl::RefPtr<PageAccount> account_;
 
     uint64_t fs_id_ = 0;
 };
@@ -26,24 +26,31 @@
 
 #include "dnode.h"
 
-namespace {
-
-constexpr size_t kPageSize = static_cast<size_t>(PAGE_SIZE);
+namespace memfs {
 
+Vfs::~Vfs() {
+    // Cached lookups hold references to vnodes, which account their pages
+    // against this Vfs when they are destroyed.
+    FlushLookupCache();
 }
 
-namespace memfs {
-
 zx_status_t Vfs::CreateFromVmo(VnodeDir* parent, fbl::StringPiece name,
                                zx_handle_t vmo, zx_off_t off,
                                zx_off_t len) {
     fbl::AutoLock lock(&vfs_lock_);
-    return parent->CreateFromVmo(name, vmo, off, len);
+    zx_status_t status = parent->CreateFromVmo(name, vmo, off, len);
+    if (status == ZX_OK) {
+        InvalidateLookupLocked(parent, name);
+    }
+    return status;
 }
 
 void Vfs::MountSubtree(VnodeDir* parent, fbl::RefPtr<VnodeDir> subtree) {
     fbl::AutoLock lock(&vfs_lock_);
     parent->MountSubtree(std::move(subtree));
+    // The subtree appears under its own name, which may have been cached as
+    // missing.
+    FlushLookupCacheLocked();
 }
 
 zx_status_t Vfs::FillFsId() {
@@ -65,47 +72,46 @@ zx_status_t Vfs::FillFsId() {
     return ZX_OK;
 }
 
-zx_status_t Vfs::GrowVMO(zx::vmo& vmo, size_t current_size,
-                         size_t request_size, size_t* actual_size) {
-    if (request_size <= current_size) {
-        *actual_size = current_size;
+zx_status_t Vfs::SetSubtreePagesLimit(VnodeDir* dir, size_t pages_limit) {
+    fbl::AutoLock lock(&vfs_lock_);
+    return dir->SetPagesLimit(pages_limit);
+}
+
+PageAccount::PageAccount(size_t pages_limit, fbl::RefPtr<PageAccount> parent)
+    : pages_limit_(pages_limit), parent_(std::move(parent)) {}
+
+zx_status_t PageAccount::CheckCharge(size_t pages) const {
+    if (pages == 0) {
         return ZX_OK;
     }
-    size_t aligned_len = fbl::round_up(request_size, kPageSize);
-    ZX_DEBUG_ASSERT(current_size % kPageSize == 0);
-    size_t num_new_pages = (aligned_len - current_size) / kPageSize;
-    if (num_new_pages + num_allocated_pages_ > pages_limit_) {
-        *actual_size = current_size;
-        return ZX_ERR_NO_SPACE;
-    }
-    zx_status_t status;
-    if (!vmo.is_valid()) {
-        if ((status = zx::vmo::create(aligned_len, 0, &vmo)) != ZX_OK) {
-            return status;
-        }
-    } else {
-        if ((status = vmo.set_size(aligned_len)) != ZX_OK) {
-            return status;
+    for (const PageAccount* account = this; account != nullptr;
+         account = account->parent_.get()) {
+        if (pages + account->num_allocated_pages_ > account->PagesLimit()) {
+            return ZX_ERR_NO_SPACE;
         }
     }
-    // vmo operation succeeded
-    num_allocated_pages_ += num_new_pages;
-    *actual_size = aligned_len;
     return ZX_OK;
 }
 
-void Vfs::WillFreeVMO(size_t vmo_size) {
-    ZX_DEBUG_ASSERT(vmo_size % kPageSize == 0);
-    size_t freed_pages = vmo_size / kPageSize;
-    ZX_DEBUG_ASSERT(freed_pages <= num_allocated_pages_);
-    num_allocated_pages_ -= freed_pages;
+void PageAccount::Charge(size_t pages) {
+    for (PageAccount* account = this; account != nullptr; account = account->parent_.get()) {
+        account->num_allocated_pages_ += pages;
+    }
+}
+
+void PageAccount::Uncharge(size_t pages) {
+    for (PageAccount* account = this; account != nullptr; account = account->parent_.get()) {
+        ZX_DEBUG_ASSERT(pages <= account->num_allocated_pages_);
+        account->num_allocated_pages_ -= pages;
+    }
 }
 
 std::atomic<uint64_t> VnodeMemfs::ino_ctr_ = 0;
 std::atomic<uint64_t> VnodeMemfs::deleted_ino_ctr_ = 0;
 
-VnodeMemfs::VnodeMemfs(Vfs* vfs) : dnode_(nullptr), link_count_(0), vfs_(vfs),
-    ino_(ino_ctr_.fetch_add(1, std::memory_order_relaxed)) {
+VnodeMemfs::VnodeMemfs(Vfs* vfs, fbl::RefPtr<PageAccount> account)
+    : dnode_(nullptr), link_count_(0), vfs_(vfs), account_(std::move(account)),
+      ino_(ino_ctr_.fetch_add(1, std::memory_order_relaxed)) {
     create_time_ = modify_time_ = zx_clock_get(ZX_CLOCK_UTC);
 }
 
@@ -146,7 +152,7 @@ zx_status_t CreateFilesystem(const char* name, memfs::Vfs* vfs, fbl::RefPtr<Vnod
         return status;
     }
     fbl::AllocChecker ac;
-    fbl::RefPtr<VnodeDir> fs = fbl::AdoptRef(new (&ac) VnodeDir(vfs));
+    fbl::RefPtr<VnodeDir> fs = fbl::AdoptRef(new (&ac) VnodeDir(vfs, vfs->account_));
     if (!ac.check()) {
         return ZX_ERR_NO_MEMORY;
     }
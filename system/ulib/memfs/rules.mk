@@ -31,6 +31,7 @@ MODULE_PACKAGE_INCS := \
 MODULE_STATIC_LIBS := \
     system/ulib/async \
     system/ulib/async.cpp \
+    system/ulib/bitmap \
     system/ulib/fbl \
     system/ulib/fs \
     system/ulib/sync \
@@ -73,6 +74,7 @@ MODULE_PACKAGE_INCS := \
 MODULE_STATIC_LIBS := \
     system/ulib/async \
     system/ulib/async.cpp \
+    system/ulib/bitmap \
     system/ulib/fbl \
     system/ulib/fs \
     system/ulib/memfs.cpp \
@@ -35,7 +35,8 @@ bool WindowMatchesVMO(zx_handle_t vmo, zx_off_t offset, zx_off_t length) {
 }  // namespace
 
 VnodeVmo::VnodeVmo(Vfs* vfs, zx_handle_t vmo, zx_off_t offset, zx_off_t length)
-    : VnodeMemfs(vfs), vmo_(vmo), offset_(offset), length_(length), have_local_clone_(false) {}
+    : VnodeMemfs(vfs, nullptr), vmo_(vmo), offset_(offset), length_(length),
+      have_local_clone_(false) {}
 
 VnodeVmo::~VnodeVmo() {
     if (have_local_clone_) {
@@ -31,6 +31,10 @@ struct MountOptions {
 
     // Number of slices to preallocate for data when the filesystem is created.
     uint32_t fvm_data_slices = 1;
+
+    // Number of threads the caller runs the dispatcher on. With more than
+    // one, reads of files and directories are handled in parallel.
+    uint32_t dispatch_threads = 1;
 };
 
 // Format the partition backed by |bc| as MinFS.
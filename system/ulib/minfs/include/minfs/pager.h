@@ -0,0 +1,126 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#pragma once
+
+#ifndef __Fuchsia__
+#error Fuchsia-only Header
+#endif
+
+#include <threads.h>
+
+#include <fbl/intrusive_hash_table.h>
+#include <fbl/intrusive_single_list.h>
+#include <fbl/macros.h>
+#include <fbl/mutex.h>
+#include <fbl/unique_ptr.h>
+#include <fbl/vector.h>
+#include <lib/zx/handle.h>
+#include <lib/zx/port.h>
+#include <lib/zx/vmo.h>
+#include <minfs/bcache.h>
+#include <minfs/format.h>
+
+namespace minfs {
+
+class VnodeMinfs;
+
+// Serves the contents of vnode VMOs on demand. Rather than reading a whole
+// file into memory the first time it is accessed, each page fault on a
+// paged VMO reads the blocks around the faulting page (plus some readahead)
+// from disk, on a dedicated thread.
+//
+// A page fault blocks the thread that caused it until the fault is handled.
+// Vnode VMOs are only accessed by the filesystem's dispatcher threads (they
+// are never handed out to clients, and writeback copies out of them on a
+// dispatcher thread). Several threads may read a vnode's VMO at once, but a
+// block map is only modified by requests which exclude all others, so while
+// the pager thread reads a map to handle a fault, any thread which could
+// modify it is either blocked on that fault or waiting for it to finish.
+class Pager {
+public:
+    DISALLOW_COPY_ASSIGN_AND_MOVE(Pager);
+
+    // Number of blocks read when a block is faulted in, including the block
+    // itself, as long as the file is that long.
+    static constexpr blk_t kReadaheadBlocks = 16;
+
+    // Size of the buffer blocks are read into before they are supplied, in
+    // blocks. Larger requests are handled in several steps.
+    static constexpr blk_t kTransferBlocks = 32;
+
+    // Creates a pager, and starts the thread which handles its page faults.
+    static zx_status_t Create(Bcache* bc, fbl::unique_ptr<Pager>* out);
+    ~Pager();
+
+    // Creates a VMO of |size| bytes whose contents are read from |vnode| as
+    // they are accessed. |out_key| identifies the VMO in later calls.
+    //
+    // |DetachVmo| must be called before |vnode| is destroyed.
+    zx_status_t CreateVmo(VnodeMinfs* vnode, uint64_t size, zx::vmo* out_vmo,
+                          uint64_t* out_key);
+
+    // Stops serving faults for the VMO identified by |key|. Waits for any
+    // fault on it which is being handled to finish.
+    void DetachVmo(uint64_t key, const zx::vmo& vmo);
+
+    // Returns ZX_ERR_IO if reading any of the VMO's blocks from disk failed
+    // since the last call, and ZX_OK otherwise.
+    //
+    // So as not to block the faulting thread forever, failed reads are
+    // supplied as zeroes. This decommits them again, so that they are read
+    // from disk once more the next time they are accessed.
+    zx_status_t TakeErrors(uint64_t key, const zx::vmo& vmo);
+
+private:
+    // A range of blocks of a paged VMO.
+    struct BlockRange {
+        blk_t start;
+        blk_t count;
+    };
+
+    struct PagedVmo : public fbl::SinglyLinkedListable<fbl::unique_ptr<PagedVmo>> {
+        uint64_t GetKey() const { return key; }
+        static size_t GetHash(uint64_t key) { return key; }
+
+        uint64_t key;
+        VnodeMinfs* vnode;
+        // Owned by |vnode|.
+        zx_handle_t vmo;
+        // Blocks which were supplied as zeroes after failing to be read.
+        fbl::Vector<BlockRange> failed;
+    };
+
+    using PagedVmoTable = fbl::HashTable<uint64_t, fbl::unique_ptr<PagedVmo>>;
+
+    explicit Pager(Bcache* bc);
+
+    static int PagerThread(void* arg);
+
+    // Supplies the blocks containing the |length| bytes at |offset| in the
+    // VMO identified by |key|, and the blocks following them, up to
+    // |kReadaheadBlocks| in all.
+    void HandleRead(uint64_t key, uint64_t offset, uint64_t length);
+
+    // Reads |count| blocks of |paged| starting at |start| into the transfer
+    // buffer, and moves them into the paged VMO.
+    zx_status_t SupplyBlocks(PagedVmo* paged, blk_t start, blk_t count) __TA_REQUIRES(lock_);
+
+    Bcache* bc_;
+    zx::handle pager_;
+    zx::port port_;
+    // Unmapped, since the kernel only takes pages from VMOs without mappings.
+    zx::vmo transfer_vmo_;
+    vmoid_t transfer_vmoid_ = VMOID_INVALID;
+    thrd_t thread_;
+    bool thread_started_ = false;
+
+    // Held while a fault is handled, so that a VMO can't be detached (and
+    // its vnode destroyed) partway through.
+    fbl::Mutex lock_;
+    PagedVmoTable vmos_ __TA_GUARDED(lock_);
+    uint64_t next_key_ __TA_GUARDED(lock_) = 1;
+};
+
+} // namespace minfs
@@ -19,6 +19,7 @@
 #include <lib/fzl/resizeable-vmo-mapper.h>
 #include <lib/sync/completion.h>
 #include <lib/zx/vmo.h>
+#include <minfs/pager.h>
 #endif
 
 #include <fbl/algorithm.h>
@@ -203,6 +204,10 @@ public:
     // Returns a unique identifier for this instance.
     uint64_t GetFsId() const { return fs_id_; }
 
+    // Returns the pager which serves vnode contents, or nullptr if vnodes
+    // read their whole contents into memory instead.
+    Pager* GetPager() const { return pager_.get(); }
+
     // Signals the completion object as soon as...
     // (1) A sync probe has entered and exited the writeback queue, and
     // (2) The block cache has sync'd with the underlying block device.
@@ -273,6 +278,7 @@ private:
           fbl::unique_ptr<Allocator> block_allocator,
           fbl::unique_ptr<InodeManager> inodes,
           fbl::unique_ptr<WritebackBuffer> writeback,
+          fbl::unique_ptr<Pager> pager,
           uint64_t fs_id);
 #else
     Minfs(fbl::unique_ptr<Bcache> bc, fbl::unique_ptr<SuperblockManager> sb,
@@ -312,8 +318,11 @@ private:
     bool collecting_metrics_ = false;
 #ifdef __Fuchsia__
     fbl::Closure on_unmount_{};
+    // Read metrics may be updated by several dispatcher threads at once.
+    fbl::Mutex metrics_lock_;
     fuchsia_minfs_Metrics metrics_ = {};
     fbl::unique_ptr<WritebackBuffer> writeback_;
+    fbl::unique_ptr<Pager> pager_;
     uint64_t fs_id_ = 0;
 #else
     // Store start block + length for all extents. These may differ from info block for
@@ -383,6 +392,14 @@ public:
     // Minfs FIDL interface.
     zx_status_t GetMetrics(fidl_txn_t* txn);
     zx_status_t ToggleMetrics(bool enabled, fidl_txn_t* txn);
+
+    // Reads |count| blocks of the file, starting at block |start|, into the
+    // VMO attached as |vmoid|. Blocks which aren't allocated are left as they
+    // are in the VMO.
+    //
+    // Called by the pager to handle faults on |vmo_|, while the dispatcher
+    // thread which caused the fault is blocked on it.
+    zx_status_t ReadBlocks(vmoid_t vmoid, blk_t start, blk_t count);
 #endif
 
     // TODO(rvargas): Make private.
@@ -409,6 +426,8 @@ private:
     zx_status_t Setattr(const vnattr_t* a) final;
     zx_status_t Readdir(fs::vdircookie_t* cookie, void* dirents, size_t len,
                         size_t* out_actual) final;
+    zx_status_t ReaddirPlus(fs::vdircookie_t* cookie, void* dirents, size_t len,
+                            size_t* out_actual) final;
     zx_status_t Create(fbl::RefPtr<fs::Vnode>* out, fbl::StringPiece name,
                        uint32_t mode) final;
     zx_status_t Unlink(fbl::StringPiece name, bool must_be_dir) final;
@@ -442,6 +461,17 @@ private:
     // Enumerates directories.
     zx_status_t ForEachDirent(DirArgs* args, const DirentCallback func);
 
+    // Passes the name, type and inode number of each entry of the directory,
+    // starting from the position saved in |cookie|, to |fill| (as for a
+    // DirentFiller) until it fails for lack of space. Implements Readdir and
+    // ReaddirPlus.
+    template <typename Fill>
+    zx_status_t ReaddirInternal(fs::vdircookie_t* cookie, Fill fill);
+
+    // Reads the attributes of the inode |ino|, which is named by an entry
+    // of this directory, without instantiating a vnode for it.
+    zx_status_t GetEntryAttributes(ino_t ino, vnattr_t* a);
+
     // Directory callback functions.
     //
     // The following functions are passable to |ForEachDirent|, which reads the parent directory,
@@ -641,6 +671,11 @@ private:
     zx_status_t InitVmo();
     zx_status_t InitIndirectVmo();
 
+    // Returns ZX_ERR_IO if any blocks faulted into |vmo_| by the pager since
+    // the last call could not be read from disk. Concurrent readers hold
+    // |read_lock_| across the access and this call.
+    zx_status_t TakePageErrors();
+
     // Loads indirect blocks up to and including the doubly indirect block at |index|.
     zx_status_t LoadIndirectWithinDoublyIndirect(uint32_t index);
 
@@ -675,12 +710,21 @@ private:
 #endif
 
 #ifdef __Fuchsia__
-    // TODO(smklein): When we have can register MinFS as a pager service, and
-    // it can properly handle pages faults on a vnode's contents, then we can
-    // avoid reading the entire file up-front. Until then, read the contents of
-    // a VMO into memory when it is read/written.
+    // The contents of the file. When the filesystem has a pager, pages are
+    // read from disk as they are accessed. Otherwise, the entire file is read
+    // into memory the first time it is read or written.
+    //
+    // |vmo_lock_| is held while the VMO is created. Once it exists, it is only
+    // released by requests which exclude all others.
+    fbl::Mutex vmo_lock_;
     zx::vmo vmo_{};
     uint64_t vmo_size_ = 0;
+    // Identifies |vmo_| to the pager, or zero if it isn't paged.
+    uint64_t paged_vmo_key_ = 0;
+    // Held by readers from reading |vmo_| until they take its page errors, so
+    // that a block which failed to read is reported by the reader which
+    // faulted it in, and any other reader faults it in again.
+    fbl::Mutex read_lock_;
 
     // vmo_indirect_ contains all indirect and doubly indirect blocks in the following order:
     // First kMinfsIndirect blocks                                - initial set of indirect blocks
@@ -325,10 +325,13 @@ void Minfs::Sync(SyncCallback closure) {
 #ifdef __Fuchsia__
 Minfs::Minfs(fbl::unique_ptr<Bcache> bc, fbl::unique_ptr<SuperblockManager> sb,
              fbl::unique_ptr<Allocator> block_allocator, fbl::unique_ptr<InodeManager> inodes,
-             fbl::unique_ptr<WritebackBuffer> writeback, uint64_t fs_id)
+             fbl::unique_ptr<WritebackBuffer> writeback, fbl::unique_ptr<Pager> pager,
+             uint64_t fs_id)
     : bc_(std::move(bc)), sb_(std::move(sb)), block_allocator_(std::move(block_allocator)),
-      inodes_(std::move(inodes)), writeback_(std::move(writeback)), fs_id_(fs_id),
-      limits_(sb_->Info()) {}
+      inodes_(std::move(inodes)), writeback_(std::move(writeback)), pager_(std::move(pager)),
+      fs_id_(fs_id), limits_(sb_->Info()) {
+    EnableLookupCache();
+}
 #else
 Minfs::Minfs(fbl::unique_ptr<Bcache> bc, fbl::unique_ptr<SuperblockManager> sb,
              fbl::unique_ptr<Allocator> block_allocator, fbl::unique_ptr<InodeManager> inodes,
@@ -338,6 +341,11 @@ Minfs::Minfs(fbl::unique_ptr<Bcache> bc, fbl::unique_ptr<SuperblockManager> sb,
 #endif
 
 Minfs::~Minfs() {
+#ifdef __Fuchsia__
+    // Cached lookups hold references to vnodes, which must be released while
+    // the filesystem is still intact.
+    FlushLookupCache();
+#endif
     vnode_hash_.clear();
 }
 
@@ -821,6 +829,13 @@ zx_status_t Minfs::Create(fbl::unique_ptr<Bcache> bc, const Superblock* info,
         return status;
     }
 
+    // Without a pager, vnodes fall back to reading their entire contents
+    // when first accessed.
+    fbl::unique_ptr<Pager> pager;
+    if ((status = Pager::Create(bc.get(), &pager)) != ZX_OK) {
+        FS_TRACE_WARN("minfs: failed to create pager: %d\n", status);
+    }
+
     uint64_t id;
     status = Minfs::CreateFsId(&id);
     if (status != ZX_OK) {
@@ -829,7 +844,8 @@ zx_status_t Minfs::Create(fbl::unique_ptr<Bcache> bc, const Superblock* info,
     }
     auto fs =
         fbl::unique_ptr<Minfs>(new Minfs(std::move(bc), std::move(sb), std::move(block_allocator),
-                                         std::move(inodes), std::move(writeback), id));
+                                         std::move(inodes), std::move(writeback),
+                                         std::move(pager), id));
 #else
     auto fs =
         fbl::unique_ptr<Minfs>(new Minfs(std::move(bc), std::move(sb), std::move(block_allocator),
@@ -888,6 +904,9 @@ zx_status_t MountAndServe(const MountOptions* options, async_dispatcher_t* dispa
     Minfs* vfs = vn->fs_;
     vfs->SetReadonly(options->readonly);
     vfs->SetMetrics(options->metrics);
+    if (options->dispatch_threads > 1) {
+        vfs->EnableConcurrentDispatch();
+    }
     vfs->SetUnmountCallback(std::move(on_unmount));
     vfs->SetDispatcher(dispatcher);
     return vfs->ServeDirectory(std::move(vn), std::move(mount_channel));
@@ -1227,6 +1246,7 @@ void Minfs::UpdateInitMetrics(uint32_t dnum_count, uint32_t inum_count, uint32_t
                               uint64_t user_data_size, const fs::Duration& duration) {
 #ifdef FS_WITH_METRICS
     if (collecting_metrics_) {
+        fbl::AutoLock lock(&metrics_lock_);
         metrics_.initialized_vmos++;
         metrics_.init_user_data_size += user_data_size;
         metrics_.init_user_data_ticks += duration.get();
@@ -1260,6 +1280,7 @@ void Minfs::UpdateCreateMetrics(bool success, const fs::Duration& duration) {
 void Minfs::UpdateReadMetrics(uint64_t size, const fs::Duration& duration) {
 #ifdef FS_WITH_METRICS
     if (collecting_metrics_) {
+        fbl::AutoLock lock(&metrics_lock_);
         metrics_.read_calls++;
         metrics_.read_size += size;
         metrics_.read_ticks += duration.get();
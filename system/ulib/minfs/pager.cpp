@@ -0,0 +1,202 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <minfs/pager.h>
+
+#include <fbl/algorithm.h>
+#include <fbl/auto_lock.h>
+#include <fs/trace.h>
+#include <zircon/syscalls.h>
+#include <zircon/syscalls/port.h>
+
+#include <utility>
+
+#include "minfs-private.h"
+
+namespace minfs {
+
+zx_status_t Pager::Create(Bcache* bc, fbl::unique_ptr<Pager>* out) {
+    fbl::unique_ptr<Pager> pager(new Pager(bc));
+    zx_status_t status;
+    if ((status = zx_pager_create(0, pager->pager_.reset_and_get_address())) != ZX_OK) {
+        return status;
+    } else if ((status = zx::port::create(0, &pager->port_)) != ZX_OK) {
+        return status;
+    } else if ((status = zx::vmo::create(kTransferBlocks * kMinfsBlockSize, 0,
+                                         &pager->transfer_vmo_)) != ZX_OK) {
+        return status;
+    } else if ((status = bc->AttachVmo(pager->transfer_vmo_,
+                                       &pager->transfer_vmoid_)) != ZX_OK) {
+        return status;
+    } else if (thrd_create_with_name(&pager->thread_, Pager::PagerThread, pager.get(),
+                                     "minfs-pager") != thrd_success) {
+        return ZX_ERR_NO_RESOURCES;
+    }
+    pager->thread_started_ = true;
+    *out = std::move(pager);
+    return ZX_OK;
+}
+
+Pager::Pager(Bcache* bc) : bc_(bc) {}
+
+Pager::~Pager() {
+    if (thread_started_) {
+        // Any packet other than a page request stops the pager thread.
+        zx_port_packet_t packet = {};
+        packet.type = ZX_PKT_TYPE_USER;
+        ZX_ASSERT(port_.queue(&packet) == ZX_OK);
+        thrd_join(thread_, nullptr);
+    }
+    if (transfer_vmoid_ != VMOID_INVALID) {
+        block_fifo_request_t request;
+        request.group = bc_->BlockGroupID();
+        request.vmoid = transfer_vmoid_;
+        request.opcode = BLOCKIO_CLOSE_VMO;
+        bc_->Transaction(&request, 1);
+    }
+}
+
+zx_status_t Pager::CreateVmo(VnodeMinfs* vnode, uint64_t size, zx::vmo* out_vmo,
+                             uint64_t* out_key) {
+    fbl::AllocChecker ac;
+    fbl::unique_ptr<PagedVmo> paged(new (&ac) PagedVmo());
+    if (!ac.check()) {
+        return ZX_ERR_NO_MEMORY;
+    }
+
+    fbl::AutoLock lock(&lock_);
+    zx::vmo vmo;
+    zx_status_t status = zx_pager_create_vmo(pager_.get(), 0, port_.get(), next_key_, size,
+                                             vmo.reset_and_get_address());
+    if (status != ZX_OK) {
+        return status;
+    }
+    paged->key = next_key_++;
+    paged->vnode = vnode;
+    paged->vmo = vmo.get();
+    *out_key = paged->key;
+    *out_vmo = std::move(vmo);
+    vmos_.insert(std::move(paged));
+    return ZX_OK;
+}
+
+void Pager::DetachVmo(uint64_t key, const zx::vmo& vmo) {
+    fbl::AutoLock lock(&lock_);
+    vmos_.erase(key);
+    zx_pager_detach_vmo(pager_.get(), vmo.get());
+}
+
+zx_status_t Pager::TakeErrors(uint64_t key, const zx::vmo& vmo) {
+    fbl::AutoLock lock(&lock_);
+    auto paged = vmos_.find(key);
+    if (!paged.IsValid() || paged->failed.is_empty()) {
+        return ZX_OK;
+    }
+    for (const BlockRange& range : paged->failed) {
+        // Blocks are supplied whole, and only blocks which were missing are
+        // recorded, so none of these hold data which hasn't been written.
+        vmo.op_range(ZX_VMO_OP_DECOMMIT, range.start * kMinfsBlockSize,
+                     range.count * kMinfsBlockSize, nullptr, 0);
+    }
+    paged->failed.reset();
+    return ZX_ERR_IO;
+}
+
+int Pager::PagerThread(void* arg) {
+    Pager* pager = static_cast<Pager*>(arg);
+    for (;;) {
+        zx_port_packet_t packet;
+        zx_status_t status = pager->port_.wait(zx::time::infinite(), &packet);
+        if (status != ZX_OK) {
+            FS_TRACE_ERROR("minfs: Pager failed to wait on port: %d\n", status);
+            return -1;
+        }
+        if (packet.type != ZX_PKT_TYPE_PAGE_REQUEST) {
+            return 0;
+        }
+        // The kernel sends ZX_PAGER_VMO_COMPLETE once a VMO is detached,
+        // which needs no response.
+        if (packet.page_request.command == ZX_PAGER_VMO_READ) {
+            pager->HandleRead(packet.key, packet.page_request.offset,
+                              packet.page_request.length);
+        }
+    }
+}
+
+void Pager::HandleRead(uint64_t key, uint64_t offset, uint64_t length) {
+    TRACE_DURATION("minfs", "Pager::HandleRead", "offset", offset, "length", length);
+    fbl::AutoLock lock(&lock_);
+    auto iter = vmos_.find(key);
+    if (!iter.IsValid()) {
+        // A stale request for a VMO which has since been detached.
+        return;
+    }
+    PagedVmo* paged = &*iter;
+
+    uint64_t vmo_size;
+    if (zx_vmo_get_size(paged->vmo, &vmo_size) != ZX_OK) {
+        return;
+    }
+    // Blocks are always supplied whole, so no block is ever partly present.
+    // That lets any range of missing blocks be decommitted again on error.
+    blk_t start = static_cast<blk_t>(offset / kMinfsBlockSize);
+    blk_t end = static_cast<blk_t>(fbl::round_up(offset + length, kMinfsBlockSize) /
+                                   kMinfsBlockSize);
+    blk_t vmo_blocks = static_cast<blk_t>(vmo_size / kMinfsBlockSize);
+    blk_t readahead_end = fbl::min(start + kReadaheadBlocks, vmo_blocks);
+
+    // The faulting thread resumes once the last of the requested blocks is
+    // supplied, and may then modify the block map. Readahead is only done
+    // alongside those last blocks, so that the map is never read afterwards.
+    while (start < end) {
+        blk_t count = fbl::min(end - start, kTransferBlocks);
+        if (start + count == end) {
+            count = fbl::max(count, fbl::min(readahead_end - start, kTransferBlocks));
+        }
+        if (SupplyBlocks(paged, start, count) != ZX_OK) {
+            // The requested blocks have to be supplied for the faulting thread
+            // to continue. Supply zeroes, and fail its operation afterwards.
+            // Readahead is best effort, and is dropped.
+            count = fbl::min(count, end - start);
+            ZX_ASSERT(transfer_vmo_.op_range(ZX_VMO_OP_DECOMMIT, 0,
+                                             kTransferBlocks * kMinfsBlockSize,
+                                             nullptr, 0) == ZX_OK);
+            zx_status_t status;
+            if ((status = transfer_vmo_.op_range(ZX_VMO_OP_COMMIT, 0, count * kMinfsBlockSize,
+                                                 nullptr, 0)) != ZX_OK ||
+                (status = zx_pager_supply_pages(pager_.get(), paged->vmo,
+                                                start * kMinfsBlockSize,
+                                                count * kMinfsBlockSize,
+                                                transfer_vmo_.get(), 0)) != ZX_OK) {
+                FS_TRACE_ERROR("minfs: Failed to supply zeroes to a vnode: %d\n", status);
+                return;
+            }
+            fbl::AllocChecker ac;
+            paged->failed.push_back(BlockRange{start, count}, &ac);
+            ZX_ASSERT(ac.check());
+        }
+        start += count;
+    }
+}
+
+zx_status_t Pager::SupplyBlocks(PagedVmo* paged, blk_t start, blk_t count) {
+    // The kernel only takes committed pages from the transfer buffer. Any of
+    // the blocks which aren't allocated (holes in the file) are left as
+    // zeroes.
+    zx_status_t status = transfer_vmo_.op_range(ZX_VMO_OP_COMMIT, 0, count * kMinfsBlockSize,
+                                                nullptr, 0);
+    if (status != ZX_OK) {
+        return status;
+    }
+    if ((status = paged->vnode->ReadBlocks(transfer_vmoid_, start, count)) != ZX_OK) {
+        FS_TRACE_ERROR("minfs: Failed to read blocks [%u, %u): %d\n",
+                       start, start + count, status);
+        return status;
+    }
+    // Pages already in the VMO are kept, and their copies from disk dropped.
+    return zx_pager_supply_pages(pager_.get(), paged->vmo, start * kMinfsBlockSize,
+                                 count * kMinfsBlockSize, transfer_vmo_.get(), 0);
+}
+
+} // namespace minfs
@@ -23,7 +23,8 @@ COMMON_SRCS := \
 
 # minfs implementation
 MODULE_SRCS := \
-    $(COMMON_SRCS)
+    $(COMMON_SRCS) \
+    $(LOCAL_DIR)/pager.cpp \
 
 MODULE_STATIC_LIBS := \
     system/ulib/async \
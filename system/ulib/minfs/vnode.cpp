@@ -45,6 +45,18 @@ zx_time_t GetTimeUTC() {
     return time;
 }
 
+void InodeToAttributes(ino_t ino, const Inode& inode, vnattr_t* a) {
+    a->mode = DTYPE_TO_VTYPE(MinfsMagicType(inode.magic)) |
+            V_IRUSR | V_IWUSR | V_IRGRP | V_IROTH;
+    a->inode = ino;
+    a->size = inode.size;
+    a->blksize = kMinfsBlockSize;
+    a->blkcount = inode.block_count * (kMinfsBlockSize / VNATTR_BLKSIZE);
+    a->nlink = inode.link_count;
+    a->create_time = inode.create_time;
+    a->modify_time = inode.modify_time;
+}
+
 zx_status_t ValidateDirent(Dirent* de, size_t bytes_read, size_t off) {
     uint32_t reclen = static_cast<uint32_t>(MinfsReclen(de, off));
     if ((bytes_read < MINFS_DIRENT_SIZE) || (reclen < MINFS_DIRENT_SIZE)) {
@@ -243,20 +255,30 @@ zx_status_t VnodeMinfs::InitIndirectVmo() {
     return ZX_OK;
 }
 
-// Since we cannot yet register the filesystem as a paging service (and cleanly
-// fault on pages when they are actually needed), we currently read an entire
-// file to a VMO when a file's data block are accessed.
-//
-// TODO(smklein): Even this hack can be optimized; a bitmap could be used to
-// track all 'empty/read/dirty' blocks for each vnode, rather than reading
-// the entire file.
+// When the filesystem has a pager, the VMO is backed by it, and blocks are read
+// as they are accessed. Otherwise, we read an entire file to a VMO when a
+// file's data blocks are accessed.
 zx_status_t VnodeMinfs::InitVmo() {
+    // Readers of the same vnode may be dispatched on several threads at once,
+    // and the first of them to arrive creates the VMO.
+    fbl::AutoLock lock(&vmo_lock_);
     if (vmo_.is_valid()) {
         return ZX_OK;
     }
 
     zx_status_t status;
     const size_t vmo_size = fbl::round_up(inode_.size, kMinfsBlockSize);
+    Pager* pager = fs_->GetPager();
+    if (pager != nullptr) {
+        if ((status = pager->CreateVmo(this, vmo_size, &vmo_, &paged_vmo_key_)) != ZX_OK) {
+            FS_TRACE_ERROR("Failed to initialize paged vmo; error: %d\n", status);
+            return status;
+        }
+        vmo_size_ = vmo_size;
+        zx_object_set_property(vmo_.get(), ZX_PROP_NAME, "minfs-inode", 11);
+        return ZX_OK;
+    }
+
     if ((status = zx::vmo::create(vmo_size, 0, &vmo_)) != ZX_OK) {
         FS_TRACE_ERROR("Failed to initialize vmo; error: %d\n", status);
         return status;
@@ -363,6 +385,29 @@ zx_status_t VnodeMinfs::InitVmo() {
     ValidateVmoTail();
     return status;
 }
+
+zx_status_t VnodeMinfs::TakePageErrors() {
+    if (paged_vmo_key_ == 0) {
+        return ZX_OK;
+    }
+    return fs_->GetPager()->TakeErrors(paged_vmo_key_, vmo_);
+}
+
+zx_status_t VnodeMinfs::ReadBlocks(vmoid_t vmoid, blk_t start, blk_t count) {
+    fs::ReadTxn txn(fs_->bc_.get());
+    for (blk_t i = 0; i < count; i++) {
+        blk_t bno;
+        zx_status_t status;
+        if ((status = BlockGet(nullptr, start + i, &bno)) != ZX_OK) {
+            return status;
+        }
+        if (bno != 0) {
+            fs_->ValidateBno(bno);
+            txn.Enqueue(vmoid, i, bno + fs_->Info().dat_block, 1);
+        }
+    }
+    return txn.Transact();
+}
 #endif
 
 void VnodeMinfs::AllocateIndirect(Transaction* state, blk_t index, IndirectArgs* args) {
@@ -1110,11 +1155,16 @@ void VnodeMinfs::fbl_recycle() {
 
 VnodeMinfs::~VnodeMinfs() {
 #ifdef __Fuchsia__
+    // Stop serving faults on the VMO before the vnode goes away.
+    if (paged_vmo_key_ != 0) {
+        fs_->GetPager()->DetachVmo(paged_vmo_key_, vmo_);
+    }
+
     // Detach the vmoids from the underlying block device,
     // so the underlying VMO may be released.
     size_t request_count = 0;
     block_fifo_request_t request[2];
-    if (vmo_.is_valid()) {
+    if (vmo_.is_valid() && paged_vmo_key_ == 0) {
         request[request_count].group = fs_->bc_->BlockGroupID();
         request[request_count].vmoid = vmoid_;
         request[request_count].opcode = BLOCKIO_CLOSE_VMO;
@@ -1221,7 +1271,11 @@ zx_status_t VnodeMinfs::ReadInternal(void* data, size_t len, size_t off, size_t*
 #ifdef __Fuchsia__
     if ((status = InitVmo()) != ZX_OK) {
         return status;
-    } else if ((status = vmo_.read(data, off, len)) != ZX_OK) {
+    }
+    fbl::AutoLock lock(&read_lock_);
+    if ((status = vmo_.read(data, off, len)) != ZX_OK) {
+        return status;
+    } else if ((status = TakePageErrors()) != ZX_OK) {
         return status;
     } else {
         *actual = len;
@@ -1354,6 +1408,10 @@ zx_status_t VnodeMinfs::WriteInternal(Transaction* state, const void* data,
         // Update this block of the in-memory VMO
         if ((status = vmo_.write(data, xfer_off, xfer)) != ZX_OK) {
             break;
+        } else if ((status = TakePageErrors()) != ZX_OK) {
+            // The rest of the block couldn't be read, so it can't be written
+            // back either.
+            break;
         }
 
         // Update this block on-disk
@@ -1390,6 +1448,11 @@ zx_status_t VnodeMinfs::WriteInternal(Transaction* state, const void* data,
 
     len = (uintptr_t)data - (uintptr_t)start;
     if (len == 0) {
+#ifdef __Fuchsia__
+        if (status == ZX_ERR_IO) {
+            return status;
+        }
+#endif
         // If more than zero bytes were requested, but zero bytes were written,
         // return an error explicitly (rather than zero).
         if (off >= kMinfsMaxFileSize) {
@@ -1443,15 +1506,7 @@ zx_status_t VnodeMinfs::LookupInternal(fbl::RefPtr<fs::Vnode>* out, fbl::StringP
 
 zx_status_t VnodeMinfs::Getattr(vnattr_t* a) {
     FS_TRACE_DEBUG("minfs_getattr() vn=%p(#%u)\n", this, ino_);
-    a->mode = DTYPE_TO_VTYPE(MinfsMagicType(inode_.magic)) |
-            V_IRUSR | V_IWUSR | V_IRGRP | V_IROTH;
-    a->inode = ino_;
-    a->size = inode_.size;
-    a->blksize = kMinfsBlockSize;
-    a->blkcount = inode_.block_count * (kMinfsBlockSize / VNATTR_BLKSIZE);
-    a->nlink = inode_.link_count;
-    a->create_time = inode_.create_time;
-    a->modify_time = inode_.modify_time;
+    InodeToAttributes(ino_, inode_, a);
     return ZX_OK;
 }
 
@@ -1489,12 +1544,9 @@ struct DirCookie {
 static_assert(sizeof(DirCookie) <= sizeof(fs::vdircookie_t),
               "MinFS DirCookie too large to fit in IO state");
 
-zx_status_t VnodeMinfs::Readdir(fs::vdircookie_t* cookie, void* dirents, size_t len,
-                                size_t* out_actual) {
-    TRACE_DURATION("minfs", "VnodeMinfs::Readdir");
-    FS_TRACE_DEBUG("minfs_readdir() vn=%p(#%u) cookie=%p len=%zd\n", this, ino_, cookie, len);
+template <typename Fill>
+zx_status_t VnodeMinfs::ReaddirInternal(fs::vdircookie_t* cookie, Fill fill) {
     DirCookie* dc = reinterpret_cast<DirCookie*>(cookie);
-    fs::DirentFiller df(dirents, len);
 
     if (!IsDirectory()) {
         return ZX_ERR_NOT_SUPPORTED;
@@ -1540,7 +1592,7 @@ zx_status_t VnodeMinfs::Readdir(fs::vdircookie_t* cookie, void* dirents, size_t
 
         if (de->ino && name != "..") {
             zx_status_t status;
-            if ((status = df.Next(name, de->type, de->ino)) != ZX_OK) {
+            if ((status = fill(name, de->type, de->ino)) != ZX_OK) {
                 // no more space
                 goto done;
             }
@@ -1553,8 +1605,6 @@ done:
     // save our place in the DirCookie
     dc->off = off;
     dc->seqno = inode_.seq_num;
-    *out_actual = df.BytesFilled();
-    ZX_DEBUG_ASSERT(*out_actual <= len); // Otherwise, we're overflowing the input buffer.
     return ZX_OK;
 
 fail:
@@ -1562,6 +1612,66 @@ fail:
     return ZX_ERR_IO;
 }
 
+zx_status_t VnodeMinfs::Readdir(fs::vdircookie_t* cookie, void* dirents, size_t len,
+                                size_t* out_actual) {
+    TRACE_DURATION("minfs", "VnodeMinfs::Readdir");
+    FS_TRACE_DEBUG("minfs_readdir() vn=%p(#%u) cookie=%p len=%zd\n", this, ino_, cookie, len);
+    fs::DirentFiller df(dirents, len);
+    zx_status_t status = ReaddirInternal(cookie, [&df](fbl::StringPiece name, uint8_t type,
+                                                       ino_t ino) {
+        return df.Next(name, type, ino);
+    });
+    if (status != ZX_OK) {
+        return status;
+    }
+    *out_actual = df.BytesFilled();
+    ZX_DEBUG_ASSERT(*out_actual <= len); // Otherwise, we're overflowing the input buffer.
+    return ZX_OK;
+}
+
+zx_status_t VnodeMinfs::GetEntryAttributes(ino_t ino, vnattr_t* a) {
+    if (ino == ino_) {
+        return Getattr(a);
+    }
+    if ((ino < 1) || (ino >= fs_->Info().inode_count)) {
+        return ZX_ERR_OUT_OF_RANGE;
+    }
+    // The inode of an open vnode may have changed since it was last written
+    // to the inode table.
+    fbl::RefPtr<VnodeMinfs> vn = fs_->VnodeLookup(ino);
+    if (vn != nullptr) {
+#ifdef __Fuchsia__
+        if (vn->IsRemote()) {
+            // The attributes of a mount point are those of another filesystem.
+            return ZX_ERR_NOT_SUPPORTED;
+        }
+#endif
+        return vn->Getattr(a);
+    }
+    Inode inode;
+    fs_->InodeLoad(ino, &inode);
+    InodeToAttributes(ino, inode, a);
+    return ZX_OK;
+}
+
+zx_status_t VnodeMinfs::ReaddirPlus(fs::vdircookie_t* cookie, void* dirents, size_t len,
+                                    size_t* out_actual) {
+    TRACE_DURATION("minfs", "VnodeMinfs::ReaddirPlus");
+    fs::DirentPlusFiller df(dirents, len);
+    zx_status_t status = ReaddirInternal(cookie, [this, &df](fbl::StringPiece name,
+                                                             uint8_t type, ino_t ino) {
+        vnattr_t attr;
+        memset(&attr, 0, sizeof(attr));
+        bool valid = GetEntryAttributes(ino, &attr) == ZX_OK;
+        return df.Next(name, type, valid ? &attr : nullptr);
+    });
+    if (status != ZX_OK) {
+        return status;
+    }
+    ZX_DEBUG_ASSERT(df.BytesFilled() <= len);
+    return df.Finish(out_actual);
+}
+
 VnodeMinfs::VnodeMinfs(Minfs* fs) : fs_(fs) {}
 
 #ifdef __Fuchsia__
@@ -1788,8 +1898,8 @@ zx_status_t VnodeMinfs::Truncate(size_t len) {
 zx_status_t VnodeMinfs::TruncateInternal(Transaction* state, size_t len) {
     zx_status_t r = 0;
 #ifdef __Fuchsia__
-    // TODO(smklein): We should only init up to 'len'; no need
-    // to read in the portion of a large file we plan on deleting.
+    // Without a pager, this reads in the portion of a large file we plan on
+    // deleting.
     if ((r = InitVmo()) != ZX_OK) {
         FS_TRACE_ERROR("minfs: Truncate failed to initialize VMO: %d\n", r);
         return ZX_ERR_IO;
@@ -1834,7 +1944,8 @@ zx_status_t VnodeMinfs::TruncateInternal(Transaction* state, size_t len) {
             if (bno != 0) {
                 size_t adjust = len % kMinfsBlockSize;
 #ifdef __Fuchsia__
-                if ((r = vmo_.read(bdata, len - adjust, adjust)) != ZX_OK) {
+                if ((r = vmo_.read(bdata, len - adjust, adjust)) != ZX_OK ||
+                    (r = TakePageErrors()) != ZX_OK) {
                     FS_TRACE_ERROR("minfs: Truncate failed to read last block: %d\n", r);
                     return ZX_ERR_IO;
                 }
@@ -4,12 +4,14 @@
 
 #include "launcher.h"
 
+#include <fbl/alloc_checker.h>
 #include <fbl/string.h>
 #include <fbl/vector.h>
 #include <fuchsia/process/c/fidl.h>
 #include <lib/fidl/cpp/message_buffer.h>
 #include <lib/zx/channel.h>
 #include <lib/zx/job.h>
+#include <lib/zx/vmo.h>
 #include <stdint.h>
 #include <zircon/processargs.h>
 #include <zircon/status.h>
@@ -107,6 +109,15 @@ zx_status_t LauncherImpl::ReadAndDispatchMessage(fidl::MessageBuffer* buffer) {
     case fuchsia_process_LauncherAddHandlesOrdinal:
     case fuchsia_process_LauncherAddHandlesGenOrdinal:
         return AddHandles(std::move(message));
+    case fuchsia_process_LauncherCreateTemplateOrdinal:
+    case fuchsia_process_LauncherCreateTemplateGenOrdinal:
+        return CreateTemplate(buffer, std::move(message));
+    case fuchsia_process_LauncherLaunchFromTemplateOrdinal:
+    case fuchsia_process_LauncherLaunchFromTemplateGenOrdinal:
+        return LaunchFromTemplate(buffer, std::move(message));
+    case fuchsia_process_LauncherReleaseTemplateOrdinal:
+    case fuchsia_process_LauncherReleaseTemplateGenOrdinal:
+        return ReleaseTemplate(std::move(message));
     default:
         fprintf(stderr, "launcher: error: Unknown message ordinal: %d\n", message.ordinal());
         return ZX_ERR_NOT_SUPPORTED;
@@ -121,37 +132,13 @@ zx_status_t LauncherImpl::Launch(fidl::MessageBuffer* buffer, fidl::Message mess
         return status;
     }
 
-    zx_txid_t txid = message.txid();
-    uint32_t ordinal = message.ordinal();
-
+    fuchsia_process_LaunchInfo* info = message.GetPayloadAs<fuchsia_process_LaunchInfo>();
     launchpad_t* lp = nullptr;
-    PrepareLaunchpad(message, &lp);
-
-    fidl::Builder builder = buffer->CreateBuilder();
-    fidl_message_header_t* header = builder.New<fidl_message_header_t>();
-    header->txid = txid;
-    header->ordinal = ordinal;
-    fuchsia_process_LaunchResult* result = builder.New<fuchsia_process_LaunchResult>();
-
-    status = launchpad_go(lp, &result->process, &error_msg);
-
-    result->status = status;
-    if (status != ZX_OK && error_msg) {
-        uint32_t len = static_cast<uint32_t>(strlen(error_msg));
-        result->error_message.size = len;
-        result->error_message.data = builder.NewArray<char>(len);
-        strncpy(result->error_message.data, error_msg, len);
-    }
-
-    message.set_bytes(builder.Finalize());
-    Reset();
+    PrepareLaunchpad(zx::job(info->job), GetString(info->name), true, &lp);
+    launchpad_load_from_vmo(lp, info->executable);
 
-    status = message.Encode(&fuchsia_process_LauncherLaunchResponseTable, &error_msg);
-    if (status != ZX_OK) {
-        fprintf(stderr, "launcher: error: Launch: %s\n", error_msg);
-        return status;
-    }
-    return message.Write(channel_.get(), 0);
+    return StartAndReply(buffer, message.txid(), message.ordinal(), lp,
+                         &fuchsia_process_LauncherLaunchResponseTable);
 }
 
 zx_status_t LauncherImpl::CreateWithoutStarting(fidl::MessageBuffer* buffer, fidl::Message message) {
@@ -165,8 +152,10 @@ zx_status_t LauncherImpl::CreateWithoutStarting(fidl::MessageBuffer* buffer, fid
     zx_txid_t txid = message.txid();
     uint32_t ordinal = message.ordinal();
 
+    fuchsia_process_LaunchInfo* info = message.GetPayloadAs<fuchsia_process_LaunchInfo>();
     launchpad_t* lp = nullptr;
-    PrepareLaunchpad(message, &lp);
+    PrepareLaunchpad(zx::job(info->job), GetString(info->name), true, &lp);
+    launchpad_load_from_vmo(lp, info->executable);
 
     fidl::Builder builder = buffer->CreateBuilder();
     fidl_message_header_t* header = builder.New<fidl_message_header_t>();
@@ -266,14 +255,135 @@ zx_status_t LauncherImpl::AddHandles(fidl::Message message) {
     return ZX_OK;
 }
 
-void LauncherImpl::PrepareLaunchpad(const fidl::Message& message, launchpad_t** lp_out) {
-    fuchsia_process_LaunchInfo* info = message.GetPayloadAs<fuchsia_process_LaunchInfo>();
+zx_status_t LauncherImpl::CreateTemplate(fidl::MessageBuffer* buffer, fidl::Message message) {
+    const char* error_msg = nullptr;
+    zx_status_t status = message.Decode(&fuchsia_process_LauncherCreateTemplateRequestTable, &error_msg);
+    if (status != ZX_OK) {
+        fprintf(stderr, "launcher: error: CreateTemplate: %s\n", error_msg);
+        return status;
+    }
 
-    // Grab an owning reference to the job because launchpad does not take
-    // ownership of the job. We need to close the handle ourselves.
-    zx::job job(info->job);
-    fbl::String name = GetString(info->name);
+    zx_txid_t txid = message.txid();
+    uint32_t ordinal = message.ordinal();
 
+    uint64_t id = 0;
+    zx_status_t result = AddTemplate(zx::vmo(*message.GetPayloadAs<zx_handle_t>()), &id);
+    Reset();
+
+    fidl::Builder builder = buffer->CreateBuilder();
+    fuchsia_process_LauncherCreateTemplateResponse* response =
+        builder.New<fuchsia_process_LauncherCreateTemplateResponse>();
+    response->hdr.txid = txid;
+    response->hdr.ordinal = ordinal;
+    response->status = result;
+    response->id = id;
+    message.set_bytes(builder.Finalize());
+
+    status = message.Encode(&fuchsia_process_LauncherCreateTemplateResponseTable, &error_msg);
+    if (status != ZX_OK) {
+        fprintf(stderr, "launcher: error: CreateTemplate: %s\n", error_msg);
+        return status;
+    }
+    return message.Write(channel_.get(), 0);
+}
+
+zx_status_t LauncherImpl::LaunchFromTemplate(fidl::MessageBuffer* buffer, fidl::Message message) {
+    const char* error_msg = nullptr;
+    zx_status_t status = message.Decode(&fuchsia_process_LauncherLaunchFromTemplateRequestTable,
+                                        &error_msg);
+    if (status != ZX_OK) {
+        fprintf(stderr, "launcher: error: LaunchFromTemplate: %s\n", error_msg);
+        return status;
+    }
+
+    auto* request = reinterpret_cast<fuchsia_process_LauncherLaunchFromTemplateRequest*>(
+        message.bytes().data());
+    auto tmpl = templates_.find(request->id);
+    bool need_ldsvc = tmpl.IsValid() && launchpad_template_has_interp(tmpl->tmpl);
+    launchpad_t* lp = nullptr;
+    PrepareLaunchpad(zx::job(request->job), GetString(request->name), need_ldsvc, &lp);
+    if (tmpl.IsValid()) {
+        launchpad_load_from_template(lp, tmpl->tmpl);
+    } else {
+        launchpad_abort(lp, ZX_ERR_NOT_FOUND, "unknown template");
+    }
+
+    return StartAndReply(buffer, message.txid(), message.ordinal(), lp,
+                         &fuchsia_process_LauncherLaunchFromTemplateResponseTable);
+}
+
+zx_status_t LauncherImpl::ReleaseTemplate(fidl::Message message) {
+    const char* error_msg = nullptr;
+    zx_status_t status = message.Decode(&fuchsia_process_LauncherReleaseTemplateRequestTable,
+                                        &error_msg);
+    if (status != ZX_OK) {
+        fprintf(stderr, "launcher: error: ReleaseTemplate: %s\n", error_msg);
+        return status;
+    }
+    templates_.erase(*message.GetPayloadAs<uint64_t>());
+    return ZX_OK;
+}
+
+zx_status_t LauncherImpl::AddTemplate(zx::vmo executable, uint64_t* id) {
+    if (templates_.size() >= kMaxTemplates)
+        return ZX_ERR_NO_RESOURCES;
+
+    fbl::AllocChecker ac;
+    fbl::unique_ptr<Template> tmpl(new (&ac) Template);
+    if (!ac.check())
+        return ZX_ERR_NO_MEMORY;
+
+    // As in PrepareLaunchpad, the PT_INTERP is looked up with a synchronous
+    // call into our client's loader service, but only once per template. A
+    // binary without one needs no loader service, and one with a PT_INTERP
+    // never falls back to ours.
+    zx_status_t status = launchpad_template_create_with_loader(executable.release(),
+                                                               ldsvc_.get(), &tmpl->tmpl);
+    if (status != ZX_OK)
+        return status;
+
+    tmpl->id = next_template_id_++;
+    *id = tmpl->id;
+    templates_.insert(std::move(tmpl));
+    return ZX_OK;
+}
+
+zx_status_t LauncherImpl::StartAndReply(fidl::MessageBuffer* buffer, zx_txid_t txid,
+                                        uint32_t ordinal, launchpad_t* lp,
+                                        const fidl_type_t* response_type) {
+    fidl::Builder builder = buffer->CreateBuilder();
+    fidl_message_header_t* header = builder.New<fidl_message_header_t>();
+    header->txid = txid;
+    header->ordinal = ordinal;
+    fuchsia_process_LaunchResult* result = builder.New<fuchsia_process_LaunchResult>();
+
+    const char* error_msg = nullptr;
+    zx_status_t status = launchpad_go(lp, &result->process, &error_msg);
+
+    result->status = status;
+    if (status != ZX_OK && error_msg) {
+        uint32_t len = static_cast<uint32_t>(strlen(error_msg));
+        result->error_message.size = len;
+        result->error_message.data = builder.NewArray<char>(len);
+        strncpy(result->error_message.data, error_msg, len);
+    }
+
+    fidl::Message message = buffer->CreateEmptyMessage();
+    message.set_bytes(builder.Finalize());
+    Reset();
+
+    status = message.Encode(response_type, &error_msg);
+    if (status != ZX_OK) {
+        fprintf(stderr, "launcher: error: Launch: %s\n", error_msg);
+        return status;
+    }
+    return message.Write(channel_.get(), 0);
+}
+
+void LauncherImpl::PrepareLaunchpad(zx::job job, const fbl::String& name, bool need_ldsvc,
+                                    launchpad_t** lp_out) {
+    // We own |job| because launchpad does not take ownership of the job. It
+    // is closed when we return.
     fbl::Vector<const char*> args, environs, nametable;
     PushCStrs(args_, &args);
     PushCStrs(environs_, &environs);
@@ -283,17 +393,16 @@ void LauncherImpl::PrepareLaunchpad(const fidl::Message& message, launchpad_t**
     launchpad_t* lp = nullptr;
     launchpad_create_with_jobs(job.get(), ZX_HANDLE_INVALID, name.c_str(), &lp);
 
-    if (!ldsvc_) {
+    if (need_ldsvc && !ldsvc_) {
         launchpad_abort(lp, ZX_ERR_INVALID_ARGS, "need ldsvc to load PT_INTERP");
     }
 
     // There's a subtle issue at this point. The problem is that launchpad will
     // make a synchronous call into the loader service to read the PT_INTERP,
     // but this handle was provided by our client, which means our client can
-    // hang the launcher.
+    // hang the launcher. Loading from a template makes no such call.
     zx::channel old_ldsvc(launchpad_use_loader_service(lp, ldsvc_.release()));
 
-    launchpad_load_from_vmo(lp, info->executable);
     launchpad_set_args(lp, static_cast<int>(args.size()), args.get());
     launchpad_set_environ(lp, environs.get());
     launchpad_set_nametable(lp, nametable.size(), nametable.get());
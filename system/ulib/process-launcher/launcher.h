@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <fbl/intrusive_hash_table.h>
 #include <fbl/intrusive_single_list.h>
 #include <fbl/string.h>
 #include <fbl/unique_ptr.h>
@@ -12,6 +13,8 @@
 #include <lib/async/cpp/wait.h>
 #include <lib/fidl/cpp/message_buffer.h>
 #include <lib/zx/channel.h>
+#include <lib/zx/job.h>
+#include <lib/zx/vmo.h>
 #include <stdint.h>
 
 #include <utility>
@@ -45,8 +48,19 @@ private:
     zx_status_t AddEnvirons(fidl::Message message);
     zx_status_t AddNames(fidl::Message message);
     zx_status_t AddHandles(fidl::Message message);
+    zx_status_t CreateTemplate(fidl::MessageBuffer* buffer, fidl::Message message);
+    zx_status_t LaunchFromTemplate(fidl::MessageBuffer* buffer, fidl::Message message);
+    zx_status_t ReleaseTemplate(fidl::Message message);
 
-    void PrepareLaunchpad(const fidl::Message& message, launchpad_t** lp);
+    // Creates a launchpad for a process named |name| in |job|, with the
+    // per-launch state. The caller loads the binary into it. If |need_ldsvc|,
+    // the launch fails unless a loader service was added.
+    void PrepareLaunchpad(zx::job job, const fbl::String& name, bool need_ldsvc,
+                          launchpad_t** lp);
+    // Starts the process, and replies with its LaunchResult.
+    zx_status_t StartAndReply(fidl::MessageBuffer* buffer, zx_txid_t txid, uint32_t ordinal,
+                              launchpad_t* lp, const fidl_type_t* response_type);
+    zx_status_t AddTemplate(zx::vmo executable, uint64_t* id);
     void NotifyError(zx_status_t error);
     void Reset();
 
@@ -61,6 +75,24 @@ private:
     fbl::Vector<uint32_t> ids_;
     fbl::Vector<zx::handle> handles_;
     zx::handle ldsvc_;
+
+    // Templates made by this client: caches of its parsed executables. They
+    // are only used by the client which made them, since each may hold a
+    // PT_INTERP found with that client's loader service.
+    struct Template : public fbl::SinglyLinkedListable<fbl::unique_ptr<Template>> {
+        ~Template() { launchpad_template_destroy(tmpl); }
+
+        uint64_t GetKey() const { return id; }
+        static size_t GetHash(uint64_t id) { return id; }
+
+        uint64_t id;
+        launchpad_template_t* tmpl = nullptr;
+    };
+
+    static constexpr size_t kMaxTemplates = 64;
+
+    fbl::HashTable<uint64_t, fbl::unique_ptr<Template>> templates_;
+    uint64_t next_template_id_ = 1;
 };
 
 } // namespace launcher
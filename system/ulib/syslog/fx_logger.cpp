@@ -7,8 +7,10 @@
 #include <fbl/string_buffer.h>
 #include <zircon/assert.h>
 
+#include <lib/syslog/log_buffer.h>
 #include <lib/syslog/logger.h>
 #include <lib/syslog/wire_format.h>
+#include <lib/zx/vmar.h>
 
 #include <atomic>
 
@@ -30,6 +32,12 @@ zx_koid_t GetCurrentThreadKoid() {
 
 } // namespace
 
+fx_logger::~fx_logger() {
+    if (buffer_ != 0) {
+        zx::vmar::root_self()->unmap(buffer_, buffer_size_);
+    }
+}
+
 void fx_logger::ActivateFallback(int fallback_fd) {
     fbl::AutoLock lock(&fallback_mutex_);
     if (logger_fd_.load(std::memory_order_relaxed) != -1) {
@@ -53,26 +61,26 @@ void fx_logger::ActivateFallback(int fallback_fd) {
     logger_fd_.store(fallback_fd, std::memory_order_relaxed);
 }
 
-zx_status_t fx_logger::VLogWriteToSocket(fx_log_severity_t severity,
-                                         const char* tag, const char* msg,
-                                         va_list args, bool perform_format) {
+zx_status_t fx_logger::FormatPacket(fx_log_severity_t severity, const char* tag,
+                                    const char* msg, va_list args, bool perform_format,
+                                    fx_log_packet_t* packet, size_t* out_size,
+                                    size_t* out_msg_pos) {
     zx_time_t time = zx_clock_get_monotonic();
-    fx_log_packet_t packet;
-    memset(&packet, 0, sizeof(packet));
-    constexpr size_t kDataSize = sizeof(packet.data);
-    packet.metadata.pid = pid_;
-    packet.metadata.tid = GetCurrentThreadKoid();
-    packet.metadata.time = time;
-    packet.metadata.severity = severity;
-    packet.metadata.dropped_logs = dropped_logs_.load();
+    memset(packet, 0, sizeof(*packet));
+    constexpr size_t kDataSize = sizeof(packet->data);
+    packet->metadata.pid = pid_;
+    packet->metadata.tid = GetCurrentThreadKoid();
+    packet->metadata.time = time;
+    packet->metadata.severity = severity;
+    packet->metadata.dropped_logs = dropped_logs_.load();
 
     // Write tags
     size_t pos = 0;
     for (size_t i = 0; i < tags_.size(); i++) {
         size_t len = tags_[i].length();
         ZX_DEBUG_ASSERT(len < 128);
-        packet.data[pos++] = static_cast<char>(len);
-        memcpy(packet.data + pos, tags_[i].c_str(), len);
+        packet->data[pos++] = static_cast<char>(len);
+        memcpy(packet->data + pos, tags_[i].c_str(), len);
         pos += len;
     }
     if (tag != NULL) {
@@ -81,12 +89,12 @@ zx_status_t fx_logger::VLogWriteToSocket(fx_log_severity_t severity,
             size_t write_len =
                 fbl::min(len, static_cast<size_t>(FX_LOG_MAX_TAG_LEN - 1));
             ZX_DEBUG_ASSERT(write_len < 128);
-            packet.data[pos++] = static_cast<char>(write_len);
-            memcpy(packet.data + pos, tag, write_len);
+            packet->data[pos++] = static_cast<char>(write_len);
+            memcpy(packet->data + pos, tag, write_len);
             pos += write_len;
         }
     }
-    packet.data[pos++] = 0;
+    packet->data[pos++] = 0;
     ZX_DEBUG_ASSERT(pos < kDataSize);
     // Write msg
     int n = static_cast<int>(kDataSize - pos);
@@ -95,12 +103,12 @@ zx_status_t fx_logger::VLogWriteToSocket(fx_log_severity_t severity,
     if (!perform_format) {
         size_t write_len =
             fbl::min(strlen(msg), static_cast<size_t>(n - 1));
-        memcpy(packet.data + pos, msg, write_len);
+        memcpy(packet->data + pos, msg, write_len);
         pos += write_len;
-        packet.data[pos] = 0;
+        packet->data[pos] = 0;
         count = static_cast<int>(write_len + 1);
     } else {
-        count = vsnprintf(packet.data + pos, n, msg, args);
+        count = vsnprintf(packet->data + pos, n, msg, args);
         if (count < 0) {
             return ZX_ERR_INVALID_ARGS;
         }
@@ -109,13 +117,27 @@ zx_status_t fx_logger::VLogWriteToSocket(fx_log_severity_t severity,
         // truncated
         constexpr char kEllipsis[] = "...";
         constexpr size_t kEllipsisSize = sizeof(kEllipsis) - 1;
-        memcpy(packet.data + kDataSize - 1 - kEllipsisSize, kEllipsis,
+        memcpy(packet->data + kDataSize - 1 - kEllipsisSize, kEllipsis,
                kEllipsisSize);
         count = n - 1;
     }
-    auto size = sizeof(packet.metadata) + msg_pos + count + 1;
-    ZX_DEBUG_ASSERT(size <= sizeof(packet));
-    auto status = socket_.write(0, &packet, size, nullptr);
+    *out_size = sizeof(packet->metadata) + msg_pos + count + 1;
+    *out_msg_pos = msg_pos;
+    ZX_DEBUG_ASSERT(*out_size <= sizeof(*packet));
+    return ZX_OK;
+}
+
+zx_status_t fx_logger::VLogWriteToSocket(const zx::socket& socket, fx_log_severity_t severity,
+                                         const char* tag, const char* msg,
+                                         va_list args, bool perform_format) {
+    fx_log_packet_t packet;
+    size_t size, msg_pos;
+    zx_status_t status = FormatPacket(severity, tag, msg, args, perform_format,
+                                      &packet, &size, &msg_pos);
+    if (status != ZX_OK) {
+        return status;
+    }
+    status = socket.write(0, &packet, size, nullptr);
     if (status == ZX_ERR_BAD_STATE || status == ZX_ERR_PEER_CLOSED) {
         ActivateFallback(-1);
         return VLogWriteToFd(logger_fd_.load(std::memory_order_relaxed),
@@ -127,6 +149,87 @@ zx_status_t fx_logger::VLogWriteToSocket(fx_log_severity_t severity,
     return status;
 }
 
+zx_status_t fx_logger::VLogWriteToBuffer(fx_log_severity_t severity,
+                                         const char* tag, const char* msg,
+                                         va_list args, bool perform_format) {
+    if (buffer_reader_gone_.load(std::memory_order_acquire)) {
+        return VLogWriteToSocket(buffer_socket_, severity, tag, msg, args, perform_format);
+    }
+    fx_log_packet_t packet;
+    size_t size, msg_pos;
+    zx_status_t status = FormatPacket(severity, tag, msg, args, perform_format,
+                                      &packet, &size, &msg_pos);
+    if (status != ZX_OK) {
+        return status;
+    }
+    bool wake_reader;
+    status = fx_log_buffer_write(reinterpret_cast<void*>(buffer_), buffer_size_,
+                                 &packet, size, &wake_reader);
+    bool written = status == ZX_OK;
+    if (written && wake_reader) {
+        // Only the first record after the reader went to sleep costs a
+        // syscall.
+        status = reader_event_.signal_peer(0, ZX_USER_SIGNAL_0);
+    } else if (status == ZX_ERR_SHOULD_WAIT) {
+        // The buffer is full. Check whether that's because the reader is gone.
+        zx_signals_t pending;
+        if (reader_event_.wait_one(ZX_EVENTPAIR_PEER_CLOSED, zx::time(), &pending) == ZX_OK) {
+            status = ZX_ERR_PEER_CLOSED;
+        }
+    }
+    if (status == ZX_OK && buffer_reader_gone_.load(std::memory_order_seq_cst)) {
+        // Another thread switched to the socket while we wrote our record,
+        // and may have drained the buffer before it was committed.
+        fbl::AutoLock lock(&fallback_mutex_);
+        DrainBufferToSocketLocked();
+    }
+    if (status == ZX_ERR_PEER_CLOSED) {
+        if (ActivateSocketFallback()) {
+            // A record in the buffer was sent with the rest of them.
+            return written ? ZX_OK
+                           : buffer_socket_.write(0, &packet, size, nullptr);
+        }
+        ActivateFallback(-1);
+        return VLogWriteToFd(logger_fd_.load(std::memory_order_relaxed),
+                             severity, tag, packet.data + msg_pos, args, false);
+    }
+    if (status != ZX_OK) {
+        dropped_logs_.fetch_add(1);
+    }
+    return status;
+}
+
+bool fx_logger::ActivateSocketFallback() {
+    fbl::AutoLock lock(&fallback_mutex_);
+    if (buffer_reader_gone_.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    if (buffer_connect_socket_ == nullptr) {
+        return false;
+    }
+    zx::socket socket = buffer_connect_socket_();
+    if (!socket.is_valid()) {
+        return false;
+    }
+    buffer_socket_ = std::move(socket);
+    // This pairs with the check writers make after committing a record, so
+    // that either we drain their record, or they drain it themselves.
+    buffer_reader_gone_.store(true, std::memory_order_seq_cst);
+    DrainBufferToSocketLocked();
+    return true;
+}
+
+void fx_logger::DrainBufferToSocketLocked() {
+    auto send = [](const fx_log_packet_t* packet, size_t size, void* ctx) {
+        // Copy the record out of the buffer, which we share with whoever
+        // else has the VMO, before sending it.
+        fx_log_packet_t copy;
+        memcpy(&copy, packet, size);
+        static_cast<zx::socket*>(ctx)->write(0, &copy, size, nullptr);
+    };
+    fx_log_buffer_drain(reinterpret_cast<void*>(buffer_), buffer_size_, send, &buffer_socket_);
+}
+
 zx_status_t fx_logger::VLogWriteToFd(int fd, fx_log_severity_t severity,
                                      const char* tag, const char* msg,
                                      va_list args, bool perform_format) {
@@ -205,7 +308,9 @@ zx_status_t fx_logger::VLogWrite(fx_log_severity_t severity, const char* tag,
     if (fd != -1) {
         status = VLogWriteToFd(fd, severity, tag, msg, args, perform_format);
     } else if (socket_.is_valid()) {
-        status = VLogWriteToSocket(severity, tag, msg, args, perform_format);
+        status = VLogWriteToSocket(socket_, severity, tag, msg, args, perform_format);
+    } else if (buffer_ != 0) {
+        status = VLogWriteToBuffer(severity, tag, msg, args, perform_format);
     } else {
         return ZX_ERR_BAD_STATE;
     }
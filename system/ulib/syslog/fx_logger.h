@@ -6,11 +6,13 @@
 #define ZIRCON_SYSTEM_ULIB_SYSLOG_FX_LOGGER_H_
 
 #include <lib/syslog/logger.h>
+#include <lib/syslog/wire_format.h>
 
 #include <fbl/mutex.h>
 #include <fbl/string.h>
 #include <fbl/unique_fd.h>
 #include <fbl/vector.h>
+#include <lib/zx/eventpair.h>
 #include <lib/zx/process.h>
 #include <lib/zx/socket.h>
 #include <lib/zx/thread.h>
@@ -39,18 +41,31 @@ public:
     // If tags or ntags are out of bound, this constructor will not fail but it
     // will not store all the tags and global tag behaviour would be undefined.
     // So they should be validated before calling this constructor.
-    fx_logger(const fx_logger_config_t* config) {
+    //
+    // If |buffer| is not zero, the logger writes to the shared log buffer of
+    // |buffer_size| bytes mapped there, and unmaps it when destroyed. If
+    // |connect_socket| is not null, the logger calls it to reconnect to the
+    // log service over a socket when the buffer's reader goes away; it
+    // returns an invalid socket if that fails.
+    fx_logger(const fx_logger_config_t* config, uintptr_t buffer = 0, size_t buffer_size = 0,
+              zx::eventpair reader_event = zx::eventpair(),
+              zx::socket (*connect_socket)() = nullptr) {
         pid_ = GetCurrentProcessKoid();
         socket_.reset(config->log_service_channel);
         fd_to_close_.reset(config->console_fd);
         logger_fd_.store(config->console_fd, std::memory_order_relaxed);
+        buffer_ = buffer;
+        buffer_size_ = buffer_size;
+        reader_event_ = std::move(reader_event);
+        buffer_connect_socket_ = connect_socket;
         SetSeverity(config->min_severity);
-        ZX_DEBUG_ASSERT(fd_to_close_ != socket_.is_valid());
+        ZX_DEBUG_ASSERT(static_cast<bool>(fd_to_close_) + socket_.is_valid() +
+                            (buffer_ != 0) == 1);
         AddTags(config->tags, config->num_tags);
         dropped_logs_.store(0, std::memory_order_relaxed);
     }
 
-    ~fx_logger() = default;
+    ~fx_logger();
 
     zx_status_t VLogWrite(fx_log_severity_t severity, const char* tag,
                           const char* format, va_list args) {
@@ -77,9 +92,28 @@ private:
     zx_status_t VLogWrite(fx_log_severity_t severity, const char* tag,
                           const char* format, va_list args, bool perform_format);
 
-    zx_status_t VLogWriteToSocket(fx_log_severity_t severity, const char* tag,
+    // Formats a packet for the log service, and returns the number of bytes
+    // of it to send in |out_size|, and the offset of the message in
+    // |out_msg_pos|.
+    zx_status_t FormatPacket(fx_log_severity_t severity, const char* tag,
+                             const char* msg, va_list args, bool perform_format,
+                             fx_log_packet_t* packet, size_t* out_size, size_t* out_msg_pos);
+
+    zx_status_t VLogWriteToSocket(const zx::socket& socket, fx_log_severity_t severity,
+                                  const char* tag, const char* msg, va_list args,
+                                  bool perform_format);
+
+    zx_status_t VLogWriteToBuffer(fx_log_severity_t severity, const char* tag,
                                   const char* msg, va_list args, bool perform_format);
 
+    // Switches a logger whose buffer's reader has gone to |buffer_socket_|,
+    // and sends it the records left in the buffer. Returns false if the
+    // logger can't, and should fall back to an fd instead.
+    bool ActivateSocketFallback();
+
+    // Sends the committed records in the buffer to |buffer_socket_|.
+    void DrainBufferToSocketLocked() __TA_REQUIRES(fallback_mutex_);
+
     zx_status_t VLogWriteToFd(int fd, fx_log_severity_t severity, const char* tag,
                               const char* msg, va_list args, bool perform_format);
 
@@ -92,6 +126,17 @@ private:
     zx::socket socket_;
     fbl::Vector<fbl::String> tags_;
 
+    // The mapping of the shared log buffer, if the logger writes to one, and
+    // the logger's end of the eventpair used to wake its reader.
+    uintptr_t buffer_ = 0;
+    size_t buffer_size_ = 0;
+    zx::eventpair reader_event_;
+    zx::socket (*buffer_connect_socket_)() = nullptr;
+    // Set once the buffer's reader has gone and records go to
+    // |buffer_socket_| instead, which doesn't change after that.
+    std::atomic<bool> buffer_reader_gone_{false};
+    zx::socket buffer_socket_;
+
     // This field is just used to close fd when
     // logger object goes out of scope
     fbl::unique_fd fd_to_close_;
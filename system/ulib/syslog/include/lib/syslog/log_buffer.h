@@ -0,0 +1,68 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// This header contains the operations on a shared log buffer, whose layout is
+// defined in <lib/syslog/wire_format.h>. A logger writes into the buffer
+// instead of sending each message over a socket, and the log service drains
+// it in batches.
+//
+// Neither side trusts the other: every operation checks the buffer's header
+// against |size|, the size of the caller's mapping of the buffer.
+
+#ifndef LIB_SYSLOG_LOG_BUFFER_H_
+#define LIB_SYSLOG_LOG_BUFFER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#include <lib/syslog/wire_format.h>
+#include <zircon/compiler.h>
+#include <zircon/types.h>
+
+__BEGIN_CDECLS
+
+// Formats the |size| bytes at |buffer| as an empty shared log buffer.
+//
+// Returns |ZX_ERR_INVALID_ARGS| if |buffer| isn't 8-byte aligned, or is too
+// small to hold a packet of the maximum size.
+zx_status_t fx_log_buffer_init(void* buffer, size_t size);
+
+// Appends the first |packet_size| bytes of |packet| to the shared log buffer
+// at |buffer|. May be called by any number of threads and processes at once;
+// records written by one thread are read in the order they were written.
+//
+// Sets |*out_wake_reader| to true if the reader asked to be woken, and the
+// caller should now signal it.
+//
+// Returns |ZX_ERR_SHOULD_WAIT| if the buffer is full, and
+// |ZX_ERR_INVALID_ARGS| if the buffer is malformed.
+zx_status_t fx_log_buffer_write(void* buffer, size_t size, const fx_log_packet_t* packet,
+                                size_t packet_size, bool* out_wake_reader);
+
+// Called by |fx_log_buffer_drain()| with each log record, and the size of
+// the packet the writer wrote, rounded up to a multiple of 8 with zeroes.
+// The packet is in shared memory, and may change under the callback.
+typedef void (*fx_log_buffer_callback_t)(const fx_log_packet_t* packet, size_t packet_size,
+                                         void* ctx);
+
+// Passes each committed record in the shared log buffer at |buffer| to
+// |callback|, in the order the records were reserved, and frees their space.
+// Stops at the first record which isn't committed yet. Only one thread may
+// drain a buffer at a time.
+//
+// Returns the number of records passed to |callback|, or a negative status
+// if the buffer is malformed.
+ssize_t fx_log_buffer_drain(void* buffer, size_t size, fx_log_buffer_callback_t callback,
+                            void* ctx);
+
+// Asks the next writer to commit a record to wake the reader of the shared log
+// buffer at |buffer|. Returns false without asking if there are records to
+// drain already, so the reader can drain and arm again rather than sleep
+// with records pending, or if the buffer is malformed.
+bool fx_log_buffer_arm(void* buffer, size_t size);
+
+__END_CDECLS
+
+#endif // LIB_SYSLOG_LOG_BUFFER_H_
@@ -67,6 +67,29 @@ typedef struct fx_logger fx_logger_t;
 zx_status_t fx_logger_create(const fx_logger_config_t* config,
                              fx_logger_t** out_logger);
 
+// Creates a logger object which writes log messages into a shared log buffer
+// (see <lib/syslog/log_buffer.h>) rather than sending each one over a socket,
+// and wakes the buffer's reader only when it asked to be woken.
+//
+// |buffer_vmo| holds the buffer, which must already be formatted and must not
+// be resizable, and |reader_event| is the logger's end of an eventpair whose
+// peer belongs to the reader. If both are |ZX_HANDLE_INVALID|, this function
+// creates a buffer and connects it to the log service, falling back to
+// |fx_logger_create()| if that fails. Messages are dropped and counted while
+// the buffer is full.
+//
+// If the reader closes its end of the eventpair, a logger which connected the
+// buffer itself reconnects to the log service over a socket, and sends it the
+// records left in the buffer. Otherwise it falls back to stderr.
+//
+// |config| must not specify |console_fd| or |log_service_channel|.
+// Returns |ZX_ERR_INVALID_ARGS| if it does, or if only one of |buffer_vmo| and
+// |reader_event| is valid. Takes ownership of both handles.
+zx_status_t fx_logger_create_with_buffer(const fx_logger_config_t* config,
+                                         zx_handle_t buffer_vmo,
+                                         zx_handle_t reader_event,
+                                         fx_logger_t** out_logger);
+
 // Destroys a logger object.
 //
 // This closes |console_fd| or |log_service_channel| which were passed in
@@ -8,6 +8,7 @@
 #define LIB_SYSLOG_WIRE_FORMAT_H_
 
 #include <lib/syslog/logger.h>
+#include <stdint.h>
 #include <zircon/types.h>
 
 // Defines max length for storing log_metadata, tags and msgbuffer.
@@ -35,4 +36,54 @@ typedef struct fx_log_packet {
     char data[FX_LOG_MAX_DATAGRAM_LEN - sizeof(fx_log_metadata_t)];
 } fx_log_packet_t;
 
+// A shared log buffer is a VMO holding a ring of records, which any number of
+// writers append to and one reader drains. It starts with this header, and
+// the ring of |capacity| bytes follows it.
+//
+// Writers reserve space by advancing |write_offset|, copy their record in,
+// and then commit it by setting |FX_LOG_RECORD_COMMITTED| in its header. The
+// reader consumes committed records in the order their space was reserved,
+// zeroes them, and advances |read_offset|, so a record header which isn't
+// committed yet always reads as zero. Both offsets only ever increase; the
+// position in the ring is the offset modulo |capacity|.
+//
+// All of these fields are accessed atomically.
+#define FX_LOG_BUFFER_MAGIC (UINT64_C(0x7265666675426f4c)) // "LoBuffer"
+
+typedef struct fx_log_buffer_header {
+    uint64_t magic;
+
+    // Size of the ring in bytes, a multiple of 8.
+    uint64_t capacity;
+
+    // Nonzero if the reader asked to be woken when a record is committed.
+    // The writer which clears it signals |ZX_USER_SIGNAL_0| on the reader's
+    // end of the eventpair which came with the buffer.
+    uint64_t reader_waiting;
+
+    uint64_t reserved0[5];
+
+    // Bytes reserved by writers. On its own cache line, as all writers
+    // update it.
+    uint64_t write_offset;
+    uint64_t reserved1[7];
+
+    // Bytes consumed by the reader.
+    uint64_t read_offset;
+    uint64_t reserved2[7];
+} fx_log_buffer_header_t;
+
+// The largest shared log buffer, including its header, in bytes. The log
+// service maps each client's buffer, so it refuses larger ones.
+#define FX_LOG_BUFFER_MAX_SIZE (UINT64_C(1) << 20)
+
+// Each record starts with a 64-bit header word, holding the size of the
+// record in bytes including the header, which is a multiple of 8, and flags.
+// A log record's header is followed by an |fx_log_packet_t| truncated to
+// the length of its message, and padding. A record which doesn't fit before
+// the end of the ring is preceded by a padding record filling the rest of it.
+#define FX_LOG_RECORD_SIZE_MASK (UINT64_C(0xffffffff))
+#define FX_LOG_RECORD_COMMITTED (UINT64_C(1) << 32)
+#define FX_LOG_RECORD_PADDING (UINT64_C(1) << 33)
+
 #endif // LIB_SYSLOG_WIRE_FORMAT_H_
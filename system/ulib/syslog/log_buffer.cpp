@@ -0,0 +1,155 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <lib/syslog/log_buffer.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include <fbl/algorithm.h>
+
+namespace {
+
+constexpr size_t kRecordHeaderSize = sizeof(uint64_t);
+
+// Returns the header of a well-formed buffer, or nullptr. The capacity is
+// returned separately, as the other side could change the header's copy.
+fx_log_buffer_header_t* GetHeader(void* buffer, size_t size, uint64_t* out_capacity) {
+    if (size < sizeof(fx_log_buffer_header_t)) {
+        return nullptr;
+    }
+    auto* header = static_cast<fx_log_buffer_header_t*>(buffer);
+    uint64_t magic = __atomic_load_n(&header->magic, __ATOMIC_RELAXED);
+    uint64_t capacity = __atomic_load_n(&header->capacity, __ATOMIC_RELAXED);
+    if (magic != FX_LOG_BUFFER_MAGIC || capacity % 8 != 0 ||
+        capacity < kRecordHeaderSize + sizeof(fx_log_packet_t) ||
+        capacity > size - sizeof(fx_log_buffer_header_t)) {
+        return nullptr;
+    }
+    *out_capacity = capacity;
+    return header;
+}
+
+uint64_t* GetRecord(fx_log_buffer_header_t* header, uint64_t capacity, uint64_t offset) {
+    auto* ring = reinterpret_cast<uint8_t*>(header + 1);
+    return reinterpret_cast<uint64_t*>(ring + offset % capacity);
+}
+
+} // namespace
+
+zx_status_t fx_log_buffer_init(void* buffer, size_t size) {
+    if (reinterpret_cast<uintptr_t>(buffer) % 8 != 0 || size < sizeof(fx_log_buffer_header_t)) {
+        return ZX_ERR_INVALID_ARGS;
+    }
+    uint64_t capacity = fbl::round_down(size - sizeof(fx_log_buffer_header_t), 8u);
+    if (capacity < kRecordHeaderSize + sizeof(fx_log_packet_t)) {
+        return ZX_ERR_INVALID_ARGS;
+    }
+    memset(buffer, 0, sizeof(fx_log_buffer_header_t) + capacity);
+    auto* header = static_cast<fx_log_buffer_header_t*>(buffer);
+    header->magic = FX_LOG_BUFFER_MAGIC;
+    header->capacity = capacity;
+    return ZX_OK;
+}
+
+zx_status_t fx_log_buffer_write(void* buffer, size_t size, const fx_log_packet_t* packet,
+                                size_t packet_size, bool* out_wake_reader) {
+    *out_wake_reader = false;
+    uint64_t capacity;
+    fx_log_buffer_header_t* header = GetHeader(buffer, size, &capacity);
+    if (header == nullptr || packet_size > sizeof(fx_log_packet_t)) {
+        return ZX_ERR_INVALID_ARGS;
+    }
+    uint64_t record_size = fbl::round_up(kRecordHeaderSize + packet_size, 8u);
+
+    // Reserve space for the record, and for padding if it would otherwise
+    // wrap around the end of the ring. The acquire load of |read_offset|
+    // orders our writes after the reader's zeroing of the space it freed.
+    uint64_t offset = __atomic_load_n(&header->write_offset, __ATOMIC_RELAXED);
+    uint64_t padding;
+    do {
+        uint64_t read_offset = __atomic_load_n(&header->read_offset, __ATOMIC_ACQUIRE);
+        uint64_t room_before_end = capacity - offset % capacity;
+        padding = room_before_end < record_size ? room_before_end : 0u;
+        if (offset - read_offset + padding + record_size > capacity) {
+            return ZX_ERR_SHOULD_WAIT;
+        }
+    } while (!__atomic_compare_exchange_n(&header->write_offset, &offset,
+                                          offset + padding + record_size, true,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    if (padding != 0u) {
+        __atomic_store_n(GetRecord(header, capacity, offset),
+                         padding | FX_LOG_RECORD_COMMITTED | FX_LOG_RECORD_PADDING,
+                         __ATOMIC_RELEASE);
+        offset += padding;
+    }
+    uint64_t* record = GetRecord(header, capacity, offset);
+    memcpy(record + 1, packet, packet_size);
+    // Commit the record. This also needs to be ordered before the load of
+    // |reader_waiting| below, which pairs with |fx_log_buffer_arm()|.
+    __atomic_store_n(record, record_size | FX_LOG_RECORD_COMMITTED, __ATOMIC_SEQ_CST);
+
+    if (__atomic_load_n(&header->reader_waiting, __ATOMIC_SEQ_CST) != 0u) {
+        *out_wake_reader = __atomic_exchange_n(&header->reader_waiting, 0u,
+                                               __ATOMIC_SEQ_CST) != 0u;
+    }
+    return ZX_OK;
+}
+
+ssize_t fx_log_buffer_drain(void* buffer, size_t size, fx_log_buffer_callback_t callback,
+                            void* ctx) {
+    uint64_t capacity;
+    fx_log_buffer_header_t* header = GetHeader(buffer, size, &capacity);
+    if (header == nullptr) {
+        return ZX_ERR_INVALID_ARGS;
+    }
+    uint64_t offset = __atomic_load_n(&header->read_offset, __ATOMIC_RELAXED);
+    // Drain at most one ring's worth, so writers can't keep us here.
+    uint64_t end_offset = offset + fbl::min(capacity, __atomic_load_n(&header->write_offset,
+                                                                      __ATOMIC_RELAXED) - offset);
+
+    ssize_t count = 0;
+    zx_status_t status = ZX_OK;
+    while (offset != end_offset) {
+        uint64_t* record = GetRecord(header, capacity, offset);
+        uint64_t record_header = __atomic_load_n(record, __ATOMIC_ACQUIRE);
+        if (!(record_header & FX_LOG_RECORD_COMMITTED)) {
+            break;
+        }
+        uint64_t record_size = record_header & FX_LOG_RECORD_SIZE_MASK;
+        if (record_size < kRecordHeaderSize || record_size % 8 != 0 ||
+            record_size > capacity - offset % capacity ||
+            record_size > end_offset - offset) {
+            status = ZX_ERR_IO_DATA_INTEGRITY;
+            break;
+        }
+        if (!(record_header & FX_LOG_RECORD_PADDING)) {
+            size_t packet_size = fbl::min(record_size - kRecordHeaderSize,
+                                          sizeof(fx_log_packet_t));
+            callback(reinterpret_cast<const fx_log_packet_t*>(record + 1), packet_size, ctx);
+            count++;
+        }
+        memset(record, 0, record_size);
+        offset += record_size;
+    }
+    __atomic_store_n(&header->read_offset, offset, __ATOMIC_RELEASE);
+    return status == ZX_OK ? count : status;
+}
+
+bool fx_log_buffer_arm(void* buffer, size_t size) {
+    uint64_t capacity;
+    fx_log_buffer_header_t* header = GetHeader(buffer, size, &capacity);
+    if (header == nullptr) {
+        return false;
+    }
+    __atomic_store_n(&header->reader_waiting, 1u, __ATOMIC_SEQ_CST);
+    uint64_t offset = __atomic_load_n(&header->read_offset, __ATOMIC_RELAXED);
+    uint64_t* record = GetRecord(header, capacity, offset);
+    if (__atomic_load_n(record, __ATOMIC_SEQ_CST) & FX_LOG_RECORD_COMMITTED) {
+        __atomic_store_n(&header->reader_waiting, 0u, __ATOMIC_RELAXED);
+        return false;
+    }
+    return true;
+}
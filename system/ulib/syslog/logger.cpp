@@ -4,7 +4,11 @@
 
 #include <lib/fdio/util.h>
 #include <lib/zx/channel.h>
+#include <lib/zx/eventpair.h>
 #include <lib/zx/socket.h>
+#include <lib/zx/vmar.h>
+#include <lib/zx/vmo.h>
+#include <lib/syslog/log_buffer.h>
 #include <lib/syslog/logger.h>
 
 // TODO: Remove this hack once FIDL-182  is fixed.
@@ -40,6 +44,83 @@ zx::socket connect_to_logger() {
     return local;
 }
 
+// Size of the shared log buffer created by |fx_logger_create_with_buffer()|.
+constexpr size_t kDefaultBufferSize = 64 * 1024;
+
+// Maps the shared log buffer in |vmo|, which must not be resizable: neither
+// side may be able to shrink the buffer under the other's mapping. The log
+// service won't take one larger than FX_LOG_BUFFER_MAX_SIZE.
+zx_status_t map_buffer(const zx::vmo& vmo, uintptr_t* out_buffer, size_t* out_size) {
+    uint64_t size;
+    zx_status_t status = vmo.get_size(&size);
+    if (status != ZX_OK) {
+        return status;
+    }
+    if (size > FX_LOG_BUFFER_MAX_SIZE) {
+        return ZX_ERR_INVALID_ARGS;
+    }
+    status = zx::vmar::root_self()->map(0, vmo, 0, size,
+                                        ZX_VM_PERM_READ | ZX_VM_PERM_WRITE |
+                                            ZX_VM_REQUIRE_NON_RESIZABLE,
+                                        out_buffer);
+    if (status != ZX_OK) {
+        return status;
+    }
+    *out_size = size;
+    return ZX_OK;
+}
+
+zx_status_t connect_to_logger_with_buffer(zx::vmo* out_vmo, zx::eventpair* out_event) {
+    zx::vmo vmo;
+    zx_status_t status = zx::vmo::create(kDefaultBufferSize, ZX_VMO_NON_RESIZABLE, &vmo);
+    if (status != ZX_OK) {
+        return status;
+    }
+    uintptr_t buffer;
+    size_t size;
+    if ((status = map_buffer(vmo, &buffer, &size)) != ZX_OK) {
+        return status;
+    }
+    status = fx_log_buffer_init(reinterpret_cast<void*>(buffer), size);
+    // Have the first record wake the service, so that we find out straight
+    // away if it has gone, or didn't accept the buffer.
+    if (status == ZX_OK) {
+        fx_log_buffer_arm(reinterpret_cast<void*>(buffer), size);
+    }
+    zx::vmar::root_self()->unmap(buffer, size);
+    if (status != ZX_OK) {
+        return status;
+    }
+
+    zx::vmo service_vmo;
+    zx::eventpair local, remote;
+    if ((status = vmo.duplicate(ZX_RIGHT_SAME_RIGHTS, &service_vmo)) != ZX_OK ||
+        (status = zx::eventpair::create(0, &local, &remote)) != ZX_OK) {
+        return status;
+    }
+    zx::channel logger, logger_request;
+    if ((status = zx::channel::create(0, &logger, &logger_request)) != ZX_OK) {
+        return status;
+    }
+    status = fdio_service_connect("/svc/fuchsia.logger.LogSink", logger_request.release());
+    if (status != ZX_OK) {
+        return status;
+    }
+    fuchsia_logger_LogSinkConnectBufferRequest req;
+    memset(&req, 0, sizeof(req));
+    req.hdr.ordinal = fuchsia_logger_LogSinkConnectBufferOrdinal;
+    req.buffer = FIDL_HANDLE_PRESENT;
+    req.reader_event = FIDL_HANDLE_PRESENT;
+    // The handles are consumed even if the write fails.
+    zx_handle_t handles[2] = {service_vmo.release(), remote.release()};
+    if ((status = logger.write(0, &req, sizeof(req), handles, 2)) != ZX_OK) {
+        return status;
+    }
+    *out_vmo = std::move(vmo);
+    *out_event = std::move(local);
+    return ZX_OK;
+}
+
 } // namespace
 zx_status_t fx_logger_logf(fx_logger_t* logger, fx_log_severity_t severity,
                            const char* tag, const char* format, ...) {
@@ -109,6 +190,34 @@ zx_status_t fx_logger_create(const fx_logger_config_t* config,
     return ZX_OK;
 }
 
+zx_status_t fx_logger_create_with_buffer(const fx_logger_config_t* config,
+                                         zx_handle_t buffer_vmo,
+                                         zx_handle_t reader_event,
+                                         fx_logger_t** out_logger) {
+    zx::vmo vmo(buffer_vmo);
+    zx::eventpair event(reader_event);
+    if (config->num_tags > FX_LOG_MAX_TAGS || config->console_fd != -1 ||
+        config->log_service_channel != ZX_HANDLE_INVALID ||
+        vmo.is_valid() != event.is_valid()) {
+        return ZX_ERR_INVALID_ARGS;
+    }
+    // A logger which connected the buffer itself can reconnect to the log
+    // service over a socket if the buffer's reader goes away.
+    bool socket_fallback = !vmo.is_valid();
+    if (socket_fallback && connect_to_logger_with_buffer(&vmo, &event) != ZX_OK) {
+        return fx_logger_create(config, out_logger);
+    }
+    uintptr_t buffer;
+    size_t size;
+    zx_status_t status = map_buffer(vmo, &buffer, &size);
+    if (status != ZX_OK) {
+        return status;
+    }
+    *out_logger = new fx_logger(config, buffer, size, std::move(event),
+                                socket_fallback ? connect_to_logger : nullptr);
+    return ZX_OK;
+}
+
 void fx_logger_destroy(fx_logger_t* logger) {
     delete logger;
 }
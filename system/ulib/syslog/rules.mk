@@ -12,6 +12,7 @@ MODULE_SRCS = \
     $(LOCAL_DIR)/fx_logger.h \
     $(LOCAL_DIR)/fx_logger.cpp \
     $(LOCAL_DIR)/global.cpp \
+    $(LOCAL_DIR)/log_buffer.cpp \
     $(LOCAL_DIR)/logger.cpp \
 
 MODULE_EXPORT := so
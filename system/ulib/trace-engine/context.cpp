@@ -70,12 +70,25 @@
 // Note that the handler is free to save buffers at whatever rate it can
 // manage. The protocol allows for records to be dropped if buffers can't be
 // saved fast enough.
+//
+// Thread buffers:
+// With |TRACE_ENGINE_OPTION_THREAD_BUFFERS|, which applies to all three
+// modes, each thread writes its non-durable records into a small buffer of
+// its own, without atomic operations. When the next record doesn't fit, the
+// thread allocates space for all of the buffer's records from the rolling
+// buffer at once, and copies them there. This trades a copy for one atomic
+// allocation per batch instead of per record, which is what threads contend
+// on when many of them trace heavily. The records left in thread buffers are
+// handed off when tracing stops, once no thread is writing any more.
 
 #include "context_impl.h"
 
 #include <assert.h>
 #include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
 
+#include <fbl/algorithm.h>
 #include <fbl/auto_lock.h>
 #include <trace-engine/fields.h>
 #include <trace-engine/handler.h>
@@ -88,12 +101,18 @@ namespace {
 // The next context generation number.
 std::atomic<uint32_t> g_next_generation{1u};
 
+// This thread's buffer, and the generation of the context it belongs to.
+// The buffer is owned by that context, so it is only valid while the
+// generations match.
+thread_local void* tls_thread_buffer{nullptr};
+thread_local uint32_t tls_thread_buffer_generation{0u};
+
 } // namespace
 } // namespace trace
 
 trace_context::trace_context(void* buffer, size_t buffer_num_bytes,
                              trace_buffering_mode_t buffering_mode,
-                             trace_handler_t* handler)
+                             bool thread_buffers, trace_handler_t* handler)
     : generation_(trace::g_next_generation.fetch_add(1u, std::memory_order_relaxed) + 1u),
       buffering_mode_(buffering_mode),
       buffer_start_(reinterpret_cast<uint8_t*>(buffer)),
@@ -104,9 +123,19 @@ trace_context::trace_context(void* buffer, size_t buffer_num_bytes,
     ZX_DEBUG_ASSERT(buffer_num_bytes <= kMaxPhysicalBufferSize);
     ZX_DEBUG_ASSERT(generation_ != 0u);
     ComputeBufferSizes();
+    if (thread_buffers) {
+        thread_buffer_size_ = fbl::min(kMaxThreadBufferSize, (rolling_buffer_size_ / 4) & ~7ul);
+    }
 }
 
-trace_context::~trace_context() = default;
+trace_context::~trace_context() {
+    fbl::AutoLock lock(&thread_buffers_mutex_);
+    while (thread_buffers_) {
+        ThreadBuffer* next = thread_buffers_->next;
+        free(thread_buffers_);
+        thread_buffers_ = next;
+    }
+}
 
 uint64_t* trace_context::AllocRecord(size_t num_bytes) {
     ZX_DEBUG_ASSERT((num_bytes & 7) == 0);
@@ -114,6 +143,19 @@ uint64_t* trace_context::AllocRecord(size_t num_bytes) {
         return nullptr;
     static_assert(TRACE_ENCODED_RECORD_MAX_LENGTH < kMaxRollingBufferSize, "");
 
+    if (UsingThreadBuffers())
+        return AllocThreadBufferRecord(num_bytes);
+    return AllocRollingRecord(num_bytes);
+}
+
+// Allocates |num_bytes| from the current rolling buffer. This may be a single
+// record, or a batch of records handed off from a thread buffer, which is
+// bounded by |kMaxThreadBufferSize| rather than by the maximum record size.
+// When |may_notify| is false, a full streaming buffer is not switched for the
+// other one: that would ask the handler to save it after it can no longer do so.
+uint64_t* trace_context::AllocRollingRecord(size_t num_bytes, bool may_notify) {
+    ZX_DEBUG_ASSERT((num_bytes & 7) == 0);
+
     // For the circular and streaming cases, try at most once for each buffer.
     // Note: Keep the normal case of one successful pass the fast path.
     // E.g., We don't do a mode comparison unless we have to.
@@ -145,7 +187,7 @@ uint64_t* trace_context::AllocRecord(size_t num_bytes) {
             MarkRollingBufferFull(wrapped_count, buffer_offset);
             // If the TraceManager is slow in saving buffers we could get
             // here a lot. Do a quick check and early exit for this case.
-            if (unlikely(!IsOtherRollingBufferReady(buffer_number))) {
+            if (unlikely(!may_notify || !IsOtherRollingBufferReady(buffer_number))) {
                 MarkRecordDropped();
                 StreamingBufferFullCheck(wrapped_count, buffer_offset);
                 return nullptr;
@@ -274,9 +316,79 @@ bool trace_context::SwitchRollingBuffer(uint32_t wrapped_count,
     return true;
 }
 
+uint64_t* trace_context::AllocThreadBufferRecord(size_t num_bytes) {
+    ThreadBuffer* buffer = GetCurrentThreadBuffer();
+    if (unlikely(!buffer))
+        return AllocRollingRecord(num_bytes);
+
+    if (buffer->num_bytes + num_bytes > thread_buffer_size_) {
+        // The thread has finished writing the records already in its buffer:
+        // it only allocates a record once it has written the previous one.
+        FlushThreadBuffer(buffer, true);
+        // Records too large for a thread buffer are written directly, after
+        // those of the thread that preceded them.
+        if (unlikely(num_bytes > thread_buffer_size_))
+            return AllocRollingRecord(num_bytes);
+    }
+
+    uint64_t* ptr = buffer->records() + buffer->num_bytes / sizeof(uint64_t);
+    buffer->num_bytes += num_bytes;
+    buffer->num_records++;
+    return ptr;
+}
+
+trace_context::ThreadBuffer* trace_context::GetCurrentThreadBuffer() {
+    if (likely(trace::tls_thread_buffer_generation == generation_))
+        return static_cast<ThreadBuffer*>(trace::tls_thread_buffer);
+    if (unlikely(trace::tls_thread_buffer_generation > generation_))
+        return nullptr;
+
+    auto buffer = static_cast<ThreadBuffer*>(malloc(sizeof(ThreadBuffer) + thread_buffer_size_));
+    if (unlikely(!buffer))
+        return nullptr;
+    buffer->num_bytes = 0u;
+    buffer->num_records = 0u;
+    {
+        fbl::AutoLock lock(&thread_buffers_mutex_);
+        buffer->next = thread_buffers_;
+        thread_buffers_ = buffer;
+    }
+
+    trace::tls_thread_buffer = buffer;
+    trace::tls_thread_buffer_generation = generation_;
+    return buffer;
+}
+
+void trace_context::FlushThreadBuffer(ThreadBuffer* buffer, bool may_notify) {
+    if (buffer->num_bytes == 0u)
+        return;
+
+    uint64_t* ptr = AllocRollingRecord(buffer->num_bytes, may_notify);
+    if (likely(ptr)) {
+        memcpy(ptr, buffer->records(), buffer->num_bytes);
+    } else if (buffer->num_records > 1u) {
+        // The failed allocation has already accounted for one record.
+        num_records_dropped_.fetch_add(buffer->num_records - 1u, std::memory_order_relaxed);
+    }
+    buffer->num_bytes = 0u;
+    buffer->num_records = 0u;
+}
+
+void trace_context::FlushThreadBuffers() {
+    fbl::AutoLock lock(&thread_buffers_mutex_);
+    for (ThreadBuffer* buffer = thread_buffers_; buffer; buffer = buffer->next) {
+        // Tracing has stopped, so nothing would save a full streaming buffer.
+        FlushThreadBuffer(buffer, false);
+    }
+}
+
 uint64_t* trace_context::AllocDurableRecord(size_t num_bytes) {
-    ZX_DEBUG_ASSERT(UsingDurableBuffer());
     ZX_DEBUG_ASSERT((num_bytes & 7) == 0);
+    if (!UsingDurableBuffer()) {
+        if (unlikely(num_bytes > TRACE_ENCODED_RECORD_MAX_LENGTH))
+            return nullptr;
+        return AllocRollingRecord(num_bytes);
+    }
 
     uint64_t buffer_offset =
         durable_buffer_current_.fetch_add(num_bytes,
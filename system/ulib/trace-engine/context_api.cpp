@@ -282,7 +282,7 @@ public:
         : ptr_(context->AllocRecord(num_bytes)) {}
 
     explicit Payload(trace_context_t* context, bool rqst_durable, size_t num_bytes)
-        : ptr_(rqst_durable && context->UsingDurableBuffer()
+        : ptr_(rqst_durable
                ? context->AllocDurableRecord(num_bytes)
                : context->AllocRecord(num_bytes)) {}
 
@@ -51,7 +51,7 @@ void trace_engine_request_save_buffer(uint32_t wrapped_count,
 // Implements the opaque type declared in <trace-engine/context.h>.
 struct trace_context {
     trace_context(void* buffer, size_t buffer_num_bytes, trace_buffering_mode_t buffering_mode,
-                  trace_handler_t* handler);
+                  bool thread_buffers, trace_handler_t* handler);
 
     ~trace_context();
 
@@ -79,6 +79,8 @@ struct trace_context {
         return buffering_mode_ != TRACE_BUFFERING_MODE_ONESHOT;
     }
 
+    bool UsingThreadBuffers() const { return thread_buffer_size_ != 0u; }
+
     // Return true if at least one record was dropped.
     bool WasRecordDropped() const { return num_records_dropped() != 0u; }
 
@@ -90,7 +92,19 @@ struct trace_context {
     void InitBufferHeader();
     void UpdateBufferHeaderAfterStopped();
 
+    // Hands off the records left in every thread's buffer.
+    // This is only called from the engine once all references to the
+    // context have been released, so no thread is writing to its buffer.
+    // In streaming mode, records which don't fit in the current buffer are
+    // dropped rather than switching to the other buffer.
+    void FlushThreadBuffers();
+
+    // Records allocated with |AllocRecord()| go into the calling thread's
+    // buffer when |UsingThreadBuffers()|. When they do, each record must be
+    // written before the thread allocates the next one.
     uint64_t* AllocRecord(size_t num_bytes);
+    // In oneshot mode, where there is no durable buffer, durable records go
+    // directly into the rolling buffer.
     uint64_t* AllocDurableRecord(size_t num_bytes);
     bool AllocThreadIndex(trace_thread_index_t* out_index);
     bool AllocStringIndex(trace_string_index_t* out_index);
@@ -186,6 +200,22 @@ private:
     static_assert(GET_DURABLE_BUFFER_SIZE(kMinPhysicalBufferSize - sizeof(trace_buffer_header)) >=
                   kMinDurableBufferSize, "");
 
+    // The maximum size of a thread's buffer.
+    // It is further limited to a fraction of the rolling buffer size, so that
+    // handing off a full thread buffer doesn't waste most of a rolling buffer.
+    static constexpr size_t kMaxThreadBufferSize = 4096;
+
+    // A thread's buffer, holding records not yet handed off to the rolling
+    // buffer. The records follow this header.
+    struct ThreadBuffer {
+        ThreadBuffer* next;
+        size_t num_bytes;
+        size_t num_records;
+
+        uint64_t* records() { return reinterpret_cast<uint64_t*>(this + 1); }
+    };
+    static_assert(sizeof(ThreadBuffer) % sizeof(uint64_t) == 0, "");
+
     static uintptr_t GetBufferOffset(uint64_t offset_plus_counter) {
         return offset_plus_counter & ((1ul << kBufferOffsetBits) - 1);
     }
@@ -223,6 +253,14 @@ private:
 
     void ComputeBufferSizes();
 
+    uint64_t* AllocRollingRecord(size_t num_bytes, bool may_notify = true);
+
+    uint64_t* AllocThreadBufferRecord(size_t num_bytes);
+
+    ThreadBuffer* GetCurrentThreadBuffer();
+
+    void FlushThreadBuffer(ThreadBuffer* buffer, bool may_notify);
+
     void MarkDurableBufferFull(uint64_t last_offset);
 
     void MarkOneshotBufferFull(uint64_t last_offset);
@@ -338,6 +376,16 @@ private:
     // Handler associated with the trace session.
     trace_handler_t* const handler_;
 
+    // The size of each thread's buffer, or zero if threads write their
+    // records directly into the rolling buffer.
+    // See |TRACE_ENGINE_OPTION_THREAD_BUFFERS|.
+    size_t thread_buffer_size_ = 0u;
+
+    // Every thread's buffer, so that they can be flushed when tracing stops.
+    // They are freed with the context.
+    fbl::Mutex thread_buffers_mutex_;
+    ThreadBuffer* thread_buffers_ __TA_GUARDED(thread_buffers_mutex_) = nullptr;
+
     // The next thread index to be assigned.
     std::atomic<trace_thread_index_t> next_thread_index_{
         TRACE_ENCODED_THREAD_REF_MIN_INDEX};
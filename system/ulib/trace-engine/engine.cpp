@@ -329,6 +329,15 @@ EXPORT_NO_DDK zx_status_t trace_start_engine(
         async_dispatcher_t* dispatcher, trace_handler_t* handler,
         trace_buffering_mode_t buffering_mode,
         void* buffer, size_t buffer_num_bytes) {
+    return trace_start_engine_etc(dispatcher, handler, buffering_mode,
+                                  buffer, buffer_num_bytes, 0u);
+}
+
+// thread-safe
+EXPORT_NO_DDK zx_status_t trace_start_engine_etc(
+        async_dispatcher_t* dispatcher, trace_handler_t* handler,
+        trace_buffering_mode_t buffering_mode,
+        void* buffer, size_t buffer_num_bytes, uint32_t options) {
     ZX_DEBUG_ASSERT(dispatcher);
     ZX_DEBUG_ASSERT(handler);
     ZX_DEBUG_ASSERT(buffer);
@@ -342,6 +351,10 @@ EXPORT_NO_DDK zx_status_t trace_start_engine(
         return ZX_ERR_INVALID_ARGS;
     }
 
+    if ((options & ~TRACE_ENGINE_OPTION_THREAD_BUFFERS) != 0) {
+        return ZX_ERR_INVALID_ARGS;
+    }
+
     // The buffer size must be a multiple of 4096 (simplifies buffer size
     // calcs).
     if ((buffer_num_bytes & 0xfff) != 0) {
@@ -380,7 +393,9 @@ EXPORT_NO_DDK zx_status_t trace_start_engine(
     g_dispatcher = dispatcher;
     g_handler = handler;
     g_disposition = ZX_OK;
-    g_context = new trace_context(buffer, buffer_num_bytes, buffering_mode, handler);
+    g_context = new trace_context(buffer, buffer_num_bytes, buffering_mode,
+                                  (options & TRACE_ENGINE_OPTION_THREAD_BUFFERS) != 0,
+                                  handler);
     g_event = std::move(event);
 
     g_context->InitBufferHeader();
@@ -530,6 +545,7 @@ void handle_context_released(async_dispatcher_t* dispatcher) {
         ZX_DEBUG_ASSERT(g_context != nullptr);
 
         // Update final buffer state.
+        g_context->FlushThreadBuffers();
         g_context->UpdateBufferHeaderAfterStopped();
 
         // Get final disposition.
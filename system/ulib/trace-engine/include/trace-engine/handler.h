@@ -112,6 +112,32 @@ zx_status_t trace_start_engine(async_dispatcher_t* dispatcher,
                                void* buffer,
                                size_t buffer_num_bytes);
 
+// Options for |trace_start_engine_etc()|.
+
+// Each thread first writes its records into a small buffer of its own, and
+// hands them off to the trace buffer in one allocation when that fills.
+// This avoids contention between threads on the trace buffer's allocation
+// pointer when many threads trace heavily, at the cost of records from
+// different threads no longer appearing in the order they were written in.
+// Threads still write string and thread records (those which go into the
+// durable buffer) directly to the trace buffer.
+// Records still in a thread's buffer are handed off when tracing stops.
+// A record allocated with |trace_context_alloc_record()| or
+// |trace_context_begin_write_blob_record()| must be completely written
+// before the thread writes its next record.
+#define TRACE_ENGINE_OPTION_THREAD_BUFFERS ((uint32_t)1u << 0)
+
+// Same as |trace_start_engine()|, with the |TRACE_ENGINE_OPTION_*| values
+// in |options|.
+//
+// Returns |ZX_ERR_INVALID_ARGS| if |options| contains an unknown option.
+zx_status_t trace_start_engine_etc(async_dispatcher_t* dispatcher,
+                                   trace_handler_t* handler,
+                                   trace_buffering_mode_t buffering_mode,
+                                   void* buffer,
+                                   size_t buffer_num_bytes,
+                                   uint32_t options);
+
 // Asynchronously stops the trace engine.
 //
 // The trace handler's |trace_stopped()| method will be invoked asynchronously
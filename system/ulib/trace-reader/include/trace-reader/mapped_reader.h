@@ -0,0 +1,133 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TRACE_READER_MAPPED_READER_H_
+#define TRACE_READER_MAPPED_READER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <trace-reader/reader.h>
+#include <trace-reader/records.h>
+
+#include <fbl/macros.h>
+#include <fbl/string.h>
+#include <fbl/unique_ptr.h>
+#include <fbl/vector.h>
+
+namespace trace {
+
+// Reads selected events from a trace held in one contiguous region of
+// memory, usually a trace file mapped by |Open()|, without decoding the
+// trace from the start.
+//
+// Creating the reader makes one pass over the record headers to build a
+// sparse index. The trace is divided into blocks of about |block_size|
+// bytes, each from a single provider, and the index holds the offset,
+// provider, and range of event timestamps of each block. It also holds the
+// offset of every record that defines something later records refer to:
+// providers, strings and threads.
+//
+// A query decodes only the blocks which may hold matching events. Blocks
+// are independent once their decoder has been given the definitions which
+// precede them, so they can be decoded in parallel: each thread takes a run
+// of consecutive blocks and replays just the definitions leading up to each
+// one, rather than decoding everything in between.
+class MappedTraceReader {
+public:
+    using RecordConsumer = TraceReader::RecordConsumer;
+    using ErrorHandler = TraceReader::ErrorHandler;
+
+    static constexpr size_t kDefaultBlockSize = 256u * 1024u;
+
+    // Selects event records.
+    struct Query {
+        // Events with timestamps in [start_time, end_time).
+        trace_ticks_t start_time = 0u;
+        trace_ticks_t end_time = UINT64_MAX;
+
+        // Events from this provider, or from any provider if zero.
+        ProviderId provider_id = 0u;
+
+        // Events in one of these categories, or in any category if empty.
+        // Categories aren't indexed: they only filter the decoded events.
+        fbl::Vector<fbl::String> categories;
+    };
+
+    ~MappedTraceReader();
+
+    // Maps the trace file at |path| read-only, and indexes it.
+    // Returns false if the file can't be mapped or the trace is corrupt,
+    // after reporting the reason to |error_handler|.
+    static bool Open(const char* path, ErrorHandler error_handler,
+                     fbl::unique_ptr<MappedTraceReader>* out_reader);
+
+    // Indexes the trace in |words|, which must outlive the reader.
+    // Returns false if the trace is corrupt, after reporting the reason to
+    // |error_handler|.
+    static bool Create(const uint64_t* words, size_t num_words,
+                       ErrorHandler error_handler, size_t block_size,
+                       fbl::unique_ptr<MappedTraceReader>* out_reader);
+
+    // Calls |record_consumer| with each event record matching |query|,
+    // decoding blocks on up to |num_threads| threads.
+    //
+    // The consumer is called from the decoding threads, but only one at a
+    // time. The events of one block are passed in the order they appear in
+    // the trace; with more than one thread, blocks are passed in no
+    // particular order.
+    //
+    // Returns false if a block couldn't be decoded.
+    bool ReadEvents(const Query& query, size_t num_threads,
+                    RecordConsumer record_consumer) const;
+
+    size_t num_blocks() const { return blocks_.size(); }
+
+    // Returns the range of event timestamps in the trace, which is empty
+    // if the trace has no events.
+    trace_ticks_t start_time() const { return start_time_; }
+    trace_ticks_t end_time() const { return end_time_; }
+
+private:
+    struct Block {
+        // Offsets of the first word of the block, and of the word past it.
+        size_t begin;
+        size_t end;
+        ProviderId provider_id;
+        // The range of event timestamps in the block, which is empty if
+        // it has no events.
+        trace_ticks_t start_time;
+        trace_ticks_t end_time;
+    };
+
+    class Decoder;
+
+    MappedTraceReader(const uint64_t* words, size_t num_words,
+                      ErrorHandler error_handler);
+
+    bool BuildIndex(size_t block_size);
+    void AddBlock(size_t begin, size_t end, ProviderId provider_id,
+                  trace_ticks_t start_time, trace_ticks_t end_time);
+    bool IsBlockSelected(const Block& block, const Query& query) const;
+
+    const uint64_t* const words_;
+    size_t const num_words_;
+    ErrorHandler const error_handler_;
+
+    // The mapping made by |Open()|, if any.
+    void* mapping_ = nullptr;
+    size_t mapping_size_ = 0u;
+
+    fbl::Vector<Block> blocks_;
+    // Offsets of the records which define providers, strings and threads.
+    fbl::Vector<size_t> definitions_;
+    trace_ticks_t start_time_ = 0u;
+    trace_ticks_t end_time_ = 0u;
+
+    DISALLOW_COPY_ASSIGN_AND_MOVE(MappedTraceReader);
+};
+
+} // namespace trace
+
+#endif  // TRACE_READER_MAPPED_READER_H_
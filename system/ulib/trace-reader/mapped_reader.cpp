@@ -0,0 +1,323 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <trace-reader/mapped_reader.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <threads.h>
+#include <unistd.h>
+
+#include <fbl/algorithm.h>
+#include <fbl/auto_lock.h>
+#include <fbl/mutex.h>
+#include <fbl/string_printf.h>
+#include <trace-engine/fields.h>
+
+#include <utility>
+
+namespace trace {
+
+// Decodes a run of consecutive selected blocks, on one thread.
+class MappedTraceReader::Decoder {
+public:
+    // State shared by all the decoders of one query.
+    struct Shared {
+        const MappedTraceReader* trace;
+        const Query* query;
+        RecordConsumer* record_consumer;
+        // Serializes calls to the consumer and the error handler.
+        fbl::Mutex mutex;
+    };
+
+    Decoder(Shared* shared, const Block* const* blocks, size_t num_blocks)
+        : shared_(shared), blocks_(blocks), num_blocks_(num_blocks),
+          reader_([this](Record record) { ConsumeRecord(&record); },
+                  [this](fbl::String error) { ReportError(std::move(error)); }) {}
+
+    bool Decode() {
+        const MappedTraceReader* trace = shared_->trace;
+        size_t next_definition = 0u;
+        for (size_t i = 0; i < num_blocks_; ++i) {
+            const Block* block = blocks_[i];
+
+            // Replay the definitions between the previous block decoded
+            // (or the start of the trace) and this one.
+            for (; next_definition < trace->definitions_.size() &&
+                   trace->definitions_[next_definition] < block->begin;
+                 ++next_definition) {
+                size_t offset = trace->definitions_[next_definition];
+                size_t size = RecordFields::RecordSize::Get<size_t>(trace->words_[offset]);
+                Chunk record(trace->words_ + offset, size);
+                if (!reader_.ReadRecords(record))
+                    return false;
+            }
+
+            consuming_ = true;
+            Chunk chunk(trace->words_ + block->begin, block->end - block->begin);
+            bool ok = reader_.ReadRecords(chunk);
+            consuming_ = false;
+            if (!ok)
+                return false;
+
+            // The block's own definitions have been read along with it.
+            while (next_definition < trace->definitions_.size() &&
+                   trace->definitions_[next_definition] < block->end) {
+                ++next_definition;
+            }
+        }
+        return true;
+    }
+
+    static int Run(void* arg) {
+        return static_cast<Decoder*>(arg)->Decode() ? 0 : -1;
+    }
+
+private:
+    // Takes a pointer, rather than the record itself, to save moving the
+    // record once more on its way to the consumer.
+    void ConsumeRecord(Record* record) {
+        if (!consuming_ || record->type() != RecordType::kEvent)
+            return;
+
+        const Query& query = *shared_->query;
+        const Record::Event& event = record->GetEvent();
+        if (event.timestamp < query.start_time || event.timestamp >= query.end_time)
+            return;
+        if (!query.categories.is_empty()) {
+            bool found = false;
+            for (const auto& category : query.categories) {
+                if (event.category == category) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found)
+                return;
+        }
+
+        fbl::AutoLock lock(&shared_->mutex);
+        (*shared_->record_consumer)(std::move(*record));
+    }
+
+    void ReportError(fbl::String error) {
+        fbl::AutoLock lock(&shared_->mutex);
+        shared_->trace->error_handler_(std::move(error));
+    }
+
+    Shared* const shared_;
+    const Block* const* const blocks_;
+    size_t const num_blocks_;
+    TraceReader reader_;
+    // False while replaying definitions, whose records aren't wanted.
+    bool consuming_ = false;
+};
+
+MappedTraceReader::MappedTraceReader(const uint64_t* words, size_t num_words,
+                                     ErrorHandler error_handler)
+    : words_(words), num_words_(num_words),
+      error_handler_(std::move(error_handler)) {}
+
+MappedTraceReader::~MappedTraceReader() {
+    if (mapping_)
+        munmap(mapping_, mapping_size_);
+}
+
+bool MappedTraceReader::Open(const char* path, ErrorHandler error_handler,
+                             fbl::unique_ptr<MappedTraceReader>* out_reader) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        error_handler(fbl::StringPrintf("Failed to open %s: %s", path, strerror(errno)));
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        error_handler(fbl::StringPrintf("Failed to stat %s: %s", path, strerror(errno)));
+        close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* mapping = nullptr;
+    if (size != 0u) {
+        mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            error_handler(fbl::StringPrintf("Failed to map %s: %s", path, strerror(errno)));
+            close(fd);
+            return false;
+        }
+    }
+    close(fd);
+
+    // A trailing partial word can only be part of a truncated record,
+    // which is ignored like any other.
+    fbl::unique_ptr<MappedTraceReader> reader(new MappedTraceReader(
+        static_cast<const uint64_t*>(mapping), size / sizeof(uint64_t),
+        std::move(error_handler)));
+    reader->mapping_ = mapping;
+    reader->mapping_size_ = size;
+    if (!reader->BuildIndex(kDefaultBlockSize))
+        return false;
+    *out_reader = std::move(reader);
+    return true;
+}
+
+bool MappedTraceReader::Create(const uint64_t* words, size_t num_words,
+                               ErrorHandler error_handler, size_t block_size,
+                               fbl::unique_ptr<MappedTraceReader>* out_reader) {
+    fbl::unique_ptr<MappedTraceReader> reader(
+        new MappedTraceReader(words, num_words, std::move(error_handler)));
+    if (!reader->BuildIndex(block_size))
+        return false;
+    *out_reader = std::move(reader);
+    return true;
+}
+
+bool MappedTraceReader::BuildIndex(size_t block_size) {
+    size_t block_size_words = fbl::max(block_size / sizeof(uint64_t), size_t{1});
+
+    size_t block_begin = 0u;
+    ProviderId provider_id = 0u;
+    trace_ticks_t block_start_time = UINT64_MAX;
+    trace_ticks_t block_end_time = 0u;
+
+    size_t offset = 0u;
+    while (offset < num_words_) {
+        RecordHeader header = words_[offset];
+        auto size = RecordFields::RecordSize::Get<size_t>(header);
+        if (size == 0) {
+            error_handler_("Unexpected record of size 0");
+            return false;
+        }
+        if (size > num_words_ - offset) {
+            // The trace ends with a truncated record.
+            break;
+        }
+
+        switch (RecordFields::Type::Get<RecordType>(header)) {
+        case RecordType::kMetadata: {
+            auto type = MetadataRecordFields::MetadataType::Get<MetadataType>(header);
+            if (type == MetadataType::kProviderInfo ||
+                type == MetadataType::kProviderSection) {
+                // These change the current provider. Start a new block so
+                // each block holds records from a single provider.
+                AddBlock(block_begin, offset, provider_id,
+                         block_start_time, block_end_time);
+                block_begin = offset;
+                block_start_time = UINT64_MAX;
+                block_end_time = 0u;
+                provider_id = type == MetadataType::kProviderInfo
+                    ? ProviderInfoMetadataRecordFields::Id::Get<ProviderId>(header)
+                    : ProviderSectionMetadataRecordFields::Id::Get<ProviderId>(header);
+            }
+            definitions_.push_back(offset);
+            break;
+        }
+        case RecordType::kString:
+        case RecordType::kThread:
+            definitions_.push_back(offset);
+            break;
+        case RecordType::kEvent: {
+            // The timestamp follows the header.
+            if (size < 2)
+                break;
+            trace_ticks_t timestamp = words_[offset + 1];
+            block_start_time = fbl::min(block_start_time, timestamp);
+            block_end_time = fbl::max(block_end_time, timestamp + 1);
+            break;
+        }
+        default:
+            break;
+        }
+
+        offset += size;
+        if (offset - block_begin >= block_size_words) {
+            AddBlock(block_begin, offset, provider_id, block_start_time, block_end_time);
+            block_begin = offset;
+            block_start_time = UINT64_MAX;
+            block_end_time = 0u;
+        }
+    }
+    AddBlock(block_begin, offset, provider_id, block_start_time, block_end_time);
+    return true;
+}
+
+void MappedTraceReader::AddBlock(size_t begin, size_t end, ProviderId provider_id,
+                                 trace_ticks_t start_time, trace_ticks_t end_time) {
+    if (begin == end)
+        return;
+    if (start_time >= end_time) {
+        // No events.
+        start_time = end_time = 0u;
+    } else if (start_time_ == end_time_) {
+        start_time_ = start_time;
+        end_time_ = end_time;
+    } else {
+        start_time_ = fbl::min(start_time_, start_time);
+        end_time_ = fbl::max(end_time_, end_time);
+    }
+    blocks_.push_back(Block{begin, end, provider_id, start_time, end_time});
+}
+
+bool MappedTraceReader::IsBlockSelected(const Block& block, const Query& query) const {
+    if (block.start_time == block.end_time)
+        return false;
+    if (block.end_time <= query.start_time || block.start_time >= query.end_time)
+        return false;
+    return query.provider_id == 0u || block.provider_id == query.provider_id;
+}
+
+bool MappedTraceReader::ReadEvents(const Query& query, size_t num_threads,
+                                   RecordConsumer record_consumer) const {
+    fbl::Vector<const Block*> selected;
+    for (const auto& block : blocks_) {
+        if (IsBlockSelected(block, query))
+            selected.push_back(&block);
+    }
+    if (selected.is_empty())
+        return true;
+
+    Decoder::Shared shared;
+    shared.trace = this;
+    shared.query = &query;
+    shared.record_consumer = &record_consumer;
+
+    num_threads = fbl::clamp(num_threads, size_t{1}, selected.size());
+    if (num_threads == 1u) {
+        Decoder decoder(&shared, selected.get(), selected.size());
+        return decoder.Decode();
+    }
+
+    // Give each thread an equal run of consecutive blocks, so that it
+    // only replays the definitions leading up to its first block once.
+    fbl::Vector<fbl::unique_ptr<Decoder>> decoders;
+    fbl::Vector<thrd_t> threads;
+    bool ok = true;
+    for (size_t i = 0; i < num_threads; ++i) {
+        size_t begin = selected.size() * i / num_threads;
+        size_t end = selected.size() * (i + 1) / num_threads;
+        decoders.push_back(fbl::unique_ptr<Decoder>(
+            new Decoder(&shared, selected.get() + begin, end - begin)));
+        if (i == 0u)
+            continue; // Decoded on this thread.
+        thrd_t thread;
+        if (thrd_create(&thread, Decoder::Run, decoders[i].get()) != thrd_success) {
+            // Decode this run on this thread instead.
+            ok = decoders[i]->Decode() && ok;
+            continue;
+        }
+        threads.push_back(thread);
+    }
+    ok = decoders[0]->Decode() && ok;
+    for (thrd_t thread : threads) {
+        int result;
+        thrd_join(thread, &result);
+        ok = ok && result == 0;
+    }
+    return ok;
+}
+
+} // namespace trace
@@ -12,6 +12,7 @@ MODULE_TYPE := userlib
 MODULE_COMPILEFLAGS += -fvisibility=hidden
 
 MODULE_SRCS = \
+    $(LOCAL_DIR)/mapped_reader.cpp \
     $(LOCAL_DIR)/reader.cpp \
     $(LOCAL_DIR)/reader_internal.cpp \
     $(LOCAL_DIR)/records.cpp
@@ -30,7 +31,8 @@ MODULE_STATIC_LIBS := \
     system/ulib/fbl
 
 MODULE_LIBS := \
-    system/ulib/c
+    system/ulib/c \
+    system/ulib/fdio
 
 MODULE_PACKAGE := src
 
@@ -44,6 +46,7 @@ MODULE_TYPE := hostlib
 MODULE_COMPILEFLAGS += -fvisibility=hidden
 
 MODULE_SRCS = \
+    $(LOCAL_DIR)/mapped_reader.cpp \
     $(LOCAL_DIR)/reader.cpp \
     $(LOCAL_DIR)/records.cpp
 
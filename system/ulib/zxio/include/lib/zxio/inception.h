@@ -30,6 +30,8 @@ typedef struct zxio_remote {
     zxio_t io;
     zx_handle_t control;
     zx_handle_t event;
+    // Held by a pipelined transfer on a file; see |zxio_file_init|.
+    mtx_t pipeline_lock;
 } zxio_remote_t;
 
 static_assert(sizeof(zxio_remote_t) <= sizeof(zxio_storage_t),
@@ -39,6 +41,12 @@ zx_status_t zxio_remote_init(zxio_storage_t* remote, zx_handle_t control,
                              zx_handle_t event);
 zx_status_t zxio_dir_init(zxio_storage_t* remote, zx_handle_t control);
 
+// Like |zxio_remote_init|, for a node known to be a file. Large reads and
+// writes at a given offset are pipelined on |control|, one transfer at a
+// time. Those at the seek offset are made a chunk at a time.
+zx_status_t zxio_file_init(zxio_storage_t* remote, zx_handle_t control,
+                           zx_handle_t event);
+
 // vmofile ---------------------------------------------------------------------
 
 typedef struct zxio_vmofile {
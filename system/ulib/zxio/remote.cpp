@@ -429,6 +429,234 @@ static constexpr zxio_ops_t zxio_dir_ops = []() {
     return ops;
 }();
 
+// file ------------------------------------------------------------------------
+
+// Transfers of at least this many bytes at a given offset are pipelined:
+// they are split into chunks as usual, but the requests for up to
+// ZXIO_FILE_PIPELINE_DEPTH chunks are sent before waiting for the first reply,
+// so that the transfer costs about one round trip to the server rather than
+// one per chunk.
+#define ZXIO_FILE_PIPELINE_MIN (8 * ZXIO_REMOTE_CHUNK_SIZE)
+#define ZXIO_FILE_PIPELINE_DEPTH 16
+
+// A pipelined transfer is made on |rio->control| itself. Its requests are
+// written with txids below the ones the kernel gives zx_channel_call(), so
+// their replies are queued on the channel rather than handed to another
+// thread's call, and are read back in order. Only one pipelined transfer may
+// be in progress on a file at a time: it holds |rio->pipeline_lock|, and a
+// transfer which finds the lock taken is made a chunk at a time instead.
+static zx_txid_t zxio_file_chunk_txid(size_t position) {
+    return static_cast<zx_txid_t>(position / ZXIO_REMOTE_CHUNK_SIZE + 1);
+}
+
+// Reads the next reply from |channel| into |bytes|.
+static zx_status_t zxio_file_read_reply(zx_handle_t channel, void* bytes, uint32_t capacity,
+                                        uint32_t* out_actual) {
+    zx_status_t status = zx_object_wait_one(channel, ZX_CHANNEL_READABLE | ZX_CHANNEL_PEER_CLOSED,
+                                            ZX_TIME_INFINITE, nullptr);
+    if (status != ZX_OK) {
+        return status;
+    }
+    uint32_t actual_handles;
+    return zx_channel_read(channel, 0, bytes, nullptr, capacity, 0, out_actual, &actual_handles);
+}
+
+// Sends the requests for a pipelined transfer of |capacity| bytes on
+// |channel|, and reads their replies. |send(position, count)| sends the
+// request for the |count| bytes at |position| in the transfer, and
+// |receive(position, count, &actual)| reads the reply to it.
+//
+// Stops at the first chunk which is transferred short or fails, and then
+// discards the replies to the requests already sent past it, so that they
+// aren't taken for the replies of a later transfer. Returns the number of
+// bytes transferred before then in |out_actual| even on failure.
+template <typename Send, typename Receive>
+static zx_status_t zxio_file_pipeline(zx_handle_t channel, size_t capacity, Send send,
+                                      Receive receive, size_t* out_actual) {
+    const size_t window = ZXIO_FILE_PIPELINE_DEPTH * ZXIO_REMOTE_CHUNK_SIZE;
+    size_t sent = 0u;
+    size_t received = 0u;
+    size_t outstanding = 0u;
+    zx_status_t status = ZX_OK;
+    while (received < capacity) {
+        while (sent < capacity && sent - received < window) {
+            size_t remaining = capacity - sent;
+            size_t chunk = (remaining > ZXIO_REMOTE_CHUNK_SIZE) ? ZXIO_REMOTE_CHUNK_SIZE : remaining;
+            if ((status = send(sent, chunk)) != ZX_OK) {
+                break;
+            }
+            sent += chunk;
+            outstanding++;
+        }
+        if (status != ZX_OK) {
+            break;
+        }
+        size_t remaining = capacity - received;
+        size_t chunk = (remaining > ZXIO_REMOTE_CHUNK_SIZE) ? ZXIO_REMOTE_CHUNK_SIZE : remaining;
+        size_t actual = 0u;
+        status = receive(received, chunk, &actual);
+        outstanding--;
+        if (status != ZX_OK) {
+            break;
+        }
+        received += actual;
+        if (actual != chunk) {
+            break;
+        }
+    }
+    *out_actual = received;
+
+    alignas(FIDL_ALIGNMENT) uint8_t bytes[sizeof(fuchsia_io_FileReadAtResponse) +
+                                          ZXIO_REMOTE_CHUNK_SIZE];
+    for (; outstanding > 0u; outstanding--) {
+        uint32_t actual_bytes;
+        if (zxio_file_read_reply(channel, bytes, sizeof(bytes), &actual_bytes) != ZX_OK) {
+            break;
+        }
+    }
+    return status;
+}
+
+// Takes |rio->pipeline_lock| if no other pipelined transfer holds it.
+static bool zxio_file_pipeline_begin(zxio_remote_t* rio) {
+    return mtx_trylock(&rio->pipeline_lock) == thrd_success;
+}
+
+static void zxio_file_pipeline_end(zxio_remote_t* rio) {
+    mtx_unlock(&rio->pipeline_lock);
+}
+
+static zx_status_t zxio_file_read_pipelined(zxio_remote_t* rio, size_t offset, uint8_t* buffer,
+                                            size_t capacity, size_t* out_actual) {
+    zx_handle_t channel = rio->control;
+    auto send = [channel, offset](size_t position, size_t count) {
+        fuchsia_io_FileReadAtRequest request;
+        memset(&request, 0, sizeof(request));
+        request.hdr.txid = zxio_file_chunk_txid(position);
+        request.hdr.ordinal = fuchsia_io_FileReadAtOrdinal;
+        request.count = count;
+        request.offset = offset + position;
+        return zx_channel_write(channel, 0, &request, sizeof(request), nullptr, 0);
+    };
+    auto receive = [channel, buffer](size_t position, size_t count, size_t* out_count) {
+        alignas(FIDL_ALIGNMENT) uint8_t bytes[sizeof(fuchsia_io_FileReadAtResponse) +
+                                              ZXIO_REMOTE_CHUNK_SIZE];
+        uint32_t actual_bytes;
+        zx_status_t status = zxio_file_read_reply(channel, bytes, sizeof(bytes), &actual_bytes);
+        if (status != ZX_OK) {
+            return status;
+        }
+        auto* response = reinterpret_cast<fuchsia_io_FileReadAtResponse*>(bytes);
+        if (actual_bytes < sizeof(*response) ||
+            response->hdr.txid != zxio_file_chunk_txid(position)) {
+            return ZX_ERR_IO;
+        }
+        if (response->s != ZX_OK) {
+            return response->s;
+        }
+        size_t actual = response->data.count;
+        if (actual > count || actual_bytes != sizeof(*response) + FIDL_ALIGN(actual)) {
+            return ZX_ERR_IO;
+        }
+        memcpy(buffer + position, bytes + sizeof(*response), actual);
+        *out_count = actual;
+        return ZX_OK;
+    };
+    return zxio_file_pipeline(channel, capacity, send, receive, out_actual);
+}
+
+static zx_status_t zxio_file_write_pipelined(zxio_remote_t* rio, size_t offset,
+                                             const uint8_t* buffer, size_t capacity,
+                                             size_t* out_actual) {
+    zx_handle_t channel = rio->control;
+    auto send = [channel, offset, buffer](size_t position, size_t count) {
+        alignas(FIDL_ALIGNMENT) uint8_t bytes[sizeof(fuchsia_io_FileWriteAtRequest) +
+                                              ZXIO_REMOTE_CHUNK_SIZE];
+        auto* request = reinterpret_cast<fuchsia_io_FileWriteAtRequest*>(bytes);
+        memset(bytes, 0, sizeof(*request) + FIDL_ALIGN(count));
+        request->hdr.txid = zxio_file_chunk_txid(position);
+        request->hdr.ordinal = fuchsia_io_FileWriteAtOrdinal;
+        request->data.count = count;
+        request->data.data = reinterpret_cast<void*>(FIDL_ALLOC_PRESENT);
+        request->offset = offset + position;
+        memcpy(bytes + sizeof(*request), buffer + position, count);
+        return zx_channel_write(channel, 0, bytes,
+                                static_cast<uint32_t>(sizeof(*request) + FIDL_ALIGN(count)),
+                                nullptr, 0);
+    };
+    auto receive = [channel](size_t position, size_t count, size_t* out_count) {
+        fuchsia_io_FileWriteAtResponse response;
+        uint32_t actual_bytes;
+        zx_status_t status = zxio_file_read_reply(channel, &response, sizeof(response),
+                                                  &actual_bytes);
+        if (status != ZX_OK) {
+            return status;
+        }
+        if (actual_bytes != sizeof(response) ||
+            response.hdr.txid != zxio_file_chunk_txid(position)) {
+            return ZX_ERR_IO;
+        }
+        if (response.s != ZX_OK) {
+            return response.s;
+        }
+        if (response.actual > count) {
+            return ZX_ERR_IO;
+        }
+        *out_count = response.actual;
+        return ZX_OK;
+    };
+    return zxio_file_pipeline(channel, capacity, send, receive, out_actual);
+}
+
+// Reads and writes at the seek offset aren't pipelined. Each chunk of a Read
+// or Write moves the offset on the server, so readers and writers sharing the
+// file see one another's chunks in order, and in append mode only the server
+// knows where writes go.
+static zx_status_t zxio_file_read_at(zxio_t* io, size_t offset, void* data,
+                                     size_t capacity, size_t* out_actual) {
+    zxio_remote_t* rio = reinterpret_cast<zxio_remote_t*>(io);
+    if (capacity < ZXIO_FILE_PIPELINE_MIN || !zxio_file_pipeline_begin(rio)) {
+        return zxio_remote_read_at(io, offset, data, capacity, out_actual);
+    }
+    size_t actual = 0u;
+    zx_status_t status = zxio_file_read_pipelined(rio, offset, static_cast<uint8_t*>(data),
+                                                  capacity, &actual);
+    zxio_file_pipeline_end(rio);
+    *out_actual = actual;
+    return status;
+}
+
+static zx_status_t zxio_file_write_at(zxio_t* io, size_t offset, const void* data,
+                                      size_t capacity, size_t* out_actual) {
+    zxio_remote_t* rio = reinterpret_cast<zxio_remote_t*>(io);
+    if (capacity < ZXIO_FILE_PIPELINE_MIN || !zxio_file_pipeline_begin(rio)) {
+        return zxio_remote_write_at(io, offset, data, capacity, out_actual);
+    }
+    size_t actual = 0u;
+    zx_status_t status = zxio_file_write_pipelined(
+        rio, offset, static_cast<const uint8_t*>(data), capacity, &actual);
+    zxio_file_pipeline_end(rio);
+    *out_actual = actual;
+    return status;
+}
+
+static constexpr zxio_ops_t zxio_file_ops = []() {
+    zxio_ops_t ops = zxio_remote_ops;
+    ops.read_at = zxio_file_read_at;
+    ops.write_at = zxio_file_write_at;
+    return ops;
+}();
+
+zx_status_t zxio_file_init(zxio_storage_t* storage, zx_handle_t control,
+                           zx_handle_t event) {
+    zxio_remote_t* remote = reinterpret_cast<zxio_remote_t*>(storage);
+    zxio_init(&remote->io, &zxio_file_ops);
+    remote->control = control;
+    remote->event = event;
+    mtx_init(&remote->pipeline_lock, mtx_plain);
+    return ZX_OK;
+}
+
 zx_status_t zxio_dir_init(zxio_storage_t* storage, zx_handle_t control) {
     zxio_remote_t* remote = reinterpret_cast<zxio_remote_t*>(storage);
     zxio_init(&remote->io, &zxio_dir_ops);
@@ -18,6 +18,7 @@ MODULE_STATIC_LIBS := \
     system/ulib/async.cpp \
     system/ulib/async-loop \
     system/ulib/async-loop.cpp \
+    system/ulib/bitmap \
     system/ulib/blobfs \
     system/ulib/digest \
     system/ulib/fbl \
@@ -0,0 +1,328 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <blobfs/fsck.h>
+#include <blobfs/host.h>
+#include <digest/merkle-cache.h>
+#include <fbl/unique_fd.h>
+#include <fbl/unique_ptr.h>
+#include <unittest/unittest.h>
+
+namespace {
+
+constexpr size_t kImageSize = 1lu << 30;  // 1 gb
+constexpr size_t kBlobCount = 10000;
+constexpr size_t kMaxBlobSize = 3 * blobfs::kBlobfsBlockSize;
+// Every so often a larger blob, so that Merkle trees and compressed data are written as well.
+constexpr size_t kLargeBlobInterval = 100;
+constexpr size_t kLargeBlobSize = 2lu << 20;  // 2 mb
+constexpr size_t kCachedBlobCount = 100;
+
+char test_dir[PATH_MAX];
+char image_path[PATH_MAX];
+
+// Writes a synthetic blob with contents unique to |index| to |path|.
+bool CreateBlobFile(const char* path, size_t index) {
+    BEGIN_HELPER;
+    unsigned int seed = static_cast<unsigned int>(index);
+    size_t size = sizeof(index) + rand_r(&seed) % kMaxBlobSize;
+    if (index % kLargeBlobInterval == 0) {
+        size = kLargeBlobSize;
+    }
+    fbl::unique_ptr<uint8_t[]> data(new uint8_t[size]);
+    // Low-entropy contents so that compression is worthwhile, prefixed with the index so that
+    // no two blobs share a digest.
+    for (size_t i = 0; i < size; i++) {
+        data[i] = static_cast<uint8_t>(rand_r(&seed) % 4);
+    }
+    memcpy(data.get(), &index, sizeof(index));
+
+    fbl::unique_fd fd(open(path, O_RDWR | O_CREAT | O_EXCL, 0644));
+    ASSERT_TRUE(fd, "Unable to create blob file");
+    ASSERT_EQ(write(fd.get(), data.get(), size), static_cast<ssize_t>(size));
+    END_HELPER;
+}
+
+bool CreateImage(fbl::unique_ptr<blobfs::Blobfs>* out) {
+    BEGIN_HELPER;
+    fbl::unique_fd fd(open(image_path, O_RDWR | O_CREAT | O_EXCL, 0644));
+    ASSERT_TRUE(fd, "Unable to create image");
+    ASSERT_EQ(ftruncate(fd.get(), kImageSize), 0);
+    uint64_t block_count;
+    ASSERT_EQ(blobfs::GetBlockCount(fd.get(), &block_count), ZX_OK);
+    ASSERT_EQ(blobfs::Mkfs(fd.get(), block_count), 0);
+    ASSERT_EQ(blobfs::blobfs_create(out, std::move(fd)), ZX_OK);
+    END_HELPER;
+}
+
+bool ReopenImage(fbl::unique_ptr<blobfs::Blobfs>* out) {
+    BEGIN_HELPER;
+    fbl::unique_fd fd(open(image_path, O_RDWR));
+    ASSERT_TRUE(fd, "Unable to open image");
+    ASSERT_EQ(blobfs::blobfs_create(out, std::move(fd)), ZX_OK);
+    END_HELPER;
+}
+
+// Adds many blobs to a single image from many threads, alternating between the precomputed
+// (compressed) and the direct paths, and checks the result with fsck.
+bool TestAddBlobsConcurrently() {
+    BEGIN_TEST;
+
+    std::vector<fbl::String> paths;
+    for (size_t i = 0; i < kBlobCount; i++) {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%sblob-%zu", test_dir, i);
+        ASSERT_TRUE(CreateBlobFile(path, i));
+        paths.push_back(path);
+    }
+
+    fbl::unique_ptr<blobfs::Blobfs> bs;
+    ASSERT_TRUE(CreateImage(&bs));
+
+    unsigned n_threads = std::thread::hardware_concurrency();
+    if (n_threads < 4) {
+        n_threads = 4;
+    }
+    std::atomic<size_t> next_blob(0);
+    std::atomic<size_t> failures(0);
+    std::vector<std::thread> threads;
+    for (unsigned j = 0; j < n_threads; j++) {
+        threads.push_back(std::thread([&] {
+            size_t i;
+            while ((i = next_blob.fetch_add(1)) < paths.size()) {
+                fbl::unique_fd fd(open(paths[i].c_str(), O_RDONLY));
+                if (!fd) {
+                    failures++;
+                    continue;
+                }
+
+                zx_status_t status;
+                if (i % 2) {
+                    blobfs::MerkleInfo info;
+                    status = blobfs::blobfs_preprocess(fd.get(), true, &info);
+                    if (status == ZX_OK) {
+                        info.path = paths[i];
+                        status = blobfs::blobfs_add_blob_with_merkle(bs.get(), fd.get(), info);
+                    }
+                } else {
+                    status = blobfs::blobfs_add_blob(bs.get(), fd.get());
+                }
+
+                if (status != ZX_OK) {
+                    failures++;
+                }
+            }
+        }));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(failures.load(), 0u);
+
+    // Blobs which are already present are detected, however they were added.
+    for (size_t i = 0; i < 2; i++) {
+        fbl::unique_fd fd(open(paths[i].c_str(), O_RDONLY));
+        ASSERT_TRUE(fd);
+        ASSERT_EQ(blobfs::blobfs_add_blob(bs.get(), fd.get()), ZX_ERR_ALREADY_EXISTS);
+    }
+    bs.reset();
+
+    ASSERT_TRUE(ReopenImage(&bs));
+    ASSERT_EQ(blobfs::Fsck(std::move(bs)), ZX_OK);
+
+    for (const auto& path : paths) {
+        ASSERT_EQ(unlink(path.c_str()), 0);
+    }
+    ASSERT_EQ(unlink(image_path), 0);
+    END_TEST;
+}
+
+// Removes the directory at |path| along with the files in it and in its subdirectories.
+bool RemoveTree(const char* path) {
+    BEGIN_HELPER;
+    DIR* dir = opendir(path);
+    ASSERT_NONNULL(dir);
+    struct dirent* de;
+    while ((de = readdir(dir)) != nullptr) {
+        if (!strcmp(de->d_name, ".") || !strcmp(de->d_name, "..")) {
+            continue;
+        }
+        char child[PATH_MAX];
+        snprintf(child, sizeof(child), "%s/%s", path, de->d_name);
+        struct stat st;
+        ASSERT_EQ(lstat(child, &st), 0);
+        if (S_ISDIR(st.st_mode)) {
+            ASSERT_TRUE(RemoveTree(child));
+        } else {
+            ASSERT_EQ(unlink(child), 0);
+        }
+    }
+    closedir(dir);
+    ASSERT_EQ(rmdir(path), 0);
+    END_HELPER;
+}
+
+// Preprocesses |paths| through |cache|, returning the results in |out| and the time taken in
+// |out_ms|.
+bool PreprocessCached(const digest::MerkleCache& cache, const std::vector<fbl::String>& paths,
+                      std::vector<blobfs::MerkleInfo>* out, long* out_ms) {
+    BEGIN_HELPER;
+    out->clear();
+    out->resize(paths.size());
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < paths.size(); i++) {
+        fbl::unique_fd fd(open(paths[i].c_str(), O_RDONLY));
+        ASSERT_TRUE(fd);
+        ASSERT_EQ(blobfs::blobfs_preprocess_cached(cache, paths[i].c_str(), fd.get(), true,
+                                                   &(*out)[i]), ZX_OK);
+    }
+    *out_ms = static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    END_HELPER;
+}
+
+// Checks that |actual| describes the same blob as |expected|.
+bool ExpectSameInfo(const blobfs::MerkleInfo& expected, const blobfs::MerkleInfo& actual) {
+    BEGIN_HELPER;
+    ASSERT_TRUE(expected.digest == actual.digest);
+    ASSERT_EQ(expected.length, actual.length);
+    ASSERT_EQ(expected.merkle.size(), actual.merkle.size());
+    ASSERT_EQ(memcmp(expected.merkle.get(), actual.merkle.get(), expected.merkle.size()), 0);
+    ASSERT_EQ(expected.compressed, actual.compressed);
+    if (expected.compressed) {
+        ASSERT_EQ(expected.compressed_length, actual.compressed_length);
+        ASSERT_EQ(memcmp(expected.compressed_data.get(), actual.compressed_data.get(),
+                         expected.compressed_length), 0);
+    }
+    END_HELPER;
+}
+
+// Preprocesses blobs through a Merkle cache, and checks that later runs reuse its results
+// without changing them, even after files are touched or rewritten.
+bool TestMerkleCache() {
+    BEGIN_TEST;
+
+    char cache_path[PATH_MAX];
+    snprintf(cache_path, sizeof(cache_path), "%smerkle-cache", test_dir);
+    fbl::unique_ptr<digest::MerkleCache> cache;
+    ASSERT_EQ(digest::MerkleCache::Create(cache_path, &cache), ZX_OK);
+
+    // Files modified within the current second are not indexed, so back-date the inputs.
+    struct timeval past[2];
+    gettimeofday(&past[0], nullptr);
+    past[0].tv_sec -= 60;
+    past[1] = past[0];
+
+    std::vector<fbl::String> paths;
+    std::vector<blobfs::MerkleInfo> expected(kCachedBlobCount);
+    for (size_t i = 0; i < kCachedBlobCount; i++) {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%scached-%zu", test_dir, i);
+        // Every blob here is a large one, so that the cache has work to save.
+        ASSERT_TRUE(CreateBlobFile(path, i * kLargeBlobInterval));
+        ASSERT_EQ(utimes(path, past), 0);
+        paths.push_back(path);
+
+        fbl::unique_fd fd(open(path, O_RDONLY));
+        ASSERT_TRUE(fd);
+        ASSERT_EQ(blobfs::blobfs_preprocess(fd.get(), true, &expected[i]), ZX_OK);
+    }
+
+    std::vector<blobfs::MerkleInfo> cold, warm;
+    long cold_ms, warm_ms;
+    ASSERT_TRUE(PreprocessCached(*cache, paths, &cold, &cold_ms));
+    ASSERT_TRUE(PreprocessCached(*cache, paths, &warm, &warm_ms));
+    unittest_printf_critical("\n    %zu blobs: cold cache %ld ms, warm cache %ld ms ",
+                             paths.size(), cold_ms, warm_ms);
+    for (size_t i = 0; i < paths.size(); i++) {
+        ASSERT_TRUE(ExpectSameInfo(expected[i], cold[i]));
+        ASSERT_TRUE(ExpectSameInfo(expected[i], warm[i]));
+    }
+
+    // Touching a file only loses its index entry; its contents are still found by digest.
+    // Rewriting a file with different contents of the same size must not reuse the old entry.
+    ASSERT_EQ(utimes(paths[0].c_str(), nullptr), 0);
+    ASSERT_EQ(unlink(paths[1].c_str()), 0);
+    ASSERT_TRUE(CreateBlobFile(paths[1].c_str(), kBlobCount * kLargeBlobInterval));
+    past[0].tv_sec++;
+    past[1] = past[0];
+    ASSERT_EQ(utimes(paths[1].c_str(), past), 0);
+    for (size_t i = 0; i < 2; i++) {
+        fbl::unique_fd fd(open(paths[i].c_str(), O_RDONLY));
+        ASSERT_TRUE(fd);
+        blobfs::MerkleInfo uncached, cached;
+        ASSERT_EQ(blobfs::blobfs_preprocess(fd.get(), true, &uncached), ZX_OK);
+        ASSERT_EQ(blobfs::blobfs_preprocess_cached(*cache, paths[i].c_str(), fd.get(), true,
+                                                   &cached), ZX_OK);
+        ASSERT_TRUE(ExpectSameInfo(uncached, cached));
+        ASSERT_EQ(uncached.digest == expected[i].digest, i == 0);
+    }
+
+    for (const auto& path : paths) {
+        ASSERT_EQ(unlink(path.c_str()), 0);
+    }
+    ASSERT_TRUE(RemoveTree(cache_path));
+    END_TEST;
+}
+
+bool Setup() {
+    BEGIN_HELPER;
+    strcpy(test_dir, "/tmp/blobfs-host-test-XXXXXX");
+    ASSERT_NONNULL(mkdtemp(test_dir), "Failed to create test directory");
+    strcat(test_dir, "/");
+    snprintf(image_path, sizeof(image_path), "%sblobfs.bin", test_dir);
+    END_HELPER;
+}
+
+bool Cleanup() {
+    BEGIN_HELPER;
+    DIR* dir = opendir(test_dir);
+    ASSERT_NONNULL(dir, "Couldn't open test directory");
+
+    struct dirent* de;
+    while ((de = readdir(dir)) != nullptr) {
+        if (!strcmp(de->d_name, ".") || !strcmp(de->d_name, "..")) {
+            continue;
+        }
+        ASSERT_EQ(unlinkat(dirfd(dir), de->d_name, 0), 0);
+    }
+
+    closedir(dir);
+    ASSERT_EQ(rmdir(test_dir), 0, "Failed to remove test directory");
+    END_HELPER;
+}
+
+} // namespace
+
+BEGIN_TEST_CASE(blobfs_host_tests)
+RUN_TEST_MEDIUM(TestAddBlobsConcurrently)
+RUN_TEST_MEDIUM(TestMerkleCache)
+END_TEST_CASE(blobfs_host_tests)
+
+int main(int argc, char** argv) {
+    if (!Setup()) {
+        return -1;
+    }
+    int result = unittest_run_all_tests(argc, argv) ? 0 : -1;
+    if (!Cleanup()) {
+        return -1;
+    }
+    return result;
+}
@@ -0,0 +1,41 @@
+# Copyright 2018 The Fuchsia Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+LOCAL_DIR := $(GET_LOCAL_DIR)
+
+MODULE := $(LOCAL_DIR)
+
+MODULE_TYPE := hosttest
+
+MODULE_SRCS += \
+    $(LOCAL_DIR)/main.cpp \
+    system/ulib/bitmap/raw-bitmap.cpp \
+
+MODULE_NAME := blobfs-host-test
+
+MODULE_COMPILEFLAGS := \
+    -Werror-implicit-function-declaration \
+    -Wstrict-prototypes -Wwrite-strings \
+    -Ithird_party/ulib/lz4/include \
+    -Ithird_party/ulib/uboringssl/include \
+    -Isystem/ulib/bitmap/include \
+    -Isystem/ulib/blobfs/include \
+    -Isystem/ulib/digest/include \
+    -Isystem/ulib/fbl/include \
+    -Isystem/ulib/fdio/include \
+    -Isystem/ulib/fit/include \
+    -Isystem/ulib/fs/include \
+    -Isystem/ulib/unittest/include \
+    -Isystem/ulib/zxcpp/include \
+
+MODULE_HOST_LIBS := \
+    third_party/ulib/lz4.hostlib \
+    third_party/ulib/uboringssl.hostlib \
+    system/ulib/blobfs.hostlib \
+    system/ulib/digest.hostlib \
+    system/ulib/fbl.hostlib \
+    system/ulib/pretty.hostlib \
+    system/ulib/unittest.hostlib \
+
+include make/module.mk
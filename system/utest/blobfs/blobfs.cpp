@@ -2722,6 +2722,78 @@ static bool TestLargeBlob() {
     END_TEST;
 }
 
+// Measures how long blobfs takes to mount after a crash, which leaves journal entries to be
+// replayed. Crashes are simulated at several points while writing a set of small blobs, by putting
+// the ramdisk to sleep after a given number of blocks.
+static bool TestMountAfterCrash() {
+    BEGIN_TEST;
+
+    if (gUseRealDisk) {
+        fprintf(stderr, "Ramdisk required; skipping test\n");
+        return true;
+    }
+
+    constexpr size_t kBlobCount = 128;
+    constexpr uint64_t kCrashPoints = 8;
+
+    fbl::unique_ptr<blob_info_t> infos[kBlobCount];
+    for (size_t i = 0; i < kBlobCount; i++) {
+        ASSERT_TRUE(GenerateRandomBlob(blobfs::kBlobfsBlockSize, &infos[i]));
+    }
+
+    // Count the blocks written when no crash occurs.
+    BlobfsTest blobfsTest(FsTestType::kNormal);
+    blobfsTest.SetStdio(false);
+    ASSERT_TRUE(blobfsTest.Init(), "Mounting Blobfs");
+    ASSERT_TRUE(blobfsTest.ToggleSleep());
+    ASSERT_TRUE(blobfsTest.ToggleSleep());
+
+    fbl::unique_fd fd;
+    for (size_t i = 0; i < kBlobCount; i++) {
+        ASSERT_TRUE(MakeBlob(infos[i].get(), &fd));
+    }
+    ASSERT_EQ(syncfs(fd.get()), 0);
+    fd.reset();
+
+    uint64_t block_count;
+    ASSERT_TRUE(blobfsTest.GetRamdiskCount(&block_count));
+    ASSERT_TRUE(blobfsTest.Teardown(), "Unmounting Blobfs");
+
+    zx_duration_t total_duration = 0;
+    for (uint64_t crash = 1; crash <= kCrashPoints; crash++) {
+        ASSERT_TRUE(blobfsTest.Reset());
+        ASSERT_TRUE(blobfsTest.Init(), "Mounting Blobfs");
+        ASSERT_TRUE(blobfsTest.ToggleSleep(block_count * crash / (kCrashPoints + 1)));
+
+        // Blob creation fails once the ramdisk falls asleep, which is expected.
+        unittest_set_output_function(silent_printf, nullptr);
+        for (size_t i = 0; i < kBlobCount; i++) {
+            MakeBlob(infos[i].get(), &fd);
+        }
+        syncfs(fd.get());
+        fd.reset();
+        current_test_info->all_ok = true;
+        unittest_restore_output_function();
+        ASSERT_TRUE(blobfsTest.ToggleSleep());
+
+        // Mounting replays the journal.
+        zx_time_t start = zx_clock_get_monotonic();
+        ASSERT_TRUE(blobfsTest.ForceRemount());
+        zx_duration_t duration = zx_clock_get_monotonic() - start;
+        total_duration += duration;
+
+        printf("\nCrash after %" PRIu64 " / %" PRIu64 " blocks: mounted in %" PRId64 " us",
+               block_count * crash / (kCrashPoints + 1), block_count, duration / ZX_USEC(1));
+
+        // Teardown checks that the replayed file system is consistent.
+        ASSERT_TRUE(blobfsTest.Teardown(), "Unmounting Blobfs");
+    }
+
+    printf("\nAverage mount time after crash: %" PRId64 " us\n",
+           total_duration / static_cast<zx_duration_t>(kCrashPoints) / ZX_USEC(1));
+    END_TEST;
+}
+
 // TODO(ZX-2416): Add tests to manually corrupt journal entries/metadata.
 
 BEGIN_TEST_CASE(blobfs_tests)
@@ -2769,6 +2841,7 @@ RUN_TESTS(LARGE, CreateWriteReopen)
 RUN_TEST_MEDIUM(TestCreateFailure)
 RUN_TEST_MEDIUM(TestExtendFailure)
 RUN_TEST_LARGE(TestLargeBlob)
+RUN_TEST_PERFORMANCE(TestMountAfterCrash)
 RUN_TESTS(SMALL, TestFailedWrite)
 END_TEST_CASE(blobfs_tests)
 
@@ -231,6 +231,39 @@ bool TestExchangeMultiThread() {
     END_TEST;
 }
 
+int GetShardFn(void* args) {
+    uint32_t* shard = static_cast<uint32_t*>(args);
+    *shard = GetMetricShard();
+    return GetMetricShard() == *shard ? thrd_success : thrd_error;
+}
+
+// Verify that each thread keeps the slot it is first assigned, and that threads are spread
+// across the slots.
+bool TestMetricShard() {
+    BEGIN_TEST;
+    uint32_t shards[kThreads];
+    thrd_t thread_ids[kThreads];
+
+    for (uint64_t i = 0; i < kThreads; ++i) {
+        ASSERT_EQ(thrd_create(&thread_ids[i], GetShardFn, &shards[i]), thrd_success);
+        int result;
+        ASSERT_EQ(thrd_join(thread_ids[i], &result), thrd_success);
+        ASSERT_EQ(result, thrd_success);
+        ASSERT_LT(shards[i], kMetricShards);
+    }
+
+    // Threads are assigned slots round robin, so any |kMetricShards| threads created in a row,
+    // with no other thread updating a metric in between, use every slot.
+    bool used[kMetricShards] = {};
+    for (uint32_t i = 0; i < kMetricShards; ++i) {
+        used[shards[i]] = true;
+    }
+    for (bool shard_used : used) {
+        EXPECT_TRUE(shard_used);
+    }
+    END_TEST;
+}
+
 // Verify flushed values match and the delta is set to 0.
 bool TestFlush() {
     BEGIN_TEST;
@@ -372,6 +405,7 @@ RUN_TEST(TestExchange)
 RUN_TEST(TestExchangeByVal)
 RUN_TEST(TestIncrementMultiThread)
 RUN_TEST(TestExchangeMultiThread)
+RUN_TEST(TestMetricShard)
 END_TEST_CASE(BaseCounterTest)
 
 BEGIN_TEST_CASE(RemoteCounterTest)
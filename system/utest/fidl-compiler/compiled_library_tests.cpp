@@ -0,0 +1,193 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <unittest/unittest.h>
+
+#include <fidl/compiled_library.h>
+#include <fidl/flat_ast.h>
+
+#include "test_library.h"
+
+namespace {
+
+const char kDependency[] = R"FIDL(
+/// A documented library.
+library fidl.test.compiled.dependency;
+
+const uint32 kMaxItems = 16;
+const int8 kNegative = -3;
+const float64 kRatio = 0.1;
+const bool kEnabled = true;
+const string kGreeting = "hello world";
+const uint32 kAlias = kMaxItems;
+
+enum Color : int16 {
+    RED = -1;
+    GREEN = 0;
+    BLUE = 2;
+};
+
+/// A documented struct.
+struct Item {
+    uint64 id;
+    string:kMaxItems? label;
+    array<Color>:4 palette;
+    vector<handle<channel>?>:kAlias channels;
+    float64 ratio = kRatio;
+    request<Base>? base;
+};
+
+table Extra {
+    1: Item item;
+    2: reserved;
+    3: vector<uint8> bytes;
+};
+
+union Either {
+    Item item;
+    bool flag;
+};
+
+xunion Sometimes {
+    Extra extra;
+    int32 value;
+};
+
+[FragileBase]
+interface Base {
+    Ping(Item item) -> (Either result);
+    -> OnPong(Sometimes event);
+};
+
+[Discoverable, FragileBase]
+interface Derived : Base {
+    [Selector = "fidl.test.compiled/Derived.Get"]
+    Get(uint32 index) -> (Item? item);
+};
+
+)FIDL";
+
+const char kDependent[] = R"FIDL(
+library fidl.test.compiled;
+
+using fidl.test.compiled.dependency as dependency;
+
+const uint32 kLocalMax = dependency.kAlias;
+
+struct Holder {
+    dependency.Item item;
+    array<dependency.Color>:kLocalMax colors;
+    dependency.Either? either;
+    dependency.Extra extra;
+    dependency.Sometimes? sometimes;
+};
+
+interface Composed : dependency.Derived {
+    Hold(Holder holder) -> (Holder holder);
+};
+
+)FIDL";
+
+std::string Produce(const fidl::flat::Library* library) {
+    fidl::CompiledLibraryWriter writer(library);
+    return writer.Produce().str();
+}
+
+bool round_trip_test() {
+    BEGIN_TEST;
+
+    TestLibrary dependency("dependency.fidl", kDependency);
+    ASSERT_TRUE(dependency.Compile());
+    std::string compiled = Produce(dependency.library());
+
+    fidl::ErrorReporter error_reporter;
+    fidl::flat::Libraries all_libraries;
+    auto typespace = fidl::flat::Typespace::RootTypes();
+    fidl::CompiledLibraryReader reader(compiled, &all_libraries, &error_reporter, &typespace);
+    auto library = reader.Consume();
+    ASSERT_NONNULL(library.get());
+    EXPECT_STR_EQ(compiled.c_str(), Produce(library.get()).c_str());
+    EXPECT_EQ(error_reporter.errors().size(), 0u);
+
+    END_TEST;
+}
+
+bool compile_against_compiled_library_test() {
+    BEGIN_TEST;
+
+    std::string compiled;
+    std::string expected_json;
+    {
+        TestLibrary dependency("dependency.fidl", kDependency);
+        ASSERT_TRUE(dependency.Compile());
+        compiled = Produce(dependency.library());
+
+        TestLibrary library("dependent.fidl", kDependent);
+        ASSERT_TRUE(library.AddDependentLibrary(dependency));
+        ASSERT_TRUE(library.Compile());
+        expected_json = library.GenerateJSON();
+    }
+
+    TestLibrary library("dependent.fidl", kDependent);
+    ASSERT_TRUE(library.AddCompiledLibrary(compiled));
+    ASSERT_TRUE(library.Compile());
+    EXPECT_STR_EQ(expected_json.c_str(), library.GenerateJSON().c_str());
+
+    END_TEST;
+}
+
+bool missing_dependency_test() {
+    BEGIN_TEST;
+
+    std::string compiled;
+    {
+        TestLibrary dependency("dependency.fidl", kDependency);
+        ASSERT_TRUE(dependency.Compile());
+        TestLibrary library("dependent.fidl", kDependent);
+        ASSERT_TRUE(library.AddDependentLibrary(dependency));
+        ASSERT_TRUE(library.Compile());
+        compiled = Produce(library.library());
+    }
+
+    // The library depends on one that was not loaded first.
+    TestLibrary library("empty.fidl", "library fidl.test.compiled.empty;");
+    EXPECT_FALSE(library.AddCompiledLibrary(compiled));
+
+    END_TEST;
+}
+
+bool malformed_test() {
+    BEGIN_TEST;
+
+    TestLibrary dependency("dependency.fidl", kDependency);
+    ASSERT_TRUE(dependency.Compile());
+    std::string compiled = Produce(dependency.library());
+
+    // Every truncation of a compiled library is rejected, rather than
+    // producing a partial library.
+    for (size_t size = 0u; size < compiled.size(); ++size) {
+        TestLibrary library("empty.fidl", "library fidl.test.compiled.empty;");
+        EXPECT_FALSE(library.AddCompiledLibrary(compiled.substr(0, size)));
+    }
+
+    // So is a compiled library of another version.
+    std::string version = " " + std::to_string(fidl::kCompiledLibraryVersion) + " ";
+    std::string other_version = " " + std::to_string(fidl::kCompiledLibraryVersion + 1) + " ";
+    size_t position = compiled.find(version);
+    ASSERT_NE(position, std::string::npos);
+    compiled.replace(position, version.size(), other_version);
+    TestLibrary library("empty.fidl", "library fidl.test.compiled.empty;");
+    EXPECT_FALSE(library.AddCompiledLibrary(compiled));
+
+    END_TEST;
+}
+
+} // namespace
+
+BEGIN_TEST_CASE(compiled_library_tests);
+RUN_TEST(round_trip_test);
+RUN_TEST(compile_against_compiled_library_test);
+RUN_TEST(missing_dependency_test);
+RUN_TEST(malformed_test);
+END_TEST_CASE(compiled_library_tests);
@@ -0,0 +1,117 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <unittest/unittest.h>
+
+#include <string>
+#include <vector>
+
+#include <fidl/error_reporter.h>
+#include <fidl/lexer.h>
+#include <fidl/source_file.h>
+#include <fidl/token.h>
+
+#include "test_library.h"
+
+namespace {
+
+struct LexedToken {
+    fidl::Token::Kind kind;
+    std::string data;
+};
+
+std::vector<LexedToken> Lex(const std::string& source, fidl::ErrorReporter* error_reporter) {
+    auto source_file = MakeSourceFile("lexer.fidl", source);
+    fidl::Lexer lexer(source_file, error_reporter);
+    std::vector<LexedToken> tokens;
+    for (;;) {
+        auto token = lexer.Lex();
+        tokens.push_back({token.kind(), token.data()});
+        if (token.kind() == fidl::Token::Kind::kEndOfFile)
+            return tokens;
+    }
+}
+
+// The lexer scans identifiers and whitespace several characters at a time.
+// Lex runs of them of every length, at every alignment, and ending at the end
+// of the source.
+bool identifier_and_whitespace_runs_test() {
+    BEGIN_TEST;
+
+    const std::string identifier_chars =
+        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789";
+    const std::string whitespace_chars = " \t\r\n";
+    for (size_t padding = 0u; padding < 9u; ++padding) {
+        for (size_t length = 1u; length < 24u; ++length) {
+            std::string whitespace;
+            for (size_t i = 0u; i < padding; ++i)
+                whitespace.push_back(whitespace_chars[i % whitespace_chars.size()]);
+            std::string identifier = "x";
+            for (size_t i = 1u; i < length; ++i)
+                identifier.push_back(identifier_chars[(i * 7u) % (identifier_chars.size() - 1)]);
+
+            for (const auto& terminator : {std::string(";"), std::string("")}) {
+                std::string source = whitespace + identifier + terminator + whitespace;
+                fidl::ErrorReporter error_reporter;
+                auto tokens = Lex(source, &error_reporter);
+                EXPECT_EQ(error_reporter.errors().size(), 0u);
+                size_t expected_tokens = terminator.empty() ? 2u : 3u;
+                ASSERT_EQ(tokens.size(), expected_tokens);
+                EXPECT_EQ(tokens[0].kind, fidl::Token::Kind::kIdentifier);
+                EXPECT_STR_EQ(tokens[0].data.c_str(), identifier.c_str());
+                if (!terminator.empty())
+                    EXPECT_EQ(tokens[1].kind, fidl::Token::Kind::kSemicolon);
+                EXPECT_EQ(tokens.back().kind, fidl::Token::Kind::kEndOfFile);
+            }
+        }
+    }
+
+    END_TEST;
+}
+
+// Characters adjacent to the identifier characters in ASCII, and those
+// outside of it, end an identifier.
+bool identifier_boundaries_test() {
+    BEGIN_TEST;
+
+    for (char boundary : {'/', ':', '@', '[', '`', '{', '\x7f', '\x80', '\xc3', '\xff'}) {
+        std::string source = "abcdefghijkl";
+        source.push_back(boundary);
+        source += "mnop";
+        fidl::ErrorReporter error_reporter;
+        auto tokens = Lex(source, &error_reporter);
+        ASSERT_GE(tokens.size(), 2u);
+        EXPECT_EQ(tokens[0].kind, fidl::Token::Kind::kIdentifier);
+        EXPECT_STR_EQ(tokens[0].data.c_str(), "abcdefghijkl");
+    }
+
+    END_TEST;
+}
+
+bool comments_test() {
+    BEGIN_TEST;
+
+    fidl::ErrorReporter error_reporter;
+    auto tokens = Lex("// A comment.\n/// A doc comment.\nstruct //// A section break", &error_reporter);
+    EXPECT_EQ(error_reporter.errors().size(), 0u);
+    ASSERT_EQ(tokens.size(), 5u);
+    EXPECT_EQ(tokens[0].kind, fidl::Token::Kind::kComment);
+    EXPECT_STR_EQ(tokens[0].data.c_str(), "// A comment.");
+    EXPECT_EQ(tokens[1].kind, fidl::Token::Kind::kDocComment);
+    EXPECT_STR_EQ(tokens[1].data.c_str(), "/// A doc comment.");
+    EXPECT_EQ(tokens[2].kind, fidl::Token::Kind::kIdentifier);
+    EXPECT_EQ(tokens[3].kind, fidl::Token::Kind::kComment);
+    EXPECT_STR_EQ(tokens[3].data.c_str(), "//// A section break");
+    EXPECT_EQ(tokens[4].kind, fidl::Token::Kind::kEndOfFile);
+
+    END_TEST;
+}
+
+} // namespace
+
+BEGIN_TEST_CASE(lexer_tests);
+RUN_TEST(identifier_and_whitespace_runs_test);
+RUN_TEST(identifier_boundaries_test);
+RUN_TEST(comments_test);
+END_TEST_CASE(lexer_tests);
@@ -64,6 +64,7 @@ std::map<std::string, std::string> Examples::map_ = {\n" >> $@ && \
 
 MODULE_SRCS := \
     $(LOCAL_DIR)/attributes_tests.cpp \
+    $(LOCAL_DIR)/compiled_library_tests.cpp \
     $(LOCAL_DIR)/consts_tests.cpp \
     $(LOCAL_DIR)/declaration_order_tests.cpp \
     $(LOCAL_DIR)/enums_tests.cpp \
@@ -71,6 +72,7 @@ MODULE_SRCS := \
     $(LOCAL_DIR)/flat_ast_tests.cpp \
     $(LOCAL_DIR)/formatter_unittests.cpp \
     $(LOCAL_DIR)/json_generator_tests.cpp \
+    $(LOCAL_DIR)/lexer_tests.cpp \
     $(LOCAL_DIR)/main.cpp \
     $(LOCAL_DIR)/max_bytes_multipass_tests.cpp \
     $(LOCAL_DIR)/max_bytes_tests.cpp \
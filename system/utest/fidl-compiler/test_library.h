@@ -5,6 +5,7 @@
 #ifndef ZIRCON_SYSTEM_UTEST_FIDL_COMPILER_TEST_LIBRARY_H_
 #define ZIRCON_SYSTEM_UTEST_FIDL_COMPILER_TEST_LIBRARY_H_
 
+#include <fidl/compiled_library.h>
 #include <fidl/flat_ast.h>
 #include <fidl/json_generator.h>
 #include <fidl/lexer.h>
@@ -42,6 +43,13 @@ public:
         return true;
     }
 
+    bool AddCompiledLibrary(const std::string& compiled_library) {
+        fidl::CompiledLibraryReader reader(compiled_library, &all_libraries_, &error_reporter_,
+                                           &typespace_);
+        auto library = reader.Consume();
+        return library != nullptr && all_libraries_.Insert(std::move(library));
+    }
+
     void AddAttributeSchema(const std::string& name, fidl::flat::AttributeSchema schema) {
         all_libraries_.AddAttributeSchema(name, std::move(schema));
     }
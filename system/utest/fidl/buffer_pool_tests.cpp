@@ -0,0 +1,145 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+#include <string.h>
+
+#include <utility>
+
+#include <lib/fidl/llcpp/buffer_pool.h>
+#include <zircon/fidl.h>
+
+#include <unittest/unittest.h>
+
+namespace {
+
+bool acquire_and_release_test() {
+    BEGIN_TEST;
+
+    fidl::BufferPool pool(100u, 3u);
+    EXPECT_EQ(pool.buffer_capacity(), 100u);
+    EXPECT_EQ(pool.slab_count(), 1u);
+
+    fidl::BufferPool::Buffer buffers[3];
+    for (auto& buffer : buffers) {
+        buffer = pool.Acquire();
+        ASSERT_TRUE(buffer.is_valid());
+        EXPECT_EQ(buffer.capacity(), 100u);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer.data()) % FIDL_ALIGNMENT, 0u);
+        EXPECT_EQ(buffer.view().capacity(), 100u);
+        EXPECT_EQ(buffer.view().actual(), 0u);
+        memset(buffer.data(), 0xff, buffer.capacity());
+    }
+    EXPECT_EQ(pool.outstanding(), 3u);
+    EXPECT_EQ(pool.slab_count(), 1u);
+
+    // Buffers do not overlap.
+    for (size_t i = 0; i < 3u; i++) {
+        for (size_t j = i + 1; j < 3u; j++) {
+            uint8_t* low = buffers[i].data() < buffers[j].data() ? buffers[i].data()
+                                                                  : buffers[j].data();
+            uint8_t* high = buffers[i].data() < buffers[j].data() ? buffers[j].data()
+                                                                   : buffers[i].data();
+            EXPECT_GE(static_cast<size_t>(high - low), 100u);
+        }
+    }
+
+    // The most recently released buffer is reused first.
+    uint8_t* released = buffers[1].data();
+    buffers[1].reset();
+    EXPECT_FALSE(buffers[1].is_valid());
+    EXPECT_EQ(pool.outstanding(), 2u);
+    buffers[1] = pool.Acquire();
+    EXPECT_EQ(buffers[1].data(), released);
+    EXPECT_EQ(pool.slab_count(), 1u);
+
+    for (auto& buffer : buffers) {
+        buffer.reset();
+    }
+    EXPECT_EQ(pool.outstanding(), 0u);
+
+    END_TEST;
+}
+
+bool grow_test() {
+    BEGIN_TEST;
+
+    fidl::BufferPool pool(16u, 2u);
+    {
+        fidl::BufferPool::Buffer buffers[5];
+        for (auto& buffer : buffers) {
+            buffer = pool.Acquire();
+            ASSERT_TRUE(buffer.is_valid());
+        }
+        EXPECT_EQ(pool.slab_count(), 3u);
+        EXPECT_EQ(pool.outstanding(), 5u);
+    }
+    EXPECT_EQ(pool.outstanding(), 0u);
+
+    // Once grown, the pool serves as many buffers again without allocating.
+    for (int round = 0; round < 10; round++) {
+        fidl::BufferPool::Buffer buffers[6];
+        for (auto& buffer : buffers) {
+            buffer = pool.Acquire();
+        }
+    }
+    EXPECT_EQ(pool.slab_count(), 3u);
+
+    END_TEST;
+}
+
+bool move_test() {
+    BEGIN_TEST;
+
+    fidl::BufferPool pool(8u, 1u);
+    fidl::BufferPool::Buffer buffer = pool.Acquire();
+    uint8_t* data = buffer.data();
+
+    fidl::BufferPool::Buffer moved(std::move(buffer));
+    EXPECT_FALSE(buffer.is_valid());
+    EXPECT_EQ(buffer.capacity(), 0u);
+    EXPECT_EQ(moved.data(), data);
+    EXPECT_EQ(pool.outstanding(), 1u);
+
+    // Assigning over a buffer returns it to the pool.
+    fidl::BufferPool::Buffer other = pool.Acquire();
+    EXPECT_EQ(pool.outstanding(), 2u);
+    other = std::move(moved);
+    EXPECT_EQ(other.data(), data);
+    EXPECT_EQ(pool.outstanding(), 1u);
+
+    other.reset();
+    EXPECT_EQ(pool.outstanding(), 0u);
+
+    END_TEST;
+}
+
+// Buffers smaller than a pointer are still usable, and aligned.
+bool tiny_buffers_test() {
+    BEGIN_TEST;
+
+    fidl::BufferPool pool(1u, 4u);
+    fidl::BufferPool::Buffer buffers[4];
+    for (auto& buffer : buffers) {
+        buffer = pool.Acquire();
+        EXPECT_EQ(buffer.capacity(), 1u);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer.data()) % FIDL_ALIGNMENT, 0u);
+        buffer.data()[0] = 0xff;
+    }
+    for (auto& buffer : buffers) {
+        buffer.reset();
+    }
+    EXPECT_EQ(pool.slab_count(), 1u);
+
+    END_TEST;
+}
+
+} // namespace
+
+BEGIN_TEST_CASE(buffer_pool_tests)
+RUN_TEST(acquire_and_release_test)
+RUN_TEST(grow_test)
+RUN_TEST(move_test)
+RUN_TEST(tiny_buffers_test)
+END_TEST_CASE(buffer_pool_tests);
@@ -0,0 +1,336 @@
+// WARNING: This file is machine generated by fidlc.
+
+#include <lib/fidl/generated_coding.h>
+
+namespace {
+
+template <typename Coder>
+bool fidl_test_coders_PointCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool fidl_test_coders_SettingsCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool fidl_test_coders_ShapeCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool fidl_test_coders_NodeCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool fidl_test_coders_ValueCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool fidl_test_coders_TreeCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool fidl_test_coders_ShapePointerCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool fidl_test_coders_ValuePointerCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool fidl_test_coders_TreePointerCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool String4294967295nonnullableCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool HandlehandlenonnullableCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool VectorHandlehandlenonnullable4nonnullableCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool HandlevmononnullableCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool String32nonnullableCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool Vectorfidl_test_coders_Point16nonnullableCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool HandlehandlenullableCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool String4294967295nullableCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool Vectorfidl_test_coders_Node64nonnullableCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool fidl_test_coders_CoderTestNodesRequestCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool Arrayfidl_test_coders_Point32Coder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool fidl_test_coders_CoderTestNodesResponseCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool fidl_test_coders_CoderTestNestedRequestCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool Vectorfidl_test_coders_Shape16nonnullableCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool fidl_test_coders_CoderTestShapesRequestCoder(Coder* coder, uint32_t offset);
+template <typename Coder>
+bool fidl_test_coders_CoderTestConfigureRequestCoder(Coder* coder, uint32_t offset);
+
+template <typename Coder>
+bool fidl_test_coders_PointCoder(Coder* coder, uint32_t offset) {
+    return true;
+}
+
+template <typename Coder>
+bool fidl_test_coders_SettingsCoder(Coder* coder, uint32_t offset) {
+    return ::fidl::internal::CodeTable(coder, offset, [](Coder* coder, uint32_t ordinal, uint32_t envelope_offset) {
+        switch (ordinal) {
+        case 1u:
+            return ::fidl::internal::CodeEnvelope(coder, envelope_offset, 16u, [](Coder* coder, uint32_t offset) { return String4294967295nonnullableCoder(coder, offset); });
+        case 3u:
+            return ::fidl::internal::CodeEnvelope(coder, envelope_offset, 8u, [](Coder* coder, uint32_t offset) { return fidl_test_coders_PointCoder(coder, offset); });
+        case 4u:
+            return ::fidl::internal::CodeEnvelope(coder, envelope_offset, 16u, [](Coder* coder, uint32_t offset) { return VectorHandlehandlenonnullable4nonnullableCoder(coder, offset); });
+        default:
+            return ::fidl::internal::CodeUnknownEnvelope(coder, envelope_offset);
+        }
+    });
+}
+
+template <typename Coder>
+bool fidl_test_coders_ShapeCoder(Coder* coder, uint32_t offset) {
+    switch (*coder->template At<fidl_union_tag_t>(offset)) {
+    case 0u:
+        return fidl_test_coders_PointCoder(coder, offset + 8u);
+    case 1u:
+        return String4294967295nonnullableCoder(coder, offset + 8u);
+    case 2u:
+        return HandlevmononnullableCoder(coder, offset + 8u);
+    default:
+        return coder->ConstraintViolation("Bad union discriminant");
+    }
+}
+
+template <typename Coder>
+bool fidl_test_coders_ShapePointerCoder(Coder* coder, uint32_t offset) {
+    return ::fidl::internal::CodePointer(coder, offset, 24u, [](Coder* coder, uint32_t offset) { return fidl_test_coders_ShapeCoder(coder, offset); });
+}
+
+template <typename Coder>
+bool fidl_test_coders_NodeCoder(Coder* coder, uint32_t offset) {
+    if (!String32nonnullableCoder(coder, offset))
+        return false;
+    if (!Vectorfidl_test_coders_Point16nonnullableCoder(coder, offset + 16u))
+        return false;
+    if (!HandlehandlenullableCoder(coder, offset + 32u))
+        return false;
+    return true;
+}
+
+template <typename Coder>
+bool fidl_test_coders_ValueCoder(Coder* coder, uint32_t offset) {
+    return ::fidl::internal::CodeXUnion(coder, offset, [](Coder* coder, uint32_t ordinal, uint32_t envelope_offset) {
+        switch (ordinal) {
+        case 1920312276u:
+            return ::fidl::internal::CodeEnvelope(coder, envelope_offset, 40u, [](Coder* coder, uint32_t offset) { return fidl_test_coders_NodeCoder(coder, offset); });
+        case 2112071686u:
+            return ::fidl::internal::CodeEnvelope(coder, envelope_offset, 16u, [](Coder* coder, uint32_t offset) { return String4294967295nonnullableCoder(coder, offset); });
+        default:
+            return ::fidl::internal::CodeUnknownEnvelope(coder, envelope_offset);
+        }
+    });
+}
+
+template <typename Coder>
+bool fidl_test_coders_ValuePointerCoder(Coder* coder, uint32_t offset) {
+    return ::fidl::internal::CodePointer(coder, offset, 24u, [](Coder* coder, uint32_t offset) { return fidl_test_coders_ValueCoder(coder, offset); });
+}
+
+template <typename Coder>
+bool fidl_test_coders_TreeCoder(Coder* coder, uint32_t offset) {
+    if (!String4294967295nullableCoder(coder, offset))
+        return false;
+    if (!fidl_test_coders_TreePointerCoder(coder, offset + 16u))
+        return false;
+    if (!fidl_test_coders_TreePointerCoder(coder, offset + 24u))
+        return false;
+    return true;
+}
+
+template <typename Coder>
+bool fidl_test_coders_TreePointerCoder(Coder* coder, uint32_t offset) {
+    return ::fidl::internal::CodePointer(coder, offset, 32u, [](Coder* coder, uint32_t offset) { return fidl_test_coders_TreeCoder(coder, offset); });
+}
+
+template <typename Coder>
+bool String4294967295nonnullableCoder(Coder* coder, uint32_t offset) {
+    return ::fidl::internal::CodeString(coder, offset, 4294967295u, false);
+}
+
+template <typename Coder>
+bool HandlehandlenonnullableCoder(Coder* coder, uint32_t offset) {
+    return ::fidl::internal::CodeHandle(coder, offset, false);
+}
+
+template <typename Coder>
+bool VectorHandlehandlenonnullable4nonnullableCoder(Coder* coder, uint32_t offset) {
+    return ::fidl::internal::CodeVector(coder, offset, 4u, 4u, false, [](Coder* coder, uint32_t offset) { return HandlehandlenonnullableCoder(coder, offset); });
+}
+
+template <typename Coder>
+bool HandlevmononnullableCoder(Coder* coder, uint32_t offset) {
+    return ::fidl::internal::CodeHandle(coder, offset, false);
+}
+
+template <typename Coder>
+bool String32nonnullableCoder(Coder* coder, uint32_t offset) {
+    return ::fidl::internal::CodeString(coder, offset, 32u, false);
+}
+
+template <typename Coder>
+bool Vectorfidl_test_coders_Point16nonnullableCoder(Coder* coder, uint32_t offset) {
+    return ::fidl::internal::CodeVector(coder, offset, 16u, 8u, false, [](Coder* coder, uint32_t offset) { return fidl_test_coders_PointCoder(coder, offset); });
+}
+
+template <typename Coder>
+bool HandlehandlenullableCoder(Coder* coder, uint32_t offset) {
+    return ::fidl::internal::CodeHandle(coder, offset, true);
+}
+
+template <typename Coder>
+bool String4294967295nullableCoder(Coder* coder, uint32_t offset) {
+    return ::fidl::internal::CodeString(coder, offset, 4294967295u, true);
+}
+
+template <typename Coder>
+bool Vectorfidl_test_coders_Node64nonnullableCoder(Coder* coder, uint32_t offset) {
+    return ::fidl::internal::CodeVector(coder, offset, 64u, 40u, false, [](Coder* coder, uint32_t offset) { return fidl_test_coders_NodeCoder(coder, offset); });
+}
+
+template <typename Coder>
+bool fidl_test_coders_CoderTestNodesRequestCoder(Coder* coder, uint32_t offset) {
+    if (!Vectorfidl_test_coders_Node64nonnullableCoder(coder, offset + 16u))
+        return false;
+    return true;
+}
+
+template <typename Coder>
+bool Arrayfidl_test_coders_Point32Coder(Coder* coder, uint32_t offset) {
+    for (uint32_t element_offset = 0u; element_offset < 32u; element_offset += 8u) {
+        if (!fidl_test_coders_PointCoder(coder, offset + element_offset))
+            return false;
+    }
+    return true;
+}
+
+template <typename Coder>
+bool fidl_test_coders_CoderTestNodesResponseCoder(Coder* coder, uint32_t offset) {
+    if (!Arrayfidl_test_coders_Point32Coder(coder, offset + 16u))
+        return false;
+    return true;
+}
+
+template <typename Coder>
+bool fidl_test_coders_CoderTestNestedRequestCoder(Coder* coder, uint32_t offset) {
+    if (!fidl_test_coders_TreeCoder(coder, offset + 16u))
+        return false;
+    return true;
+}
+
+template <typename Coder>
+bool Vectorfidl_test_coders_Shape16nonnullableCoder(Coder* coder, uint32_t offset) {
+    return ::fidl::internal::CodeVector(coder, offset, 16u, 24u, false, [](Coder* coder, uint32_t offset) { return fidl_test_coders_ShapeCoder(coder, offset); });
+}
+
+template <typename Coder>
+bool fidl_test_coders_CoderTestShapesRequestCoder(Coder* coder, uint32_t offset) {
+    if (!Vectorfidl_test_coders_Shape16nonnullableCoder(coder, offset + 16u))
+        return false;
+    if (!fidl_test_coders_ShapePointerCoder(coder, offset + 32u))
+        return false;
+    return true;
+}
+
+template <typename Coder>
+bool fidl_test_coders_CoderTestConfigureRequestCoder(Coder* coder, uint32_t offset) {
+    if (!fidl_test_coders_SettingsCoder(coder, offset + 16u))
+        return false;
+    if (!fidl_test_coders_ValuePointerCoder(coder, offset + 32u))
+        return false;
+    return true;
+}
+
+} // namespace
+
+extern "C" {
+
+zx_status_t fidl_test_coders_CoderTestNodesRequestEncode(void* bytes, uint32_t num_bytes, zx_handle_t* handles, uint32_t max_handles, uint32_t* out_actual_handles, const char** out_error_msg) {
+    return ::fidl::internal::GeneratedEncode(
+        32u, [](::fidl::internal::GeneratedEncoder* coder) { return fidl_test_coders_CoderTestNodesRequestCoder(coder, 0u); },
+        bytes, num_bytes, handles, max_handles, out_actual_handles, out_error_msg);
+}
+
+zx_status_t fidl_test_coders_CoderTestNodesRequestDecode(void* bytes, uint32_t num_bytes, const zx_handle_t* handles, uint32_t num_handles, const char** out_error_msg) {
+    return ::fidl::internal::GeneratedDecode(
+        32u, [](::fidl::internal::GeneratedDecoder* coder) { return fidl_test_coders_CoderTestNodesRequestCoder(coder, 0u); },
+        bytes, num_bytes, handles, num_handles, out_error_msg);
+}
+
+zx_status_t fidl_test_coders_CoderTestNodesRequestValidate(const void* bytes, uint32_t num_bytes, uint32_t num_handles, const char** out_error_msg) {
+    return ::fidl::internal::GeneratedValidate(
+        32u, [](::fidl::internal::GeneratedValidator* coder) { return fidl_test_coders_CoderTestNodesRequestCoder(coder, 0u); },
+        bytes, num_bytes, num_handles, out_error_msg);
+}
+
+zx_status_t fidl_test_coders_CoderTestNodesResponseEncode(void* bytes, uint32_t num_bytes, zx_handle_t* handles, uint32_t max_handles, uint32_t* out_actual_handles, const char** out_error_msg) {
+    return ::fidl::internal::GeneratedEncode(
+        48u, [](::fidl::internal::GeneratedEncoder* coder) { return fidl_test_coders_CoderTestNodesResponseCoder(coder, 0u); },
+        bytes, num_bytes, handles, max_handles, out_actual_handles, out_error_msg);
+}
+
+zx_status_t fidl_test_coders_CoderTestNodesResponseDecode(void* bytes, uint32_t num_bytes, const zx_handle_t* handles, uint32_t num_handles, const char** out_error_msg) {
+    return ::fidl::internal::GeneratedDecode(
+        48u, [](::fidl::internal::GeneratedDecoder* coder) { return fidl_test_coders_CoderTestNodesResponseCoder(coder, 0u); },
+        bytes, num_bytes, handles, num_handles, out_error_msg);
+}
+
+zx_status_t fidl_test_coders_CoderTestNodesResponseValidate(const void* bytes, uint32_t num_bytes, uint32_t num_handles, const char** out_error_msg) {
+    return ::fidl::internal::GeneratedValidate(
+        48u, [](::fidl::internal::GeneratedValidator* coder) { return fidl_test_coders_CoderTestNodesResponseCoder(coder, 0u); },
+        bytes, num_bytes, num_handles, out_error_msg);
+}
+
+zx_status_t fidl_test_coders_CoderTestNestedRequestEncode(void* bytes, uint32_t num_bytes, zx_handle_t* handles, uint32_t max_handles, uint32_t* out_actual_handles, const char** out_error_msg) {
+    return ::fidl::internal::GeneratedEncode(
+        48u, [](::fidl::internal::GeneratedEncoder* coder) { return fidl_test_coders_CoderTestNestedRequestCoder(coder, 0u); },
+        bytes, num_bytes, handles, max_handles, out_actual_handles, out_error_msg);
+}
+
+zx_status_t fidl_test_coders_CoderTestNestedRequestDecode(void* bytes, uint32_t num_bytes, const zx_handle_t* handles, uint32_t num_handles, const char** out_error_msg) {
+    return ::fidl::internal::GeneratedDecode(
+        48u, [](::fidl::internal::GeneratedDecoder* coder) { return fidl_test_coders_CoderTestNestedRequestCoder(coder, 0u); },
+        bytes, num_bytes, handles, num_handles, out_error_msg);
+}
+
+zx_status_t fidl_test_coders_CoderTestNestedRequestValidate(const void* bytes, uint32_t num_bytes, uint32_t num_handles, const char** out_error_msg) {
+    return ::fidl::internal::GeneratedValidate(
+        48u, [](::fidl::internal::GeneratedValidator* coder) { return fidl_test_coders_CoderTestNestedRequestCoder(coder, 0u); },
+        bytes, num_bytes, num_handles, out_error_msg);
+}
+
+zx_status_t fidl_test_coders_CoderTestShapesRequestEncode(void* bytes, uint32_t num_bytes, zx_handle_t* handles, uint32_t max_handles, uint32_t* out_actual_handles, const char** out_error_msg) {
+    return ::fidl::internal::GeneratedEncode(
+        40u, [](::fidl::internal::GeneratedEncoder* coder) { return fidl_test_coders_CoderTestShapesRequestCoder(coder, 0u); },
+        bytes, num_bytes, handles, max_handles, out_actual_handles, out_error_msg);
+}
+
+zx_status_t fidl_test_coders_CoderTestShapesRequestDecode(void* bytes, uint32_t num_bytes, const zx_handle_t* handles, uint32_t num_handles, const char** out_error_msg) {
+    return ::fidl::internal::GeneratedDecode(
+        40u, [](::fidl::internal::GeneratedDecoder* coder) { return fidl_test_coders_CoderTestShapesRequestCoder(coder, 0u); },
+        bytes, num_bytes, handles, num_handles, out_error_msg);
+}
+
+zx_status_t fidl_test_coders_CoderTestShapesRequestValidate(const void* bytes, uint32_t num_bytes, uint32_t num_handles, const char** out_error_msg) {
+    return ::fidl::internal::GeneratedValidate(
+        40u, [](::fidl::internal::GeneratedValidator* coder) { return fidl_test_coders_CoderTestShapesRequestCoder(coder, 0u); },
+        bytes, num_bytes, num_handles, out_error_msg);
+}
+
+zx_status_t fidl_test_coders_CoderTestConfigureRequestEncode(void* bytes, uint32_t num_bytes, zx_handle_t* handles, uint32_t max_handles, uint32_t* out_actual_handles, const char** out_error_msg) {
+    return ::fidl::internal::GeneratedEncode(
+        40u, [](::fidl::internal::GeneratedEncoder* coder) { return fidl_test_coders_CoderTestConfigureRequestCoder(coder, 0u); },
+        bytes, num_bytes, handles, max_handles, out_actual_handles, out_error_msg);
+}
+
+zx_status_t fidl_test_coders_CoderTestConfigureRequestDecode(void* bytes, uint32_t num_bytes, const zx_handle_t* handles, uint32_t num_handles, const char** out_error_msg) {
+    return ::fidl::internal::GeneratedDecode(
+        40u, [](::fidl::internal::GeneratedDecoder* coder) { return fidl_test_coders_CoderTestConfigureRequestCoder(coder, 0u); },
+        bytes, num_bytes, handles, num_handles, out_error_msg);
+}
+
+zx_status_t fidl_test_coders_CoderTestConfigureRequestValidate(const void* bytes, uint32_t num_bytes, uint32_t num_handles, const char** out_error_msg) {
+    return ::fidl::internal::GeneratedValidate(
+        40u, [](::fidl::internal::GeneratedValidator* coder) { return fidl_test_coders_CoderTestConfigureRequestCoder(coder, 0u); },
+        bytes, num_bytes, num_handles, out_error_msg);
+}
+
+} // extern "C"
@@ -0,0 +1,36 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <lib/fidl/internal.h>
+#include <zircon/types.h>
+
+// "extern" definitions copied from generated_coders_tables.cpp, and the
+// declarations of the coders in generated_coders.cpp, as the C header would
+// have them.
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+extern const fidl_type_t fidl_test_coders_CoderTestNodesRequestTable;
+extern const fidl_type_t fidl_test_coders_CoderTestNestedRequestTable;
+extern const fidl_type_t fidl_test_coders_CoderTestShapesRequestTable;
+extern const fidl_type_t fidl_test_coders_CoderTestConfigureRequestTable;
+
+zx_status_t fidl_test_coders_CoderTestNodesRequestEncode(void* bytes, uint32_t num_bytes, zx_handle_t* handles, uint32_t max_handles, uint32_t* out_actual_handles, const char** out_error_msg);
+zx_status_t fidl_test_coders_CoderTestNodesRequestDecode(void* bytes, uint32_t num_bytes, const zx_handle_t* handles, uint32_t num_handles, const char** out_error_msg);
+zx_status_t fidl_test_coders_CoderTestNodesRequestValidate(const void* bytes, uint32_t num_bytes, uint32_t num_handles, const char** out_error_msg);
+zx_status_t fidl_test_coders_CoderTestNestedRequestEncode(void* bytes, uint32_t num_bytes, zx_handle_t* handles, uint32_t max_handles, uint32_t* out_actual_handles, const char** out_error_msg);
+zx_status_t fidl_test_coders_CoderTestNestedRequestDecode(void* bytes, uint32_t num_bytes, const zx_handle_t* handles, uint32_t num_handles, const char** out_error_msg);
+zx_status_t fidl_test_coders_CoderTestNestedRequestValidate(const void* bytes, uint32_t num_bytes, uint32_t num_handles, const char** out_error_msg);
+zx_status_t fidl_test_coders_CoderTestShapesRequestEncode(void* bytes, uint32_t num_bytes, zx_handle_t* handles, uint32_t max_handles, uint32_t* out_actual_handles, const char** out_error_msg);
+zx_status_t fidl_test_coders_CoderTestShapesRequestDecode(void* bytes, uint32_t num_bytes, const zx_handle_t* handles, uint32_t num_handles, const char** out_error_msg);
+zx_status_t fidl_test_coders_CoderTestShapesRequestValidate(const void* bytes, uint32_t num_bytes, uint32_t num_handles, const char** out_error_msg);
+zx_status_t fidl_test_coders_CoderTestConfigureRequestEncode(void* bytes, uint32_t num_bytes, zx_handle_t* handles, uint32_t max_handles, uint32_t* out_actual_handles, const char** out_error_msg);
+zx_status_t fidl_test_coders_CoderTestConfigureRequestDecode(void* bytes, uint32_t num_bytes, const zx_handle_t* handles, uint32_t num_handles, const char** out_error_msg);
+zx_status_t fidl_test_coders_CoderTestConfigureRequestValidate(const void* bytes, uint32_t num_bytes, uint32_t num_handles, const char** out_error_msg);
+
+#if defined(__cplusplus)
+}
+#endif
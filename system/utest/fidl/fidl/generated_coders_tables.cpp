@@ -0,0 +1,109 @@
+// WARNING: This file is machine generated by fidlc.
+
+#include <lib/fidl/internal.h>
+
+extern "C" {
+
+extern const fidl_type_t fidl_test_coders_PointTable;
+extern const fidl_type_t fidl_test_coders_SettingsTable;
+extern const fidl_type_t fidl_test_coders_ShapeTable;
+extern const fidl_type_t fidl_test_coders_NodeTable;
+extern const fidl_type_t fidl_test_coders_ValueTable;
+extern const fidl_type_t fidl_test_coders_TreeTable;
+
+static const fidl_type_t fidl_test_coders_ShapePointerTable = fidl_type_t(::fidl::FidlCodedUnionPointer(&fidl_test_coders_ShapeTable.coded_union));
+static const fidl_type_t fidl_test_coders_ValuePointerTable = fidl_type_t(::fidl::FidlCodedXUnionPointer(&fidl_test_coders_ValueTable.coded_xunion));
+static const fidl_type_t fidl_test_coders_TreePointerTable = fidl_type_t(::fidl::FidlCodedStructPointer(&fidl_test_coders_TreeTable.coded_struct));
+
+static const fidl_type_t String4294967295nonnullableTable = fidl_type_t(::fidl::FidlCodedString(4294967295, ::fidl::kNonnullable));
+
+static const fidl_type_t HandlehandlenonnullableTable = fidl_type_t(::fidl::FidlCodedHandle(ZX_OBJ_TYPE_NONE, ::fidl::kNonnullable));
+
+static const fidl_type_t VectorHandlehandlenonnullable4nonnullableTable = fidl_type_t(::fidl::FidlCodedVector(&HandlehandlenonnullableTable, 4, 4, ::fidl::kNonnullable));
+
+static const fidl_type_t HandlevmononnullableTable = fidl_type_t(::fidl::FidlCodedHandle(ZX_OBJ_TYPE_VMO, ::fidl::kNonnullable));
+
+static const fidl_type_t String32nonnullableTable = fidl_type_t(::fidl::FidlCodedString(32, ::fidl::kNonnullable));
+
+static const fidl_type_t Vectorfidl_test_coders_Point16nonnullableTable = fidl_type_t(::fidl::FidlCodedVector(&fidl_test_coders_PointTable, 16, 8, ::fidl::kNonnullable));
+
+static const fidl_type_t HandlehandlenullableTable = fidl_type_t(::fidl::FidlCodedHandle(ZX_OBJ_TYPE_NONE, ::fidl::kNullable));
+
+static const fidl_type_t String4294967295nullableTable = fidl_type_t(::fidl::FidlCodedString(4294967295, ::fidl::kNullable));
+
+static const fidl_type_t Vectorfidl_test_coders_Node64nonnullableTable = fidl_type_t(::fidl::FidlCodedVector(&fidl_test_coders_NodeTable, 64, 40, ::fidl::kNonnullable));
+
+extern const fidl_type_t fidl_test_coders_CoderTestNodesRequestTable;
+static const ::fidl::FidlStructField fidl_test_coders_CoderTestNodesRequestFields[] = {
+    ::fidl::FidlStructField(&Vectorfidl_test_coders_Node64nonnullableTable, 16)
+};
+const fidl_type_t fidl_test_coders_CoderTestNodesRequestTable = fidl_type_t(::fidl::FidlCodedStruct(fidl_test_coders_CoderTestNodesRequestFields, 1, 32, 12800, 64, "fidl.test.coders/CoderTestNodesRequest"));
+
+static const fidl_type_t Arrayfidl_test_coders_Point32Table = fidl_type_t(::fidl::FidlCodedArray(&fidl_test_coders_PointTable, 32, 8));
+
+extern const fidl_type_t fidl_test_coders_CoderTestNodesResponseTable;
+static const ::fidl::FidlStructField fidl_test_coders_CoderTestNodesResponseFields[] = {
+    ::fidl::FidlStructField(&Arrayfidl_test_coders_Point32Table, 16)
+};
+const fidl_type_t fidl_test_coders_CoderTestNodesResponseTable = fidl_type_t(::fidl::FidlCodedStruct(fidl_test_coders_CoderTestNodesResponseFields, 1, 48, 0, 0, "fidl.test.coders/CoderTestNodesResponse"));
+
+extern const fidl_type_t fidl_test_coders_CoderTestNestedRequestTable;
+static const ::fidl::FidlStructField fidl_test_coders_CoderTestNestedRequestFields[] = {
+    ::fidl::FidlStructField(&fidl_test_coders_TreeTable, 16)
+};
+const fidl_type_t fidl_test_coders_CoderTestNestedRequestTable = fidl_type_t(::fidl::FidlCodedStruct(fidl_test_coders_CoderTestNestedRequestFields, 1, 48, 4294967295, 4294967295, "fidl.test.coders/CoderTestNestedRequest"));
+
+static const fidl_type_t Vectorfidl_test_coders_Shape16nonnullableTable = fidl_type_t(::fidl::FidlCodedVector(&fidl_test_coders_ShapeTable, 16, 24, ::fidl::kNonnullable));
+
+extern const fidl_type_t fidl_test_coders_CoderTestShapesRequestTable;
+static const ::fidl::FidlStructField fidl_test_coders_CoderTestShapesRequestFields[] = {
+    ::fidl::FidlStructField(&Vectorfidl_test_coders_Shape16nonnullableTable, 16),
+    ::fidl::FidlStructField(&fidl_test_coders_ShapePointerTable, 32)
+};
+const fidl_type_t fidl_test_coders_CoderTestShapesRequestTable = fidl_type_t(::fidl::FidlCodedStruct(fidl_test_coders_CoderTestShapesRequestFields, 2, 40, 4294967295, 17, "fidl.test.coders/CoderTestShapesRequest"));
+
+extern const fidl_type_t fidl_test_coders_CoderTestConfigureRequestTable;
+static const ::fidl::FidlStructField fidl_test_coders_CoderTestConfigureRequestFields[] = {
+    ::fidl::FidlStructField(&fidl_test_coders_SettingsTable, 16),
+    ::fidl::FidlStructField(&fidl_test_coders_ValuePointerTable, 32)
+};
+const fidl_type_t fidl_test_coders_CoderTestConfigureRequestTable = fidl_type_t(::fidl::FidlCodedStruct(fidl_test_coders_CoderTestConfigureRequestFields, 2, 40, 4294967295, 5, "fidl.test.coders/CoderTestConfigureRequest"));
+
+static const ::fidl::FidlStructField fidl_test_coders_PointFields[] = {};
+const fidl_type_t fidl_test_coders_PointTable = fidl_type_t(::fidl::FidlCodedStruct(fidl_test_coders_PointFields, 0, 8, 0, 0, "fidl.test.coders/Point"));
+
+static const ::fidl::FidlTableField fidl_test_coders_SettingsFields[] = {
+    ::fidl::FidlTableField(&String4294967295nonnullableTable,1),
+    ::fidl::FidlTableField(&fidl_test_coders_PointTable,3),
+    ::fidl::FidlTableField(&VectorHandlehandlenonnullable4nonnullableTable,4)
+};
+const fidl_type_t fidl_test_coders_SettingsTable = fidl_type_t(::fidl::FidlCodedTable(fidl_test_coders_SettingsFields, 3, "fidl.test.coders/Settings"));
+
+static const fidl_type_t* fidl_test_coders_ShapeMembers[] = {
+    &fidl_test_coders_PointTable,
+    &String4294967295nonnullableTable,
+    &HandlevmononnullableTable
+};
+const fidl_type_t fidl_test_coders_ShapeTable = fidl_type_t(::fidl::FidlCodedUnion(fidl_test_coders_ShapeMembers, 3, 8, 24, "fidl.test.coders/Shape"));
+
+static const ::fidl::FidlStructField fidl_test_coders_NodeFields[] = {
+    ::fidl::FidlStructField(&String32nonnullableTable, 0),
+    ::fidl::FidlStructField(&Vectorfidl_test_coders_Point16nonnullableTable, 16),
+    ::fidl::FidlStructField(&HandlehandlenullableTable, 32)
+};
+const fidl_type_t fidl_test_coders_NodeTable = fidl_type_t(::fidl::FidlCodedStruct(fidl_test_coders_NodeFields, 3, 40, 160, 1, "fidl.test.coders/Node"));
+
+static const ::fidl::FidlXUnionField fidl_test_coders_ValueFields[] = {
+    ::fidl::FidlXUnionField(&fidl_test_coders_NodeTable,1920312276),
+    ::fidl::FidlXUnionField(&String4294967295nonnullableTable,2112071686)
+};
+const fidl_type_t fidl_test_coders_ValueTable = fidl_type_t(::fidl::FidlCodedXUnion(2, fidl_test_coders_ValueFields, "fidl.test.coders/Value"));
+
+static const ::fidl::FidlStructField fidl_test_coders_TreeFields[] = {
+    ::fidl::FidlStructField(&String4294967295nullableTable, 0),
+    ::fidl::FidlStructField(&fidl_test_coders_TreePointerTable, 16),
+    ::fidl::FidlStructField(&fidl_test_coders_TreePointerTable, 24)
+};
+const fidl_type_t fidl_test_coders_TreeTable = fidl_type_t(::fidl::FidlCodedStruct(fidl_test_coders_TreeFields, 3, 32, 4294967295, 4294967295, "fidl.test.coders/Tree"));
+
+} // extern "C"
@@ -0,0 +1,230 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <lib/fidl/coding.h>
+#include <lib/fidl/internal.h>
+#include <unittest/unittest.h>
+#include <zircon/fidl.h>
+#include <zircon/syscalls.h>
+
+namespace fidl {
+namespace {
+
+// A typical small message, with no out-of-line data or handles.
+struct flat_message_layout {
+    fidl_message_header_t header;
+    uint32_t status;
+};
+
+// A coding table for |flat_message_layout|, as generated by fidlc.
+const fidl_type_t flat_message_type = fidl_type_t(
+    FidlCodedStruct(nullptr, 0, sizeof(flat_message_layout), "flat_message"));
+
+constexpr uint32_t kMessageSize = FIDL_ALIGN(sizeof(flat_message_layout));
+
+// A message holding an inline union of two uint32_t members. It has no out-of-line data or
+// handles, but the union's tag must still be checked.
+struct union_message_layout {
+    fidl_message_header_t header;
+    fidl_union_tag_t tag;
+    uint32_t value;
+};
+
+const fidl_type_t* const union_members[] = {nullptr, nullptr};
+const fidl_type_t union_type = fidl_type_t(
+    FidlCodedUnion(union_members, 2, sizeof(fidl_union_tag_t),
+                   sizeof(fidl_union_tag_t) + sizeof(uint32_t), "union"));
+const FidlStructField union_message_fields[] = {
+    FidlStructField(&union_type, offsetof(union_message_layout, tag)),
+};
+const fidl_type_t union_message_type = fidl_type_t(
+    FidlCodedStruct(union_message_fields, 1, sizeof(union_message_layout), "union_message"));
+
+constexpr uint32_t kUnionMessageSize = FIDL_ALIGN(sizeof(union_message_layout));
+
+bool encode_flat_message() {
+    BEGIN_TEST;
+
+    const fidl_type_t* type = &flat_message_type;
+    uint8_t bytes[kMessageSize + FIDL_ALIGNMENT] = {};
+    zx_handle_t handles[1] = {};
+    uint32_t actual_handles = 1;
+    const char* error = nullptr;
+
+    EXPECT_EQ(fidl_encode(type, bytes, kMessageSize, handles, 1, &actual_handles, &error),
+              ZX_OK);
+    EXPECT_NULL(error, error);
+    EXPECT_EQ(actual_handles, 0u);
+
+    // Trailing bytes are an error.
+    EXPECT_EQ(fidl_encode(type, bytes, sizeof(bytes), handles, 1, &actual_handles, &error),
+              ZX_ERR_INVALID_ARGS);
+    EXPECT_NONNULL(error);
+
+    // So is a message smaller than the type.
+    error = nullptr;
+    EXPECT_EQ(fidl_encode(type, bytes, sizeof(flat_message_layout) - 1, handles, 1,
+                          &actual_handles, &error),
+              ZX_ERR_INVALID_ARGS);
+    EXPECT_NONNULL(error);
+
+    END_TEST;
+}
+
+bool decode_flat_message() {
+    BEGIN_TEST;
+
+    const fidl_type_t* type = &flat_message_type;
+    uint8_t bytes[kMessageSize + FIDL_ALIGNMENT] = {};
+    const char* error = nullptr;
+
+    EXPECT_EQ(fidl_decode(type, bytes, kMessageSize, nullptr, 0, &error), ZX_OK);
+    EXPECT_NULL(error, error);
+
+    EXPECT_EQ(fidl_decode(type, bytes, sizeof(bytes), nullptr, 0, &error),
+              ZX_ERR_INVALID_ARGS);
+    EXPECT_NONNULL(error);
+
+    // Handles sent along with a flat message are an error.
+    zx_handle_t handles[] = {static_cast<zx_handle_t>(23)};
+    error = nullptr;
+    EXPECT_EQ(fidl_decode(type, bytes, kMessageSize, handles, 1, &error),
+              ZX_ERR_INVALID_ARGS);
+    EXPECT_NONNULL(error);
+
+    END_TEST;
+}
+
+bool decode_union_message_bad_tag() {
+    BEGIN_TEST;
+
+    union_message_layout message = {};
+    message.tag = 1;
+    const char* error = nullptr;
+    EXPECT_EQ(fidl_decode(&union_message_type, &message, sizeof(message), nullptr, 0, &error),
+              ZX_OK);
+    EXPECT_NULL(error, error);
+    EXPECT_EQ(fidl_validate(&union_message_type, &message, sizeof(message), 0, &error), ZX_OK);
+    EXPECT_NULL(error, error);
+
+    message.tag = 2;
+    EXPECT_EQ(fidl_decode(&union_message_type, &message, sizeof(message), nullptr, 0, &error),
+              ZX_ERR_INVALID_ARGS);
+    EXPECT_NONNULL(error);
+    error = nullptr;
+    EXPECT_EQ(fidl_validate(&union_message_type, &message, sizeof(message), 0, &error),
+              ZX_ERR_INVALID_ARGS);
+    EXPECT_NONNULL(error);
+
+    END_TEST;
+}
+
+bool validate_flat_message() {
+    BEGIN_TEST;
+
+    const fidl_type_t* type = &flat_message_type;
+    uint8_t bytes[kMessageSize + FIDL_ALIGNMENT] = {};
+    const char* error = nullptr;
+
+    EXPECT_EQ(fidl_validate(type, bytes, kMessageSize, 0, &error), ZX_OK);
+    EXPECT_NULL(error, error);
+
+    EXPECT_EQ(fidl_validate(type, bytes, sizeof(bytes), 0, &error), ZX_ERR_INVALID_ARGS);
+    EXPECT_NONNULL(error);
+
+    error = nullptr;
+    EXPECT_EQ(fidl_validate(type, bytes, kMessageSize, 1, &error), ZX_ERR_INVALID_ARGS);
+    EXPECT_NONNULL(error);
+
+    END_TEST;
+}
+
+bool linearize_flat_message() {
+    BEGIN_TEST;
+
+    const fidl_type_t* type = &flat_message_type;
+    flat_message_layout message;
+    memset(&message, 0xab, sizeof(message));
+    message.status = 42;
+
+    uint8_t buffer[kMessageSize + FIDL_ALIGNMENT];
+    memset(buffer, 0xcd, sizeof(buffer));
+    uint32_t actual_num_bytes = 0;
+    const char* error = nullptr;
+
+    EXPECT_EQ(fidl_linearize(type, &message, buffer, sizeof(buffer), &actual_num_bytes,
+                             &error),
+              ZX_OK);
+    EXPECT_NULL(error, error);
+    EXPECT_EQ(actual_num_bytes, kMessageSize);
+    EXPECT_BYTES_EQ(buffer, reinterpret_cast<uint8_t*>(&message),
+                    sizeof(flat_message_layout), "");
+
+    // The padding after the message is zeroed.
+    for (uint32_t i = sizeof(flat_message_layout); i < kMessageSize; i++) {
+        EXPECT_EQ(buffer[i], 0);
+    }
+
+    EXPECT_EQ(fidl_linearize(type, &message, buffer, sizeof(flat_message_layout) - 1,
+                             &actual_num_bytes, &error),
+              ZX_ERR_BUFFER_TOO_SMALL);
+
+    END_TEST;
+}
+
+constexpr uint32_t kBenchmarkIterations = 1000000;
+
+// Returns the average time, in nanoseconds, taken to encode and decode a zeroed message of |type|,
+// which is |size| bytes long.
+bool BenchmarkEncodeDecode(const fidl_type_t* type, uint32_t size, zx_duration_t* out_ns) {
+    BEGIN_HELPER;
+
+    alignas(FIDL_ALIGNMENT) uint8_t bytes[kUnionMessageSize] = {};
+    ASSERT_LE(size, sizeof(bytes));
+    zx_handle_t handles[ZX_CHANNEL_MAX_MSG_HANDLES];
+    zx_time_t start = zx_clock_get_monotonic();
+    for (uint32_t i = 0; i < kBenchmarkIterations; i++) {
+        uint32_t actual_handles;
+        ASSERT_EQ(fidl_encode(type, bytes, size, handles, ZX_CHANNEL_MAX_MSG_HANDLES,
+                              &actual_handles, nullptr),
+                  ZX_OK);
+        ASSERT_EQ(fidl_decode(type, bytes, size, handles, actual_handles, nullptr), ZX_OK);
+    }
+    *out_ns = (zx_clock_get_monotonic() - start) / kBenchmarkIterations;
+
+    END_HELPER;
+}
+
+bool benchmark_flat_message() {
+    BEGIN_TEST;
+
+    // The union message has a single field to code, so it is walked.
+    zx_duration_t flat_ns, walked_ns;
+    ASSERT_TRUE(BenchmarkEncodeDecode(&flat_message_type, kMessageSize, &flat_ns));
+    ASSERT_TRUE(BenchmarkEncodeDecode(&union_message_type, kUnionMessageSize, &walked_ns));
+
+    printf("\nEncode + decode: %" PRId64 " ns for a %u byte flat message, %" PRId64
+           " ns for a %u byte walked message\n",
+           flat_ns, kMessageSize, walked_ns, kUnionMessageSize);
+
+    END_TEST;
+}
+
+} // namespace
+
+BEGIN_TEST_CASE(flat_coding)
+RUN_TEST(encode_flat_message)
+RUN_TEST(decode_flat_message)
+RUN_TEST(decode_union_message_bad_tag)
+RUN_TEST(validate_flat_message)
+RUN_TEST(linearize_flat_message)
+RUN_TEST_PERFORMANCE(benchmark_flat_message)
+END_TEST_CASE(flat_coding)
+
+} // namespace fidl
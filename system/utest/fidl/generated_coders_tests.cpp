@@ -0,0 +1,689 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <lib/fidl/coding.h>
+#include <unittest/unittest.h>
+#include <zircon/assert.h>
+#include <zircon/fidl.h>
+#include <zircon/syscalls.h>
+
+#include "fidl/generated_coders.h"
+
+namespace fidl {
+namespace {
+
+// The coders generated for fidl/generated_coders.fidl must encode, decode and
+// validate exactly like the coding tables generated for it.
+
+constexpr zx_handle_t dummy_handle_0 = static_cast<zx_handle_t>(23);
+constexpr zx_handle_t dummy_handle_1 = static_cast<zx_handle_t>(24);
+
+using EncodeFn = zx_status_t (*)(void* bytes, uint32_t num_bytes, zx_handle_t* handles,
+                                 uint32_t max_handles, uint32_t* out_actual_handles,
+                                 const char** out_error_msg);
+using DecodeFn = zx_status_t (*)(void* bytes, uint32_t num_bytes, const zx_handle_t* handles,
+                                 uint32_t num_handles, const char** out_error_msg);
+using ValidateFn = zx_status_t (*)(const void* bytes, uint32_t num_bytes, uint32_t num_handles,
+                                   const char** out_error_msg);
+
+// The coding table of a message, and the coders generated for it.
+struct MessageCoders {
+    const fidl_type_t* table;
+    EncodeFn encode;
+    DecodeFn decode;
+    ValidateFn validate;
+};
+
+const MessageCoders kNodesCoders = {
+    &fidl_test_coders_CoderTestNodesRequestTable,
+    fidl_test_coders_CoderTestNodesRequestEncode,
+    fidl_test_coders_CoderTestNodesRequestDecode,
+    fidl_test_coders_CoderTestNodesRequestValidate,
+};
+
+const MessageCoders kNestedCoders = {
+    &fidl_test_coders_CoderTestNestedRequestTable,
+    fidl_test_coders_CoderTestNestedRequestEncode,
+    fidl_test_coders_CoderTestNestedRequestDecode,
+    fidl_test_coders_CoderTestNestedRequestValidate,
+};
+
+const MessageCoders kShapesCoders = {
+    &fidl_test_coders_CoderTestShapesRequestTable,
+    fidl_test_coders_CoderTestShapesRequestEncode,
+    fidl_test_coders_CoderTestShapesRequestDecode,
+    fidl_test_coders_CoderTestShapesRequestValidate,
+};
+
+// Encodes the same message as |walked| with the coding table and as |generated| with the
+// generated coders, and checks that both produce the same bytes and |expected_handles| handles.
+// The handles are returned in |handles|.
+bool EncodeBoth(const MessageCoders& coders, void* walked, void* generated, uint32_t num_bytes,
+                uint32_t expected_handles, zx_handle_t* handles) {
+    BEGIN_HELPER;
+
+    zx_handle_t walked_handles[ZX_CHANNEL_MAX_MSG_HANDLES];
+    uint32_t walked_actual_handles = 0;
+    uint32_t generated_actual_handles = 0;
+    const char* error = nullptr;
+    ASSERT_EQ(fidl_encode(coders.table, walked, num_bytes, walked_handles,
+                          ZX_CHANNEL_MAX_MSG_HANDLES, &walked_actual_handles, &error),
+              ZX_OK, error);
+    ASSERT_EQ(coders.encode(generated, num_bytes, handles, ZX_CHANNEL_MAX_MSG_HANDLES,
+                            &generated_actual_handles, &error),
+              ZX_OK, error);
+    EXPECT_EQ(generated_actual_handles, expected_handles);
+    EXPECT_EQ(walked_actual_handles, generated_actual_handles);
+    EXPECT_BYTES_EQ(reinterpret_cast<uint8_t*>(generated), reinterpret_cast<uint8_t*>(walked),
+                    num_bytes, "");
+    EXPECT_BYTES_EQ(reinterpret_cast<uint8_t*>(handles),
+                    reinterpret_cast<uint8_t*>(walked_handles),
+                    generated_actual_handles * sizeof(zx_handle_t), "");
+
+    END_HELPER;
+}
+
+// Checks that the walker and the generated coders both reject |walked| and |generated|, two
+// copies of the same damaged message, with the same error.
+bool ExpectSameErrors(const MessageCoders& coders, void* walked, void* generated,
+                      uint32_t num_bytes, const zx_handle_t* handles, uint32_t num_handles) {
+    BEGIN_HELPER;
+
+    const char* walked_error = nullptr;
+    const char* generated_error = nullptr;
+    EXPECT_EQ(fidl_validate(coders.table, walked, num_bytes, num_handles, &walked_error),
+              ZX_ERR_INVALID_ARGS);
+    EXPECT_EQ(coders.validate(generated, num_bytes, num_handles, &generated_error),
+              ZX_ERR_INVALID_ARGS);
+    ASSERT_NONNULL(walked_error);
+    ASSERT_NONNULL(generated_error);
+    EXPECT_STR_EQ(generated_error, walked_error);
+
+    walked_error = nullptr;
+    generated_error = nullptr;
+    EXPECT_EQ(fidl_decode(coders.table, walked, num_bytes, handles, num_handles, &walked_error),
+              ZX_ERR_INVALID_ARGS);
+    EXPECT_EQ(coders.decode(generated, num_bytes, handles, num_handles, &generated_error),
+              ZX_ERR_INVALID_ARGS);
+    ASSERT_NONNULL(walked_error);
+    ASSERT_NONNULL(generated_error);
+    EXPECT_STR_EQ(generated_error, walked_error);
+
+    END_HELPER;
+}
+
+struct point_layout {
+    int32_t x;
+    int32_t y;
+};
+
+struct node_layout {
+    fidl_string_t name;
+    fidl_vector_t points;
+    zx_handle_t handle;
+    uint32_t padding;
+};
+
+constexpr uint32_t kNodeCount = 8;
+constexpr uint32_t kPointsPerNode = 4;
+constexpr uint32_t kNodeHandles = 2;
+
+// A CoderTest.Nodes request, followed by its out-of-line objects in the order
+// they are encoded.
+struct nodes_message_layout {
+    fidl_message_header_t header;
+    fidl_vector_t nodes;
+    node_layout node_data[kNodeCount];
+    struct {
+        char name[8];
+        point_layout points[kPointsPerNode];
+    } node_objects[kNodeCount];
+};
+
+void BuildNodesMessage(nodes_message_layout* message) {
+    memset(message, 0, sizeof(*message));
+    message->nodes.count = kNodeCount;
+    message->nodes.data = message->node_data;
+    for (uint32_t i = 0; i < kNodeCount; i++) {
+        node_layout* node = &message->node_data[i];
+        auto* objects = &message->node_objects[i];
+        snprintf(objects->name, sizeof(objects->name), "node%u", i);
+        node->name.size = strlen(objects->name);
+        node->name.data = objects->name;
+        for (uint32_t j = 0; j < kPointsPerNode; j++) {
+            objects->points[j] = point_layout{static_cast<int32_t>(i), static_cast<int32_t>(j)};
+        }
+        node->points.count = kPointsPerNode;
+        node->points.data = objects->points;
+        node->handle = ZX_HANDLE_INVALID;
+    }
+    message->node_data[0].handle = dummy_handle_0;
+    message->node_data[1].handle = dummy_handle_1;
+}
+
+bool nodes_message_coding() {
+    BEGIN_TEST;
+
+    nodes_message_layout walked, generated;
+    BuildNodesMessage(&walked);
+    BuildNodesMessage(&generated);
+
+    zx_handle_t walked_handles[ZX_CHANNEL_MAX_MSG_HANDLES];
+    zx_handle_t generated_handles[ZX_CHANNEL_MAX_MSG_HANDLES];
+    uint32_t walked_actual_handles = 0;
+    uint32_t generated_actual_handles = 0;
+    const char* error = nullptr;
+    ASSERT_EQ(fidl_encode(&fidl_test_coders_CoderTestNodesRequestTable, &walked, sizeof(walked),
+                          walked_handles, ZX_CHANNEL_MAX_MSG_HANDLES, &walked_actual_handles,
+                          &error),
+              ZX_OK);
+    ASSERT_EQ(fidl_test_coders_CoderTestNodesRequestEncode(
+                  &generated, sizeof(generated), generated_handles, ZX_CHANNEL_MAX_MSG_HANDLES,
+                  &generated_actual_handles, &error),
+              ZX_OK, error);
+    EXPECT_EQ(generated_actual_handles, kNodeHandles);
+    EXPECT_EQ(walked_actual_handles, generated_actual_handles);
+    EXPECT_BYTES_EQ(reinterpret_cast<uint8_t*>(&generated), reinterpret_cast<uint8_t*>(&walked),
+                    sizeof(generated), "");
+    EXPECT_BYTES_EQ(reinterpret_cast<uint8_t*>(generated_handles),
+                    reinterpret_cast<uint8_t*>(walked_handles),
+                    generated_actual_handles * sizeof(zx_handle_t), "");
+
+    EXPECT_EQ(fidl_test_coders_CoderTestNodesRequestValidate(&generated, sizeof(generated),
+                                                             kNodeHandles, &error),
+              ZX_OK, error);
+
+    EXPECT_EQ(fidl_test_coders_CoderTestNodesRequestDecode(&generated, sizeof(generated),
+                                                           generated_handles, kNodeHandles,
+                                                           &error),
+              ZX_OK, error);
+    EXPECT_EQ(generated.nodes.data, generated.node_data);
+    for (uint32_t i = 0; i < kNodeCount; i++) {
+        EXPECT_EQ(generated.node_data[i].name.data, generated.node_objects[i].name);
+        EXPECT_EQ(generated.node_data[i].points.data, generated.node_objects[i].points);
+    }
+    EXPECT_EQ(generated.node_data[0].handle, dummy_handle_0);
+    EXPECT_EQ(generated.node_data[1].handle, dummy_handle_1);
+    EXPECT_EQ(generated.node_data[2].handle, ZX_HANDLE_INVALID);
+
+    END_TEST;
+}
+
+// Damages an encoded CoderTest.Nodes request.
+using Damage = void (*)(nodes_message_layout* message);
+
+bool nodes_message_errors() {
+    BEGIN_TEST;
+
+    const Damage damages[] = {
+        [](nodes_message_layout* message) { message->node_data[1].name.size = 33; },
+        [](nodes_message_layout* message) { message->node_data[2].points.data = nullptr; },
+        [](nodes_message_layout* message) { message->node_data[3].points.count = 17; },
+        [](nodes_message_layout* message) { message->nodes.count = kNodeCount + 1; },
+        [](nodes_message_layout* message) { message->node_data[4].handle = FIDL_HANDLE_PRESENT; },
+        [](nodes_message_layout* message) { message->node_data[0].handle = ZX_HANDLE_INVALID; },
+        [](nodes_message_layout* message) {
+            message->node_data[5].name.data = reinterpret_cast<char*>(42);
+        },
+    };
+
+    nodes_message_layout encoded;
+    BuildNodesMessage(&encoded);
+    zx_handle_t handles[ZX_CHANNEL_MAX_MSG_HANDLES];
+    uint32_t actual_handles = 0;
+    ASSERT_EQ(fidl_encode(&fidl_test_coders_CoderTestNodesRequestTable, &encoded, sizeof(encoded),
+                          handles, ZX_CHANNEL_MAX_MSG_HANDLES, &actual_handles, nullptr),
+              ZX_OK);
+
+    for (Damage damage : damages) {
+        nodes_message_layout walked = encoded;
+        nodes_message_layout generated = encoded;
+        damage(&walked);
+        damage(&generated);
+        EXPECT_TRUE(ExpectSameErrors(kNodesCoders, &walked, &generated, sizeof(walked), handles,
+                                     actual_handles));
+    }
+
+    END_TEST;
+}
+
+struct tree_layout {
+    fidl_string_t label;
+    tree_layout* left;
+    tree_layout* right;
+};
+
+constexpr uint32_t kTreeDepth = 4;
+constexpr uint32_t kTreeNodes = (1u << (kTreeDepth + 1)) - 1;
+constexpr uint32_t kLabelSize = 8;
+
+// A CoderTest.Nested request holding a complete binary tree, followed by its
+// out-of-line objects: each node's label and then its children, depth first.
+struct nested_message_layout {
+    fidl_message_header_t header;
+    tree_layout tree;
+    uint8_t objects[(kTreeNodes - 1) * sizeof(tree_layout) + kTreeNodes * kLabelSize];
+};
+
+static_assert(sizeof(nested_message_layout) == FIDL_ALIGN(sizeof(nested_message_layout)),
+              "the message must not need trailing padding");
+
+class TreeBuilder {
+public:
+    explicit TreeBuilder(nested_message_layout* message) : message_(message) {}
+
+    void Build(tree_layout* node, uint32_t depth) {
+        char* label = static_cast<char*>(Allocate(kLabelSize));
+        snprintf(label, kLabelSize, "n%u", label_count_++);
+        node->label.size = strlen(label);
+        node->label.data = label;
+        if (depth == 0) {
+            node->left = nullptr;
+            node->right = nullptr;
+            return;
+        }
+        node->left = static_cast<tree_layout*>(Allocate(sizeof(tree_layout)));
+        Build(node->left, depth - 1);
+        node->right = static_cast<tree_layout*>(Allocate(sizeof(tree_layout)));
+        Build(node->right, depth - 1);
+    }
+
+    uint32_t used() const { return used_; }
+
+private:
+    void* Allocate(uint32_t size) {
+        void* object = &message_->objects[used_];
+        used_ += FIDL_ALIGN(size);
+        return object;
+    }
+
+    nested_message_layout* message_;
+    uint32_t used_ = 0;
+    uint32_t label_count_ = 0;
+};
+
+void BuildNestedMessage(nested_message_layout* message) {
+    memset(message, 0, sizeof(*message));
+    TreeBuilder builder(message);
+    builder.Build(&message->tree, kTreeDepth);
+    ZX_ASSERT(builder.used() == sizeof(message->objects));
+}
+
+// Counts the nodes of a decoded tree, checking that each points into |message|.
+uint32_t CountTreeNodes(const nested_message_layout* message, const tree_layout* node) {
+    const uint8_t* start = reinterpret_cast<const uint8_t*>(message);
+    const uint8_t* end = start + sizeof(*message);
+    auto inside = [start, end](const void* p) {
+        return static_cast<const uint8_t*>(p) >= start && static_cast<const uint8_t*>(p) < end;
+    };
+    if (node == nullptr || !inside(node) || !inside(node->label.data)) {
+        return 0;
+    }
+    return 1 + CountTreeNodes(message, node->left) + CountTreeNodes(message, node->right);
+}
+
+bool nested_message_coding() {
+    BEGIN_TEST;
+
+    nested_message_layout walked, generated;
+    BuildNestedMessage(&walked);
+    BuildNestedMessage(&generated);
+    zx_handle_t handles[ZX_CHANNEL_MAX_MSG_HANDLES];
+    ASSERT_TRUE(EncodeBoth(kNestedCoders, &walked, &generated, sizeof(generated), 0, handles));
+
+    const char* error = nullptr;
+    EXPECT_EQ(kNestedCoders.validate(&generated, sizeof(generated), 0, &error), ZX_OK, error);
+    EXPECT_EQ(kNestedCoders.decode(&generated, sizeof(generated), nullptr, 0, &error), ZX_OK,
+              error);
+    EXPECT_EQ(CountTreeNodes(&generated, &generated.tree), kTreeNodes);
+    EXPECT_STR_EQ(generated.tree.label.data, "n0");
+    EXPECT_STR_EQ(generated.tree.left->label.data, "n1");
+
+    END_TEST;
+}
+
+// Damages an encoded CoderTest.Nested request.
+using NestedDamage = void (*)(nested_message_layout* message);
+
+bool nested_message_errors() {
+    BEGIN_TEST;
+
+    const NestedDamage damages[] = {
+        [](nested_message_layout* message) {
+            message->tree.label.data = reinterpret_cast<char*>(42);
+        },
+        [](nested_message_layout* message) { message->tree.label.data = nullptr; },
+        [](nested_message_layout* message) {
+            message->tree.right = reinterpret_cast<tree_layout*>(42);
+        },
+        [](nested_message_layout* message) { message->tree.right = nullptr; },
+    };
+
+    nested_message_layout encoded;
+    BuildNestedMessage(&encoded);
+    ASSERT_EQ(fidl_encode(kNestedCoders.table, &encoded, sizeof(encoded), nullptr, 0, nullptr,
+                          nullptr),
+              ZX_OK);
+
+    for (NestedDamage damage : damages) {
+        nested_message_layout walked = encoded;
+        nested_message_layout generated = encoded;
+        damage(&walked);
+        damage(&generated);
+        EXPECT_TRUE(ExpectSameErrors(kNestedCoders, &walked, &generated, sizeof(walked),
+                                     nullptr, 0));
+    }
+
+    END_TEST;
+}
+
+struct shape_layout {
+    fidl_union_tag_t tag;
+    uint32_t padding;
+    union {
+        point_layout point;
+        fidl_string_t circle;
+        zx_handle_t buffer;
+    };
+};
+
+enum ShapeTag : fidl_union_tag_t {
+    kShapePoint = 0,
+    kShapeCircle = 1,
+    kShapeBuffer = 2,
+};
+
+constexpr uint32_t kShapeCount = 3;
+
+// A CoderTest.Shapes request with one shape of each kind, and a circle as its
+// extra shape, followed by its out-of-line objects in the order they are
+// encoded.
+struct shapes_message_layout {
+    fidl_message_header_t header;
+    fidl_vector_t shapes;
+    shape_layout* extra;
+    shape_layout shape_data[kShapeCount];
+    char circle_data[8];
+    shape_layout extra_data;
+    char extra_circle_data[8];
+};
+
+void BuildShapesMessage(shapes_message_layout* message) {
+    memset(message, 0, sizeof(*message));
+    message->shapes.count = kShapeCount;
+    message->shapes.data = message->shape_data;
+
+    message->shape_data[0].tag = kShapePoint;
+    message->shape_data[0].point = point_layout{3, 4};
+    message->shape_data[1].tag = kShapeCircle;
+    memcpy(message->circle_data, "round", 5);
+    message->shape_data[1].circle.size = 5;
+    message->shape_data[1].circle.data = message->circle_data;
+    message->shape_data[2].tag = kShapeBuffer;
+    message->shape_data[2].buffer = dummy_handle_0;
+
+    message->extra = &message->extra_data;
+    message->extra_data.tag = kShapeCircle;
+    memcpy(message->extra_circle_data, "ring", 4);
+    message->extra_data.circle.size = 4;
+    message->extra_data.circle.data = message->extra_circle_data;
+}
+
+bool shapes_message_coding() {
+    BEGIN_TEST;
+
+    shapes_message_layout walked, generated;
+    BuildShapesMessage(&walked);
+    BuildShapesMessage(&generated);
+    zx_handle_t handles[ZX_CHANNEL_MAX_MSG_HANDLES];
+    ASSERT_TRUE(EncodeBoth(kShapesCoders, &walked, &generated, sizeof(generated), 1, handles));
+    EXPECT_EQ(handles[0], dummy_handle_0);
+
+    const char* error = nullptr;
+    EXPECT_EQ(kShapesCoders.validate(&generated, sizeof(generated), 1, &error), ZX_OK, error);
+
+    // The extra shape is optional.
+    shapes_message_layout without_extra = generated;
+    without_extra.extra = nullptr;
+    EXPECT_EQ(kShapesCoders.validate(&without_extra,
+                                     offsetof(shapes_message_layout, extra_data), 1, &error),
+              ZX_OK, error);
+
+    EXPECT_EQ(kShapesCoders.decode(&generated, sizeof(generated), handles, 1, &error), ZX_OK,
+              error);
+    EXPECT_EQ(generated.shapes.data, generated.shape_data);
+    EXPECT_EQ(generated.shape_data[0].point.x, 3);
+    EXPECT_EQ(generated.shape_data[0].point.y, 4);
+    EXPECT_EQ(generated.shape_data[1].circle.data, generated.circle_data);
+    EXPECT_EQ(generated.shape_data[2].buffer, dummy_handle_0);
+    EXPECT_EQ(generated.extra, &generated.extra_data);
+    EXPECT_EQ(generated.extra_data.circle.data, generated.extra_circle_data);
+
+    END_TEST;
+}
+
+// Damages an encoded CoderTest.Shapes request.
+using ShapesDamage = void (*)(shapes_message_layout* message);
+
+bool shapes_message_errors() {
+    BEGIN_TEST;
+
+    const ShapesDamage damages[] = {
+        [](shapes_message_layout* message) { message->shape_data[0].tag = kShapeCount; },
+        [](shapes_message_layout* message) { message->extra_data.tag = 0xffffffff; },
+        [](shapes_message_layout* message) { message->shape_data[1].circle.data = nullptr; },
+        [](shapes_message_layout* message) {
+            message->shape_data[2].buffer = ZX_HANDLE_INVALID;
+        },
+        [](shapes_message_layout* message) { message->shapes.count = 17; },
+        [](shapes_message_layout* message) {
+            message->extra = reinterpret_cast<shape_layout*>(42);
+        },
+        // A point where a circle was encoded leaves the circle's data unclaimed.
+        [](shapes_message_layout* message) { message->shape_data[1].tag = kShapePoint; },
+    };
+
+    shapes_message_layout encoded;
+    BuildShapesMessage(&encoded);
+    zx_handle_t handles[ZX_CHANNEL_MAX_MSG_HANDLES];
+    uint32_t actual_handles = 0;
+    ASSERT_EQ(fidl_encode(kShapesCoders.table, &encoded, sizeof(encoded), handles,
+                          ZX_CHANNEL_MAX_MSG_HANDLES, &actual_handles, nullptr),
+              ZX_OK);
+
+    for (ShapesDamage damage : damages) {
+        shapes_message_layout walked = encoded;
+        shapes_message_layout generated = encoded;
+        damage(&walked);
+        damage(&generated);
+        EXPECT_TRUE(ExpectSameErrors(kShapesCoders, &walked, &generated, sizeof(walked), handles,
+                                     actual_handles));
+    }
+
+    END_TEST;
+}
+
+// The ordinal fidlc assigns to Value.text.
+constexpr uint32_t kValueTextOrdinal = 2112071686u;
+
+// A CoderTest.Configure request whose settings have a name and flags, the
+// latter of which the coders treat as an unknown field as it holds plain data.
+struct configure_message_layout {
+    fidl_message_header_t header;
+    fidl_vector_t settings;
+    fidl_xunion_t* value;
+    fidl_envelope_t envelopes[5];
+    fidl_string_t name;
+    char name_data[8];
+    uint32_t flags;
+    uint32_t flags_padding;
+    fidl_xunion_t value_data;
+    fidl_string_t text;
+    char text_data[8];
+};
+
+void BuildConfigureMessage(configure_message_layout* message) {
+    memset(message, 0, sizeof(*message));
+    message->settings.count = 5;
+    message->settings.data = message->envelopes;
+    message->envelopes[0].num_bytes = sizeof(message->name) + sizeof(message->name_data);
+    message->envelopes[0].data = &message->name;
+    message->envelopes[4].num_bytes = sizeof(message->flags) + sizeof(message->flags_padding);
+    message->envelopes[4].data = &message->flags;
+    memcpy(message->name_data, "hi", 2);
+    message->name.size = 2;
+    message->name.data = message->name_data;
+    message->flags = 7;
+
+    message->value = &message->value_data;
+    message->value_data.tag = kValueTextOrdinal;
+    message->value_data.envelope.num_bytes = sizeof(message->text) + sizeof(message->text_data);
+    message->value_data.envelope.data = &message->text;
+    memcpy(message->text_data, "hello", 5);
+    message->text.size = 5;
+    message->text.data = message->text_data;
+}
+
+bool configure_message_coding() {
+    BEGIN_TEST;
+
+    configure_message_layout walked, generated;
+    BuildConfigureMessage(&walked);
+    BuildConfigureMessage(&generated);
+
+    uint32_t actual_handles = 0;
+    const char* error = nullptr;
+    ASSERT_EQ(fidl_encode(&fidl_test_coders_CoderTestConfigureRequestTable, &walked,
+                          sizeof(walked), nullptr, 0, &actual_handles, &error),
+              ZX_OK, error);
+    ASSERT_EQ(fidl_test_coders_CoderTestConfigureRequestEncode(
+                  &generated, sizeof(generated), nullptr, 0, &actual_handles, &error),
+              ZX_OK, error);
+    EXPECT_BYTES_EQ(reinterpret_cast<uint8_t*>(&generated), reinterpret_cast<uint8_t*>(&walked),
+                    sizeof(generated), "");
+
+    EXPECT_EQ(fidl_test_coders_CoderTestConfigureRequestValidate(&generated, sizeof(generated), 0,
+                                                                 &error),
+              ZX_OK, error);
+
+    // An ordinal unknown to the receiver is skipped.
+    configure_message_layout unknown = generated;
+    unknown.value_data.tag = 1;
+    EXPECT_EQ(fidl_test_coders_CoderTestConfigureRequestDecode(&unknown, sizeof(unknown), nullptr,
+                                                               0, &error),
+              ZX_OK, error);
+    EXPECT_EQ(unknown.value, &unknown.value_data);
+    EXPECT_EQ(unknown.value_data.envelope.data, &unknown.text);
+
+    // An envelope whose size does not match its payload is not.
+    configure_message_layout missized = generated;
+    missized.envelopes[0].num_bytes = sizeof(missized.name);
+    EXPECT_EQ(fidl_test_coders_CoderTestConfigureRequestDecode(&missized, sizeof(missized),
+                                                               nullptr, 0, &error),
+              ZX_ERR_INVALID_ARGS);
+    EXPECT_STR_EQ(error, "Envelope num_bytes was mis-sized");
+
+    EXPECT_EQ(fidl_test_coders_CoderTestConfigureRequestDecode(&generated, sizeof(generated),
+                                                               nullptr, 0, &error),
+              ZX_OK, error);
+    EXPECT_EQ(generated.settings.data, generated.envelopes);
+    EXPECT_EQ(generated.envelopes[0].data, &generated.name);
+    EXPECT_EQ(generated.name.data, generated.name_data);
+    EXPECT_NULL(generated.envelopes[1].data);
+    EXPECT_EQ(generated.envelopes[4].data, &generated.flags);
+    EXPECT_EQ(generated.value, &generated.value_data);
+    EXPECT_EQ(generated.text.data, generated.text_data);
+
+    END_TEST;
+}
+
+constexpr uint32_t kBenchmarkIterations = 100000;
+
+// Returns the average time, in nanoseconds, taken to encode and decode the
+// message built by |build|, with the generated coders or the coding tables.
+template <typename Layout>
+bool BenchmarkMessage(const MessageCoders& coders, void (*build)(Layout*),
+                      bool use_generated_coders, zx_duration_t* out_ns) {
+    BEGIN_HELPER;
+
+    Layout message;
+    build(&message);
+    zx_handle_t handles[ZX_CHANNEL_MAX_MSG_HANDLES];
+    zx_time_t start = zx_clock_get_monotonic();
+    for (uint32_t i = 0; i < kBenchmarkIterations; i++) {
+        uint32_t actual_handles;
+        if (use_generated_coders) {
+            ASSERT_EQ(coders.encode(&message, sizeof(message), handles,
+                                    ZX_CHANNEL_MAX_MSG_HANDLES, &actual_handles, nullptr),
+                      ZX_OK);
+            ASSERT_EQ(coders.decode(&message, sizeof(message), handles, actual_handles, nullptr),
+                      ZX_OK);
+        } else {
+            ASSERT_EQ(fidl_encode(coders.table, &message, sizeof(message), handles,
+                                  ZX_CHANNEL_MAX_MSG_HANDLES, &actual_handles, nullptr),
+                      ZX_OK);
+            ASSERT_EQ(fidl_decode(coders.table, &message, sizeof(message), handles,
+                                  actual_handles, nullptr),
+                      ZX_OK);
+        }
+    }
+    *out_ns = (zx_clock_get_monotonic() - start) / kBenchmarkIterations;
+
+    END_HELPER;
+}
+
+template <typename Layout>
+bool BenchmarkAndPrint(const char* name, const MessageCoders& coders, void (*build)(Layout*)) {
+    BEGIN_HELPER;
+
+    zx_duration_t walked_ns, generated_ns;
+    ASSERT_TRUE(BenchmarkMessage(coders, build, false, &walked_ns));
+    ASSERT_TRUE(BenchmarkMessage(coders, build, true, &generated_ns));
+
+    printf("\nEncode + decode of a %zu byte %s message: %" PRId64 " ns walked, %" PRId64
+           " ns generated\n",
+           sizeof(Layout), name, walked_ns, generated_ns);
+
+    END_HELPER;
+}
+
+bool benchmark_nodes_message() {
+    BEGIN_TEST;
+    ASSERT_TRUE(BenchmarkAndPrint("Nodes", kNodesCoders, BuildNodesMessage));
+    END_TEST;
+}
+
+bool benchmark_nested_message() {
+    BEGIN_TEST;
+    ASSERT_TRUE(BenchmarkAndPrint("Nested", kNestedCoders, BuildNestedMessage));
+    END_TEST;
+}
+
+bool benchmark_shapes_message() {
+    BEGIN_TEST;
+    ASSERT_TRUE(BenchmarkAndPrint("Shapes", kShapesCoders, BuildShapesMessage));
+    END_TEST;
+}
+
+} // namespace
+
+BEGIN_TEST_CASE(generated_coders)
+RUN_TEST(nodes_message_coding)
+RUN_TEST(nodes_message_errors)
+RUN_TEST(nested_message_coding)
+RUN_TEST(nested_message_errors)
+RUN_TEST(shapes_message_coding)
+RUN_TEST(shapes_message_errors)
+RUN_TEST(configure_message_coding)
+RUN_TEST_PERFORMANCE(benchmark_nodes_message)
+RUN_TEST_PERFORMANCE(benchmark_nested_message)
+RUN_TEST_PERFORMANCE(benchmark_shapes_message)
+END_TEST_CASE(generated_coders)
+
+} // namespace fidl
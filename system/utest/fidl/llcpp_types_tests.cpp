@@ -8,6 +8,7 @@
 
 #include <lib/fidl/internal.h>
 #include <lib/fidl/llcpp/array_wrapper.h>
+#include <lib/fidl/llcpp/buffer_pool.h>
 #include <lib/fidl/llcpp/coding.h>
 #include <lib/zx/channel.h>
 
@@ -252,6 +253,59 @@ bool ArrayLayoutTest() {
     END_TEST;
 }
 
+// Read messages straight into buffers from a pool, and decode them in place.
+bool ReadIntoPoolTest() {
+    BEGIN_TEST;
+
+    zx::channel client, server;
+    ASSERT_EQ(zx::channel::create(0, &client, &server), ZX_OK);
+
+    fidl::BufferPool pool(sizeof(NonnullableChannelMessage), 2u);
+    for (uint32_t i = 0; i < 8u; i++) {
+        // Send a message carrying one end of a fresh channel.
+        zx::channel out0, out1;
+        ASSERT_EQ(zx::channel::create(0, &out0, &out1), ZX_OK);
+        NonnullableChannelMessage request = {};
+        request.header.txid = i;
+        request.header.ordinal = 42;
+        request.channel.reset(FIDL_HANDLE_PRESENT);
+        zx_handle_t handle = out0.release();
+        ASSERT_EQ(client.write(0, &request, sizeof(request), &handle, 1), ZX_OK);
+        request.channel.release();
+
+        fidl::BufferPool::Buffer buffer = pool.Acquire();
+        auto read_result = fidl::Read<NonnullableChannelMessage>(server, buffer.view());
+        ASSERT_EQ(read_result.status, ZX_OK);
+        EXPECT_EQ(read_result.message.bytes().data(), buffer.data());
+        EXPECT_EQ(read_result.message.bytes().actual(), sizeof(NonnullableChannelMessage));
+        EXPECT_EQ(read_result.message.handles().actual(), 1);
+
+        auto decode_result = fidl::Decode(std::move(read_result.message));
+        ASSERT_EQ(decode_result.status, ZX_OK);
+        EXPECT_EQ(decode_result.message.message()->header.txid, i);
+        EXPECT_TRUE(HelperExpectPeerValid(out1));
+
+        // Closing the decoded message closes the channel it received, and
+        // the buffer is returned to the pool for the next message.
+        decode_result.message.Reset(fidl::BytePart());
+        EXPECT_TRUE(HelperExpectPeerInvalid(out1));
+    }
+    EXPECT_EQ(pool.slab_count(), 1u);
+    EXPECT_EQ(pool.outstanding(), 0u);
+
+    // A buffer too small for the message leaves it in the channel.
+    fidl::BufferPool small_pool(sizeof(fidl_message_header_t), 1u);
+    NonnullableChannelMessage request = {};
+    ASSERT_EQ(client.write(0, &request, sizeof(request), nullptr, 0), ZX_OK);
+    {
+        fidl::BufferPool::Buffer buffer = small_pool.Acquire();
+        auto read_result = fidl::Read<NonnullableChannelMessage>(server, buffer.view());
+        EXPECT_EQ(read_result.status, ZX_ERR_BUFFER_TOO_SMALL);
+    }
+
+    END_TEST;
+}
+
 } // namespace
 
 BEGIN_TEST_CASE(llcpp_types_tests)
@@ -259,4 +313,5 @@ RUN_NAMED_TEST("EncodedMessage test", EncodedMessageTest)
 RUN_NAMED_TEST("DecodedMessage test", DecodedMessageTest)
 RUN_NAMED_TEST("Round trip test", RoundTripTest)
 RUN_NAMED_TEST("Array layout test", ArrayLayoutTest)
+RUN_NAMED_TEST("Read into pool test", ReadIntoPoolTest)
 END_TEST_CASE(llcpp_types_tests);
@@ -10,11 +10,14 @@ MODULE_TYPE := usertest
 
 MODULE_SRCS += \
     $(LOCAL_DIR)/abi_tests.cpp \
+    $(LOCAL_DIR)/buffer_pool_tests.cpp \
     $(LOCAL_DIR)/cpp_types_tests.cpp \
     $(LOCAL_DIR)/decoding_tests.cpp \
     $(LOCAL_DIR)/encoding_tests.cpp \
     $(LOCAL_DIR)/fidl_coded_types.cpp \
+    $(LOCAL_DIR)/flat_coding_tests.cpp \
     $(LOCAL_DIR)/formatting_tests.cpp \
+    $(LOCAL_DIR)/generated_coders_tests.cpp \
     $(LOCAL_DIR)/handle_closing_tests.cpp \
     $(LOCAL_DIR)/linearizing_tests.cpp \
     $(LOCAL_DIR)/llcpp_types_tests.cpp \
@@ -27,6 +30,12 @@ MODULE_SRCS += \
 # See ./fidl/README.md for details.
 MODULE_SRCS += $(LOCAL_DIR)/fidl/extra_messages.cpp
 
+# Generated coding tables and coders for fidl/generated_coders.fidl, checked in
+# for the same reason. See ./fidl/README.md for details.
+MODULE_SRCS += \
+    $(LOCAL_DIR)/fidl/generated_coders.cpp \
+    $(LOCAL_DIR)/fidl/generated_coders_tables.cpp \
+
 MODULE_NAME := fidl-test
 
 MODULE_STATIC_LIBS := \
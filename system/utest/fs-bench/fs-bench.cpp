@@ -2,21 +2,38 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <dirent.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
+#include <threads.h>
+#include <unistd.h>
 
 #include <fbl/function.h>
 #include <fbl/string.h>
 #include <fbl/string_buffer.h>
+#include <fbl/string_piece.h>
 #include <fbl/string_printf.h>
 #include <fbl/unique_fd.h>
 #include <fs-management/mount.h>
 #include <fs-test-utils/fixture.h>
 #include <fs-test-utils/perftest.h>
+#include <fuchsia/io/c/fidl.h>
+#include <lib/fdio/io.h>
+#include <lib/fdio/limits.h>
+#include <lib/fdio/vfs.h>
+#include <lib/fzl/fdio.h>
+#include <lib/zx/job.h>
+#include <lib/zx/process.h>
 #include <perftest/perftest.h>
 #include <unittest/unittest.h>
+#include <zircon/fidl.h>
+#include <zircon/syscalls.h>
+#include <zircon/syscalls/object.h>
 
 #include <utility>
 
@@ -70,6 +87,365 @@ bool ReadBigFile(ssize_t data_size, perftest::RepeatState* state, Fixture* fixtu
     END_HELPER;
 }
 
+constexpr size_t kPartialReadFileSize = 16 * (1 << 20);
+constexpr size_t kPartialReadSize = 8 * (1 << 10);
+
+// Returns the private memory of the filesystem server, which is launched in
+// the same job as the test, or zero if it can't be found.
+size_t GetFilesystemPrivateBytes(const char* name) {
+    zx_koid_t koids[32];
+    size_t count;
+    auto job = zx::job::default_job();
+    if (job->get_info(ZX_INFO_JOB_PROCESSES, koids, sizeof(koids), &count, nullptr) != ZX_OK) {
+        return 0;
+    }
+    for (size_t i = 0; i < count; i++) {
+        zx::process process;
+        char process_name[ZX_MAX_NAME_LEN];
+        zx_info_task_stats_t stats;
+        if (job->get_child(koids[i], ZX_RIGHT_SAME_RIGHTS, &process) != ZX_OK ||
+            process.get_property(ZX_PROP_NAME, process_name, sizeof(process_name)) != ZX_OK ||
+            strcmp(process_name, name) != 0 ||
+            process.get_info(ZX_INFO_TASK_STATS, &stats, sizeof(stats), nullptr,
+                             nullptr) != ZX_OK) {
+            continue;
+        }
+        return stats.mem_private_bytes;
+    }
+    return 0;
+}
+
+// Measures the latency of the first read from a large file, which has not
+// been accessed since it was written. Each iteration opens the file, reads a
+// block which the previous iterations did not touch, and closes the file.
+//
+// Also reports how much memory the filesystem holds while the file is open
+// after reading a single block of it.
+bool PartialReadBigFile(perftest::RepeatState* state, Fixture* fixture) {
+    BEGIN_HELPER;
+    fbl::String path = fbl::StringPrintf("%s/partial-read.txt", fixture->fs_path().c_str());
+    uint8_t data[kPartialReadSize];
+    memset(data, 0xab, sizeof(data));
+    {
+        fbl::unique_fd fd(open(path.c_str(), O_CREAT | O_WRONLY));
+        ASSERT_TRUE(fd);
+        for (size_t off = 0; off < kPartialReadFileSize; off += sizeof(data)) {
+            ASSERT_EQ(write(fd.get(), data, sizeof(data)), static_cast<ssize_t>(sizeof(data)));
+        }
+        ASSERT_EQ(fsync(fd.get()), 0);
+    }
+
+    const char* fs_name = disk_format_string_[fixture->options().fs_type];
+    {
+        size_t before = GetFilesystemPrivateBytes(fs_name);
+        fbl::unique_fd fd(open(path.c_str(), O_RDONLY));
+        ASSERT_TRUE(fd);
+        ASSERT_EQ(read(fd.get(), data, sizeof(data)), static_cast<ssize_t>(sizeof(data)));
+        size_t after = GetFilesystemPrivateBytes(fs_name);
+        if (before != 0 && after != 0) {
+            printf("%s: %zu bytes resident after reading %zu of %zu bytes\n", fs_name,
+                   after > before ? after - before : 0, sizeof(data), kPartialReadFileSize);
+        }
+    }
+
+    state->DeclareStep("open");
+    state->DeclareStep("read");
+    state->DeclareStep("close");
+    constexpr size_t kBlocks = kPartialReadFileSize / kPartialReadSize;
+    size_t block = 0;
+    while (state->KeepRunning()) {
+        fbl::unique_fd fd(open(path.c_str(), O_RDONLY));
+        ASSERT_TRUE(fd);
+        state->NextStep();
+        // Stride across the file, so that readahead from one iteration does
+        // not cover the next.
+        block = (block + 257) % kBlocks;
+        ASSERT_EQ(pread(fd.get(), data, sizeof(data), block * kPartialReadSize),
+                  static_cast<ssize_t>(sizeof(data)));
+        ASSERT_EQ(data[0], 0xab);
+        state->NextStep();
+        fd.reset();
+    }
+    END_HELPER;
+}
+
+constexpr size_t kPipelinedReadFileSize = 1 << 20;
+constexpr size_t kPipelinedReadSize = 1 << 10;
+constexpr uint32_t kPipelineDepth = 16;
+
+// Measures small reads by a client which keeps several requests in flight on
+// the same connection, rather than waiting for each reply before sending the
+// next request.
+bool PipelinedReadBigFile(perftest::RepeatState* state, Fixture* fixture) {
+    BEGIN_HELPER;
+    fbl::String path = fbl::StringPrintf("%s/pipelined-read.txt", fixture->fs_path().c_str());
+    {
+        fbl::unique_fd fd(open(path.c_str(), O_CREAT | O_WRONLY));
+        ASSERT_TRUE(fd);
+        uint8_t data[kPipelinedReadSize];
+        memset(data, 0xab, sizeof(data));
+        for (size_t off = 0; off < kPipelinedReadFileSize; off += sizeof(data)) {
+            ASSERT_EQ(write(fd.get(), data, sizeof(data)), static_cast<ssize_t>(sizeof(data)));
+        }
+    }
+
+    fbl::unique_fd fd(open(path.c_str(), O_RDONLY));
+    ASSERT_TRUE(fd);
+    fzl::FdioCaller caller(std::move(fd));
+    zx_handle_t channel = caller.borrow_channel();
+    alignas(FIDL_ALIGNMENT) uint8_t reply[sizeof(fuchsia_io_FileReadAtResponse) +
+                                          FIDL_ALIGN(kPipelinedReadSize)];
+    state->SetBytesProcessedPerRun(kPipelineDepth * kPipelinedReadSize);
+    uint64_t offset = 0;
+    while (state->KeepRunning()) {
+        for (uint32_t i = 0; i < kPipelineDepth; i++) {
+            fuchsia_io_FileReadAtRequest request;
+            memset(&request, 0, sizeof(request));
+            request.hdr.txid = i + 1;
+            request.hdr.ordinal = fuchsia_io_FileReadAtOrdinal;
+            request.count = kPipelinedReadSize;
+            request.offset = offset;
+            offset = (offset + kPipelinedReadSize) % kPipelinedReadFileSize;
+            ASSERT_EQ(zx_channel_write(channel, 0, &request, sizeof(request), nullptr, 0),
+                      ZX_OK);
+        }
+        for (uint32_t i = 0; i < kPipelineDepth; i++) {
+            ASSERT_EQ(zx_object_wait_one(channel, ZX_CHANNEL_READABLE, ZX_TIME_INFINITE,
+                                         nullptr), ZX_OK);
+            uint32_t actual_bytes;
+            ASSERT_EQ(zx_channel_read(channel, 0, reply, nullptr, sizeof(reply), 0,
+                                      &actual_bytes, nullptr), ZX_OK);
+            auto response = reinterpret_cast<fuchsia_io_FileReadAtResponse*>(reply);
+            ASSERT_EQ(response->s, ZX_OK);
+            ASSERT_EQ(response->data.count, kPipelinedReadSize);
+        }
+    }
+    END_HELPER;
+}
+
+constexpr size_t kConcurrentReadFileSize = 4 * (1 << 20);
+constexpr size_t kConcurrentReadSize = 8 * (1 << 10);
+constexpr uint32_t kConcurrentReadsPerReader = 32;
+constexpr uint32_t kMaxConcurrentReaders = 8;
+
+// State of one of the threads reading in ConcurrentReadBigFile.
+struct ConcurrentReader {
+    int fd;
+    size_t offset;
+    bool ok;
+};
+
+int ConcurrentReaderThread(void* arg) {
+    auto reader = static_cast<ConcurrentReader*>(arg);
+    uint8_t data[kConcurrentReadSize];
+    reader->ok = true;
+    for (uint32_t i = 0; i < kConcurrentReadsPerReader; i++) {
+        if (pread(reader->fd, data, sizeof(data), reader->offset) !=
+            static_cast<ssize_t>(sizeof(data)) || data[0] != 0xab) {
+            reader->ok = false;
+            return -1;
+        }
+        reader->offset = (reader->offset + sizeof(data)) % kConcurrentReadFileSize;
+    }
+    return 0;
+}
+
+// Measures the throughput of |readers| clients reading the same file at
+// once, each through its own connection. Shows how well the filesystem
+// serves reads in parallel when it dispatches requests on several threads
+// (see --dispatch_threads).
+bool ConcurrentReadBigFile(uint32_t readers, perftest::RepeatState* state, Fixture* fixture) {
+    BEGIN_HELPER;
+    fbl::String path = fbl::StringPrintf("%s/concurrent-read.txt", fixture->fs_path().c_str());
+    {
+        fbl::unique_fd fd(open(path.c_str(), O_CREAT | O_WRONLY));
+        ASSERT_TRUE(fd);
+        uint8_t data[kConcurrentReadSize];
+        memset(data, 0xab, sizeof(data));
+        for (size_t off = 0; off < kConcurrentReadFileSize; off += sizeof(data)) {
+            ASSERT_EQ(write(fd.get(), data, sizeof(data)), static_cast<ssize_t>(sizeof(data)));
+        }
+    }
+
+    ASSERT_LE(readers, kMaxConcurrentReaders);
+    fbl::unique_fd fds[kMaxConcurrentReaders];
+    ConcurrentReader args[kMaxConcurrentReaders];
+    for (uint32_t i = 0; i < readers; i++) {
+        fds[i].reset(open(path.c_str(), O_RDONLY));
+        ASSERT_TRUE(fds[i]);
+        // Spread the readers across the file.
+        args[i].fd = fds[i].get();
+        args[i].offset = (kConcurrentReadFileSize / readers) * i;
+    }
+
+    state->SetBytesProcessedPerRun(readers * kConcurrentReadsPerReader * kConcurrentReadSize);
+    thrd_t threads[kMaxConcurrentReaders];
+    while (state->KeepRunning()) {
+        for (uint32_t i = 0; i < readers; i++) {
+            ASSERT_EQ(thrd_create(&threads[i], ConcurrentReaderThread, &args[i]),
+                      thrd_success);
+        }
+        for (uint32_t i = 0; i < readers; i++) {
+            ASSERT_EQ(thrd_join(threads[i], nullptr), thrd_success);
+            ASSERT_TRUE(args[i].ok);
+        }
+    }
+    END_HELPER;
+}
+
+constexpr int kDeepPathDepth = 8;
+
+// Creates |kDeepPathDepth| nested directories, and returns the path of the
+// innermost one.
+bool MakeDeepDirectory(Fixture* fixture, fbl::String* out) {
+    BEGIN_HELPER;
+    fbl::String path = fixture->fs_path();
+    for (int i = 0; i < kDeepPathDepth; i++) {
+        path = fbl::StringPrintf("%s/dir%d", path.c_str(), i);
+        ASSERT_TRUE(mkdir(path.c_str(), 0666) == 0 || errno == EEXIST, path.c_str());
+    }
+    *out = std::move(path);
+    END_HELPER;
+}
+
+// Measures opening and closing a file several directories deep, over and
+// over, as a program does when it looks up the same resources repeatedly.
+bool OpenDeepPath(perftest::RepeatState* state, Fixture* fixture) {
+    BEGIN_HELPER;
+    fbl::String dir;
+    ASSERT_TRUE(MakeDeepDirectory(fixture, &dir));
+    fbl::String path = fbl::StringPrintf("%s/file", dir.c_str());
+    ASSERT_TRUE(fbl::unique_fd(open(path.c_str(), O_CREAT | O_RDWR, 0644)));
+
+    while (state->KeepRunning()) {
+        fbl::unique_fd fd(open(path.c_str(), O_RDONLY));
+        ASSERT_TRUE(fd);
+    }
+    END_HELPER;
+}
+
+// Measures failing to open a missing file several directories deep, as a
+// program does when it searches a list of directories for a library.
+bool OpenMissingDeepPath(perftest::RepeatState* state, Fixture* fixture) {
+    BEGIN_HELPER;
+    fbl::String dir;
+    ASSERT_TRUE(MakeDeepDirectory(fixture, &dir));
+    fbl::String path = fbl::StringPrintf("%s/missing", dir.c_str());
+
+    while (state->KeepRunning()) {
+        ASSERT_LT(open(path.c_str(), O_RDONLY), 0);
+        ASSERT_EQ(errno, ENOENT);
+    }
+    END_HELPER;
+}
+
+// The tree walked by the Walk tests: 100k files, spread across directories.
+// On minfs, creating it needs FVM, so that the inode table can grow.
+constexpr int kWalkTreeDirs = 100;
+constexpr int kWalkTreeFilesPerDir = 1000;
+
+// Creates a tree of |dirs| directories holding |files| empty files each,
+// unless an earlier test has already done so, and returns its path.
+bool MakeWalkTree(int dirs, int files, Fixture* fixture, fbl::String* out) {
+    BEGIN_HELPER;
+    fbl::String root = fbl::StringPrintf("%s/walk-%dx%d", fixture->fs_path().c_str(),
+                                         dirs, files);
+    if (mkdir(root.c_str(), 0755) != 0) {
+        ASSERT_EQ(errno, EEXIST);
+        dirs = 0;
+    }
+    for (int i = 0; i < dirs; i++) {
+        fbl::String dir = fbl::StringPrintf("%s/dir%d", root.c_str(), i);
+        ASSERT_EQ(mkdir(dir.c_str(), 0755), 0, dir.c_str());
+        for (int j = 0; j < files; j++) {
+            fbl::String path = fbl::StringPrintf("%s/file%d", dir.c_str(), j);
+            ASSERT_TRUE(fbl::unique_fd(open(path.c_str(), O_CREAT | O_WRONLY, 0644)),
+                        path.c_str());
+        }
+    }
+    *out = std::move(root);
+    END_HELPER;
+}
+
+// Lists the tree below |path| with readdir, calling stat on each entry (as
+// "ls -l" does), and counts the files in it.
+bool WalkWithStat(const fbl::String& path, size_t* files) {
+    BEGIN_HELPER;
+    DIR* dir = opendir(path.c_str());
+    ASSERT_NONNULL(dir, path.c_str());
+    struct dirent* de;
+    while ((de = readdir(dir)) != nullptr) {
+        if (!strcmp(de->d_name, ".") || !strcmp(de->d_name, "..")) {
+            continue;
+        }
+        struct stat st;
+        ASSERT_EQ(fstatat(dirfd(dir), de->d_name, &st, 0), 0, de->d_name);
+        if (S_ISDIR(st.st_mode)) {
+            fbl::String child = fbl::StringPrintf("%s/%s", path.c_str(), de->d_name);
+            ASSERT_TRUE(WalkWithStat(child, files));
+        } else {
+            (*files)++;
+        }
+    }
+    ASSERT_EQ(closedir(dir), 0);
+    END_HELPER;
+}
+
+// Lists the tree below |path| with fdio_readdir_plus, which returns the
+// attributes of each entry along with its name, and counts the files in it.
+bool WalkWithReaddirPlus(const fbl::String& path, size_t* files) {
+    BEGIN_HELPER;
+    fbl::unique_fd fd(open(path.c_str(), O_RDONLY | O_DIRECTORY));
+    ASSERT_TRUE(fd, path.c_str());
+    uint64_t buffer[FDIO_CHUNK_SIZE / sizeof(uint64_t)];
+    for (;;) {
+        size_t actual;
+        ASSERT_EQ(fdio_readdir_plus(fd.get(), buffer, sizeof(buffer), &actual), ZX_OK);
+        if (actual == 0) {
+            break;
+        }
+        for (size_t off = 0; off < actual;) {
+            const vdirent_plus_t* de = reinterpret_cast<const vdirent_plus_t*>(
+                reinterpret_cast<const char*>(buffer) + off);
+            off += VDIRENT_PLUS_LEN(de->size);
+            fbl::StringPiece name(de->name, de->size);
+            if (name == "." || name == "..") {
+                continue;
+            }
+            ASSERT_NE(de->attr.mode, 0u);
+            if (S_ISDIR(de->attr.mode)) {
+                fbl::String child = fbl::StringPrintf("%s/%.*s", path.c_str(),
+                                                      static_cast<int>(name.length()),
+                                                      name.data());
+                ASSERT_TRUE(WalkWithReaddirPlus(child, files));
+            } else {
+                (*files)++;
+            }
+        }
+    }
+    END_HELPER;
+}
+
+// Measures listing every directory of a large tree along with the
+// attributes of its entries.
+bool WalkTree(int dirs, int files, bool readdir_plus, perftest::RepeatState* state,
+              Fixture* fixture) {
+    BEGIN_HELPER;
+    fbl::String root;
+    ASSERT_TRUE(MakeWalkTree(dirs, files, fixture, &root));
+
+    while (state->KeepRunning()) {
+        size_t found = 0;
+        if (readdir_plus) {
+            ASSERT_TRUE(WalkWithReaddirPlus(root, &found));
+        } else {
+            ASSERT_TRUE(WalkWithStat(root, &found));
+        }
+        ASSERT_EQ(found, static_cast<size_t>(dirs * files));
+    }
+    END_HELPER;
+}
+
 constexpr char kBaseComponent[] = "/aaa";
 
 constexpr size_t kComponentLength = fbl::constexpr_strlen(kBaseComponent);
@@ -206,6 +582,106 @@ bool RunBenchmark(int argc, char** argv) {
         testcases.push_back(std::move(testcase));
     }
 
+    // Partial read test.
+    {
+        TestCaseInfo testcase;
+        testcase.name = fbl::StringPrintf("%s/Bigfile/16Mbytes/PartialRead",
+                                          disk_format_string_[f_opts.fs_type]);
+        testcase.sample_count = 100;
+        testcase.teardown = false;
+        TestInfo partial_read_test;
+        partial_read_test.name = fbl::StringPrintf("%s/FirstRead", testcase.name.c_str());
+        partial_read_test.test_fn = PartialReadBigFile;
+        partial_read_test.required_disk_space = kPartialReadFileSize;
+        testcase.tests.push_back(std::move(partial_read_test));
+        testcases.push_back(std::move(testcase));
+    }
+
+    // Pipelined read test.
+    {
+        TestCaseInfo testcase;
+        testcase.name = fbl::StringPrintf("%s/Bigfile/1Mbytes/PipelinedRead/%u-Deep",
+                                          disk_format_string_[f_opts.fs_type], kPipelineDepth);
+        testcase.sample_count = 1000;
+        testcase.teardown = false;
+        TestInfo pipelined_read_test;
+        pipelined_read_test.name = fbl::StringPrintf("%s/ReadAt", testcase.name.c_str());
+        pipelined_read_test.test_fn = PipelinedReadBigFile;
+        pipelined_read_test.required_disk_space = kPipelinedReadFileSize;
+        testcase.tests.push_back(std::move(pipelined_read_test));
+        testcases.push_back(std::move(testcase));
+    }
+
+    // Concurrent read tests.
+    const uint32_t concurrent_readers[] = {
+        1,
+        2,
+        4,
+        kMaxConcurrentReaders,
+    };
+
+    for (uint32_t readers : concurrent_readers) {
+        TestCaseInfo testcase;
+        testcase.name = fbl::StringPrintf("%s/Bigfile/4Mbytes/ConcurrentRead/%u-Readers",
+                                          disk_format_string_[f_opts.fs_type], readers);
+        testcase.sample_count = 100;
+        testcase.teardown = false;
+        TestInfo concurrent_read_test;
+        concurrent_read_test.name = fbl::StringPrintf("%s/%u-Threads", testcase.name.c_str(),
+                                                      f_opts.dispatch_threads);
+        concurrent_read_test.test_fn = [readers](perftest::RepeatState* state,
+                                                 Fixture* fixture) {
+            return ConcurrentReadBigFile(readers, state, fixture);
+        };
+        concurrent_read_test.required_disk_space = kConcurrentReadFileSize;
+        testcase.tests.push_back(std::move(concurrent_read_test));
+        testcases.push_back(std::move(testcase));
+    }
+
+    // Repeated open tests.
+    {
+        TestCaseInfo testcase;
+        testcase.name = fbl::StringPrintf("%s/Open/%d-Deep",
+                                          disk_format_string_[f_opts.fs_type], kDeepPathDepth);
+        testcase.sample_count = 1000;
+        testcase.teardown = false;
+        TestInfo open_test;
+        open_test.name = fbl::StringPrintf("%s/Present", testcase.name.c_str());
+        open_test.test_fn = OpenDeepPath;
+        testcase.tests.push_back(std::move(open_test));
+        TestInfo open_missing_test;
+        open_missing_test.name = fbl::StringPrintf("%s/Missing", testcase.name.c_str());
+        open_missing_test.test_fn = OpenMissingDeepPath;
+        testcase.tests.push_back(std::move(open_missing_test));
+        testcases.push_back(std::move(testcase));
+    }
+
+    // Directory walk tests.
+    {
+        // Unittest mode only checks that the walks work.
+        int dirs = p_opts.is_unittest ? 4 : kWalkTreeDirs;
+        int files = p_opts.is_unittest ? 16 : kWalkTreeFilesPerDir;
+        TestCaseInfo testcase;
+        testcase.name = fbl::StringPrintf("%s/Walk/%d-Files",
+                                          disk_format_string_[f_opts.fs_type], dirs * files);
+        testcase.sample_count = 10;
+        testcase.teardown = false;
+        TestInfo stat_test;
+        stat_test.name = fbl::StringPrintf("%s/ReaddirStat", testcase.name.c_str());
+        stat_test.test_fn = [dirs, files](perftest::RepeatState* state, Fixture* fixture) {
+            return WalkTree(dirs, files, false, state, fixture);
+        };
+        testcase.tests.push_back(std::move(stat_test));
+        TestInfo readdir_plus_test;
+        readdir_plus_test.name = fbl::StringPrintf("%s/ReaddirPlus", testcase.name.c_str());
+        readdir_plus_test.test_fn = [dirs, files](perftest::RepeatState* state,
+                                                  Fixture* fixture) {
+            return WalkTree(dirs, files, true, state, fixture);
+        };
+        testcase.tests.push_back(std::move(readdir_plus_test));
+        testcases.push_back(std::move(testcase));
+    }
+
     // Path walk tests.
     const int path_walk_sample_counts[] = {
         125,
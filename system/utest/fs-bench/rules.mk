@@ -20,6 +20,7 @@ MODULE_STATIC_LIBS := \
     system/ulib/async.cpp \
     system/ulib/async-loop \
     system/ulib/async-loop.cpp \
+    system/ulib/bitmap \
     system/ulib/fbl \
     system/ulib/fs \
     system/ulib/fs-test-utils \
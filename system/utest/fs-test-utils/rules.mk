@@ -19,6 +19,7 @@ MODULE_STATIC_LIBS := \
     system/ulib/async.cpp \
     system/ulib/async-loop \
     system/ulib/async-loop.cpp \
+    system/ulib/bitmap \
     system/ulib/digest \
     system/ulib/fbl \
     system/ulib/fvm \
@@ -0,0 +1,158 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <fs/managed-vfs.h>
+#include <fs/synchronous-vfs.h>
+#include <fs/vnode.h>
+#include <fuchsia/io/c/fidl.h>
+#include <lib/async-loop/cpp/loop.h>
+#include <lib/sync/completion.h>
+#include <lib/zx/channel.h>
+
+#include <unittest/unittest.h>
+
+#include <string.h>
+
+#include <utility>
+
+namespace {
+
+constexpr uint32_t kRequests = 40;
+
+// A vnode which supports no operations, so requests are answered without
+// any work beyond dispatch.
+class TestVnode : public fs::Vnode {};
+
+// Sends |kRequests| GetAttr requests on |client| without waiting for replies.
+bool SendRequests(const zx::channel& client) {
+    BEGIN_HELPER;
+    for (uint32_t i = 0; i < kRequests; i++) {
+        fuchsia_io_NodeGetAttrRequest request;
+        memset(&request, 0, sizeof(request));
+        request.hdr.txid = i + 1;
+        request.hdr.ordinal = fuchsia_io_NodeGetAttrOrdinal;
+        ASSERT_EQ(client.write(0, &request, sizeof(request), nullptr, 0), ZX_OK);
+    }
+    END_HELPER;
+}
+
+// Reads the replies pending on |client|, checking that they arrive in the
+// order their requests were sent.
+bool ReadReplies(const zx::channel& client, uint32_t* count) {
+    BEGIN_HELPER;
+    for (;;) {
+        fuchsia_io_NodeGetAttrResponse response;
+        uint32_t actual_bytes;
+        zx_status_t status = client.read(0, &response, sizeof(response), &actual_bytes,
+                                         nullptr, 0, nullptr);
+        if (status == ZX_ERR_SHOULD_WAIT) {
+            break;
+        }
+        ASSERT_EQ(status, ZX_OK);
+        ASSERT_EQ(actual_bytes, sizeof(response));
+        (*count)++;
+        ASSERT_EQ(response.hdr.txid, *count);
+        ASSERT_EQ(response.s, ZX_ERR_NOT_SUPPORTED);
+    }
+    END_HELPER;
+}
+
+bool Serve(fs::Vfs* vfs, zx::channel* out_client) {
+    BEGIN_HELPER;
+    auto vn = fbl::AdoptRef(new TestVnode());
+    zx::channel server;
+    ASSERT_EQ(zx::channel::create(0, out_client, &server), ZX_OK);
+    ASSERT_EQ(vn->Serve(vfs, std::move(server), 0), ZX_OK);
+    END_HELPER;
+}
+
+// Requests which a client sends without waiting for replies are all
+// answered, in order.
+bool TestPipelinedRequests() {
+    BEGIN_TEST;
+    async::Loop loop(&kAsyncLoopConfigNoAttachToThread);
+    fs::SynchronousVfs vfs(loop.dispatcher());
+    zx::channel client;
+    ASSERT_TRUE(Serve(&vfs, &client));
+
+    ASSERT_TRUE(SendRequests(client));
+    ASSERT_EQ(loop.RunUntilIdle(), ZX_OK);
+    uint32_t count = 0;
+    ASSERT_TRUE(ReadReplies(client, &count));
+    ASSERT_EQ(count, kRequests);
+    END_TEST;
+}
+
+// A connection handles several pending requests each time it wakes, but
+// not so many that other connections have to wait for it to be drained.
+bool TestPipelinedRequestsBounded() {
+    BEGIN_TEST;
+    async::Loop loop(&kAsyncLoopConfigNoAttachToThread);
+    fs::SynchronousVfs vfs(loop.dispatcher());
+    zx::channel clients[2];
+    for (zx::channel& client : clients) {
+        ASSERT_TRUE(Serve(&vfs, &client));
+        ASSERT_TRUE(SendRequests(client));
+    }
+
+    // Handle a single wakeup of one of the connections.
+    ASSERT_EQ(loop.Run(zx::time::infinite(), true), ZX_OK);
+    uint32_t counts[2] = {};
+    for (size_t i = 0; i < 2; i++) {
+        ASSERT_TRUE(ReadReplies(clients[i], &counts[i]));
+    }
+    ASSERT_GT(counts[0] + counts[1], 1u);
+    ASSERT_LT(counts[0] + counts[1], kRequests);
+
+    ASSERT_EQ(loop.RunUntilIdle(), ZX_OK);
+    for (size_t i = 0; i < 2; i++) {
+        ASSERT_TRUE(ReadReplies(clients[i], &counts[i]));
+        ASSERT_EQ(counts[i], kRequests);
+    }
+    END_TEST;
+}
+
+// Requests on many connections are all answered when the dispatcher runs
+// on several threads, and the Vfs can still be shut down afterwards.
+bool TestConcurrentDispatch() {
+    BEGIN_TEST;
+    constexpr size_t kConnections = 8;
+    constexpr uint32_t kThreads = 4;
+    async::Loop loop(&kAsyncLoopConfigNoAttachToThread);
+    fs::ManagedVfs vfs(loop.dispatcher());
+    vfs.EnableConcurrentDispatch();
+    zx::channel clients[kConnections];
+    for (zx::channel& client : clients) {
+        ASSERT_TRUE(Serve(&vfs, &client));
+        ASSERT_TRUE(SendRequests(client));
+    }
+
+    for (uint32_t i = 0; i < kThreads; i++) {
+        ASSERT_EQ(loop.StartThread(), ZX_OK);
+    }
+    for (zx::channel& client : clients) {
+        uint32_t count = 0;
+        while (count < kRequests) {
+            ASSERT_EQ(client.wait_one(ZX_CHANNEL_READABLE, zx::time::infinite(), nullptr),
+                      ZX_OK);
+            ASSERT_TRUE(ReadReplies(client, &count));
+        }
+    }
+
+    sync_completion_t shutdown;
+    vfs.Shutdown([&shutdown](zx_status_t status) {
+        sync_completion_signal(&shutdown);
+    });
+    ASSERT_EQ(sync_completion_wait(&shutdown, ZX_TIME_INFINITE), ZX_OK);
+    loop.Shutdown();
+    END_TEST;
+}
+
+} // namespace
+
+BEGIN_TEST_CASE(connection_tests)
+RUN_TEST(TestPipelinedRequests)
+RUN_TEST(TestPipelinedRequestsBounded)
+RUN_TEST(TestConcurrentDispatch)
+END_TEST_CASE(connection_tests)
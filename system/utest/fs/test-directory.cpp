@@ -4,9 +4,11 @@
 
 #include <assert.h>
 #include <dirent.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -17,6 +19,9 @@
 #include <zircon/compiler.h>
 
 #include <fbl/algorithm.h>
+#include <lib/fdio/io.h>
+#include <lib/fdio/limits.h>
+#include <lib/fdio/vfs.h>
 
 #include "filesystems.h"
 #include "misc.h"
@@ -375,6 +380,82 @@ bool TestDirectoryReaddirRmAll(void) {
     END_TEST;
 }
 
+// Entries read with fdio_readdir_plus carry the same attributes as stat
+// returns for them, across several calls.
+bool TestDirectoryReaddirPlus(void) {
+    BEGIN_TEST;
+
+    constexpr size_t kEntries = 300;
+    ASSERT_EQ(mkdir("::dir", 0755), 0);
+    for (size_t i = 0; i < kEntries; i++) {
+        char name[100];
+        snprintf(name, sizeof(name), "::dir/%05zu", i);
+        if (i % 2 == 0) {
+            ASSERT_EQ(mkdir(name, 0755), 0);
+        } else {
+            int fd = open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+            ASSERT_GT(fd, 0);
+            ASSERT_EQ(ftruncate(fd, i), 0);
+            ASSERT_EQ(close(fd), 0);
+        }
+    }
+
+    int fd = open("::dir", O_RDONLY | O_DIRECTORY);
+    ASSERT_GT(fd, 0);
+    bool seen[kEntries] = {};
+    size_t num_seen = 0;
+    size_t num_calls = 0;
+    uint64_t buffer[FDIO_CHUNK_SIZE / sizeof(uint64_t)];
+
+    // A buffer too small for any entry is an error, not the end of the
+    // directory, and skips no entries.
+    size_t actual;
+    ASSERT_EQ(fdio_readdir_plus(fd, buffer, offsetof(vdirent_plus_t, name), &actual),
+              ZX_ERR_BUFFER_TOO_SMALL);
+    for (;;) {
+        ASSERT_EQ(fdio_readdir_plus(fd, buffer, sizeof(buffer), &actual), ZX_OK);
+        if (actual == 0) {
+            break;
+        }
+        num_calls++;
+        for (size_t off = 0; off < actual;) {
+            const vdirent_plus_t* de = reinterpret_cast<const vdirent_plus_t*>(
+                reinterpret_cast<const char*>(buffer) + off);
+            off += VDIRENT_PLUS_LEN(de->size);
+            char name[NAME_MAX + 1];
+            memcpy(name, de->name, de->size);
+            name[de->size] = '\0';
+
+            struct stat st;
+            ASSERT_EQ(fstatat(fd, name, &st, 0), 0, name);
+            ASSERT_EQ(de->attr.mode, st.st_mode, name);
+            ASSERT_EQ(de->attr.inode, static_cast<uint64_t>(st.st_ino), name);
+            ASSERT_EQ(de->attr.size, static_cast<uint64_t>(st.st_size), name);
+            ASSERT_EQ(de->attr.nlink, static_cast<uint64_t>(st.st_nlink), name);
+            ASSERT_EQ(de->type, VTYPE_TO_DTYPE(st.st_mode), name);
+            if (!strcmp(name, ".")) {
+                continue;
+            }
+            size_t i = strtoul(name, nullptr, 10);
+            ASSERT_LT(i, kEntries, name);
+            ASSERT_FALSE(seen[i], name);
+            seen[i] = true;
+            num_seen++;
+        }
+    }
+    ASSERT_EQ(num_seen, kEntries, "Did not see all expected entries");
+    ASSERT_GT(num_calls, 1u);
+    ASSERT_EQ(close(fd), 0);
+
+    for (size_t i = 0; i < kEntries; i++) {
+        char name[100];
+        snprintf(name, sizeof(name), "::dir/%05zu", i);
+        ASSERT_EQ(i % 2 == 0 ? rmdir(name) : unlink(name), 0);
+    }
+    ASSERT_EQ(rmdir("::dir"), 0);
+    END_TEST;
+}
+
 bool TestDirectoryRewind(void) {
     BEGIN_TEST;
 
@@ -458,6 +539,45 @@ bool TestDirectoryAfterRmdir(void) {
     END_TEST;
 }
 
+// Paths which were recently walked (or found to be missing) reflect later
+// changes to the namespace.
+bool TestDirectoryLookupAfterChange(void) {
+    BEGIN_TEST;
+
+    // A missing name, once created, can be found.
+    ASSERT_EQ(mkdir("::a", 0755), 0);
+    ASSERT_EQ(open("::a/b/file", O_RDONLY), -1);
+    ASSERT_EQ(errno, ENOENT);
+    ASSERT_EQ(mkdir("::a/b", 0755), 0);
+    int fd = open("::a/b/file", O_CREAT | O_EXCL | O_RDWR, 0644);
+    ASSERT_GT(fd, 0);
+    ASSERT_EQ(close(fd), 0);
+
+    // A directory which was walked through, once moved away, is no longer
+    // found under its old name...
+    ASSERT_EQ(rename("::a/b", "::a/c"), 0);
+    ASSERT_EQ(open("::a/b/file", O_RDONLY), -1);
+    ASSERT_EQ(errno, ENOENT);
+    fd = open("::a/c/file", O_RDONLY);
+    ASSERT_GT(fd, 0);
+    ASSERT_EQ(close(fd), 0);
+
+    // ... and, once removed, is not found at all.
+    ASSERT_EQ(unlink("::a/c/file"), 0);
+    ASSERT_EQ(rmdir("::a/c"), 0);
+    ASSERT_EQ(open("::a/c/file", O_RDONLY), -1);
+    ASSERT_EQ(errno, ENOENT);
+
+    // A new directory with the same name is empty.
+    ASSERT_EQ(mkdir("::a/c", 0755), 0);
+    ASSERT_EQ(open("::a/c/file", O_RDONLY), -1);
+    ASSERT_EQ(errno, ENOENT);
+    ASSERT_EQ(rmdir("::a/c"), 0);
+    ASSERT_EQ(rmdir("::a"), 0);
+
+    END_TEST;
+}
+
 RUN_FOR_ALL_FILESYSTEMS(directory_tests,
     RUN_TEST_MEDIUM(TestDirectoryCoalesce)
     RUN_TEST_MEDIUM(TestDirectoryCoalesceLargeRecord)
@@ -466,8 +586,10 @@ RUN_FOR_ALL_FILESYSTEMS(directory_tests,
     RUN_TEST_MEDIUM(TestDirectoryTrailingSlash)
     RUN_TEST_MEDIUM(TestDirectoryReaddir)
     RUN_TEST_LARGE(TestDirectoryReaddirRmAll)
+    RUN_TEST_MEDIUM(TestDirectoryReaddirPlus)
     RUN_TEST_MEDIUM(TestDirectoryRewind)
     RUN_TEST_MEDIUM(TestDirectoryAfterRmdir)
+    RUN_TEST_MEDIUM(TestDirectoryLookupAfterChange)
 )
 
 // TODO(smklein): Run this when MemFS can execute it without causing an OOM
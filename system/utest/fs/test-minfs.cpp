@@ -514,6 +514,51 @@ bool TestUnlinkFail(void) {
 
     END_TEST;
 }
+
+// File contents are read from disk when they are first accessed. A read which
+// fails should be reported, and leave the file readable once the disk works
+// again.
+bool TestReadFail(void) {
+    BEGIN_TEST;
+
+    if (use_real_disk) {
+        fprintf(stderr, "Ramdisk required; skipping test\n");
+        return true;
+    }
+
+    constexpr size_t kBlocks = 64;
+    char data[minfs::kMinfsBlockSize];
+    const char* filename = "::file";
+    fbl::unique_fd fd(open(filename, O_CREAT | O_RDWR));
+    ASSERT_TRUE(fd);
+    for (size_t i = 0; i < kBlocks; i++) {
+        memset(data, static_cast<int>(i), sizeof(data));
+        ASSERT_EQ(write(fd.get(), data, sizeof(data)), sizeof(data));
+    }
+    ASSERT_EQ(close(fd.release()), 0);
+
+    // Remount, so that none of the file is in memory.
+    ASSERT_TRUE(check_remount());
+    fd.reset(open(filename, O_RDWR));
+    ASSERT_TRUE(fd);
+
+    ASSERT_EQ(sleep_ramdisk(ramdisk_path, 0), 0);
+    ASSERT_EQ(pread(fd.get(), data, sizeof(data), 3 * sizeof(data)), -1);
+    ASSERT_EQ(errno, EIO);
+    ASSERT_EQ(wake_ramdisk(ramdisk_path), 0);
+
+    // Both the block which failed, and those around it, are read again.
+    for (size_t i = 0; i < kBlocks; i++) {
+        ASSERT_EQ(pread(fd.get(), data, sizeof(data), i * sizeof(data)), sizeof(data));
+        for (size_t j = 0; j < sizeof(data); j++) {
+            ASSERT_EQ(data[j], static_cast<char>(i));
+        }
+    }
+
+    ASSERT_EQ(close(fd.release()), 0);
+    ASSERT_EQ(unlink(filename), 0);
+    END_TEST;
+}
 }  // namespace
 
 #define RUN_MINFS_TESTS_NORMAL(name, CASE_TESTS) \
@@ -525,6 +570,7 @@ bool TestUnlinkFail(void) {
 RUN_MINFS_TESTS_NORMAL(FsMinfsTests,
     RUN_TEST_LARGE(TestFullOperations)
     RUN_TEST_MEDIUM(TestUnlinkFail)
+    RUN_TEST_MEDIUM(TestReadFail)
 )
 
 RUN_MINFS_TESTS_FVM(FsMinfsFvmTests,
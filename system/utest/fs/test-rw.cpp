@@ -9,13 +9,25 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <threads.h>
 #include <unistd.h>
 
 #include <fbl/algorithm.h>
 #include <fbl/alloc_checker.h>
 #include <fbl/unique_fd.h>
 #include <fbl/unique_ptr.h>
+#include <fbl/vector.h>
+#include <fuchsia/io/c/fidl.h>
+#include <lib/fdio/util.h>
+#include <lib/zx/channel.h>
+#include <lib/zx/port.h>
+#include <zircon/processargs.h>
 #include <zircon/syscalls.h>
+#include <zircon/syscalls/port.h>
+
+#include <atomic>
+#include <utility>
 
 #include "filesystems.h"
 #include "misc.h"
@@ -112,9 +124,232 @@ bool TestOffsetOperations(void) {
     END_TEST;
 }
 
+// Forwards messages between a client and a directory connection, and the
+// connections to the nodes opened through it, counting the ReadAt and WriteAt
+// requests which a pipelined transfer sends. zx_channel_call() always uses a
+// txid with the high bit set, which pipelined requests don't.
+class PipelineCounter {
+public:
+    ~PipelineCounter() {
+        if (started_) {
+            zx_port_packet_t packet = {};
+            packet.key = kQuitKey;
+            packet.type = ZX_PKT_TYPE_USER;
+            port_.queue(&packet);
+            thrd_join(thread_, nullptr);
+        }
+    }
+
+    // Starts forwarding between |directory| and a new file descriptor.
+    zx_status_t Start(zx::channel directory, int* out_fd) {
+        zx::channel client, server;
+        zx_status_t status;
+        if ((status = zx::port::create(0, &port_)) != ZX_OK ||
+            (status = zx::channel::create(0, &client, &server)) != ZX_OK ||
+            (status = AddPair(std::move(server), std::move(directory))) != ZX_OK) {
+            return status;
+        }
+        if (thrd_create(&thread_, [](void* arg) {
+                return static_cast<PipelineCounter*>(arg)->Run();
+            }, this) != thrd_success) {
+            return ZX_ERR_NO_RESOURCES;
+        }
+        started_ = true;
+        zx_handle_t handle = client.release();
+        uint32_t type = PA_FDIO_REMOTE;
+        return fdio_create_fd(&handle, &type, 1, out_fd);
+    }
+
+    uint64_t pipelined_reads() const { return pipelined_reads_.load(); }
+    uint64_t pipelined_writes() const { return pipelined_writes_.load(); }
+
+private:
+    static constexpr uint64_t kQuitKey = UINT64_MAX;
+
+    // |client| receives requests, which go out on |server|.
+    struct Pair {
+        zx::channel client;
+        zx::channel server;
+    };
+
+    zx_status_t AddPair(zx::channel client, zx::channel server) {
+        uint64_t key = pairs_.size() * 2;
+        zx_status_t status;
+        if ((status = Wait(client, key)) != ZX_OK || (status = Wait(server, key + 1)) != ZX_OK) {
+            return status;
+        }
+        fbl::AllocChecker ac;
+        pairs_.push_back(Pair{std::move(client), std::move(server)}, &ac);
+        return ac.check() ? ZX_OK : ZX_ERR_NO_MEMORY;
+    }
+
+    zx_status_t Wait(const zx::channel& channel, uint64_t key) {
+        return channel.wait_async(port_, key, ZX_CHANNEL_READABLE | ZX_CHANNEL_PEER_CLOSED,
+                                  ZX_WAIT_ASYNC_ONCE);
+    }
+
+    void CountRequest(uint32_t actual_bytes) {
+        if (actual_bytes < sizeof(fidl_message_header_t)) {
+            return;
+        }
+        auto* hdr = reinterpret_cast<fidl_message_header_t*>(bytes_);
+        if (hdr->txid == 0 || (hdr->txid & 0x80000000u) != 0) {
+            return;
+        }
+        if (hdr->ordinal == fuchsia_io_FileReadAtOrdinal ||
+            hdr->ordinal == fuchsia_io_FileReadAtGenOrdinal) {
+            pipelined_reads_++;
+        } else if (hdr->ordinal == fuchsia_io_FileWriteAtOrdinal ||
+                   hdr->ordinal == fuchsia_io_FileWriteAtGenOrdinal) {
+            pipelined_writes_++;
+        }
+    }
+
+    // Sends the node opened by an Open request through another pair.
+    zx_status_t InterceptOpen(uint32_t actual_bytes, uint32_t actual_handles) {
+        auto* hdr = reinterpret_cast<fidl_message_header_t*>(bytes_);
+        if (actual_bytes < sizeof(*hdr) || actual_handles != 1 ||
+            (hdr->ordinal != fuchsia_io_DirectoryOpenOrdinal &&
+             hdr->ordinal != fuchsia_io_DirectoryOpenGenOrdinal)) {
+            return ZX_OK;
+        }
+        zx::channel client, server;
+        zx_status_t status = zx::channel::create(0, &client, &server);
+        if (status != ZX_OK) {
+            return status;
+        }
+        zx::channel object(handles_[0]);
+        handles_[0] = server.release();
+        return AddPair(std::move(object), std::move(client));
+    }
+
+    int Run() {
+        for (;;) {
+            zx_port_packet_t packet;
+            if (port_.wait(zx::time::infinite(), &packet) != ZX_OK || packet.key == kQuitKey) {
+                return 0;
+            }
+            size_t index = packet.key / 2;
+            bool from_client = packet.key % 2 == 0;
+            uint32_t actual_bytes, actual_handles;
+            const zx::channel& src = from_client ? pairs_[index].client : pairs_[index].server;
+            if (!(packet.signal.observed & ZX_CHANNEL_READABLE) ||
+                src.read(0, bytes_, sizeof(bytes_), &actual_bytes, handles_,
+                         fbl::count_of(handles_), &actual_handles) != ZX_OK) {
+                pairs_[index] = Pair();
+                continue;
+            }
+            if (from_client) {
+                CountRequest(actual_bytes);
+                if (InterceptOpen(actual_bytes, actual_handles) != ZX_OK) {
+                    return 0;
+                }
+            }
+            // Looked up again, since InterceptOpen() may have moved |pairs_|.
+            Pair& pair = pairs_[index];
+            const zx::channel& dst = from_client ? pair.server : pair.client;
+            if (dst.write(0, bytes_, actual_bytes, handles_, actual_handles) != ZX_OK ||
+                Wait(from_client ? pair.client : pair.server, packet.key) != ZX_OK) {
+                pair = Pair();
+            }
+        }
+    }
+
+    zx::port port_;
+    thrd_t thread_;
+    bool started_ = false;
+    fbl::Vector<Pair> pairs_;
+    std::atomic<uint64_t> pipelined_reads_{0};
+    std::atomic<uint64_t> pipelined_writes_{0};
+    uint8_t bytes_[ZX_CHANNEL_MAX_MSG_BYTES];
+    zx_handle_t handles_[ZX_CHANNEL_MAX_MSG_HANDLES];
+};
+
+// Test reads and writes much larger than a single message, and vectored
+// reads and writes of many small buffers.
+bool TestLargeOperations(void) {
+    BEGIN_TEST;
+
+    srand(0xDEADBEEF);
+
+    // Not a multiple of the chunk size, so that the last chunk is short.
+    constexpr size_t kFileSize = (1 << 20) + 123;
+    fbl::AllocChecker ac;
+    fbl::unique_ptr<uint8_t[]> expected(new (&ac) uint8_t[kFileSize]);
+    ASSERT_TRUE(ac.check());
+    fbl::unique_ptr<uint8_t[]> buf(new (&ac) uint8_t[2 * kFileSize]);
+    ASSERT_TRUE(ac.check());
+    for (size_t i = 0; i < kFileSize; i++) {
+        expected[i] = static_cast<uint8_t>(rand());
+    }
+
+    // The file is opened through a PipelineCounter, to check that large
+    // transfers are pipelined.
+    fbl::unique_ptr<PipelineCounter> counter(new (&ac) PipelineCounter);
+    ASSERT_TRUE(ac.check());
+    int mount_fd = open(kMountPath, O_RDONLY | O_DIRECTORY);
+    ASSERT_GE(mount_fd, 0);
+    zx_handle_t mount_handle;
+    ASSERT_EQ(fdio_get_service_handle(mount_fd, &mount_handle), ZX_OK);
+    int dir_fd;
+    ASSERT_EQ(counter->Start(zx::channel(mount_handle), &dir_fd), ZX_OK);
+    fbl::unique_fd dir(dir_fd);
+
+    const char* filename = "::large_ops";
+    fbl::unique_fd fd(openat(dir.get(), "large_ops", O_RDWR | O_CREAT, 0644));
+    ASSERT_TRUE(fd);
+    ASSERT_EQ(pwrite(fd.get(), expected.get(), kFileSize, 0), static_cast<ssize_t>(kFileSize));
+    ASSERT_EQ(lseek(fd.get(), 0, SEEK_CUR), 0);
+    ASSERT_GT(counter->pipelined_writes(), 1u);
+
+    // A read at the seek pointer is made a chunk at a time. A read past the
+    // end of the file stops there, and moves the seek pointer past what was
+    // read.
+    memset(buf.get(), 0, 2 * kFileSize);
+    ASSERT_EQ(lseek(fd.get(), 100, SEEK_SET), 100);
+    ASSERT_EQ(read(fd.get(), buf.get(), 2 * kFileSize), static_cast<ssize_t>(kFileSize - 100));
+    ASSERT_EQ(memcmp(buf.get(), expected.get() + 100, kFileSize - 100), 0);
+    ASSERT_EQ(lseek(fd.get(), 0, SEEK_CUR), static_cast<off_t>(kFileSize));
+    ASSERT_EQ(read(fd.get(), buf.get(), 2 * kFileSize), 0);
+    ASSERT_EQ(counter->pipelined_reads(), 0u);
+
+    memset(buf.get(), 0, 2 * kFileSize);
+    ASSERT_EQ(pread(fd.get(), buf.get(), kFileSize, 0), static_cast<ssize_t>(kFileSize));
+    ASSERT_EQ(memcmp(buf.get(), expected.get(), kFileSize), 0);
+    ASSERT_GT(counter->pipelined_reads(), 1u);
+    ASSERT_EQ(lseek(fd.get(), 0, SEEK_CUR), static_cast<off_t>(kFileSize));
+
+    // Vectors of small buffers.
+    constexpr size_t kVectors = 16;
+    constexpr size_t kVectorSize = 1000;
+    struct iovec iov[kVectors];
+    for (size_t i = 0; i < kVectors; i++) {
+        iov[i].iov_base = buf.get() + i * kVectorSize;
+        iov[i].iov_len = kVectorSize;
+    }
+    memset(buf.get(), 0, 2 * kFileSize);
+    ASSERT_EQ(preadv(fd.get(), iov, kVectors, 10), static_cast<ssize_t>(kVectors * kVectorSize));
+    ASSERT_EQ(memcmp(buf.get(), expected.get() + 10, kVectors * kVectorSize), 0);
+
+    memset(buf.get(), 0xab, kVectors * kVectorSize);
+    memset(expected.get() + 50, 0xab, kVectors * kVectorSize);
+    ASSERT_EQ(lseek(fd.get(), 50, SEEK_SET), 50);
+    ASSERT_EQ(writev(fd.get(), iov, kVectors), static_cast<ssize_t>(kVectors * kVectorSize));
+    ASSERT_EQ(lseek(fd.get(), 0, SEEK_CUR), static_cast<off_t>(50 + kVectors * kVectorSize));
+    memset(buf.get(), 0, 2 * kFileSize);
+    ASSERT_EQ(pread(fd.get(), buf.get(), kFileSize, 0), static_cast<ssize_t>(kFileSize));
+    ASSERT_EQ(memcmp(buf.get(), expected.get(), kFileSize), 0);
+
+    ASSERT_EQ(close(fd.release()), 0);
+    ASSERT_EQ(unlink(filename), 0);
+
+    END_TEST;
+}
+
 }  // namespace
 
 RUN_FOR_ALL_FILESYSTEMS(rw_tests,
     RUN_TEST_MEDIUM(TestZeroLengthOperations)
     RUN_TEST_MEDIUM(TestOffsetOperations)
+    RUN_TEST_MEDIUM(TestLargeOperations)
 )
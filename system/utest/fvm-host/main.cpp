@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include <blobfs/lz4.h>
+#include <fbl/algorithm.h>
 #include <fbl/string.h>
 #include <fbl/unique_fd.h>
 #include <fvm-host/container.h>
@@ -11,6 +12,10 @@
 
 #include <fvm/sparse-reader.h>
 
+#include <inttypes.h>
+
+#include <chrono>
+#include <thread>
 #include <utility>
 
 #define DEFAULT_SLICE_SIZE (8lu * (1 << 20))  // 8 mb
@@ -585,6 +590,62 @@ bool TestCompressorBufferTooSmall() {
     END_TEST;
 }
 
+// Compresses |data| with |thread_count| threads, feeding it to |compression| in block-sized
+// pieces as SparseContainer does.
+bool CompressWithThreads(const uint8_t* data, size_t length, unsigned thread_count,
+                         CompressionContext* compression) {
+    BEGIN_HELPER;
+    compression->SetThreadCount(thread_count);
+    ASSERT_EQ(compression->Setup(length), ZX_OK);
+    constexpr size_t kChunkSize = 8192;
+    for (size_t offset = 0; offset < length; offset += kChunkSize) {
+        size_t chunk = fbl::min(kChunkSize, length - offset);
+        ASSERT_EQ(compression->Compress(data + offset, chunk), ZX_OK);
+    }
+    ASSERT_EQ(compression->Finish(), ZX_OK);
+    END_HELPER;
+}
+
+// Test that parallel compression produces the same, decompressible, output for any number of
+// compression threads.
+bool TestCompressorThreadCounts() {
+    BEGIN_TEST;
+
+    // Several batches of blocks, with a partial block at the end. Alternate between compressible
+    // and incompressible runs so that both block encodings are exercised.
+    constexpr size_t kDataSize = (8lu << 20) + 12345;
+    fbl::unique_ptr<uint8_t[]> data(new uint8_t[kDataSize]);
+    unsigned int seed = 0;
+    for (size_t i = 0; i < kDataSize; i++) {
+        data[i] = ((i >> 16) & 1) ? static_cast<uint8_t>(rand_r(&seed))
+                                   : static_cast<uint8_t>(i % 7);
+    }
+
+    CompressionContext serial;
+    ASSERT_TRUE(CompressWithThreads(data.get(), kDataSize, 1, &serial));
+
+    for (unsigned thread_count : {2, 3, 8}) {
+        CompressionContext parallel;
+        ASSERT_TRUE(CompressWithThreads(data.get(), kDataSize, thread_count, &parallel));
+        ASSERT_EQ(parallel.GetLength(), serial.GetLength());
+        ASSERT_EQ(memcmp(parallel.GetData(), serial.GetData(), serial.GetLength()), 0);
+    }
+
+    LZ4F_decompressionContext_t dctx;
+    ASSERT_FALSE(LZ4F_isError(LZ4F_createDecompressionContext(&dctx, LZ4F_VERSION)));
+    auto cleanup = fbl::MakeAutoCall([&dctx]() { LZ4F_freeDecompressionContext(dctx); });
+    fbl::unique_ptr<uint8_t[]> out(new uint8_t[kDataSize]);
+    size_t out_size = kDataSize;
+    size_t in_size = serial.GetLength();
+    size_t r = LZ4F_decompress(dctx, out.get(), &out_size, serial.GetData(), &in_size, nullptr);
+    ASSERT_EQ(r, 0, "Frame was not fully decompressed");
+    ASSERT_EQ(in_size, serial.GetLength());
+    ASSERT_EQ(out_size, kDataSize);
+    ASSERT_EQ(memcmp(out.get(), data.get(), kDataSize), 0);
+
+    END_TEST;
+}
+
 bool TestBlobfsCompressor() {
     BEGIN_TEST;
     blobfs::Compressor compressor;
@@ -614,6 +675,70 @@ bool TestBlobfsCompressor() {
     END_TEST;
 }
 
+// Times compressed sparse image generation from a multi-GB blobfs partition with a single
+// compression thread and with one thread per core.
+bool TestSparseCompressionPerformance() {
+    BEGIN_TEST;
+    constexpr size_t kPerfPartitionSize = 3lu << 30;
+    constexpr size_t kPerfBlobSize = 32lu << 20;
+    constexpr size_t kPerfBlobCount = 64;
+
+    char blobfs_path[PATH_MAX];
+    char perf_sparse_path[PATH_MAX];
+    sprintf(blobfs_path, "%sperf_blobfs.bin", test_dir);
+    sprintf(perf_sparse_path, "%sperf_sparse.bin.lz4", test_dir);
+
+    fbl::unique_fd fd(open(blobfs_path, O_RDWR | O_CREAT | O_EXCL, 0755));
+    ASSERT_TRUE(fd, "Unable to create blobfs path");
+    ASSERT_EQ(ftruncate(fd.get(), kPerfPartitionSize), 0);
+    uint64_t block_count;
+    ASSERT_EQ(blobfs::GetBlockCount(fd.get(), &block_count), ZX_OK);
+    ASSERT_EQ(blobfs::Mkfs(fd.get(), block_count), ZX_OK);
+    fbl::unique_ptr<blobfs::Blobfs> bs;
+    ASSERT_EQ(blobfs::blobfs_create(&bs, std::move(fd)), ZX_OK);
+
+    // Low-entropy synthetic contents, so that blocks actually compress.
+    fbl::unique_ptr<uint8_t[]> data(new uint8_t[kPerfBlobSize]);
+    unsigned int seed = 0;
+    for (size_t i = 0; i < kPerfBlobCount; i++) {
+        for (size_t n = 0; n < kPerfBlobSize; n++) {
+            data[n] = static_cast<uint8_t>(rand_r(&seed) % 16);
+        }
+
+        char blob_path[PATH_MAX];
+        GenerateFilename(test_dir, 10, blob_path);
+        fbl::unique_fd blobfd(open(blob_path, O_RDWR | O_CREAT | O_EXCL, 0755));
+        ASSERT_TRUE(blobfd);
+        ASSERT_EQ(write(blobfd.get(), data.get(), kPerfBlobSize), kPerfBlobSize);
+        ASSERT_EQ(blobfs::blobfs_add_blob(bs.get(), blobfd.get()), ZX_OK);
+        ASSERT_EQ(unlink(blob_path), 0);
+    }
+    bs.reset();
+
+    unsigned cores = fbl::max(std::thread::hardware_concurrency(), 1u);
+    for (unsigned thread_count : {1u, cores}) {
+        fbl::unique_ptr<SparseContainer> container;
+        ASSERT_EQ(SparseContainer::Create(perf_sparse_path, DEFAULT_SLICE_SIZE,
+                                          fvm::kSparseFlagLz4, &container), ZX_OK);
+        container->SetCompressionThreads(thread_count);
+        ASSERT_EQ(container->AddPartition(blobfs_path, kBlobTypeName), ZX_OK);
+
+        auto start = std::chrono::steady_clock::now();
+        ASSERT_EQ(container->Commit(), ZX_OK);
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start);
+
+        off_t length;
+        ASSERT_TRUE(StatFile(perf_sparse_path, &length));
+        printf("\n  sparse lz4, %u thread(s): %" PRId64 " ms, %" PRId64 " bytes\n", thread_count,
+               static_cast<int64_t>(elapsed.count()), static_cast<int64_t>(length));
+        ASSERT_EQ(unlink(perf_sparse_path), 0);
+    }
+
+    ASSERT_EQ(unlink(blobfs_path), 0);
+    END_TEST;
+}
+
 enum class PaveSizeType {
     kSmall, // Allocate disk space for paving smaller than what is required.
     kExact, // Allocate exactly as much disk space as is required for a pave.
@@ -816,10 +941,12 @@ BEGIN_TEST_CASE(fvm_host_tests)
 RUN_FOR_ALL_TYPES(8192)
 RUN_FOR_ALL_TYPES(DEFAULT_SLICE_SIZE)
 RUN_TEST_MEDIUM(TestCompressorBufferTooSmall)
+RUN_TEST_MEDIUM(TestCompressorThreadCounts)
 RUN_TEST_MEDIUM(TestBlobfsCompressor)
 RUN_ALL_PAVE(8192)
 RUN_ALL_PAVE(DEFAULT_SLICE_SIZE)
 RUN_TEST_MEDIUM(TestPaveZxcryptFail)
+RUN_TEST_PERFORMANCE(TestSparseCompressionPerformance)
 END_TEST_CASE(fvm_host_tests)
 
 int main(int argc, char** argv) {
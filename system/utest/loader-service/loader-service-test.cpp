@@ -0,0 +1,323 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fbl/unique_fd.h>
+#include <ldmsg/ldmsg.h>
+#include <lib/async-loop/cpp/loop.h>
+#include <lib/fdio/io.h>
+#include <lib/fdio/util.h>
+#include <lib/memfs/memfs.h>
+#include <lib/sync/completion.h>
+#include <lib/zx/channel.h>
+#include <lib/zx/vmo.h>
+#include <loader-service/loader-service.h>
+#include <unittest/unittest.h>
+#include <zircon/processargs.h>
+#include <zircon/syscalls.h>
+#include <zircon/syscalls/object.h>
+
+#include <utility>
+
+namespace {
+
+// A memfs holding the library path of a loader service created by
+// loader_service_create_fd, and a connection to the service.
+struct Fixture {
+    Fixture() : loop(&kAsyncLoopConfigNoAttachToThread) {}
+
+    ~Fixture() {
+        client.reset();
+        if (svc != nullptr) {
+            loader_service_release(svc);
+        }
+        root_fd.reset();
+        if (vfs != nullptr) {
+            sync_completion_t unmounted;
+            memfs_free_filesystem(vfs, &unmounted);
+            sync_completion_wait(&unmounted, ZX_SEC(3));
+        }
+    }
+
+    async::Loop loop;
+    memfs_filesystem_t* vfs = nullptr;
+    fbl::unique_fd root_fd;
+    loader_service_t* svc = nullptr;
+    zx::channel client;
+};
+
+bool WriteFile(int dir_fd, const char* path, const char* contents) {
+    BEGIN_HELPER;
+    fbl::unique_fd fd(openat(dir_fd, path, O_CREAT | O_RDWR, 0644));
+    ASSERT_TRUE(fd);
+    ssize_t len = static_cast<ssize_t>(strlen(contents));
+    ASSERT_EQ(write(fd.get(), contents, len), len);
+    END_HELPER;
+}
+
+bool SetUp(Fixture* f) {
+    BEGIN_HELPER;
+    ASSERT_EQ(f->loop.StartThread(), ZX_OK);
+    zx_handle_t root;
+    ASSERT_EQ(memfs_create_filesystem(f->loop.dispatcher(), &f->vfs, &root), ZX_OK);
+    uint32_t type = PA_FDIO_REMOTE;
+    int root_fd;
+    ASSERT_EQ(fdio_create_fd(&root, &type, 1, &root_fd), ZX_OK);
+    f->root_fd.reset(root_fd);
+
+    ASSERT_EQ(mkdirat(root_fd, "lib", 0755), 0);
+    ASSERT_EQ(mkdirat(root_fd, "lib/asan", 0755), 0);
+    ASSERT_TRUE(WriteFile(root_fd, "lib/libfoo.so", "foo"));
+    ASSERT_TRUE(WriteFile(root_fd, "lib/asan/libfoo.so", "asan foo"));
+
+    ASSERT_EQ(loader_service_create_fd(nullptr, dup(root_fd), &f->svc), ZX_OK);
+    zx_handle_t client;
+    ASSERT_EQ(loader_service_connect(f->svc, &client), ZX_OK);
+    f->client.reset(client);
+    END_HELPER;
+}
+
+// Sends a request to the loader service, returning its status and, if
+// |out| isn't null, the VMO it returned.
+zx_status_t Request(const zx::channel& client, uint32_t ordinal, const char* data,
+                    zx::vmo* out) {
+    ldmsg_req_t req;
+    memset(&req.header, 0, sizeof(req.header));
+    req.header.ordinal = ordinal;
+    size_t req_len;
+    zx_status_t status = ldmsg_req_encode(&req, &req_len, data, strlen(data));
+    if (status != ZX_OK) {
+        return status;
+    }
+
+    ldmsg_rsp_t rsp;
+    memset(&rsp, 0, sizeof(rsp));
+    zx_handle_t handle = ZX_HANDLE_INVALID;
+    zx_channel_call_args_t call = {
+        .wr_bytes = &req,
+        .wr_handles = nullptr,
+        .rd_bytes = &rsp,
+        .rd_handles = &handle,
+        .wr_num_bytes = static_cast<uint32_t>(req_len),
+        .wr_num_handles = 0,
+        .rd_num_bytes = sizeof(rsp),
+        .rd_num_handles = 1,
+    };
+    uint32_t actual_bytes;
+    uint32_t actual_handles;
+    if ((status = client.call(0, zx::time::infinite(), &call, &actual_bytes,
+                              &actual_handles)) != ZX_OK) {
+        return status;
+    }
+    zx::vmo vmo(handle);
+    if (out != nullptr) {
+        *out = std::move(vmo);
+    }
+    return rsp.rv;
+}
+
+zx_status_t Load(const zx::channel& client, const char* name, zx::vmo* out) {
+    return Request(client, LDMSG_OP_LOAD_OBJECT, name, out);
+}
+
+// Returns the koid of the VMO |vmo| was cloned from.
+zx_koid_t ParentKoid(const zx::vmo& vmo) {
+    zx_info_vmo_t info;
+    if (vmo.get_info(ZX_INFO_VMO, &info, sizeof(info), nullptr, nullptr) != ZX_OK) {
+        return ZX_KOID_INVALID;
+    }
+    return info.parent_koid;
+}
+
+// Returns the koid of the VMO memfs keeps the file at |path| in. When an
+// object isn't cached, clients get clones of it; when it is, they get clones
+// of the clone the loader service keeps.
+zx_koid_t FileKoid(int dir_fd, const char* path) {
+    fbl::unique_fd fd(openat(dir_fd, path, O_RDONLY));
+    zx::vmo vmo;
+    zx_info_handle_basic_t info;
+    if (!fd || fdio_get_vmo_exact(fd.get(), vmo.reset_and_get_address()) != ZX_OK ||
+        vmo.get_info(ZX_INFO_HANDLE_BASIC, &info, sizeof(info), nullptr, nullptr) != ZX_OK) {
+        return ZX_KOID_INVALID;
+    }
+    return info.koid;
+}
+
+bool ContentsEqual(const zx::vmo& vmo, const char* contents) {
+    char buf[32] = {};
+    size_t len = strlen(contents);
+    return len < sizeof(buf) && vmo.read(buf, 0, len) == ZX_OK &&
+           memcmp(buf, contents, len) == 0;
+}
+
+bool CacheHitTest() {
+    BEGIN_TEST;
+    Fixture f;
+    ASSERT_TRUE(SetUp(&f));
+    zx_koid_t file_koid = FileKoid(f.root_fd.get(), "lib/libfoo.so");
+    ASSERT_NE(file_koid, ZX_KOID_INVALID);
+
+    // Both loads are served from the same cached VMO, each by a clone of its
+    // own.
+    zx::vmo first, second;
+    ASSERT_EQ(Load(f.client, "libfoo.so", &first), ZX_OK);
+    ASSERT_EQ(Load(f.client, "libfoo.so", &second), ZX_OK);
+    EXPECT_TRUE(ContentsEqual(first, "foo"));
+    EXPECT_TRUE(ContentsEqual(second, "foo"));
+    EXPECT_NE(ParentKoid(first), file_koid);
+    EXPECT_EQ(ParentKoid(first), ParentKoid(second));
+    EXPECT_NE(first.get(), second.get());
+
+    ASSERT_EQ(Load(f.client, "libmissing.so", nullptr), ZX_ERR_NOT_FOUND);
+    END_TEST;
+}
+
+bool ClientWriteIsolationTest() {
+    BEGIN_TEST;
+    Fixture f;
+    ASSERT_TRUE(SetUp(&f));
+
+    // The client whose load filled the cache may write to its VMO without
+    // changing what later clients load.
+    zx::vmo first;
+    ASSERT_EQ(Load(f.client, "libfoo.so", &first), ZX_OK);
+    ASSERT_EQ(first.write("bar", 0, 3), ZX_OK);
+    zx::vmo second;
+    ASSERT_EQ(Load(f.client, "libfoo.so", &second), ZX_OK);
+    EXPECT_EQ(ParentKoid(first), ParentKoid(second));
+    EXPECT_TRUE(ContentsEqual(second, "foo"));
+
+    // Nor may later clients change what the first one sees.
+    ASSERT_EQ(second.write("baz", 0, 3), ZX_OK);
+    EXPECT_TRUE(ContentsEqual(first, "bar"));
+    zx::vmo third;
+    ASSERT_EQ(Load(f.client, "libfoo.so", &third), ZX_OK);
+    EXPECT_TRUE(ContentsEqual(third, "foo"));
+    END_TEST;
+}
+
+bool FlushOnWatchEventTest() {
+    BEGIN_TEST;
+    Fixture f;
+    ASSERT_TRUE(SetUp(&f));
+    zx_koid_t file_koid = FileKoid(f.root_fd.get(), "lib/libfoo.so");
+
+    zx::vmo vmo;
+    ASSERT_EQ(Load(f.client, "libfoo.so", &vmo), ZX_OK);
+    zx_koid_t cached_koid = ParentKoid(vmo);
+    ASSERT_NE(cached_koid, file_koid);
+
+    // Adding a name to the library path flushes the cache once the watch
+    // reports it, after which the object is loaded and cached anew.
+    ASSERT_TRUE(WriteFile(f.root_fd.get(), "lib/libbar.so", "bar"));
+    zx_koid_t koid = cached_koid;
+    for (int i = 0; i < 100 && koid == cached_koid; ++i) {
+        zx_nanosleep(zx_deadline_after(ZX_MSEC(10)));
+        ASSERT_EQ(Load(f.client, "libfoo.so", &vmo), ZX_OK);
+        koid = ParentKoid(vmo);
+    }
+    EXPECT_NE(koid, cached_koid);
+    EXPECT_NE(koid, file_koid);
+    EXPECT_TRUE(ContentsEqual(vmo, "foo"));
+    END_TEST;
+}
+
+bool UncachedNamesTest() {
+    BEGIN_TEST;
+    Fixture f;
+    ASSERT_TRUE(SetUp(&f));
+    zx_koid_t file_koid = FileKoid(f.root_fd.get(), "lib/asan/libfoo.so");
+    ASSERT_NE(file_koid, ZX_KOID_INVALID);
+
+    // Names containing '/' are loaded from the filesystem every time.
+    zx::vmo vmo;
+    for (int i = 0; i < 2; ++i) {
+        ASSERT_EQ(Load(f.client, "asan/libfoo.so", &vmo), ZX_OK);
+        EXPECT_EQ(ParentKoid(vmo), file_koid);
+        EXPECT_TRUE(ContentsEqual(vmo, "asan foo"));
+    }
+
+    // So are names with a configured prefix.
+    ASSERT_EQ(Request(f.client, LDMSG_OP_CONFIG, "asan", nullptr), ZX_OK);
+    for (int i = 0; i < 2; ++i) {
+        ASSERT_EQ(Load(f.client, "libfoo.so", &vmo), ZX_OK);
+        EXPECT_EQ(ParentKoid(vmo), file_koid);
+        EXPECT_TRUE(ContentsEqual(vmo, "asan foo"));
+    }
+    END_TEST;
+}
+
+bool SetCacheEnabledTest() {
+    BEGIN_TEST;
+    Fixture f;
+    ASSERT_TRUE(SetUp(&f));
+    zx_koid_t file_koid = FileKoid(f.root_fd.get(), "lib/libfoo.so");
+
+    // While disabled, every load goes to the filesystem.
+    ASSERT_EQ(loader_service_set_cache_enabled(f.svc, false), ZX_OK);
+    zx::vmo first, second;
+    ASSERT_EQ(Load(f.client, "libfoo.so", &first), ZX_OK);
+    ASSERT_EQ(Load(f.client, "libfoo.so", &second), ZX_OK);
+    EXPECT_EQ(ParentKoid(first), file_koid);
+    EXPECT_EQ(ParentKoid(second), file_koid);
+
+    ASSERT_EQ(loader_service_set_cache_enabled(f.svc, true), ZX_OK);
+    ASSERT_EQ(Load(f.client, "libfoo.so", &first), ZX_OK);
+    ASSERT_EQ(Load(f.client, "libfoo.so", &second), ZX_OK);
+    EXPECT_NE(ParentKoid(first), file_koid);
+    EXPECT_EQ(ParentKoid(first), ParentKoid(second));
+
+    // Disabling the cache drops what it held.
+    zx_koid_t cached_koid = ParentKoid(first);
+    ASSERT_EQ(loader_service_set_cache_enabled(f.svc, false), ZX_OK);
+    ASSERT_EQ(loader_service_set_cache_enabled(f.svc, true), ZX_OK);
+    ASSERT_EQ(Load(f.client, "libfoo.so", &first), ZX_OK);
+    EXPECT_NE(ParentKoid(first), cached_koid);
+
+    EXPECT_EQ(loader_service_set_cache_enabled(nullptr, true), ZX_ERR_INVALID_ARGS);
+    END_TEST;
+}
+
+zx_status_t NotFound(void* ctx, const char* name, zx_handle_t* out) {
+    return ZX_ERR_NOT_FOUND;
+}
+
+zx_status_t NoDataSink(void* ctx, const char* name, zx_handle_t vmo) {
+    zx_handle_close(vmo);
+    return ZX_ERR_NOT_SUPPORTED;
+}
+
+bool SetCacheEnabledCustomOpsTest() {
+    BEGIN_TEST;
+    static const loader_service_ops_t ops = {
+        .load_object = NotFound,
+        .load_abspath = NotFound,
+        .publish_data_sink = NoDataSink,
+        .finalizer = nullptr,
+    };
+    loader_service_t* svc;
+    ASSERT_EQ(loader_service_create(nullptr, &ops, nullptr, &svc), ZX_OK);
+    EXPECT_EQ(loader_service_set_cache_enabled(svc, true), ZX_ERR_NOT_SUPPORTED);
+    ASSERT_EQ(loader_service_release(svc), ZX_OK);
+    END_TEST;
+}
+
+} // namespace
+
+BEGIN_TEST_CASE(loader_service_tests)
+RUN_TEST(CacheHitTest)
+RUN_TEST(ClientWriteIsolationTest)
+RUN_TEST(FlushOnWatchEventTest)
+RUN_TEST(UncachedNamesTest)
+RUN_TEST(SetCacheEnabledTest)
+RUN_TEST(SetCacheEnabledCustomOpsTest)
+END_TEST_CASE(loader_service_tests)
+
+int main(int argc, char** argv) {
+    return unittest_run_all_tests(argc, argv) ? 0 : -1;
+}
@@ -0,0 +1,41 @@
+# Copyright 2018 The Fuchsia Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+LOCAL_DIR := $(GET_LOCAL_DIR)
+
+MODULE := $(LOCAL_DIR)
+
+MODULE_TYPE := usertest
+
+MODULE_SRCS += \
+    $(LOCAL_DIR)/loader-service-test.cpp \
+
+MODULE_NAME := loader-service-test
+
+MODULE_FIDL_LIBS := \
+    system/fidl/fuchsia-io \
+    system/fidl/fuchsia-mem \
+
+MODULE_STATIC_LIBS := \
+    system/ulib/async \
+    system/ulib/async.cpp \
+    system/ulib/async-loop \
+    system/ulib/async-loop.cpp \
+    system/ulib/fbl \
+    system/ulib/fidl \
+    system/ulib/ldmsg \
+    system/ulib/loader-service \
+    system/ulib/sync \
+    system/ulib/zx \
+    system/ulib/zxcpp \
+
+MODULE_LIBS := \
+    system/ulib/async.default \
+    system/ulib/c \
+    system/ulib/fdio \
+    system/ulib/memfs \
+    system/ulib/unittest \
+    system/ulib/zircon \
+
+include make/module.mk
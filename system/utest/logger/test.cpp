@@ -7,6 +7,9 @@
 #include <fuchsia/logger/c/fidl.h>
 #include <lib/async-loop/cpp/loop.h>
 #include <lib/syslog/global.h>
+#include <lib/syslog/wire_format.h>
+#include <lib/zx/eventpair.h>
+#include <lib/zx/vmo.h>
 #include <unittest/unittest.h>
 
 #include <fcntl.h>
@@ -84,6 +87,25 @@ public:
         return true;
     }
 
+    // Connects a shared log buffer of |size| bytes, without initializing it.
+    bool ConnectBufferToLogger(size_t size) {
+        ASSERT_TRUE(logger_handle_);
+        zx::vmo vmo;
+        ASSERT_EQ(ZX_OK, zx::vmo::create(size, ZX_VMO_NON_RESIZABLE, &vmo));
+        zx::eventpair local, remote;
+        ASSERT_EQ(ZX_OK, zx::eventpair::create(0, &local, &remote));
+        fuchsia_logger_LogSinkConnectBufferRequest req;
+        memset(&req, 0, sizeof(req));
+        req.hdr.ordinal = fuchsia_logger_LogSinkConnectBufferOrdinal;
+        req.buffer = FIDL_HANDLE_PRESENT;
+        req.reader_event = FIDL_HANDLE_PRESENT;
+        zx_handle_t handles[2] = {vmo.release(), remote.release()};
+        ASSERT_EQ(ZX_OK, logger_handle_.write(0, &req, sizeof(req), handles, 2));
+        loop_.RunUntilIdle();
+        reader_event_ = std::move(local);
+        return true;
+    }
+
     bool InitSyslog(const char** tags, size_t ntags) {
         ASSERT_TRUE(socket_);
         fx_logger_config_t config = {.min_severity = FX_LOG_INFO,
@@ -122,6 +144,7 @@ private:
     fbl::unique_ptr<logger::LoggerImpl> logger_;
     zx::channel logger_handle_;
     zx::socket socket_;
+    zx::eventpair reader_event_;
     int pipefd_[2];
 };
 
@@ -235,6 +258,15 @@ bool TestLoggerDiesWithChannelWhenNoConnectCalled(void) {
     END_TEST;
 }
 
+bool TestLoggerRefusesLargeBuffer(void) {
+    BEGIN_TEST;
+    Fixture fixture;
+    ASSERT_TRUE(fixture.CreateLogger());
+    ASSERT_TRUE(fixture.ConnectBufferToLogger(FX_LOG_BUFFER_MAX_SIZE + ZX_PAGE_SIZE));
+    ASSERT_EQ(ZX_ERR_INVALID_ARGS, fixture.error_status());
+    END_TEST;
+}
+
 } // namespace
 
 BEGIN_TEST_CASE(logger_tests)
@@ -246,6 +278,7 @@ RUN_TEST(TestLogWithMultipleTags)
 RUN_TEST(TestLogWhenLoggerHandleDies)
 RUN_TEST(TestLoggerDiesWithSocket)
 RUN_TEST(TestLoggerDiesWithChannelWhenNoConnectCalled)
+RUN_TEST(TestLoggerRefusesLargeBuffer)
 END_TEST_CASE(logger_tests)
 
 int main(int argc, char** argv) {
@@ -6,7 +6,9 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/statfs.h>
 #include <sys/types.h>
 #include <threads.h>
 #include <unistd.h>
@@ -15,12 +17,17 @@
 #include <fbl/unique_fd.h>
 #include <fbl/vector.h>
 #include <lib/fdio/util.h>
+#include <lib/fdio/vfs.h>
 #include <lib/async-loop/cpp/loop.h>
+#include <lib/memfs/cpp/vnode.h>
 #include <lib/memfs/memfs.h>
+#include <lib/zx/channel.h>
 #include <unittest/unittest.h>
 #include <zircon/processargs.h>
 #include <zircon/syscalls.h>
 
+#include <utility>
+
 namespace {
 
 bool TestMemfsNull() {
@@ -168,6 +175,226 @@ bool TestMemfsLimitPages() {
     END_TEST;
 }
 
+bool TestMemfsSparseFile() {
+    BEGIN_TEST;
+
+    constexpr ssize_t kPageSize = static_cast<ssize_t>(PAGE_SIZE);
+    async::Loop loop(&kAsyncLoopConfigNoAttachToThread);
+    ASSERT_EQ(loop.StartThread(), ZX_OK);
+
+    memfs_filesystem_t* vfs;
+    zx_handle_t root;
+    ASSERT_EQ(memfs_create_filesystem(loop.dispatcher(), &vfs, &root), ZX_OK);
+    uint32_t type = PA_FDIO_REMOTE;
+    int raw_root_fd;
+    ASSERT_EQ(fdio_create_fd(&root, &type, 1, &raw_root_fd), ZX_OK);
+    fbl::unique_fd root_fd(raw_root_fd);
+    fbl::unique_fd fd(openat(root_fd.get(), "sparse", O_CREAT | O_RDWR));
+    ASSERT_GE(fd.get(), 0);
+
+    // A file may be much larger than the memory it uses.
+    constexpr off_t kFileSize = 1ll << 32;
+    constexpr off_t kOffset = kFileSize / 2;
+    ASSERT_EQ(ftruncate(fd.get(), kFileSize), 0);
+    struct stat st;
+    ASSERT_EQ(fstat(fd.get(), &st), 0);
+    ASSERT_EQ(st.st_size, kFileSize);
+    ASSERT_EQ(st.st_blocks, 0);
+
+    // Only the pages which are written are committed, and holes read back
+    // as zeroes.
+    uint8_t data[kPageSize];
+    uint8_t zeroes[kPageSize];
+    uint8_t buf[kPageSize];
+    memset(data, 'a', sizeof(data));
+    memset(zeroes, 0, sizeof(zeroes));
+    ASSERT_EQ(pwrite(fd.get(), data, kPageSize, kOffset), kPageSize);
+    ASSERT_EQ(fstat(fd.get(), &st), 0);
+    ASSERT_EQ(st.st_blocks, kPageSize / VNATTR_BLKSIZE);
+    ASSERT_EQ(pread(fd.get(), buf, kPageSize, kOffset - kPageSize), kPageSize);
+    ASSERT_EQ(memcmp(buf, zeroes, kPageSize), 0);
+    ASSERT_EQ(pread(fd.get(), buf, kPageSize, kOffset), kPageSize);
+    ASSERT_EQ(memcmp(buf, data, kPageSize), 0);
+
+    // Writing a whole page of zeroes punches a hole.
+    ASSERT_EQ(pwrite(fd.get(), zeroes, kPageSize, kOffset), kPageSize);
+    ASSERT_EQ(fstat(fd.get(), &st), 0);
+    ASSERT_EQ(st.st_blocks, 0);
+    ASSERT_EQ(pread(fd.get(), buf, kPageSize, kOffset), kPageSize);
+    ASSERT_EQ(memcmp(buf, zeroes, kPageSize), 0);
+
+    // A partial page of zeroes is written like any other data.
+    ASSERT_EQ(pwrite(fd.get(), zeroes, kPageSize / 2, kOffset), kPageSize / 2);
+    ASSERT_EQ(fstat(fd.get(), &st), 0);
+    ASSERT_EQ(st.st_blocks, kPageSize / VNATTR_BLKSIZE);
+
+    // Truncating the file decommits the pages past its new end.
+    ASSERT_EQ(pwrite(fd.get(), data, kPageSize, kOffset + kPageSize), kPageSize);
+    ASSERT_EQ(fstat(fd.get(), &st), 0);
+    ASSERT_EQ(st.st_blocks, 2 * kPageSize / VNATTR_BLKSIZE);
+    ASSERT_EQ(ftruncate(fd.get(), kOffset), 0);
+    ASSERT_EQ(fstat(fd.get(), &st), 0);
+    ASSERT_EQ(st.st_size, kOffset);
+    ASSERT_EQ(st.st_blocks, 0);
+
+    fd.reset();
+    root_fd.reset();
+    sync_completion_t unmounted;
+    memfs_free_filesystem(vfs, &unmounted);
+    ASSERT_EQ(sync_completion_wait(&unmounted, ZX_SEC(3)), ZX_OK);
+
+    END_TEST;
+}
+
+bool TestMemfsMmapLimit() {
+    BEGIN_TEST;
+
+    constexpr size_t kPageSize = static_cast<size_t>(PAGE_SIZE);
+    constexpr size_t kPageLimit = 4;
+    async::Loop loop(&kAsyncLoopConfigNoAttachToThread);
+    ASSERT_EQ(loop.StartThread(), ZX_OK);
+
+    memfs_filesystem_t* vfs;
+    zx_handle_t root;
+    ASSERT_EQ(memfs_create_filesystem_with_page_limit(loop.dispatcher(), kPageLimit,
+                                                      &vfs, &root), ZX_OK);
+    uint32_t type = PA_FDIO_REMOTE;
+    int raw_root_fd;
+    ASSERT_EQ(fdio_create_fd(&root, &type, 1, &raw_root_fd), ZX_OK);
+    fbl::unique_fd root_fd(raw_root_fd);
+    fbl::unique_fd fd(openat(root_fd.get(), "mapped", O_CREAT | O_RDWR));
+    ASSERT_GE(fd.get(), 0);
+
+    // Writable shared mappings could commit every page of the file, so the
+    // whole file must fit within the limit for one to be made.
+    ASSERT_EQ(ftruncate(fd.get(), (kPageLimit + 1) * kPageSize), 0);
+    ASSERT_EQ(mmap(nullptr, (kPageLimit + 1) * kPageSize, PROT_READ | PROT_WRITE,
+                   MAP_SHARED, fd.get(), 0), MAP_FAILED);
+
+    // Private and read-only mappings do not write to the file.
+    void* addr = mmap(nullptr, (kPageLimit + 1) * kPageSize, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE, fd.get(), 0);
+    ASSERT_NE(addr, MAP_FAILED);
+    ASSERT_EQ(munmap(addr, (kPageLimit + 1) * kPageSize), 0);
+    addr = mmap(nullptr, (kPageLimit + 1) * kPageSize, PROT_READ, MAP_SHARED, fd.get(), 0);
+    ASSERT_NE(addr, MAP_FAILED);
+    ASSERT_EQ(munmap(addr, (kPageLimit + 1) * kPageSize), 0);
+
+    // While a mapping of a file which fits is held, the file may not grow,
+    // and nothing else may be written.
+    ASSERT_EQ(ftruncate(fd.get(), kPageLimit * kPageSize), 0);
+    addr = mmap(nullptr, kPageLimit * kPageSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                fd.get(), 0);
+    ASSERT_NE(addr, MAP_FAILED);
+    memset(addr, 'a', kPageLimit * kPageSize);
+    ASSERT_EQ(ftruncate(fd.get(), (kPageLimit + 1) * kPageSize), -1);
+    ASSERT_EQ(errno, ENOSPC);
+    fbl::unique_fd other_fd(openat(root_fd.get(), "other", O_CREAT | O_RDWR));
+    ASSERT_GE(other_fd.get(), 0);
+    char c = 'b';
+    ASSERT_EQ(write(other_fd.get(), &c, 1), -1);
+    ASSERT_EQ(errno, ENOSPC);
+
+    // Once the mapping is gone, the file is only charged for what it uses.
+    ASSERT_EQ(munmap(addr, kPageLimit * kPageSize), 0);
+    ASSERT_EQ(ftruncate(fd.get(), (kPageLimit - 1) * kPageSize), 0);
+    ASSERT_EQ(write(other_fd.get(), &c, 1), 1);
+
+    other_fd.reset();
+    fd.reset();
+    root_fd.reset();
+    sync_completion_t unmounted;
+    memfs_free_filesystem(vfs, &unmounted);
+    ASSERT_EQ(sync_completion_wait(&unmounted, ZX_SEC(3)), ZX_OK);
+
+    END_TEST;
+}
+
+bool TestMemfsSubtreePageLimit() {
+    BEGIN_TEST;
+
+    constexpr ssize_t kPageSize = static_cast<ssize_t>(PAGE_SIZE);
+    async::Loop loop(&kAsyncLoopConfigNoAttachToThread);
+    ASSERT_EQ(loop.StartThread(), ZX_OK);
+
+    memfs::Vfs vfs(8);
+    vfs.SetDispatcher(loop.dispatcher());
+    fbl::RefPtr<memfs::VnodeDir> root;
+    ASSERT_EQ(memfs::CreateFilesystem("<tmp>", &vfs, &root), ZX_OK);
+    fbl::RefPtr<fs::Vnode> vn;
+    ASSERT_EQ(root->Create(&vn, "limited", S_IFDIR), ZX_OK);
+    auto subtree = fbl::RefPtr<memfs::VnodeDir>::Downcast(std::move(vn));
+
+    // Only empty directories can be given a limit.
+    ASSERT_EQ(vfs.SetSubtreePagesLimit(root.get(), 4), ZX_ERR_BAD_STATE);
+    ASSERT_EQ(vfs.SetSubtreePagesLimit(subtree.get(), 2), ZX_OK);
+
+    zx::channel client, server;
+    ASSERT_EQ(zx::channel::create(0, &client, &server), ZX_OK);
+    ASSERT_EQ(vfs.ServeDirectory(root, std::move(server)), ZX_OK);
+    zx_handle_t client_handle = client.release();
+    uint32_t type = PA_FDIO_REMOTE;
+    int raw_root_fd;
+    ASSERT_EQ(fdio_create_fd(&client_handle, &type, 1, &raw_root_fd), ZX_OK);
+    fbl::unique_fd root_fd(raw_root_fd);
+
+    uint8_t data[kPageSize * 2];
+    memset(data, 'a', sizeof(data));
+
+    // Files within the subtree are bound by its limit.
+    fbl::unique_fd fd(openat(root_fd.get(), "limited/a", O_CREAT | O_RDWR));
+    ASSERT_GE(fd.get(), 0);
+    ASSERT_EQ(write(fd.get(), data, kPageSize * 2), kPageSize * 2);
+    errno = 0;
+    ASSERT_EQ(write(fd.get(), data, 1), -1);
+    ASSERT_EQ(errno, ENOSPC);
+    ASSERT_EQ(subtree->NumAllocatedPages(), 2u);
+    ASSERT_EQ(vfs.NumAllocatedPages(), 2u);
+
+    // The subtree reports its own capacity and usage.
+    fbl::unique_fd dir_fd(openat(root_fd.get(), "limited", O_DIRECTORY | O_RDONLY));
+    ASSERT_GE(dir_fd.get(), 0);
+    struct statfs stats;
+    ASSERT_EQ(fstatfs(dir_fd.get(), &stats), 0);
+    ASSERT_EQ(stats.f_blocks, 2u);
+    ASSERT_EQ(stats.f_bfree, 0u);
+
+    // Files outside it may use the rest of the filesystem, but can't be
+    // moved into it.
+    fbl::unique_fd other_fd(openat(root_fd.get(), "b", O_CREAT | O_RDWR));
+    ASSERT_GE(other_fd.get(), 0);
+    ASSERT_EQ(write(other_fd.get(), data, kPageSize * 2), kPageSize * 2);
+    ASSERT_EQ(subtree->NumAllocatedPages(), 2u);
+    ASSERT_EQ(vfs.NumAllocatedPages(), 4u);
+    errno = 0;
+    ASSERT_EQ(renameat(root_fd.get(), "b", root_fd.get(), "limited/b"), -1);
+    ASSERT_EQ(errno, ENOTSUP);
+
+    // The limit may be raised once the subtree has contents.
+    ASSERT_EQ(vfs.SetSubtreePagesLimit(subtree.get(), 3), ZX_OK);
+    ASSERT_EQ(write(fd.get(), data, kPageSize), kPageSize);
+    ASSERT_EQ(subtree->NumAllocatedPages(), 3u);
+    ASSERT_EQ(vfs.NumAllocatedPages(), 5u);
+
+    // Truncating a file returns its pages to every subtree containing it.
+    ASSERT_EQ(ftruncate(fd.get(), 0), 0);
+    ASSERT_EQ(subtree->NumAllocatedPages(), 0u);
+    ASSERT_EQ(vfs.NumAllocatedPages(), 2u);
+
+    fd.reset();
+    dir_fd.reset();
+    other_fd.reset();
+    root_fd.reset();
+    sync_completion_t unmounted;
+    vfs.Shutdown([&unmounted](zx_status_t status) {
+        sync_completion_signal(&unmounted);
+    });
+    ASSERT_EQ(sync_completion_wait(&unmounted, ZX_SEC(3)), ZX_OK);
+    loop.Shutdown();
+
+    END_TEST;
+}
+
 bool TestMemfsInstall() {
     BEGIN_TEST;
 
@@ -282,6 +509,9 @@ BEGIN_TEST_CASE(memfs_tests)
 RUN_TEST(TestMemfsNull)
 RUN_TEST(TestMemfsBasic)
 RUN_TEST(TestMemfsLimitPages)
+RUN_TEST(TestMemfsSparseFile)
+RUN_TEST(TestMemfsMmapLimit)
+RUN_TEST(TestMemfsSubtreePageLimit)
 RUN_TEST(TestMemfsInstall)
 RUN_TEST(TestMemfsCloseDuringAccess)
 END_TEST_CASE(memfs_tests)
@@ -27,6 +27,7 @@ MODULE_STATIC_LIBS := \
     system/ulib/async \
     system/ulib/async-loop.cpp \
     system/ulib/async-loop \
+    system/ulib/bitmap \
     system/ulib/sync \
     system/ulib/fs \
     system/ulib/memfs.cpp \
@@ -0,0 +1,85 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <threads.h>
+
+#include <cobalt-client/cpp/counter.h>
+#include <cobalt-client/cpp/histogram.h>
+#include <cobalt-client/cpp/metric-options.h>
+#include <fbl/string_printf.h>
+#include <fbl/vector.h>
+#include <perftest/perftest.h>
+
+namespace {
+
+constexpr size_t kUpdatesPerThread = 10000;
+constexpr uint32_t kBuckets = 20;
+
+int IncrementThread(void* arg) {
+    auto* counter = static_cast<cobalt_client::Counter*>(arg);
+    for (size_t i = 0; i < kUpdatesPerThread; i++) {
+        counter->Increment();
+    }
+    return 0;
+}
+
+int AddThread(void* arg) {
+    auto* histogram = static_cast<cobalt_client::Histogram<kBuckets>*>(arg);
+    for (size_t i = 0; i < kUpdatesPerThread; i++) {
+        // Latencies, in nanoseconds, spread over several buckets.
+        histogram->Add(1000 * (i % 64));
+    }
+    return 0;
+}
+
+// Runs |num_threads| threads calling |fn| on |metric|, once per iteration.
+void RunThreads(perftest::RepeatState* state, uint32_t num_threads, thrd_start_t fn,
+                void* metric) {
+    fbl::Vector<thrd_t> threads;
+    for (uint32_t i = 0; i < num_threads; i++) {
+        threads.push_back(thrd_t{});
+    }
+    while (state->KeepRunning()) {
+        for (thrd_t& thread : threads) {
+            ZX_ASSERT(thrd_create(&thread, fn, metric) == thrd_success);
+        }
+        for (thrd_t thread : threads) {
+            ZX_ASSERT(thrd_join(thread, nullptr) == thrd_success);
+        }
+    }
+}
+
+// Measure the time taken for |num_threads| threads to each increment the
+// same counter |kUpdatesPerThread| times, as filesystems do on their I/O
+// paths.
+bool CounterIncrementTest(perftest::RepeatState* state, uint32_t num_threads) {
+    cobalt_client::MetricOptions options;
+    options.SetMode(cobalt_client::MetricOptions::Mode::kRemote);
+    options.metric_id = 1;
+    cobalt_client::Counter counter(options);
+    RunThreads(state, num_threads, IncrementThread, &counter);
+    return true;
+}
+
+// The same, for adding values to a histogram.
+bool HistogramAddTest(perftest::RepeatState* state, uint32_t num_threads) {
+    auto options = cobalt_client::HistogramOptions::Exponential(kBuckets, 1000 * 64);
+    options.SetMode(cobalt_client::MetricOptions::Mode::kRemote);
+    options.metric_id = 1;
+    cobalt_client::Histogram<kBuckets> histogram(options);
+    RunThreads(state, num_threads, AddThread, &histogram);
+    return true;
+}
+
+void RegisterTests() {
+    for (uint32_t num_threads : {1, 2, 4, 8}) {
+        auto name = fbl::StringPrintf("CobaltClient/Counter/Increment/%uThreads", num_threads);
+        perftest::RegisterTest(name.c_str(), CounterIncrementTest, num_threads);
+        name = fbl::StringPrintf("CobaltClient/Histogram/Add/%uThreads", num_threads);
+        perftest::RegisterTest(name.c_str(), HistogramAddTest, num_threads);
+    }
+}
+PERFTEST_CTOR(RegisterTests);
+
+}  // namespace
@@ -0,0 +1,111 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <lib/fidl/cpp/message_buffer.h>
+#include <lib/fidl/internal.h>
+#include <lib/fidl/llcpp/buffer_pool.h>
+#include <lib/fidl/llcpp/coding.h>
+#include <lib/zx/channel.h>
+#include <perftest/perftest.h>
+#include <zircon/assert.h>
+
+#include <utility>
+
+namespace {
+
+// A message shaped like the llcpp codegen output, with a payload of
+// |kPayloadSize| bytes and nothing out of line.
+constexpr uint32_t kPayloadSize = 64;
+
+extern const fidl_type_t PayloadMessageType;
+
+struct PayloadMessage {
+    alignas(FIDL_ALIGNMENT) fidl_message_header_t header;
+    uint8_t payload[kPayloadSize];
+
+    static constexpr uint32_t MaxNumHandles = 0;
+    static constexpr uint32_t PrimarySize =
+        FIDL_ALIGN(sizeof(fidl_message_header_t)) + FIDL_ALIGN(kPayloadSize);
+    [[maybe_unused]] static constexpr uint32_t MaxOutOfLine = 0;
+    static constexpr const fidl_type_t* Type = &PayloadMessageType;
+};
+
+const fidl_type_t PayloadMessageType = fidl_type_t(fidl::FidlCodedStruct(
+    nullptr, /* field_count */ 0, sizeof(PayloadMessage), "PayloadMessage"));
+
+} // namespace
+
+namespace fidl {
+
+template <>
+struct IsFidlType<PayloadMessage> : public std::true_type {};
+
+template <>
+struct IsFidlMessage<PayloadMessage> : public std::true_type {};
+
+} // namespace fidl
+
+namespace {
+
+// These tests measure the time taken to receive and decode a message on a
+// channel with the low-level C++ bindings, where the receive buffer comes
+// either from a new fidl::MessageBuffer per message, as servers commonly
+// do, or from a fidl::BufferPool owned by the connection. The inverse of
+// the time per run is the number of messages per second.
+//
+// A MessageBuffer makes one heap allocation per message. The pool makes
+// none once it has grown to the connection's needs, which the pool test
+// checks.
+
+void WriteMessage(const zx::channel& channel) {
+    PayloadMessage message = {};
+    message.header.ordinal = 1;
+    ZX_ASSERT(channel.write(0, &message, sizeof(message), nullptr, 0) == ZX_OK);
+}
+
+void DecodeMessage(fidl::EncodeResult<PayloadMessage> read_result) {
+    ZX_ASSERT(read_result.status == ZX_OK);
+    auto decode_result = fidl::Decode(std::move(read_result.message));
+    ZX_ASSERT(decode_result.status == ZX_OK);
+    ZX_ASSERT(decode_result.message.message()->header.ordinal == 1);
+}
+
+bool ReceiveMessageBufferTest(perftest::RepeatState* state) {
+    state->SetBytesProcessedPerRun(sizeof(PayloadMessage));
+    zx::channel client, server;
+    ZX_ASSERT(zx::channel::create(0, &client, &server) == ZX_OK);
+
+    while (state->KeepRunning()) {
+        WriteMessage(client);
+        fidl::MessageBuffer buffer;
+        DecodeMessage(fidl::Read<PayloadMessage>(
+            server, fidl::BytePart(buffer.bytes(), buffer.bytes_capacity())));
+    }
+    return true;
+}
+
+bool ReceiveBufferPoolTest(perftest::RepeatState* state) {
+    state->SetBytesProcessedPerRun(sizeof(PayloadMessage));
+    zx::channel client, server;
+    ZX_ASSERT(zx::channel::create(0, &client, &server) == ZX_OK);
+
+    fidl::BufferPool pool;
+    size_t slab_count = pool.slab_count();
+    while (state->KeepRunning()) {
+        WriteMessage(client);
+        fidl::BufferPool::Buffer buffer = pool.Acquire();
+        DecodeMessage(fidl::Read<PayloadMessage>(server, buffer.view()));
+    }
+    // No allocations per message.
+    ZX_ASSERT(pool.slab_count() == slab_count);
+    return true;
+}
+
+void RegisterTests() {
+    perftest::RegisterTest("FidlLlcpp/Receive/MessageBuffer", ReceiveMessageBufferTest);
+    perftest::RegisterTest("FidlLlcpp/Receive/BufferPool", ReceiveBufferPoolTest);
+}
+PERFTEST_CTOR(RegisterTests);
+
+} // namespace
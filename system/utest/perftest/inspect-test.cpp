@@ -0,0 +1,62 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <threads.h>
+
+#include <fbl/string_printf.h>
+#include <fbl/vector.h>
+#include <lib/inspect/inspect.h>
+#include <perftest/perftest.h>
+
+namespace {
+
+constexpr size_t kAddsPerThread = 10000;
+
+int AddThread(void* arg) {
+    auto* metric = static_cast<inspect::UintMetric*>(arg);
+    for (size_t i = 0; i < kAddsPerThread; i++) {
+        metric->Add(1);
+    }
+    return 0;
+}
+
+// Measure the time taken for |num_threads| threads to each add to an
+// Inspect metric |kAddsPerThread| times. If |shared| is true, every thread
+// adds to the same metric, otherwise each has its own, although all the
+// metrics are in the same VMO.
+bool MetricAddTest(perftest::RepeatState* state, uint32_t num_threads, bool shared) {
+    inspect::Inspector inspector;
+    fbl::Vector<inspect::UintMetric> metrics;
+    for (uint32_t i = 0; i < (shared ? 1 : num_threads); i++) {
+        metrics.push_back(inspector.GetRootObject().CreateUintMetric("metric", 0));
+    }
+
+    fbl::Vector<thrd_t> threads;
+    for (uint32_t i = 0; i < num_threads; i++) {
+        threads.push_back(thrd_t{});
+    }
+    while (state->KeepRunning()) {
+        for (uint32_t i = 0; i < num_threads; i++) {
+            ZX_ASSERT(thrd_create(&threads[i], AddThread, &metrics[shared ? 0 : i]) ==
+                      thrd_success);
+        }
+        for (thrd_t thread : threads) {
+            ZX_ASSERT(thrd_join(thread, nullptr) == thrd_success);
+        }
+    }
+    return true;
+}
+
+void RegisterTests() {
+    for (uint32_t num_threads : {1, 2, 4, 8}) {
+        for (bool shared : {true, false}) {
+            auto name = fbl::StringPrintf("Inspect/MetricAdd/%uThreads/%s", num_threads,
+                                          shared ? "Shared" : "PerThread");
+            perftest::RegisterTest(name.c_str(), MetricAddTest, num_threads, shared);
+        }
+    }
+}
+PERFTEST_CTOR(RegisterTests);
+
+}  // namespace
@@ -10,7 +10,10 @@ MODULE_TYPE := usertest
 
 MODULE_SRCS += \
     $(LOCAL_DIR)/clock-test.cpp \
+    $(LOCAL_DIR)/cobalt-client-test.cpp \
+    $(LOCAL_DIR)/fidl-llcpp-test.cpp \
     $(LOCAL_DIR)/handle-creation-test.cpp \
+    $(LOCAL_DIR)/inspect-test.cpp \
     $(LOCAL_DIR)/malloc-test.cpp \
     $(LOCAL_DIR)/memcpy-test.cpp \
     $(LOCAL_DIR)/mutex-test.cpp \
@@ -20,6 +23,7 @@ MODULE_SRCS += \
     $(LOCAL_DIR)/runner-test.cpp \
     $(LOCAL_DIR)/sleep-test.cpp \
     $(LOCAL_DIR)/syscalls-test.cpp \
+    $(LOCAL_DIR)/syslog-test.cpp \
     $(LOCAL_DIR)/timer-test.cpp \
 
 MODULE_NAME := perf-test
@@ -29,7 +33,12 @@ MODULE_STATIC_LIBS := \
     system/ulib/async-loop \
     system/ulib/async-loop.cpp \
     system/ulib/async.cpp \
+    system/ulib/cobalt-client \
     system/ulib/fbl \
+    system/ulib/fidl \
+    system/ulib/fidl-async \
+    system/ulib/fzl \
+    system/ulib/inspect \
     system/ulib/perftest \
     system/ulib/trace \
     system/ulib/trace-provider \
@@ -41,8 +50,13 @@ MODULE_LIBS := \
     system/ulib/c \
     system/ulib/fdio \
     system/ulib/launchpad \
+    system/ulib/syslog \
     system/ulib/trace-engine \
     system/ulib/unittest \
     system/ulib/zircon \
 
+MODULE_FIDL_LIBS := \
+    system/fidl/fuchsia-cobalt \
+    system/fidl/fuchsia-mem \
+
 include make/module.mk
@@ -0,0 +1,134 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <threads.h>
+
+#include <lib/syslog/log_buffer.h>
+#include <lib/syslog/logger.h>
+#include <lib/syslog/wire_format.h>
+#include <lib/zx/eventpair.h>
+#include <lib/zx/socket.h>
+#include <lib/zx/vmar.h>
+#include <lib/zx/vmo.h>
+#include <perftest/perftest.h>
+
+namespace {
+
+constexpr size_t kBufferSize = 64 * 1024;
+
+// Reads log records from the service end of a socket until the logger
+// closes it.
+int SocketReaderThread(void* arg) {
+    auto* socket = static_cast<zx::socket*>(arg);
+    fx_log_packet_t packet;
+    for (;;) {
+        zx_status_t status = socket->read(0, &packet, sizeof(packet), nullptr);
+        if (status == ZX_ERR_SHOULD_WAIT) {
+            zx_signals_t pending;
+            socket->wait_one(ZX_SOCKET_READABLE | ZX_SOCKET_PEER_CLOSED,
+                             zx::time::infinite(), &pending);
+            continue;
+        }
+        if (status != ZX_OK) {
+            return 0;
+        }
+    }
+}
+
+struct BufferReader {
+    uintptr_t buffer;
+    zx::eventpair event;
+};
+
+void IgnorePacket(const fx_log_packet_t* packet, size_t packet_size, void* ctx) {}
+
+// Drains a shared log buffer, sleeping while it's empty, until the logger
+// closes its end of the eventpair.
+int BufferReaderThread(void* arg) {
+    auto* reader = static_cast<BufferReader*>(arg);
+    void* buffer = reinterpret_cast<void*>(reader->buffer);
+    for (;;) {
+        fx_log_buffer_drain(buffer, kBufferSize, IgnorePacket, nullptr);
+        if (!fx_log_buffer_arm(buffer, kBufferSize)) {
+            continue;
+        }
+        zx_signals_t pending;
+        reader->event.wait_one(ZX_USER_SIGNAL_0 | ZX_EVENTPAIR_PEER_CLOSED,
+                               zx::time::infinite(), &pending);
+        reader->event.signal(ZX_USER_SIGNAL_0, 0);
+        if (pending & ZX_EVENTPAIR_PEER_CLOSED) {
+            fx_log_buffer_drain(buffer, kBufferSize, IgnorePacket, nullptr);
+            return 0;
+        }
+    }
+}
+
+fx_logger_config_t MakeConfig() {
+    static const char* kTags[] = {"perftest"};
+    return fx_logger_config_t{.min_severity = FX_LOG_INFO,
+                              .console_fd = -1,
+                              .log_service_channel = ZX_HANDLE_INVALID,
+                              .tags = kTags,
+                              .num_tags = 1};
+}
+
+void LogMessages(perftest::RepeatState* state, fx_logger_t* logger) {
+    while (state->KeepRunning()) {
+        fx_logger_log(logger, FX_LOG_INFO, nullptr, "a typical log message of moderate length");
+    }
+}
+
+// Measure the time taken to write a log record to a socket, as the log
+// service reads it on another thread. Records are dropped when the socket
+// is full.
+bool SocketLogTest(perftest::RepeatState* state) {
+    zx::socket local, remote;
+    ZX_ASSERT(zx::socket::create(ZX_SOCKET_DATAGRAM, &local, &remote) == ZX_OK);
+    fx_logger_config_t config = MakeConfig();
+    config.log_service_channel = local.release();
+    fx_logger_t* logger;
+    ZX_ASSERT(fx_logger_create(&config, &logger) == ZX_OK);
+
+    thrd_t reader;
+    ZX_ASSERT(thrd_create(&reader, SocketReaderThread, &remote) == thrd_success);
+    LogMessages(state, logger);
+    fx_logger_destroy(logger);
+    ZX_ASSERT(thrd_join(reader, nullptr) == thrd_success);
+    return true;
+}
+
+// The same, writing to a shared log buffer instead. Records are dropped
+// when the buffer is full.
+bool BufferLogTest(perftest::RepeatState* state) {
+    zx::vmo vmo;
+    ZX_ASSERT(zx::vmo::create(kBufferSize, ZX_VMO_NON_RESIZABLE, &vmo) == ZX_OK);
+    BufferReader reader_state;
+    ZX_ASSERT(zx::vmar::root_self()->map(0, vmo, 0, kBufferSize,
+                                         ZX_VM_PERM_READ | ZX_VM_PERM_WRITE,
+                                         &reader_state.buffer) == ZX_OK);
+    ZX_ASSERT(fx_log_buffer_init(reinterpret_cast<void*>(reader_state.buffer),
+                                 kBufferSize) == ZX_OK);
+    zx::eventpair writer_event;
+    ZX_ASSERT(zx::eventpair::create(0, &reader_state.event, &writer_event) == ZX_OK);
+    fx_logger_config_t config = MakeConfig();
+    fx_logger_t* logger;
+    ZX_ASSERT(fx_logger_create_with_buffer(&config, vmo.release(), writer_event.release(),
+                                           &logger) == ZX_OK);
+
+    thrd_t reader;
+    ZX_ASSERT(thrd_create(&reader, BufferReaderThread, &reader_state) == thrd_success);
+    LogMessages(state, logger);
+    fx_logger_destroy(logger);
+    ZX_ASSERT(thrd_join(reader, nullptr) == thrd_success);
+    zx::vmar::root_self()->unmap(reader_state.buffer, kBufferSize);
+    return true;
+}
+
+void RegisterTests() {
+    perftest::RegisterTest("Syslog/Log/Socket", SocketLogTest);
+    perftest::RegisterTest("Syslog/Log/Buffer", BufferLogTest);
+}
+PERFTEST_CTOR(RegisterTests);
+
+}  // namespace
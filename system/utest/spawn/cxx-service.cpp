@@ -0,0 +1,29 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <fbl/string.h>
+#include <fbl/vector.h>
+#include <lib/async-loop/cpp/loop.h>
+#include <lib/async/cpp/task.h>
+#include <lib/zx/channel.h>
+
+// Starts up the way a typical C++ service does, then exits at once. Used by
+// spawn-bench to measure launching such a binary.
+int main(int argc, char** argv) {
+    async::Loop loop(&kAsyncLoopConfigAttachToThread);
+
+    fbl::Vector<fbl::String> args;
+    for (int i = 0; i < argc; ++i) {
+        args.push_back(fbl::String(argv[i]));
+    }
+
+    zx::channel client, server;
+    if (zx::channel::create(0, &client, &server) != ZX_OK) {
+        return 1;
+    }
+
+    async::PostTask(loop.dispatcher(), [&loop] { loop.Quit(); });
+    loop.Run();
+    return args.is_empty() ? 1 : 0;
+}
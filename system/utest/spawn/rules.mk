@@ -17,17 +17,66 @@ MODULE_NAME := spawn-test
 MODULE_SRCS := \
     $(LOCAL_DIR)/spawn.cpp \
 
+MODULE_FIDL_LIBS := \
+    system/fidl/fuchsia-io \
+    system/fidl/fuchsia-mem \
+    system/fidl/fuchsia-process \
+
 MODULE_STATIC_LIBS := \
     system/ulib/zx \
 
 MODULE_LIBS := \
     system/ulib/fdio \
+    system/ulib/launchpad \
     system/ulib/unittest \
     system/ulib/c \
     system/ulib/zircon \
 
 include make/module.mk
 
+#
+# spawn-bench
+#
+
+MODULE := $(LOCAL_DIR).bench
+
+MODULE_TYPE := usertest
+
+MODULE_NAME := spawn-bench
+
+MODULE_SRCS := \
+    $(LOCAL_DIR)/spawn-bench.cpp \
+
+MODULE_STATIC_LIBS := \
+    system/ulib/async \
+    system/ulib/async-loop \
+    system/ulib/async-loop.cpp \
+    system/ulib/async.cpp \
+    system/ulib/fbl \
+    system/ulib/fidl \
+    system/ulib/ldmsg \
+    system/ulib/loader-service \
+    system/ulib/perftest \
+    system/ulib/trace \
+    system/ulib/trace-provider \
+    system/ulib/zx \
+    system/ulib/zxcpp \
+
+MODULE_LIBS := \
+    system/ulib/async.default \
+    system/ulib/c \
+    system/ulib/fdio \
+    system/ulib/launchpad \
+    system/ulib/trace-engine \
+    system/ulib/unittest \
+    system/ulib/zircon \
+
+MODULE_FIDL_LIBS := \
+    system/fidl/fuchsia-io \
+    system/fidl/fuchsia-mem \
+
+include make/module.mk
+
 #
 # spawn-child
 #
@@ -49,6 +98,37 @@ MODULE_LIBS := \
 
 include make/module.mk
 
+#
+# spawn-cxx-service
+#
+
+MODULE := $(LOCAL_DIR).cxx-service
+
+MODULE_TYPE := userapp
+MODULE_GROUP := test
+
+MODULE_NAME := spawn-cxx-service
+
+MODULE_SRCS := \
+    $(LOCAL_DIR)/cxx-service.cpp \
+
+MODULE_STATIC_LIBS := \
+    system/ulib/async \
+    system/ulib/async-loop \
+    system/ulib/async-loop.cpp \
+    system/ulib/async.cpp \
+    system/ulib/fbl \
+    system/ulib/zx \
+    system/ulib/zxcpp \
+
+MODULE_LIBS := \
+    system/ulib/async.default \
+    system/ulib/c \
+    system/ulib/fdio \
+    system/ulib/zircon \
+
+include make/module.mk
+
 #
 # spawn-launcher
 #
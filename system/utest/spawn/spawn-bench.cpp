@@ -0,0 +1,114 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <launchpad/launchpad.h>
+#include <launchpad/vmo.h>
+#include <lib/fdio/spawn.h>
+#include <lib/zx/process.h>
+#include <loader-service/loader-service.h>
+#include <perftest/perftest.h>
+#include <zircon/assert.h>
+#include <zircon/processargs.h>
+#include <zircon/syscalls.h>
+
+namespace {
+
+constexpr char kSpawnChild[] = "/boot/bin/spawn-child";
+constexpr char kCxxService[] = "/boot/bin/spawn-cxx-service";
+
+// Measures launching a process which exits as soon as it starts, with its
+// libraries served by a loader service of our own rather than the system's,
+// so that the loader service's cache can be turned on and off. The number of
+// processes started per second is the reciprocal of the time per iteration.
+bool SpawnTest(perftest::RepeatState* state, bool cache_enabled) {
+    state->DeclareStep("spawn");
+    state->DeclareStep("wait");
+
+    loader_service_t* svc;
+    ZX_ASSERT(loader_service_create_fs(nullptr, &svc) == ZX_OK);
+    ZX_ASSERT(loader_service_set_cache_enabled(svc, cache_enabled) == ZX_OK);
+
+    const char* argv[] = {kSpawnChild, nullptr};
+    while (state->KeepRunning()) {
+        zx_handle_t ldsvc;
+        ZX_ASSERT(loader_service_connect(svc, &ldsvc) == ZX_OK);
+        fdio_spawn_action_t action;
+        action.action = FDIO_SPAWN_ACTION_ADD_HANDLE;
+        action.h.id = PA_LDSVC_LOADER;
+        action.h.handle = ldsvc;
+        zx::process process;
+        ZX_ASSERT(fdio_spawn_etc(ZX_HANDLE_INVALID,
+                                 FDIO_SPAWN_CLONE_ALL & ~FDIO_SPAWN_DEFAULT_LDSVC, kSpawnChild,
+                                 argv, nullptr, 1, &action, process.reset_and_get_address(),
+                                 nullptr) == ZX_OK);
+        state->NextStep();
+
+        ZX_ASSERT(process.wait_one(ZX_TASK_TERMINATED, zx::time::infinite(), nullptr) == ZX_OK);
+        zx_info_process_t info;
+        ZX_ASSERT(process.get_info(ZX_INFO_PROCESS, &info, sizeof(info), nullptr,
+                                   nullptr) == ZX_OK);
+        ZX_ASSERT(info.return_code == 43);
+    }
+
+    loader_service_release(svc);
+    return true;
+}
+
+// Measures launching a small C++ service binary, either loading it from its
+// VMO each time, or from a launchpad template holding its parsed headers and
+// its dynamic linker.
+bool LaunchTest(perftest::RepeatState* state, bool use_template) {
+    state->DeclareStep("launch");
+    state->DeclareStep("wait");
+
+    zx_handle_t vmo;
+    ZX_ASSERT(launchpad_vmo_from_file(kCxxService, &vmo) == ZX_OK);
+    launchpad_template_t* tmpl = nullptr;
+    if (use_template) {
+        ZX_ASSERT(launchpad_template_create(vmo, ZX_HANDLE_INVALID, &tmpl) == ZX_OK);
+        vmo = ZX_HANDLE_INVALID;
+    }
+
+    const char* argv[] = {kCxxService};
+    while (state->KeepRunning()) {
+        launchpad_t* lp;
+        launchpad_create(ZX_HANDLE_INVALID, kCxxService, &lp);
+        if (use_template) {
+            launchpad_load_from_template(lp, tmpl);
+        } else {
+            zx_handle_t executable;
+            ZX_ASSERT(zx_handle_duplicate(vmo, ZX_RIGHT_SAME_RIGHTS, &executable) == ZX_OK);
+            launchpad_load_from_vmo(lp, executable);
+        }
+        launchpad_set_args(lp, 1, argv);
+        launchpad_clone(lp, LP_CLONE_ALL);
+        zx::process process;
+        ZX_ASSERT(launchpad_go(lp, process.reset_and_get_address(), nullptr) == ZX_OK);
+        state->NextStep();
+
+        ZX_ASSERT(process.wait_one(ZX_TASK_TERMINATED, zx::time::infinite(), nullptr) == ZX_OK);
+        zx_info_process_t info;
+        ZX_ASSERT(process.get_info(ZX_INFO_PROCESS, &info, sizeof(info), nullptr,
+                                   nullptr) == ZX_OK);
+        ZX_ASSERT(info.return_code == 0);
+    }
+
+    launchpad_template_destroy(tmpl);
+    zx_handle_close(vmo);
+    return true;
+}
+
+void RegisterTests() {
+    perftest::RegisterTest("Spawn/Uncached", SpawnTest, false);
+    perftest::RegisterTest("Spawn/Cached", SpawnTest, true);
+    perftest::RegisterTest("Launch/CxxService/FromVmo", LaunchTest, false);
+    perftest::RegisterTest("Launch/CxxService/FromTemplate", LaunchTest, true);
+}
+PERFTEST_CTOR(RegisterTests);
+
+} // namespace
+
+int main(int argc, char** argv) {
+    return perftest::PerfTestMain(argc, argv, "fuchsia.zircon.spawn");
+}
@@ -5,6 +5,8 @@
 #include <unittest/unittest.h>
 
 #include <fcntl.h>
+#include <fuchsia/process/c/fidl.h>
+#include <launchpad/launchpad.h>
 #include <lib/fdio/io.h>
 #include <lib/fdio/spawn.h>
 #include <lib/fdio/util.h>
@@ -12,12 +14,17 @@
 #include <lib/zx/job.h>
 #include <lib/zx/process.h>
 #include <lib/zx/socket.h>
+#include <lib/zx/vmo.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
+#include <zircon/dlfcn.h>
 #include <zircon/limits.h>
 #include <zircon/processargs.h>
 #include <zircon/syscalls/policy.h>
 
+#include <utility>
+
 static constexpr char kSpawnChild[] = "/boot/bin/spawn-child";
 static constexpr char kSpawnLauncher[] = "/boot/bin/spawn-launcher";
 
@@ -600,6 +607,203 @@ static bool spawn_vmo_test(void) {
     END_TEST;
 }
 
+// The launcher replies to nothing but Launch, CreateWithoutStarting,
+// CreateTemplate and LaunchFromTemplate, so these send the other messages
+// without waiting.
+static zx_status_t launcher_add_args(const zx::channel& launcher, const char* const* argv) {
+    size_t count = 0;
+    size_t len = 0;
+    for (; argv[count] != nullptr; ++count)
+        len += FIDL_ALIGN(strlen(argv[count]));
+
+    struct {
+        FIDL_ALIGNDECL
+        fidl_message_header_t hdr;
+        fidl_vector_t vector;
+        fidl_string_t strings[8];
+        char data[256];
+    } msg;
+    if (count > sizeof(msg.strings) / sizeof(msg.strings[0]) || len > sizeof(msg.data))
+        return ZX_ERR_INVALID_ARGS;
+    memset(&msg, 0, sizeof(msg));
+
+    msg.hdr.ordinal = fuchsia_process_LauncherAddArgsOrdinal;
+    msg.vector.count = count;
+    msg.vector.data = reinterpret_cast<void*>(FIDL_ALLOC_PRESENT);
+    char* payload = reinterpret_cast<char*>(&msg.strings[count]);
+    for (size_t i = 0; i < count; ++i) {
+        size_t size = strlen(argv[i]);
+        msg.strings[i].size = size;
+        msg.strings[i].data = reinterpret_cast<char*>(FIDL_ALLOC_PRESENT);
+        memcpy(payload, argv[i], size);
+        payload += FIDL_ALIGN(size);
+    }
+    uint32_t msg_len = static_cast<uint32_t>(payload - reinterpret_cast<char*>(&msg));
+    return launcher.write(0, &msg, msg_len, nullptr, 0);
+}
+
+static zx_status_t launcher_add_loader(const zx::channel& launcher) {
+    zx_handle_t ldsvc;
+    zx_status_t status = dl_clone_loader_service(&ldsvc);
+    if (status != ZX_OK)
+        return status;
+
+    struct {
+        FIDL_ALIGNDECL
+        fuchsia_process_LauncherAddHandlesRequest req;
+        fuchsia_process_HandleInfo handles[1];
+    } msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.req.hdr.ordinal = fuchsia_process_LauncherAddHandlesOrdinal;
+    msg.req.handles.count = 1;
+    msg.req.handles.data = reinterpret_cast<void*>(FIDL_ALLOC_PRESENT);
+    msg.handles[0].handle = FIDL_HANDLE_PRESENT;
+    msg.handles[0].id = PA_LDSVC_LOADER;
+    return launcher.write(0, &msg, sizeof(msg), &ldsvc, 1);
+}
+
+static zx_status_t launcher_create_template(const zx::channel& launcher, zx::vmo executable,
+                                            uint64_t* id) {
+    fuchsia_process_LauncherCreateTemplateRequest req;
+    memset(&req, 0, sizeof(req));
+    req.hdr.ordinal = fuchsia_process_LauncherCreateTemplateOrdinal;
+    req.executable = FIDL_HANDLE_PRESENT;
+    zx_handle_t handle = executable.release();
+
+    fuchsia_process_LauncherCreateTemplateResponse rsp;
+    memset(&rsp, 0, sizeof(rsp));
+
+    zx_channel_call_args_t args = {};
+    args.wr_bytes = &req;
+    args.wr_handles = &handle;
+    args.rd_bytes = &rsp;
+    args.wr_num_bytes = sizeof(req);
+    args.wr_num_handles = 1;
+    args.rd_num_bytes = sizeof(rsp);
+    uint32_t actual_bytes = 0;
+    uint32_t actual_handles = 0;
+    zx_status_t status = launcher.call(0, zx::time::infinite(), &args,
+                                       &actual_bytes, &actual_handles);
+    if (status != ZX_OK)
+        return status;
+    *id = rsp.id;
+    return rsp.status;
+}
+
+static zx_status_t launcher_launch_from_template(const zx::channel& launcher, uint64_t id,
+                                                 zx::process* process) {
+    static constexpr char kName[] = "spawn-template-child";
+
+    struct {
+        FIDL_ALIGNDECL
+        fuchsia_process_LauncherLaunchFromTemplateRequest req;
+        char name[FIDL_ALIGN(sizeof(kName) - 1)];
+    } msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.req.hdr.ordinal = fuchsia_process_LauncherLaunchFromTemplateOrdinal;
+    msg.req.id = id;
+    msg.req.job = FIDL_HANDLE_PRESENT;
+    msg.req.name.size = sizeof(kName) - 1;
+    msg.req.name.data = reinterpret_cast<char*>(FIDL_ALLOC_PRESENT);
+    memcpy(msg.name, kName, sizeof(kName) - 1);
+
+    zx::job job;
+    zx_status_t status = zx::job::default_job()->duplicate(ZX_RIGHT_SAME_RIGHTS, &job);
+    if (status != ZX_OK)
+        return status;
+    zx_handle_t handle = job.release();
+
+    struct {
+        FIDL_ALIGNDECL
+        fuchsia_process_LauncherLaunchFromTemplateResponse rsp;
+        char err_msg[1024];
+    } reply;
+    memset(&reply, 0, sizeof(reply));
+
+    zx_channel_call_args_t args = {};
+    args.wr_bytes = &msg;
+    args.wr_handles = &handle;
+    args.rd_bytes = &reply;
+    args.rd_handles = process->reset_and_get_address();
+    args.wr_num_bytes = sizeof(msg);
+    args.wr_num_handles = 1;
+    args.rd_num_bytes = sizeof(reply);
+    args.rd_num_handles = 1;
+    uint32_t actual_bytes = 0;
+    uint32_t actual_handles = 0;
+    status = launcher.call(0, zx::time::infinite(), &args, &actual_bytes, &actual_handles);
+    if (status != ZX_OK)
+        return status;
+    return reply.rsp.result.status;
+}
+
+static zx_status_t launcher_release_template(const zx::channel& launcher, uint64_t id) {
+    fuchsia_process_LauncherReleaseTemplateRequest req;
+    memset(&req, 0, sizeof(req));
+    req.hdr.ordinal = fuchsia_process_LauncherReleaseTemplateOrdinal;
+    req.id = id;
+    return launcher.write(0, &req, sizeof(req), nullptr, 0);
+}
+
+static bool launcher_template_test(void) {
+    BEGIN_TEST;
+
+    zx::channel launcher, launcher_request;
+    ASSERT_EQ(ZX_OK, zx::channel::create(0, &launcher, &launcher_request));
+    ASSERT_EQ(ZX_OK, fdio_service_connect("/svc/fuchsia.process.Launcher",
+                                          launcher_request.release()));
+
+    int fd = open(kSpawnChild, O_RDONLY);
+    ASSERT_GE(fd, 0);
+    zx::vmo vmo;
+    ASSERT_EQ(ZX_OK, fdio_get_vmo_clone(fd, vmo.reset_and_get_address()));
+    close(fd);
+
+    // A template's PT_INTERP is looked up with the client's loader service,
+    // so one is needed to make a template of a binary which has one.
+    zx::vmo executable;
+    ASSERT_EQ(ZX_OK, vmo.duplicate(ZX_RIGHT_SAME_RIGHTS, &executable));
+    uint64_t id = 0;
+    EXPECT_EQ(ZX_ERR_INVALID_ARGS, launcher_create_template(launcher, std::move(executable), &id));
+
+    // An ELF file without a PT_INTERP, like the vDSO, needs none.
+    zx_handle_t vdso;
+    ASSERT_EQ(ZX_OK, launchpad_get_vdso_vmo(&vdso));
+    ASSERT_EQ(ZX_OK, launcher_create_template(launcher, zx::vmo(vdso), &id));
+    ASSERT_EQ(ZX_OK, launcher_release_template(launcher, id));
+
+    ASSERT_EQ(ZX_OK, launcher_add_loader(launcher));
+    ASSERT_EQ(ZX_OK, launcher_create_template(launcher, std::move(vmo), &id));
+
+    // Each launch gets the arguments and handles added since the last one.
+    zx::process process;
+    {
+        const char* argv[] = {kSpawnChild, "--argc", "three", nullptr};
+        ASSERT_EQ(ZX_OK, launcher_add_args(launcher, argv));
+        ASSERT_EQ(ZX_OK, launcher_add_loader(launcher));
+        ASSERT_EQ(ZX_OK, launcher_launch_from_template(launcher, id, &process));
+        EXPECT_EQ(3, join(process));
+    }
+    {
+        const char* argv[] = {kSpawnChild, nullptr};
+        ASSERT_EQ(ZX_OK, launcher_add_args(launcher, argv));
+        ASSERT_EQ(ZX_OK, launcher_add_loader(launcher));
+        ASSERT_EQ(ZX_OK, launcher_launch_from_template(launcher, id, &process));
+        EXPECT_EQ(43, join(process));
+    }
+
+    // Once released, the template can't be launched from.
+    ASSERT_EQ(ZX_OK, launcher_release_template(launcher, id));
+    {
+        const char* argv[] = {kSpawnChild, nullptr};
+        ASSERT_EQ(ZX_OK, launcher_add_args(launcher, argv));
+        ASSERT_EQ(ZX_OK, launcher_add_loader(launcher));
+        EXPECT_EQ(ZX_ERR_NOT_FOUND, launcher_launch_from_template(launcher, id, &process));
+    }
+
+    END_TEST;
+}
+
 BEGIN_TEST_CASE(spawn_tests)
 RUN_TEST(spawn_control_test)
 RUN_TEST(spawn_launcher_test)
@@ -612,6 +816,7 @@ RUN_TEST(spawn_actions_h_test)
 RUN_TEST(spawn_actions_name_test)
 RUN_TEST(spawn_errors_test)
 RUN_TEST(spawn_vmo_test)
+RUN_TEST(launcher_template_test)
 END_TEST_CASE(spawn_tests)
 
 int main(int argc, char** argv) {
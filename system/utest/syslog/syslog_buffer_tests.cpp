@@ -0,0 +1,292 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <fbl/algorithm.h>
+#include <lib/syslog/log_buffer.h>
+#include <lib/syslog/logger.h>
+#include <lib/syslog/wire_format.h>
+#include <lib/zx/eventpair.h>
+#include <lib/zx/vmar.h>
+#include <lib/zx/vmo.h>
+#include <unittest/unittest.h>
+
+#include <string.h>
+#include <threads.h>
+
+#include <utility>
+
+namespace {
+
+// A shared log buffer, and the reader's end of its eventpair.
+class Buffer {
+public:
+    ~Buffer() {
+        if (mapping_ != 0) {
+            zx::vmar::root_self()->unmap(mapping_, size_);
+        }
+    }
+
+    bool Init(size_t size) {
+        BEGIN_HELPER;
+        size_ = size;
+        ASSERT_EQ(ZX_OK, zx::vmo::create(size_, ZX_VMO_NON_RESIZABLE, &vmo_));
+        ASSERT_EQ(ZX_OK, zx::vmar::root_self()->map(0, vmo_, 0, size_,
+                                                    ZX_VM_PERM_READ | ZX_VM_PERM_WRITE,
+                                                    &mapping_));
+        ASSERT_EQ(ZX_OK, fx_log_buffer_init(data(), size_));
+        END_HELPER;
+    }
+
+    // Creates a logger writing to the buffer.
+    bool CreateLogger(const char** tags, size_t num_tags, fx_logger_t** out_logger) {
+        BEGIN_HELPER;
+        zx::vmo vmo;
+        ASSERT_EQ(ZX_OK, vmo_.duplicate(ZX_RIGHT_SAME_RIGHTS, &vmo));
+        zx::eventpair writer_event;
+        ASSERT_EQ(ZX_OK, zx::eventpair::create(0, &event_, &writer_event));
+        fx_logger_config_t config = {.min_severity = FX_LOG_INFO,
+                                     .console_fd = -1,
+                                     .log_service_channel = ZX_HANDLE_INVALID,
+                                     .tags = tags,
+                                     .num_tags = num_tags};
+        ASSERT_EQ(ZX_OK, fx_logger_create_with_buffer(&config, vmo.release(),
+                                                      writer_event.release(), out_logger));
+        END_HELPER;
+    }
+
+    void* data() const { return reinterpret_cast<void*>(mapping_); }
+    size_t size() const { return size_; }
+    const zx::eventpair& event() const { return event_; }
+    void CloseReader() { event_.reset(); }
+
+private:
+    zx::vmo vmo_;
+    uintptr_t mapping_ = 0;
+    size_t size_ = 0;
+    zx::eventpair event_;
+};
+
+// Copies each packet drained from a buffer.
+struct Packets {
+    static void Append(const fx_log_packet_t* packet, size_t size, void* ctx) {
+        auto* packets = static_cast<Packets*>(ctx);
+        if (packets->count < fbl::count_of(packets->packets)) {
+            memcpy(&packets->packets[packets->count], packet, size);
+        }
+        packets->count++;
+    }
+
+    fx_log_packet_t packets[4] = {};
+    size_t count = 0;
+};
+
+bool TestBufferWriteAndDrain(void) {
+    BEGIN_TEST;
+    Buffer buffer;
+    ASSERT_TRUE(buffer.Init(ZX_PAGE_SIZE));
+    const char* tags[] = {"tag"};
+    fx_logger_t* logger;
+    ASSERT_TRUE(buffer.CreateLogger(tags, 1, &logger));
+
+    EXPECT_TRUE(fx_log_buffer_arm(buffer.data(), buffer.size()));
+    EXPECT_EQ(ZX_OK, fx_logger_logf(logger, FX_LOG_WARNING, nullptr, "%d, %s", 10, "first"));
+    // The reader asked to be woken by the first record.
+    zx_signals_t pending;
+    EXPECT_EQ(ZX_OK, buffer.event().wait_one(ZX_USER_SIGNAL_0, zx::time(), &pending));
+    EXPECT_FALSE(fx_log_buffer_arm(buffer.data(), buffer.size()));
+    EXPECT_EQ(ZX_OK, fx_logger_log(logger, FX_LOG_INFO, "local", "second"));
+
+    Packets packets;
+    EXPECT_EQ(2, fx_log_buffer_drain(buffer.data(), buffer.size(), Packets::Append, &packets));
+    ASSERT_EQ(2u, packets.count);
+    const fx_log_packet_t& first = packets.packets[0];
+    EXPECT_EQ(FX_LOG_WARNING, first.metadata.severity);
+    EXPECT_EQ(3, first.data[0]);
+    EXPECT_BYTES_EQ(reinterpret_cast<const uint8_t*>("tag"),
+                    reinterpret_cast<const uint8_t*>(first.data + 1), 3, "");
+    EXPECT_EQ(0, first.data[4]);
+    EXPECT_STR_EQ("10, first", first.data + 5, "");
+    const fx_log_packet_t& second = packets.packets[1];
+    EXPECT_EQ(FX_LOG_INFO, second.metadata.severity);
+    EXPECT_STR_EQ("second", second.data + 11, "");
+
+    EXPECT_EQ(0, fx_log_buffer_drain(buffer.data(), buffer.size(), Packets::Append, &packets));
+    EXPECT_TRUE(fx_log_buffer_arm(buffer.data(), buffer.size()));
+    fx_logger_destroy(logger);
+    END_TEST;
+}
+
+bool TestBufferFull(void) {
+    BEGIN_TEST;
+    Buffer buffer;
+    ASSERT_TRUE(buffer.Init(ZX_PAGE_SIZE));
+    fx_logger_t* logger;
+    ASSERT_TRUE(buffer.CreateLogger(nullptr, 0, &logger));
+
+    char msg[1000];
+    memset(msg, 'a', sizeof(msg) - 1);
+    msg[sizeof(msg) - 1] = 0;
+    size_t written = 0;
+    uint32_t dropped = 0;
+    for (size_t i = 0; i < 10; i++) {
+        zx_status_t status = fx_logger_log(logger, FX_LOG_INFO, nullptr, msg);
+        if (status == ZX_OK) {
+            EXPECT_EQ(0u, dropped, "no record fits once the buffer is full");
+            written++;
+        } else {
+            EXPECT_EQ(ZX_ERR_SHOULD_WAIT, status);
+            dropped++;
+        }
+    }
+    EXPECT_GT(written, 0u);
+    EXPECT_GT(dropped, 0u);
+
+    // The next record written reports the dropped ones.
+    Packets packets;
+    EXPECT_EQ(static_cast<ssize_t>(written),
+              fx_log_buffer_drain(buffer.data(), buffer.size(), Packets::Append, &packets));
+    EXPECT_EQ(ZX_OK, fx_logger_log(logger, FX_LOG_INFO, nullptr, "after"));
+    packets.count = 0;
+    EXPECT_EQ(1, fx_log_buffer_drain(buffer.data(), buffer.size(), Packets::Append, &packets));
+    EXPECT_EQ(dropped, packets.packets[0].metadata.dropped_logs);
+    EXPECT_STR_EQ("after", packets.packets[0].data + 1, "");
+    fx_logger_destroy(logger);
+    END_TEST;
+}
+
+constexpr size_t kThreads = 4;
+constexpr uint32_t kRecordsPerThread = 10000;
+
+struct WriterArgs {
+    Buffer* buffer;
+    zx_koid_t index;
+};
+
+int WriterThread(void* arg) {
+    auto* args = static_cast<WriterArgs*>(arg);
+    fx_log_packet_t packet = {};
+    packet.metadata.tid = args->index;
+    for (uint32_t i = 0; i < kRecordsPerThread; i++) {
+        // Vary the size of the records, so they wrap at different places.
+        packet.metadata.dropped_logs = i;
+        size_t size = sizeof(packet.metadata) + (i * 13) % 300;
+        bool wake_reader;
+        while (fx_log_buffer_write(args->buffer->data(), args->buffer->size(), &packet, size,
+                                   &wake_reader) == ZX_ERR_SHOULD_WAIT) {
+            thrd_yield();
+        }
+    }
+    return 0;
+}
+
+struct Order {
+    static void Check(const fx_log_packet_t* packet, size_t size, void* ctx) {
+        auto* order = static_cast<Order*>(ctx);
+        zx_koid_t index = packet->metadata.tid;
+        if (index >= kThreads || packet->metadata.dropped_logs != order->next[index]) {
+            order->ok = false;
+            return;
+        }
+        order->next[index]++;
+        order->total++;
+    }
+
+    uint32_t next[kThreads] = {};
+    size_t total = 0;
+    bool ok = true;
+};
+
+// Records from one thread are read in the order they were written, even
+// while other threads write and the reader drains at the same time.
+bool TestBufferThreadOrder(void) {
+    BEGIN_TEST;
+    Buffer buffer;
+    ASSERT_TRUE(buffer.Init(2 * ZX_PAGE_SIZE));
+
+    WriterArgs args[kThreads];
+    thrd_t threads[kThreads];
+    for (size_t i = 0; i < kThreads; i++) {
+        args[i] = {&buffer, i};
+        ASSERT_EQ(thrd_success, thrd_create(&threads[i], WriterThread, &args[i]));
+    }
+    Order order;
+    while (order.ok && order.total < kThreads * kRecordsPerThread) {
+        ASSERT_GE(fx_log_buffer_drain(buffer.data(), buffer.size(), Order::Check, &order), 0);
+    }
+    for (thrd_t thread : threads) {
+        thrd_join(thread, nullptr);
+    }
+    EXPECT_TRUE(order.ok);
+    EXPECT_EQ(kThreads * kRecordsPerThread, order.total);
+    END_TEST;
+}
+
+bool TestBufferMalformed(void) {
+    BEGIN_TEST;
+    Buffer buffer;
+    ASSERT_TRUE(buffer.Init(ZX_PAGE_SIZE));
+    auto* header = static_cast<fx_log_buffer_header_t*>(buffer.data());
+    header->capacity = buffer.size();
+
+    fx_log_packet_t packet = {};
+    bool wake_reader;
+    EXPECT_EQ(ZX_ERR_INVALID_ARGS, fx_log_buffer_write(buffer.data(), buffer.size(), &packet,
+                                                       sizeof(packet.metadata), &wake_reader));
+    Packets packets;
+    EXPECT_EQ(ZX_ERR_INVALID_ARGS,
+              fx_log_buffer_drain(buffer.data(), buffer.size(), Packets::Append, &packets));
+    END_TEST;
+}
+
+// A buffer which could shrink under the logger's mapping is refused.
+bool TestBufferResizable(void) {
+    BEGIN_TEST;
+    zx::vmo vmo;
+    ASSERT_EQ(ZX_OK, zx::vmo::create(ZX_PAGE_SIZE, 0, &vmo));
+    zx::eventpair reader_event, writer_event;
+    ASSERT_EQ(ZX_OK, zx::eventpair::create(0, &reader_event, &writer_event));
+    fx_logger_config_t config = {.min_severity = FX_LOG_INFO,
+                                 .console_fd = -1,
+                                 .log_service_channel = ZX_HANDLE_INVALID,
+                                 .tags = nullptr,
+                                 .num_tags = 0};
+    fx_logger_t* logger = nullptr;
+    EXPECT_NE(ZX_OK, fx_logger_create_with_buffer(&config, vmo.release(),
+                                                  writer_event.release(), &logger));
+    EXPECT_NULL(logger);
+    END_TEST;
+}
+
+// Once the reader is gone the logger stops writing to the buffer, rather
+// than filling it and then dropping records.
+bool TestBufferReaderGone(void) {
+    BEGIN_TEST;
+    Buffer buffer;
+    ASSERT_TRUE(buffer.Init(ZX_PAGE_SIZE));
+    fx_logger_t* logger;
+    ASSERT_TRUE(buffer.CreateLogger(nullptr, 0, &logger));
+
+    EXPECT_TRUE(fx_log_buffer_arm(buffer.data(), buffer.size()));
+    buffer.CloseReader();
+    // This record finds the reader gone when it tries to wake it.
+    EXPECT_EQ(ZX_OK, fx_logger_log(logger, FX_LOG_INFO, nullptr, "first"));
+    for (size_t i = 0; i < 10; i++) {
+        EXPECT_EQ(ZX_OK, fx_logger_log(logger, FX_LOG_INFO, nullptr, "more"));
+    }
+    Packets packets;
+    EXPECT_EQ(1, fx_log_buffer_drain(buffer.data(), buffer.size(), Packets::Append, &packets));
+    fx_logger_destroy(logger);
+    END_TEST;
+}
+
+} // namespace
+
+BEGIN_TEST_CASE(syslog_buffer_tests)
+RUN_TEST(TestBufferWriteAndDrain)
+RUN_TEST(TestBufferFull)
+RUN_TEST(TestBufferThreadOrder)
+RUN_TEST(TestBufferMalformed)
+RUN_TEST(TestBufferResizable)
+RUN_TEST(TestBufferReaderGone)
+END_TEST_CASE(syslog_buffer_tests)
@@ -0,0 +1,336 @@
+// Copyright 2019 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <trace-reader/mapped_reader.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <fbl/algorithm.h>
+#include <fbl/string.h>
+#include <fbl/unique_ptr.h>
+#include <fbl/vector.h>
+#include <trace-engine/fields.h>
+#include <unittest/unittest.h>
+
+#include <utility>
+
+namespace {
+
+// Small blocks, so the test trace spans many of them.
+constexpr size_t kBlockSize = 256u;
+
+constexpr trace_ticks_t kEventsPerProvider = 1000u;
+// Provider 1 renames string 3 at this time.
+constexpr trace_ticks_t kRenameTime = 500u;
+
+uint64_t MakeHeader(trace::RecordType type, size_t size_words) {
+    return trace::RecordFields::Type::Make(trace::ToUnderlyingType(type)) |
+           trace::RecordFields::RecordSize::Make(size_words);
+}
+
+// Appends records to a trace.
+class TraceBuilder {
+public:
+    void ProviderInfo(trace::ProviderId id, const char* name) {
+        size_t length = strlen(name);
+        Append(MakeHeader(trace::RecordType::kMetadata, 1 + trace::BytesToWords(length)) |
+               trace::MetadataRecordFields::MetadataType::Make(
+                   trace::ToUnderlyingType(trace::MetadataType::kProviderInfo)) |
+               trace::ProviderInfoMetadataRecordFields::Id::Make(id) |
+               trace::ProviderInfoMetadataRecordFields::NameLength::Make(length));
+        AppendString(name, length);
+    }
+
+    void String(trace_string_index_t index, const char* string) {
+        size_t length = strlen(string);
+        Append(MakeHeader(trace::RecordType::kString, 1 + trace::BytesToWords(length)) |
+               trace::StringRecordFields::StringIndex::Make(index) |
+               trace::StringRecordFields::StringLength::Make(length));
+        AppendString(string, length);
+    }
+
+    void Thread(trace_thread_index_t index, zx_koid_t process_koid, zx_koid_t thread_koid) {
+        Append(MakeHeader(trace::RecordType::kThread, 3) |
+               trace::ThreadRecordFields::ThreadIndex::Make(index));
+        Append(process_koid);
+        Append(thread_koid);
+    }
+
+    // A duration begin event from thread 1, with indexed category and name.
+    void Event(trace_ticks_t timestamp, trace_string_index_t category,
+               trace_string_index_t name) {
+        Append(MakeHeader(trace::RecordType::kEvent, 2) |
+               trace::EventRecordFields::EventType::Make(
+                   trace::ToUnderlyingType(trace::EventType::kDurationBegin)) |
+               trace::EventRecordFields::ThreadRef::Make(1) |
+               trace::EventRecordFields::CategoryStringRef::Make(category) |
+               trace::EventRecordFields::NameStringRef::Make(name));
+        Append(timestamp);
+    }
+
+    const fbl::Vector<uint64_t>& words() const { return words_; }
+
+private:
+    void Append(uint64_t word) { words_.push_back(word); }
+
+    void AppendString(const char* string, size_t length) {
+        for (size_t i = 0; i < length; i += sizeof(uint64_t)) {
+            uint64_t word = 0u;
+            memcpy(&word, string + i, fbl::min(sizeof(uint64_t), length - i));
+            Append(word);
+        }
+    }
+
+    fbl::Vector<uint64_t> words_;
+};
+
+// Two providers, each with a thread and three strings, which index the
+// categories the other way around in provider 2. Each writes events at
+// consecutive times, alternating between the categories.
+void BuildTestTrace(TraceBuilder* builder) {
+    builder->ProviderInfo(1u, "p1");
+    builder->String(1u, "c1");
+    builder->String(2u, "c2");
+    builder->String(3u, "name");
+    builder->Thread(1u, 1u, 2u);
+    for (trace_ticks_t ts = 0u; ts < kEventsPerProvider; ++ts) {
+        if (ts == kRenameTime)
+            builder->String(3u, "renamed");
+        builder->Event(ts, ts % 2 ? 2u : 1u, 3u);
+    }
+
+    builder->ProviderInfo(2u, "p2");
+    builder->String(1u, "c2");
+    builder->String(2u, "c1");
+    builder->String(3u, "name");
+    builder->Thread(1u, 3u, 4u);
+    for (trace_ticks_t ts = kEventsPerProvider; ts < 2 * kEventsPerProvider; ++ts) {
+        builder->Event(ts, ts % 2 ? 2u : 1u, 3u);
+    }
+}
+
+// Returns the category and name the test trace gives the event at |ts|.
+const char* ExpectedCategory(trace_ticks_t ts) {
+    bool first_index = ts % 2 == 0;
+    return (ts < kEventsPerProvider) == first_index ? "c1" : "c2";
+}
+
+const char* ExpectedName(trace_ticks_t ts) {
+    return ts >= kRenameTime && ts < kEventsPerProvider ? "renamed" : "name";
+}
+
+bool CreateTestReader(const TraceBuilder& builder, fbl::String* error,
+                      fbl::unique_ptr<trace::MappedTraceReader>* out_reader) {
+    BEGIN_HELPER;
+
+    ASSERT_TRUE(trace::MappedTraceReader::Create(
+        builder.words().get(), builder.words().size(),
+        [error](fbl::String e) { *error = std::move(e); },
+        kBlockSize, out_reader));
+
+    END_HELPER;
+}
+
+bool CheckEvent(const trace::Record& record) {
+    BEGIN_HELPER;
+
+    ASSERT_TRUE(record.type() == trace::RecordType::kEvent);
+    const auto& event = record.GetEvent();
+    EXPECT_TRUE(event.type() == trace::EventType::kDurationBegin);
+    EXPECT_TRUE(event.category == ExpectedCategory(event.timestamp));
+    EXPECT_TRUE(event.name == ExpectedName(event.timestamp));
+    zx_koid_t thread_koid = event.timestamp < kEventsPerProvider ? 2u : 4u;
+    EXPECT_EQ(thread_koid, event.process_thread.thread_koid());
+
+    END_HELPER;
+}
+
+bool index_test() {
+    BEGIN_TEST;
+
+    TraceBuilder builder;
+    BuildTestTrace(&builder);
+    fbl::String error;
+    fbl::unique_ptr<trace::MappedTraceReader> reader;
+    ASSERT_TRUE(CreateTestReader(builder, &error, &reader));
+
+    EXPECT_GE(reader->num_blocks(), builder.words().size() * sizeof(uint64_t) / kBlockSize);
+    EXPECT_EQ(0u, reader->start_time());
+    EXPECT_EQ(2 * kEventsPerProvider, reader->end_time());
+    EXPECT_TRUE(error.empty());
+
+    END_TEST;
+}
+
+// Reading a time range in the middle of a provider's events needs the
+// definitions from every block before it, including the redefinition of
+// a string.
+bool time_range_test() {
+    BEGIN_TEST;
+
+    TraceBuilder builder;
+    BuildTestTrace(&builder);
+    fbl::String error;
+    fbl::unique_ptr<trace::MappedTraceReader> reader;
+    ASSERT_TRUE(CreateTestReader(builder, &error, &reader));
+
+    trace::MappedTraceReader::Query query;
+    query.start_time = kRenameTime - 10u;
+    query.end_time = kRenameTime + 10u;
+    fbl::Vector<trace::Record> records;
+    ASSERT_TRUE(reader->ReadEvents(query, 1u, [&records](trace::Record record) {
+        records.push_back(std::move(record));
+    }));
+
+    ASSERT_EQ(20u, records.size());
+    for (size_t i = 0; i < records.size(); ++i) {
+        ASSERT_TRUE(CheckEvent(records[i]));
+        EXPECT_EQ(query.start_time + i, records[i].GetEvent().timestamp);
+    }
+    EXPECT_TRUE(error.empty(), error.c_str());
+
+    END_TEST;
+}
+
+bool provider_and_category_test() {
+    BEGIN_TEST;
+
+    TraceBuilder builder;
+    BuildTestTrace(&builder);
+    fbl::String error;
+    fbl::unique_ptr<trace::MappedTraceReader> reader;
+    ASSERT_TRUE(CreateTestReader(builder, &error, &reader));
+
+    trace::MappedTraceReader::Query query;
+    query.provider_id = 2u;
+    query.categories.push_back("c1");
+    size_t count = 0u;
+    bool ok = true;
+    ASSERT_TRUE(reader->ReadEvents(query, 1u, [&count, &ok](trace::Record record) {
+        ok = ok && CheckEvent(record) &&
+             record.GetEvent().timestamp >= kEventsPerProvider &&
+             record.GetEvent().category == "c1";
+        count++;
+    }));
+
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(kEventsPerProvider / 2, count);
+    EXPECT_TRUE(error.empty(), error.c_str());
+
+    END_TEST;
+}
+
+bool parallel_test() {
+    BEGIN_TEST;
+
+    TraceBuilder builder;
+    BuildTestTrace(&builder);
+    fbl::String error;
+    fbl::unique_ptr<trace::MappedTraceReader> reader;
+    ASSERT_TRUE(CreateTestReader(builder, &error, &reader));
+
+    trace::MappedTraceReader::Query query;
+    uint32_t seen[2 * kEventsPerProvider] = {};
+    bool ok = true;
+    ASSERT_TRUE(reader->ReadEvents(query, 4u, [&seen, &ok](trace::Record record) {
+        ok = ok && CheckEvent(record) &&
+             record.GetEvent().timestamp < 2 * kEventsPerProvider;
+        if (ok)
+            seen[record.GetEvent().timestamp]++;
+    }));
+
+    EXPECT_TRUE(ok);
+    for (uint32_t count : seen) {
+        EXPECT_EQ(1u, count);
+    }
+    EXPECT_TRUE(error.empty(), error.c_str());
+
+    END_TEST;
+}
+
+// Opening a trace file maps it, and reads the same events as the trace
+// in memory.
+bool open_test() {
+    BEGIN_TEST;
+
+    TraceBuilder builder;
+    BuildTestTrace(&builder);
+    char path[] = "/tmp/mapped-reader-test-XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    size_t size = builder.words().size() * sizeof(uint64_t);
+    bool written = write(fd, builder.words().get(), size) == static_cast<ssize_t>(size);
+    close(fd);
+
+    fbl::String error;
+    fbl::unique_ptr<trace::MappedTraceReader> reader;
+    bool opened = written && trace::MappedTraceReader::Open(
+        path, [&error](fbl::String e) { error = std::move(e); }, &reader);
+    unlink(path);
+    ASSERT_TRUE(written);
+    ASSERT_TRUE(opened, error.c_str());
+
+    EXPECT_GE(reader->num_blocks(), 2u);
+    EXPECT_EQ(0u, reader->start_time());
+    EXPECT_EQ(2 * kEventsPerProvider, reader->end_time());
+
+    trace::MappedTraceReader::Query query;
+    trace_ticks_t next = 0u;
+    bool ok = true;
+    ASSERT_TRUE(reader->ReadEvents(query, 1u, [&next, &ok](trace::Record record) {
+        ok = ok && CheckEvent(record) && record.GetEvent().timestamp == next;
+        next++;
+    }));
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(2 * kEventsPerProvider, next);
+    EXPECT_TRUE(error.empty(), error.c_str());
+
+    END_TEST;
+}
+
+bool open_missing_file_test() {
+    BEGIN_TEST;
+
+    fbl::String error;
+    fbl::unique_ptr<trace::MappedTraceReader> reader;
+    EXPECT_FALSE(trace::MappedTraceReader::Open(
+        "/tmp/mapped-reader-test-does-not-exist",
+        [&error](fbl::String e) { error = std::move(e); }, &reader));
+    EXPECT_NULL(reader);
+    EXPECT_FALSE(error.empty());
+
+    END_TEST;
+}
+
+bool corrupt_trace_test() {
+    BEGIN_TEST;
+
+    // A record of size zero.
+    const uint64_t kWords[] = {0u};
+    fbl::String error;
+    fbl::unique_ptr<trace::MappedTraceReader> reader;
+    EXPECT_FALSE(trace::MappedTraceReader::Create(
+        kWords, fbl::count_of(kWords),
+        [&error](fbl::String e) { error = std::move(e); },
+        kBlockSize, &reader));
+    EXPECT_NULL(reader);
+    EXPECT_FALSE(error.empty());
+
+    END_TEST;
+}
+
+} // namespace
+
+BEGIN_TEST_CASE(mapped_reader_tests)
+RUN_TEST(index_test)
+RUN_TEST(time_range_test)
+RUN_TEST(provider_and_category_test)
+RUN_TEST(parallel_test)
+RUN_TEST(open_test)
+RUN_TEST(open_missing_file_test)
+RUN_TEST(corrupt_trace_test)
+END_TEST_CASE(mapped_reader_tests)
@@ -835,6 +835,166 @@ bool TestShutdownWhenFull() {
     END_TRACE_TEST;
 }
 
+// The range of values of the events one thread wrote with
+// |WriteThreadEvents()| which were recorded.
+struct ThreadEvents {
+    zx_koid_t koid;
+    uint32_t first;
+    uint32_t last;
+};
+
+void WriteThreadEvents(uint32_t num_events) {
+    for (uint32_t i = 0; i < num_events; ++i) {
+        TRACE_INSTANT("+enabled", "name", TRACE_SCOPE_GLOBAL,
+                      "i", TA_UINT32(i));
+    }
+}
+
+// Checks that each thread's events are in the order it wrote them, and,
+// when |contiguous|, that none of them are missing from its range.
+bool CollectThreadEvents(const fbl::Vector<trace::Record>& records,
+                         bool contiguous, fbl::Vector<ThreadEvents>* out_threads) {
+    BEGIN_HELPER;
+
+    for (const auto& record : records) {
+        if (record.type() != trace::RecordType::kEvent)
+            continue;
+        const auto& event = record.GetEvent();
+        ASSERT_EQ(event.arguments.size(), 1u);
+        uint32_t value = event.arguments[0].value().GetUint32();
+
+        zx_koid_t koid = event.process_thread.thread_koid();
+        size_t index = 0;
+        while (index < out_threads->size() && (*out_threads)[index].koid != koid)
+            ++index;
+        if (index == out_threads->size()) {
+            out_threads->push_back(ThreadEvents{koid, value, value});
+            continue;
+        }
+        ThreadEvents& thread = (*out_threads)[index];
+        if (contiguous) {
+            EXPECT_EQ(value, thread.last + 1, "out of order");
+        } else {
+            EXPECT_GT(value, thread.last, "out of order");
+        }
+        thread.last = value;
+    }
+
+    END_HELPER;
+}
+
+// With thread buffers every record still arrives, and each thread's
+// records stay in the order it wrote them. The records of threads which
+// exited before tracing stopped are handed off when it stops.
+bool TestThreadBuffers() {
+    BEGIN_TRACE_TEST;
+
+    const uint32_t kNumThreads = 4u;
+    // Enough records to fill each thread's buffer several times over.
+    const uint32_t kNumEvents = 1000u;
+
+    fixture_set_engine_options(TRACE_ENGINE_OPTION_THREAD_BUFFERS);
+    fixture_start_tracing();
+
+    for (uint32_t t = 0; t < kNumThreads; ++t) {
+        RunThread([] { WriteThreadEvents(kNumEvents); });
+    }
+    WriteThreadEvents(kNumEvents);
+
+    fbl::Vector<trace::Record> records;
+    ASSERT_TRUE(fixture_read_records(&records));
+
+    fbl::Vector<ThreadEvents> threads;
+    ASSERT_TRUE(CollectThreadEvents(records, true, &threads));
+    EXPECT_EQ(threads.size(), kNumThreads + 1);
+    for (const auto& thread : threads) {
+        EXPECT_EQ(thread.first, 0u);
+        EXPECT_EQ(thread.last, kNumEvents - 1);
+    }
+
+    END_TRACE_TEST;
+}
+
+// In circular mode older records are overwritten, but each thread's most
+// recent records, including those handed off when tracing stops, remain.
+bool TestThreadBuffersCircularMode() {
+    const size_t kBufferSize = 65536u;
+    BEGIN_TRACE_TEST_ETC(kNoAttachToThread,
+                         TRACE_BUFFERING_MODE_CIRCULAR, kBufferSize);
+
+    // Few enough threads that the records left in their buffers when
+    // tracing stops fit in one rolling buffer.
+    const uint32_t kNumThreads = 2u;
+    // Enough records to wrap the rolling buffers.
+    const uint32_t kNumEvents = 1000u;
+
+    fixture_set_engine_options(TRACE_ENGINE_OPTION_THREAD_BUFFERS);
+    fixture_start_tracing();
+
+    for (uint32_t t = 0; t < kNumThreads; ++t) {
+        RunThread([] { WriteThreadEvents(kNumEvents); });
+    }
+    WriteThreadEvents(kNumEvents);
+
+    fbl::Vector<trace::Record> records;
+    ASSERT_TRUE(fixture_read_records(&records));
+    EXPECT_EQ(fixture_get_disposition(), ZX_OK);
+
+    trace_buffer_header header;
+    fixture_read_buffer_header(&header);
+    EXPECT_GT(header.wrapped_count, 1u);
+
+    fbl::Vector<ThreadEvents> threads;
+    ASSERT_TRUE(CollectThreadEvents(records, true, &threads));
+    EXPECT_EQ(threads.size(), kNumThreads + 1);
+    for (const auto& thread : threads) {
+        EXPECT_EQ(thread.last, kNumEvents - 1);
+    }
+
+    END_TRACE_TEST;
+}
+
+// In streaming mode the records left in a thread's buffer when tracing
+// stops are dropped, rather than switched to the other rolling buffer,
+// when the current one is full: nothing would save it.
+bool TestThreadBuffersStreamingMode() {
+    const size_t kBufferSize = 4096u;
+    BEGIN_TRACE_TEST_ETC(kNoAttachToThread,
+                         TRACE_BUFFERING_MODE_STREAMING, kBufferSize);
+
+    fixture_set_engine_options(TRACE_ENGINE_OPTION_THREAD_BUFFERS);
+    fixture_start_tracing();
+
+    // Fill both rolling buffers. Only the first one is reported full since
+    // there's no one to save it.
+    WriteThreadEvents(kBufferSize / 8);
+    EXPECT_TRUE(fixture_wait_buffer_full_notification());
+    EXPECT_EQ(fixture_get_buffer_full_wrapped_count(), 0);
+    fixture_reset_buffer_full_notification();
+
+    // Save the first buffer, so the second one, which is current and full,
+    // could be switched for it.
+    trace_engine_mark_buffer_saved(0, 0);
+
+    fbl::Vector<trace::Record> records;
+    ASSERT_TRUE(fixture_read_records(&records));
+    EXPECT_EQ(fixture_get_disposition(), ZX_ERR_NO_MEMORY);
+
+    trace_buffer_header header;
+    fixture_read_buffer_header(&header);
+    EXPECT_EQ(header.wrapped_count, 1u);
+    EXPECT_EQ(header.rolling_data_end[0], 0u);
+    EXPECT_NE(header.num_records_dropped, 0u);
+
+    fbl::Vector<ThreadEvents> threads;
+    ASSERT_TRUE(CollectThreadEvents(records, false, &threads));
+    ASSERT_EQ(threads.size(), 1u);
+    // The last event was still in the thread's buffer when tracing stopped.
+    EXPECT_LT(threads[0].last, kBufferSize / 8 - 1);
+
+    END_TRACE_TEST;
+}
+
 // NOTE: The functions for writing trace records are exercised by other trace tests.
 
 } // namespace
@@ -860,4 +1020,7 @@ RUN_TEST(TestEventWithInlineEverything)
 RUN_TEST(TestCircularMode)
 RUN_TEST(TestStreamingMode)
 RUN_TEST(TestShutdownWhenFull)
+RUN_TEST(TestThreadBuffers)
+RUN_TEST(TestThreadBuffersCircularMode)
+RUN_TEST(TestThreadBuffersStreamingMode)
 END_TEST_CASE(engine_tests)
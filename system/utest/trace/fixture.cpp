@@ -63,9 +63,10 @@ public:
     void StartEngine() {
         ResetEngineState();
 
-        zx_status_t status = trace_start_engine(loop_.dispatcher(), this,
-                                                buffering_mode_,
-                                                buffer_.get(), buffer_.size());
+        zx_status_t status = trace_start_engine_etc(loop_.dispatcher(), this,
+                                                    buffering_mode_,
+                                                    buffer_.get(), buffer_.size(),
+                                                    engine_options_);
         ZX_DEBUG_ASSERT_MSG(status == ZX_OK, "status=%d", status);
     }
 
@@ -142,6 +143,10 @@ public:
         return loop_;
     }
 
+    void set_engine_options(uint32_t options) {
+        engine_options_ = options;
+    }
+
     zx_status_t disposition() const {
         return disposition_;
     }
@@ -164,6 +169,10 @@ public:
         observed_buffer_full_durable_data_end_ = 0;
     }
 
+    void ReadBufferHeader(trace_buffer_header* header) {
+        memcpy(header, buffer_.get(), sizeof(*header));
+    }
+
     bool ReadRecords(fbl::Vector<trace::Record>* out_records) {
         return trace_testing::ReadRecords(buffer_.get(), buffer_.size(),
                                           out_records);
@@ -201,6 +210,7 @@ private:
     attach_to_thread_t attach_to_thread_;
     async::Loop loop_;
     trace_buffering_mode_t buffering_mode_;
+    uint32_t engine_options_ = 0u;
     fbl::Array<uint8_t> buffer_;
     bool trace_running_ = false;
     zx_status_t disposition_;
@@ -223,6 +233,11 @@ void fixture_set_up(attach_to_thread_t attach_to_thread,
     g_fixture = new Fixture(attach_to_thread, mode, buffer_size);
 }
 
+void fixture_set_engine_options(uint32_t options) {
+    ZX_DEBUG_ASSERT(g_fixture);
+    g_fixture->set_engine_options(options);
+}
+
 void fixture_tear_down(void) {
     ZX_DEBUG_ASSERT(g_fixture);
     delete g_fixture;
@@ -317,6 +332,17 @@ bool fixture_compare_n_records(size_t max_num_records, const char* expected,
     END_HELPER;
 }
 
+bool fixture_read_records(fbl::Vector<trace::Record>* out_records) {
+    ZX_DEBUG_ASSERT(g_fixture);
+    BEGIN_HELPER;
+
+    g_fixture->StopTracing(false);
+
+    ASSERT_TRUE(g_fixture->ReadRecords(out_records), "read error");
+
+    END_HELPER;
+}
+
 bool fixture_compare_records(const char* expected) {
     fbl::Vector<trace::Record> records;
     return fixture_compare_n_records(SIZE_MAX, expected, &records, nullptr);
@@ -326,3 +352,8 @@ void fixture_snapshot_buffer_header(trace_buffer_header* header) {
     auto context = trace::TraceProlongedContext::Acquire();
     trace_context_snapshot_buffer_header(context.get(), header);
 }
+
+void fixture_read_buffer_header(trace_buffer_header* header) {
+    ZX_DEBUG_ASSERT(g_fixture);
+    g_fixture->ReadBufferHeader(header);
+}
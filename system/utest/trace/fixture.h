@@ -41,9 +41,15 @@ bool fixture_compare_raw_records(const fbl::Vector<trace::Record>& records,
 bool fixture_compare_n_records(size_t max_num_records, const char* expected,
                                fbl::Vector<trace::Record>* out_records,
                                size_t* out_leading_to_skip);
+// Stops tracing and reads back every record in the buffer, for tests
+// which check the records themselves rather than their text.
+bool fixture_read_records(fbl::Vector<trace::Record>* out_records);
 
 using trace::internal::trace_buffer_header;
 void fixture_snapshot_buffer_header(trace_buffer_header* header);
+// Copies the header of the buffer, for tests which check it once tracing
+// has stopped and the context is gone.
+void fixture_read_buffer_header(trace_buffer_header* header);
 
 #endif
 
@@ -51,6 +57,9 @@ __BEGIN_CDECLS
 
 void fixture_set_up(attach_to_thread_t attach_to_thread,
                     trace_buffering_mode_t mode, size_t buffer_size);
+// Sets the |TRACE_ENGINE_OPTION_*| values used the next time the engine
+// is started.
+void fixture_set_engine_options(uint32_t options);
 void fixture_tear_down(void);
 void fixture_start_tracing(void);
 